@@ -48,6 +48,14 @@ extern "C" {
  */
 #define U_CELL_FILE_NAME_MAX_LENGTH 248
 
+#ifndef U_CELL_FILE_READ_CHUNK_LENGTH_BYTES
+/** uCellFileRead() reads files larger than this from the default
+ * area of the file system (i.e. with no tag set) in blocks of this
+ * size, allowing higher priority AT client users in between blocks.
+ */
+# define U_CELL_FILE_READ_CHUNK_LENGTH_BYTES 512
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -112,6 +120,10 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
 /** Read the contents of a file from the file system. If the file does not exist,
  * error will be return. In order to avoid character loss it is recommended
  * that flow control lines are connected on the interface to the module.
+ * If no tag is set and dataSize is larger than
+ * #U_CELL_FILE_READ_CHUNK_LENGTH_BYTES the file is read in blocks of
+ * that size, letting higher priority users of the AT interface in
+ * between blocks.
  *
  * @param cellHandle     the handle of the cellular instance.
  * @param[in] pFileName  a pointer to file name to read file contents from the
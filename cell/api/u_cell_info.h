@@ -275,7 +275,9 @@ int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
 
 /** Get the UTC time according to cellular.  This feature requires
  * a connection to have been activated and support for this feature
- * is optional in the cellular network.
+ * is optional in the cellular network.  On success the UTC clock
+ * of u_time.h is also set, so that uTimeUtcGet() may subsequently
+ * be used to obtain the current UTC time without an AT exchange.
  *
  * @param cellHandle  the handle of the cellular instance.
  * @return            on success the Unix UTC time, else negative
@@ -205,6 +205,30 @@ void uCellLocSetGnssEnable(uDeviceHandle_t cellHandle, bool onNotOff);
  */
 bool uCellLocGetGnssEnable(uDeviceHandle_t cellHandle);
 
+/** Set the maximum age of a location fix for it to be returned
+ * by uCellLocGet(), uCellLocGetStart() or the periodic location
+ * callback (see uCellLocGetPeriodicStart()) instead of a new fix
+ * being requested from the cellular module; the cached fix is
+ * also only used if its radius is no larger than the desired
+ * accuracy (see uCellLocSetDesiredAccuracy()).  If this is not
+ * called then the default is zero, i.e. a new fix is always
+ * requested.  The last fix can always be read, whatever its age,
+ * with uCellLocGetCached().
+ *
+ * @param cellHandle    the handle of the cellular instance.
+ * @param maxAgeSeconds the maximum age of a cached fix in seconds,
+ *                      zero to not use the cache.
+ */
+void uCellLocSetCacheMaxAge(uDeviceHandle_t cellHandle, int32_t maxAgeSeconds);
+
+/** Get the maximum age of a cached location fix.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            the maximum age in seconds, else negative
+ *                    error code.
+ */
+int32_t uCellLocGetCacheMaxAge(uDeviceHandle_t cellHandle);
+
 /** Set the cellular module pin which enables power to the
  * GNSS chip.  This is the pin number of the cellular module so,
  * for instance, GPIO2 is cellular module pin 23 and hence 23 would
@@ -300,6 +324,12 @@ bool uCellLocGnssInsideCell(uDeviceHandle_t cellHandle);
  * the cellular module is currently registered on a network
  * (e.g. as a result of uCellNetConnect() or uCellNetRegister()
  * being called).
+ * If a location fix is already in progress, e.g. as a result
+ * of uCellLocGetStart() or uCellLocGetPeriodicStart(), then
+ * this will wait for the answer to that rather than asking the
+ * cellular module for another.  If the last fix is young enough
+ * (see uCellLocSetCacheMaxAge()) it is returned immediately,
+ * even if the cellular module is not registered.
  * IMPORTANT: if Cell Locate is unable to establish a location
  * it may still return a valid time and a location of all zeros
  * but with a very large radius (e.g. 200 km), hence it is always
@@ -360,7 +390,10 @@ int32_t uCellLocGet(uDeviceHandle_t cellHandle,
  * work if the cellular module is currently registered on a network
  * (e.g. as a result of uCellNetConnect() or uCellNetRegister() being
  * called). The location establishment attempt will time-out after
- * #U_CELL_LOC_TIMEOUT_SECONDS.
+ * #U_CELL_LOC_TIMEOUT_SECONDS.  As for uCellLocGet(), a location
+ * fix already in progress is shared and, if the last fix is young
+ * enough (see uCellLocSetCacheMaxAge()), pCallback will be called
+ * with it without the cellular module being involved.
  *
  * @param cellHandle     the handle of the cellular instance.
  * @param[in] pCallback  a callback that will be called when a fix has
@@ -394,18 +427,97 @@ int32_t uCellLocGetStart(uDeviceHandle_t cellHandle,
 int32_t uCellLocGetStatus(uDeviceHandle_t cellHandle);
 
 /** Cancel a uCellLocGetStart(); after calling this function the
- * callback passed to uCellLocGetStart() will not be called until
+ * callback(s) passed to uCellLocGetStart() will not be called until
  * another uCellLocGetStart() is begun.  Note that this causes the
  * code here to stop waiting for any answer coming back from the
  * cellular module but the module may still send such an answer and,
  * since there is no reference count in it, if uCellLocGetStart() is
  * called again quickly it may pick up the first answer (and then
- * the subsequent answer one will be ignored, etc.).
+ * the subsequent answer one will be ignored, etc.).  Anyone else
+ * waiting on the same fix, e.g. in uCellLocGet(), is not affected.
  *
  * @param cellHandle  the handle of the cellular instance.
  */
 void uCellLocGetStop(uDeviceHandle_t cellHandle);
 
+/** Get the last location fix that was successfully obtained,
+ * whatever its age, without involving the cellular module.
+ *
+ * @param cellHandle                       the handle of the cellular instance.
+ * @param[out] pLatitudeX1e7               a place to put latitude (in ten
+ *                                         millionths of a degree); may be NULL.
+ * @param[out] pLongitudeX1e7              a place to put longitude (in ten millionths
+ *                                         of a degree); may be NULL.
+ * @param[out] pAltitudeMillimetres        a place to put the altitude (in
+ *                                         millimetres); may be NULL.
+ * @param[out] pRadiusMillimetres          a place to put the radius of position
+ *                                         (in millimetres); may be NULL.
+ * @param[out] pSpeedMillimetresPerSecond  a place to put the speed (in
+ *                                         millimetres per second); may be NULL.
+ * @param[out] pSvs                        a place to store the number of
+ *                                         space vehicles used in the
+ *                                         solution; may be NULL.
+ * @param[out] pTimeUtc                    a place to put the UTC time; may be NULL.
+ * @param[out] pAgeMs                      a place to put how long ago, in
+ *                                         milliseconds, the fix arrived; may
+ *                                         be NULL.
+ * @return                                 zero on success,
+ *                                         #U_ERROR_COMMON_NOT_FOUND if there
+ *                                         has not yet been a fix, else negative
+ *                                         error code.
+ */
+int32_t uCellLocGetCached(uDeviceHandle_t cellHandle,
+                          int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                          int32_t *pAltitudeMillimetres, int32_t *pRadiusMillimetres,
+                          int32_t *pSpeedMillimetresPerSecond,
+                          int32_t *pSvs, int64_t *pTimeUtc,
+                          int32_t *pAgeMs);
+
+/** Get the current location periodically: a task is started which
+ * obtains a location every periodSeconds and calls pCallback with
+ * the outcome.  Cellular modules do not offer a continuous Cell
+ * Locate mode, hence each period is a single location request
+ * to the cellular module, however everything that can be kept
+ * between requests is kept, requests already in progress are
+ * shared and a cached fix is used if it is young enough (see
+ * uCellLocSetCacheMaxAge()).  If periodic location is already
+ * running it is restarted with the new parameters.
+ *
+ * @param cellHandle     the handle of the cellular instance.
+ * @param periodSeconds  the period in seconds; must be greater than
+ *                       zero.  If obtaining a location takes longer
+ *                       than this then the next location request
+ *                       will begin immediately.
+ * @param[in] pCallback  the callback, with the same parameters as
+ *                       for uCellLocGetStart(); cannot be NULL.  This
+ *                       is called from a task of this API and so
+ *                       must not call into the cellular API: for
+ *                       instance uCellLocGetPeriodicStop() would
+ *                       wait forever for that task to exit.
+ * @return               zero on success or negative error code on
+ *                       failure.
+ */
+int32_t uCellLocGetPeriodicStart(uDeviceHandle_t cellHandle,
+                                 int32_t periodSeconds,
+                                 void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                    int32_t errorCode,
+                                                    int32_t latitudeX1e7,
+                                                    int32_t longitudeX1e7,
+                                                    int32_t altitudeMillimetres,
+                                                    int32_t radiusMillimetres,
+                                                    int32_t speedMillimetresPerSecond,
+                                                    int32_t svs,
+                                                    int64_t timeUtc));
+
+/** Stop periodic location, see uCellLocGetPeriodicStart(); if
+ * the periodic location task is in the process of sending a
+ * location request to the cellular module this will wait
+ * until it has done so.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ */
+void uCellLocGetPeriodicStop(uDeviceHandle_t cellHandle);
+
 #ifdef __cplusplus
 }
 #endif
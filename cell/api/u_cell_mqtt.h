@@ -102,6 +102,15 @@ extern "C" {
 # define U_CELL_MQTT_RETRIES_DEFAULT 2
 #endif
 
+#ifndef U_CELL_MQTT_URC_WAIT_SLICE_MS
+/** The longest time to block for in one go while waiting for an
+ * MQTT URC; the wait ends as soon as a URC arrives, this only
+ * sets how often the timeout and the keep-going callback are
+ * checked.
+ */
+# define U_CELL_MQTT_URC_WAIT_SLICE_MS 1000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
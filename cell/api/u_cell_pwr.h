@@ -406,6 +406,24 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
  */
 int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset);
 
+/** Get the time that the cellular module took to boot the last
+ * time this code powered it on, rebooted it or reset it.  Rather
+ * than waiting for the worst-case boot time of the module type,
+ * uCellPwrOn(), uCellPwrReboot() and uCellPwrResetHard() watch
+ * VInt (if connected) and probe the module with "AT" so that they
+ * continue as soon as the module is able to respond; this is the
+ * time that took, measured from the point that the module was
+ * switched on, released from reset or commanded to reboot, to the
+ * point that it responded.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            the boot time in milliseconds or negative
+ *                    error code; U_ERROR_COMMON_NOT_FOUND is
+ *                    returned if this code has not yet booted
+ *                    the module.
+ */
+int32_t uCellPwrGetBootTimeMs(uDeviceHandle_t cellHandle);
+
 /** Set the DTR power-saving pin.  "UPSV" or UART power saving is
  * normally handled automatically, using activity on the UART transmit
  * data line to wake-up the module, however this is not supported on
@@ -898,7 +916,10 @@ int32_t uCellPwrDisableUartSleep(uDeviceHandle_t cellHandle);
 
 /** Enable UART, AKA 32 kHz sleep.  32 kHz sleep is always enabled
  * where supported - you only need to call this if you have
- * previously called uCellPwrDisableUartSleep().
+ * previously called uCellPwrDisableUartSleep().  Where several
+ * tasks talk to the module independently, consider also
+ * uAtClientWakeUpBatchWindowSet() on the AT client handle (see
+ * uCellAtClientHandleGet()) so that they share wake-ups.
  *
  * @param cellHandle  the handle of the cellular instance.
  * @return            zero on success or negative error code on
@@ -448,6 +448,65 @@ int32_t uCellSecE2eEncrypt(uDeviceHandle_t cellHandle,
                            const void *pDataIn,
                            void *pDataOut, size_t dataSizeBytes);
 
+/** Ask a cellular module to encrypt a stream of data of any length,
+ * using bounded RAM.  The data is obtained from pSourceCallback
+ * in blocks of up to blockSizeBytes, each block is encrypted by
+ * the module exactly as uCellSecE2eEncrypt() would encrypt it and
+ * the encrypted block is passed to pSinkCallback.  While the module
+ * is encrypting one block the next block is obtained from
+ * pSourceCallback, so that the two overlap.  Note that each
+ * encrypted block carries its own E2E header and must be decrypted
+ * separately at the far end; it is up to the application to
+ * preserve the block boundaries, e.g. by length-prefixing each
+ * block in pSinkCallback.  The memory required is three times
+ * blockSizeBytes plus #U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES,
+ * allocated for the duration of this function.
+ *
+ * @param cellHandle           the handle of the instance to be used.
+ * @param[in] pSourceCallback  the callback that provides the data
+ *                             to encrypt, cannot be NULL.  It is
+ *                             given the cellular handle, a buffer,
+ *                             the size of that buffer and
+ *                             pCallbackParam and should fill as much
+ *                             of the buffer as it can, returning the
+ *                             number of bytes written, zero when there
+ *                             is no more data or negative error code
+ *                             to abort the operation.  The callback is
+ *                             called with the AT interface locked and
+ *                             hence MUST NOT call into the cellular
+ *                             API itself.
+ * @param[in] pSinkCallback    the callback that receives each encrypted
+ *                             block, cannot be NULL.  It is given the
+ *                             cellular handle, the encrypted block,
+ *                             its length and pCallbackParam and should
+ *                             return zero to continue or negative error
+ *                             code to abort the operation; it is called
+ *                             with nothing locked.
+ * @param[in] pCallbackParam   a parameter that will be passed to both
+ *                             callbacks, may be NULL.
+ * @param blockSizeBytes       the size of block to encrypt in one go;
+ *                             use 0 for the default,
+ *                             #U_SECURITY_E2E_STREAM_BLOCK_LENGTH_BYTES.
+ *                             The module may impose a limit, refer to
+ *                             the AT manual for AT+USECE2EDATAENC.
+ * @return                     on success the total number of encrypted
+ *                             bytes passed to pSinkCallback, else
+ *                             negative error code (which will be the
+ *                             error code returned by a callback if it
+ *                             aborted the operation).
+ */
+int32_t uCellSecE2eEncryptStream(uDeviceHandle_t cellHandle,
+                                 int32_t (*pSourceCallback) (uDeviceHandle_t,
+                                                             char *,
+                                                             size_t,
+                                                             void *),
+                                 int32_t (*pSinkCallback) (uDeviceHandle_t,
+                                                           const char *,
+                                                           size_t,
+                                                           void *),
+                                 void *pCallbackParam,
+                                 size_t blockSizeBytes);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PRE-SHARED KEY GENERATION
  * -------------------------------------------------------------- */
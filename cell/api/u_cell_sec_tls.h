@@ -86,6 +86,14 @@ typedef struct {
 typedef struct {
     uDeviceHandle_t cellHandle; /**< the associated cellular handle. */
     uCellSecTlsCipherList_t cipherList; /**< temporary storage for a cipher list. */
+    uint64_t cacheKey;  /**< the key under which the settings of this
+                             context are cached, valid only if cached
+                             is true. */
+    uint32_t lastUsed;  /**< a sequence number recording when the context
+                             was last released, used for LRU eviction. */
+    size_t useCount;    /**< the number of users of a cached context. */
+    bool cached;        /**< true if the settings of this context have
+                             been cached, see uCellSecTlsCache(). */
     uint8_t profileId;  /**< the associated security profile ID,
                              at the end to improve structure packing. */
 } uCellSecTlsContext_t;
@@ -112,11 +120,47 @@ uCellSecTlsContext_t *pUCellSecSecTlsAdd(uDeviceHandle_t cellHandle);
  * internally within ubxlib by the common TLS security API
  * (common/security/api/u_security_tls.h) when a secure connection
  * is closed by one of the common protocol APIs (e.g. common/sock).
+ * If the context has been cached with uCellSecTlsCache() the security
+ * profile is retained in the module for re-use.
  *
  * @param[in] pContext a pointer to the TLS security context.
  */
 void uCellSecTlsRemove(uCellSecTlsContext_t *pContext);
 
+/** Mark a cellular TLS security context, which has been fully
+ * configured, as cached under the given key.  When the context is
+ * then removed with uCellSecTlsRemove() the security profile is
+ * kept, as programmed, in the module so that a subsequent call to
+ * pUCellSecSecTlsReuse() with the same key can obtain it again
+ * without any AT traffic.  Cached contexts which are not in use are
+ * evicted, least recently used first, when pUCellSecSecTlsAdd()
+ * runs out of security profiles, and are all forgotten when the
+ * module is powered off or rebooted.  The settings of a cached
+ * context must not be modified.  This function is called internally
+ * within ubxlib by the common TLS security API
+ * (common/security/api/u_security_tls.h), where the key is a hash
+ * of the TLS security settings.
+ *
+ * @param[in] pContext a pointer to the TLS security context.
+ * @param cacheKey     the key under which to cache the context.
+ * @return             zero on success else negative error code.
+ */
+int32_t uCellSecTlsCache(uCellSecTlsContext_t *pContext, uint64_t cacheKey);
+
+/** Obtain a cellular TLS security context that was previously
+ * cached with uCellSecTlsCache() under the given key; the context
+ * must be released with uCellSecTlsRemove() as usual.  This
+ * function is called internally within ubxlib by the common TLS
+ * security API (common/security/api/u_security_tls.h).
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param cacheKey    the key that the context was cached under.
+ * @return            on success a pointer to the TLS security context,
+ *                    else NULL if there is no such cached context.
+ */
+uCellSecTlsContext_t *pUCellSecSecTlsReuse(uDeviceHandle_t cellHandle,
+                                           uint64_t cacheKey);
+
 /** Get the last error that occurred in this API.  This must
  * be called if pUCellSecTlsAdd() returned NULL to find out
  * why.  The error code is reset to "success" by this function.
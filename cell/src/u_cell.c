@@ -50,6 +50,7 @@
 #include "u_cell.h"         // Order is
 #include "u_cell_net.h"     // important here
 #include "u_cell_private.h" // don't change it
+#include "u_cell_sec_tls_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -117,6 +118,56 @@ static void removeCellInstance(const uCellPrivateInstance_t *pInstance)
     uDeviceDestroyInstance(U_DEVICE_INSTANCE(pInstance->cellHandle));
 }
 
+// Take a cellular instance out of the list, tidy it up and free it.
+// The instance must have been locked with pUCellPrivateLock() and
+// gUCellPrivateMutex must NOT be locked.
+static void removeAndFreeCellInstance(uCellPrivateInstance_t *pInstance)
+{
+    bool inUse = true;
+
+    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+    // Once it is out of the list, and the device instance
+    // has gone, nothing else can find this instance
+    removeCellInstance(pInstance);
+    pInstance->removed = true;
+
+    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+    // Tell the AT client to ignore any asynchronous events from now on
+    uAtClientIgnoreAsync(pInstance->atHandle);
+    // Free the wake-up callback
+    uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
+    // Free any scan results
+    uCellPrivateScanFree(&(pInstance->pScanResults));
+    // Free any chip to chip security context
+    uCellPrivateC2cRemoveContext(pInstance);
+    // Free any location context and associated URC
+    uCellPrivateLocRemoveContext(pInstance);
+    // Free any sleep context
+    uCellPrivateSleepRemoveContext(pInstance);
+    // Free any FOTA context
+    free(pInstance->pFotaContext);
+    // Forget any cached security profiles
+    uCellSecTlsPrivateForget(pInstance->cellHandle);
+
+    // Tasks which found the instance before it was removed may
+    // still be waiting for it: let them see that it is gone
+    // before it is free'd
+    uCellPrivateUnlock(pInstance);
+    while (inUse) {
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        inUse = (pInstance->lockCount > 0);
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        if (inUse) {
+            uPortTaskBlock(10);
+        }
+    }
+
+    uPortMutexDelete(pInstance->mutex);
+    free(pInstance);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -138,33 +189,32 @@ int32_t uCellInit()
 void uCellDeinit()
 {
     uCellPrivateInstance_t *pInstance;
+    uDeviceHandle_t cellHandle;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         // Remove all cell instances
-        while (gpUCellPrivateInstanceList != NULL) {
-            pInstance = gpUCellPrivateInstanceList;
-            removeCellInstance(pInstance);
-            // Tell the AT client to ignore any asynchronous events from now on
-            uAtClientIgnoreAsync(pInstance->atHandle);
-            // Free the wake-up callback
-            uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
-            // Free any scan results
-            uCellPrivateScanFree(&(pInstance->pScanResults));
-            // Free any chip to chip security context
-            uCellPrivateC2cRemoveContext(pInstance);
-            // Free any location context and associated URC
-            uCellPrivateLocRemoveContext(pInstance);
-            // Free any sleep context
-            uCellPrivateSleepRemoveContext(pInstance);
-            // Free any FOTA context
-            free(pInstance->pFotaContext);
-            free(pInstance);
-        }
+        do {
+            cellHandle = NULL;
+
+            U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+            if (gpUCellPrivateInstanceList != NULL) {
+                cellHandle = gpUCellPrivateInstanceList->cellHandle;
+            }
+
+            U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+            if (cellHandle != NULL) {
+                pInstance = pUCellPrivateLock(cellHandle);
+                if (pInstance != NULL) {
+                    removeAndFreeCellInstance(pInstance);
+                }
+            }
+        } while (cellHandle != NULL);
 
-        // Unlock the mutex so that we can delete it
+        // Make sure the mutex isn't locked before we delete it
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
         uPortMutexDelete(gUCellPrivateMutex);
         gUCellPrivateMutex = NULL;
@@ -249,6 +299,7 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                     pInstance->pinPwrOn = pinPwrOn;
                     pInstance->pinVInt = pinVInt;
                     pInstance->pinDtrPowerSaving = -1;
+                    pInstance->bootTimeMs = -1;
                     for (size_t x = 0;
                          x < sizeof(pInstance->networkStatus) / sizeof(pInstance->networkStatus[0]);
                          x++) {
@@ -264,7 +315,12 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                     pInstance->pFileSystemTag = NULL;
                     pInstance->inWakeUpCallback = false;
                     pInstance->pSleepContext = NULL;
+                    pInstance->lockCount = 0;
+                    pInstance->removed = false;
                     pInstance->pNext = NULL;
+                    if (uPortMutexCreate(&(pInstance->mutex)) != 0) {
+                        platformError = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    }
 
                     // Now set up the pins
                     uPortLog("U_CELL: initialising with enable power pin ");
@@ -293,7 +349,7 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                         uPortLog("not connected.\n");
                     }
                     // Sort PWR_ON pin if there is one
-                    if (pinPwrOn >= 0) {
+                    if ((platformError == 0) && (pinPwrOn >= 0)) {
                         if (!leavePowerAlone) {
                             // Set PWR_ON to its steady state so that we can pull it
                             // the other way
@@ -378,10 +434,14 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
 #endif
                         // ...and finally add it to the list
                         addCellInstance(pInstance);
+                        pDevInstance->pDriverInstance = pInstance;
                         handleOrErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                         *pCellHandle = pInstance->cellHandle;
                     } else {
                         // If we hit a platform error, free memory again
+                        if (pInstance->mutex != NULL) {
+                            uPortMutexDelete(pInstance->mutex);
+                        }
                         free(pInstance);
                     }
                 }
@@ -404,28 +464,12 @@ void uCellRemove(uDeviceHandle_t cellHandle)
     uCellPrivateInstance_t *pInstance;
 
     if (gUCellPrivateMutex != NULL) {
-
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        // Lock the instance first so that anyone
+        // currently using it gets to finish
+        pInstance = pUCellPrivateLock(cellHandle);
         if (pInstance != NULL) {
-            removeCellInstance(pInstance);
-            // Tell the AT client to ignore any asynchronous events from now on
-            uAtClientIgnoreAsync(pInstance->atHandle);
-            // Free the wake-up callback
-            uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
-            // Free any scan results
-            uCellPrivateScanFree(&(pInstance->pScanResults));
-            // Free any chip to chip security context
-            uCellPrivateC2cRemoveContext(pInstance);
-            // Free any location context and associated URC
-            uCellPrivateLocRemoveContext(pInstance);
-            // Free any sleep context
-            uCellPrivateSleepRemoveContext(pInstance);
-            free(pInstance);
+            removeAndFreeCellInstance(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 }
 
@@ -438,16 +482,15 @@ int32_t uCellAtClientHandleGet(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (pAtHandle != NULL)) {
             *pAtHandle = pInstance->atHandle;
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -274,7 +274,7 @@ static int32_t setCops(uAtClientHandle_t atHandle, int32_t cops)
 
 // Get the radio access technology that is being used by
 // the cellular module at the given rank, SARA-U2 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static uCellNetRat_t getRatSaraU2(uCellPrivateInstance_t *pInstance,
                                   int32_t rank)
 {
@@ -349,7 +349,7 @@ static uCellNetRat_t getRatSaraU2(uCellPrivateInstance_t *pInstance,
 }
 
 // Get the rank at which the given RAT is being used, SARA-U2 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static int32_t getRatRankSaraU2(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat)
 {
@@ -417,7 +417,7 @@ static int32_t getRatRankSaraU2(uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT SARA-U2 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static int32_t setRatSaraU2(uCellPrivateInstance_t *pInstance,
                             uCellNetRat_t rat)
 {
@@ -453,7 +453,7 @@ static int32_t setRatSaraU2(uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT rank SARA-U2 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static int32_t setRatRankSaraU2(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat, int32_t rank)
 {
@@ -630,7 +630,7 @@ static int32_t setRatRankSaraU2(uCellPrivateInstance_t *pInstance,
 
 // Get the radio access technology that is being used by
 // the cellular module at the given rank, SARA-R4/R5/R6 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static uCellNetRat_t getRatSaraRx(const uCellPrivateInstance_t *pInstance,
                                   int32_t rank)
 {
@@ -667,7 +667,7 @@ static uCellNetRat_t getRatSaraRx(const uCellPrivateInstance_t *pInstance,
 }
 
 // Get the rank at which the given RAT is being used, SARA-R4/R5/R6 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static int32_t getRatRankSaraRx(const uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat)
 {
@@ -695,7 +695,7 @@ static int32_t getRatRankSaraRx(const uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT SARA-R4/R5/R6 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static int32_t setRatSaraRx(uCellPrivateInstance_t *pInstance,
                             uCellNetRat_t rat)
 {
@@ -729,7 +729,7 @@ static int32_t setRatSaraRx(uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT rank SARA-R4/R5/R6 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked before this is called.
 static int32_t setRatRankSaraRx(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat, int32_t rank)
 {
@@ -849,9 +849,8 @@ int32_t uCellCfgSetBandMask(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((rat == U_CELL_NET_RAT_CATM1) || (rat == U_CELL_NET_RAT_NB1) ||
@@ -882,7 +881,7 @@ int32_t uCellCfgSetBandMask(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -905,9 +904,8 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((rat == U_CELL_NET_RAT_CATM1) || (rat == U_CELL_NET_RAT_NB1) ||
@@ -1031,7 +1029,7 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1047,9 +1045,8 @@ int32_t uCellCfgSetRat(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             (rat > U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED) &&
@@ -1075,7 +1072,7 @@ int32_t uCellCfgSetRat(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1091,9 +1088,8 @@ int32_t uCellCfgSetRatRank(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             /* U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED is allowed here */
@@ -1121,7 +1117,7 @@ int32_t uCellCfgSetRatRank(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1137,9 +1133,8 @@ uCellNetRat_t uCellCfgGetRat(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrRat = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (rank >= 0) &&
             (rank < (int32_t) pInstance->pModule->maxNumSimultaneousRats)) {
@@ -1154,7 +1149,7 @@ uCellNetRat_t uCellCfgGetRat(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return (uCellNetRat_t) errorCodeOrRat;
@@ -1170,9 +1165,8 @@ int32_t uCellCfgGetRatRank(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrRank = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             (rat > U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED) &&
@@ -1197,7 +1191,7 @@ int32_t uCellCfgGetRatRank(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrRank;
@@ -1213,9 +1207,8 @@ int32_t uCellCfgSetMnoProfile(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (mnoProfile >= 0)) {
             errorCode = (int32_t) U_CELL_ERROR_CONNECTED;
@@ -1240,7 +1233,7 @@ int32_t uCellCfgSetMnoProfile(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1256,9 +1249,8 @@ int32_t uCellCfgGetMnoProfile(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrMnoProfile = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1277,7 +1269,7 @@ int32_t uCellCfgGetMnoProfile(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrMnoProfile;
@@ -1292,9 +1284,8 @@ int32_t uCellCfgSetSerialInterface(uDeviceHandle_t cellHandle, int32_t requested
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             // Lock mutex before using AT client.
@@ -1312,7 +1303,7 @@ int32_t uCellCfgSetSerialInterface(uDeviceHandle_t cellHandle, int32_t requested
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1328,9 +1319,8 @@ int32_t uCellCfgGetActiveSerialInterface(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrActiveVariant = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1352,7 +1342,7 @@ int32_t uCellCfgGetActiveSerialInterface(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrActiveVariant;
@@ -1368,9 +1358,8 @@ int32_t uCellCfgSetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (param1 >= 0) && (param2 >= 0)) {
             atHandle = pInstance->atHandle;
@@ -1388,7 +1377,7 @@ int32_t uCellCfgSetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1406,9 +1395,8 @@ int32_t uCellCfgGetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrUdconf = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (param1 >= 0)) {
             atHandle = pInstance->atHandle;
@@ -1435,7 +1423,7 @@ int32_t uCellCfgGetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrUdconf;
@@ -1453,9 +1441,8 @@ int32_t uCellCfgFactoryReset(uDeviceHandle_t cellHandle, int32_t fsRestoreType,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             // Lock mutex before using AT client.
@@ -1476,7 +1463,7 @@ int32_t uCellCfgFactoryReset(uDeviceHandle_t cellHandle, int32_t fsRestoreType,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1496,9 +1483,8 @@ int32_t uCellCfgSetGreeting(uDeviceHandle_t cellHandle, const char *pStr)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             uAtClientLock(atHandle);
@@ -1511,7 +1497,7 @@ int32_t uCellCfgSetGreeting(uDeviceHandle_t cellHandle, const char *pStr)
             errorCode = uAtClientUnlock(atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1528,9 +1514,8 @@ int32_t uCellCfgGetGreeting(uDeviceHandle_t cellHandle, char *pStr, size_t size)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (pStr != NULL)) {
             atHandle = pInstance->atHandle;
             uAtClientLock(atHandle);
@@ -1556,7 +1541,7 @@ int32_t uCellCfgGetGreeting(uDeviceHandle_t cellHandle, char *pStr, size_t size)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -1572,9 +1557,8 @@ int32_t uCellCfgSetAutoBaudOff(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -1596,7 +1580,7 @@ int32_t uCellCfgSetAutoBaudOff(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1610,9 +1594,8 @@ int32_t uCellCfgSetAutoBaudOn(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -1623,7 +1606,7 @@ int32_t uCellCfgSetAutoBaudOn(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1641,9 +1624,8 @@ bool uCellCfgAutoBaudIsOn(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) &&
             U_CELL_PRIVATE_HAS(pInstance->pModule,
                                U_CELL_PRIVATE_FEATURE_AUTO_BAUDING)) {
@@ -1683,7 +1665,7 @@ bool uCellCfgAutoBaudIsOn(uDeviceHandle_t cellHandle)
             uAtClientUnlock(atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return autoBaudOn;
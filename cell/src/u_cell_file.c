@@ -58,6 +58,94 @@ static uCellPrivateFileListContainer_t *gpFileList = NULL;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Read a block of a file from the default area of the file system
+// with AT+URDBLOCK, AT client already locked; returns the number of
+// bytes read, which may be zero or negative if there was an error.
+static int32_t blockRead(const uCellPrivateInstance_t *pInstance,
+                         const char *pFileName, char *pData,
+                         int32_t offset, int32_t dataSize)
+{
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t readSize;
+    int32_t indicatedReadSize;
+
+    uAtClientCommandStart(atHandle, "AT+URDBLOCK=");
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    // Write offset in bytes from the beginning of the file
+    uAtClientWriteInt(atHandle, offset);
+    // Write size of data to be read from file
+    uAtClientWriteInt(atHandle, dataSize);
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
+        // SARA-R4 only puts \n before the
+        // response, not \r\n as it should
+        uAtClientResponseStart(atHandle, "\n+URDBLOCK:");
+    } else {
+        uAtClientResponseStart(atHandle, "+URDBLOCK:");
+    }
+    // Skip the file name
+    uAtClientSkipParameters(atHandle, 1);
+    // Read the size
+    indicatedReadSize = uAtClientReadInt(atHandle);
+    readSize = indicatedReadSize;
+    if (readSize > dataSize) {
+        readSize = dataSize;
+    }
+    // Don't stop for anything!
+    uAtClientIgnoreStopTag(atHandle);
+    // Get the leading quote mark out of the way
+    uAtClientReadBytes(atHandle, NULL, 1, true);
+    // Now read out all the actual data,
+    // first the bit we want
+    readSize = uAtClientReadBytes(atHandle, pData,
+                                  // Cast in two stages to keep Lint happy
+                                  (size_t) (unsigned) readSize,
+                                  true);
+    if (indicatedReadSize > readSize) {
+        //...and then the rest poured away to NULL
+        uAtClientReadBytes(atHandle, NULL,
+                           // Cast in two stages to keep Lint happy
+                           (size_t) (unsigned) (indicatedReadSize - readSize),
+                           true);
+    }
+    // Make sure to wait for the stop tag before
+    // we finish
+    uAtClientRestoreStopTag(atHandle);
+    uAtClientResponseStop(atHandle);
+
+    return readSize;
+}
+
+// Read the size of a file, AT client already locked; returns
+// the size, which may be negative if there was an error.
+static int32_t sizeRead(const uCellPrivateInstance_t *pInstance,
+                        const char *pFileName)
+{
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t size;
+
+    // Do the ULSTFILE thang with the AT interface
+    uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
+    // Write get file size op_code
+    uAtClientWriteInt(atHandle, 2);
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    if (pInstance->pFileSystemTag != NULL) {
+        // Write tag
+        uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+    }
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    uAtClientResponseStart(atHandle, "+ULSTFILE:");
+    // Read file size
+    size = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+
+    return size;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -70,9 +158,8 @@ int32_t uCellFileSetTag(uDeviceHandle_t cellHandle, const char *pTag)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -83,7 +170,7 @@ int32_t uCellFileSetTag(uDeviceHandle_t cellHandle, const char *pTag)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -97,14 +184,13 @@ const char *pUCellFileGetTag(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance !=  NULL) {
             pFileSystemTag = pInstance->pFileSystemTag;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return pFileSystemTag;
@@ -123,9 +209,8 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
@@ -166,7 +251,7 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -183,121 +268,63 @@ int32_t uCellFileRead(uDeviceHandle_t cellHandle,
     uAtClientHandle_t atHandle;
     int32_t readSize = 0;
     int32_t indicatedReadSize = 0;
+    int32_t fileSize;
+    int32_t x;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
             (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
             errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
             atHandle = pInstance->atHandle;
-            // Do the URDFILE thang with the AT interface
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+URDFILE=");
-            // Write file name
-            uAtClientWriteString(atHandle, pFileName, true);
-            if (pInstance->pFileSystemTag != NULL) {
-                // Write tag
-                uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
-            }
-            uAtClientCommandStop(atHandle);
-            // Grab the response
-            if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
-                // SARA-R4 only puts \n before the
-                // response, not \r\n as it should
-                uAtClientResponseStart(atHandle, "\n+URDFILE:");
+            // This may be a large file so let latency-critical
+            // traffic get the AT client first
+            uAtClientLockPriority(atHandle, U_AT_CLIENT_LOCK_PRIORITY_LOW);
+            if ((pInstance->pFileSystemTag == NULL) &&
+                (dataSize > U_CELL_FILE_READ_CHUNK_LENGTH_BYTES)) {
+                // A large read from the default area of the file
+                // system: read it in blocks, letting anything more
+                // urgent in between them
+                fileSize = sizeRead(pInstance, pFileName);
+                if (fileSize > (int32_t) dataSize) {
+                    fileSize = (int32_t) dataSize;
+                }
+                x = 1;
+                while ((readSize < fileSize) && (x > 0)) {
+                    if (readSize > 0) {
+                        uAtClientLockYield(atHandle);
+                    }
+                    x = fileSize - readSize;
+                    if (x > U_CELL_FILE_READ_CHUNK_LENGTH_BYTES) {
+                        x = U_CELL_FILE_READ_CHUNK_LENGTH_BYTES;
+                    }
+                    x = blockRead(pInstance, pFileName, pData + readSize,
+                                  readSize, x);
+                    if (x > 0) {
+                        readSize += x;
+                    }
+                }
             } else {
-                uAtClientResponseStart(atHandle, "+URDFILE:");
-            }
-            // Skip the file name
-            uAtClientSkipParameters(atHandle, 1);
-            // Read the size
-            indicatedReadSize = uAtClientReadInt(atHandle);
-            readSize = indicatedReadSize;
-            if (readSize > (int32_t) dataSize) {
-                readSize = (int32_t) dataSize;
-            }
-            // Don't stop for anything!
-            uAtClientIgnoreStopTag(atHandle);
-            // Get the leading quote mark out of the way
-            uAtClientReadBytes(atHandle, NULL, 1, true);
-            // Now read out all the actual data,
-            // first the bit we want
-            readSize = uAtClientReadBytes(atHandle, pData,
-                                          // Cast in two stages to keep Lint happy
-                                          (size_t)  (unsigned) readSize,
-                                          true);
-            if (indicatedReadSize > readSize) {
-                //...and then the rest poured away to NULL
-                uAtClientReadBytes(atHandle, NULL,
-                                   // Cast in two stages to keep Lint happy
-                                   (size_t) (unsigned) (indicatedReadSize - readSize),
-                                   true);
-            }
-            // Make sure to wait for the stop tag before
-            // we finish
-            uAtClientRestoreStopTag(atHandle);
-            uAtClientResponseStop(atHandle);
-            if (uAtClientUnlock(atHandle) == 0) {
-                errorCode = readSize;
-            }
-        }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
-    }
-
-    return errorCode;
-}
-
-// Read block of data from file.
-int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
-                           const char *pFileName,
-                           char *pData,
-                           size_t offset,
-                           size_t dataSize)
-{
-    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    int32_t readSize = 0;
-    int32_t indicatedReadSize = 0;
-
-    if (gUCellPrivateMutex != NULL) {
-
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
-        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        // Check parameters
-        if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
-            (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
-            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-            // Use of tags is not supported by any of the modules
-            // we support for block reads
-            if (pInstance->pFileSystemTag == NULL) {
-                errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-                atHandle = pInstance->atHandle;
-                // Do the URDBLOCK thang with the AT interface
-                uAtClientLock(atHandle);
-                uAtClientCommandStart(atHandle, "AT+URDBLOCK=");
+                // Do the URDFILE thang with the AT interface
+                uAtClientCommandStart(atHandle, "AT+URDFILE=");
                 // Write file name
                 uAtClientWriteString(atHandle, pFileName, true);
-                // Write offset in bytes from the beginning of the file
-                uAtClientWriteInt(atHandle, (int32_t) offset);
-                // Write size of data to be read from file
-                uAtClientWriteInt(atHandle, (int32_t) dataSize);
+                if (pInstance->pFileSystemTag != NULL) {
+                    // Write tag
+                    uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+                }
                 uAtClientCommandStop(atHandle);
                 // Grab the response
                 if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
                     // SARA-R4 only puts \n before the
                     // response, not \r\n as it should
-                    uAtClientResponseStart(atHandle, "\n+URDBLOCK:");
+                    uAtClientResponseStart(atHandle, "\n+URDFILE:");
                 } else {
-                    uAtClientResponseStart(atHandle, "+URDBLOCK:");
+                    uAtClientResponseStart(atHandle, "+URDFILE:");
                 }
                 // Skip the file name
                 uAtClientSkipParameters(atHandle, 1);
@@ -315,7 +342,7 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
                 // first the bit we want
                 readSize = uAtClientReadBytes(atHandle, pData,
                                               // Cast in two stages to keep Lint happy
-                                              (size_t) (unsigned) readSize,
+                                              (size_t)  (unsigned) readSize,
                                               true);
                 if (indicatedReadSize > readSize) {
                     //...and then the rest poured away to NULL
@@ -328,13 +355,56 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
                 // we finish
                 uAtClientRestoreStopTag(atHandle);
                 uAtClientResponseStop(atHandle);
+            }
+            if (uAtClientUnlock(atHandle) == 0) {
+                errorCode = readSize;
+            }
+        }
+
+        U_CELL_PRIVATE_UNLOCK(pInstance);
+    }
+
+    return errorCode;
+}
+
+// Read block of data from file.
+int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
+                           const char *pFileName,
+                           char *pData,
+                           size_t offset,
+                           size_t dataSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    int32_t readSize;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Check parameters
+        if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
+            (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            // Use of tags is not supported by any of the modules
+            // we support for block reads
+            if (pInstance->pFileSystemTag == NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                atHandle = pInstance->atHandle;
+                uAtClientLock(atHandle);
+                readSize = blockRead(pInstance, pFileName, pData,
+                                     // Cast in two stages to keep Lint happy
+                                     (int32_t) (unsigned) offset,
+                                     (int32_t) (unsigned) dataSize);
                 if (uAtClientUnlock(atHandle) == 0) {
                     errorCode = readSize;
                 }
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -351,38 +421,22 @@ int32_t uCellFileSize(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pFileName != NULL) &&
             (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
             errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
             atHandle = pInstance->atHandle;
-            // Do the ULSTFILE thang with the AT interface
             uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
-            // Write get file size op_code
-            uAtClientWriteInt(atHandle, 2);
-            // Write file name
-            uAtClientWriteString(atHandle, pFileName, true);
-            if (pInstance->pFileSystemTag != NULL) {
-                // Write tag
-                uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
-            }
-            uAtClientCommandStop(atHandle);
-            // Grab the response
-            uAtClientResponseStart(atHandle, "+ULSTFILE:");
-            // Read file size
-            size = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
+            size = sizeRead(pInstance, pFileName);
             if (uAtClientUnlock(atHandle) == 0) {
                 errorCode = size;
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -397,14 +451,13 @@ int32_t uCellFileDelete(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellPrivateFileDelete(pInstance, pFileName);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -416,19 +469,26 @@ int32_t uCellFileListFirst(uDeviceHandle_t cellHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
+    uCellPrivateFileListContainer_t *pFileList = NULL;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellPrivateFileListFirst(pInstance,
-                                                  &gpFileList,
+                                                  &pFileList,
                                                   pFileName);
+            // The list is shared between instances so swap it in
+            // under the cellular API mutex, which is safe to take
+            // while an instance is locked
+            U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+            uCellPrivateFileListLast(&gpFileList);
+            gpFileList = pFileList;
+            U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -318,9 +318,8 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -396,7 +395,7 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
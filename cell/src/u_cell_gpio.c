@@ -79,9 +79,8 @@ int32_t uCellGpioConfig(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && ((int32_t) gpioId >= 0)) {
             atHandle = pInstance->atHandle;
 
@@ -99,7 +98,7 @@ int32_t uCellGpioConfig(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId,
             errorCode = uAtClientUnlock(atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -115,9 +114,8 @@ int32_t uCellGpioSet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && ((int32_t) gpioId >= 0)) {
             atHandle = pInstance->atHandle;
 
@@ -131,7 +129,7 @@ int32_t uCellGpioSet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId,
             errorCode = uAtClientUnlock(atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -147,9 +145,8 @@ int32_t uCellGpioGet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && ((int32_t) gpioId >= 0)) {
             atHandle = pInstance->atHandle;
 
@@ -174,7 +171,7 @@ int32_t uCellGpioGet(uDeviceHandle_t cellHandle, uCellGpioName_t gpioId)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -189,9 +186,8 @@ int32_t uCellGpioSetCts(uDeviceHandle_t cellHandle, int32_t level)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -206,7 +202,7 @@ int32_t uCellGpioSetCts(uDeviceHandle_t cellHandle, int32_t level)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -222,9 +218,8 @@ int32_t uCellGpioGetCts(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -244,7 +239,7 @@ int32_t uCellGpioGetCts(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
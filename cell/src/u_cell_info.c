@@ -47,6 +47,8 @@
 #include "u_port_os.h"
 #include "u_port_uart.h"
 
+#include "u_time.h"
+
 #include "u_at_client.h"
 
 #include "u_cell_module_type.h"
@@ -462,9 +464,8 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
@@ -525,7 +526,7 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -540,14 +541,13 @@ int32_t uCellInfoGetRssiDbm(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.rssiDbm;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -562,14 +562,13 @@ int32_t uCellInfoGetRsrpDbm(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.rsrpDbm;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -585,14 +584,13 @@ int32_t uCellInfoGetRsrqDb(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.rsrqDb;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -606,15 +604,14 @@ int32_t uCellInfoGetRxQual(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.rxQual;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -681,9 +678,8 @@ int32_t uCellInfoGetSnrDb(uDeviceHandle_t cellHandle, int32_t *pSnrDb)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pSnrDb != NULL)) {
             pRadioParameters = &(pInstance->radioParameters);
@@ -703,7 +699,7 @@ int32_t uCellInfoGetSnrDb(uDeviceHandle_t cellHandle, int32_t *pSnrDb)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -717,15 +713,14 @@ int32_t uCellInfoGetCellId(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.cellId;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -739,15 +734,14 @@ int32_t uCellInfoGetEarfcn(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.earfcn;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -762,9 +756,8 @@ int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImei != NULL)) {
             errorCode = uCellPrivateGetImei(pInstance, pImei);
@@ -776,7 +769,7 @@ int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -791,9 +784,8 @@ int32_t uCellInfoGetImsi(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImsi != NULL)) {
             errorCode = uCellPrivateGetImsi(pInstance, pImsi);
@@ -805,7 +797,7 @@ int32_t uCellInfoGetImsi(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -822,9 +814,8 @@ int32_t uCellInfoGetIccidStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             atHandle = pInstance->atHandle;
@@ -844,7 +835,7 @@ int32_t uCellInfoGetIccidStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -859,16 +850,15 @@ int32_t uCellInfoGetManufacturerStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             errorCodeOrSize = getString(pInstance->atHandle, "AT+CGMI",
                                         pStr, size);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -883,16 +873,15 @@ int32_t uCellInfoGetModelStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             errorCodeOrSize = getString(pInstance->atHandle, "AT+CGMM",
                                         pStr, size);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -907,9 +896,8 @@ int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             // Use ATI9 instead of AT+CGMR as it contains more information
@@ -917,7 +905,7 @@ int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
                                         pStr, size);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -937,9 +925,8 @@ int64_t uCellInfoGetTimeUtc(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrValue = (int64_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -993,6 +980,8 @@ int64_t uCellInfoGetTimeUtc(uDeviceHandle_t cellHandle)
 
                 if (timeUtc >= 0) {
                     errorCodeOrValue = timeUtc;
+                    // Anchor the UTC clock to this
+                    uTimeUtcSet(timeUtc * 1000, U_TIME_UTC_SOURCE_CELL);
                     uPortLog("U_CELL_INFO: UTC time is %d.\n", (int32_t) errorCodeOrValue);
                 } else {
                     uPortLog("U_CELL_INFO: unable to calculate UTC time.\n");
@@ -1003,7 +992,7 @@ int64_t uCellInfoGetTimeUtc(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrValue;
@@ -1025,9 +1014,8 @@ int32_t uCellInfoGetTimeUtcStr(uDeviceHandle_t cellHandle, char *pStr, size_t si
 
     if (gUCellPrivateMutex != NULL && sizeOrErrorCode == 0) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1049,7 +1037,7 @@ int32_t uCellInfoGetTimeUtcStr(uDeviceHandle_t cellHandle, char *pStr, size_t si
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return sizeOrErrorCode;
@@ -1065,9 +1053,8 @@ bool uCellInfoIsRtsFlowControlEnabled(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             atStreamHandle = uAtClientStreamGet(pInstance->atHandle, &atStreamType);
             if (atStreamType == U_AT_CLIENT_STREAM_TYPE_UART) {
@@ -1075,7 +1062,7 @@ bool uCellInfoIsRtsFlowControlEnabled(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isEnabled;
@@ -1091,9 +1078,8 @@ bool uCellInfoIsCtsFlowControlEnabled(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             atStreamHandle = uAtClientStreamGet(pInstance->atHandle, &atStreamType);
             if (atStreamType == U_AT_CLIENT_STREAM_TYPE_UART) {
@@ -1101,7 +1087,7 @@ bool uCellInfoIsCtsFlowControlEnabled(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isEnabled;
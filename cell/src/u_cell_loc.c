@@ -32,11 +32,12 @@
 #include "stdlib.h"    // malloc()/free()
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
-#include "string.h"    // strstr()
+#include "string.h"    // strstr(), memset()
 #include "stdbool.h"
 #include "ctype.h"     // isdigit()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 
 #include "u_error_common.h"
 
@@ -50,6 +51,7 @@
 #include "u_port_os.h"
 
 #include "u_time.h"
+#include "u_completion.h"
 
 #include "u_at_client.h"
 
@@ -62,6 +64,7 @@
 #include "u_cell_private.h" // here don't change it
 
 #include "u_cell_loc.h"
+#include "u_cell_loc_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -78,7 +81,7 @@
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
  */
-#define U_CELL_LOC_EXIT_FUNCTION() } exitFunction()
+#define U_CELL_LOC_EXIT_FUNCTION(pInstance) } exitFunction(pInstance)
 
 #ifndef U_CELL_LOC_MIN_UTC_TIME
 /** If cell locate is unable to establish a location it will
@@ -102,6 +105,26 @@
 #define U_CELL_LOC_GNSS_SYSTEM_TYPES 0x7f
 #endif
 
+#ifndef U_CELL_LOC_PERIODIC_TASK_STACK_SIZE_BYTES
+/** The stack size for the periodic location task; this calls
+ * the user callback and so needs a little headroom.
+ */
+# define U_CELL_LOC_PERIODIC_TASK_STACK_SIZE_BYTES (1024 * 3)
+#endif
+
+#ifndef U_CELL_LOC_PERIODIC_TASK_PRIORITY
+/** The task priority for the periodic location task.
+ */
+# define U_CELL_LOC_PERIODIC_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 2)
+#endif
+
+#ifndef U_CELL_LOC_PERIODIC_TASK_POLL_MS
+/** How often the periodic location task checks whether it
+ * has been asked to stop, in milliseconds.
+ */
+# define U_CELL_LOC_PERIODIC_TASK_POLL_MS 100
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -150,11 +173,14 @@ typedef union {
 } uCellLocFixDataStorageUnion_t;
 
 /** Structure to bring together the #uCellLocFixDataStorageUnion_t
- * union the enum indicating what type of storage it is.
+ * union the enum indicating what type of storage it is; these
+ * form a linked list of everyone waiting on the same fix.
  */
-typedef struct {
+typedef struct uCellLocFixDataStorage_t {
     uCellLocFixDataStorageType_t type;
     uCellLocFixDataStorageUnion_t store;
+    int64_t startTimeMs; /**< when the fix this is waiting on was begun. */
+    struct uCellLocFixDataStorage_t *pNext;
 } uCellLocFixDataStorage_t;
 
 /** Structure for the URC to use as storage.
@@ -164,6 +190,28 @@ typedef struct {
     uCellLocFixDataStorageBlock_t fixDataStorageBlock;
 } uCellLocUrc_t;
 
+/** Structure in which to cache the last fix.
+ */
+typedef struct {
+    uCellLocFixDataStorageBlock_t fixDataStorageBlock;
+    int64_t tickTimeMs; /**< when the fix arrived. */
+} uCellLocCache_t;
+
+/** Structure for passing a cached fix to a user callback.
+ */
+typedef struct {
+    void (*pCallback) (uDeviceHandle_t cellHandle,
+                       int32_t errorCode,
+                       int32_t latitudeX1e7,
+                       int32_t longitudeX1e7,
+                       int32_t altitudeMillimetres,
+                       int32_t radiusMillimetres,
+                       int32_t speedMillimetresPerSecond,
+                       int32_t svs,
+                       int64_t timeUtc);
+    uCellLocFixDataStorageBlock_t fixDataStorageBlock;
+} uCellLocCachedCallback_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -233,14 +281,17 @@ static int32_t numberToX1e7(const char *pNumber)
 // from the UULOC or UULOCIND URCs (the latter in case
 // it indicates a fatal error) and ultimately either calls
 // the user callback or dumps the data into a data block it
-// was given for processing within this API. In
-// BOTH cases it free's pContext->pFixDataStorage.
+// was given for processing within this API, for everyone
+// on the pContext->pFixDataStorage list, and it free's
+// that list.  A successful fix is also copied into the cache.
 static void UULOC_urc_callback(uAtClientHandle_t atHandle, void *pParam)
 {
     uCellLocUrc_t *pUrcStorage = (uCellLocUrc_t *) pParam;
     uCellPrivateLocContext_t *pContext;
     uCellLocFixDataStorage_t *pFixDataStorage;
+    uCellLocFixDataStorage_t *pNext;
     uCellLocFixDataStorageBlock_t *pFixDataStorageBlock;
+    uCellLocCache_t *pCache;
 
     (void) atHandle;
 
@@ -251,9 +302,21 @@ static void UULOC_urc_callback(uAtClientHandle_t atHandle, void *pParam)
             // Lock the data storage mutex while we use it
             U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
 
+            pFixDataStorageBlock = &(pUrcStorage->fixDataStorageBlock);
+            if (pFixDataStorageBlock->errorCode == 0) {
+                // Keep the fix for anyone who asks again soon
+                if (pContext->pCache == NULL) {
+                    pContext->pCache = malloc(sizeof(uCellLocCache_t));
+                }
+                pCache = (uCellLocCache_t *) pContext->pCache;
+                if (pCache != NULL) {
+                    pCache->fixDataStorageBlock = *pFixDataStorageBlock;
+                    pCache->tickTimeMs = uPortGetTickTimeMs();
+                }
+            }
+
             pFixDataStorage = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
-            if (pFixDataStorage != NULL) {
-                pFixDataStorageBlock = &(pUrcStorage->fixDataStorageBlock);
+            while (pFixDataStorage != NULL) {
                 switch (pFixDataStorage->type) {
                     case U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK:
                         if (pFixDataStorage->store.pBlock != NULL) {
@@ -280,11 +343,16 @@ static void UULOC_urc_callback(uAtClientHandle_t atHandle, void *pParam)
                 // Having called the callback we must free
                 // the data storage; the block is unaffected,
                 // that's the responsibility of whoever called us
-                free(pContext->pFixDataStorage);
-                pContext->pFixDataStorage = NULL;
+                pNext = pFixDataStorage->pNext;
+                free(pFixDataStorage);
+                pFixDataStorage = pNext;
             }
+            pContext->pFixDataStorage = NULL;
 
             U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+
+            // Wake up uCellLocGet() if it is waiting
+            uCompletionSignal((uCompletion_t *) pContext->pFixCompletion);
         }
 
         // Free the URC storage
@@ -292,6 +360,28 @@ static void UULOC_urc_callback(uAtClientHandle_t atHandle, void *pParam)
     }
 }
 
+// Handler that is called via uAtClientCallback() to give
+// a cached fix to the callback of uCellLocGetStart().
+static void cachedCallback(uAtClientHandle_t atHandle, void *pParam)
+{
+    uCellLocCachedCallback_t *pCached = (uCellLocCachedCallback_t *) pParam;
+    uCellLocFixDataStorageBlock_t *pBlock;
+
+    (void) atHandle;
+
+    if (pCached != NULL) {
+        pBlock = &(pCached->fixDataStorageBlock);
+        if (pCached->pCallback != NULL) {
+            pCached->pCallback(pBlock->cellHandle, pBlock->errorCode,
+                               pBlock->latitudeX1e7, pBlock->longitudeX1e7,
+                               pBlock->altitudeMillimetres, pBlock->radiusMillimetres,
+                               pBlock->speedMillimetresPerSecond, pBlock->svs,
+                               pBlock->timeUtc);
+        }
+        free(pCached);
+    }
+}
+
 // Callback for getting a fix from the +UULOC URC.
 static void UULOC_urc(uAtClientHandle_t atHandle, void *pParam)
 {
@@ -485,7 +575,7 @@ static void UULOCIND_urc(uAtClientHandle_t atHandle, void *pParam)
  * -------------------------------------------------------------- */
 
 // Ensure that there is a location context.
-// gUCellPrivateMutex should be locked before this is called.
+// The instance should be locked before this is called.
 static int32_t ensureContext(uCellPrivateInstance_t *pInstance)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -497,18 +587,46 @@ static int32_t ensureContext(uCellPrivateInstance_t *pInstance)
         pContext = (uCellPrivateLocContext_t *) malloc(sizeof(*pContext));
         if (pContext != NULL) {
             errorCode = uPortMutexCreate(&(pContext->fixDataStorageMutex));
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pContext->pFixCompletion = malloc(sizeof(uCompletion_t));
+                if (pContext->pFixCompletion != NULL) {
+                    errorCode = uCompletionCreate((uCompletion_t *) pContext->pFixCompletion);
+                    if (errorCode != 0) {
+                        free(pContext->pFixCompletion);
+                    }
+                }
+                if (errorCode != 0) {
+                    uPortMutexDelete(pContext->fixDataStorageMutex);
+                }
+            }
             if (errorCode == 0) {
                 pContext->desiredAccuracyMillimetres = U_CELL_LOC_DESIRED_ACCURACY_DEFAULT_MILLIMETRES;
                 pContext->desiredFixTimeoutSeconds = U_CELL_LOC_DESIRED_FIX_TIMEOUT_DEFAULT_SECONDS;
                 pContext->gnssEnable = U_CELL_LOC_GNSS_ENABLE_DEFAULT;
                 pContext->fixStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
+                pContext->indicationsOn = false;
+                pContext->cacheMaxAgeSeconds = 0;
+                pContext->pCache = NULL;
+                pContext->pPeriodicCallback = NULL;
+                pContext->periodicSeconds = 0;
+                pContext->periodicTask = NULL;
+                pContext->periodicMutex = NULL;
+                pContext->periodicTaskFlags = 0;
+                pContext->pFixDataStorage = NULL;
+                // The URC handlers stay in place for the life of
+                // the context so that there is nothing to set up
+                // per request
                 uAtClientSetUrcHandler(pInstance->atHandle,
                                        "+UULOCIND:", UULOCIND_urc,
                                        pInstance);
-                pContext->pFixDataStorage = NULL;
+                uAtClientSetUrcHandler(pInstance->atHandle,
+                                       "+UULOC:", UULOC_urc,
+                                       pInstance);
                 pInstance->pLocContext = pContext;
             } else {
                 // Free context on failure to create a fixDataStorageMutex
+                // or the fix completion
                 free(pContext);
             }
         }
@@ -517,7 +635,7 @@ static int32_t ensureContext(uCellPrivateInstance_t *pInstance)
     return errorCode;
 }
 
-// Check all the basics and lock the mutex, MUST be called
+// Check all the basics and lock the instance, MUST be called
 // at the start of every API function; use the helper macro
 // U_CELL_LOC_ENTRY_FUNCTION to be sure of this, rather than
 // calling this function directly.
@@ -530,10 +648,8 @@ static void entryFunction(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        uPortMutexLock(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = ensureContext(pInstance);
         }
@@ -548,14 +664,11 @@ static void entryFunction(uDeviceHandle_t cellHandle,
 }
 
 // MUST be called at the end of every API function to unlock
-// the cellular mutex; use the helper macro
-// U_CELL_LOC_EXIT_FUNCTION to be sure of this, rather than
-// calling this function directly.
-static void exitFunction()
+// the instance; use the helper macro U_CELL_LOC_EXIT_FUNCTION
+// to be sure of this, rather than calling this function directly.
+static void exitFunction(uCellPrivateInstance_t *pInstance)
 {
-    if (gUCellPrivateMutex != NULL) {
-        uPortMutexUnlock(gUCellPrivateMutex);
-    }
+    uCellPrivateUnlock(pInstance);
 }
 
 // Set the pin of the module that is used for the
@@ -582,14 +695,16 @@ static int32_t beginLocationFix(const uCellPrivateInstance_t *pInstance)
 
     uPortLog("U_CELL_LOC: getting location.\n");
 
-    // Request progress indications
-    uAtClientLock(atHandle);
-    uAtClientCommandStart(atHandle, "AT+ULOCIND=");
-    uAtClientWriteInt(atHandle, 1);
-    uAtClientCommandStopReadResponse(atHandle);
-    // Don't care about the error here,
-    // let's get on with it...
-    uAtClientUnlock(atHandle);
+    if (!pContext->indicationsOn) {
+        // Request progress indications, only need to do this once
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+ULOCIND=");
+        uAtClientWriteInt(atHandle, 1);
+        uAtClientCommandStopReadResponse(atHandle);
+        // Don't care much about the error here,
+        // let's get on with it...
+        pContext->indicationsOn = (uAtClientUnlock(atHandle) == 0);
+    }
 
     // Sometimes location requests are bounced by the
     // cellular module if it is busy talking to the
@@ -623,9 +738,316 @@ static int32_t beginLocationFix(const uCellPrivateInstance_t *pInstance)
         }
     }
 
+    if (errorCode < 0) {
+        // The module may have been restarted underneath us,
+        // ask for progress indications again next time
+        pContext->indicationsOn = false;
+    }
+
+    return errorCode;
+}
+
+// Get the cached fix, if there is one; if checkFresh is true
+// the cached fix is only returned if it is young enough and
+// accurate enough to stand in for a new one.
+static bool cacheGet(uCellPrivateLocContext_t *pContext,
+                     uCellLocFixDataStorageBlock_t *pFixDataStorageBlock,
+                     int32_t *pAgeMs, bool checkFresh)
+{
+    bool found = false;
+    uCellLocCache_t *pCache;
+    int64_t ageMs;
+
+    U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+
+    pCache = (uCellLocCache_t *) pContext->pCache;
+    if (pCache != NULL) {
+        ageMs = uPortGetTickTimeMs() - pCache->tickTimeMs;
+        found = !checkFresh ||
+                ((pContext->cacheMaxAgeSeconds > 0) &&
+                 (ageMs <= (int64_t) pContext->cacheMaxAgeSeconds * 1000) &&
+                 (pCache->fixDataStorageBlock.radiusMillimetres >= 0) &&
+                 (pCache->fixDataStorageBlock.radiusMillimetres <=
+                  pContext->desiredAccuracyMillimetres));
+        if (found) {
+            *pFixDataStorageBlock = pCache->fixDataStorageBlock;
+            if (pAgeMs != NULL) {
+                *pAgeMs = (int32_t) ageMs;
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+
+    return found;
+}
+
+// Fail everyone waiting on the fix begun at startTimeMs, other
+// than pExclude, because the request for that fix could not be
+// sent to the module; pExclude is removed from the list and free'd
+// without being told, its owner is given the error code directly.
+static void failFix(const uCellPrivateInstance_t *pInstance, int64_t startTimeMs,
+                    const uCellLocFixDataStorage_t *pExclude, int32_t errorCode)
+{
+    uCellPrivateLocContext_t *pContext = pInstance->pLocContext;
+    uCellLocFixDataStorage_t *pFixDataStorage;
+    uCellLocFixDataStorage_t *pPrevious = NULL;
+    uCellLocFixDataStorage_t *pNext;
+    //lint -esym(593, pCached) Suppress pCached not freed,
+    // cachedCallback() does that
+    uCellLocCachedCallback_t *pCached;
+
+    U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+
+    pFixDataStorage = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
+    while (pFixDataStorage != NULL) {
+        pNext = pFixDataStorage->pNext;
+        if (pFixDataStorage->startTimeMs == startTimeMs) {
+            if (pFixDataStorage != pExclude) {
+                if (pFixDataStorage->type == U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK) {
+                    if (pFixDataStorage->store.pBlock != NULL) {
+                        pFixDataStorage->store.pBlock->errorCode = errorCode;
+                    }
+                } else if (pFixDataStorage->store.pCallback != NULL) {
+                    // Not from here, as for a cached fix, since
+                    // the caller may be holding all sorts of locks
+                    pCached = (uCellLocCachedCallback_t *) malloc(sizeof(*pCached));
+                    if (pCached != NULL) {
+                        memset(pCached, 0, sizeof(*pCached));
+                        pCached->pCallback = pFixDataStorage->store.pCallback;
+                        pCached->fixDataStorageBlock.cellHandle = pInstance->cellHandle;
+                        pCached->fixDataStorageBlock.errorCode = errorCode;
+                        pCached->fixDataStorageBlock.timeUtc = LONG_MIN;
+                        if (uAtClientCallback(pInstance->atHandle, cachedCallback,
+                                              pCached) != 0) {
+                            free(pCached);
+                        }
+                    }
+                }
+            }
+            if (pPrevious == NULL) {
+                pContext->pFixDataStorage = (void *) pNext;
+            } else {
+                pPrevious->pNext = pNext;
+            }
+            free(pFixDataStorage);
+        } else {
+            pPrevious = pFixDataStorage;
+        }
+        pFixDataStorage = pNext;
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+
+    // Wake up uCellLocGet() if it is waiting
+    uCompletionSignal((uCompletion_t *) pContext->pFixCompletion);
+}
+
+// Add fix data storage to the list of those waiting for a fix,
+// beginning a location fix only if there isn't one in progress
+// that it can join.  The fix storage mutex is only held while
+// the list is changed, not while the request is sent to the
+// module (which may take many seconds if the module bounces
+// it), so that the URC handler and anyone else wanting a fix
+// are not held up: the new storage goes on the list first, as
+// a request in progress that others may join, and is taken off
+// again, along with anyone who joined it, if the request could
+// not be sent.
+static int32_t requestFix(const uCellPrivateInstance_t *pInstance,
+                          uCellLocFixDataStorageType_t type,
+                          volatile uCellLocFixDataStorageBlock_t *pBlock,
+                          void (*pCallback) (uDeviceHandle_t cellHandle,
+                                             int32_t errorCode,
+                                             int32_t latitudeX1e7,
+                                             int32_t longitudeX1e7,
+                                             int32_t altitudeMillimetres,
+                                             int32_t radiusMillimetres,
+                                             int32_t speedMillimetresPerSecond,
+                                             int32_t svs,
+                                             int64_t timeUtc))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uCellPrivateLocContext_t *pContext = pInstance->pLocContext;
+    uCellLocFixDataStorage_t *pFixDataStorage;
+    uCellLocFixDataStorage_t *pInFlight;
+    int64_t startTimeMs;
+    bool begin = false;
+
+    // Allocate the data storage. This will be freed by the
+    // local callback that is called from the URC handler
+    // once it's got an answer and passed it on
+    pFixDataStorage = (uCellLocFixDataStorage_t *) malloc(sizeof(*pFixDataStorage));
+    if (pFixDataStorage != NULL) {
+        pFixDataStorage->type = type;
+        if (type == U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK) {
+            pFixDataStorage->store.pBlock = pBlock;
+        } else {
+            pFixDataStorage->store.pCallback = pCallback;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+        // Lock the fix storage mutex while we fiddle with the list
+        U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+
+        pFixDataStorage->startTimeMs = uPortGetTickTimeMs();
+        pInFlight = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
+        if ((pInFlight != NULL) &&
+            ((pFixDataStorage->startTimeMs - pInFlight->startTimeMs) / 1000 <
+             U_CELL_LOC_TIMEOUT_SECONDS)) {
+            // There's a fix in progress that will answer
+            // for us too, no need to bother the module again
+            uPortLog("U_CELL_LOC: joining location request in progress.\n");
+            pFixDataStorage->startTimeMs = pInFlight->startTimeMs;
+        } else {
+            // We will start the location fix
+            pContext->fixStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
+            begin = true;
+        }
+        startTimeMs = pFixDataStorage->startTimeMs;
+        // Attach our storage to the front of the list
+        pFixDataStorage->pNext = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
+        pContext->pFixDataStorage = (void *) pFixDataStorage;
+
+        U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+
+        if (begin) {
+            errorCode = beginLocationFix(pInstance);
+            if (errorCode != 0) {
+                // Our storage may already have been free'd by the
+                // URC handler (e.g. a late answer to an earlier
+                // request) so it is only used as a marker here
+                failFix(pInstance, startTimeMs, pFixDataStorage, errorCode);
+            }
+        }
+    }
+
     return errorCode;
 }
 
+// Remove fix data storage of the given type from the list of
+// those waiting for a fix; if the type is block then only the
+// storage pointing at pBlock is removed.
+static void removeFixDataStorage(uCellPrivateLocContext_t *pContext,
+                                 uCellLocFixDataStorageType_t type,
+                                 const volatile uCellLocFixDataStorageBlock_t *pBlock)
+{
+    uCellLocFixDataStorage_t *pFixDataStorage;
+    uCellLocFixDataStorage_t *pPrevious = NULL;
+    uCellLocFixDataStorage_t *pNext;
+
+    U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+
+    pFixDataStorage = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
+    while (pFixDataStorage != NULL) {
+        pNext = pFixDataStorage->pNext;
+        if ((pFixDataStorage->type == type) &&
+            ((type != U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK) ||
+             (pFixDataStorage->store.pBlock == pBlock))) {
+            if (pPrevious == NULL) {
+                pContext->pFixDataStorage = (void *) pNext;
+            } else {
+                pPrevious->pNext = pNext;
+            }
+            free(pFixDataStorage);
+        } else {
+            pPrevious = pFixDataStorage;
+        }
+        pFixDataStorage = pNext;
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+}
+
+// Task to get location periodically; note that this does NOT
+// lock the instance, it only uses things that can be used safely
+// without doing so, and uCellPrivateLocCleanUpPeriodicTask(),
+// which waits for it to exit, is called with the instance locked.
+static void periodicTask(void *pParameter)
+{
+    uCellPrivateInstance_t *pInstance = (uCellPrivateInstance_t *) pParameter;
+    uCellPrivateLocContext_t *pContext = pInstance->pLocContext;
+    volatile uCellLocFixDataStorageBlock_t fixDataStorageBlock;
+    uCellLocFixDataStorageBlock_t cachedFix;
+    int64_t startTime;
+    int32_t errorCode;
+
+    // Lock the mutex to indicate that we're running
+    U_PORT_MUTEX_LOCK(pContext->periodicMutex);
+
+    pContext->periodicTaskFlags |= U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_HAS_RUN;
+
+    while (pContext->periodicTaskFlags & U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING) {
+        startTime = uPortGetTickTimeMs();
+        fixDataStorageBlock.cellHandle = pInstance->cellHandle;
+        fixDataStorageBlock.errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        if (cacheGet(pContext, &cachedFix, NULL, true)) {
+            // Someone else has asked recently enough
+            fixDataStorageBlock = cachedFix;
+        } else {
+            errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+            if (uCellPrivateIsRegistered(pInstance)) {
+                errorCode = requestFix(pInstance, U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK,
+                                       &fixDataStorageBlock, NULL);
+            }
+            if (errorCode == 0) {
+                while ((fixDataStorageBlock.errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) &&
+                       (pContext->periodicTaskFlags & U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING) &&
+                       ((uPortGetTickTimeMs() - startTime) / 1000 < U_CELL_LOC_TIMEOUT_SECONDS)) {
+                    uPortTaskBlock(U_CELL_LOC_PERIODIC_TASK_POLL_MS);
+                }
+                removeFixDataStorage(pContext, U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK,
+                                     &fixDataStorageBlock);
+            } else {
+                fixDataStorageBlock.errorCode = errorCode;
+            }
+        }
+        if (pContext->periodicTaskFlags & U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING) {
+            pContext->pPeriodicCallback(pInstance->cellHandle,
+                                        fixDataStorageBlock.errorCode,
+                                        fixDataStorageBlock.latitudeX1e7,
+                                        fixDataStorageBlock.longitudeX1e7,
+                                        fixDataStorageBlock.altitudeMillimetres,
+                                        fixDataStorageBlock.radiusMillimetres,
+                                        fixDataStorageBlock.speedMillimetresPerSecond,
+                                        fixDataStorageBlock.svs,
+                                        fixDataStorageBlock.timeUtc);
+        }
+        // Wait out the rest of the period
+        while ((pContext->periodicTaskFlags & U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING) &&
+               ((uPortGetTickTimeMs() - startTime) / 1000 < pContext->periodicSeconds)) {
+            uPortTaskBlock(U_CELL_LOC_PERIODIC_TASK_POLL_MS);
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->periodicMutex);
+
+    // Delete ourselves
+    uPortTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Free the list of everyone waiting on a fix.
+void uCellLocPrivateFreeFixDataStorage(uCellPrivateLocContext_t *pContext)
+{
+    uCellLocFixDataStorage_t *pFixDataStorage;
+    uCellLocFixDataStorage_t *pNext;
+
+    U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+
+    pFixDataStorage = (uCellLocFixDataStorage_t *) pContext->pFixDataStorage;
+    while (pFixDataStorage != NULL) {
+        pNext = pFixDataStorage->pNext;
+        free(pFixDataStorage);
+        pFixDataStorage = pNext;
+    }
+    pContext->pFixDataStorage = NULL;
+
+    U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -642,7 +1064,7 @@ void uCellLocCleanUp(uDeviceHandle_t cellHandle)
         uCellPrivateLocRemoveContext(pInstance);
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 }
 
 /* ----------------------------------------------------------------
@@ -662,7 +1084,7 @@ void uCellLocSetDesiredAccuracy(uDeviceHandle_t cellHandle,
         pInstance->pLocContext->desiredAccuracyMillimetres = accuracyMillimetres;
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 }
 
 // Get the desired location accuracy.
@@ -677,7 +1099,7 @@ int32_t uCellLocGetDesiredAccuracy(uDeviceHandle_t cellHandle)
         errorCodeOrAccuracy = pInstance->pLocContext->desiredAccuracyMillimetres;
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrAccuracy;
 }
@@ -695,7 +1117,7 @@ void uCellLocSetDesiredFixTimeout(uDeviceHandle_t cellHandle,
         pInstance->pLocContext->desiredFixTimeoutSeconds = fixTimeoutSeconds;
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 }
 
 // Get the desired location fix time-out.
@@ -710,7 +1132,7 @@ int32_t uCellLocGetDesiredFixTimeout(uDeviceHandle_t cellHandle)
         errorCodeOrFixTimeout = pInstance->pLocContext->desiredFixTimeoutSeconds;
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrFixTimeout;
 }
@@ -727,7 +1149,7 @@ void uCellLocSetGnssEnable(uDeviceHandle_t cellHandle, bool onNotOff)
         pInstance->pLocContext->gnssEnable = onNotOff;
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 }
 
 // Get whether GNSS is employed in the location fix or not.
@@ -742,11 +1164,43 @@ bool uCellLocGetGnssEnable(uDeviceHandle_t cellHandle)
         errorCodeOrGnssEnable = pInstance->pLocContext->gnssEnable;
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return (errorCodeOrGnssEnable != (int32_t) false);
 }
 
+// Set the maximum age of a cached fix.
+void uCellLocSetCacheMaxAge(uDeviceHandle_t cellHandle, int32_t maxAgeSeconds)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        pInstance->pLocContext->cacheMaxAgeSeconds = maxAgeSeconds;
+    }
+
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
+}
+
+// Get the maximum age of a cached fix.
+int32_t uCellLocGetCacheMaxAge(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrMaxAge = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCodeOrMaxAge);
+
+    if ((errorCodeOrMaxAge == 0) && (pInstance != NULL)) {
+        errorCodeOrMaxAge = pInstance->pLocContext->cacheMaxAgeSeconds;
+    }
+
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
+
+    return errorCodeOrMaxAge;
+}
+
 // Set the module pin that enables power to the GNSS chip.
 int32_t uCellLocSetPinGnssPwr(uDeviceHandle_t cellHandle, int32_t pin)
 {
@@ -779,7 +1233,7 @@ int32_t uCellLocSetPinGnssPwr(uDeviceHandle_t cellHandle, int32_t pin)
         }
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -797,7 +1251,7 @@ int32_t uCellLocSetPinGnssDataReady(uDeviceHandle_t cellHandle, int32_t pin)
         errorCode = setModulePin(pInstance->atHandle, pin, 4);
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -878,7 +1332,7 @@ int32_t uCellLocSetServer(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -939,7 +1393,7 @@ bool uCellLocIsGnssPresent(uDeviceHandle_t cellHandle)
         }
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return (x != 0);
 }
@@ -955,9 +1409,8 @@ bool uCellLocGnssInsideCell(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             // Simplest way to check is to send ATI and see if
@@ -978,7 +1431,7 @@ bool uCellLocGnssInsideCell(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isInside;
@@ -1000,8 +1453,8 @@ int32_t uCellLocGet(uDeviceHandle_t cellHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance = NULL;
     uCellPrivateLocContext_t *pContext;
-    uCellLocFixDataStorage_t *pFixDataStorage;
     volatile uCellLocFixDataStorageBlock_t fixDataStorageBlock;
+    uCellLocFixDataStorageBlock_t cachedFix;
     int64_t startTime;
 
     fixDataStorageBlock.errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
@@ -1009,96 +1462,81 @@ int32_t uCellLocGet(uDeviceHandle_t cellHandle,
     U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
 
     if ((errorCode == 0) && (pInstance != NULL)) {
-        errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
-        if (uCellPrivateIsRegistered(pInstance)) {
-            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            pContext = pInstance->pLocContext;
-
-            // Lock the fix storage mutex while we fiddle with it
-            U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
-
-            if (pContext->pFixDataStorage == NULL) {
-                // Allocate the data storage. This will be freed by the
-                // local callback that is called from the URC handler
-                // once it's got an answer and copied it into our
-                // data block
-                pFixDataStorage = (uCellLocFixDataStorage_t *) malloc(sizeof(*pFixDataStorage));
-                if (pFixDataStorage != NULL) {
-                    // Attach our block to it
-                    pFixDataStorage->type = U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK;
-                    pFixDataStorage->store.pBlock = &fixDataStorageBlock;
-                    pContext->pFixDataStorage = (void *) pFixDataStorage;
-                    // Register a URC handler and give it the instance,
-                    // which has our data storage attached to it
-                    uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
-                    uAtClientSetUrcHandler(pInstance->atHandle,
-                                           "+UULOC:", UULOC_urc,
-                                           pInstance);
-                    // Start the location fix
-                    pContext->fixStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
-                    errorCode = beginLocationFix(pInstance);
-                    if (errorCode != 0) {
-                        uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
-                    }
-                }
-            }
-
-            U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
-
-            if (errorCode == 0) {
-                uPortLog("U_CELL_LOC: waiting for the answer...\n");
-                // Wait for the callback called by the URC to set
-                // errorCode inside our block to success
-                startTime = uPortGetTickTimeMs();
-                while ((fixDataStorageBlock.errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) &&
-                       (((pKeepGoingCallback == NULL) &&
-                         (uPortGetTickTimeMs() - startTime) / 1000 < U_CELL_LOC_TIMEOUT_SECONDS) ||
-                        ((pKeepGoingCallback != NULL) && pKeepGoingCallback(cellHandle)))) {
-                    // Relax a little
-                    uPortTaskBlock(1000);
-                }
-                uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
-                errorCode = fixDataStorageBlock.errorCode;
+        pContext = pInstance->pLocContext;
+        if (cacheGet(pContext, &cachedFix, NULL, true)) {
+            // The last fix is good enough, no need to
+            // bother the module
+            uPortLog("U_CELL_LOC: using cached location.\n");
+            fixDataStorageBlock = cachedFix;
+        } else {
+            errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+            if (uCellPrivateIsRegistered(pInstance)) {
+                // Attach our block to the list of those waiting
+                // for a fix, starting one if necessary, having
+                // cleared out any signal left over from a previous fix
+                uCompletionReset((uCompletion_t *) pContext->pFixCompletion);
+                errorCode = requestFix(pInstance, U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK,
+                                       &fixDataStorageBlock, NULL);
                 if (errorCode == 0) {
-                    if (pLatitudeX1e7 != NULL) {
-                        *pLatitudeX1e7 = fixDataStorageBlock.latitudeX1e7;
-                    }
-                    if (pLongitudeX1e7 != NULL) {
-                        *pLongitudeX1e7 = fixDataStorageBlock.longitudeX1e7;
-                    }
-                    if (pAltitudeMillimetres != NULL) {
-                        *pAltitudeMillimetres = fixDataStorageBlock.altitudeMillimetres;
+                    uPortLog("U_CELL_LOC: waiting for the answer...\n");
+                    // Let go of the instance while waiting, as
+                    // periodicTask() does, so that other callers can
+                    // join this request rather than queue up behind
+                    // it; the context remains valid since neither
+                    // uCellLocCleanUp() nor uCellDeinit() may be
+                    // called while location establishment is running
+                    uCellPrivateUnlock(pInstance);
+                    // Wait for the callback called by the URC to set
+                    // errorCode inside our block to success
+                    startTime = uPortGetTickTimeMs();
+                    while ((fixDataStorageBlock.errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) &&
+                           (((pKeepGoingCallback == NULL) &&
+                             (uPortGetTickTimeMs() - startTime) / 1000 < U_CELL_LOC_TIMEOUT_SECONDS) ||
+                            ((pKeepGoingCallback != NULL) && pKeepGoingCallback(cellHandle)))) {
+                        // Relax until the URC arrives or a second passes
+                        uCompletionWait((uCompletion_t *) pContext->pFixCompletion,
+                                        1000, NULL);
                     }
-                    if (pRadiusMillimetres != NULL) {
-                        *pRadiusMillimetres = fixDataStorageBlock.radiusMillimetres;
-                    }
-                    if (pSpeedMillimetresPerSecond != NULL) {
-                        *pSpeedMillimetresPerSecond = fixDataStorageBlock.speedMillimetresPerSecond;
-                    }
-                    if (pSvs != NULL) {
-                        *pSvs = fixDataStorageBlock.svs;
-                    }
-                    if (pTimeUtc != NULL) {
-                        *pTimeUtc = fixDataStorageBlock.timeUtc;
+                    if (fixDataStorageBlock.errorCode != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                        // Others may be waiting on the same fix and
+                        // we may have consumed the signal: pass it on
+                        uCompletionSignal((uCompletion_t *) pContext->pFixCompletion);
                     }
+                    // In case the callback hasn't freed our
+                    // fix data storage
+                    removeFixDataStorage(pContext, U_CELL_LOC_FIX_DATA_STORAGE_TYPE_BLOCK,
+                                         &fixDataStorageBlock);
+                    errorCode = fixDataStorageBlock.errorCode;
+                    pInstance = pUCellPrivateLock(cellHandle);
                 }
             }
-
-            // Free memory, locking the mutex while we do so
-            U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
-
-            // In case the callback hasn't freed the fix
-            // data storage memory
-            if (pContext->pFixDataStorage != NULL) {
-                free(pContext->pFixDataStorage);
-                pContext->pFixDataStorage = NULL;
+        }
+        if (errorCode == 0) {
+            if (pLatitudeX1e7 != NULL) {
+                *pLatitudeX1e7 = fixDataStorageBlock.latitudeX1e7;
+            }
+            if (pLongitudeX1e7 != NULL) {
+                *pLongitudeX1e7 = fixDataStorageBlock.longitudeX1e7;
+            }
+            if (pAltitudeMillimetres != NULL) {
+                *pAltitudeMillimetres = fixDataStorageBlock.altitudeMillimetres;
+            }
+            if (pRadiusMillimetres != NULL) {
+                *pRadiusMillimetres = fixDataStorageBlock.radiusMillimetres;
+            }
+            if (pSpeedMillimetresPerSecond != NULL) {
+                *pSpeedMillimetresPerSecond = fixDataStorageBlock.speedMillimetresPerSecond;
+            }
+            if (pSvs != NULL) {
+                *pSvs = fixDataStorageBlock.svs;
+            }
+            if (pTimeUtc != NULL) {
+                *pTimeUtc = fixDataStorageBlock.timeUtc;
             }
-
-            U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
         }
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -1118,47 +1556,44 @@ int32_t uCellLocGetStart(uDeviceHandle_t cellHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance = NULL;
     uCellPrivateLocContext_t *pContext;
-    uCellLocFixDataStorage_t *pFixDataStorage;
+    uCellLocFixDataStorageBlock_t cachedFix;
+    //lint -esym(593, pCached) Suppress pCached not freed,
+    // cachedCallback() does that
+    uCellLocCachedCallback_t *pCached;
 
     U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
 
     if ((errorCode == 0) && (pInstance != NULL)) {
-        errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
-        if (uCellPrivateIsRegistered(pInstance)) {
+        pContext = pInstance->pLocContext;
+        if (cacheGet(pContext, &cachedFix, NULL, true)) {
+            // The last fix is good enough: call the callback
+            // with it but not from here, so that the behaviour
+            // is the same as for a new fix
             errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            pContext = pInstance->pLocContext;
-
-            U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
-
-            if (pContext->pFixDataStorage == NULL) {
-                // Allocate the data storage and copy pCallback in
-                // The data storage will be freed by the local callback
-                // that is called from the URC handler after it has done
-                // pCallback
-                pFixDataStorage = (uCellLocFixDataStorage_t *) malloc(sizeof(*pFixDataStorage));
-                if (pFixDataStorage != NULL) {
-                    pFixDataStorage->type = U_CELL_LOC_FIX_DATA_STORAGE_TYPE_CALLBACK;
-                    pFixDataStorage->store.pCallback = pCallback;
-                    pContext->pFixDataStorage = (void *) pFixDataStorage;
-                    // Start the location fix
-                    pContext->fixStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
-                    // Register a URC handler and give it the instance,
-                    // which has our data storage attached to it
-                    uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
-                    uAtClientSetUrcHandler(pInstance->atHandle, "+UULOC:",
-                                           UULOC_urc, pInstance);
-                    errorCode = beginLocationFix(pInstance);
-                    if (errorCode != 0) {
-                        uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
-                    }
+            pCached = (uCellLocCachedCallback_t *) malloc(sizeof(*pCached));
+            if (pCached != NULL) {
+                pCached->pCallback = pCallback;
+                pCached->fixDataStorageBlock = cachedFix;
+                errorCode = uAtClientCallback(pInstance->atHandle, cachedCallback, pCached);
+                if (errorCode != 0) {
+                    free(pCached);
                 }
             }
-
-            U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+        } else {
+            errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+            if (uCellPrivateIsRegistered(pInstance)) {
+                // Attach the callback to the list of those waiting
+                // for a fix, starting one if necessary; the data
+                // storage will be freed by the local callback that
+                // is called from the URC handler after it has done
+                // pCallback
+                errorCode = requestFix(pInstance, U_CELL_LOC_FIX_DATA_STORAGE_TYPE_CALLBACK,
+                                       NULL, pCallback);
+            }
         }
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -1236,7 +1671,7 @@ int32_t uCellLocGetStatus(uDeviceHandle_t cellHandle)
         }
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrStatus;
 }
@@ -1246,27 +1681,141 @@ void uCellLocGetStop(uDeviceHandle_t cellHandle)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance = NULL;
-    uCellPrivateLocContext_t *pContext;
 
     U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
 
     if ((errorCode == 0) && (pInstance != NULL)) {
+        // Only the callbacks are removed: anyone else
+        // waiting on the same fix continues to wait
+        removeFixDataStorage(pInstance->pLocContext,
+                             U_CELL_LOC_FIX_DATA_STORAGE_TYPE_CALLBACK,
+                             NULL);
+    }
 
-        pContext = pInstance->pLocContext;
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
+}
 
-        // Lock the fix data storage mutex while we fiddle
-        U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+// Get the last location fix that was obtained.
+int32_t uCellLocGetCached(uDeviceHandle_t cellHandle,
+                          int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                          int32_t *pAltitudeMillimetres, int32_t *pRadiusMillimetres,
+                          int32_t *pSpeedMillimetresPerSecond,
+                          int32_t *pSvs, int64_t *pTimeUtc,
+                          int32_t *pAgeMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    uCellLocFixDataStorageBlock_t cachedFix;
 
-        if (pContext->pFixDataStorage != NULL) {
-            uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
-            free(pContext->pFixDataStorage);
-            pContext->pFixDataStorage = NULL;
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        if (cacheGet(pInstance->pLocContext, &cachedFix, pAgeMs, false)) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pLatitudeX1e7 != NULL) {
+                *pLatitudeX1e7 = cachedFix.latitudeX1e7;
+            }
+            if (pLongitudeX1e7 != NULL) {
+                *pLongitudeX1e7 = cachedFix.longitudeX1e7;
+            }
+            if (pAltitudeMillimetres != NULL) {
+                *pAltitudeMillimetres = cachedFix.altitudeMillimetres;
+            }
+            if (pRadiusMillimetres != NULL) {
+                *pRadiusMillimetres = cachedFix.radiusMillimetres;
+            }
+            if (pSpeedMillimetresPerSecond != NULL) {
+                *pSpeedMillimetresPerSecond = cachedFix.speedMillimetresPerSecond;
+            }
+            if (pSvs != NULL) {
+                *pSvs = cachedFix.svs;
+            }
+            if (pTimeUtc != NULL) {
+                *pTimeUtc = cachedFix.timeUtc;
+            }
         }
+    }
 
-        U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
+
+    return errorCode;
+}
+
+// Get location periodically.
+int32_t uCellLocGetPeriodicStart(uDeviceHandle_t cellHandle,
+                                 int32_t periodSeconds,
+                                 void (*pCallback) (uDeviceHandle_t cellHandle,
+                                                    int32_t errorCode,
+                                                    int32_t latitudeX1e7,
+                                                    int32_t longitudeX1e7,
+                                                    int32_t altitudeMillimetres,
+                                                    int32_t radiusMillimetres,
+                                                    int32_t speedMillimetresPerSecond,
+                                                    int32_t svs,
+                                                    int64_t timeUtc))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    uCellPrivateLocContext_t *pContext;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((periodSeconds > 0) && (pCallback != NULL)) {
+            pContext = pInstance->pLocContext;
+            // Stop any existing periodic location task
+            uCellPrivateLocCleanUpPeriodicTask(pContext);
+            // Create a mutex to allow us to monitor whether
+            // the task is running
+            errorCode = uPortMutexCreate(&(pContext->periodicMutex));
+            if (errorCode == 0) {
+                pContext->pPeriodicCallback = pCallback;
+                pContext->periodicSeconds = periodSeconds;
+                pContext->periodicTaskFlags |= U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING;
+                errorCode = uPortTaskCreate(periodicTask,
+                                            "cellLocPeriodic",
+                                            U_CELL_LOC_PERIODIC_TASK_STACK_SIZE_BYTES,
+                                            (void *) pInstance,
+                                            U_CELL_LOC_PERIODIC_TASK_PRIORITY,
+                                            &(pContext->periodicTask));
+                if (errorCode == 0) {
+                    while (!(pContext->periodicTaskFlags &
+                             U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_HAS_RUN)) {
+                        // Make sure the task has run before we
+                        // exit so that stopping it works properly
+                        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                    }
+                } else {
+                    // If we couldn't create the task, clean up
+                    // the mutex and re-zero the flags
+                    uPortMutexDelete(pContext->periodicMutex);
+                    pContext->periodicMutex = NULL;
+                    pContext->periodicTaskFlags = 0;
+                }
+            }
+        }
+    }
+
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
+
+    return errorCode;
+}
+
+// Stop getting location periodically.
+void uCellLocGetPeriodicStop(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+
+    U_CELL_LOC_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        uCellPrivateLocCleanUpPeriodicTask(pInstance->pLocContext);
     }
 
-    U_CELL_LOC_EXIT_FUNCTION();
+    U_CELL_LOC_EXIT_FUNCTION(pInstance);
 }
 
 // End of file
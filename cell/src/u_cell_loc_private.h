@@ -0,0 +1,56 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_LOC_PRIVATE_H_
+#define _U_CELL_LOC_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines a location function that is needed
+ * in an internal form inside the cellular API, made available this way
+ * because the types it operates on are private to u_cell_loc.c.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Free the list of fix data storage hanging off a location
+ * context, i.e. everyone still waiting on a fix, without telling
+ * them; for use when the context is being removed.  The list is
+ * manipulated under fixDataStorageMutex, which must therefore
+ * still exist.
+ *
+ * @param pContext  a pointer to the location context, cannot
+ *                  be NULL.
+ */
+void uCellLocPrivateFreeFixDataStorage(uCellPrivateLocContext_t *pContext);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_LOC_PRIVATE_H_
+
+// End of file
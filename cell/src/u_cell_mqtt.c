@@ -51,6 +51,7 @@
 #include "u_port_os.h"
 
 #include "u_hex_bin_convert.h"
+#include "u_completion.h"
 
 #include "u_at_client.h"
 
@@ -100,7 +101,7 @@
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
  */
-#define U_CELL_MQTT_EXIT_FUNCTION() } exitFunction()
+#define U_CELL_MQTT_EXIT_FUNCTION(pInstance) } exitFunction(pInstance)
 
 /** Flag bits for the flags field in uCellMqttUrcStatus_t.
  */
@@ -286,6 +287,7 @@ typedef struct {
                                                       required for SARA-R4. */
     size_t numTries; /**< The number of tries for a radio-related operation. */
     bool mqttSn; /**< true if this is an MQTT-SN session, else false. */
+    uCompletion_t urcCompletion; /**< signalled whenever an MQTT URC arrives. */
 } uCellMqttContext_t;
 
 /* ----------------------------------------------------------------
@@ -343,20 +345,22 @@ static void messageIndicationCallback(uAtClientHandle_t atHandle,
     //lint -e(507) Suppress size incompatibility due to the compiler
     // we use for Linting being a 64 bit one where the pointer
     // is 64 bit.
-    volatile uCellMqttContext_t *pContext = (volatile uCellMqttContext_t *) pParam;
+    const uCellPrivateInstance_t *pInstance = (const uCellPrivateInstance_t *) pParam;
+    volatile uCellMqttContext_t *pContext;
 
     (void) atHandle;
 
-    // This task can lock the mutex to ensure we are thread-safe
+    // This task can lock the instance to ensure we are thread-safe
     // for the call below
-    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-    if ((pContext != NULL) && (pContext->pMessageIndicationCallback != NULL)) {
-        pContext->pMessageIndicationCallback((int32_t) pContext->numUnreadMessages,
-                                             pContext->pMessageIndicationCallbackParam);
+    pInstance = pUCellPrivateLock(pInstance->cellHandle);
+    if (pInstance != NULL) {
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        if ((pContext != NULL) && (pContext->pMessageIndicationCallback != NULL)) {
+            pContext->pMessageIndicationCallback((int32_t) pContext->numUnreadMessages,
+                                                 pContext->pMessageIndicationCallbackParam);
+        }
+        uCellPrivateUnlock((uCellPrivateInstance_t *) pInstance);
     }
-
-    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
 }
 
 // A local "trampoline" for the disconnect callback,
@@ -371,20 +375,21 @@ static void disconnectCallback(uAtClientHandle_t atHandle,
     // we use for Linting being a 64 bit one where the pointer
     // is 64 bit.
     const uCellPrivateInstance_t *pInstance = (const uCellPrivateInstance_t *) pParam;
-    volatile uCellMqttContext_t *pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+    volatile uCellMqttContext_t *pContext;
 
     (void) atHandle;
 
-    // This task can lock the mutex to ensure we are thread-safe
+    // This task can lock the instance to ensure we are thread-safe
     // for the call below
-    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-    if ((pContext != NULL) && (pContext->pDisconnectCallback != NULL)) {
-        pContext->pDisconnectCallback(getLastMqttErrorCode(pInstance),
-                                      pContext->pDisconnectCallbackParam);
+    pInstance = pUCellPrivateLock(pInstance->cellHandle);
+    if (pInstance != NULL) {
+        pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+        if ((pContext != NULL) && (pContext->pDisconnectCallback != NULL)) {
+            pContext->pDisconnectCallback(getLastMqttErrorCode(pInstance),
+                                          pContext->pDisconnectCallbackParam);
+        }
+        uCellPrivateUnlock((uCellPrivateInstance_t *) pInstance);
     }
-
-    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
 }
 
 // "+UUMQTTC:"/"+UUMQTTSNC" URC handler, called by the UUMQTT_urc()
@@ -504,7 +509,7 @@ static void UUMQTTC_UUMQTTSNC_urc(uAtClientHandle_t atHandle,
                 //lint -e(1773) Suppress complaints about
                 // passing the pointer as non-volatile
                 uAtClientCallback(atHandle, messageIndicationCallback,
-                                  (void *) pContext);
+                                  (void *) pInstance);
             }
         }
         pUrcStatus->flagsBitmap |= 1 << U_CELL_MQTT_URC_FLAG_UNREAD_MESSAGES_UPDATED;
@@ -626,7 +631,8 @@ static void UUMQTTx_urc(uAtClientHandle_t atHandle,
 // "+UUMQTTCM:" URC handler, for SARA-R4 only,
 // called by the UUMQTT_urc() URC handler.
 static void UUMQTTCM_urc(uAtClientHandle_t atHandle,
-                         volatile uCellMqttContext_t *pContext)
+                         volatile uCellMqttContext_t *pContext,
+                         const uCellPrivateInstance_t *pInstance)
 {
     volatile uCellMqttUrcMessage_t *pUrcMessage = pContext->pUrcMessage;
     int32_t x;
@@ -730,7 +736,7 @@ static void UUMQTTCM_urc(uAtClientHandle_t atHandle,
             //lint -e(1773) Suppress complaints about
             // passing the pointer as non-volatile
             uAtClientCallback(atHandle, messageIndicationCallback,
-                              (void *) pContext);
+                              (void *) pInstance);
         }
     }
     uAtClientRestoreStopTag(atHandle);
@@ -758,7 +764,7 @@ static void UUMQTT_urc(uAtClientHandle_t atHandle,
                     // Either "+UUMQTTC" or "+UUMQTTCM"
                     if (bytes[1] == 'M') {
                         if (pContext->pUrcMessage != NULL) {
-                            UUMQTTCM_urc(atHandle, pContext);
+                            UUMQTTCM_urc(atHandle, pContext, pInstance);
                         }
                     } else {
                         UUMQTTC_UUMQTTSNC_urc(atHandle, pContext, pInstance);
@@ -793,6 +799,10 @@ static void UUMQTT_urc(uAtClientHandle_t atHandle,
                 }
             }
         }
+        // Wake up anyone waiting on the outcome
+        //lint -e(1773) Suppress complaints about
+        // passing the pointer as non-volatile
+        uCompletionSignal((uCompletion_t *) &(pContext->urcCompletion));
     }
 }
 
@@ -800,6 +810,17 @@ static void UUMQTT_urc(uAtClientHandle_t atHandle,
  * STATIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
 
+// Wait for an MQTT URC to arrive, or for U_CELL_MQTT_URC_WAIT_SLICE_MS,
+// whichever is the sooner; the caller must check for itself
+// whether the URC it wants has arrived.
+static void urcWait(volatile uCellMqttContext_t *pContext)
+{
+    //lint -e(1773) Suppress complaints about
+    // passing the pointer as non-volatile
+    uCompletionWait((uCompletion_t *) &(pContext->urcCompletion),
+                    U_CELL_MQTT_URC_WAIT_SLICE_MS, NULL);
+}
+
 // Check all the basics and lock the mutex, MUST be called at the
 // start of every API function; use the helper macro
 // U_CELL_MQTT_ENTRY_FUNCTION to be sure of this, rather than calling
@@ -811,8 +832,8 @@ static void UUMQTT_urc(uAtClientHandle_t atHandle,
 // already initialised MQTT context, i.e. pInstance->pMqttContext
 // may be NULL.  This latter case is only useful when this function
 // is called from uCellMqttInit(), normally you want to call this
-// function with mustBeInitialised set to true.  In all cases the
-// cellular mutex will be locked.
+// function with mustBeInitialised set to true.  The instance is
+// only left locked if it is returned.
 static void entryFunction(uDeviceHandle_t cellHandle,
                           uCellPrivateInstance_t **ppInstance,
                           int32_t *pErrorCode,
@@ -823,10 +844,8 @@ static void entryFunction(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        uPortMutexLock(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -838,13 +857,15 @@ static void entryFunction(uDeviceHandle_t cellHandle,
                     *ppInstance = pInstance;
                     errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 } else {
-                    // NULL pInstance in case the caller isn't checkiing
-                    // pErrorCode
+                    // Unlock and NULL pInstance in case the caller
+                    // isn't checkiing pErrorCode
+                    uCellPrivateUnlock(pInstance);
                     pInstance = NULL;
                 }
             } else {
-                // NULL pInstance in case the caller isn't checkiing
-                // pErrorCode
+                // Unlock and NULL pInstance in case the caller
+                // isn't checkiing pErrorCode
+                uCellPrivateUnlock(pInstance);
                 pInstance = NULL;
             }
         }
@@ -859,14 +880,11 @@ static void entryFunction(uDeviceHandle_t cellHandle,
 }
 
 // MUST be called at the end of every API function to unlock
-// the cellular mutex; use the helper macro
-// U_CELL_MQTT_EXIT_FUNCTION to be sure of this, rather than calling
-// this function directly.
-static void exitFunction()
+// the instance; use the helper macro U_CELL_MQTT_EXIT_FUNCTION
+// to be sure of this, rather than calling this function directly.
+static void exitFunction(uCellPrivateInstance_t *pInstance)
 {
-    if (gUCellPrivateMutex != NULL) {
-        uPortMutexUnlock(gUCellPrivateMutex);
-    }
+    uCellPrivateUnlock(pInstance);
 }
 
 // Print the error state of MQTT.
@@ -1031,8 +1049,8 @@ static int32_t doSaraR4OldSyntaxUmqttQuery(const uCellPrivateInstance_t *pInstan
                                            int32_t number)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-    volatile uCellMqttUrcStatus_t *pUrcStatus = &(((volatile uCellMqttContext_t *)
-                                                   pInstance->pMqttContext)->urcStatus);
+    volatile uCellMqttContext_t *pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+    volatile uCellMqttUrcStatus_t *pUrcStatus = &(pContext->urcStatus);
     uAtClientHandle_t atHandle = pInstance->atHandle;
     char buffer[13];  // Enough room for "AT+UMQTT=x?"
     int32_t status;
@@ -1066,7 +1084,7 @@ static int32_t doSaraR4OldSyntaxUmqttQuery(const uCellPrivateInstance_t *pInstan
         startTimeMs = uPortGetTickTimeMs();
         while ((!checkUrcStatusField(pUrcStatus, number)) &&
                (uPortGetTickTimeMs() - startTimeMs < U_CELL_MQTT_LOCAL_URC_TIMEOUT_MS)) {
-            uPortTaskBlock(250);
+            urcWait(pContext);
         }
         if (checkUrcStatusField(pUrcStatus, number)) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -1209,7 +1227,7 @@ static int32_t setKeepAlive(uDeviceHandle_t cellHandle, bool onNotOff)
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -1242,7 +1260,7 @@ static int32_t setSessionRetain(uDeviceHandle_t cellHandle, bool onNotOff)
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -1282,7 +1300,7 @@ static int32_t setSecurity(uDeviceHandle_t cellHandle, bool onNotOff,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -1361,7 +1379,7 @@ static int32_t connect(const uCellPrivateInstance_t *pInstance,
                        (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000) ) &&
                        ((pContext->pKeepGoingCallback == NULL) ||
                         pContext->pKeepGoingCallback())) {
-                    uPortTaskBlock(1000);
+                    urcWait(pContext);
                 }
                 if ((int32_t) onNotOff == pContext->connected) {
                     uPortLog("U_CELL_MQTT: %s after %d second(s).\n",
@@ -1642,7 +1660,7 @@ static int32_t publish(const uCellPrivateInstance_t *pInstance,
                                (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                                ((pContext->pKeepGoingCallback == NULL) ||
                                 pContext->pKeepGoingCallback())) {
-                            uPortTaskBlock(1000);
+                            urcWait(pContext);
                             // When UART power saving is switched on some
                             // modules (e.g. SARA-R422) can somteimes
                             // withhold URCs so poke the module here to be
@@ -1745,7 +1763,7 @@ static int32_t subscribe(const uCellPrivateInstance_t *pInstance,
                        (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                        ((pContext->pKeepGoingCallback == NULL) ||
                         pContext->pKeepGoingCallback())) {
-                    uPortTaskBlock(1000);
+                    urcWait(pContext);
                 }
                 if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_SUBSCRIBE_SUCCESS)) != 0) {
                     errorCodeOrQos = (int32_t) pUrcStatus->subscribeQoS;
@@ -1829,7 +1847,7 @@ static int32_t unsubscribe(const uCellPrivateInstance_t *pInstance,
                            (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                            ((pContext->pKeepGoingCallback == NULL) ||
                             pContext->pKeepGoingCallback())) {
-                        uPortTaskBlock(1000);
+                        urcWait(pContext);
                     }
                     if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_UNSUBSCRIBE_SUCCESS)) != 0) {
                         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -1917,7 +1935,7 @@ static int32_t readMessage(const uCellPrivateInstance_t *pInstance,
                        (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                        ((pContext->pKeepGoingCallback == NULL) ||
                         pContext->pKeepGoingCallback())) {
-                    uPortTaskBlock(1000);
+                    urcWait(pContext);
                 }
                 if (pUrcMessage->messageRead) {
                     if (pContext->numUnreadMessages > 0) {
@@ -2078,13 +2096,15 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                     pContext->pUrcMessage = NULL;
                     pContext->numTries = U_CELL_MQTT_RETRIES_DEFAULT + 1;
                     pContext->mqttSn = mqttSn;
+                    pContext->urcCompletion.semaphoreHandle = NULL;
                     pInstance->pMqttContext = pContext;
                     if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
                         // SARA-R4 requires a pUrcMessage as well
                         pContext->pUrcMessage = (uCellMqttUrcMessage_t *) malloc(sizeof(*(pContext->pUrcMessage)));
                     }
-                    if ((pContext->pUrcMessage != NULL) ||
-                        !U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
+                    if (((pContext->pUrcMessage != NULL) ||
+                         !U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) &&
+                        (uCompletionCreate((uCompletion_t *) &(pContext->urcCompletion)) == 0)) {
                         atHandle = pInstance->atHandle;
                         // Deal with the broker name string
                         // Allocate space to fiddle with the
@@ -2231,6 +2251,7 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
                             // freeing a volatile pointer as well
                             volatile uCellMqttContext_t *pCtx = (volatile uCellMqttContext_t *)pInstance->pMqttContext;
                             free((void *)pCtx->pUrcMessage);
+                            uCompletionDelete((uCompletion_t *) &(pCtx->urcCompletion));
                         }
                         //lint -e(605) Suppress complaints about
                         // freeing this volatile pointer as well
@@ -2242,7 +2263,7 @@ int32_t uCellMqttInit(uDeviceHandle_t cellHandle, const char *pBrokerNameStr,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2262,6 +2283,9 @@ void uCellMqttDeinit(uDeviceHandle_t cellHandle)
         }
 
         uAtClientRemoveUrcHandler(pInstance->atHandle, "+UUMQTT");
+        //lint -e(1773) Suppress complaints about
+        // passing the pointer as non-volatile
+        uCompletionDelete((uCompletion_t *) &(pContext->urcCompletion));
         free(pContext->pBrokerNameStr);
         //lint -e(605) Suppress complaints about
         // freeing a volatile pointer as well
@@ -2272,7 +2296,7 @@ void uCellMqttDeinit(uDeviceHandle_t cellHandle)
         pInstance->pMqttContext = NULL;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 }
 
 // Get the current cellular MQTT client ID.
@@ -2329,7 +2353,7 @@ int32_t uCellMqttGetClientId(uDeviceHandle_t cellHandle, char *pClientIdStr,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2391,7 +2415,7 @@ int32_t uCellMqttGetLocalPort(uDeviceHandle_t cellHandle)
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrPort;
 }
@@ -2420,7 +2444,7 @@ int32_t uCellMqttSetInactivityTimeout(uDeviceHandle_t cellHandle,
         errorCode = atMqttStopCmdGetRespAndUnlock(pInstance);
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2471,7 +2495,7 @@ int32_t uCellMqttGetInactivityTimeout(uDeviceHandle_t cellHandle)
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrTimeout;
 }
@@ -2518,7 +2542,7 @@ bool uCellMqttIsKeptAlive(uDeviceHandle_t cellHandle)
         keptAlive = ((volatile uCellMqttContext_t *) pInstance->pMqttContext)->keptAlive;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return keptAlive;
 }
@@ -2580,7 +2604,7 @@ bool uCellMqttIsRetained(uDeviceHandle_t cellHandle)
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return isRetained;
 }
@@ -2612,7 +2636,7 @@ bool uCellMqttIsSecured(uDeviceHandle_t cellHandle,
         secured = isSecured(pInstance, pSecurityProfileId);
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return secured;
 }
@@ -2721,7 +2745,7 @@ int32_t uCellMqttSetWill(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2883,7 +2907,7 @@ int32_t uCellMqttGetWill(uDeviceHandle_t cellHandle, char *pTopicNameStr,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2904,7 +2928,7 @@ int32_t uCellMqttConnect(uDeviceHandle_t cellHandle)
         errorCode = connect(pInstance, true);
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2921,7 +2945,7 @@ int32_t uCellMqttDisconnect(uDeviceHandle_t cellHandle)
         errorCode = connect(pInstance, false);
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2941,7 +2965,7 @@ bool uCellMqttIsConnected(uDeviceHandle_t cellHandle)
         connected = ((volatile uCellMqttContext_t *) pInstance->pMqttContext)->connected;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return connected;
 }
@@ -2962,7 +2986,7 @@ int32_t uCellMqttSetMessageCallback(uDeviceHandle_t cellHandle,
             pCallbackParam;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -2980,7 +3004,7 @@ int32_t uCellMqttGetUnread(uDeviceHandle_t cellHandle)
                                        pInstance->pMqttContext)->numUnreadMessages;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrUnread;
 }
@@ -2997,7 +3021,7 @@ int32_t uCellMqttGetLastErrorCode(uDeviceHandle_t cellHandle)
         errorCode = getLastMqttErrorCode(pInstance);
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3018,7 +3042,7 @@ int32_t uCellMqttSetDisconnectCallback(uDeviceHandle_t cellHandle,
             pCallbackParam;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3036,7 +3060,7 @@ void uCellMqttSetRetries(uDeviceHandle_t cellHandle, size_t numRetries)
         pContext->numTries = numRetries + 1;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 }
 
 // Get the number of retries on radio-related failure.
@@ -3053,7 +3077,7 @@ int32_t uCellMqttGetRetries(uDeviceHandle_t cellHandle)
         errorCodeOrRetries = ((int32_t) pContext->numTries) - 1;
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrRetries;
 }
@@ -3069,7 +3093,7 @@ bool uCellMqttIsSupported(uDeviceHandle_t cellHandle)
     uCellPrivateInstance_t *pInstance = NULL;
 
     U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, false);
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return (pInstance != NULL ? U_CELL_PRIVATE_HAS(pInstance->pModule,
                                                    U_CELL_PRIVATE_FEATURE_MQTT) : false);
@@ -3104,7 +3128,7 @@ int32_t uCellMqttSetLocalPort(uDeviceHandle_t cellHandle, uint16_t port)
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3133,7 +3157,7 @@ int32_t uCellMqttPublish(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3160,7 +3184,7 @@ int32_t uCellMqttSubscribe(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrQos;
 }
@@ -3185,7 +3209,7 @@ int32_t uCellMqttUnsubscribe(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3215,7 +3239,7 @@ int32_t uCellMqttMessageRead(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3231,7 +3255,7 @@ bool uCellMqttSnIsSupported(uDeviceHandle_t cellHandle)
     uCellPrivateInstance_t *pInstance = NULL;
 
     U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, false);
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return (pInstance != NULL ? U_CELL_PRIVATE_HAS(pInstance->pModule,
                                                    U_CELL_PRIVATE_FEATURE_MQTTSN) : false);
@@ -3283,7 +3307,7 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
                                (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                                ((pContext->pKeepGoingCallback == NULL) ||
                                 pContext->pKeepGoingCallback())) {
-                            uPortTaskBlock(1000);
+                            urcWait(pContext);
                         }
                         if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_REGISTER_SUCCESS)) != 0) {
                             pTopicName->name.id = (uint16_t) pUrcStatus->topicId;
@@ -3302,7 +3326,7 @@ int32_t uCellMqttSnRegisterNormalTopic(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3338,7 +3362,7 @@ int32_t uCellMqttSnPublish(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3371,7 +3395,7 @@ int32_t uCellMqttSnSubscribe(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrQos;
 }
@@ -3402,7 +3426,7 @@ int32_t uCellMqttSnSubscribeNormalTopic(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCodeOrQos;
 }
@@ -3433,7 +3457,7 @@ int32_t uCellMqttSnUnsubscribe(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3461,7 +3485,7 @@ int32_t uCellMqttSnUnsubscribeNormalTopic(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3496,7 +3520,7 @@ int32_t uCellMqttSnMessageRead(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3548,7 +3572,7 @@ int32_t uCellMqttSnSetWillMessaage(uDeviceHandle_t cellHandle,
                                (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                                ((pContext->pKeepGoingCallback == NULL) ||
                                 pContext->pKeepGoingCallback())) {
-                            uPortTaskBlock(1000);
+                            urcWait(pContext);
                         }
                         if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_WILL_MESSAGE_SUCCESS)) != 0) {
                             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -3564,7 +3588,7 @@ int32_t uCellMqttSnSetWillMessaage(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -3623,7 +3647,7 @@ int32_t uCellMqttSnSetWillParameters(uDeviceHandle_t cellHandle,
                                (uPortGetTickTimeMs() - startTimeMs < (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000)) &&
                                ((pContext->pKeepGoingCallback == NULL) ||
                                 pContext->pKeepGoingCallback())) {
-                            uPortTaskBlock(1000);
+                            urcWait(pContext);
                         }
                         if ((pUrcStatus->flagsBitmap & (1 << U_CELL_MQTT_URC_FLAG_WILL_PARAMETERS_SUCCESS)) != 0) {
                             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -3639,7 +3663,7 @@ int32_t uCellMqttSnSetWillParameters(uDeviceHandle_t cellHandle,
         }
     }
 
-    U_CELL_MQTT_EXIT_FUNCTION();
+    U_CELL_MQTT_EXIT_FUNCTION(pInstance);
 
     return errorCode;
 }
@@ -740,27 +740,35 @@ static int32_t radioOff(uCellPrivateInstance_t *pInstance)
     return errorCode;
 }
 
-// Perform an abort of an AT command.
-static void abortCommand(const uCellPrivateInstance_t *pInstance)
+// Make one attempt at aborting an AT command, AT client
+// already locked; returns true if the abort was acknowledged.
+static bool abortCommandTry(uAtClientHandle_t atHandle)
 {
-    uAtClientHandle_t atHandle = pInstance->atHandle;
     uAtClientDeviceError_t deviceError;
-    bool success = false;
 
     // Abort is done by sending anything, we use
     // here just a space, after an AT command has
     // been sent and before the response comes
-    // back.  It is, however, possible for
-    // an abort to be ignored so we test for that
-    // and try a few times
+    // back.
+    uAtClientCommandStart(atHandle, " ");
+    uAtClientCommandStopReadResponse(atHandle);
+    uAtClientDeviceErrorGet(atHandle, &deviceError);
+    // Check that a device error has been signalled,
+    // we've not simply timed out
+    return (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR);
+}
+
+// Perform an abort of an AT command.
+static void abortCommand(const uCellPrivateInstance_t *pInstance)
+{
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    bool success = false;
+
+    // It is possible for an abort to be ignored
+    // so we test for that and try a few times
     for (size_t x = 3; (x > 0) && !success; x--) {
         uAtClientLock(atHandle);
-        uAtClientCommandStart(atHandle, " ");
-        uAtClientCommandStopReadResponse(atHandle);
-        uAtClientDeviceErrorGet(atHandle, &deviceError);
-        // Check that a device error has been signalled,
-        // we've not simply timed out
-        success = (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR);
+        success = abortCommandTry(atHandle);
         uAtClientUnlock(atHandle);
     }
 }
@@ -2012,9 +2020,8 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pUsername == NULL) || (pPassword != NULL))) {
@@ -2178,7 +2185,7 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2195,9 +2202,8 @@ int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
 
@@ -2258,7 +2264,7 @@ int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2278,9 +2284,8 @@ int32_t uCellNetActivate(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pUsername == NULL) || (pPassword != NULL))) {
@@ -2393,7 +2398,7 @@ int32_t uCellNetActivate(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2409,9 +2414,8 @@ int32_t uCellNetDeactivate(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             if (uCellPrivateIsRegistered(pInstance)) {
@@ -2437,7 +2441,7 @@ int32_t uCellNetDeactivate(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2454,9 +2458,8 @@ int32_t uCellNetDisconnect(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -2484,7 +2487,7 @@ int32_t uCellNetDisconnect(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2505,14 +2508,14 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
     int64_t innerStartTimeMs;
     uAtClientDeviceError_t deviceError;
     bool gotAnswer = false;
+    bool aborted;
     char *pSaved;
     char *pStr;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrNumber = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pName == NULL) || (nameSize > 0))) {
@@ -2543,11 +2546,21 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
                 // it will be at longer than that hence we set
                 // a threshold for readBytes of > 12 characters.
                 pInstance->startTimeMs = uPortGetTickTimeMs();
+                // A scan takes a long time: let latency-critical
+                // traffic get the AT client first
+                uAtClientLockPriority(atHandle, U_AT_CLIENT_LOCK_PRIORITY_LOW);
                 for (size_t x = U_CELL_NET_SCAN_RETRIES + 1;
                      (x > 0) && (errorCodeOrNumber <= 0) &&
                      ((pKeepGoingCallback == NULL) || (pKeepGoingCallback(cellHandle)));
                      x--) {
-                    uAtClientLock(atHandle);
+                    if (x <= U_CELL_NET_SCAN_RETRIES) {
+                        // Between attempts, let in anything
+                        // waiting that is more urgent; this can't
+                        // be done while a scan is in progress as
+                        // any character sent would abort it
+                        uAtClientClearError(atHandle);
+                        uAtClientLockYield(atHandle);
+                    }
                     // Set the timeout to a second so that we
                     // can spin around the loop
                     gotAnswer = false;
@@ -2605,13 +2618,19 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
                         }
                     }
                     uAtClientResponseStop(atHandle);
-                    uAtClientUnlock(atHandle);
                     if (!gotAnswer) {
                         // If we never got an answer, abort the
-                        // command first.
-                        abortCommand(pInstance);
+                        // command first; it is possible for
+                        // an abort to be ignored so try a few times
+                        aborted = false;
+                        uAtClientTimeoutSet(atHandle, U_AT_CLIENT_DEFAULT_TIMEOUT_MS);
+                        for (size_t y = 3; (y > 0) && !aborted; y--) {
+                            uAtClientClearError(atHandle);
+                            aborted = abortCommandTry(atHandle);
+                        }
                     }
                 }
+                uAtClientUnlock(atHandle);
 
                 // Free memory
                 free(pBuffer);
@@ -2630,7 +2649,7 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrNumber;
@@ -2646,9 +2665,8 @@ int32_t uCellNetScanGetNext(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = readNextScanItem(pInstance, pMccMnc, pName,
@@ -2659,7 +2677,7 @@ int32_t uCellNetScanGetNext(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2672,15 +2690,14 @@ void uCellNetScanGetLast(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             // Free scan results
             uCellPrivateScanFree(&(pInstance->pScanResults));
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 }
 
@@ -2696,9 +2713,8 @@ int32_t uCellNetSetRegistrationStatusCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             pInstance->pRegistrationStatusCallback = pCallback;
@@ -2706,7 +2722,7 @@ int32_t uCellNetSetRegistrationStatusCallback(uDeviceHandle_t cellHandle,
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2725,9 +2741,8 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -2753,7 +2768,7 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2768,15 +2783,14 @@ uCellNetStatus_t uCellNetGetNetworkStatus(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrStatus = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (domain < U_CELL_NET_REG_DOMAIN_MAX_NUM)) {
             errorCodeOrStatus = (int32_t) pInstance->networkStatus[domain];
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return (uCellNetStatus_t) errorCodeOrStatus;
@@ -2790,14 +2804,13 @@ bool uCellNetIsRegistered(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             isRegistered = uCellPrivateIsRegistered(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isRegistered;
@@ -2811,15 +2824,14 @@ uCellNetRat_t uCellNetGetActiveRat(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrRat = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrRat = (int32_t) uCellPrivateGetActiveRat(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return (uCellNetRat_t) errorCodeOrRat;
@@ -2834,9 +2846,8 @@ int32_t uCellNetGetOperatorStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             errorCodeOrSize = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
@@ -2854,7 +2865,7 @@ int32_t uCellNetGetOperatorStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -2872,9 +2883,8 @@ int32_t uCellNetGetMccMnc(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pMcc != NULL) && (pMnc != NULL)) {
             errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
@@ -2915,7 +2925,7 @@ int32_t uCellNetGetMccMnc(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2934,9 +2944,8 @@ int32_t uCellNetGetIpAddressStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrSize = (int32_t) U_CELL_ERROR_NOT_CONNECTED;
@@ -3008,7 +3017,7 @@ int32_t uCellNetGetIpAddressStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -3023,9 +3032,8 @@ int32_t uCellNetGetDnsStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -3040,7 +3048,7 @@ int32_t uCellNetGetDnsStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -3055,9 +3063,8 @@ int32_t uCellNetGetApnStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -3074,7 +3081,7 @@ int32_t uCellNetGetApnStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -3097,9 +3104,8 @@ int32_t uCellNetGetDataCounterTx(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -3130,7 +3136,7 @@ int32_t uCellNetGetDataCounterTx(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrCount;
@@ -3148,9 +3154,8 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -3182,7 +3187,7 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrCount;
@@ -3197,9 +3202,8 @@ int32_t uCellNetResetDataCounters(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -3216,7 +3220,7 @@ int32_t uCellNetResetDataCounters(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -42,8 +42,10 @@
 #include "u_port_uart.h"
 #include "u_port_gpio.h"
 #include "u_port_crypto.h"
+#include "u_completion.h"
 
 #include "u_at_client.h"
+#include "u_device_shared.h"
 
 #include "u_security.h"
 
@@ -54,6 +56,8 @@
 #include "u_cell_private.h" // don't change it
 #include "u_cell_sec_c2c.h"
 #include "u_cell_pwr_private.h"
+#include "u_cell_loc_private.h"
+#include "u_cell_sec_tls_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -466,18 +470,69 @@ bool uCellPrivateIsNumeric(const char *pBuffer, size_t bufferSize)
     return numeric;
 }
 
-// Find a cellular instance in the list by instance handle.
+// Find a cellular instance by instance handle.
 uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle)
 {
-    uCellPrivateInstance_t *pInstance = gpUCellPrivateInstanceList;
+    uCellPrivateInstance_t *pInstance = NULL;
+    uDeviceInstance_t *pDevInstance = U_DEVICE_INSTANCE(cellHandle);
+
+    // The device instance carries a pointer to our instance,
+    // which in turn must point back at the device instance
+    if (uDeviceIsValidInstance(pDevInstance) &&
+        (pDevInstance->deviceType == U_DEVICE_TYPE_CELL)) {
+        pInstance = (uCellPrivateInstance_t *) pDevInstance->pDriverInstance;
+        if ((pInstance != NULL) && (pInstance->cellHandle != cellHandle)) {
+            pInstance = NULL;
+        }
+    }
+
+    return pInstance;
+}
+
+// Find a cellular instance by instance handle and lock it.
+uCellPrivateInstance_t *pUCellPrivateLock(uDeviceHandle_t cellHandle)
+{
+    uCellPrivateInstance_t *pInstance = NULL;
 
-    while ((pInstance != NULL) && (pInstance->cellHandle != cellHandle)) {
-        pInstance = pInstance->pNext;
+    if (gUCellPrivateMutex != NULL) {
+
+        // The list mutex is only held while the instance is found
+        // and marked as in use, so that it can't be free'd under
+        // our feet, not while we wait for the instance itself
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            pInstance->lockCount++;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+        if (pInstance != NULL) {
+            uPortMutexLock(pInstance->mutex);
+            if (pInstance->removed) {
+                // Removed while we were waiting
+                uCellPrivateUnlock(pInstance);
+                pInstance = NULL;
+            }
+        }
     }
 
     return pInstance;
 }
 
+// Unlock an instance.
+void uCellPrivateUnlock(uCellPrivateInstance_t *pInstance)
+{
+    if (pInstance != NULL) {
+        uPortMutexUnlock(pInstance->mutex);
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        pInstance->lockCount--;
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+}
+
 // Set the radio parameters back to defaults.
 void uCellPrivateClearRadioParameters(uCellPrivateRadioParameters_t *pParameters)
 {
@@ -489,8 +544,8 @@ void uCellPrivateClearRadioParameters(uCellPrivateRadioParameters_t *pParameters
 }
 
 // Clear the dynamic parameters of an instance,
-// so the network status, the active RAT and
-// the radio parameters.
+// so the network status, the active RAT, the radio
+// parameters and any cached security profiles.
 void uCellPrivateClearDynamicParameters(uCellPrivateInstance_t *pInstance)
 {
     for (size_t x = 0;
@@ -504,6 +559,7 @@ void uCellPrivateClearDynamicParameters(uCellPrivateInstance_t *pInstance)
         pInstance->rat[x] = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
     }
     uCellPrivateClearRadioParameters(&(pInstance->radioParameters));
+    uCellSecTlsPrivateForget(pInstance->cellHandle);
 }
 
 // Get the current CFUN mode.
@@ -750,13 +806,9 @@ void uCellPrivateScanFree(uCellPrivateNet_t **ppScanResults)
 // Get the module characteristics for a given instance.
 const uCellPrivateModule_t *pUCellPrivateGetModule(uDeviceHandle_t cellHandle)
 {
-    uCellPrivateInstance_t *pInstance = gpUCellPrivateInstanceList;
+    uCellPrivateInstance_t *pInstance = pUCellPrivateGetInstance(cellHandle);
     const uCellPrivateModule_t *pModule = NULL;
 
-    while ((pInstance != NULL) && (pInstance->cellHandle != cellHandle)) {
-        pInstance = pInstance->pNext;
-    }
-
     if (pInstance != NULL) {
         pModule = pInstance->pModule;
     }
@@ -784,6 +836,7 @@ void uCellPrivateC2cRemoveContext(uCellPrivateInstance_t *pInstance)
             memset(pContext->pRx, 0, sizeof(*(pContext->pRx)));
             free(pContext->pRx);
         }
+        uCellSecC2cContextCryptoDelete(pContext);
         // For safety
         memset(pContext, 0, sizeof(*pContext));
         free(pContext);
@@ -800,12 +853,21 @@ void uCellPrivateLocRemoveContext(uCellPrivateInstance_t *pInstance)
         // Free all Wifi APs
         pContext = pInstance->pLocContext;
         if (pContext != NULL) {
+            uCellPrivateLocCleanUpPeriodicTask(pContext);
             uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOC:");
             uAtClientRemoveUrcHandler(pInstance->atHandle, "+UULOCIND:");
+            // Free anyone still waiting for a fix, e.g. the
+            // callbacks of unanswered uCellLocGetStart() calls
+            uCellLocPrivateFreeFixDataStorage(pContext);
             U_PORT_MUTEX_LOCK(pContext->fixDataStorageMutex);
+            free(pContext->pCache);
+            pContext->pCache = NULL;
             U_PORT_MUTEX_UNLOCK(pContext->fixDataStorageMutex);
             uPortMutexDelete(pContext->fixDataStorageMutex);
             pContext->fixDataStorageMutex = NULL;
+            uCompletionDelete((uCompletion_t *) pContext->pFixCompletion);
+            free(pContext->pFixCompletion);
+            pContext->pFixCompletion = NULL;
         }
         // Free the context
         free(pContext);
@@ -813,6 +875,24 @@ void uCellPrivateLocRemoveContext(uCellPrivateInstance_t *pInstance)
     }
 }
 
+// Stop the periodic location task.
+void uCellPrivateLocCleanUpPeriodicTask(uCellPrivateLocContext_t *pContext)
+{
+    if (pContext->periodicTaskFlags & U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_HAS_RUN) {
+        // Make the periodic task exit if it is running
+        pContext->periodicTaskFlags &= ~(U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING);
+        // Wait for the task to exit
+        U_PORT_MUTEX_LOCK(pContext->periodicMutex);
+        U_PORT_MUTEX_UNLOCK(pContext->periodicMutex);
+        // Free the mutex
+        uPortMutexDelete(pContext->periodicMutex);
+        pContext->periodicMutex = NULL;
+        // Only now clear all of the flags so that it is safe
+        // to start again
+        pContext->periodicTaskFlags = 0;
+    }
+}
+
 // Remove the sleep context for the given instance.
 void uCellPrivateSleepRemoveContext(uCellPrivateInstance_t *pInstance)
 {
@@ -1101,8 +1181,11 @@ int32_t uCellPrivateFileListFirst(const uCellPrivateInstance_t *pInstance,
     if ((pInstance != NULL) && (ppFileListContainer != NULL) && (pFileName != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
         atHandle = pInstance->atHandle;
-        // Do the ULSTFILE thang with the AT interface
-        uAtClientLock(atHandle);
+        // Do the ULSTFILE thang with the AT interface; the list
+        // arrives as a single response, which cannot be broken
+        // into, so the most that can be done is to let anything
+        // more urgent go first
+        uAtClientLockPriority(atHandle, U_AT_CLIENT_LOCK_PRIORITY_LOW);
         uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
         // List files operation
         uAtClientWriteInt(atHandle, 0);
@@ -105,6 +105,18 @@ extern "C" {
 #define U_CELL_PRIVATE_HAS(pModule, feature) \
     ((pModule != NULL) && ((pModule->featuresBitmap) & (1ULL << (int32_t) (feature))))
 
+/** Helper to make sure that cellular instance lock/unlock pairs
+ * are always balanced: locks the instance for cellHandle, see
+ * pUCellPrivateLock(), setting pInstance to point to it, or
+ * NULL if there is no such instance.
+ */
+#define U_CELL_PRIVATE_LOCK(pInstance, cellHandle)   { pInstance = pUCellPrivateLock(cellHandle)
+
+/** Helper to make sure that cellular instance lock/unlock pairs
+ * are always balanced.
+ */
+#define U_CELL_PRIVATE_UNLOCK(pInstance)             } uCellPrivateUnlock(pInstance)
+
 #ifndef U_CELL_PRIVATE_GREETING_STR
 /** A greeting string, a useful indication that the module
  * rebooted underneath us unexpectedly.
@@ -166,6 +178,15 @@ extern "C" {
  */
 #define U_CELL_PRIVATE_VINT_PIN_ON_STATE(pinStates) (int32_t) (((pinStates) >> U_CELL_PRIVATE_VINT_PIN_BIT_ON_STATE) & 1)
 
+/** Flag to indicate that the periodic location task has run.
+ */
+#define U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_HAS_RUN    0x01
+
+/** Flag to indicate that the periodic location task should
+ * continue running.
+ */
+#define U_CELL_PRIVATE_LOC_PERIODIC_TASK_FLAG_KEEP_GOING 0x02
+
 /** Bit mask to get to the bit in pinStates which indicates
  * the "on" (i.e. no power saving) state of the DTR pin when
  * it is used for power saving.
@@ -307,8 +328,29 @@ typedef struct {
                                               to the cellular module should
                                               be used in the fix or not. */
     uPortMutexHandle_t fixDataStorageMutex;  /**< protect manipulation of fix data storage. */
-    void *pFixDataStorage;/**< pointer to data storage used when establishing a fix. */
+    void *pFixDataStorage;/**< pointer to data storage used when establishing a fix,
+                               a list of everyone waiting for the fix in progress. */
     int32_t fixStatus;    /**< status of a location fix. */
+    bool indicationsOn;   /**< true once +ULOCIND has been switched on in the module. */
+    int32_t cacheMaxAgeSeconds; /**< how old the last fix may be and still be returned
+                                     instead of asking for a new one, 0 for never. */
+    void *pCache;         /**< the last fix, protected by fixDataStorageMutex; NULL
+                               if there hasn't been one. */
+    void *pFixCompletion; /**< a uCompletion_t, signalled when the answer to a
+                               fix request arrives. */
+    void (*pPeriodicCallback) (uDeviceHandle_t cellHandle,
+                               int32_t errorCode,
+                               int32_t latitudeX1e7,
+                               int32_t longitudeX1e7,
+                               int32_t altitudeMillimetres,
+                               int32_t radiusMillimetres,
+                               int32_t speedMillimetresPerSecond,
+                               int32_t svs,
+                               int64_t timeUtc); /**< callback for periodic location. */
+    int32_t periodicSeconds; /**< the period of periodic location. */
+    uPortTaskHandle_t periodicTask; /**< handle for the periodic location task. */
+    uPortMutexHandle_t periodicMutex; /**< locked while the periodic location task is running. */
+    volatile uint8_t periodicTaskFlags; /**< flags to synchronise the periodic location task. */
 } uCellPrivateLocContext_t;
 
 /** Type to keep track of the deep sleep state.
@@ -406,6 +448,9 @@ typedef struct uCellPrivateInstance_t {
     bool rebootIsRequired;   /**< Set to true if a reboot of the module is
                                   required, e.g. as a result of a configuration
                                   change. */
+    int32_t bootTimeMs;      /**< How long the module took to boot the last time
+                                  it was powered on, rebooted or reset, -1 if
+                                  not known. */
     bool (*pKeepGoingCallback) (uDeviceHandle_t cellHandle);  /**< Used while connecting. */
     void (*pRegistrationStatusCallback) (uCellNetRegDomain_t, uCellNetStatus_t, void *);
     void *pRegistrationStatusCallbackParameter;
@@ -426,6 +471,12 @@ typedef struct uCellPrivateInstance_t {
     uCellPrivateProfileState_t profileState; /**< To track whether a profile is meant to be active. */
     void *pFotaContext; /**< FOTA context, lodged here as a void * to
                              avoid spreading its types all over. */
+    uPortMutexHandle_t mutex; /**< Serialises use of this instance. */
+    int32_t lockCount; /**< The number of tasks that have locked, or are
+                            waiting to lock, mutex; protected by
+                            gUCellPrivateMutex. */
+    bool removed; /**< Set when the instance has been taken out of the
+                       list and is about to be free'd. */
     struct uCellPrivateInstance_t *pNext;
 } uCellPrivateInstance_t;
 
@@ -446,7 +497,9 @@ extern const size_t gUCellPrivateModuleListSize;
  */
 extern uCellPrivateInstance_t *gpUCellPrivateInstanceList;
 
-/** Mutex to protect the linked list.
+/** Mutex to protect the linked list; each instance has its own
+ * mutex, see pUCellPrivateLock(), so that operations on different
+ * instances may proceed in parallel.
  */
 extern uPortMutexHandle_t gUCellPrivateMutex;
 
@@ -464,14 +517,36 @@ extern uPortMutexHandle_t gUCellPrivateMutex;
  */
 bool uCellPrivateIsNumeric(const char *pBuffer, size_t bufferSize);
 
-/** Find a cellular instance in the list by instance handle.
- * Note: gUCellPrivateMutex should be locked before this is called.
+/** Find a cellular instance by instance handle; this does not
+ * search the list, the instance is found directly from the
+ * device handle.
  *
  * @param cellHandle  the instance handle.
  * @return            a pointer to the instance.
  */
 uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle);
 
+/** Find a cellular instance by instance handle and lock it: any
+ * other task wanting to use the same instance will be blocked until
+ * uCellPrivateUnlock() is called, while other instances remain
+ * available.  Use the helper macros U_CELL_PRIVATE_LOCK() and
+ * U_CELL_PRIVATE_UNLOCK() to be sure that calls are balanced.
+ * If there is no such instance NULL is returned and nothing is
+ * locked.  Note: gUCellPrivateMutex must NOT be locked when this
+ * is called.
+ *
+ * @param cellHandle  the instance handle.
+ * @return            a pointer to the instance, locked, or NULL.
+ */
+uCellPrivateInstance_t *pUCellPrivateLock(uDeviceHandle_t cellHandle);
+
+/** Unlock an instance that was locked with pUCellPrivateLock().
+ *
+ * @param pInstance  a pointer to the instance, may be NULL, in
+ *                   which case this function does nothing.
+ */
+void uCellPrivateUnlock(uCellPrivateInstance_t *pInstance);
+
 /** Set the radio parameters back to defaults.
  *
  * @param pParameters pointer to a radio parameters structure.
@@ -479,8 +554,10 @@ uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle);
 void uCellPrivateClearRadioParameters(uCellPrivateRadioParameters_t *pParameters);
 
 /** Clear the dynamic parameters of an instance, so the network
- * status, the active RAT and the radio parameters.  This should
- * be called when the module is being rebooted or powered off.
+ * status, the active RAT, the radio parameters and any cached
+ * security profiles.  This should be called when the module is
+ * being rebooted or powered off; gUCellPrivateMutex must NOT be
+ * locked.
  *
  * @param pInstance a pointer to the instance.
  */
@@ -512,7 +589,7 @@ void uCellPrivateCFunMode(uCellPrivateInstance_t *pInstance,
                           int32_t mode);
 
 /** Get the IMSI of the SIM.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @param pImsi      a pointer to 15 bytes in which the IMSI
@@ -523,7 +600,7 @@ int32_t uCellPrivateGetImsi(const uCellPrivateInstance_t *pInstance,
                             char *pImsi);
 
 /** Get the IMEI of the module.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @param pImei      a pointer to 15 bytes in which the IMEI
@@ -534,7 +611,7 @@ int32_t uCellPrivateGetImei(const uCellPrivateInstance_t *pInstance,
                             char *pImei);
 
 /** Get whether the given instance is registered with the network.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @return           true if it is registered, else false.
@@ -552,7 +629,7 @@ uCellNetRat_t uCellPrivateModuleRatToCellRat(uCellModuleType_t moduleType,
                                              int32_t moduleRat);
 
 /** Get the active RAT.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @return           the active RAT.
@@ -595,21 +672,29 @@ void uCellPrivateScanFree(uCellPrivateNet_t **ppScanResults);
 const uCellPrivateModule_t *pUCellPrivateGetModule(uDeviceHandle_t cellHandle);
 
 /** Remove the chip to chip security context for the given instance.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
 void uCellPrivateC2cRemoveContext(uCellPrivateInstance_t *pInstance);
 
 /** Remove the location context for the given instance.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
 void uCellPrivateLocRemoveContext(uCellPrivateInstance_t *pInstance);
 
+/** Stop the periodic location task, if it is running, and wait
+ * for it to exit.
+ * Note: the instance should be locked before this is called.
+ *
+ * @param pContext   a pointer to the location context.
+ */
+void uCellPrivateLocCleanUpPeriodicTask(uCellPrivateLocContext_t *pContext);
+
 /** Remove the sleep context for the given instance.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
@@ -663,7 +748,7 @@ int32_t uCellPrivateWakeUpCallback(uAtClientHandle_t atHandle,
  * RATs.  Something like that anyway.  This should be called after
  * power-on and after a RAT change; it doesn't talk to the module,
  * simply works on the current state of the module as known to this code.
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance a pointer to the cellular instance.
  */
@@ -706,7 +791,7 @@ int32_t uCellPrivateResumeUartPowerSaving(const uCellPrivateInstance_t *pInstanc
 /** Delete a file from the file system. If the file does not exist an
  * error will be returned.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance      a pointer to the cellular instance.
  * @param[in] pFileName  a pointer to the file name to delete from the
@@ -721,7 +806,7 @@ int32_t uCellPrivateFileDelete(const uCellPrivateInstance_t *pInstance,
  * uCellPrivateFileListNext() should be called repeatedly to iterate
  * through subsequent entries in the list.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked before this is called.
  *
  * @param pInstance           a pointer to the cellular instance.
  * @param ppFileListContainer a pointer to a place to store the pointer
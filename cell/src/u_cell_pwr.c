@@ -65,6 +65,21 @@
  */
 #define U_CELL_PWR_IS_ALIVE_ATTEMPTS_POWER_ON 10
 
+#ifndef U_CELL_PWR_BOOT_PROBE_TIMEOUT_MS
+/** The AT response time-out to use when probing a module to find
+ * out whether it has finished booting; short so that a module
+ * which is still booting is asked again promptly.
+ */
+# define U_CELL_PWR_BOOT_PROBE_TIMEOUT_MS 250
+#endif
+
+#ifndef U_CELL_PWR_BOOT_PROBE_INTERVAL_MS
+/** The interval between probes, or between checks of VInt, while
+ * waiting for a module to boot.
+ */
+# define U_CELL_PWR_BOOT_PROBE_INTERVAL_MS 100
+#endif
+
 /** The number of time to try a configuration AT command by default.
  */
 #define U_CELL_PWR_CONFIGURATION_COMMAND_TRIES 3
@@ -850,12 +865,32 @@ static void UUPSMR_urc(uAtClientHandle_t atHandle, void *pParameter)
  * STATIC FUNCTIONS: POWERING UP/DOWN
  * -------------------------------------------------------------- */
 
+// Poke the cellular module once with "AT", waiting up to timeoutMs
+// for a response.
+static bool moduleRespondsToAt(const uCellPrivateInstance_t *pInstance,
+                               int32_t timeoutMs)
+{
+    uAtClientDeviceError_t deviceError;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+
+    // The response can be "OK" or it can also be "CMS/CMS ERROR"
+    // if the modem happened to be awake and in the middle
+    // of something from a previous command.
+    uAtClientLock(atHandle);
+    uAtClientTimeoutSet(atHandle, timeoutMs);
+    uAtClientCommandStart(atHandle, "AT");
+    uAtClientCommandStopReadResponse(atHandle);
+    uAtClientDeviceErrorGet(atHandle, &deviceError);
+
+    return (uAtClientUnlock(atHandle) == 0) ||
+           (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR);
+}
+
 // Check that the cellular module is alive.
 static int32_t moduleIsAlive(uCellPrivateInstance_t *pInstance,
                              int32_t attempts)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
-    uAtClientDeviceError_t deviceError;
     uAtClientHandle_t atHandle = pInstance->atHandle;
     bool isAlive = false;
 
@@ -873,18 +908,9 @@ static int32_t moduleIsAlive(uCellPrivateInstance_t *pInstance,
     } else {
         // See if the cellular module is responding at the AT interface
         // by poking it with "AT" up to "attempts" times.
-        // The response can be "OK" or it can also be "CMS/CMS ERROR"
-        // if the modem happened to be awake and in the middle
-        // of something from a previous command.
         for (int32_t x = 0; !isAlive && (x < attempts); x++) {
-            uAtClientLock(atHandle);
-            uAtClientTimeoutSet(atHandle,
-                                pInstance->pModule->responseMaxWaitMs);
-            uAtClientCommandStart(atHandle, "AT");
-            uAtClientCommandStopReadResponse(atHandle);
-            uAtClientDeviceErrorGet(atHandle, &deviceError);
-            isAlive = (uAtClientUnlock(atHandle) == 0) ||
-                      (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR);
+            isAlive = moduleRespondsToAt(pInstance,
+                                         pInstance->pModule->responseMaxWaitMs);
         }
     }
 
@@ -1105,6 +1131,53 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
     return errorCode;
 }
 
+// Wait for the cellular module to boot, for at most waitMs.  If
+// goesDown is true the module has been commanded to reboot and
+// so may still be responding; in that case wait for it to stop
+// responding first.  Then wait for VInt, if connected, to show
+// that the module is on and probe it with "AT" until it responds.
+// No probe is allowed to run beyond waitMs.
+static void waitForBoot(const uCellPrivateInstance_t *pInstance,
+                        int32_t waitMs, bool goesDown,
+                        bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    int32_t remainingMs = waitMs;
+    int32_t probeTimeoutMs;
+    bool isUp = false;
+
+    while (!isUp && (remainingMs > 0) &&
+           ((pKeepGoingCallback == NULL) || pKeepGoingCallback(pInstance->cellHandle))) {
+        probeTimeoutMs = U_CELL_PWR_BOOT_PROBE_TIMEOUT_MS;
+        if (probeTimeoutMs > remainingMs) {
+            probeTimeoutMs = remainingMs;
+        }
+        if (goesDown) {
+            goesDown = moduleRespondsToAt(pInstance, probeTimeoutMs);
+        } else if ((pInstance->pinVInt < 0) ||
+                   (uPortGpioGet(pInstance->pinVInt) ==
+                    U_CELL_PRIVATE_VINT_PIN_ON_STATE(pInstance->pinStates))) {
+            isUp = moduleRespondsToAt(pInstance, probeTimeoutMs);
+        }
+        remainingMs = waitMs - (uPortGetTickTimeMs() - startTimeMs);
+        if (!isUp && (remainingMs > 0)) {
+            uPortTaskBlock(remainingMs < U_CELL_PWR_BOOT_PROBE_INTERVAL_MS ?
+                           remainingMs : U_CELL_PWR_BOOT_PROBE_INTERVAL_MS);
+            remainingMs = waitMs - (uPortGetTickTimeMs() - startTimeMs);
+        }
+    }
+}
+
+// Record how long the cellular module took to boot, from
+// startTimeMs until now.
+static void bootTimeSet(uCellPrivateInstance_t *pInstance,
+                        int32_t startTimeMs)
+{
+    pInstance->bootTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    uPortLog("U_CELL_PWR: module took %d ms to boot.\n",
+             pInstance->bootTimeMs);
+}
+
 // Wait for power off to complete
 static void waitForPowerOff(uCellPrivateInstance_t *pInstance,
                             bool (*pKeepGoingCallback) (uDeviceHandle_t))
@@ -1142,7 +1215,7 @@ static void waitForPowerOff(uCellPrivateInstance_t *pInstance,
 }
 
 // Power the cellular module off.
-// Note: gUCellPrivateMutex must be locked before this is called
+// Note: the instance must be locked before this is called
 static int32_t powerOff(uCellPrivateInstance_t *pInstance,
                         bool (*pKeepGoingCallback) (uDeviceHandle_t))
 {
@@ -1191,7 +1264,7 @@ static int32_t powerOff(uCellPrivateInstance_t *pInstance,
 // Do a quick power off, used for recovery situations only.
 // IMPORTANT: this won't work if a SIM PIN needs
 // to be entered at a power cycle
-// Note: gUCellPrivateMutex must be locked before this is called
+// Note: the instance must be locked before this is called
 static void quickPowerOff(uCellPrivateInstance_t *pInstance,
                           bool (*pKeepGoingCallback) (uDeviceHandle_t))
 {
@@ -1236,6 +1309,7 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
     int32_t platformError = 0;
     int32_t enablePowerAtStart = 1;
+    int32_t bootStartTimeMs;
     bool asleepAtStart = (pInstance->deepSleepState == U_CELL_PRIVATE_DEEP_SLEEP_STATE_ASLEEP);
     uDeviceHandle_t cellHandle = pInstance->cellHandle;
     uCellPrivateSleep_t *pSleepContext = pInstance->pSleepContext;
@@ -1316,15 +1390,20 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
                     }
                 }
             }
-            // Cellular module should be up, see if it's there
-            // and, if so, configure it
-            for (size_t y = U_CELL_PWR_IS_ALIVE_ATTEMPTS_POWER_ON;
-                 (y > 0) && (errorCode != 0) &&
-                 ((pKeepGoingCallback == NULL) || pKeepGoingCallback(cellHandle));
-                 y--) {
+            // Cellular module should be up or on its way: probe it
+            // quickly, for no longer than all but one of the
+            // U_CELL_PWR_IS_ALIVE_ATTEMPTS_POWER_ON full-length
+            // attempts would have taken, then make the last attempt
+            // to see if it's there and, if so, configure it
+            bootStartTimeMs = uPortGetTickTimeMs();
+            waitForBoot(pInstance, (U_CELL_PWR_IS_ALIVE_ATTEMPTS_POWER_ON - 1) *
+                        pInstance->pModule->responseMaxWaitMs,
+                        false, pKeepGoingCallback);
+            if ((pKeepGoingCallback == NULL) || pKeepGoingCallback(cellHandle)) {
                 errorCode = moduleIsAlive(pInstance, 1);
             }
             if (errorCode == 0) {
+                bootTimeSet(pInstance, bootStartTimeMs);
                 // Configure the module, only putting into radio-off
                 // mode if we weren't already registered at the start
                 // (e.g. we might have been in 3GPP sleep, which retains
@@ -1674,9 +1753,8 @@ bool uCellPwrIsPowered(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             isPowered = true;
             if (pInstance->pinEnablePower >= 0) {
@@ -1685,7 +1763,7 @@ bool uCellPwrIsPowered(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
 
     }
 
@@ -1700,14 +1778,13 @@ bool uCellPwrIsAlive(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             isAlive = (moduleIsAlive(pInstance, 1) == 0);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isAlive;
@@ -1722,9 +1799,8 @@ int32_t uCellPwrOn(uDeviceHandle_t cellHandle, const char *pSimPinCode,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_CELL_ERROR_PIN_ENTRY_NOT_SUPPORTED;
@@ -1736,7 +1812,7 @@ int32_t uCellPwrOn(uDeviceHandle_t cellHandle, const char *pSimPinCode,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1751,15 +1827,14 @@ int32_t uCellPwrOff(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = powerOff(pInstance, pKeepGoingCallback);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
 
     }
 
@@ -1776,9 +1851,8 @@ int32_t uCellPwrOffHard(uDeviceHandle_t cellHandle, bool trulyHard,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1830,7 +1904,7 @@ int32_t uCellPwrOffHard(uDeviceHandle_t cellHandle, bool trulyHard,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -1845,14 +1919,13 @@ bool uCellPwrRebootIsRequired(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             rebootIsRequired = pInstance->rebootIsRequired;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return rebootIsRequired;
@@ -1866,13 +1939,13 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
+    int32_t bootStartTimeMs;
     bool success = false;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1903,8 +1976,10 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
                 uCellPrivateC2cRemoveContext(pInstance);
                 // We have rebooted
                 pInstance->rebootIsRequired = false;
-                // Wait for the module to boot
-                uPortTaskBlock(pInstance->pModule->rebootCommandWaitSeconds * 1000);
+                // Wait for the module to go down and boot again
+                bootStartTimeMs = uPortGetTickTimeMs();
+                waitForBoot(pInstance, pInstance->pModule->rebootCommandWaitSeconds * 1000,
+                            true, pKeepGoingCallback);
                 // Two goes at this with a power-off inbetween,
                 // 'cos I've seen some modules
                 // fail during initial configuration.
@@ -1921,6 +1996,7 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
                     errorCode = moduleIsAlive(pInstance,
                                               U_CELL_PWR_IS_ALIVE_ATTEMPTS_POWER_ON);
                     if (errorCode == 0) {
+                        bootTimeSet(pInstance, bootStartTimeMs);
                         // Sleep is no longer available
                         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
                         // Configure the module
@@ -1968,14 +2044,16 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
                             uPortTaskBlock(pInstance->pModule->powerOnPullMs);
                             uPortGpioSet(pInstance->pinPwrOn,
                                          (int32_t) !U_CELL_PRIVATE_PWR_ON_PIN_TOGGLE_TO_STATE(pInstance->pinStates));
-                            uPortTaskBlock(pInstance->pModule->bootWaitSeconds * 1000);
+                            bootStartTimeMs = uPortGetTickTimeMs();
+                            waitForBoot(pInstance, pInstance->pModule->bootWaitSeconds * 1000,
+                                        false, pKeepGoingCallback);
                         }
                     }
                 }
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2015,16 +2093,14 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pinReset >= 0)) {
             errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
             resetHoldMilliseconds = pInstance->pModule->resetHoldMilliseconds;
             uPortLog("U_CELL_PWR: performing hard reset, this will take"
-                     " at least %d milliseconds...\n", resetHoldMilliseconds +
-                     (pInstance->pModule->rebootCommandWaitSeconds * 1000));
+                     " at least %d milliseconds...\n", resetHoldMilliseconds);
             // Sleep is no longer available
             pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
             // Set the RESET pin to the "reset" state
@@ -2051,7 +2127,9 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
                     // nothing we can do about it anyway
                     uPortGpioSet(pinReset, (int32_t) !U_CELL_RESET_PIN_TOGGLE_TO_STATE);
                     // Wait for the module to boot
-                    uPortTaskBlock(pInstance->pModule->rebootCommandWaitSeconds * 1000);
+                    startTime = uPortGetTickTimeMs();
+                    waitForBoot(pInstance, pInstance->pModule->rebootCommandWaitSeconds * 1000,
+                                false, NULL);
                     if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
                         // SARA-R5 chucks out a load of stuff after
                         // boot in its development version: flush it away
@@ -2062,6 +2140,7 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
                     errorCode = moduleIsAlive(pInstance,
                                               U_CELL_PWR_IS_ALIVE_ATTEMPTS_POWER_ON);
                     if (errorCode == 0) {
+                        bootTimeSet(pInstance, (int32_t) startTime);
                         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNKNOWN;
                         // Configure the module
                         errorCode = moduleConfigure(pInstance, true, false);
@@ -2078,12 +2157,36 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
 }
 
+// Get the time the module took to boot.
+int32_t uCellPwrGetBootTimeMs(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCodeOrTimeMs = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
+
+        errorCodeOrTimeMs = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            errorCodeOrTimeMs = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (pInstance->bootTimeMs >= 0) {
+                errorCodeOrTimeMs = pInstance->bootTimeMs;
+            }
+        }
+
+        U_CELL_PRIVATE_UNLOCK(pInstance);
+    }
+
+    return errorCodeOrTimeMs;
+}
+
 // Set the DTR power-saving pin.
 int32_t uCellPwrSetDtrPowerSavingPin(uDeviceHandle_t cellHandle, int32_t pin)
 {
@@ -2097,9 +2200,8 @@ int32_t uCellPwrSetDtrPowerSavingPin(uDeviceHandle_t cellHandle, int32_t pin)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL) && (pin >= 0)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2129,7 +2231,7 @@ int32_t uCellPwrSetDtrPowerSavingPin(uDeviceHandle_t cellHandle, int32_t pin)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
 
     }
 
@@ -2144,9 +2246,8 @@ int32_t uCellPwrGetDtrPowerSavingPin(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrPin = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrPin = (int32_t) U_ERROR_COMMON_NOT_FOUND;
@@ -2155,7 +2256,7 @@ int32_t uCellPwrGetDtrPowerSavingPin(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrPin;
@@ -2179,9 +2280,8 @@ int32_t  uCellPwrSetRequested3gppPowerSaving(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL) &&
             (!onNotOff ||
@@ -2259,7 +2359,7 @@ int32_t  uCellPwrSetRequested3gppPowerSaving(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2279,9 +2379,8 @@ int32_t uCellPwrGetRequested3gppPowerSaving(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2308,7 +2407,7 @@ int32_t uCellPwrGetRequested3gppPowerSaving(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2328,9 +2427,8 @@ int32_t uCellPwrGet3gppPowerSaving(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2357,7 +2455,7 @@ int32_t uCellPwrGet3gppPowerSaving(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2378,9 +2476,8 @@ int32_t uCellPwrSet3gppPowerSavingCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2397,7 +2494,7 @@ int32_t uCellPwrSet3gppPowerSavingCallback(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2418,9 +2515,8 @@ int32_t uCellPwrSetRequestedEDrx(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL) &&
             // Cast in two stages to keep Lint happy
@@ -2513,7 +2609,7 @@ int32_t uCellPwrSetRequestedEDrx(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2531,9 +2627,8 @@ int32_t uCellPwrGetRequestedEDrx(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = uCellPwrPrivateGetEDrx(pInstance, false, rat,
@@ -2541,7 +2636,7 @@ int32_t uCellPwrGetRequestedEDrx(uDeviceHandle_t cellHandle,
                                                pPagingWindowSeconds);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2559,9 +2654,8 @@ int32_t uCellPwrGetEDrx(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = uCellPwrPrivateGetEDrx(pInstance, true, rat,
@@ -2569,7 +2663,7 @@ int32_t uCellPwrGetEDrx(uDeviceHandle_t cellHandle,
                                                pPagingWindowSeconds);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2591,9 +2685,8 @@ int32_t uCellPwrSetEDrxCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2617,7 +2710,7 @@ int32_t uCellPwrSetEDrxCallback(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2634,9 +2727,8 @@ int32_t uCellPwrSetDeepSleepWakeUpCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2659,7 +2751,7 @@ int32_t uCellPwrSetDeepSleepWakeUpCallback(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2673,9 +2765,8 @@ int32_t uCellPwrGetDeepSleepActive(uDeviceHandle_t cellHandle, bool *pSleepActiv
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -2688,7 +2779,7 @@ int32_t uCellPwrGetDeepSleepActive(uDeviceHandle_t cellHandle, bool *pSleepActiv
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2711,9 +2802,8 @@ int32_t uCellPwrDisableUartSleep(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             pUartSleepCache = &(pInstance->uartSleepCache);
             // If a wake-up handler has been set then the module supports
@@ -2750,7 +2840,7 @@ int32_t uCellPwrDisableUartSleep(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2766,9 +2856,8 @@ int32_t uCellPwrEnableUartSleep(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             pUartSleepCache = &(pInstance->uartSleepCache);
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2811,7 +2900,7 @@ int32_t uCellPwrEnableUartSleep(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -2826,14 +2915,13 @@ bool uCellPwrUartSleepIsEnabled(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (pInstance->pModule != NULL)) {
             isEnabled = uAtClientWakeUpHandlerIsSet(pInstance->atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isEnabled;
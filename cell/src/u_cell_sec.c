@@ -179,9 +179,8 @@ static int32_t ztpGet(uDeviceHandle_t cellHandle, int32_t type,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -213,7 +212,7 @@ static int32_t ztpGet(uDeviceHandle_t cellHandle, int32_t type,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -244,6 +243,7 @@ static size_t encryptC2cConfirmationTag(const char *pC2cConfirmationTagHex,
 {
     size_t length = 0;
     char ivOrMac[U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES];
+    uPortCryptoContextHandle_t hmacContext = NULL;
     // *INDENT-OFF* (otherwise AStyle makes a mess of this)
     char c2cConfirmationTagPadded[U_SECURITY_C2C_CONFIRMATION_TAG_LENGTH_BYTES +
                                   U_CELL_SEC_C2C_MAX_PAD_LENGTH_BYTES];
@@ -287,34 +287,97 @@ static size_t encryptC2cConfirmationTag(const char *pC2cConfirmationTagHex,
                                     pOutputBuffer + U_CELL_SEC_C2C_IV_LENGTH_BYTES) == 0) {
         length += sizeof(c2cConfirmationTagPadded);
         // Next we need to create a HMAC tag across the
-        // IV, the encrypted text and the TE Secret.
-        // The simplest way to do this is to copy
-        // the TE Secret into the output buffer, perform
-        // the calculation (putting the result into the
-        // local variable ivOrMac) and then we overwrite
-        // where it is in the buffer with the truncated MAC
-        // (which is at least as big, as checked with
-        // a #error above)
-        memcpy(pOutputBuffer + length, pTeSecret, U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES);
+        // IV, the encrypted text and the TE Secret,
+        // putting the result into the local variable ivOrMac;
+        // feeding the TE Secret in separately means that
+        // it never has to be written to the output buffer
         // NOLINTNEXTLINE(readability-suspicious-call-argument)
-        if (uPortCryptoHmacSha256(pHMacKey,
-                                  U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES,
-                                  pOutputBuffer,
-                                  length + U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES,
-                                  ivOrMac) == 0) {
-            // Now copy the first 16 bytes of the
-            // generated HMAC tag into the output,
-            // overwriting the TE Secret
-            memcpy(pOutputBuffer + length, ivOrMac,
-                   U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES);
-            // Account for its length
-            length += U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES;
+        if (uPortCryptoHmacSha256ContextCreate(&hmacContext, pHMacKey,
+                                               U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES) == 0) {
+            if ((uPortCryptoHmacSha256ContextUpdate(hmacContext, pOutputBuffer,
+                                                    length) == 0) &&
+                (uPortCryptoHmacSha256ContextUpdate(hmacContext, pTeSecret,
+                                                    U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES) == 0) &&
+                (uPortCryptoHmacSha256ContextFinish(hmacContext, ivOrMac) == 0)) {
+                // Now copy the first 16 bytes of the
+                // generated HMAC tag into the output
+                memcpy(pOutputBuffer + length, ivOrMac,
+                       U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES);
+                // Account for its length
+                length += U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES;
+            }
+            uPortCryptoHmacSha256ContextDelete(hmacContext);
         }
     }
 
     return length;
 }
 
+// Send a block of data to the module for end to end encryption;
+// the AT client must be locked, the encrypted result should be
+// read with e2eEncryptReceive().
+static void e2eEncryptSend(uAtClientHandle_t atHandle,
+                           const char *pData, size_t dataSizeBytes)
+{
+    uAtClientTimeoutSet(atHandle,
+                        U_CELL_SEC_TRANSACTION_TIMEOUT_SECONDS * 1000);
+    uAtClientCommandStart(atHandle, "AT+USECE2EDATAENC=");
+    uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
+    uAtClientCommandStop(atHandle);
+    // Wait for the prompt
+    if (uAtClientWaitCharacter(atHandle, '>') == 0) {
+        // Wait for it...
+        uPortTaskBlock(50);
+        // Go!
+        uAtClientWriteBytes(atHandle, pData, dataSizeBytes, true);
+    }
+}
+
+// Read the response to e2eEncryptSend(), returning the number
+// of encrypted bytes written to pData or negative error code;
+// any encrypted data beyond dataSizeBytes is thrown away.  The
+// AT client must be locked; it is left locked.
+static int32_t e2eEncryptReceive(uAtClientHandle_t atHandle,
+                                 char *pData, size_t dataSizeBytes)
+{
+    int32_t errorCodeOrSize;
+    int32_t sizeOutBytes;
+
+    errorCodeOrSize = uAtClientErrorGet(atHandle);
+    if (errorCodeOrSize == 0) {
+        // Grab the response
+        uAtClientResponseStart(atHandle, "+USECE2EDATAENC:");
+        // Read the length of the response
+        sizeOutBytes = uAtClientReadInt(atHandle);
+        if (sizeOutBytes > 0) {
+            // Don't stop for anything!
+            uAtClientIgnoreStopTag(atHandle);
+            // Get the leading quote mark out of the way
+            uAtClientReadBytes(atHandle, NULL, 1, true);
+            // Now read out all the actual data
+            if ((size_t) sizeOutBytes > dataSizeBytes) {
+                uAtClientReadBytes(atHandle, pData, dataSizeBytes, true);
+                uAtClientReadBytes(atHandle, NULL,
+                                   sizeOutBytes - dataSizeBytes, true);
+                sizeOutBytes = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            } else {
+                uAtClientReadBytes(atHandle, pData, sizeOutBytes, true);
+            }
+        }
+        // Make sure to wait for the top tag before
+        // we finish
+        uAtClientRestoreStopTag(atHandle);
+        uAtClientResponseStop(atHandle);
+        errorCodeOrSize = uAtClientErrorGet(atHandle);
+        if (errorCodeOrSize == 0) {
+            // All good
+            errorCodeOrSize = sizeOutBytes;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INFORMATION
  * -------------------------------------------------------------- */
@@ -327,9 +390,8 @@ bool uCellSecIsSupported(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             // No need to contact the module, this is something
             // we know in advance for a given module type
@@ -337,7 +399,7 @@ bool uCellSecIsSupported(uDeviceHandle_t cellHandle)
                                              U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isSupported;
@@ -354,9 +416,8 @@ bool uCellSecIsBootstrapped(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
@@ -389,7 +450,7 @@ bool uCellSecIsBootstrapped(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isBootstrapped;
@@ -427,10 +488,9 @@ int32_t uCellSecGetRootOfTrustUid(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
         if (pRootOfTrustUid != NULL) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
             errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
             if (pInstance != NULL) {
                 errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -464,7 +524,7 @@ int32_t uCellSecGetRootOfTrustUid(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -491,9 +551,8 @@ int32_t uCellSecC2cPair(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pTESecret != NULL) &&
             (pKey != NULL) && (pHMac != NULL)) {
@@ -626,7 +685,7 @@ int32_t uCellSecC2cPair(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -646,9 +705,8 @@ int32_t uCellSecC2cOpen(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pTESecret != NULL) &&
             (pKey != NULL) && (pHMacKey != NULL)) {
@@ -697,6 +755,11 @@ int32_t uCellSecC2cOpen(uDeviceHandle_t cellHandle,
                                          (x > 0) && !pContext->isV2; x--) {
                                         pContext->isV2 = (pContext->hmacKey[x] != 0);
                                     }
+                                    // Expand the keys once, here, rather than
+                                    // for every frame; if this fails the
+                                    // intercept functions will do it the
+                                    // slow way
+                                    uCellSecC2cContextCryptoCreate(pContext);
                                     // Hook the intercept functions into the AT handler
                                     uAtClientStreamInterceptTx(atHandle, pUCellSecC2cInterceptTx,
                                                                (void *) pContext);
@@ -717,7 +780,7 @@ int32_t uCellSecC2cOpen(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -732,9 +795,8 @@ int32_t uCellSecC2cClose(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -762,7 +824,7 @@ int32_t uCellSecC2cClose(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -784,9 +846,8 @@ int32_t uCellSecSealSet(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pDeviceProfileUid != NULL) &&
             (pDeviceSerialNumberStr != NULL)) {
@@ -817,7 +878,7 @@ int32_t uCellSecSealSet(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -831,9 +892,8 @@ bool uCellSecIsSealed(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
@@ -841,7 +901,7 @@ bool uCellSecIsSealed(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return isSealed;
@@ -888,10 +948,9 @@ int32_t uCellSecE2eSetVersion(uDeviceHandle_t cellHandle, int32_t version)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if ((pInstance != NULL) && (version > 0)) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -908,7 +967,7 @@ int32_t uCellSecE2eSetVersion(uDeviceHandle_t cellHandle, int32_t version)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
@@ -924,10 +983,9 @@ int32_t uCellSecE2eGetVersion(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
         errorCodeOrVersion = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrVersion = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -952,7 +1010,7 @@ int32_t uCellSecE2eGetVersion(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrVersion;
@@ -971,11 +1029,10 @@ int32_t uCellSecE2eEncrypt(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pDataIn != NULL) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
             if (pInstance != NULL) {
                 errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
                 if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -986,49 +1043,135 @@ int32_t uCellSecE2eEncrypt(uDeviceHandle_t cellHandle,
                     } else {
                         atHandle = pInstance->atHandle;
                         uAtClientLock(atHandle);
-                        uAtClientTimeoutSet(atHandle,
-                                            U_CELL_SEC_TRANSACTION_TIMEOUT_SECONDS * 1000);
-                        uAtClientCommandStart(atHandle, "AT+USECE2EDATAENC=");
-                        uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
-                        uAtClientCommandStop(atHandle);
-                        // Wait for the prompt
-                        if (uAtClientWaitCharacter(atHandle, '>') == 0) {
-                            // Wait for it...
-                            uPortTaskBlock(50);
-                            // Go!
-                            uAtClientWriteBytes(atHandle, (const char *) pDataIn,
-                                                dataSizeBytes, true);
-                            // Grab the response
-                            uAtClientResponseStart(atHandle, "+USECE2EDATAENC:");
-                            // Read the length of the response
-                            sizeOutBytes = uAtClientReadInt(atHandle);
-                            if (sizeOutBytes > 0) {
-                                // Don't stop for anything!
-                                uAtClientIgnoreStopTag(atHandle);
-                                // Get the leading quote mark out of the way
-                                uAtClientReadBytes(atHandle, NULL, 1, true);
-                                // Now read out all the actual data
-                                uAtClientReadBytes(atHandle, (char *) pDataOut,
-                                                   sizeOutBytes, true);
-                            }
-                            // Make sure to wait for the top tag before
-                            // we finish
-                            uAtClientRestoreStopTag(atHandle);
-                            uAtClientResponseStop(atHandle);
-                            errorCodeOrSize = uAtClientUnlock(atHandle);
-                            if (errorCodeOrSize == 0) {
-                                // All good
-                                errorCodeOrSize = sizeOutBytes;
-                            }
-                        } else {
-                            errorCodeOrSize = uAtClientUnlock(atHandle);
+                        e2eEncryptSend(atHandle, (const char *) pDataIn,
+                                       dataSizeBytes);
+                        // pDataOut is, by contract, big enough
+                        sizeOutBytes = e2eEncryptReceive(atHandle, (char *) pDataOut,
+                                                         INT_MAX);
+                        errorCodeOrSize = uAtClientUnlock(atHandle);
+                        if (errorCodeOrSize == 0) {
+                            // All good
+                            errorCodeOrSize = sizeOutBytes;
                         }
                     }
                 }
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
+    }
+
+    return errorCodeOrSize;
+}
+
+// Encrypt a stream of data, block by block.
+int32_t uCellSecE2eEncryptStream(uDeviceHandle_t cellHandle,
+                                 int32_t (*pSourceCallback) (uDeviceHandle_t,
+                                                             char *,
+                                                             size_t,
+                                                             void *),
+                                 int32_t (*pSinkCallback) (uDeviceHandle_t,
+                                                           const char *,
+                                                           size_t,
+                                                           void *),
+                                 void *pCallbackParam,
+                                 size_t blockSizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    uAtClientHandle_t atHandle;
+    char *pBuffer = NULL;
+    char *pIn[2];
+    char *pOut;
+    int32_t inSizeBytes[2] = {0};
+    size_t x = 0;
+    int32_t sizeOutBytes = 0;
+    int32_t totalSizeBytes = 0;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
+
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (blockSizeBytes == 0) {
+            blockSizeBytes = U_SECURITY_E2E_STREAM_BLOCK_LENGTH_BYTES;
+        }
+        if ((pInstance != NULL) && (pSourceCallback != NULL) && (pSinkCallback != NULL)) {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                   U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
+                // Two input buffers, so that the next block can be
+                // obtained from the source while the module is
+                // encrypting the current one, plus one output buffer
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pBuffer = (char *) malloc((blockSizeBytes * 3) +
+                                          U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES);
+            }
+        }
+
+        U_CELL_PRIVATE_UNLOCK(pInstance);
+
+        if (pBuffer != NULL) {
+            pIn[0] = pBuffer;
+            pIn[1] = pBuffer + blockSizeBytes;
+            pOut = pBuffer + (blockSizeBytes * 2);
+            // Get the first block
+            inSizeBytes[x] = pSourceCallback(cellHandle, pIn[x],
+                                             blockSizeBytes,
+                                             pCallbackParam);
+            errorCodeOrSize = 0;
+            while ((inSizeBytes[x] > 0) && (errorCodeOrSize == 0)) {
+                if (inSizeBytes[x] > (int32_t) blockSizeBytes) {
+                    inSizeBytes[x] = (int32_t) blockSizeBytes;
+                }
+                // The instance may have gone while we weren't looking
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+                U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
+
+                if (pInstance != NULL) {
+                    atHandle = pInstance->atHandle;
+                    uAtClientLock(atHandle);
+                    e2eEncryptSend(atHandle, pIn[x], inSizeBytes[x]);
+                    // While the module is busy, get the next block
+                    inSizeBytes[x ^ 1] = pSourceCallback(cellHandle, pIn[x ^ 1],
+                                                         blockSizeBytes,
+                                                         pCallbackParam);
+                    sizeOutBytes = e2eEncryptReceive(atHandle, pOut,
+                                                     blockSizeBytes +
+                                                     U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES);
+                    errorCodeOrSize = uAtClientUnlock(atHandle);
+                    if ((errorCodeOrSize == 0) && (sizeOutBytes < 0)) {
+                        errorCodeOrSize = sizeOutBytes;
+                    }
+                }
+
+                U_CELL_PRIVATE_UNLOCK(pInstance);
+
+                if (errorCodeOrSize == 0) {
+                    // Pass the encrypted block to the sink outside
+                    // of any lock
+                    errorCodeOrSize = pSinkCallback(cellHandle, pOut,
+                                                    sizeOutBytes,
+                                                    pCallbackParam);
+                    if (errorCodeOrSize >= 0) {
+                        totalSizeBytes += sizeOutBytes;
+                        errorCodeOrSize = 0;
+                    }
+                }
+                x ^= 1;
+            }
+            if ((errorCodeOrSize == 0) && (inSizeBytes[x] < 0)) {
+                // The source gave up, return its error code
+                errorCodeOrSize = inSizeBytes[x];
+            }
+            if (errorCodeOrSize == 0) {
+                errorCodeOrSize = totalSizeBytes;
+            }
+
+            // Free memory
+            free(pBuffer);
+        }
     }
 
     return errorCodeOrSize;
@@ -1052,9 +1195,8 @@ int32_t uCellSecPskGenerate(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pPsk != NULL) && (pPskId != NULL) &&
             ((pskSizeBytes == 16) || (pskSizeBytes == 32))) {
@@ -1097,7 +1239,7 @@ int32_t uCellSecPskGenerate(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCodeOrSize;
@@ -1116,9 +1258,8 @@ int32_t uCellSecHeartbeatTrigger(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -1134,7 +1275,7 @@ int32_t uCellSecHeartbeatTrigger(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return errorCode;
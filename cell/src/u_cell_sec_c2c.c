@@ -39,6 +39,7 @@
 
 #include "u_cfg_sw.h"
 #include "u_compiler.h" // for U_WEAK
+#include "u_error_common.h"
 
 #include "u_port_clib_platform_specific.h" // rand()
 #include "u_port_debug.h"
@@ -76,12 +77,6 @@
 # error U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES must be at least as big as U_CELL_SEC_C2C_IV_LENGTH_BYTES since we size a local array below on U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES and it is used for both.
 #endif
 
-// Check that U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES is at least as
-// big as U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES
-#if U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES > U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES
-# error U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES must be at least as big as U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES since a TE secret is temporarily written to the space a truncated MAC would occupy during V2 encoding.
-#endif
-
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -262,6 +257,82 @@ void printBlock(const char *pStr, size_t length,
 }
 #endif
 
+// AES 128 CBC encrypt, using the context if there is one.
+static int32_t aesEncrypt(const uCellSecC2cContext_t *pContext,
+                          char *pInitVector, const char *pInput,
+                          size_t lengthBytes, char *pOutput)
+{
+    int32_t errorCode;
+
+    if (pContext->aesContext != NULL) {
+        errorCode = uPortCryptoAes128CbcContextEncrypt(pContext->aesContext,
+                                                       pInitVector, pInput,
+                                                       lengthBytes, pOutput);
+    } else {
+        errorCode = uPortCryptoAes128CbcEncrypt(pContext->key,
+                                                sizeof(pContext->key),
+                                                pInitVector, pInput,
+                                                lengthBytes, pOutput);
+    }
+
+    return errorCode;
+}
+
+// AES 128 CBC decrypt, using the context if there is one.
+static int32_t aesDecrypt(const uCellSecC2cContext_t *pContext,
+                          char *pInitVector, const char *pInput,
+                          size_t lengthBytes, char *pOutput)
+{
+    int32_t errorCode;
+
+    if (pContext->aesContext != NULL) {
+        errorCode = uPortCryptoAes128CbcContextDecrypt(pContext->aesContext,
+                                                       pInitVector, pInput,
+                                                       lengthBytes, pOutput);
+    } else {
+        errorCode = uPortCryptoAes128CbcDecrypt(pContext->key,
+                                                sizeof(pContext->key),
+                                                pInitVector, pInput,
+                                                lengthBytes, pOutput);
+    }
+
+    return errorCode;
+}
+
+// Compute the V2 HMAC tag across a block of data followed by the
+// TE Secret, using the context if there is one.  pOutput must
+// point to U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES of storage.
+static int32_t hmacWithTeSecret(const uCellSecC2cContext_t *pContext,
+                                const char *pData, size_t dataLengthBytes,
+                                char *pOutput)
+{
+    int32_t errorCode = 0;
+    uPortCryptoContextHandle_t hmacContext = pContext->hmacContext;
+
+    if (hmacContext == NULL) {
+        errorCode = uPortCryptoHmacSha256ContextCreate(&hmacContext,
+                                                       pContext->hmacKey,
+                                                       sizeof(pContext->hmacKey));
+    }
+    if (errorCode == 0) {
+        errorCode = uPortCryptoHmacSha256ContextUpdate(hmacContext, pData,
+                                                       dataLengthBytes);
+        if (errorCode == 0) {
+            errorCode = uPortCryptoHmacSha256ContextUpdate(hmacContext,
+                                                           pContext->teSecret,
+                                                           sizeof(pContext->teSecret));
+        }
+        if (errorCode == 0) {
+            errorCode = uPortCryptoHmacSha256ContextFinish(hmacContext, pOutput);
+        }
+        if (pContext->hmacContext == NULL) {
+            uPortCryptoHmacSha256ContextDelete(hmacContext);
+        }
+    }
+
+    return errorCode;
+}
+
 // Run chip to chip encode.
 static size_t encode(const uCellSecC2cContext_t *pContext)
 {
@@ -348,31 +419,15 @@ static size_t encode(const uCellSecC2cContext_t *pContext)
         x = U_CELL_SEC_C2C_IV_LENGTH_BYTES;
         // Encrypt the padded plain text into the
         // output buffer using the encryption key and the IV
-        if (uPortCryptoAes128CbcEncrypt(pContext->key,
-                                        sizeof(pContext->key),
-                                        ivOrMac, pTx->txIn,
-                                        pTx->txInLength,
-                                        pTx->txOut + 3 + x) == 0) {
+        if (aesEncrypt(pContext, ivOrMac, pTx->txIn, pTx->txInLength,
+                       pTx->txOut + 3 + x) == 0) {
             x += pTx->txInLength;
             // Next we need to create a HMAC tag across the
-            // encrypted text, the IV and the TE Secret.
-            // The simplest way to do this is to copy
-            // the TE Secret into the output buffer, perform
-            // the calculation (putting the result into the
-            // local variable ivOrMac) and then we overwrite
-            // where it is in the buffer with the truncated MAC
-            // (which is at least as big, as checked with
-            // a #error above)
-            memcpy(pTx->txOut + 3 + x, pContext->teSecret,
-                   sizeof(pContext->teSecret));
-            if (uPortCryptoHmacSha256(pContext->hmacKey,
-                                      sizeof(pContext->hmacKey),
-                                      pTx->txOut + 3,
-                                      x + sizeof(pContext->teSecret),
-                                      ivOrMac) == 0) {
+            // encrypted text, the IV and the TE Secret,
+            // putting the result into the local variable ivOrMac
+            if (hmacWithTeSecret(pContext, pTx->txOut + 3, x, ivOrMac) == 0) {
                 // Now copy the first 16 bytes of the
-                // generated HMAC tag into the output,
-                // overwriting the TE Secret
+                // generated HMAC tag into the output
                 memcpy(pTx->txOut + 3 + x,
                        ivOrMac, U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES);
                 // Account for its length
@@ -415,10 +470,8 @@ static size_t encode(const uCellSecC2cContext_t *pContext)
                    U_CELL_SEC_C2C_IV_LENGTH_BYTES);
             // Encrypt the padded plain text plus MAC into the
             // output buffer using the encryption key and the IV
-            if (uPortCryptoAes128CbcEncrypt(pContext->key,
-                                            sizeof(pContext->key),
-                                            ivOrMac, pTx->txIn, x,
-                                            pTx->txOut + 3) == 0) {
+            if (aesEncrypt(pContext, ivOrMac, pTx->txIn, x,
+                           pTx->txOut + 3) == 0) {
                 // Now account for the length of the initial vector
                 x += U_CELL_SEC_C2C_IV_LENGTH_BYTES;
                 success = true;
@@ -576,9 +629,6 @@ static size_t decode(const uCellSecC2cContext_t *pContext)
                     // encrypted text (i.e. minus the
                     // HMAC tag that forms part of
                     // the payload) plus the TE Secret.
-                    // To do this concatenate the two
-                    // into rxOut (there is enough room
-                    // to do so).
 #ifdef U_CELL_SEC_C2C_DETAILED_DEBUG
                     uPortLog("U_CELL_SEC_C2C_DECODE: version 2.\n");
 
@@ -593,22 +643,13 @@ static size_t decode(const uCellSecC2cContext_t *pContext)
 #endif
                     x = chunkLength -
                         U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES;
-                    memcpy(pRx->rxOut, pData, x);
-                    memcpy(pRx->rxOut + x, pContext->teSecret,
-                           sizeof(pContext->teSecret));
                     // Compute the HMAC SHA256 of this block
                     // using the HMAC tag as the key and put it
-                    // on the end of rxOut as temporary storage.
-                    if (uPortCryptoHmacSha256(pContext->hmacKey,
-                                              sizeof(pContext->hmacKey),
-                                              pRx->rxOut,
-                                              x + sizeof(pContext->teSecret),
-                                              pRx->rxOut +
-                                              x + sizeof(pContext->teSecret)) == 0) {
+                    // in rxOut as temporary storage.
+                    if (hmacWithTeSecret(pContext, pData, x, pRx->rxOut) == 0) {
                         // Compare the first 16 bytes of
                         // it with the truncated MAC we received.
-                        if (memcmp(pData + x, pRx->rxOut + x +
-                                   sizeof(pContext->teSecret),
+                        if (memcmp(pData + x, pRx->rxOut,
                                    U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES) == 0) {
                             // The MAC's match, decrypt the contents
                             // into rxOut using the key and the IV from the
@@ -623,12 +664,10 @@ static size_t decode(const uCellSecC2cContext_t *pContext)
                             uPortLog("U_CELL_SEC_C2C_DECODE: IV:\n");
                             printBlock(pData, U_CELL_SEC_C2C_IV_LENGTH_BYTES, true);
 #endif
-                            if (uPortCryptoAes128CbcDecrypt(pContext->key,
-                                                            sizeof(pContext->key),
-                                                            pData, /* IV */
-                                                            pData + U_CELL_SEC_C2C_IV_LENGTH_BYTES,
-                                                            x,
-                                                            pRx->rxOut) == 0) {
+                            if (aesDecrypt(pContext,
+                                           pData, /* IV */
+                                           pData + U_CELL_SEC_C2C_IV_LENGTH_BYTES,
+                                           x, pRx->rxOut) == 0) {
 #ifdef U_CELL_SEC_C2C_DETAILED_DEBUG
                                 uPortLog("U_CELL_SEC_C2C_DECODE: padded decrypted data:\n");
                                 printBlock(pRx->rxOut, x, false);
@@ -675,11 +714,9 @@ static size_t decode(const uCellSecC2cContext_t *pContext)
                     printBlock(pData + x,
                                U_CELL_SEC_C2C_IV_LENGTH_BYTES, true);
 #endif
-                    if (uPortCryptoAes128CbcDecrypt(pContext->key,
-                                                    sizeof(pContext->key),
-                                                    pData + x, /* IV */
-                                                    pData, x,
-                                                    pRx->rxOut) == 0) {
+                    if (aesDecrypt(pContext,
+                                   pData + x, /* IV */
+                                   pData, x, pRx->rxOut) == 0) {
 #ifdef U_CELL_SEC_C2C_DETAILED_DEBUG
                         if (x >= U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES) {
                             uPortLog("U_CELL_SEC_C2C_DECODE: padded decrypted data:\n");
@@ -847,6 +884,41 @@ static size_t decode(const uCellSecC2cContext_t *pContext)
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Set up the crypto contexts for chip to chip security.
+int32_t uCellSecC2cContextCryptoCreate(uCellSecC2cContext_t *pContext)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+        uCellSecC2cContextCryptoDelete(pContext);
+        errorCode = uPortCryptoAes128CbcContextCreate(&(pContext->aesContext),
+                                                      pContext->key,
+                                                      sizeof(pContext->key));
+        if ((errorCode == 0) && pContext->isV2) {
+            // Only V2 uses HMAC
+            errorCode = uPortCryptoHmacSha256ContextCreate(&(pContext->hmacContext),
+                                                           pContext->hmacKey,
+                                                           sizeof(pContext->hmacKey));
+        }
+        if (errorCode != 0) {
+            uCellSecC2cContextCryptoDelete(pContext);
+        }
+    }
+
+    return errorCode;
+}
+
+// Free the crypto contexts for chip to chip security.
+void uCellSecC2cContextCryptoDelete(uCellSecC2cContext_t *pContext)
+{
+    if (pContext != NULL) {
+        uPortCryptoAes128CbcContextDelete(pContext->aesContext);
+        pContext->aesContext = NULL;
+        uPortCryptoHmacSha256ContextDelete(pContext->hmacContext);
+        pContext->hmacContext = NULL;
+    }
+}
+
 // Transmit intercept function.
 const char *pUCellSecC2cInterceptTx(uAtClientHandle_t atHandle,
                                     const char **ppData,
@@ -116,6 +116,9 @@ typedef struct {
     char teSecret[U_SECURITY_C2C_TE_SECRET_LENGTH_BYTES];
     char key[U_SECURITY_C2C_ENCRYPTION_KEY_LENGTH_BYTES];
     char hmacKey[U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES];
+    // Set up by uCellSecC2cContextCryptoCreate()
+    uPortCryptoContextHandle_t aesContext;
+    uPortCryptoContextHandle_t hmacContext;
     uCellSecC2cContextTx_t *pTx;
     uCellSecC2cContextRx_t *pRx;
 } uCellSecC2cContext_t;
@@ -124,6 +127,26 @@ typedef struct {
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
+/** Set up the crypto contexts for a chip to chip security
+ * context so that the key schedules are not recalculated for
+ * every frame; call this once isV2, key and hmacKey have been
+ * populated.  If this is not called, or fails, encoding and
+ * decoding still work, they are just slower.
+ *
+ * @param pContext a pointer to uCellSecC2cContext_t that
+ *                 has been populated appropriately.
+ * @return         zero on success else negative error code.
+ */
+int32_t uCellSecC2cContextCryptoCreate(uCellSecC2cContext_t *pContext);
+
+/** Free the crypto contexts created by
+ * uCellSecC2cContextCryptoCreate(); safe to call if they
+ * were never created.
+ *
+ * @param pContext a pointer to uCellSecC2cContext_t.
+ */
+void uCellSecC2cContextCryptoDelete(uCellSecC2cContext_t *pContext);
+
 /** Transmit intercept function, suitable for hooking
  * into the AT stream with uAtClientStreamInterceptTx().
  *
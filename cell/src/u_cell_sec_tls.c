@@ -50,6 +50,7 @@
 #include "u_cell_private.h"      // don't change it
 
 #include "u_cell_sec_tls.h"
+#include "u_cell_sec_tls_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -103,6 +104,11 @@ static int32_t gLastErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
  */
 static uCellSecTlsContext_t *gpContextList[U_CELL_SEC_PROFILES_MAX_NUM] = {0};
 
+/** Sequence number used to find the least recently used
+ * cached context.
+ */
+static uint32_t gLastUsed = 0;
+
 /** Array of IANA to u-blox legacy cipher suite numbers.
  */
 static const uCellSecTlsIanaToLegacy_t gIanaToLegacyCipher[] = {
@@ -162,6 +168,10 @@ static uCellSecTlsContext_t *pNewContext()
                 pContext->cellHandle = NULL;
                 pContext->cipherList.pString = NULL;
                 pContext->cipherList.index = 0;
+                pContext->cacheKey = 0;
+                pContext->lastUsed = 0;
+                pContext->useCount = 0;
+                pContext->cached = false;
                 pContext->profileId = (uint8_t) x;
             }
         }
@@ -194,11 +204,9 @@ static int32_t setString(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to set the string thing
@@ -213,9 +221,8 @@ static int32_t setString(const uCellSecTlsContext_t *pContext,
                 uAtClientCommandStopReadResponse(atHandle);
                 errorCode = uAtClientUnlock(atHandle);
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return errorCode;
@@ -233,11 +240,9 @@ static int32_t getString(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to get the string thing
@@ -261,9 +266,8 @@ static int32_t getString(const uCellSecTlsContext_t *pContext,
                     errorCodeOrSize = readSize;
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return errorCodeOrSize;
@@ -285,11 +289,9 @@ static int32_t setSequence(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 pModule = pUCellPrivateGetModule(pContext->cellHandle);
                 if (U_CELL_PRIVATE_HAS(pModule,
@@ -346,9 +348,8 @@ static int32_t setSequence(const uCellSecTlsContext_t *pContext,
                     free(pString);
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return errorCode;
@@ -384,11 +385,9 @@ static int32_t cipherSuiteSet(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
                 pModule = pUCellPrivateGetModule(pContext->cellHandle);
@@ -450,9 +449,8 @@ static int32_t cipherSuiteSet(const uCellSecTlsContext_t *pContext,
                     errorCode = uAtClientUnlock(atHandle);
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return errorCode;
@@ -519,6 +517,32 @@ static int32_t cipherListGetRemove(uCellSecTlsCipherList_t *pList)
     return errorCodeOrIana;
 }
 
+// Free the least recently used cached context which is not in
+// use, returning true if one was freed.
+// gUCellPrivateMutex must be locked before this is called.
+static bool evictContext()
+{
+    uCellSecTlsContext_t *pContext = NULL;
+
+    for (size_t x = 0; x < sizeof(gpContextList) / sizeof(gpContextList[0]); x++) {
+        if ((gpContextList[x] != NULL) && gpContextList[x]->cached &&
+            (gpContextList[x]->useCount == 0) &&
+            ((pContext == NULL) ||
+             // Subtract to deal with wrap
+             ((gLastUsed - gpContextList[x]->lastUsed) >
+              (gLastUsed - pContext->lastUsed)))) {
+            pContext = gpContextList[x];
+        }
+    }
+
+    if (pContext != NULL) {
+        cipherListFree(&(pContext->cipherList));
+        freeContext(pContext);
+    }
+
+    return (pContext != NULL);
+}
+
 // Set root of trust PSK generation using AT+USECPRF.
 static int32_t setGeneratePsk(const uCellSecTlsContext_t *pContext,
                               bool onNotOff)
@@ -530,14 +554,12 @@ static int32_t setGeneratePsk(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             pModule = pUCellPrivateGetModule(pContext->cellHandle);
             if (U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
-                pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+                pInstance = pUCellPrivateLock(pContext->cellHandle);
                 if (pInstance != NULL) {
                     atHandle = pInstance->atHandle;
                     // Talk to the cellular module to set the PSK
@@ -555,19 +577,47 @@ static int32_t setGeneratePsk(const uCellSecTlsContext_t *pContext,
                     uAtClientCommandStopReadResponse(atHandle);
                     errorCode = uAtClientUnlock(atHandle);
                 }
+                uCellPrivateUnlock(pInstance);
             } else {
                 if (onNotOff) {
                     errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
                 }
             }
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Forget the cached security profiles of a cellular instance.
+void uCellSecTlsPrivateForget(uDeviceHandle_t cellHandle)
+{
+    uCellSecTlsContext_t *pContext;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        for (size_t x = 0; x < sizeof(gpContextList) / sizeof(gpContextList[0]); x++) {
+            pContext = gpContextList[x];
+            if ((pContext != NULL) && pContext->cached &&
+                (pContext->cellHandle == cellHandle)) {
+                pContext->cached = false;
+                if (pContext->useCount == 0) {
+                    cipherListFree(&(pContext->cipherList));
+                    freeContext(pContext);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: ADD/REMOVE A TLS SECURITY CONTEXT
  * -------------------------------------------------------------- */
@@ -582,13 +632,19 @@ uCellSecTlsContext_t *pUCellSecSecTlsAdd(uDeviceHandle_t cellHandle)
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_LOCK(pInstance, cellHandle);
 
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             gLastErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // The list of contexts is shared between instances
+            U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
             pContext = pNewContext();
+            if ((pContext == NULL) && evictContext()) {
+                // Made room by dropping a cached profile
+                pContext = pNewContext();
+            }
+            U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
             if (pContext != NULL) {
                 pContext->cellHandle = cellHandle;
                 atHandle = pInstance->atHandle;
@@ -602,13 +658,15 @@ uCellSecTlsContext_t *pUCellSecSecTlsAdd(uDeviceHandle_t cellHandle)
                 if (gLastErrorCode != 0) {
                     // If initialisation failed, free the
                     // context again
+                    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
                     freeContext(pContext);
+                    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
                     pContext = NULL;
                 }
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        U_CELL_PRIVATE_UNLOCK(pInstance);
     }
 
     return pContext;
@@ -623,13 +681,72 @@ void uCellSecTlsRemove(uCellSecTlsContext_t *pContext)
 
         if (pContext != NULL) {
             cipherListFree(&(pContext->cipherList));
-            freeContext(pContext);
+            if (pContext->cached) {
+                // Keep the profile for re-use
+                if (pContext->useCount > 0) {
+                    pContext->useCount--;
+                }
+                gLastUsed++;
+                pContext->lastUsed = gLastUsed;
+            } else {
+                freeContext(pContext);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 }
 
+// Cache a cellular TLS security context.
+int32_t uCellSecTlsCache(uCellSecTlsContext_t *pContext, uint64_t cacheKey)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pContext != NULL) && !pContext->cached) {
+            pContext->cacheKey = cacheKey;
+            // The caller is the first user
+            pContext->useCount = 1;
+            pContext->cached = true;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Re-use a cached cellular TLS security context.
+uCellSecTlsContext_t *pUCellSecSecTlsReuse(uDeviceHandle_t cellHandle,
+                                           uint64_t cacheKey)
+{
+    uCellSecTlsContext_t *pContext = NULL;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        for (size_t x = 0; (x < sizeof(gpContextList) / sizeof(gpContextList[0])) &&
+             (pContext == NULL); x++) {
+            if ((gpContextList[x] != NULL) && gpContextList[x]->cached &&
+                (gpContextList[x]->cellHandle == cellHandle) &&
+                (gpContextList[x]->cacheKey == cacheKey)) {
+                pContext = gpContextList[x];
+                pContext->useCount++;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return pContext;
+}
+
 // Get the last error that occurred in this API and reset it.
 int32_t uCellSecTlsResetLastError()
 {
@@ -756,11 +873,9 @@ int32_t uCellSecTlsUseDeviceCertificateSet(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 uAtClientLock(atHandle);
@@ -771,9 +886,8 @@ int32_t uCellSecTlsUseDeviceCertificateSet(const uCellSecTlsContext_t *pContext,
                 uAtClientCommandStopReadResponse(atHandle);
                 errorCode = uAtClientUnlock(atHandle);
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return errorCode;
@@ -795,10 +909,8 @@ bool uCellSecTlsIsUsingDeviceCertificate(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 uAtClientLock(atHandle);
@@ -820,9 +932,8 @@ bool uCellSecTlsIsUsingDeviceCertificate(const uCellSecTlsContext_t *pContext,
                     }
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return isUsingDeviceCertificate;
@@ -860,11 +971,9 @@ int32_t uCellSecTlsCipherSuiteListFirst(uCellSecTlsContext_t *pContext)
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
                 pModule = pUCellPrivateGetModule(pContext->cellHandle);
@@ -913,9 +1022,8 @@ int32_t uCellSecTlsCipherSuiteListFirst(uCellSecTlsContext_t *pContext)
                     }
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return gLastErrorCode;
@@ -977,11 +1085,9 @@ int32_t uCellSecTlsVersionSet(const uCellSecTlsContext_t *pContext,
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pContext != NULL) && (tlsVersionMin >= 0) && (tlsVersionMin <= 12)) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 // Convert to module version number
                 switch (tlsVersionMin) {
@@ -1014,9 +1120,8 @@ int32_t uCellSecTlsVersionSet(const uCellSecTlsContext_t *pContext,
                 uAtClientCommandStopReadResponse(atHandle);
                 gLastErrorCode = uAtClientUnlock(atHandle);
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return gLastErrorCode;
@@ -1032,11 +1137,9 @@ int32_t uCellSecTlsVersionGet(const uCellSecTlsContext_t *pContext)
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to get the minimum
@@ -1076,9 +1179,8 @@ int32_t uCellSecTlsVersionGet(const uCellSecTlsContext_t *pContext)
                     }
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return gLastErrorCode;
@@ -1095,13 +1197,11 @@ int32_t uCellSecTlsCertificateCheckSet(const uCellSecTlsContext_t *pContext,
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pContext != NULL) &&
             ((check < U_CELL_SEC_TLS_CERTIFICATE_CHECK_ROOT_CA_URL) || (pUrl != NULL)) &&
             (check < U_CELL_SEC_TLS_CERTIFICATE_CHECK_MAX_NUM)) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 gLastErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -1132,9 +1232,8 @@ int32_t uCellSecTlsCertificateCheckSet(const uCellSecTlsContext_t *pContext,
                     gLastErrorCode = uAtClientUnlock(atHandle);
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return gLastErrorCode;
@@ -1152,11 +1251,9 @@ int32_t uCellSecTlsCertificateCheckGet(const uCellSecTlsContext_t *pContext,
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pContext != NULL) && ((pUrl == NULL) || (size > 0))) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to get the certificate
@@ -1202,9 +1299,8 @@ int32_t uCellSecTlsCertificateCheckGet(const uCellSecTlsContext_t *pContext,
                     gLastErrorCode = x;
                 }
             }
+            uCellPrivateUnlock(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 
     return gLastErrorCode;
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_SEC_TLS_PRIVATE_H_
+#define _U_CELL_SEC_TLS_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines a TLS security function that is
+ * needed in an internal form inside the cellular API, made available
+ * this way in order to avoid dragging the whole of the TLS security
+ * part of the cellular API into u_cell_private.c.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Forget the security profiles cached for the given cellular
+ * instance, e.g. because the module has been powered off or the
+ * instance is being removed.  Cached contexts which are not in use
+ * are freed, those which are in use will be freed when they are
+ * removed.
+ * Note: gUCellPrivateMutex must NOT be locked when this is called.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ */
+void uCellSecTlsPrivateForget(uDeviceHandle_t cellHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_SEC_TLS_PRIVATE_H_
+
+// End of file
@@ -39,6 +39,7 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "limits.h"    // INT_MIN, LONG_MIN
+#include "string.h"    // strlen(), strncmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -52,12 +53,15 @@
 #include "u_port_os.h"   // Required by u_cell_private.h
 
 #include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
 
 #include "u_location.h"
 
 #include "u_cell_module_type.h"
 #include "u_cell.h"
-#include "u_cell_net.h"
+#include "u_cell_file.h"    // Required by u_cell_private.h
+#include "u_cell_net.h"     // Required by u_cell_private.h
+#include "u_cell_private.h" // So that we can mark the instance as registered
 #include "u_cell_loc.h"
 #if U_CFG_APP_PIN_CELL_PWR_ON < 0
 #include "u_cell_pwr.h"
@@ -78,6 +82,33 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+#ifndef U_CELL_LOC_TEST_SHARED_LATENCY_MS
+/** How long the simulated module of the cellLocShared test takes
+ * to respond to AT+ULOC.
+ */
+# define U_CELL_LOC_TEST_SHARED_LATENCY_MS 1000
+#endif
+
+#ifndef U_CELL_LOC_TEST_SHARED_COMMAND_MAX_LENGTH_BYTES
+/** The maximum length of AT command that the simulated module of
+ * the cellLocShared test will capture.
+ */
+# define U_CELL_LOC_TEST_SHARED_COMMAND_MAX_LENGTH_BYTES 32
+#endif
+
+#ifndef U_CELL_LOC_TEST_SHARED_GET_TASKS
+/** The number of tasks that call uCellLocGet() at once in the
+ * cellLocShared test.
+ */
+# define U_CELL_LOC_TEST_SHARED_GET_TASKS 2
+#endif
+
+/** The fix that the simulated module of the cellLocShared test
+ * sends once it has responded to AT+ULOC.
+ */
+#define U_CELL_LOC_TEST_SHARED_URC "\r\n+UULOC: 18/10/2026,10:23:07.000,52.2226433," \
+                                   "-0.0744436,86,5,0,0,0,2,6\r\n"
+
 #ifndef U_CELL_LOC_TEST_TIMEOUT_SECONDS
 /** The position establishment timeout to use during testing, in
  * seconds.
@@ -120,6 +151,59 @@
  */
 static uCellTestPrivate_t gHandles = U_CELL_TEST_PRIVATE_DEFAULTS;
 
+/** Handle of the memory stream used by the cellLocShared test.
+ */
+static int32_t gSharedStreamHandle = -1;
+
+/** The AT command being received by the simulated module of the
+ * cellLocShared test.
+ */
+static char gSharedCommand[U_CELL_LOC_TEST_SHARED_COMMAND_MAX_LENGTH_BYTES];
+
+/** The number of characters in gSharedCommand.
+ */
+static size_t gSharedCommandLength = 0;
+
+/** The number of AT+ULOC commands the simulated module of the
+ * cellLocShared test has received.
+ */
+static volatile int32_t gSharedUlocCount = 0;
+
+/** The number of times the periodic callback of the cellLocShared
+ * test has been called.
+ */
+static volatile int32_t gSharedPeriodicCount = 0;
+
+/** The number of times the uCellLocGetStart() callback of the
+ * cellLocShared test has been called.
+ */
+static volatile int32_t gSharedStartCount = 0;
+
+/** The error code passed to either callback of the cellLocShared
+ * test, set to non-zero if either sees an error.
+ */
+static volatile int32_t gSharedErrorCode = 0;
+
+/** Set to true to stop the simulated module of the cellLocShared
+ * test sending the +UULOC URC, so that the test can send it later.
+ */
+static volatile bool gSharedHoldUrc = false;
+
+/** Set to true to make the uCellLocGet() calls of the cellLocShared
+ * test give up.
+ */
+static volatile bool gSharedStop = false;
+
+/** The cellular handle that the uCellLocGet() tasks of the
+ * cellLocShared test use.
+ */
+static uDeviceHandle_t gSharedCellHandle = NULL;
+
+/** The outcome of the uCellLocGet() call made by each task of
+ * the cellLocShared test, 1 while the call is in progress.
+ */
+static volatile int32_t gSharedGetErrorCode[U_CELL_LOC_TEST_SHARED_GET_TASKS];
+
 #ifdef U_CFG_APP_CELL_LOC_AUTHENTICATION_TOKEN
 
 /** Used for keepGoingCallback() timeout.
@@ -162,6 +246,14 @@ static int32_t gSvs = INT_MIN;
  */
 static int64_t gTimeUtc = LONG_MIN;
 
+/** Number of times periodicCallback() has been called.
+ */
+static volatile int32_t gPeriodicCount = 0;
+
+/** Error code as seen by periodicCallback().
+ */
+static volatile int32_t gPeriodicErrorCode = -1;
+
 #endif //U_CFG_APP_CELL_LOC_AUTHENTICATION_TOKEN
 
 /* ----------------------------------------------------------------
@@ -205,6 +297,32 @@ static void posCallback(uDeviceHandle_t cellHandle,
     gTimeUtc = timeUtc;
 }
 
+// Callback function for periodic location.
+static void periodicCallback(uDeviceHandle_t cellHandle,
+                             int32_t errorCode,
+                             int32_t latitudeX1e7,
+                             int32_t longitudeX1e7,
+                             int32_t altitudeMillimetres,
+                             int32_t radiusMillimetres,
+                             int32_t speedMillimetresPerSecond,
+                             int32_t svs,
+                             int64_t timeUtc)
+{
+    (void) latitudeX1e7;
+    (void) longitudeX1e7;
+    (void) altitudeMillimetres;
+    (void) radiusMillimetres;
+    (void) speedMillimetresPerSecond;
+    (void) svs;
+
+    if ((cellHandle == gCellHandle) && (timeUtc > U_CELL_LOC_TEST_MIN_UTC_TIME)) {
+        gPeriodicErrorCode = errorCode;
+    } else {
+        gPeriodicErrorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+    gPeriodicCount++;
+}
+
 // Convert a lat/long into a whole number and a
 // bit-after-the-decimal-point that can be printed
 // without having to invoke floating point operations,
@@ -238,6 +356,120 @@ static char latLongToBits(int32_t thingX1e7,
 
 #endif //U_CFG_APP_CELL_LOC_AUTHENTICATION_TOKEN
 
+// Transmit callback for the memory stream of the cellLocShared
+// test: a simulated module that responds "OK" to everything,
+// taking U_CELL_LOC_TEST_SHARED_LATENCY_MS to do so for AT+ULOC,
+// after which it sends a +UULOC URC with a fix, unless
+// gSharedHoldUrc is true.
+static void sharedTransmitCallback(int32_t streamHandle, const char *pData,
+                                   size_t size, void *pParam)
+{
+    bool isUloc;
+
+    (void) pParam;
+
+    for (size_t x = 0; x < size; x++) {
+        if (pData[x] == '\r') {
+            gSharedCommand[gSharedCommandLength] = 0;
+            gSharedCommandLength = 0;
+            isUloc = (strncmp(gSharedCommand, "AT+ULOC=", 8) == 0);
+            if (isUloc) {
+                gSharedUlocCount++;
+                uPortTaskBlock(U_CELL_LOC_TEST_SHARED_LATENCY_MS);
+            }
+            uAtClientStreamMemoryPush(streamHandle, "\r\nOK\r\n", 6);
+            if (isUloc && !gSharedHoldUrc) {
+                uAtClientStreamMemoryPush(streamHandle, U_CELL_LOC_TEST_SHARED_URC,
+                                          strlen(U_CELL_LOC_TEST_SHARED_URC));
+            }
+        } else if (gSharedCommandLength < sizeof(gSharedCommand) - 1) {
+            gSharedCommand[gSharedCommandLength] = pData[x];
+            gSharedCommandLength++;
+        }
+    }
+}
+
+// Callback for periodic location in the cellLocShared test.
+static void sharedPeriodicCallback(uDeviceHandle_t cellHandle,
+                                   int32_t errorCode,
+                                   int32_t latitudeX1e7,
+                                   int32_t longitudeX1e7,
+                                   int32_t altitudeMillimetres,
+                                   int32_t radiusMillimetres,
+                                   int32_t speedMillimetresPerSecond,
+                                   int32_t svs,
+                                   int64_t timeUtc)
+{
+    (void) cellHandle;
+    (void) latitudeX1e7;
+    (void) longitudeX1e7;
+    (void) altitudeMillimetres;
+    (void) radiusMillimetres;
+    (void) speedMillimetresPerSecond;
+    (void) svs;
+    (void) timeUtc;
+
+    if (errorCode != 0) {
+        gSharedErrorCode = errorCode;
+    }
+    gSharedPeriodicCount++;
+}
+
+// Callback for uCellLocGetStart() in the cellLocShared test.
+static void sharedStartCallback(uDeviceHandle_t cellHandle,
+                                int32_t errorCode,
+                                int32_t latitudeX1e7,
+                                int32_t longitudeX1e7,
+                                int32_t altitudeMillimetres,
+                                int32_t radiusMillimetres,
+                                int32_t speedMillimetresPerSecond,
+                                int32_t svs,
+                                int64_t timeUtc)
+{
+    (void) cellHandle;
+    (void) longitudeX1e7;
+    (void) altitudeMillimetres;
+    (void) radiusMillimetres;
+    (void) speedMillimetresPerSecond;
+    (void) svs;
+    (void) timeUtc;
+
+    if (errorCode != 0) {
+        gSharedErrorCode = errorCode;
+    } else if (latitudeX1e7 != 522226433) {
+        gSharedErrorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+    gSharedStartCount++;
+}
+
+// Keep-going callback for the uCellLocGet() calls of the
+// cellLocShared test.
+static bool sharedKeepGoingCallback(uDeviceHandle_t cellHandle)
+{
+    (void) cellHandle;
+
+    return !gSharedStop;
+}
+
+// Task for the cellLocShared test: call uCellLocGet() and
+// record the outcome in the gSharedGetErrorCode entry indexed
+// by pParameter.
+static void sharedGetTask(void *pParameter)
+{
+    size_t index = (size_t) pParameter;
+    int32_t latitudeX1e7 = 0;
+    int32_t errorCode;
+
+    errorCode = uCellLocGet(gSharedCellHandle, &latitudeX1e7, NULL, NULL, NULL,
+                            NULL, NULL, NULL, sharedKeepGoingCallback);
+    if ((errorCode == 0) && (latitudeX1e7 != 522226433)) {
+        errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+    gSharedGetErrorCode[index] = errorCode;
+
+    uPortTaskDelete(NULL);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -304,6 +536,20 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocCfg")
     uCellLocSetGnssEnable(cellHandle, (bool) y);
     U_TEST_PRINT_LINE("GNSS returned to %s.", y ? "enabled" : "disabled");
 
+    // Check the cache maximum age: there should be nothing in the
+    // cache yet
+    y = uCellLocGetCacheMaxAge(cellHandle);
+    U_TEST_PRINT_LINE("cache maximum age is %d second(s).", y);
+    U_PORT_TEST_ASSERT(y == 0);
+    uCellLocSetCacheMaxAge(cellHandle, 60);
+    z = uCellLocGetCacheMaxAge(cellHandle);
+    U_TEST_PRINT_LINE("cache maximum age is now %d second(s).", z);
+    U_PORT_TEST_ASSERT(z == 60);
+    // Put it back as it was
+    uCellLocSetCacheMaxAge(cellHandle, y);
+    U_PORT_TEST_ASSERT(uCellLocGetCached(cellHandle, NULL, NULL, NULL, NULL,
+                                         NULL, NULL, NULL, NULL) < 0);
+
 #if (U_CFG_APP_CELL_PIN_GNSS_POWER >= 0)
     if (!uCellLocGnssInsideCell(cellHandle)) {
         U_PORT_TEST_ASSERT(uCellLocSetPinGnssPwr(cellHandle,
@@ -367,6 +613,7 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocLoc")
     int32_t svs = INT_MIN;
     int64_t timeUtc = LONG_MIN;
     int32_t x;
+    int32_t ageMs;
     size_t badStatusCount;
     char prefix[2];
     int32_t whole[2];
@@ -545,6 +792,52 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocLoc")
     U_PORT_TEST_ASSERT(gErrorCode == 0);
     U_PORT_TEST_ASSERT(gTimeUtc > U_CELL_LOC_TEST_MIN_UTC_TIME);
 
+    // The last fix should now be in the cache
+    x = uCellLocGetCached(cellHandle, NULL, NULL, NULL, NULL, NULL, NULL,
+                          &timeUtc, &ageMs);
+    U_TEST_PRINT_LINE("cached location is %d millisecond(s) old.", ageMs);
+    U_PORT_TEST_ASSERT(x == 0);
+    U_PORT_TEST_ASSERT(timeUtc == gTimeUtc);
+    U_PORT_TEST_ASSERT(ageMs >= 0);
+
+    if ((gRadiusMillimetres > 0) &&
+        (gRadiusMillimetres <= uCellLocGetDesiredAccuracy(cellHandle))) {
+        // With a maximum age set the cached fix should be
+        // returned immediately
+        uCellLocSetCacheMaxAge(cellHandle, 3600);
+        startTime = uPortGetTickTimeMs();
+        timeUtc = LONG_MIN;
+        x = uCellLocGet(cellHandle, NULL, NULL, NULL, NULL, NULL, NULL,
+                        &timeUtc, keepGoingCallback);
+        U_TEST_PRINT_LINE("location from the cache took %d millisecond(s).",
+                          (int32_t) (uPortGetTickTimeMs() - startTime));
+        U_PORT_TEST_ASSERT(x == 0);
+        U_PORT_TEST_ASSERT(timeUtc == gTimeUtc);
+        U_PORT_TEST_ASSERT(uPortGetTickTimeMs() - startTime < 1000);
+        uCellLocSetCacheMaxAge(cellHandle, 0);
+    }
+
+    // Get position periodically
+    U_TEST_PRINT_LINE("location establishment, periodic version.");
+    gCellHandle = cellHandle;
+    gPeriodicCount = 0;
+    gPeriodicErrorCode = -1;
+    startTime = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uCellLocGetPeriodicStart(cellHandle, 10, periodicCallback) == 0);
+    while ((gPeriodicCount < 2) &&
+           (uPortGetTickTimeMs() - startTime < U_CELL_LOC_TEST_TIMEOUT_SECONDS * 1000)) {
+        uPortTaskBlock(1000);
+    }
+    uCellLocGetPeriodicStop(cellHandle);
+    U_TEST_PRINT_LINE("periodic callback was called %d time(s) in %d second(s).",
+                      gPeriodicCount, (int32_t) (uPortGetTickTimeMs() - startTime) / 1000);
+    U_PORT_TEST_ASSERT(gPeriodicCount >= 2);
+    U_PORT_TEST_ASSERT(gPeriodicErrorCode == 0);
+    // No more callbacks once stopped
+    x = gPeriodicCount;
+    uPortTaskBlock(1000);
+    U_PORT_TEST_ASSERT(gPeriodicCount == x);
+
 #if U_CFG_APP_PIN_CELL_PWR_ON < 0
     // The standard postamble would normally power the module off
     // but if there is no power-on pin it won't (for obvious reasons)
@@ -568,6 +861,165 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocLoc")
 #endif
 }
 
+/** Check that a location request made while another is still
+ * being sent to the module joins it, rather than waiting for it
+ * to be sent or sending a second AT+ULOC.  A module is simulated,
+ * using a memory stream, which takes
+ * #U_CELL_LOC_TEST_SHARED_LATENCY_MS to respond to AT+ULOC; periodic
+ * location is started and, while its AT+ULOC is in progress,
+ * uCellLocGetStart() is called, which should return at once; both
+ * callbacks should get the one fix.
+ */
+U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocShared")
+{
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t cellHandle = NULL;
+    uCellPrivateInstance_t *pInstance;
+    uPortTaskHandle_t taskHandle = NULL;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t heapUsed;
+    int32_t x;
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    gSharedStreamHandle = uAtClientStreamMemoryOpen(U_CELL_AT_BUFFER_LENGTH_BYTES,
+                                                    sharedTransmitCallback, NULL);
+    U_PORT_TEST_ASSERT(gSharedStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gSharedStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CFG_TEST_CELL_MODULE_TYPE, atClientHandle,
+                                -1, -1, -1, false, &cellHandle) == 0);
+    // Location requests are only made when registered; there is
+    // no network here so pretend
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    U_PORT_TEST_ASSERT(pInstance != NULL);
+    //lint -esym(613, pInstance) Suppress possible use of NULL pointer
+    pInstance->networkStatus[U_CELL_NET_REG_DOMAIN_PS] = U_CELL_NET_STATUS_REGISTERED_HOME;
+
+    gSharedUlocCount = 0;
+    gSharedPeriodicCount = 0;
+    gSharedStartCount = 0;
+    gSharedErrorCode = 0;
+    U_TEST_PRINT_LINE("starting periodic location...");
+    U_PORT_TEST_ASSERT(uCellLocGetPeriodicStart(cellHandle, 3600,
+                                                sharedPeriodicCallback) == 0);
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    while ((gSharedUlocCount == 0) &&
+           ((int32_t) uPortGetTickTimeMs() - startTimeMs < U_CELL_LOC_TEST_SHARED_LATENCY_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gSharedUlocCount == 1);
+
+    U_TEST_PRINT_LINE("asking for location while that request is in progress...");
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uCellLocGetStart(cellHandle, sharedStartCallback) == 0);
+    durationMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("uCellLocGetStart() took %d ms.", durationMs);
+    // Were the request in progress to hold anything up this
+    // would take as long as the module takes to respond
+    U_PORT_TEST_ASSERT(durationMs < U_CELL_LOC_TEST_SHARED_LATENCY_MS / 2);
+
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    while (((gSharedPeriodicCount == 0) || (gSharedStartCount == 0)) &&
+           ((int32_t) uPortGetTickTimeMs() - startTimeMs < U_CELL_LOC_TEST_SHARED_LATENCY_MS * 5)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("%d AT+ULOC(s) sent, periodic callback called %d time(s),"
+                      " uCellLocGetStart() callback called %d time(s).",
+                      gSharedUlocCount, gSharedPeriodicCount, gSharedStartCount);
+    U_PORT_TEST_ASSERT(gSharedPeriodicCount == 1);
+    U_PORT_TEST_ASSERT(gSharedStartCount == 1);
+    U_PORT_TEST_ASSERT(gSharedErrorCode == 0);
+    U_PORT_TEST_ASSERT(gSharedUlocCount == 1);
+
+    uCellLocGetPeriodicStop(cellHandle);
+
+    // Now several blocking callers at once, with the cache switched
+    // off so that the later ones can only avoid sending their own
+    // AT+ULOC by joining the request of the first; the URC is held
+    // back until they have all had the chance to do so
+    uCellLocSetCacheMaxAge(cellHandle, 0);
+    gSharedUlocCount = 0;
+    gSharedHoldUrc = true;
+    gSharedStop = false;
+    gSharedCellHandle = cellHandle;
+    U_TEST_PRINT_LINE("calling uCellLocGet() from %d tasks at once...",
+                      U_CELL_LOC_TEST_SHARED_GET_TASKS);
+    for (size_t x = 0; x < U_CELL_LOC_TEST_SHARED_GET_TASKS; x++) {
+        gSharedGetErrorCode[x] = 1;
+        U_PORT_TEST_ASSERT(uPortTaskCreate(sharedGetTask, "cellLocShared",
+                                           U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                           (void *) x, U_CFG_TEST_OS_TASK_PRIORITY,
+                                           &taskHandle) == 0);
+    }
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    while ((gSharedUlocCount == 0) &&
+           ((int32_t) uPortGetTickTimeMs() - startTimeMs < U_CELL_LOC_TEST_SHARED_LATENCY_MS * 5)) {
+        uPortTaskBlock(10);
+    }
+    uPortTaskBlock(U_CELL_LOC_TEST_SHARED_LATENCY_MS * 2);
+    U_PORT_TEST_ASSERT(uAtClientStreamMemoryPush(gSharedStreamHandle,
+                                                 U_CELL_LOC_TEST_SHARED_URC,
+                                                 strlen(U_CELL_LOC_TEST_SHARED_URC)) > 0);
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    x = U_CELL_LOC_TEST_SHARED_GET_TASKS;
+    while (x > 0) {
+        // Anyone still waiting after a while must be waiting on an
+        // AT+ULOC of their own, which will never be answered: stop them
+        if ((int32_t) uPortGetTickTimeMs() - startTimeMs > U_CELL_LOC_TEST_SHARED_LATENCY_MS * 5) {
+            gSharedStop = true;
+        }
+        uPortTaskBlock(10);
+        x = 0;
+        for (size_t y = 0; y < U_CELL_LOC_TEST_SHARED_GET_TASKS; y++) {
+            if (gSharedGetErrorCode[y] == 1) {
+                x++;
+            }
+        }
+    }
+    // Give the tasks time to delete themselves
+    uPortTaskBlock(U_CFG_OS_YIELD_MS * 10);
+    U_TEST_PRINT_LINE("%d AT+ULOC(s) sent.", gSharedUlocCount);
+    for (size_t y = 0; y < U_CELL_LOC_TEST_SHARED_GET_TASKS; y++) {
+        U_TEST_PRINT_LINE("uCellLocGet() in task %d returned %d.", (int) y,
+                          gSharedGetErrorCode[y]);
+        U_PORT_TEST_ASSERT(gSharedGetErrorCode[y] == 0);
+    }
+    U_PORT_TEST_ASSERT(gSharedUlocCount == 1);
+
+    // Leave a request unanswered: removing the instance must
+    // free it, which the memory leak check below will confirm
+    gSharedStartCount = 0;
+    U_PORT_TEST_ASSERT(uCellLocGetStart(cellHandle, sharedStartCallback) == 0);
+    U_PORT_TEST_ASSERT(gSharedUlocCount == 2);
+    gSharedHoldUrc = false;
+    uCellDeinit();
+    uAtClientRemove(atClientHandle);
+    uAtClientStreamMemoryClose(gSharedStreamHandle);
+    gSharedStreamHandle = -1;
+    uAtClientDeinit();
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -577,6 +1029,9 @@ U_PORT_TEST_FUNCTION("[cellLoc]", "cellLocCleanUp")
     int32_t x;
 
     uCellTestPrivateCleanup(&gHandles);
+    if (gSharedStreamHandle >= 0) {
+        uAtClientStreamMemoryClose(gSharedStreamHandle);
+    }
 
     x = uPortTaskStackMinFree(NULL);
     if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
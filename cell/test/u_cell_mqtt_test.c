@@ -24,7 +24,8 @@
  * @brief Tests for the configuration calls of the cellular MQTT
  * API; for testing of the connectivity parts see the tests in
  * common/mqtt_client.  These test should pass on all platforms
- * that have a cellular module connected to them.  They are only
+ * that have a cellular module connected to them, except for
+ * cellMqttUrcWake which uses a simulated module.  They are only
  * compiled if U_CFG_TEST_CELL_MODULE_TYPE is defined.
  * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
  * naming rules that must be followed when using the
@@ -55,6 +56,7 @@
 #include "u_port_os.h"   // Required by u_cell_private.h
 
 #include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
 
 #include "u_cell_module_type.h"
 #include "u_cell.h"
@@ -115,6 +117,29 @@
 # define U_CELL_MQTT_TEST_MQTTSN_SERVER_IP_ADDRESS_SECURED  ubxlib.it-sgn.u-blox.com:8883
 #endif
 
+#ifndef U_CELL_MQTT_TEST_URC_WAKE_DELAY_MS
+/** How long after the subscribe command the simulated module of
+ * the cellMqttUrcWake test sends the URC that says the subscribe
+ * has succeeded.
+ */
+# define U_CELL_MQTT_TEST_URC_WAKE_DELAY_MS 100
+#endif
+
+/** The topic that the cellMqttUrcWake test subscribes to.
+ */
+#define U_CELL_MQTT_TEST_URC_WAKE_TOPIC "ubx_test_wake"
+
+/** The URC that the simulated module of the cellMqttUrcWake test
+ * sends to say that the subscribe has succeeded at QoS 0.
+ */
+#define U_CELL_MQTT_TEST_URC_WAKE_URC "\r\n+UUMQTTC: 4,1,0,\""            \
+                                      U_CELL_MQTT_TEST_URC_WAKE_TOPIC "\"\r\n"
+
+/** The maximum length of AT command that the simulated module of
+ * the cellMqttUrcWake test will capture.
+ */
+#define U_CELL_MQTT_TEST_URC_WAKE_COMMAND_MAX_LENGTH_BYTES 64
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -146,6 +171,29 @@ static const char gAllChars[] = "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0
 static const char gPrintableChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
                                       "0123456789!#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
 
+/** Handle of the memory stream used by the cellMqttUrcWake test.
+ */
+static int32_t gUrcWakeStreamHandle = -1;
+
+/** The AT command being received by the simulated module of the
+ * cellMqttUrcWake test.
+ */
+static char gUrcWakeCommand[U_CELL_MQTT_TEST_URC_WAKE_COMMAND_MAX_LENGTH_BYTES];
+
+/** The number of characters in gUrcWakeCommand.
+ */
+static size_t gUrcWakeCommandLength = 0;
+
+/** Set by the simulated module of the cellMqttUrcWake test when
+ * it has received the subscribe command.
+ */
+static volatile bool gUrcWakeSubscribed = false;
+
+/** The time at which the URC task of the cellMqttUrcWake test sent
+ * the URC, -1 if it has not.
+ */
+static volatile int32_t gUrcWakeUrcTimeMs = -1;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -164,6 +212,49 @@ static bool keepGoingCallback(uDeviceHandle_t unused)
     return keepGoing;
 }
 
+// Transmit callback for the memory stream of the cellMqttUrcWake
+// test: a simulated module that responds "OK" to everything and
+// flags when it has been asked to subscribe; the URC saying that
+// the subscribe has succeeded is sent by urcWakeTask().
+static void urcWakeTransmitCallback(int32_t streamHandle, const char *pData,
+                                    size_t size, void *pParam)
+{
+    (void) pParam;
+
+    for (size_t x = 0; x < size; x++) {
+        if (pData[x] == '\r') {
+            gUrcWakeCommand[gUrcWakeCommandLength] = 0;
+            gUrcWakeCommandLength = 0;
+            uAtClientStreamMemoryPush(streamHandle, "\r\nOK\r\n", 6);
+            if (strncmp(gUrcWakeCommand, "AT+UMQTTC=4,", 12) == 0) {
+                gUrcWakeSubscribed = true;
+            }
+        } else if (gUrcWakeCommandLength < sizeof(gUrcWakeCommand) - 1) {
+            gUrcWakeCommand[gUrcWakeCommandLength] = pData[x];
+            gUrcWakeCommandLength++;
+        }
+    }
+}
+
+// Task for the cellMqttUrcWake test: once the simulated module has
+// been asked to subscribe, wait U_CELL_MQTT_TEST_URC_WAKE_DELAY_MS,
+// by which time uCellMqttSubscribe() will be waiting for the URC,
+// then send the URC.
+static void urcWakeTask(void *pParameters)
+{
+    (void) pParameters;
+
+    while (!gUrcWakeSubscribed) {
+        uPortTaskBlock(10);
+    }
+    uPortTaskBlock(U_CELL_MQTT_TEST_URC_WAKE_DELAY_MS);
+    gUrcWakeUrcTimeMs = (int32_t) uPortGetTickTimeMs();
+    uAtClientStreamMemoryPush(gUrcWakeStreamHandle, U_CELL_MQTT_TEST_URC_WAKE_URC,
+                              sizeof(U_CELL_MQTT_TEST_URC_WAKE_URC) - 1);
+
+    uPortTaskDelete(NULL);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -717,6 +808,85 @@ U_PORT_TEST_FUNCTION("[cellMqtt]", "cellMqttSn")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Check that an MQTT operation which waits for a URC carries on
+ * as soon as the URC arrives, rather than at the end of a wait
+ * slice of #U_CELL_MQTT_URC_WAIT_SLICE_MS, using a simulated SARA-R5
+ * module on a memory stream; this does not need a real module.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[cellMqtt]", "cellMqttUrcWake")
+{
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t cellHandle = NULL;
+    uPortTaskHandle_t taskHandle = NULL;
+    int32_t startTimeMs;
+    int32_t x;
+    int32_t heapUsed;
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    gUrcWakeStreamHandle = uAtClientStreamMemoryOpen(U_CELL_AT_BUFFER_LENGTH_BYTES,
+                                                     urcWakeTransmitCallback, NULL);
+    U_PORT_TEST_ASSERT(gUrcWakeStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gUrcWakeStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    // SARA-R5 since the responses of the simulated module are of that form
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandle,
+                                -1, -1, -1, false, &cellHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellMqttInit(cellHandle, "ubxlib.it-sgn.u-blox.com",
+                                     "ubx_test", NULL, NULL, NULL, false) == 0);
+
+    gUrcWakeSubscribed = false;
+    gUrcWakeUrcTimeMs = -1;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(urcWakeTask, "cellMqttUrcWake",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       NULL, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    U_TEST_PRINT_LINE("subscribing, the URC will arrive %d ms after the command...",
+                      U_CELL_MQTT_TEST_URC_WAKE_DELAY_MS);
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uCellMqttSubscribe(cellHandle, U_CELL_MQTT_TEST_URC_WAKE_TOPIC,
+                                          U_CELL_MQTT_QOS_AT_MOST_ONCE) == 0);
+    x = (int32_t) uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(gUrcWakeUrcTimeMs >= 0);
+    U_TEST_PRINT_LINE("subscribe took %d ms, returning %d ms after the URC was sent.",
+                      x - startTimeMs, x - gUrcWakeUrcTimeMs);
+    // Were the wait not woken by the URC it would only end at the
+    // end of the wait slice
+    U_PORT_TEST_ASSERT(x - gUrcWakeUrcTimeMs < U_CELL_MQTT_URC_WAIT_SLICE_MS / 4);
+    // Give the task a moment to delete itself
+    uPortTaskBlock(U_CFG_OS_YIELD_MS + 100);
+
+    uCellMqttDeinit(cellHandle);
+    uCellDeinit();
+    uAtClientRemove(atClientHandle);
+    uAtClientStreamMemoryClose(gUrcWakeStreamHandle);
+    gUrcWakeStreamHandle = -1;
+    uAtClientDeinit();
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -729,6 +899,9 @@ U_PORT_TEST_FUNCTION("[cellMqtt]", "cellMqttCleanUp")
         uCellMqttDeinit(gHandles.cellHandle);
     }
     uCellTestPrivateCleanup(&gHandles);
+    if (gUrcWakeStreamHandle >= 0) {
+        uAtClientStreamMemoryClose(gUrcWakeStreamHandle);
+    }
 
     x = uPortTaskStackMinFree(NULL);
     if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
@@ -53,6 +53,7 @@
 #include "u_port_uart.h"
 
 #include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
 
 #include "u_sock.h"
 
@@ -145,6 +146,29 @@
 # define U_CELL_PWR_TEST_ECHO_STRING_LENGTH_BYTES 12
 #endif
 
+#ifndef U_CELL_PWR_TEST_BOOT_DOWN_DELAY_MS
+/** How long the simulated module of the cellPwrBoot test carries
+ * on responding after it has been commanded to reboot.
+ */
+# define U_CELL_PWR_TEST_BOOT_DOWN_DELAY_MS 500
+#endif
+
+#ifndef U_CELL_PWR_TEST_BOOT_TIME_MS
+/** How long the simulated module of the cellPwrBoot test stops
+ * responding for, measured from the reboot command or, at power-on,
+ * from the end of the initial "is it already on" check; must be
+ * less than the reboot wait time of any module type.
+ */
+# define U_CELL_PWR_TEST_BOOT_TIME_MS 2000
+#endif
+
+#ifndef U_CELL_PWR_TEST_BOOT_COMMAND_MAX_LENGTH_BYTES
+/** The maximum length of AT command that the simulated module of
+ * the cellPwrBoot test will capture.
+ */
+# define U_CELL_PWR_TEST_BOOT_COMMAND_MAX_LENGTH_BYTES 32
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -197,6 +221,40 @@ static int64_t gStopTimeMs;
  */
 static int32_t gCallbackErrorCode = 0;
 
+/** Handle of the memory stream used by the cellPwrBoot test.
+ */
+static int32_t gBootStreamHandle = -1;
+
+/** Storage for the command being received by the simulated module
+ * of the cellPwrBoot test.
+ */
+static char gBootCommand[U_CELL_PWR_TEST_BOOT_COMMAND_MAX_LENGTH_BYTES];
+
+/** The number of characters in gBootCommand.
+ */
+static size_t gBootCommandLength = 0;
+
+/** The time at which the simulated module of the cellPwrBoot test
+ * stops responding.
+ */
+static volatile int32_t gBootDownStartTimeMs = 0;
+
+/** The time at which the simulated module of the cellPwrBoot test
+ * starts responding again.
+ */
+static volatile int32_t gBootDownEndTimeMs = 0;
+
+/** The number of "AT"s that the simulated module of the cellPwrBoot
+ * test has responded to between being commanded to reboot and
+ * going down.
+ */
+static volatile int32_t gBootGoingDownCount = 0;
+
+/** The number of commands that the simulated module of the
+ * cellPwrBoot test has ignored because it was down.
+ */
+static volatile int32_t gBootIgnoredCount = 0;
+
 # ifndef U_CFG_CELL_DISABLE_UART_POWER_SAVING
 
 /** TCP socket handle.
@@ -692,6 +750,44 @@ static bool setEdrx(uDeviceHandle_t cellHandle, int32_t *pSockHandle,
 
 # endif // U_CFG_CELL_DISABLE_UART_POWER_SAVING
 
+// Transmit callback for the memory stream of the cellPwrBoot test:
+// simulates a module which ignores everything while it is down
+// and otherwise responds "OK" to everything, going down
+// U_CELL_PWR_TEST_BOOT_DOWN_DELAY_MS after it is commanded to
+// reboot and coming back U_CELL_PWR_TEST_BOOT_TIME_MS after that
+// command.
+static void bootTransmitCallback(int32_t streamHandle, const char *pData,
+                                 size_t size, void *pParam)
+{
+    int32_t nowMs;
+
+    (void) pParam;
+
+    for (size_t x = 0; x < size; x++) {
+        if (pData[x] == '\r') {
+            gBootCommand[gBootCommandLength] = 0;
+            gBootCommandLength = 0;
+            nowMs = (int32_t) uPortGetTickTimeMs();
+            if ((nowMs - gBootDownStartTimeMs >= 0) && (nowMs - gBootDownEndTimeMs < 0)) {
+                gBootIgnoredCount++;
+            } else {
+                if ((strcmp(gBootCommand, "AT+CFUN=15") == 0) ||
+                    (strcmp(gBootCommand, "AT+CFUN=16") == 0)) {
+                    gBootDownStartTimeMs = nowMs + U_CELL_PWR_TEST_BOOT_DOWN_DELAY_MS;
+                    gBootDownEndTimeMs = nowMs + U_CELL_PWR_TEST_BOOT_TIME_MS;
+                } else if ((strcmp(gBootCommand, "AT") == 0) &&
+                           (gBootDownStartTimeMs - nowMs > 0)) {
+                    gBootGoingDownCount++;
+                }
+                uAtClientStreamMemoryPush(streamHandle, "\r\nOK\r\n", 6);
+            }
+        } else if (gBootCommandLength < sizeof(gBootCommand) - 1) {
+            gBootCommand[gBootCommandLength] = pData[x];
+            gBootCommandLength++;
+        }
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -776,6 +872,7 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReboot")
 {
     int32_t heapUsed;
     int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+    int32_t x;
 
     // In case a previous test failed
     uCellTestPrivateCleanup(&gHandles);
@@ -795,6 +892,9 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReboot")
     U_PORT_TEST_ASSERT(uCellPwrReboot(gHandles.cellHandle, NULL) == 0);
 
     U_PORT_TEST_ASSERT(uCellPwrIsAlive(gHandles.cellHandle));
+    x = uCellPwrGetBootTimeMs(gHandles.cellHandle);
+    U_TEST_PRINT_LINE("module took %d ms to reboot.", x);
+    U_PORT_TEST_ASSERT(x >= 0);
 
     // Do the standard postamble, leaving the module on for the next
     // test to speed things up
@@ -834,6 +934,9 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReset")
     x = uCellPwrResetHard(gHandles.cellHandle, U_CFG_APP_PIN_CELL_RESET);
 # if U_CFG_APP_PIN_CELL_RESET >= 0
     U_PORT_TEST_ASSERT(x == 0);
+    x = uCellPwrGetBootTimeMs(gHandles.cellHandle);
+    U_TEST_PRINT_LINE("module took %d ms to boot after reset.", x);
+    U_PORT_TEST_ASSERT(x >= 0);
 # else
     U_PORT_TEST_ASSERT(x < 0);
 # endif
@@ -1531,6 +1634,90 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrSavingEDrx")
 }
 # endif //U_CFG_CELL_DISABLE_UART_POWER_SAVING
 
+/** Test that power-on and reboot detect the module booting, rather
+ * than waiting a fixed time, using a simulated module on a memory
+ * stream; this does not need a real module.
+ */
+U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrBoot")
+{
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t cellHandle = NULL;
+    int32_t x;
+    int32_t heapUsed;
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    gBootStreamHandle = uAtClientStreamMemoryOpen(U_CELL_AT_BUFFER_LENGTH_BYTES,
+                                                  bootTransmitCallback, NULL);
+    U_PORT_TEST_ASSERT(gBootStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gBootStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CFG_TEST_CELL_MODULE_TYPE, atClientHandle,
+                                -1, -1, -1, false, &cellHandle) == 0);
+
+    // Power on with the module not responding at first: having
+    // found that it is not already on, uCellPwrOn() should keep
+    // probing it and carry on as soon as it responds
+    gBootIgnoredCount = 0;
+    gBootDownStartTimeMs = (int32_t) uPortGetTickTimeMs();
+    gBootDownEndTimeMs = gBootDownStartTimeMs +
+                         pUCellPrivateGetModule(cellHandle)->responseMaxWaitMs +
+                         U_CELL_PWR_TEST_BOOT_TIME_MS;
+    U_TEST_PRINT_LINE("powering on a module that takes %d ms to respond...",
+                      gBootDownEndTimeMs - gBootDownStartTimeMs);
+    U_PORT_TEST_ASSERT(uCellPwrGetBootTimeMs(cellHandle) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uCellPwrOn(cellHandle, NULL, NULL) == 0);
+    x = uCellPwrGetBootTimeMs(cellHandle);
+    U_TEST_PRINT_LINE("module took %d ms to boot, %d command(s) went unanswered.",
+                      x, gBootIgnoredCount);
+    // One unanswered command is the initial check, the rest are probes
+    U_PORT_TEST_ASSERT(gBootIgnoredCount > 2);
+    U_PORT_TEST_ASSERT(x >= 0);
+    U_PORT_TEST_ASSERT(x < U_CELL_PWR_TEST_BOOT_TIME_MS + 1000);
+
+    // Reboot: the module carries on responding for a while after
+    // the reboot command; that must not be taken as it having booted
+    gBootIgnoredCount = 0;
+    gBootGoingDownCount = 0;
+    U_TEST_PRINT_LINE("rebooting a module that goes down after %d ms and"
+                      " is back after %d ms...", U_CELL_PWR_TEST_BOOT_DOWN_DELAY_MS,
+                      U_CELL_PWR_TEST_BOOT_TIME_MS);
+    U_PORT_TEST_ASSERT(uCellPwrReboot(cellHandle, NULL) == 0);
+    x = uCellPwrGetBootTimeMs(cellHandle);
+    U_TEST_PRINT_LINE("module took %d ms to reboot, %d \"AT\"(s) answered while"
+                      " going down, %d command(s) went unanswered.", x,
+                      gBootGoingDownCount, gBootIgnoredCount);
+    U_PORT_TEST_ASSERT(gBootGoingDownCount > 0);
+    U_PORT_TEST_ASSERT(gBootIgnoredCount > 0);
+    U_PORT_TEST_ASSERT(x >= U_CELL_PWR_TEST_BOOT_DOWN_DELAY_MS);
+    U_PORT_TEST_ASSERT(x < U_CELL_PWR_TEST_BOOT_TIME_MS + 1000);
+
+    uCellDeinit();
+    uAtClientRemove(atClientHandle);
+    uAtClientStreamMemoryClose(gBootStreamHandle);
+    gBootStreamHandle = -1;
+    uAtClientDeinit();
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -1556,6 +1743,9 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrCleanUp")
     }
 
     uCellTestPrivateCleanup(&gHandles);
+    if (gBootStreamHandle >= 0) {
+        uAtClientStreamMemoryClose(gBootStreamHandle);
+    }
 
     x = uPortTaskStackMinFree(NULL);
     if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
@@ -1269,73 +1269,86 @@ U_PORT_TEST_FUNCTION("[cellSecC2c]", "cellSecC2cIntercept")
     gContext.pTx = &gContextTx;
     gContext.pRx = &gContextRx;
 
-    for (size_t x = 0; x < sizeof(gTestData) / sizeof(gTestData[0]); x++) {
-        pTestData = &gTestData[x];
-        totalLength = 0;
-        for (size_t y = 0; y < (sizeof(pTestData->clearLength) /
-                                sizeof(pTestData->clearLength[0])); y++) {
-            totalLength += pTestData->clearLength[y];
+    // The first pass is without crypto contexts, so that the
+    // keys are set up afresh for each frame, the second pass
+    // with them
+    uCellSecC2cContextCryptoDelete(&gContext);
+    for (size_t pass = 0; pass < 2; pass++) {
+        if (pass > 0) {
+            U_TEST_PRINT_LINE("repeating with crypto contexts.");
         }
-        uPortLog(U_TEST_PREFIX_X "clear text %d byte(s) \"", x + 1, totalLength);
-        print(pTestData->pClear, totalLength);
-        uPortLog("\".\n");
+        for (size_t x = 0; x < sizeof(gTestData) / sizeof(gTestData[0]); x++) {
+            pTestData = &gTestData[x];
+            totalLength = 0;
+            for (size_t y = 0; y < (sizeof(pTestData->clearLength) /
+                                    sizeof(pTestData->clearLength[0])); y++) {
+                totalLength += pTestData->clearLength[y];
+            }
+            uPortLog(U_TEST_PREFIX_X "clear text %d byte(s) \"", x + 1, totalLength);
+            print(pTestData->pClear, totalLength);
+            uPortLog("\".\n");
+
+            // Populate context
+            gContext.isV2 = pTestData->isV2;
+            memcpy(gContext.teSecret, pTestData->pTeSecret,
+                   sizeof(gContext.teSecret));
+            memcpy(gContext.key, pTestData->pKey,
+                   sizeof(gContext.key));
+            if (pTestData->pHmacTag != NULL) {
+                memcpy(gContext.hmacKey, pTestData->pHmacTag,
+                       sizeof(gContext.hmacKey));
+            }
+            gContext.pTx->txInLength = 0;
+            gContext.pTx->txInLimit = pTestData->chunkLengthMax;
+            if (pass > 0) {
+                U_PORT_TEST_ASSERT(uCellSecC2cContextCryptoCreate(&gContext) == 0);
+            }
 
-        // Populate context
-        gContext.isV2 = pTestData->isV2;
-        memcpy(gContext.teSecret, pTestData->pTeSecret,
-               sizeof(gContext.teSecret));
-        memcpy(gContext.key, pTestData->pKey,
-               sizeof(gContext.key));
-        if (pTestData->pHmacTag != NULL) {
-            memcpy(gContext.hmacKey, pTestData->pHmacTag,
-                   sizeof(gContext.hmacKey));
-        }
-        gContext.pTx->txInLength = 0;
-        gContext.pTx->txInLimit = pTestData->chunkLengthMax;
-
-        memcpy(gBufferA + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES,
-               pTestData->pClear, totalLength);
-        pData = gBufferA + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES;
-        numChunks = 0;
-        pDataStart = pData;
-
-        // Do the encryption by calling the transmit intercept
-        do {
-            U_PORT_TEST_ASSERT(numChunks < pTestData->numChunks);
-            outLength = totalLength - (pData - pDataStart);
-            pOut = pUCellSecC2cInterceptTx(0, &pData, &outLength,
-                                           &gContext);
+            memcpy(gBufferA + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES,
+                   pTestData->pClear, totalLength);
+            pData = gBufferA + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES;
+            numChunks = 0;
+            pDataStart = pData;
+
+            // Do the encryption by calling the transmit intercept
+            do {
+                U_PORT_TEST_ASSERT(numChunks < pTestData->numChunks);
+                outLength = totalLength - (pData - pDataStart);
+                pOut = pUCellSecC2cInterceptTx(0, &pData, &outLength,
+                                               &gContext);
+                if (outLength > 0) {
+                    // There will only be a result here if the input reached
+                    // the chunk length limit
+                    checkEncrypted(x, numChunks, pOut, outLength, pTestData);
+                    numChunks++;
+                }
+            } while (pData < gBufferA + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES + totalLength);
+
+            U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferA);
+            U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferA);
+            U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferB);
+            U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferB);
+
+            // Flush the transmit intercept by calling it again with NULL
+            outLength = 0;
+            pOut = pUCellSecC2cInterceptTx(0, NULL, &outLength, &gContext);
             if (outLength > 0) {
-                // There will only be a result here if the input reached
-                // the chunk length limit
                 checkEncrypted(x, numChunks, pOut, outLength, pTestData);
                 numChunks++;
             }
-        } while (pData < gBufferA + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES + totalLength);
 
-        U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferA);
-        U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferA);
-        U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferB);
-        U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferB);
+            U_PORT_TEST_ASSERT(numChunks == pTestData->numChunks);
+            // When done, the RX buffer should contain the complete
+            // clear message
+            U_PORT_TEST_ASSERT(memcmp(gBufferB + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES,
+                                      pTestData->pClear, totalLength) == 0);
 
-        // Flush the transmit intercept by calling it again with NULL
-        outLength = 0;
-        pOut = pUCellSecC2cInterceptTx(0, NULL, &outLength, &gContext);
-        if (outLength > 0) {
-            checkEncrypted(x, numChunks, pOut, outLength, pTestData);
-            numChunks++;
+            U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferA);
+            U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferA);
+            U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferB);
+            U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferB);
         }
-
-        U_PORT_TEST_ASSERT(numChunks == pTestData->numChunks);
-        // When done, the RX buffer should contain the complete
-        // clear message
-        U_PORT_TEST_ASSERT(memcmp(gBufferB + U_CELL_SEC_C2C_GUARD_LENGTH_BYTES,
-                                  pTestData->pClear, totalLength) == 0);
-
-        U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferA);
-        U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferA);
-        U_CELL_SEC_C2C_CHECK_GUARD_UNDERRUN(gBufferB);
-        U_CELL_SEC_C2C_CHECK_GUARD_OVERRUN(gBufferB);
+        uCellSecC2cContextCryptoDelete(&gContext);
     }
 
     uPortDeinit();
@@ -1695,6 +1708,7 @@ U_PORT_TEST_FUNCTION("[cellSecC2c]", "cellSecC2cCleanUp")
 {
     int32_t minFreeStackBytes;
 
+    uCellSecC2cContextCryptoDelete(&gContext);
     uAtClientDeinit();
     if (gUartAHandle >= 0) {
         uPortUartClose(gUartAHandle);
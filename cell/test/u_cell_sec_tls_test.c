@@ -81,6 +81,14 @@
  */
 #define U_CELL_SEC_TLS_TEST_NAME_LENGTH_BYTES 11
 
+#ifndef U_CELL_SEC_TLS_TEST_MAX_NUM_CONTEXTS
+/** The maximum number of security contexts to try to add when
+ * testing caching, should be larger than the number of security
+ * profiles a module supports.
+ */
+# define U_CELL_SEC_TLS_TEST_MAX_NUM_CONTEXTS 10
+#endif
+
 #ifndef U_CELL_SEC_TLS_TEST_CIPHER_1
 /** A cipher we know all cellular modules support:
  * TLS_RSA_WITH_3DES_EDE_CBC_SHA. */
@@ -483,6 +491,111 @@ U_PORT_TEST_FUNCTION("[cellSecTls]", "cellSecTlsSettings")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test caching of security contexts.
+ */
+U_PORT_TEST_FUNCTION("[cellSecTls]", "cellSecTlsCache")
+{
+    uDeviceHandle_t cellHandle;
+    int32_t heapUsed;
+    uCellSecTlsContext_t *pContexts[U_CELL_SEC_TLS_TEST_MAX_NUM_CONTEXTS] = {0};
+    uCellSecTlsContext_t *pContext;
+    char *pBuffer;
+    uint8_t profileId;
+    size_t numContexts = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    // malloc a buffer to put names in
+    pBuffer = (char *) malloc(U_CELL_SEC_TLS_TEST_NAME_LENGTH_BYTES + 1);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    // Nothing should be cached to begin with
+    U_PORT_TEST_ASSERT(pUCellSecSecTlsReuse(cellHandle, 1) == NULL);
+
+    // Add two security contexts, give one some settings and
+    // cache both under different keys
+    U_TEST_PRINT_LINE("adding and caching security contexts...");
+    pContexts[0] = pUCellSecSecTlsAdd(cellHandle);
+    U_PORT_TEST_ASSERT(pContexts[0] != NULL);
+    U_PORT_TEST_ASSERT(uCellSecTlsRootCaCertificateNameSet(pContexts[0], "test_name_1") == 0);
+    U_PORT_TEST_ASSERT(uCellSecTlsCache(pContexts[0], 1) == 0);
+    // Can't be cached twice
+    U_PORT_TEST_ASSERT(uCellSecTlsCache(pContexts[0], 2) < 0);
+    profileId = pContexts[0]->profileId;
+    pContexts[1] = pUCellSecSecTlsAdd(cellHandle);
+    U_PORT_TEST_ASSERT(pContexts[1] != NULL);
+    U_PORT_TEST_ASSERT(pContexts[1]->profileId != profileId);
+    U_PORT_TEST_ASSERT(uCellSecTlsCache(pContexts[1], 2) == 0);
+
+    // A cached context can be shared while it is in use
+    pContext = pUCellSecSecTlsReuse(cellHandle, 1);
+    U_PORT_TEST_ASSERT(pContext == pContexts[0]);
+    uCellSecTlsRemove(pContext);
+
+    // Remove both: they should remain available for re-use,
+    // settings intact, without the profiles being set up again
+    U_TEST_PRINT_LINE("re-using a cached security context...");
+    uCellSecTlsRemove(pContexts[0]);
+    uCellSecTlsRemove(pContexts[1]);
+    U_PORT_TEST_ASSERT(pUCellSecSecTlsReuse(cellHandle, 3) == NULL);
+    pContext = pUCellSecSecTlsReuse(cellHandle, 1);
+    U_PORT_TEST_ASSERT(pContext != NULL);
+    U_PORT_TEST_ASSERT(pContext->profileId == profileId);
+    U_PORT_TEST_ASSERT(uCellSecTlsRootCaCertificateNameGet(pContext, pBuffer,
+                                                           U_CELL_SEC_TLS_TEST_NAME_LENGTH_BYTES + 1) == 0);
+    U_PORT_TEST_ASSERT(strcmp(pBuffer, "test_name_1") == 0);
+    uCellSecTlsRemove(pContext);
+
+    // Use up all of the profiles: the cached ones, which are not
+    // in use, should be evicted to make room
+    U_TEST_PRINT_LINE("evicting cached security contexts...");
+    for (size_t x = 0; (x < sizeof(pContexts) / sizeof(pContexts[0])) &&
+         ((x == 0) || (pContexts[x - 1] != NULL)); x++) {
+        pContexts[x] = pUCellSecSecTlsAdd(cellHandle);
+        if (pContexts[x] != NULL) {
+            numContexts++;
+        }
+    }
+    uCellSecTlsResetLastError();
+    U_TEST_PRINT_LINE("%d security context(s) could be added.", numContexts);
+    U_PORT_TEST_ASSERT(numContexts >= 2);
+    U_PORT_TEST_ASSERT(pUCellSecSecTlsReuse(cellHandle, 1) == NULL);
+    U_PORT_TEST_ASSERT(pUCellSecSecTlsReuse(cellHandle, 2) == NULL);
+    for (size_t x = 0; x < numContexts; x++) {
+        uCellSecTlsRemove(pContexts[x]);
+    }
+
+    // Cache one more, which will be forgotten, and the
+    // memory freed, when the cellular instance is removed
+    pContext = pUCellSecSecTlsAdd(cellHandle);
+    U_PORT_TEST_ASSERT(pContext != NULL);
+    U_PORT_TEST_ASSERT(uCellSecTlsCache(pContext, 1) == 0);
+    uCellSecTlsRemove(pContext);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Release memory
+    free(pBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -36,8 +36,10 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memchr()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 #include "u_cfg_app_platform_specific.h"
 #include "u_cfg_test_platform_specific.h"
 
@@ -49,9 +51,11 @@
 #include "u_port_uart.h"
 
 #include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
 
 #include "u_cell_module_type.h"
 #include "u_cell.h"
+#include "u_cell_info.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -65,6 +69,25 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+#ifndef U_CELL_TEST_PARALLEL_LATENCY_MS
+/** The time the simulated modules of the parallel test take to
+ * respond to a command; long enough to swamp the time taken by the
+ * AT client itself.
+ */
+# define U_CELL_TEST_PARALLEL_LATENCY_MS 50
+#endif
+
+#ifndef U_CELL_TEST_PARALLEL_ITERATIONS
+/** The number of commands each task of the parallel test sends.
+ */
+# define U_CELL_TEST_PARALLEL_ITERATIONS 10
+#endif
+
+/** The response of the simulated modules of the parallel test
+ * to AT+CGSN.
+ */
+#define U_CELL_TEST_PARALLEL_RESPONSE "\r\n351234567890123\r\nOK\r\n"
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -81,10 +104,63 @@ static int32_t gUartAHandle = -1;
  */
 static int32_t gUartBHandle = -1;
 
+/** Handles of the memory streams used by the parallel test.
+ */
+static int32_t gStreamHandle[2] = {-1, -1};
+
+/** Set by the task of the parallel test when it has finished.
+ */
+static volatile bool gParallelTaskDone = false;
+
+/** The number of failures seen by the task of the parallel test.
+ */
+static volatile int32_t gParallelTaskErrorCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Transmit callback for the simulated modules of the parallel
+// test: once a command is complete, wait a while, as a real module
+// would, and then respond with an IMEI.
+static void parallelTransmitCallback(int32_t streamHandle, const char *pData,
+                                     size_t size, void *pParam)
+{
+    (void) pParam;
+
+    if (memchr(pData, '\r', size) != NULL) {
+        uPortTaskBlock(U_CELL_TEST_PARALLEL_LATENCY_MS);
+        uAtClientStreamMemoryPush(streamHandle, U_CELL_TEST_PARALLEL_RESPONSE,
+                                  sizeof(U_CELL_TEST_PARALLEL_RESPONSE) - 1);
+    }
+}
+
+// Read the IMEI from the given instance a number of times,
+// returning the number of failures.
+static int32_t parallelReadImei(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCount = 0;
+    char imei[U_CELL_INFO_IMEI_SIZE];
+
+    for (size_t x = 0; x < U_CELL_TEST_PARALLEL_ITERATIONS; x++) {
+        if (uCellInfoGetImei(cellHandle, imei) != 0) {
+            errorCount++;
+        }
+    }
+
+    return errorCount;
+}
+
+// Task for the parallel test: read the IMEI from the instance
+// passed in and exit.
+static void parallelTask(void *pParameters)
+{
+    gParallelTaskErrorCount = parallelReadImei((uDeviceHandle_t) pParameters);
+    gParallelTaskDone = true;
+
+    uPortTaskDelete(NULL);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -242,6 +318,78 @@ U_PORT_TEST_FUNCTION("[cell]", "cellAdd")
 }
 #endif
 
+/** Check that two cellular instances can be used in parallel,
+ * i.e. that a command in progress on one instance does not hold
+ * up the other.  Two modules are simulated, using memory streams,
+ * each of which takes #U_CELL_TEST_PARALLEL_LATENCY_MS to respond;
+ * the time taken to read the IMEI a number of times from one
+ * instance is measured and then the same is done on both instances
+ * at once, which should take about the same time rather than twice
+ * as long.
+ */
+U_PORT_TEST_FUNCTION("[cell]", "cellParallel")
+{
+    uAtClientHandle_t atClientHandle[2];
+    uDeviceHandle_t devHandle[2];
+    uPortTaskHandle_t taskHandle = NULL;
+    int32_t startTimeMs;
+    int32_t serialTimeMs;
+    int32_t parallelTimeMs;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    for (size_t x = 0; x < sizeof(devHandle) / sizeof(devHandle[0]); x++) {
+        gStreamHandle[x] = uAtClientStreamMemoryOpen(U_CELL_AT_BUFFER_LENGTH_BYTES,
+                                                     parallelTransmitCallback,
+                                                     NULL);
+        U_PORT_TEST_ASSERT(gStreamHandle[x] >= 0);
+        atClientHandle[x] = uAtClientAdd(gStreamHandle[x],
+                                         U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                         NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(atClientHandle[x] != NULL);
+        U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandle[x],
+                                    -1, -1, -1, false, &devHandle[x]) == 0);
+    }
+
+    U_TEST_PRINT_LINE("reading the IMEI %d time(s) from one instance...",
+                      U_CELL_TEST_PARALLEL_ITERATIONS);
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(parallelReadImei(devHandle[0]) == 0);
+    serialTimeMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+
+    U_TEST_PRINT_LINE("doing the same on both instances at once...");
+    gParallelTaskDone = false;
+    gParallelTaskErrorCount = 0;
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortTaskCreate(parallelTask, "cellParallel",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) devHandle[1],
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    U_PORT_TEST_ASSERT(parallelReadImei(devHandle[0]) == 0);
+    while (!gParallelTaskDone) {
+        uPortTaskBlock(10);
+    }
+    parallelTimeMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+    U_PORT_TEST_ASSERT(gParallelTaskErrorCount == 0);
+
+    U_TEST_PRINT_LINE("one instance took %d ms, two instances in parallel"
+                      " took %d ms.", serialTimeMs, parallelTimeMs);
+    // Were the instances serialised this would take twice as long
+    U_PORT_TEST_ASSERT(parallelTimeMs < (serialTimeMs * 3) / 2);
+
+    uCellDeinit();
+    for (size_t x = 0; x < sizeof(atClientHandle) / sizeof(atClientHandle[0]); x++) {
+        uAtClientRemove(atClientHandle[x]);
+        uAtClientStreamMemoryClose(gStreamHandle[x]);
+        gStreamHandle[x] = -1;
+    }
+    uAtClientDeinit();
+    uPortDeinit();
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -252,6 +400,11 @@ U_PORT_TEST_FUNCTION("[cell]", "cellCleanUp")
 
     uCellDeinit();
     uAtClientDeinit();
+    for (size_t y = 0; y < sizeof(gStreamHandle) / sizeof(gStreamHandle[0]); y++) {
+        if (gStreamHandle[y] >= 0) {
+            uAtClientStreamMemoryClose(gStreamHandle[y]);
+        }
+    }
     if (gUartAHandle >= 0) {
         uPortUartClose(gUartAHandle);
     }
@@ -277,6 +277,35 @@ extern "C" {
  */
 #define U_AT_CLIENT_BUFFER_LENGTH_BYTES (U_AT_CLIENT_BUFFER_OVERHEAD_BYTES + 64)
 
+#ifndef U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS
+/** The number of larger receive buffers, shared between all
+ * AT clients, that may be lent to an AT client whose own receive
+ * buffer has filled up, e.g. while a large response is being
+ * parsed; the AT client gives the block back when it has
+ * finished with it.  This allows the receive buffer passed to
+ * uAtClientAdd() to be sized for the usual case rather than
+ * the worst case, see uAtClientReceiveBufferStatsGet().  A block
+ * is allocated from the heap the first time it is needed and is
+ * kept until uAtClientDeinit() is called.  The default is zero,
+ * i.e. no borrowing, in which case the contents of a full receive
+ * buffer are thrown away, as they always have been: since the
+ * receive buffers of the cellular, short-range and BLE AT clients
+ * are already sized for the worst case, a block would only add
+ * to the heap used; set this to 1 or more when the receive buffers
+ * passed to uAtClientAdd() have been reduced.
+ */
+# define U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS 0
+#endif
+
+#ifndef U_AT_CLIENT_BUFFER_POOL_BLOCK_LENGTH_BYTES
+/** The size of each block in the shared receive buffer pool, see
+ * #U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS, including
+ * #U_AT_CLIENT_BUFFER_OVERHEAD_BYTES; an AT client with a receive
+ * buffer at least this big will never borrow a block.
+ */
+# define U_AT_CLIENT_BUFFER_POOL_BLOCK_LENGTH_BYTES (U_AT_CLIENT_BUFFER_OVERHEAD_BYTES + 2048)
+#endif
+
 /** The string to put on the end of an AT command.
  */
 #define U_AT_CLIENT_COMMAND_DELIMITER       "\r"
@@ -380,6 +409,13 @@ extern "C" {
 # define U_AT_CLIENT_MAX_NUM 5
 #endif
 
+#ifndef U_AT_CLIENT_WAKE_UP_BATCH_WINDOW_MS
+/** The default wake-up batch window in milliseconds, see
+ * uAtClientWakeUpBatchWindowSet(); zero means no batching.
+ */
+# define U_AT_CLIENT_WAKE_UP_BATCH_WINDOW_MS 0
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -388,13 +424,13 @@ extern "C" {
  */
 typedef void *uAtClientHandle_t;
 
-/** The types of underlying stream APIs supported, currently
- * only UART.
+/** The types of underlying stream APIs supported.
  */
 //lint -estring(788, uAtClientStream_t::U_AT_CLIENT_STREAM_TYPE_MAX) Suppress not used within defaulted switch
 typedef enum {
     U_AT_CLIENT_STREAM_TYPE_UART,
     U_AT_CLIENT_STREAM_TYPE_EDM,
+    U_AT_CLIENT_STREAM_TYPE_MEMORY, /**< see u_at_client_stream_memory.h. */
     U_AT_CLIENT_STREAM_TYPE_MAX
 } uAtClientStream_t;
 
@@ -415,6 +451,82 @@ typedef struct {
     int32_t code;
 } uAtClientDeviceError_t;
 
+/** Statistics concerning the wake-up handler, see
+ * uAtClientWakeUpStatsGet().  Commands sent by the wake-up
+ * handler itself are not counted.
+ */
+typedef struct {
+    int32_t numWakeUps;           /**< the number of times the wake-up
+                                       handler has been called. */
+    int32_t numCommands;          /**< the number of AT commands sent
+                                       while a wake-up handler was set;
+                                       numCommands / numWakeUps is the
+                                       average number of commands per
+                                       wake. */
+    int32_t maxCommandsPerWake;   /**< the largest number of AT commands
+                                       sent in a single wake window. */
+    int32_t wakeUpTimeTotalMs;    /**< the total time spent in the wake-up
+                                       handler. */
+    int32_t wakeUpTimeMaxMs;      /**< the longest time spent in the wake-up
+                                       handler. */
+    int32_t batchWaitTimeTotalMs; /**< the total time spent waiting in the
+                                       batch window, see
+                                       uAtClientWakeUpBatchWindowSet(). */
+} uAtClientWakeUpStats_t;
+
+/** Statistics concerning the receive buffer of an AT client,
+ * see uAtClientReceiveBufferStatsGet().
+ */
+typedef struct {
+    size_t highWaterMarkBytes; /**< the largest amount of data that
+                                    has been held in the receive
+                                    buffer, not including
+                                    #U_AT_CLIENT_BUFFER_OVERHEAD_BYTES;
+                                    if this is more than the size
+                                    of the receive buffer then a block
+                                    was borrowed from the pool, see
+                                    #U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS. */
+    int32_t numBorrows;        /**< the number of times a block was
+                                    borrowed from the pool. */
+    int32_t numOverflows;      /**< the number of times the receive
+                                    buffer filled up and no block
+                                    could be borrowed, hence received
+                                    data was thrown away. */
+} uAtClientReceiveBufferStats_t;
+
+/** The priority with which a task may lock an AT client, see
+ * uAtClientLockPriority().
+ */
+typedef enum {
+    U_AT_CLIENT_LOCK_PRIORITY_LOW,    /**< for long-running background work,
+                                           e.g. a network scan or reading
+                                           a large file. */
+    U_AT_CLIENT_LOCK_PRIORITY_NORMAL, /**< the priority used by uAtClientLock(). */
+    U_AT_CLIENT_LOCK_PRIORITY_HIGH,   /**< for latency-critical traffic. */
+    U_AT_CLIENT_LOCK_PRIORITY_MAX_NUM
+} uAtClientLockPriority_t;
+
+/** Lock statistics for one priority, see uAtClientLockStatsGet().
+ */
+typedef struct {
+    int32_t numLocks;        /**< the number of times the AT client
+                                  was locked at this priority. */
+    int32_t waitTimeTotalMs; /**< the total time spent waiting for
+                                  the lock at this priority. */
+    int32_t waitTimeMaxMs;   /**< the longest time spent waiting for
+                                  the lock at this priority. */
+} uAtClientLockPriorityStats_t;
+
+/** Lock statistics for an AT client, see uAtClientLockStatsGet().
+ * Locks taken by a wake-up handler are not counted.
+ */
+typedef struct {
+    /** The statistics for each priority, indexed by #uAtClientLockPriority_t. */
+    uAtClientLockPriorityStats_t priority[U_AT_CLIENT_LOCK_PRIORITY_MAX_NUM];
+    int32_t numYields; /**< the number of times uAtClientLockYield()
+                            gave the lock away. */
+} uAtClientLockStats_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INITIALISATION AND CONFIGURATION
  * -------------------------------------------------------------- */
@@ -633,6 +745,61 @@ void uAtClientDelaySet(uAtClientHandle_t atHandle,
  */
 void uAtClientLock(uAtClientHandle_t atHandle);
 
+/** As uAtClientLock() but with a priority: while tasks are
+ * waiting for the lock, a task of higher priority will get it
+ * before a task of lower priority; tasks of the same priority get
+ * the lock in whatever order the operating system chooses.  The
+ * exception is a task that started waiting when no task of a
+ * different priority was waiting: that task waits in the operating
+ * system, without polling, and so will get the lock ahead of a task
+ * of higher priority that starts waiting after it.  A task that
+ * already has the lock is never interrupted:
+ * if it is doing something that involves a long sequence of AT
+ * commands it should call uAtClientLockYield() between them to let
+ * higher priority tasks in.  uAtClientLock() is the same as calling
+ * this function with #U_AT_CLIENT_LOCK_PRIORITY_NORMAL.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @param priority  the priority.
+ */
+void uAtClientLockPriority(uAtClientHandle_t atHandle,
+                           uAtClientLockPriority_t priority);
+
+/** A preemption point: if a task of higher priority than that
+ * of the task that currently has the lock is waiting for it,
+ * unlock, let that task (and any others of higher priority)
+ * do their thing and then lock again at the original priority.
+ * This must only be called between AT commands, i.e. after
+ * uAtClientResponseStop() and before the next
+ * uAtClientCommandStart(), by the task that has the lock.  Any
+ * AT timeout set with uAtClientTimeoutSet() is retained.  If an
+ * error has occurred the lock is not given away so that the
+ * error is still returned by uAtClientUnlock().  Does nothing
+ * if called from a wake-up handler.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @return          true if the lock was given away and retaken,
+ *                  else false.
+ */
+bool uAtClientLockYield(uAtClientHandle_t atHandle);
+
+/** Get the lock statistics for an AT client; these are accumulated
+ * from when the AT client was added or when uAtClientLockStatsReset()
+ * was last called and can be used to check the time that tasks of
+ * a given priority spend waiting for the lock.
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param[out] pStats a place to put the statistics, cannot be NULL.
+ */
+void uAtClientLockStatsGet(const uAtClientHandle_t atHandle,
+                           uAtClientLockStats_t *pStats);
+
+/** Reset the lock statistics for an AT client.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientLockStatsReset(uAtClientHandle_t atHandle);
+
 /** Unlock the stream.  This MUST be called to release
  * the AT client lock, otherwise the AT client will hang
  * on a subsequent call to uAtClientLock().
@@ -1401,6 +1568,73 @@ int32_t uAtClientSetWakeUpHandler(uAtClientHandle_t atHandle,
  */
 bool uAtClientWakeUpHandlerIsSet(const uAtClientHandle_t atHandle);
 
+/** Set a batch window for the wake-up handler.  Where several
+ * tasks each send AT commands independently, spaced apart in
+ * time by more than the inactivityTimeoutMs passed to
+ * uAtClientSetWakeUpHandler(), every one of them will pay the cost
+ * of waking the module up.  With a batch window set, the task that
+ * finds the module needs waking will first wait for windowMs,
+ * during which any other tasks that want to send AT commands will
+ * queue up behind it; all of them are then served in the same
+ * wake window, the module being woken only once.  This trades
+ * the latency of the first command for fewer wake-ups and hence
+ * less energy consumption; the AT timeout of the first command is
+ * not affected by the wait.  The setting is retained if the
+ * wake-up handler is removed and set again.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @param windowMs  the batch window in milliseconds, zero (the
+ *                  default unless #U_AT_CLIENT_WAKE_UP_BATCH_WINDOW_MS
+ *                  is overridden) to switch batching off.
+ * @return          zero on success else negative error code.
+ */
+int32_t uAtClientWakeUpBatchWindowSet(uAtClientHandle_t atHandle,
+                                      int32_t windowMs);
+
+/** Get the batch window for the wake-up handler.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @return          the batch window in milliseconds.
+ */
+int32_t uAtClientWakeUpBatchWindowGet(const uAtClientHandle_t atHandle);
+
+/** Get the wake-up statistics for an AT client; these are
+ * accumulated from when the AT client was added or when
+ * uAtClientWakeUpStatsReset() was last called.
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param[out] pStats a place to put the statistics, cannot be NULL.
+ */
+void uAtClientWakeUpStatsGet(const uAtClientHandle_t atHandle,
+                             uAtClientWakeUpStats_t *pStats);
+
+/** Reset the wake-up statistics for an AT client.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientWakeUpStatsReset(uAtClientHandle_t atHandle);
+
+/** Get the receive buffer statistics for an AT client; these are
+ * accumulated from when the AT client was added or when
+ * uAtClientReceiveBufferStatsReset() was last called.  Use
+ * highWaterMarkBytes to choose the receive buffer size passed to
+ * uAtClientAdd(): if the application can live with the occasional
+ * large response borrowing a block from the shared pool (see
+ * #U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS) then the receive buffer need
+ * only be big enough for the usual case.
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param[out] pStats a place to put the statistics, cannot be NULL.
+ */
+void uAtClientReceiveBufferStatsGet(const uAtClientHandle_t atHandle,
+                                    uAtClientReceiveBufferStats_t *pStats);
+
+/** Reset the receive buffer statistics for an AT client.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientReceiveBufferStatsReset(uAtClientHandle_t atHandle);
+
 /** Set an "activity" pin.  This is useful where the module at the
  * other end of the link requires a pin to be raised or lowered while
  * this MCU is actively communicating over the AT interface (i.e.
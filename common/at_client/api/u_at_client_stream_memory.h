@@ -0,0 +1,220 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_AT_CLIENT_STREAM_MEMORY_H_
+#define _U_AT_CLIENT_STREAM_MEMORY_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _AT-client
+ *  @{
+ */
+
+/** @file
+ * @brief An in-memory stream which the AT client can use in place
+ * of a UART, stream type #U_AT_CLIENT_STREAM_TYPE_MEMORY.  Whatever
+ * the AT client writes to the stream is passed to a callback and
+ * whatever is pushed into the stream with uAtClientStreamMemoryPush()
+ * is received by the AT client as if it had come from a module.  This
+ * allows the AT client, or code built upon it, to be driven from
+ * recorded module transcripts, e.g. for testing or for measuring
+ * parser performance, without any hardware.
+ *
+ * The functions uAtClientStreamMemoryRead() onwards are the stream
+ * interface used by the AT client; they mirror the equivalent
+ * uPortUartXxx() functions and should not normally be called by
+ * the application.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_AT_CLIENT_STREAM_MEMORY_MAX_NUM
+/** The maximum number of memory streams that may be open at
+ * any one time.
+ */
+# define U_AT_CLIENT_STREAM_MEMORY_MAX_NUM 2
+#endif
+
+#ifndef U_AT_CLIENT_STREAM_MEMORY_EVENT_QUEUE_SIZE
+/** The length of the event queue used to signal that data has
+ * been pushed into a memory stream.
+ */
+# define U_AT_CLIENT_STREAM_MEMORY_EVENT_QUEUE_SIZE 20
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Open a memory stream.
+ *
+ * @param receiveBufferSizeBytes the amount of data, in bytes, that
+ *                               can be pushed into the stream with
+ *                               uAtClientStreamMemoryPush() before
+ *                               it is read by the AT client; this
+ *                               amount of memory is allocated from
+ *                               the heap.
+ * @param[in] pTransmitCallback  a function that will be called with
+ *                               whatever the AT client writes to the
+ *                               stream, may be NULL in which case the
+ *                               data is thrown away.  The callback is
+ *                               called in the context of the task that
+ *                               is using the AT client, with the AT
+ *                               client locked, and so may call
+ *                               uAtClientStreamMemoryPush() (e.g. to
+ *                               send a response) but must not call
+ *                               into the AT client.
+ * @param[in] pTransmitParam     a parameter that will be passed to
+ *                               pTransmitCallback as its last
+ *                               parameter, may be NULL.
+ * @return                       the handle of the stream, to be passed
+ *                               to uAtClientAdd(), else negative error
+ *                               code.
+ */
+int32_t uAtClientStreamMemoryOpen(size_t receiveBufferSizeBytes,
+                                  void (*pTransmitCallback) (int32_t,
+                                                             const char *,
+                                                             size_t,
+                                                             void *),
+                                  void *pTransmitParam);
+
+/** Close a memory stream; the AT client using it must have been
+ * removed first.
+ *
+ * @param streamHandle the handle of the stream.
+ */
+void uAtClientStreamMemoryClose(int32_t streamHandle);
+
+/** Push data into a memory stream, to be received by the AT client.
+ * The data is copied; nothing is pushed unless there is room for
+ * all of it.
+ *
+ * @param streamHandle the handle of the stream.
+ * @param[in] pData    the data to push.
+ * @param sizeBytes    the number of bytes at pData.
+ * @return             the number of bytes pushed, which will be
+ *                     sizeBytes, U_ERROR_COMMON_NO_MEMORY if there
+ *                     is not currently room for all of the data,
+ *                     else negative error code.
+ */
+int32_t uAtClientStreamMemoryPush(int32_t streamHandle,
+                                  const char *pData, size_t sizeBytes);
+
+/** Read data from a memory stream; equivalent to uPortUartRead().
+ *
+ * @param streamHandle the handle of the stream.
+ * @param[out] pBuffer a place to put the data.
+ * @param sizeBytes    the amount of storage at pBuffer.
+ * @return             the number of bytes read else negative error
+ *                     code.
+ */
+int32_t uAtClientStreamMemoryRead(int32_t streamHandle, char *pBuffer,
+                                  size_t sizeBytes);
+
+/** Write data to a memory stream; equivalent to uPortUartWrite().
+ *
+ * @param streamHandle the handle of the stream.
+ * @param[in] pData    the data to write.
+ * @param sizeBytes    the number of bytes at pData.
+ * @return             the number of bytes written else negative error
+ *                     code.
+ */
+int32_t uAtClientStreamMemoryWrite(int32_t streamHandle,
+                                   const char *pData, size_t sizeBytes);
+
+/** Get the number of bytes waiting to be read from a memory stream;
+ * equivalent to uPortUartGetReceiveSize().
+ *
+ * @param streamHandle the handle of the stream.
+ * @return             the number of bytes waiting else negative error
+ *                     code.
+ */
+int32_t uAtClientStreamMemoryGetReceiveSize(int32_t streamHandle);
+
+/** Set the callback that is called, in its own task, when data has
+ * been pushed into a memory stream; equivalent to
+ * uPortUartEventCallbackSet().
+ *
+ * @param streamHandle   the handle of the stream.
+ * @param[in] pFunction  the function to call, cannot be NULL.
+ * @param[in] pParam     a parameter that will be passed to pFunction
+ *                       as its last parameter.
+ * @param stackSizeBytes the stack size of the task in which pFunction
+ *                       will be called.
+ * @param priority       the priority of that task.
+ * @return               zero on success else negative error code.
+ */
+int32_t uAtClientStreamMemoryCallbackSet(int32_t streamHandle,
+                                         void (*pFunction) (int32_t,
+                                                            uint32_t,
+                                                            void *),
+                                         void *pParam,
+                                         size_t stackSizeBytes,
+                                         int32_t priority);
+
+/** Remove the callback set with uAtClientStreamMemoryCallbackSet().
+ *
+ * @param streamHandle the handle of the stream.
+ */
+void uAtClientStreamMemoryCallbackRemove(int32_t streamHandle);
+
+/** Determine if we are in the callback task of a memory stream;
+ * equivalent to uPortUartEventIsCallback().
+ *
+ * @param streamHandle the handle of the stream.
+ * @return             true if the caller is in the callback task.
+ */
+bool uAtClientStreamMemoryEventIsCallback(int32_t streamHandle);
+
+/** Send a data event to the callback of a memory stream;
+ * equivalent to uPortUartEventSend().
+ *
+ * @param streamHandle the handle of the stream.
+ * @param eventBitMap  the events, only
+ *                     #U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED
+ *                     is supported.
+ * @return             zero on success else negative error code.
+ */
+int32_t uAtClientStreamMemoryEventSend(int32_t streamHandle,
+                                       uint32_t eventBitMap);
+
+/** Get the minimum free stack of the callback task of a memory
+ * stream; equivalent to uPortUartEventStackMinFree().
+ *
+ * @param streamHandle the handle of the stream.
+ * @return             the minimum free stack in bytes else negative
+ *                     error code.
+ */
+int32_t uAtClientStreamMemoryEventStackMinFree(int32_t streamHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_AT_CLIENT_STREAM_MEMORY_H_
+
+// End of file
@@ -61,6 +61,8 @@
 #include "u_short_range.h"
 #include "u_short_range_edm_stream.h"
 
+#include "u_at_client_stream_memory.h"
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
@@ -203,6 +205,14 @@
 # define U_AT_CLIENT_ACTIVITY_PIN_HYSTERESIS_INTERVAL_MS 10
 #endif
 
+#ifndef U_AT_CLIENT_LOCK_PRIORITY_INTERVAL_MS
+/** While waiting for the lock behind a task of higher priority,
+ * the interval at which to check if it is our turn; value in
+ * milliseconds.
+ */
+# define U_AT_CLIENT_LOCK_PRIORITY_INTERVAL_MS 10
+#endif
+
 /** The mutex stack, used when locking the stream mutex, required
  * because when the wake-up handler is active there will be two
  * stream mutexes that may be locked: the normal one and the
@@ -381,6 +391,11 @@ typedef struct uAtClientInstance_t {
     uPortMutexHandle_t streamMutex; /** Mutex for the data stream. */
     uPortMutexHandle_t urcPermittedMutex; /** Mutex that we can use to avoid trampling on a URC. */
     uAtClientReceiveBuffer_t *pReceiveBuffer; /** Pointer to the receive buffer structure. */
+    uAtClientReceiveBuffer_t *pReceiveBufferOwn; /** Pointer to the AT client's own receive
+                                                     buffer structure: differs from
+                                                     pReceiveBuffer while a block is borrowed
+                                                     from the receive buffer pool. */
+    uAtClientReceiveBufferStats_t receiveBufferStats; /** Statistics concerning the receive buffer. */
     bool debugOn; /** Whether general debug is on or off. */
     bool printAtOn; /** Whether printing of AT commands and responses is on or off. */
     int32_t atTimeoutMs; /** The current AT timeout in milliseconds. */
@@ -416,10 +431,26 @@ typedef struct uAtClientInstance_t {
     void *pInterceptRxContext; /** Context pointer that will be passed to pInterceptRx
                                    as its fourth parameter. */
     uAtClientWakeUp_t *pWakeUp; /** Pointer to a wake-up handler structure. */
+    int32_t wakeUpBatchWindowMs; /** How long to wait before calling the wake-up handler. */
+    uAtClientWakeUpStats_t wakeUpStats; /** Statistics concerning the wake-up handler. */
+    int32_t wakeUpNumCommandsThisWake; /** The number of AT commands in the current wake window. */
     uAtClientActivityPin_t *pActivityPin; /** Pointer to an activity pin structure. */
+    int32_t lockNumWaiting[U_AT_CLIENT_LOCK_PRIORITY_MAX_NUM]; /** The number of tasks waiting
+                                                                   for the lock at each priority. */
+    uAtClientLockPriority_t lockPriority; /** The priority of the task that has the lock. */
+    uAtClientLockStats_t lockStats; /** Statistics concerning the lock. */
     struct uAtClientInstance_t *pNext;
 } uAtClientInstance_t;
 
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+/** A block in the shared receive buffer pool.
+ */
+typedef struct {
+    uAtClientReceiveBuffer_t *pBuffer; /** NULL until the block is first needed. */
+    const uAtClientInstance_t *pClient; /** The AT client the block is lent to, NULL if free. */
+} uAtClientBufferPoolBlock_t;
+#endif
+
 #ifdef U_CFG_AT_CLIENT_DETAILED_DEBUG
 /** Structure used for detailed debugging of the AT client
  * buffering behaviour, used in particular to debug the
@@ -509,6 +540,16 @@ static int32_t gEventQueueHandle;
  */
 static uPortMutexHandle_t gMutexEventQueue = NULL;
 
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+/** The receive buffer pool, shared between all AT clients.
+ */
+static uAtClientBufferPoolBlock_t gBufferPool[U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS] = {0};
+
+/** Mutex to protect gBufferPool.
+ */
+static uPortMutexHandle_t gMutexBufferPool = NULL;
+#endif
+
 #ifdef U_CFG_AT_CLIENT_DETAILED_DEBUG
 /** Array for detailed debugging.
  */
@@ -703,6 +744,28 @@ static void removeAtClientInstance(const uAtClientInstance_t *pClient)
     }
 }
 
+// Release any block that has been lent to the given AT client
+// from the receive buffer pool, without moving any data.
+static void bufferPoolRelease(const uAtClientInstance_t *pClient)
+{
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+    if (gMutexBufferPool != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutexBufferPool);
+
+        for (size_t x = 0; x < sizeof(gBufferPool) / sizeof(gBufferPool[0]); x++) {
+            if (gBufferPool[x].pClient == pClient) {
+                gBufferPool[x].pClient = NULL;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexBufferPool);
+    }
+#else
+    (void) pClient;
+#endif
+}
+
 // Remove an AT client.
 // gMutex should be locked before this is called.
 static void removeClient(uAtClientInstance_t *pClient)
@@ -739,6 +802,9 @@ static void removeClient(uAtClientInstance_t *pClient)
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             uShortRangeEdmStreamAtCallbackRemove(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+            uAtClientStreamMemoryCallbackRemove(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -753,9 +819,11 @@ static void removeClient(uAtClientInstance_t *pClient)
     // Remove any activity pin
     free(pClient->pActivityPin);
 
-    // Free the receive buffer if it was malloc()ed.
-    if (pClient->pReceiveBuffer->isMalloced) {
-        free(pClient->pReceiveBuffer);
+    // Give back any block borrowed from the receive buffer
+    // pool and free the receive buffer if it was malloc()ed.
+    bufferPoolRelease(pClient);
+    if (pClient->pReceiveBufferOwn->isMalloced) {
+        free(pClient->pReceiveBufferOwn);
     }
 
     // Unlock its main mutex so that we can delete it
@@ -894,6 +962,50 @@ static uPortMutexHandle_t streamLock(const uAtClientInstance_t *pClient)
     return streamMutex;
 }
 
+// Add increment to the number of tasks waiting for the lock
+// at the given priority.
+static void lockNumWaitingAdd(uAtClientInstance_t *pClient,
+                              uAtClientLockPriority_t priority,
+                              int32_t increment)
+{
+    bool inCritical = (uPortEnterCritical() == 0);
+
+    pClient->lockNumWaiting[priority] += increment;
+
+    if (inCritical) {
+        uPortExitCritical();
+    }
+}
+
+// Return true if a task of higher priority than that
+// given is waiting for the lock.
+static bool lockHigherPriorityWaiting(const uAtClientInstance_t *pClient,
+                                      uAtClientLockPriority_t priority)
+{
+    bool waiting = false;
+
+    for (int32_t x = (int32_t) priority + 1;
+         !waiting && (x < (int32_t) U_AT_CLIENT_LOCK_PRIORITY_MAX_NUM); x++) {
+        waiting = (pClient->lockNumWaiting[x] > 0);
+    }
+
+    return waiting;
+}
+
+// Return true if a task of a priority other than that
+// given is waiting for the lock.
+static bool lockOtherPriorityWaiting(const uAtClientInstance_t *pClient,
+                                     uAtClientLockPriority_t priority)
+{
+    bool waiting = false;
+
+    for (int32_t x = 0; !waiting && (x < (int32_t) U_AT_CLIENT_LOCK_PRIORITY_MAX_NUM); x++) {
+        waiting = (x != (int32_t) priority) && (pClient->lockNumWaiting[x] > 0);
+    }
+
+    return waiting;
+}
+
 // Try to lock an AT stream, returning the one that was locked or NULL.
 static uPortMutexHandle_t streamTryLock(const uAtClientInstance_t *pClient,
                                         int32_t timeoutMs)
@@ -925,6 +1037,58 @@ static uPortMutexHandle_t streamTryLock(const uAtClientInstance_t *pClient,
     return streamMutex;
 }
 
+// Lock the stream at the given priority, giving way to any
+// tasks of higher priority that are waiting.
+static uPortMutexHandle_t streamLockPriority(uAtClientInstance_t *pClient,
+                                             uAtClientLockPriority_t priority)
+{
+    uPortMutexHandle_t streamMutex = NULL;
+    uAtClientLockPriorityStats_t *pStats;
+    int32_t startTimeMs;
+    int32_t waitTimeMs;
+
+    if ((pClient->pWakeUp != NULL) && (pClient->pWakeUp->wakeUpTask != NULL) &&
+        uPortTaskIsThis(pClient->pWakeUp->wakeUpTask)) {
+        // The wake-up handler is already inside the lock
+        // of another task and must never be held up
+        streamMutex = streamLock(pClient);
+    } else {
+        startTimeMs = uPortGetTickTimeMs();
+        lockNumWaitingAdd(pClient, priority, 1);
+        // If no task of another priority is waiting then the order
+        // doesn't matter and we simply queue in the OS, saving the
+        // polling.  Otherwise back off while a task of higher
+        // priority is waiting and, if there isn't one, use a timed
+        // "try".  Note that a task in a timed "try" is still queued
+        // in the OS on the stream mutex, as is one in a plain lock;
+        // either may get the lock ahead of a task of higher priority
+        // that starts waiting after it.  For a timed "try" that is
+        // limited to the current holder letting go within
+        // U_AT_CLIENT_LOCK_PRIORITY_INTERVAL_MS; a plain lock waits
+        // until it gets the lock
+        while (streamMutex == NULL) {
+            if (lockHigherPriorityWaiting(pClient, priority)) {
+                uPortTaskBlock(U_AT_CLIENT_LOCK_PRIORITY_INTERVAL_MS);
+            } else if (lockOtherPriorityWaiting(pClient, priority)) {
+                streamMutex = streamTryLock(pClient, U_AT_CLIENT_LOCK_PRIORITY_INTERVAL_MS);
+            } else {
+                streamMutex = streamLock(pClient);
+            }
+        }
+        lockNumWaitingAdd(pClient, priority, -1);
+        pClient->lockPriority = priority;
+        waitTimeMs = uPortGetTickTimeMs() - startTimeMs;
+        pStats = &(pClient->lockStats.priority[priority]);
+        pStats->numLocks++;
+        pStats->waitTimeTotalMs += waitTimeMs;
+        if (waitTimeMs > pStats->waitTimeMaxMs) {
+            pStats->waitTimeMaxMs = waitTimeMs;
+        }
+    }
+
+    return streamMutex;
+}
+
 // Find one character buffer inside another.
 static const char *pMemStr(const char *pBuffer,
                            size_t bufferLength,
@@ -952,6 +1116,22 @@ static void printAt(const uAtClientInstance_t *pClient,
     char c;
 
     if (pClient->printAtOn) {
+#ifdef U_CFG_LOG_BINARY
+        // A binary log record per character would be wasteful,
+        // log the AT string in chunks; the decoder deals with
+        // any control characters
+        size_t x;
+        (void) c;
+        while (length > 0) {
+            x = length;
+            if (x > U_LOG_BINARY_STRING_MAX_LENGTH_BYTES) {
+                x = U_LOG_BINARY_STRING_MAX_LENGTH_BYTES;
+            }
+            uPortLog("%.*s", (int) x, pAt);
+            pAt += x;
+            length -= x;
+        }
+#else
         for (size_t x = 0; x < length; x++) {
             c = *pAt++;
             if (!isprint((int32_t) c)) {
@@ -973,6 +1153,7 @@ static void printAt(const uAtClientInstance_t *pClient,
                 uPortLog("%c", c);
             }
         }
+#endif
     }
 }
 
@@ -1122,6 +1303,98 @@ static void bufferRewind(const uAtClientInstance_t *pClient)
     }
 }
 
+// Write the protection markers at either end of a receive
+// buffer structure; dataBufferSize must have been set.
+static void bufferMarkersSet(uAtClientReceiveBuffer_t *pBuffer)
+{
+    memcpy(pBuffer->mk0, U_AT_CLIENT_MARKER, U_AT_CLIENT_MARKER_SIZE);
+    memcpy(U_AT_CLIENT_DATA_BUFFER_PTR(pBuffer) + pBuffer->dataBufferSize,
+           U_AT_CLIENT_MARKER, U_AT_CLIENT_MARKER_SIZE);
+}
+
+// Called when the receive buffer is full: borrow a larger block
+// from the receive buffer pool and move the contents of the
+// receive buffer into it.  Returns true if a block was borrowed,
+// in which case pClient->pReceiveBuffer will have changed.
+static bool bufferBorrow(uAtClientInstance_t *pClient)
+{
+    bool borrowed = false;
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+    uAtClientReceiveBuffer_t *pOwn = pClient->pReceiveBuffer;
+    uAtClientReceiveBuffer_t *pBlock = NULL;
+
+    if ((gMutexBufferPool != NULL) && (pOwn == pClient->pReceiveBufferOwn) &&
+        (pOwn->dataBufferSize < U_AT_CLIENT_BUFFER_POOL_BLOCK_LENGTH_BYTES -
+         U_AT_CLIENT_BUFFER_OVERHEAD_BYTES)) {
+
+        U_PORT_MUTEX_LOCK(gMutexBufferPool);
+
+        for (size_t x = 0; (pBlock == NULL) &&
+             (x < sizeof(gBufferPool) / sizeof(gBufferPool[0])); x++) {
+            if (gBufferPool[x].pClient == NULL) {
+                if (gBufferPool[x].pBuffer == NULL) {
+                    // First use of this block, allocate it
+                    gBufferPool[x].pBuffer = (uAtClientReceiveBuffer_t *)
+                                             malloc(U_AT_CLIENT_BUFFER_POOL_BLOCK_LENGTH_BYTES);
+                    if (gBufferPool[x].pBuffer != NULL) {
+                        // Not for the AT client to free
+                        gBufferPool[x].pBuffer->isMalloced = 0;
+                        gBufferPool[x].pBuffer->dataBufferSize = U_AT_CLIENT_BUFFER_POOL_BLOCK_LENGTH_BYTES -
+                                                                 U_AT_CLIENT_BUFFER_OVERHEAD_BYTES;
+                        bufferMarkersSet(gBufferPool[x].pBuffer);
+                    }
+                }
+                if (gBufferPool[x].pBuffer != NULL) {
+                    gBufferPool[x].pClient = pClient;
+                    pBlock = gBufferPool[x].pBuffer;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexBufferPool);
+
+        if (pBlock != NULL) {
+            pBlock->length = pOwn->length;
+            pBlock->lengthBuffered = pOwn->lengthBuffered;
+            pBlock->readIndex = pOwn->readIndex;
+            memcpy(U_AT_CLIENT_DATA_BUFFER_PTR(pBlock),
+                   U_AT_CLIENT_DATA_BUFFER_PTR(pOwn), pOwn->lengthBuffered);
+            U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBlock));
+            pClient->pReceiveBuffer = pBlock;
+            pClient->receiveBufferStats.numBorrows++;
+            borrowed = true;
+        }
+    }
+#else
+    (void) pClient;
+#endif
+
+    return borrowed;
+}
+
+// If a block has been borrowed from the receive buffer pool,
+// give it back, provided that the data remaining in it will fit
+// into the AT client's own receive buffer.
+static void bufferGiveBack(uAtClientInstance_t *pClient)
+{
+    uAtClientReceiveBuffer_t *pBlock = pClient->pReceiveBuffer;
+    uAtClientReceiveBuffer_t *pOwn = pClient->pReceiveBufferOwn;
+
+    if (pBlock != pOwn) {
+        bufferRewind(pClient);
+        if (pBlock->lengthBuffered < pOwn->dataBufferSize) {
+            pOwn->length = pBlock->length;
+            pOwn->lengthBuffered = pBlock->lengthBuffered;
+            pOwn->readIndex = pBlock->readIndex;
+            memcpy(U_AT_CLIENT_DATA_BUFFER_PTR(pOwn),
+                   U_AT_CLIENT_DATA_BUFFER_PTR(pBlock), pBlock->lengthBuffered);
+            U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pOwn));
+            pClient->pReceiveBuffer = pOwn;
+            bufferPoolRelease(pClient);
+        }
+    }
+}
+
 // Read from the UART interface in nice coherent lines.
 static int32_t uartReadNoStutter(uAtClientInstance_t *pClient,
                                  uAtClientBlockState_t blockState,
@@ -1193,6 +1466,9 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             eventIsCallback = uShortRangeEdmStreamAtEventIsCallback(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+            eventIsCallback = uAtClientStreamMemoryEventIsCallback(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -1246,8 +1522,14 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
     }
 
-    // Reset buffer if it has become full
+    // If the buffer has become full, borrow a bigger one
+    // from the pool or, if that's not possible, reset it
+    if ((pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) &&
+        bufferBorrow(pClient)) {
+        pReceiveBuffer = pClient->pReceiveBuffer;
+    }
     if (pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) {
+        pClient->receiveBufferStats.numOverflows++;
 #if U_CFG_OS_CLIB_LEAKS
         // If the C library leaks then don't print
         // in a callback as it will leak
@@ -1284,6 +1566,13 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                                                         pReceiveBuffer->dataBufferSize -
                                                         pReceiveBuffer->length);
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+                readLength = uAtClientStreamMemoryRead(pClient->streamHandle,
+                                                       U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                                                       pReceiveBuffer->length,
+                                                       pReceiveBuffer->dataBufferSize -
+                                                       pReceiveBuffer->length);
+                break;
             default:
                 break;
         }
@@ -1295,6 +1584,9 @@ static bool bufferFill(uAtClientInstance_t *pClient,
             // available in the buffer for the AT client as
             // there may be an intercept function in the way
             pReceiveBuffer->lengthBuffered += readLength;
+            if (pReceiveBuffer->lengthBuffered > pClient->receiveBufferStats.highWaterMarkBytes) {
+                pClient->receiveBufferStats.highWaterMarkBytes = pReceiveBuffer->lengthBuffered;
+            }
             // length starts out as the amount of data that has not yet
             // been successfully processed by the intercept function
             length += readLength;
@@ -1477,7 +1769,9 @@ static int32_t bufferReadChar(uAtClientInstance_t *pClient)
         // Everything has been read, try to bring more in
         bufferReset(pClient, false);
         if (bufferFill(pClient, true)) {
-            // Read something, all good
+            // Read something, all good; note that
+            // bufferFill() may have moved the buffer
+            pReceiveBuffer = pClient->pReceiveBuffer;
             character = (unsigned char) * (U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
                                            pReceiveBuffer->readIndex);
             pReceiveBuffer->readIndex++;
@@ -1978,6 +2272,7 @@ static size_t write(uAtClientInstance_t *pClient,
     const char *pDataToWrite = pData;
     int32_t savedLockTimeMs;
     int32_t wakeUpDurationMs = 0;
+    int32_t batchWaitDurationMs = 0;
     uAtClientScope_t savedScope;
     uAtClientTag_t savedStopTag;
     bool savedDelimiterRequired;
@@ -2006,6 +2301,17 @@ static size_t write(uAtClientInstance_t *pClient,
             // waking-up takes in order to correct for it
             savedLockTimeMs = pClient->lockTimeMs;
             wakeUpDurationMs = uPortGetTickTimeMs();
+            if (pClient->wakeUpBatchWindowMs > 0) {
+                // Wait for the batch window: any other tasks that
+                // want to talk to the module in that time will
+                // queue up behind us and so will be served in the
+                // same wake window without needing to wake it again
+                uPortTaskBlock(pClient->wakeUpBatchWindowMs);
+                batchWaitDurationMs = uPortGetTickTimeMs() - wakeUpDurationMs;
+                if (batchWaitDurationMs < 0) {
+                    batchWaitDurationMs = 0;
+                }
+            }
             // Remember the dynamic things that the
             // wake-up handler might overwrite
             savedScope = pClient->scope;
@@ -2043,7 +2349,17 @@ static size_t write(uAtClientInstance_t *pClient,
                 pClient->lockTimeMs = savedLockTimeMs + wakeUpDurationMs;
             } else {
                 pClient->lockTimeMs = uPortGetTickTimeMs();
+                wakeUpDurationMs = batchWaitDurationMs;
             }
+            // Update the statistics, a new wake window begins
+            wakeUpDurationMs -= batchWaitDurationMs;
+            pClient->wakeUpStats.numWakeUps++;
+            pClient->wakeUpStats.wakeUpTimeTotalMs += wakeUpDurationMs;
+            if (wakeUpDurationMs > pClient->wakeUpStats.wakeUpTimeMaxMs) {
+                pClient->wakeUpStats.wakeUpTimeMaxMs = wakeUpDurationMs;
+            }
+            pClient->wakeUpStats.batchWaitTimeTotalMs += batchWaitDurationMs;
+            pClient->wakeUpNumCommandsThisWake = 0;
             // We are no longer in the wake-up handler
             uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex);
         }
@@ -2084,6 +2400,11 @@ static size_t write(uAtClientInstance_t *pClient,
                     // Write handled in intercept
                     case U_AT_CLIENT_STREAM_TYPE_EDM:
                         break;
+                    case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+                        thisLengthWritten = uAtClientStreamMemoryWrite(pClient->streamHandle,
+                                                                       pDataToWrite,
+                                                                       lengthToWrite);
+                        break;
                     default:
                         break;
                 }
@@ -2186,6 +2507,9 @@ static uPortMutexHandle_t tryLock(uAtClientInstance_t *pClient)
 static void unlockNoDataCheck(uAtClientInstance_t *pClient,
                               uPortMutexHandle_t streamMutex)
 {
+    // Give back any block borrowed from the receive buffer pool
+    bufferGiveBack(pClient);
+
     if ((pClient->pWakeUp != NULL) &&
         ((uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) != 0) ||
          // This just to unlock the mutex if the try actually succeeded
@@ -2300,6 +2624,9 @@ static int32_t getReceiveSizeForUrc(const uAtClientInstance_t *pClient)
             case U_AT_CLIENT_STREAM_TYPE_EDM:
                 receiveSize = uShortRangeEdmStreamAtGetReceiveSize(pClient->streamHandle);
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+                receiveSize = uAtClientStreamMemoryGetReceiveSize(pClient->streamHandle);
+                break;
             default:
                 break;
         }
@@ -2371,9 +2698,12 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
                             // Start the cycle again as if we'd just done
                             // uAtClientLock()
                             pClient->lockTimeMs = uPortGetTickTimeMs();
+                            // bufferFill() may have moved the buffer
+                            pReceiveBuffer = pClient->pReceiveBuffer;
                         } else {
                             // There is no more data: clear anything that
                             // could not be handled and leave this loop
+                            pReceiveBuffer = pClient->pReceiveBuffer;
                             bufferReset(pClient, false);
                             break;
                         }
@@ -2465,6 +2795,16 @@ int32_t uAtClientInit()
             if (errorCodeOrHandle == 0) {
                 // Create the mutex that protects the linked list
                 errorCodeOrHandle = uPortMutexCreate(&gMutex);
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+                if (errorCodeOrHandle == 0) {
+                    // Create the mutex that protects the receive buffer pool
+                    errorCodeOrHandle = uPortMutexCreate(&gMutexBufferPool);
+                    if (errorCodeOrHandle != 0) {
+                        uPortMutexDelete(gMutex);
+                        gMutex = NULL;
+                    }
+                }
+#endif
                 if (errorCodeOrHandle != 0) {
                     // Failed, release the callbacks event queue again
                     // and its mutex
@@ -2501,6 +2841,19 @@ void uAtClientDeinit()
         U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
         uPortMutexDelete(gMutexEventQueue);
         gMutexEventQueue = NULL;
+
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+        // Free the receive buffer pool: nothing can
+        // be borrowing from it now
+        for (size_t x = 0; x < sizeof(gBufferPool) / sizeof(gBufferPool[0]); x++) {
+            free(gBufferPool[x].pBuffer);
+            gBufferPool[x].pBuffer = NULL;
+            gBufferPool[x].pClient = NULL;
+        }
+        uPortMutexDelete(gMutexBufferPool);
+        gMutexBufferPool = NULL;
+#endif
+
         U_PORT_MUTEX_UNLOCK(gMutex);
         uPortMutexDelete(gMutex);
         gMutex = NULL;
@@ -2564,17 +2917,15 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
                         // This will also set stopTag
                         setScope(pClient, U_AT_CLIENT_SCOPE_NONE);
                         pClient->lastTxTimeMs = -1;
+                        pClient->wakeUpBatchWindowMs = U_AT_CLIENT_WAKE_UP_BATCH_WINDOW_MS;
                         pClient->urcMaxStringLength = U_AT_CLIENT_INITIAL_URC_LENGTH;
                         pClient->maxRespLength = U_AT_CLIENT_MAX_LENGTH_INFORMATION_RESPONSE_PREFIX;
                         // Set up the buffer and its protection markers
+                        pClient->pReceiveBufferOwn = pClient->pReceiveBuffer;
                         pClient->pReceiveBuffer->dataBufferSize = receiveBufferSize -
                                                                   U_AT_CLIENT_BUFFER_OVERHEAD_BYTES;
                         bufferReset(pClient, true);
-                        memcpy(pClient->pReceiveBuffer->mk0, U_AT_CLIENT_MARKER,
-                               U_AT_CLIENT_MARKER_SIZE);
-                        memcpy(U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer) +
-                               pClient->pReceiveBuffer->dataBufferSize,
-                               U_AT_CLIENT_MARKER, U_AT_CLIENT_MARKER_SIZE);
+                        bufferMarkersSet(pClient->pReceiveBuffer);
                         // Now add an event handler for characters
                         // received on the stream
                         switch (streamType) {
@@ -2588,6 +2939,12 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
                             case U_AT_CLIENT_STREAM_TYPE_EDM:
                                 errorCode = uShortRangeEdmStreamAtCallbackSet(streamHandle, urcCallback, pClient);
                                 break;
+                            case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+                                errorCode = uAtClientStreamMemoryCallbackSet(streamHandle,
+                                                                             urcCallback, pClient,
+                                                                             U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                                             U_AT_CLIENT_URC_TASK_PRIORITY);
+                                break;
                             default:
                                 // streamType is checked on entry
                                 break;
@@ -2795,16 +3152,28 @@ void uAtClientDelaySet(uAtClientHandle_t atHandle,
 
 // Lock the stream.
 void uAtClientLock(uAtClientHandle_t atHandle)
+{
+    uAtClientLockPriority(atHandle, U_AT_CLIENT_LOCK_PRIORITY_NORMAL);
+}
+
+// Lock the stream with a priority.
+void uAtClientLockPriority(uAtClientHandle_t atHandle,
+                           uAtClientLockPriority_t priority)
 {
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
     uPortMutexHandle_t streamMutex;
 
+    if ((priority < U_AT_CLIENT_LOCK_PRIORITY_LOW) ||
+        (priority >= U_AT_CLIENT_LOCK_PRIORITY_MAX_NUM)) {
+        priority = U_AT_CLIENT_LOCK_PRIORITY_NORMAL;
+    }
+
     // IMPORTANT: this can't lock pClient->mutex as it
     // needs to wait on the stream mutex and if it locked
     // pClient->mutex that would prevent uAtClientUnlock()
     // from working.
     if ((pClient != NULL) && (pClient->streamMutex != NULL)) {
-        streamMutex = streamLock(pClient);
+        streamMutex = streamLockPriority(pClient, priority);
         mutexStackPush(&(pClient->lockedStreamMutexStack), streamMutex);
         if (pClient->pActivityPin != NULL) {
             while (uPortGetTickTimeMs() - pClient->pActivityPin->lastToggleTime <
@@ -2870,6 +3239,14 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
                                                     U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
                 }
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+                sizeBytes = uAtClientStreamMemoryGetReceiveSize(pClient->streamHandle);
+                if ((sizeBytes > 0) ||
+                    (pClient->pReceiveBuffer->readIndex < pClient->pReceiveBuffer->length)) {
+                    uAtClientStreamMemoryEventSend(pClient->streamHandle,
+                                                   U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+                }
+                break;
             default:
                 break;
         }
@@ -2882,6 +3259,64 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
     return (int32_t) pClient->error;
 }
 
+// Give the lock to a waiting task of higher priority.
+bool uAtClientLockYield(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    bool yielded = false;
+    uAtClientLockPriority_t priority;
+    int32_t atTimeoutMs;
+    int32_t atTimeoutSavedMs;
+
+    // Can't do this from the wake-up handler, which is
+    // running inside the lock of another task
+    if ((pClient != NULL) && (pClient->error == U_ERROR_COMMON_SUCCESS) &&
+        ((pClient->pWakeUp == NULL) || (pClient->pWakeUp->wakeUpTask == NULL)) &&
+        lockHigherPriorityWaiting(pClient, pClient->lockPriority)) {
+        priority = pClient->lockPriority;
+        // Keep any timeout the caller has set, which
+        // uAtClientUnlock() would otherwise put back
+        atTimeoutMs = pClient->atTimeoutMs;
+        atTimeoutSavedMs = pClient->atTimeoutSavedMs;
+        pClient->atTimeoutSavedMs = -1;
+        uAtClientUnlock(atHandle);
+        uAtClientLockPriority(atHandle, priority);
+        pClient->atTimeoutMs = atTimeoutMs;
+        pClient->atTimeoutSavedMs = atTimeoutSavedMs;
+        pClient->lockStats.numYields++;
+        yielded = true;
+    }
+
+    return yielded;
+}
+
+// Get the lock statistics.
+void uAtClientLockStatsGet(const uAtClientHandle_t atHandle,
+                           uAtClientLockStats_t *pStats)
+{
+    const uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pStats != NULL) {
+        *pStats = pClient->lockStats;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Reset the lock statistics.
+void uAtClientLockStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    memset(&(pClient->lockStats), 0, sizeof(pClient->lockStats));
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
 // Start an AT command sequence.
 void uAtClientCommandStart(uAtClientHandle_t atHandle,
                            const char *pCommand)
@@ -2906,6 +3341,15 @@ void uAtClientCommandStart(uAtClientHandle_t atHandle,
         if (pCommand != NULL) {
             write(pClient, pCommand, strlen(pCommand), false);
         }
+        // Count the commands per wake window, ignoring
+        // those sent from within the wake-up handler itself
+        if ((pClient->pWakeUp != NULL) && (pClient->pWakeUp->wakeUpTask == NULL)) {
+            pClient->wakeUpStats.numCommands++;
+            pClient->wakeUpNumCommandsThisWake++;
+            if (pClient->wakeUpNumCommandsThisWake > pClient->wakeUpStats.maxCommandsPerWake) {
+                pClient->wakeUpStats.maxCommandsPerWake = pClient->wakeUpNumCommandsThisWake;
+            }
+        }
     }
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
@@ -3438,6 +3882,8 @@ int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
                         } else {
                             pClient->numConsecutiveAtTimeouts = 0;
                         }
+                        // bufferFill() may have moved the buffer
+                        pReceiveBuffer = pClient->pReceiveBuffer;
                     } else {
                         if (uPortGetTickTimeMs() > stopTimeMs) {
                             // If we're stuck, set an error
@@ -3567,6 +4013,9 @@ int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle)
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             stackMinFree = uShortRangeEdmStreamAtEventStackMinFree(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_MEMORY:
+            stackMinFree = uAtClientStreamMemoryEventStackMinFree(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -3897,6 +4346,95 @@ bool uAtClientWakeUpHandlerIsSet(const uAtClientHandle_t atHandle)
     return ((const uAtClientInstance_t *) atHandle)->pWakeUp != NULL;
 }
 
+// Set the wake-up batch window.
+int32_t uAtClientWakeUpBatchWindowSet(uAtClientHandle_t atHandle,
+                                      int32_t windowMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (windowMs >= 0) {
+        pClient->wakeUpBatchWindowMs = windowMs;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCode;
+}
+
+// Get the wake-up batch window.
+int32_t uAtClientWakeUpBatchWindowGet(const uAtClientHandle_t atHandle)
+{
+    int32_t windowMs;
+    const uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    windowMs = pClient->wakeUpBatchWindowMs;
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return windowMs;
+}
+
+// Get the wake-up statistics.
+void uAtClientWakeUpStatsGet(const uAtClientHandle_t atHandle,
+                             uAtClientWakeUpStats_t *pStats)
+{
+    const uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pStats != NULL) {
+        *pStats = pClient->wakeUpStats;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Reset the wake-up statistics.
+void uAtClientWakeUpStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    memset(&(pClient->wakeUpStats), 0, sizeof(pClient->wakeUpStats));
+    pClient->wakeUpNumCommandsThisWake = 0;
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Get the receive buffer statistics.
+void uAtClientReceiveBufferStatsGet(const uAtClientHandle_t atHandle,
+                                    uAtClientReceiveBufferStats_t *pStats)
+{
+    const uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pStats != NULL) {
+        *pStats = pClient->receiveBufferStats;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Reset the receive buffer statistics.
+void uAtClientReceiveBufferStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    memset(&(pClient->receiveBufferStats), 0, sizeof(pClient->receiveBufferStats));
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
 // Set an "activity" pin.
 int32_t uAtClientSetActivityPin(uAtClientHandle_t atHandle,
                                 int32_t pin, int32_t readyMs,
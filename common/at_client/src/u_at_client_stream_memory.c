@@ -0,0 +1,476 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the in-memory stream for the AT client.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc() and free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port_os.h"
+#include "u_port_uart.h"
+#include "u_port_event_queue.h"
+
+#include "u_ringbuffer.h"
+
+#include "u_at_client_stream_memory.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A memory stream.
+ */
+typedef struct {
+    bool inUse;
+    char *pLinearBuffer;
+    uRingBuffer_t ringBuffer;
+    void (*pTransmitCallback) (int32_t, const char *, size_t, void *);
+    void *pTransmitParam;
+    int32_t eventQueueHandle;
+    void (*pEventCallback) (int32_t, uint32_t, void *);
+    void *pEventCallbackParam;
+} uAtClientStreamMemory_t;
+
+/** An event sent to the event queue of a memory stream.
+ */
+typedef struct {
+    int32_t streamHandle;
+    uint32_t eventBitMap;
+} uAtClientStreamMemoryEvent_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect the memory streams, only exists while
+ * at least one is open.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** The memory streams.
+ */
+static uAtClientStreamMemory_t gStream[U_AT_CLIENT_STREAM_MEMORY_MAX_NUM] = {0};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the stream for a handle, NULL if there is none.
+static uAtClientStreamMemory_t *pGetStream(int32_t streamHandle)
+{
+    uAtClientStreamMemory_t *pStream = NULL;
+
+    if ((streamHandle >= 0) &&
+        (streamHandle < (int32_t) (sizeof(gStream) / sizeof(gStream[0]))) &&
+        gStream[streamHandle].inUse) {
+        pStream = &(gStream[streamHandle]);
+    }
+
+    return pStream;
+}
+
+// Event handler, calls the user's event callback.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    const uAtClientStreamMemoryEvent_t *pEvent = (uAtClientStreamMemoryEvent_t *) pParam;
+    uAtClientStreamMemory_t *pStream;
+
+    (void) paramLength;
+
+    // Don't lock the mutex: uAtClientStreamMemoryCallbackRemove()
+    // closes the event queue, which makes sure this exits cleanly,
+    // and the callback will want to call into this API
+    pStream = pGetStream(pEvent->streamHandle);
+    if ((pStream != NULL) && (pStream->pEventCallback != NULL)) {
+        pStream->pEventCallback(pEvent->streamHandle, pEvent->eventBitMap,
+                                pStream->pEventCallbackParam);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Open a memory stream.
+int32_t uAtClientStreamMemoryOpen(size_t receiveBufferSizeBytes,
+                                  void (*pTransmitCallback) (int32_t,
+                                                             const char *,
+                                                             size_t,
+                                                             void *),
+                                  void *pTransmitParam)
+{
+    int32_t handleOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientStreamMemory_t *pStream = NULL;
+
+    if (receiveBufferSizeBytes > 0) {
+        handleOrErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (gMutex == NULL) {
+            handleOrErrorCode = uPortMutexCreate(&gMutex);
+        }
+        if (handleOrErrorCode == 0) {
+
+            U_PORT_MUTEX_LOCK(gMutex);
+
+            handleOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            for (size_t x = 0; (pStream == NULL) &&
+                 (x < sizeof(gStream) / sizeof(gStream[0])); x++) {
+                if (!gStream[x].inUse) {
+                    pStream = &(gStream[x]);
+                    handleOrErrorCode = (int32_t) x;
+                }
+            }
+            if (pStream != NULL) {
+                memset(pStream, 0, sizeof(*pStream));
+                // +1 since the ring buffer uses one byte internally
+                pStream->pLinearBuffer = (char *) malloc(receiveBufferSizeBytes + 1);
+                if ((pStream->pLinearBuffer != NULL) &&
+                    (uRingBufferCreate(&(pStream->ringBuffer), pStream->pLinearBuffer,
+                                       receiveBufferSizeBytes + 1) == 0)) {
+                    pStream->pTransmitCallback = pTransmitCallback;
+                    pStream->pTransmitParam = pTransmitParam;
+                    pStream->eventQueueHandle = -1;
+                    pStream->inUse = true;
+                } else {
+                    free(pStream->pLinearBuffer);
+                    pStream->pLinearBuffer = NULL;
+                    handleOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(gMutex);
+        }
+    }
+
+    return handleOrErrorCode;
+}
+
+// Close a memory stream.
+void uAtClientStreamMemoryClose(int32_t streamHandle)
+{
+    uAtClientStreamMemory_t *pStream;
+    bool anyInUse = false;
+
+    if (gMutex != NULL) {
+        // Do this first, outside the mutex, as the
+        // event handler may be calling into this API
+        uAtClientStreamMemoryCallbackRemove(streamHandle);
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pStream = pGetStream(streamHandle);
+        if (pStream != NULL) {
+            uRingBufferDelete(&(pStream->ringBuffer));
+            free(pStream->pLinearBuffer);
+            memset(pStream, 0, sizeof(*pStream));
+        }
+        for (size_t x = 0; x < sizeof(gStream) / sizeof(gStream[0]); x++) {
+            anyInUse = anyInUse || gStream[x].inUse;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (!anyInUse) {
+            uPortMutexDelete(gMutex);
+            gMutex = NULL;
+        }
+    }
+}
+
+// Push data into a memory stream.
+int32_t uAtClientStreamMemoryPush(int32_t streamHandle,
+                                  const char *pData, size_t sizeBytes)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream;
+    uAtClientStreamMemoryEvent_t event;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && ((pData != NULL) || (sizeBytes == 0))) {
+            sizeOrErrorCode = 0;
+            if (sizeBytes > 0) {
+                // All or nothing: the caller must know if data was
+                // not pushed, otherwise the AT client would see a
+                // response with a hole in it
+                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if (uRingBufferAdd(&(pStream->ringBuffer), pData, sizeBytes)) {
+                    sizeOrErrorCode = (int32_t) sizeBytes;
+                    if (pStream->eventQueueHandle >= 0) {
+                        // Non-blocking: if the queue is full there
+                        // are events pending which will pick this up
+                        event.streamHandle = streamHandle;
+                        event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+                        uPortEventQueueSendIrq(pStream->eventQueueHandle,
+                                               &event, sizeof(event));
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Read from a memory stream.
+int32_t uAtClientStreamMemoryRead(int32_t streamHandle, char *pBuffer,
+                                  size_t sizeBytes)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && (pBuffer != NULL)) {
+            sizeOrErrorCode = (int32_t) uRingBufferRead(&(pStream->ringBuffer),
+                                                        pBuffer, sizeBytes);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Write to a memory stream.
+int32_t uAtClientStreamMemoryWrite(int32_t streamHandle,
+                                   const char *pData, size_t sizeBytes)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream = NULL;
+    void (*pTransmitCallback) (int32_t, const char *, size_t, void *) = NULL;
+    void *pTransmitParam = NULL;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && ((pData != NULL) || (sizeBytes == 0))) {
+            pTransmitCallback = pStream->pTransmitCallback;
+            pTransmitParam = pStream->pTransmitParam;
+            sizeOrErrorCode = (int32_t) sizeBytes;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        // Call the callback with the mutex unlocked so
+        // that it may call uAtClientStreamMemoryPush()
+        if ((sizeOrErrorCode > 0) && (pTransmitCallback != NULL)) {
+            pTransmitCallback(streamHandle, pData, sizeBytes, pTransmitParam);
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Get the number of bytes waiting to be read.
+int32_t uAtClientStreamMemoryGetReceiveSize(int32_t streamHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if (pStream != NULL) {
+            sizeOrErrorCode = (int32_t) uRingBufferDataSize(&(pStream->ringBuffer));
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Set the event callback.
+int32_t uAtClientStreamMemoryCallbackSet(int32_t streamHandle,
+                                         void (*pFunction) (int32_t,
+                                                            uint32_t,
+                                                            void *),
+                                         void *pParam,
+                                         size_t stackSizeBytes,
+                                         int32_t priority)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && (pStream->eventQueueHandle < 0) &&
+            (pFunction != NULL)) {
+            errorCode = uPortEventQueueOpen(eventHandler, "eventMemoryStream",
+                                            sizeof(uAtClientStreamMemoryEvent_t),
+                                            stackSizeBytes, priority,
+                                            U_AT_CLIENT_STREAM_MEMORY_EVENT_QUEUE_SIZE);
+            if (errorCode >= 0) {
+                pStream->eventQueueHandle = errorCode;
+                pStream->pEventCallback = pFunction;
+                pStream->pEventCallbackParam = pParam;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Remove the event callback.
+void uAtClientStreamMemoryCallbackRemove(int32_t streamHandle)
+{
+    uAtClientStreamMemory_t *pStream;
+    int32_t eventQueueHandle = -1;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pStream = pGetStream(streamHandle);
+        if (pStream != NULL) {
+            eventQueueHandle = pStream->eventQueueHandle;
+            pStream->eventQueueHandle = -1;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        // Close the queue outside the mutex as the event
+        // handler may be waiting on it
+        if (eventQueueHandle >= 0) {
+            uPortEventQueueClose(eventQueueHandle);
+        }
+        if (pStream != NULL) {
+            pStream->pEventCallback = NULL;
+            pStream->pEventCallbackParam = NULL;
+        }
+    }
+}
+
+// Determine if we are in the event callback task.
+bool uAtClientStreamMemoryEventIsCallback(int32_t streamHandle)
+{
+    bool isEventCallback = false;
+    uAtClientStreamMemory_t *pStream;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && (pStream->eventQueueHandle >= 0)) {
+            isEventCallback = uPortEventQueueIsTask(pStream->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return isEventCallback;
+}
+
+// Send an event to the event callback.
+int32_t uAtClientStreamMemoryEventSend(int32_t streamHandle,
+                                       uint32_t eventBitMap)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream;
+    uAtClientStreamMemoryEvent_t event;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && (pStream->eventQueueHandle >= 0) &&
+            (eventBitMap == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+            event.streamHandle = streamHandle;
+            event.eventBitMap = eventBitMap;
+            // Non-blocking, the caller may have the AT client locked
+            errorCode = uPortEventQueueSendIrq(pStream->eventQueueHandle,
+                                               &event, sizeof(event));
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the minimum free stack of the event callback task.
+int32_t uAtClientStreamMemoryEventStackMinFree(int32_t streamHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uAtClientStreamMemory_t *pStream;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pStream = pGetStream(streamHandle);
+        if ((pStream != NULL) && (pStream->eventQueueHandle >= 0)) {
+            sizeOrErrorCode = uPortEventQueueStackMinFree(pStream->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// End of file
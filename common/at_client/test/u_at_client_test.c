@@ -35,7 +35,7 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "stdlib.h"    // rand()
-#include "string.h"    // strlen(), memcmp()
+#include "string.h"    // strlen(), memcmp(), memset()
 #include "stdio.h"     // snprintf()
 #include "ctype.h"     // isprint()
 
@@ -55,6 +55,7 @@
 #include "u_port_uart.h"
 
 #include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
 #include "u_at_client_test.h"
 #include "u_at_client_test_data.h"
 
@@ -129,6 +130,70 @@
  * we need room for initial and trailing line endings. */
 #define U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES (256 + 4 + U_AT_CLIENT_BUFFER_OVERHEAD_BYTES)
 
+/** The receive buffer size of the memory stream used by the
+ * corpus test: must be big enough for the largest response in
+ * gAtClientTestCorpus[] and for the whole URC storm but NOT for
+ * two +USORD responses, that being used to check that data which
+ * does not fit is refused.
+ */
+#define U_AT_CLIENT_TEST_CORPUS_STREAM_BUFFER_LENGTH_BYTES 4096
+
+/** The number of times each entry in gAtClientTestCorpus[] is
+ * run through the AT client.
+ */
+#define U_AT_CLIENT_TEST_CORPUS_ITERATIONS 20
+
+/** The number of (binary) bytes in the +USORD response of the
+ * corpus test; they are hex encoded so the response is twice
+ * this length.
+ */
+#define U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES 1024
+
+/** The number of URCs in the URC storm of the corpus test.
+ */
+#define U_AT_CLIENT_TEST_CORPUS_URC_STORM_NUM 100
+
+/** How long to wait for the URC storm to be handled.
+ */
+#define U_AT_CLIENT_TEST_CORPUS_URC_STORM_TIMEOUT_MS 5000
+
+/** The length of the line of the response used by the buffer
+ * pool test: longer than the data part of a receive buffer of
+ * size #U_AT_CLIENT_BUFFER_LENGTH_BYTES, shorter than that of a
+ * block of size #U_AT_CLIENT_BUFFER_POOL_BLOCK_LENGTH_BYTES.
+ */
+#define U_AT_CLIENT_TEST_BUFFER_POOL_LINE_LENGTH_BYTES 200
+
+/** The maximum length of a line in gAtClientTestTranscript[],
+ * including a terminator.
+ */
+#define U_AT_CLIENT_TEST_TRANSCRIPT_LINE_MAX_LENGTH_BYTES 128
+
+/** The inactivity timeout used by the wake-up batch test.
+ */
+#define U_AT_CLIENT_TEST_WAKE_UP_INACTIVITY_TIMEOUT_MS 200
+
+/** The batch window used by the wake-up batch test.
+ */
+#define U_AT_CLIENT_TEST_WAKE_UP_BATCH_WINDOW_MS 1000
+
+/** The number of tasks, in addition to the test task, that send
+ * an AT command during the batch window of the wake-up batch test;
+ * they are spread across the window at intervals longer than
+ * the inactivity timeout so that, without batching, each of them
+ * would cause a wake-up.
+ */
+#define U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS 3
+
+/** The body of the recorded +COPS=? response in the corpus test.
+ */
+#define U_AT_CLIENT_TEST_CORPUS_COPS_BODY "(2,\"Vodafone UK\",\"Vodafone\",\"23415\",7),"  \
+                                          "(1,\"O2 - UK\",\"O2 - UK\",\"23410\",7),"     \
+                                          "(3,\"EE\",\"EE\",\"23430\",7),"               \
+                                          "(1,\"3 UK\",\"3 UK\",\"23420\",7),"           \
+                                          "(1,\"Vodafone UK\",\"Vodafone\",\"23415\",9)," \
+                                          ",(0,1,2,3,4),(0,1,2)"
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -145,6 +210,33 @@ typedef struct {
     int32_t responseLastError;
 } uAtClientTestCheckCommandResponse_t;
 
+/** An entry in the AT parser corpus: a recorded module response
+ * and a function that sends the command which provokes it and
+ * parses the result.
+ */
+typedef struct {
+    const char *pName;
+    const char *pResponse; /**< NULL if the response is built at run-time. */
+    size_t numUrcs; /**< The number of URCs embedded in pResponse. */
+    bool (*pParse) (uAtClientHandle_t atClientHandle);
+} uAtClientTestCorpus_t;
+
+/** Context for the transmit callback of the memory stream used
+ * by the corpus test.
+ */
+typedef struct {
+    const char *pResponse;
+    size_t responseLength;
+    bool responsePushed;
+} uAtClientTestCorpusContext_t;
+
+/** Parameters for a task of the wake-up batch test.
+ */
+typedef struct {
+    uAtClientHandle_t atClientHandle;
+    int32_t delayMs;
+} uAtClientTestWakeUpBatchTask_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -157,6 +249,60 @@ static int32_t gUartAHandle = -1;
  */
 static int32_t gUartBHandle = -1;
 
+/** Handle for the memory stream used by the corpus test.
+ */
+static int32_t gMemoryStreamHandle = -1;
+
+/** The number of URCs handled during the corpus test.
+ */
+static volatile size_t gCorpusUrcCount = 0;
+
+/** The number of URCs handled during the corpus test that
+ * did not contain what was expected.
+ */
+static volatile size_t gCorpusUrcErrorCount = 0;
+
+/** Set by lockHighPriorityTask() when it has the lock.
+ */
+static volatile bool gLockHighPriorityDone = false;
+
+/** The number of times wakeUpHandler() has been called.
+ */
+static volatile size_t gWakeUpCount = 0;
+
+/** The number of wakeUpBatchTask()s that have had "OK".
+ */
+static volatile size_t gWakeUpBatchTasksDone = 0;
+
+// Forward declarations for gAtClientTestCorpus[].
+static bool corpusParseUsord(uAtClientHandle_t atClientHandle);
+static bool corpusParseUcged(uAtClientHandle_t atClientHandle);
+static bool corpusParseCops(uAtClientHandle_t atClientHandle);
+
+/** The AT parser corpus: recorded module responses, including
+ * those that are large or have URCs embedded in them.  Note that
+ * the AT client only dispatches URCs that arrive before the
+ * information response to a command; a URC between the information
+ * response and the final result code is skipped, hence the +COPS=?
+ * response below counts only the +CEREG URC.
+ */
+static const uAtClientTestCorpus_t gAtClientTestCorpus[] = {
+    {"+USORD", NULL /* Built at run-time */, 0, corpusParseUsord},
+    {
+        "+UCGED",
+        "\r\n+UCGED: 2\r\n6,4,001,01\r\n"
+        "2525,5,50,50,e8fe,1a2d001,1,d60814d1,8001,01,28,31,13.75,3,1,10,28,-50,-6,0,255,255,0\r\n"
+        "\r\nOK\r\n",
+        0, corpusParseUcged
+    },
+    {
+        "+COPS=?",
+        "\r\n+CEREG: 5\r\n\r\n+COPS: " U_AT_CLIENT_TEST_CORPUS_COPS_BODY "\r\n"
+        "\r\n+UUSORD: 0,32\r\n\r\nOK\r\n",
+        1, corpusParseCops
+    }
+};
+
 #if (U_CFG_TEST_UART_A >= 0)
 
 /** Store the last consecutive AT time-out call-back here.
@@ -860,6 +1006,403 @@ static char *pInterceptRx(uAtClientHandle_t atHandle,
 # endif
 #endif
 
+// Return the hex character for the given nibble of the given
+// byte of the +USORD data used in the corpus test.
+static char corpusUsordHex(size_t index, bool highNibble)
+{
+    const char *pHex = "0123456789ABCDEF";
+    // Something that isn't just a repeating count
+    uint8_t byte = (uint8_t) ((index * 7) + (index >> 8));
+
+    return highNibble ? pHex[byte >> 4] : pHex[byte & 0x0f];
+}
+
+// Build the recorded +USORD response of the corpus test.
+static char *pCorpusUsordResponseBuild(size_t *pLength)
+{
+    char *pResponse;
+    size_t length = 0;
+    // Room for the hex, the prefix, the quotes and the trailing OK
+    size_t size = (U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES * 2) + 64;
+
+    pResponse = (char *) malloc(size);
+    if (pResponse != NULL) {
+        length = snprintf(pResponse, size, "\r\n+USORD: 0,%d,\"",
+                          U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES);
+        for (size_t x = 0; x < U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES; x++) {
+            *(pResponse + length) = corpusUsordHex(x, true);
+            length++;
+            *(pResponse + length) = corpusUsordHex(x, false);
+            length++;
+        }
+        length += snprintf(pResponse + length, size - length, "\"\r\nOK\r\n");
+    }
+    *pLength = length;
+
+    return pResponse;
+}
+
+// Send AT+USORD and parse the large, hex-encoded, response.
+static bool corpusParseUsord(uAtClientHandle_t atClientHandle)
+{
+    bool success = false;
+    char *pHex;
+    size_t hexSize = (U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES * 2) + 1;
+    int32_t x;
+    int32_t y;
+
+    pHex = (char *) malloc(hexSize);
+    if (pHex != NULL) {
+        uAtClientCommandStart(atClientHandle, "AT+USORD=");
+        uAtClientWriteInt(atClientHandle, 0);
+        uAtClientWriteInt(atClientHandle, U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES);
+        uAtClientCommandStop(atClientHandle);
+        uAtClientResponseStart(atClientHandle, "+USORD:");
+        uAtClientSkipParameters(atClientHandle, 1);
+        x = uAtClientReadInt(atClientHandle);
+        y = uAtClientReadString(atClientHandle, pHex, hexSize, false);
+        uAtClientResponseStop(atClientHandle);
+        if ((x == U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES) &&
+            (y == U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES * 2)) {
+            success = true;
+            for (size_t z = 0; success && (z < U_AT_CLIENT_TEST_CORPUS_USORD_LENGTH_BYTES); z++) {
+                success = (*(pHex + (z * 2)) == corpusUsordHex(z, true)) &&
+                          (*(pHex + (z * 2) + 1) == corpusUsordHex(z, false));
+            }
+        }
+        free(pHex);
+    }
+
+    return success;
+}
+
+// Send AT+UCGED? and parse the multi-line response, SARA-R5 style.
+static bool corpusParseUcged(uAtClientHandle_t atClientHandle)
+{
+    int32_t earfcn;
+    int32_t pcid;
+    int32_t rsrp;
+    int32_t rsrq;
+
+    uAtClientCommandStart(atClientHandle, "AT+UCGED?");
+    uAtClientCommandStop(atClientHandle);
+    uAtClientResponseStart(atClientHandle, "+UCGED:");
+    uAtClientSkipParameters(atClientHandle, 1);
+    uAtClientResponseStart(atClientHandle, NULL);
+    uAtClientSkipParameters(atClientHandle, 4);
+    uAtClientResponseStart(atClientHandle, NULL);
+    earfcn = uAtClientReadInt(atClientHandle);
+    uAtClientSkipParameters(atClientHandle, 5);
+    pcid = uAtClientReadInt(atClientHandle);
+    uAtClientSkipParameters(atClientHandle, 3);
+    rsrp = uAtClientReadInt(atClientHandle);
+    rsrq = uAtClientReadInt(atClientHandle);
+    uAtClientResponseStop(atClientHandle);
+
+    return (earfcn == 2525) && (pcid == 1) && (rsrp == 28) && (rsrq == 31);
+}
+
+// Send AT+COPS=? and read the response, which has URCs
+// embedded in it, the way uCellNetScanGetFirst() does.
+static bool corpusParseCops(uAtClientHandle_t atClientHandle)
+{
+    bool success = false;
+    char *pBuffer;
+    size_t length = sizeof(U_AT_CLIENT_TEST_CORPUS_COPS_BODY) - 1;
+    int32_t x;
+
+    pBuffer = (char *) malloc(length + 1);
+    if (pBuffer != NULL) {
+        uAtClientCommandStart(atClientHandle, "AT+COPS=?");
+        uAtClientCommandStop(atClientHandle);
+        uAtClientResponseStart(atClientHandle, "+COPS:");
+        x = uAtClientReadBytes(atClientHandle, pBuffer, length + 1, false);
+        uAtClientResponseStop(atClientHandle);
+        success = (x == (int32_t) length) &&
+                  (memcmp(pBuffer, U_AT_CLIENT_TEST_CORPUS_COPS_BODY, length) == 0);
+        free(pBuffer);
+    }
+
+    return success;
+}
+
+// Return the length of the line of a transcript that starts at
+// pLine, not including the "\n".
+static size_t transcriptLineLength(const char *pLine)
+{
+    const char *pEnd = strchr(pLine, '\n');
+
+    return pEnd != NULL ? pEnd - pLine : strlen(pLine);
+}
+
+// Return the line of a transcript after the one at pLine.
+static const char *pTranscriptLineNext(const char *pLine)
+{
+    pLine += transcriptLineLength(pLine);
+    if (*pLine == '\n') {
+        pLine++;
+    }
+
+    return pLine;
+}
+
+// Return true if the line of a transcript at pLine is a final
+// result code.
+static bool transcriptLineIsFinal(const char *pLine, size_t length)
+{
+    return ((length == 2) && (strncmp(pLine, "OK", length) == 0)) ||
+           ((length == 5) && (strncmp(pLine, "ERROR", length) == 0)) ||
+           (strncmp(pLine, "+CME ERROR:", 11) == 0) ||
+           (strncmp(pLine, "+CMS ERROR:", 11) == 0);
+}
+
+// Read a line of an information response from the AT client and
+// check that it matches the line of a transcript at pLine.
+static bool transcriptLineCheck(uAtClientHandle_t atClientHandle,
+                                const char *pLine, size_t length)
+{
+    char prefix[U_AT_CLIENT_TEST_TRANSCRIPT_LINE_MAX_LENGTH_BYTES];
+    char buffer[U_AT_CLIENT_TEST_TRANSCRIPT_LINE_MAX_LENGTH_BYTES];
+    const char *pColon = NULL;
+    size_t prefixLength = 0;
+    int32_t x;
+    int32_t y = 0;
+
+    if (*pLine == '+') {
+        pColon = (const char *) memchr(pLine, ':', length);
+    }
+    if (pColon != NULL) {
+        prefixLength = pColon - pLine + 1;
+        memcpy(prefix, pLine, prefixLength);
+        prefix[prefixLength] = 0;
+    }
+    uAtClientResponseStart(atClientHandle, pColon != NULL ? prefix : NULL);
+    uAtClientDelimiterSet(atClientHandle, '\x00');
+    x = uAtClientReadString(atClientHandle, buffer, sizeof(buffer), false);
+    uAtClientDelimiterSet(atClientHandle, ',');
+    pLine += prefixLength;
+    length -= prefixLength;
+    while ((length > 0) && (*pLine == ' ')) {
+        pLine++;
+        length--;
+    }
+    // uAtClientReadString() removes quotes, so skip them here
+    // while comparing
+    for (y = 0; (y < x) && (length > 0); pLine++, length--) {
+        if (*pLine != '\"') {
+            if (buffer[y] != *pLine) {
+                break;
+            }
+            y++;
+        }
+    }
+    while ((length > 0) && (*pLine == '\"')) {
+        pLine++;
+        length--;
+    }
+
+    return (x >= 0) && (y == x) && (length == 0);
+}
+
+// Replay a transcript from gAtClientTestTranscript[] through the
+// AT client, adding the number of URCs in it to *pNumUrcs.
+static bool transcriptReplay(uAtClientHandle_t atClientHandle,
+                             uAtClientTestCorpusContext_t *pContext,
+                             const char *pText, size_t *pNumUrcs)
+{
+    bool success = true;
+    char command[U_AT_CLIENT_TEST_TRANSCRIPT_LINE_MAX_LENGTH_BYTES];
+    char *pResponse;
+    const char *pLine;
+    const char *pFinal;
+    size_t length;
+    size_t responseSize;
+    size_t numLines;
+    int32_t x;
+
+    command[0] = 0;
+    while (success && (*pText != 0)) {
+        // The command
+        length = transcriptLineLength(pText);
+        success = (*pText == U_AT_CLIENT_TEST_TRANSCRIPT_COMMAND) &&
+                  (length < sizeof(command));
+        pResponse = NULL;
+        pFinal = NULL;
+        if (success) {
+            memcpy(command, pText + 1, length - 1);
+            command[length - 1] = 0;
+            pText = pTranscriptLineNext(pText);
+            // Find the final result code and work out how much
+            // room the response needs with line endings added
+            responseSize = 1;
+            for (pLine = pText; (pFinal == NULL) && (*pLine != 0) &&
+                 (*pLine != U_AT_CLIENT_TEST_TRANSCRIPT_COMMAND);
+                 pLine = pTranscriptLineNext(pLine)) {
+                length = transcriptLineLength(pLine);
+                responseSize += length + 4;
+                if (transcriptLineIsFinal(pLine, length)) {
+                    pFinal = pLine;
+                }
+            }
+            if (pFinal != NULL) {
+                pResponse = (char *) malloc(responseSize);
+            }
+            success = (pResponse != NULL);
+        }
+        if (success) {
+            pContext->responseLength = 0;
+            for (pLine = pText; pLine <= pFinal; pLine = pTranscriptLineNext(pLine)) {
+                length = transcriptLineLength(pLine);
+                if (*pLine == U_AT_CLIENT_TEST_TRANSCRIPT_URC) {
+                    pLine++;
+                    length--;
+                    (*pNumUrcs)++;
+                }
+                pContext->responseLength += snprintf(pResponse + pContext->responseLength,
+                                                     responseSize - pContext->responseLength,
+                                                     "\r\n%.*s\r\n", (int) length, pLine);
+            }
+            pContext->pResponse = pResponse;
+            pContext->responsePushed = false;
+            uAtClientLock(atClientHandle);
+            uAtClientCommandStart(atClientHandle, command);
+            uAtClientCommandStop(atClientHandle);
+            numLines = 0;
+            for (pLine = pText; pLine < pFinal; pLine = pTranscriptLineNext(pLine)) {
+                if (*pLine != U_AT_CLIENT_TEST_TRANSCRIPT_URC) {
+                    success = transcriptLineCheck(atClientHandle, pLine,
+                                                  transcriptLineLength(pLine)) && success;
+                    numLines++;
+                }
+            }
+            if (numLines == 0) {
+                // No information response, just wait for the
+                // final result code
+                uAtClientResponseStart(atClientHandle, NULL);
+            }
+            uAtClientResponseStop(atClientHandle);
+            x = uAtClientUnlock(atClientHandle);
+            // "OK" must give success, anything else an error
+            success = success && pContext->responsePushed &&
+                      ((x == 0) == (strncmp(pFinal, "OK\n", 3) == 0));
+            pContext->pResponse = NULL;
+            free(pResponse);
+            pText = pTranscriptLineNext(pFinal);
+        }
+        if (!success) {
+            U_TEST_PRINT_LINE("transcript failed at \"%s\".", command);
+        }
+    }
+
+    return success;
+}
+
+// Handler for the +CEREG URC of the corpus test.
+static void corpusCeregUrcHandler(uAtClientHandle_t atClientHandle, void *pParameters)
+{
+    (void) pParameters;
+
+    if (uAtClientReadInt(atClientHandle) != 5) {
+        gCorpusUrcErrorCount++;
+    }
+    gCorpusUrcCount++;
+}
+
+// Handler for the +UUSORD URC of the corpus test.
+static void corpusUusordUrcHandler(uAtClientHandle_t atClientHandle, void *pParameters)
+{
+    (void) pParameters;
+
+    if ((uAtClientReadInt(atClientHandle) != 0) ||
+        (uAtClientReadInt(atClientHandle) != 32)) {
+        gCorpusUrcErrorCount++;
+    }
+    gCorpusUrcCount++;
+}
+
+// Transmit callback for the memory stream of the corpus test:
+// once the command terminator has been sent by the AT client,
+// push the recorded response into the stream.
+static void corpusTransmitCallback(int32_t streamHandle, const char *pData,
+                                   size_t size, void *pParam)
+{
+    uAtClientTestCorpusContext_t *pContext = (uAtClientTestCorpusContext_t *) pParam;
+
+    if ((pContext->pResponse != NULL) && !pContext->responsePushed &&
+        (memchr(pData, '\r', size) != NULL)) {
+        pContext->responsePushed = (uAtClientStreamMemoryPush(streamHandle,
+                                                              pContext->pResponse,
+                                                              pContext->responseLength) ==
+                                    (int32_t) pContext->responseLength);
+    }
+}
+
+// Task used by the lock priority test: lock the AT client
+// at high priority, note that the lock was obtained and exit.
+static void lockHighPriorityTask(void *pParameters)
+{
+    uAtClientHandle_t atClientHandle = (uAtClientHandle_t) pParameters;
+
+    uAtClientLockPriority(atClientHandle, U_AT_CLIENT_LOCK_PRIORITY_HIGH);
+    gLockHighPriorityDone = true;
+    uAtClientUnlock(atClientHandle);
+
+    uPortTaskDelete(NULL);
+}
+
+// Transmit callback for a memory stream that responds
+// "OK" to every AT command.
+static void okTransmitCallback(int32_t streamHandle, const char *pData,
+                               size_t size, void *pParam)
+{
+    (void) pParam;
+
+    if (memchr(pData, '\r', size) != NULL) {
+        uAtClientStreamMemoryPush(streamHandle, "\r\nOK\r\n", 6);
+    }
+}
+
+// Send "AT" and wait for "OK".
+static int32_t sendAt(uAtClientHandle_t atClientHandle)
+{
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT");
+    uAtClientCommandStopReadResponse(atClientHandle);
+    return uAtClientUnlock(atClientHandle);
+}
+
+// Wake-up handler for the wake-up batch test, the way a
+// cellular module is woken: poke it with "AT".
+static int32_t wakeUpHandler(uAtClientHandle_t atClientHandle, void *pParam)
+{
+    (void) pParam;
+
+    gWakeUpCount++;
+
+    return sendAt(atClientHandle);
+}
+
+// Task used by the wake-up batch test: wait and then send
+// an AT command.
+static void wakeUpBatchTask(void *pParameters)
+{
+    uAtClientTestWakeUpBatchTask_t *pTask = (uAtClientTestWakeUpBatchTask_t *) pParameters;
+    uAtClientHandle_t atClientHandle = pTask->atClientHandle;
+
+    uPortTaskBlock(pTask->delayMs);
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT");
+    uAtClientCommandStopReadResponse(atClientHandle);
+    if (uAtClientErrorGet(atClientHandle) == 0) {
+        // Done with the AT client locked so that
+        // the tasks don't trample on each other
+        gWakeUpBatchTasksDone++;
+    }
+    uAtClientUnlock(atClientHandle);
+
+    uPortTaskDelete(NULL);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -1057,6 +1600,8 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientConfiguration")
     bool thingIsOn;
     int32_t x;
     char c;
+    uAtClientWakeUpStats_t wakeUpStats;
+    uAtClientReceiveBufferStats_t receiveBufferStats;
     int32_t heapUsed;
     int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
 
@@ -1133,6 +1678,38 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientConfiguration")
     U_TEST_PRINT_LINE("delay is now %d ms.", x);
     U_PORT_TEST_ASSERT(x == U_AT_CLIENT_DEFAULT_DELAY_MS + 1);
 
+    x = uAtClientWakeUpBatchWindowGet(atClientHandle);
+    U_TEST_PRINT_LINE("wake-up batch window is %d ms.", x);
+    U_PORT_TEST_ASSERT(x == U_AT_CLIENT_WAKE_UP_BATCH_WINDOW_MS);
+
+    x++;
+    U_PORT_TEST_ASSERT(uAtClientWakeUpBatchWindowSet(atClientHandle, x) == 0);
+    x = uAtClientWakeUpBatchWindowGet(atClientHandle);
+    U_TEST_PRINT_LINE("wake-up batch window is now %d ms.", x);
+    U_PORT_TEST_ASSERT(x == U_AT_CLIENT_WAKE_UP_BATCH_WINDOW_MS + 1);
+    U_PORT_TEST_ASSERT(uAtClientWakeUpBatchWindowSet(atClientHandle, -1) < 0);
+    U_PORT_TEST_ASSERT(uAtClientWakeUpBatchWindowGet(atClientHandle) == x);
+
+    // No wake-up handler, so the statistics should be empty
+    memset(&wakeUpStats, 0xFF, sizeof(wakeUpStats));
+    uAtClientWakeUpStatsGet(atClientHandle, &wakeUpStats);
+    U_PORT_TEST_ASSERT(wakeUpStats.numWakeUps == 0);
+    U_PORT_TEST_ASSERT(wakeUpStats.numCommands == 0);
+    U_PORT_TEST_ASSERT(wakeUpStats.maxCommandsPerWake == 0);
+    U_PORT_TEST_ASSERT(wakeUpStats.wakeUpTimeTotalMs == 0);
+    U_PORT_TEST_ASSERT(wakeUpStats.wakeUpTimeMaxMs == 0);
+    U_PORT_TEST_ASSERT(wakeUpStats.batchWaitTimeTotalMs == 0);
+    uAtClientWakeUpStatsReset(atClientHandle);
+
+    // Nothing has been received, so the receive buffer
+    // statistics should be empty
+    memset(&receiveBufferStats, 0xFF, sizeof(receiveBufferStats));
+    uAtClientReceiveBufferStatsGet(atClientHandle, &receiveBufferStats);
+    U_PORT_TEST_ASSERT(receiveBufferStats.highWaterMarkBytes == 0);
+    U_PORT_TEST_ASSERT(receiveBufferStats.numBorrows == 0);
+    U_PORT_TEST_ASSERT(receiveBufferStats.numOverflows == 0);
+    uAtClientReceiveBufferStatsReset(atClientHandle);
+
     // Can't do much with this other than set it
     U_TEST_PRINT_LINE("setting consecutive AT timeout callback...");
     uAtClientTimeoutCallbackSet(atClientHandle,
@@ -1728,6 +2305,461 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet2")
 # endif
 #endif
 
+/** Run the AT parser corpus, gAtClientTestCorpus[], the recorded
+ * transcripts, gAtClientTestTranscript[], and a storm of URCs
+ * through an AT client over an in-memory stream, checking
+ * the outcome and reporting parse latency, throughput and heap
+ * usage.  Requires no hardware.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientCorpus")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientTestCorpusContext_t context = {0};
+    const uAtClientTestCorpus_t *pCorpus;
+    char *pUsordResponse;
+    size_t usordResponseLength;
+    char *pStorm;
+    size_t stormLength = 0;
+    size_t stormSize = U_AT_CLIENT_TEST_CORPUS_URC_STORM_NUM * 16;
+    size_t numUrcs = 0;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t minMs;
+    int32_t maxMs;
+    int32_t totalMs;
+    int32_t heapFree;
+    int32_t heapUsed;
+    int32_t stackMinFree;
+    uAtClientReceiveBufferStats_t receiveBufferStats;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    pUsordResponse = pCorpusUsordResponseBuild(&usordResponseLength);
+    U_PORT_TEST_ASSERT(pUsordResponse != NULL);
+
+    gMemoryStreamHandle = uAtClientStreamMemoryOpen(U_AT_CLIENT_TEST_CORPUS_STREAM_BUFFER_LENGTH_BYTES,
+                                                    corpusTransmitCallback, &context);
+    U_PORT_TEST_ASSERT(gMemoryStreamHandle >= 0);
+
+    // Data that does not fit must be refused, not dropped
+    U_PORT_TEST_ASSERT(uAtClientStreamMemoryPush(gMemoryStreamHandle, pUsordResponse,
+                                                 usordResponseLength) ==
+                       (int32_t) usordResponseLength);
+    U_PORT_TEST_ASSERT(uAtClientStreamMemoryPush(gMemoryStreamHandle, pUsordResponse,
+                                                 usordResponseLength) ==
+                       (int32_t) U_ERROR_COMMON_NO_MEMORY);
+    U_PORT_TEST_ASSERT(uAtClientStreamMemoryGetReceiveSize(gMemoryStreamHandle) ==
+                       (int32_t) usordResponseLength);
+    // Read it out again, into the same place since it is the same data
+    U_PORT_TEST_ASSERT(uAtClientStreamMemoryRead(gMemoryStreamHandle, pUsordResponse,
+                                                 usordResponseLength) ==
+                       (int32_t) usordResponseLength);
+
+    U_TEST_PRINT_LINE("adding an AT client on memory stream %d...", gMemoryStreamHandle);
+    atClientHandle = uAtClientAdd(gMemoryStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, U_AT_CLIENT_TEST_AT_TIMEOUT_MS);
+
+    gCorpusUrcCount = 0;
+    gCorpusUrcErrorCount = 0;
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+CEREG:",
+                                              corpusCeregUrcHandler, NULL) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UUSORD:",
+                                              corpusUusordUrcHandler, NULL) == 0);
+
+    for (size_t x = 0; x < sizeof(gAtClientTestCorpus) / sizeof(gAtClientTestCorpus[0]); x++) {
+        pCorpus = &(gAtClientTestCorpus[x]);
+        if (pCorpus->pResponse != NULL) {
+            context.pResponse = pCorpus->pResponse;
+            context.responseLength = strlen(pCorpus->pResponse);
+        } else {
+            context.pResponse = pUsordResponse;
+            context.responseLength = usordResponseLength;
+        }
+        minMs = INT32_MAX;
+        maxMs = 0;
+        totalMs = 0;
+        heapFree = uPortGetHeapFree();
+        for (size_t y = 0; y < U_AT_CLIENT_TEST_CORPUS_ITERATIONS; y++) {
+            context.responsePushed = false;
+            startTimeMs = uPortGetTickTimeMs();
+            uAtClientLock(atClientHandle);
+            U_PORT_TEST_ASSERT(pCorpus->pParse(atClientHandle));
+            U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+            durationMs = uPortGetTickTimeMs() - startTimeMs;
+            U_PORT_TEST_ASSERT(context.responsePushed);
+            if (durationMs < minMs) {
+                minMs = durationMs;
+            }
+            if (durationMs > maxMs) {
+                maxMs = durationMs;
+            }
+            totalMs += durationMs;
+        }
+        numUrcs += pCorpus->numUrcs * U_AT_CLIENT_TEST_CORPUS_ITERATIONS;
+        U_TEST_PRINT_LINE("\"%s\" (%d byte(s)) x %d: latency min %d ms, average %d ms,"
+                          " max %d ms, %d byte(s)/second, heap change %d byte(s).",
+                          pCorpus->pName, context.responseLength,
+                          U_AT_CLIENT_TEST_CORPUS_ITERATIONS, minMs,
+                          totalMs / U_AT_CLIENT_TEST_CORPUS_ITERATIONS, maxMs,
+                          totalMs > 0 ? (int32_t) ((context.responseLength *
+                                                    U_AT_CLIENT_TEST_CORPUS_ITERATIONS * 1000) /
+                                                   totalMs) : -1,
+                          heapFree - uPortGetHeapFree());
+    }
+    context.pResponse = NULL;
+
+    // Replay the recorded transcripts
+    for (size_t x = 0; x < gAtClientTestTranscriptSize; x++) {
+        startTimeMs = uPortGetTickTimeMs();
+        heapFree = uPortGetHeapFree();
+        U_PORT_TEST_ASSERT(transcriptReplay(atClientHandle, &context,
+                                            gAtClientTestTranscript[x].pText,
+                                            &numUrcs));
+        U_TEST_PRINT_LINE("transcript \"%s\" (%d byte(s)) took %d ms, heap change"
+                          " %d byte(s).", gAtClientTestTranscript[x].pName,
+                          (int32_t) strlen(gAtClientTestTranscript[x].pText),
+                          uPortGetTickTimeMs() - startTimeMs,
+                          heapFree - uPortGetHeapFree());
+    }
+
+    // Now a storm of URCs, all arriving at once
+    pStorm = (char *) malloc(stormSize);
+    U_PORT_TEST_ASSERT(pStorm != NULL);
+    for (size_t x = 0; x < U_AT_CLIENT_TEST_CORPUS_URC_STORM_NUM; x++) {
+        if (x & 1) {
+            stormLength += snprintf(pStorm + stormLength, stormSize - stormLength,
+                                    "\r\n+UUSORD: 0,32\r\n");
+        } else {
+            stormLength += snprintf(pStorm + stormLength, stormSize - stormLength,
+                                    "\r\n+CEREG: 5\r\n");
+        }
+    }
+    numUrcs += U_AT_CLIENT_TEST_CORPUS_URC_STORM_NUM;
+    heapFree = uPortGetHeapFree();
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uAtClientStreamMemoryPush(gMemoryStreamHandle,
+                                                 pStorm, stormLength) == (int32_t) stormLength);
+    while ((gCorpusUrcCount < numUrcs) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_CORPUS_URC_STORM_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    free(pStorm);
+    U_TEST_PRINT_LINE("URC storm of %d URC(s) (%d byte(s)) took %d ms, heap change"
+                      " %d byte(s).", U_AT_CLIENT_TEST_CORPUS_URC_STORM_NUM,
+                      stormLength, durationMs, heapFree - uPortGetHeapFree());
+    U_TEST_PRINT_LINE("%d URC(s) handled in total, %d expected, %d in error.",
+                      gCorpusUrcCount, numUrcs, gCorpusUrcErrorCount);
+    U_PORT_TEST_ASSERT(gCorpusUrcCount == numUrcs);
+    U_PORT_TEST_ASSERT(gCorpusUrcErrorCount == 0);
+
+    uAtClientReceiveBufferStatsGet(atClientHandle, &receiveBufferStats);
+    U_TEST_PRINT_LINE("receive buffer of %d byte(s): high water mark %d byte(s),"
+                      " %d borrow(s) from the pool, %d overflow(s).",
+                      U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES - U_AT_CLIENT_BUFFER_OVERHEAD_BYTES,
+                      receiveBufferStats.highWaterMarkBytes, receiveBufferStats.numBorrows,
+                      receiveBufferStats.numOverflows);
+    U_PORT_TEST_ASSERT(receiveBufferStats.highWaterMarkBytes > 0);
+    U_PORT_TEST_ASSERT(receiveBufferStats.numOverflows == 0);
+
+    // Check the stack extent for the URC task
+    stackMinFree = uAtClientUrcHandlerStackMinFree(atClientHandle);
+    U_TEST_PRINT_LINE("URC task had a minimum of %d byte(s) of stack free.", stackMinFree);
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    gMemoryStreamHandle = -1;
+    free(pUsordResponse);
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Check that a task locking an AT client at high priority is
+ * let in when a task holding the lock at low priority yields.
+ * Requires no hardware.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientLockPriority")
+{
+    uAtClientHandle_t atClientHandle;
+    uPortTaskHandle_t taskHandle = NULL;
+    uAtClientLockStats_t lockStats;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    gMemoryStreamHandle = uAtClientStreamMemoryOpen(U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES,
+                                                    NULL, NULL);
+    U_PORT_TEST_ASSERT(gMemoryStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gMemoryStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+
+    uAtClientLockStatsGet(atClientHandle, &lockStats);
+    for (size_t x = 0; x < sizeof(lockStats.priority) / sizeof(lockStats.priority[0]); x++) {
+        U_PORT_TEST_ASSERT(lockStats.priority[x].numLocks == 0);
+    }
+    U_PORT_TEST_ASSERT(lockStats.numYields == 0);
+
+    U_TEST_PRINT_LINE("locking at low priority...");
+    uAtClientLockPriority(atClientHandle, U_AT_CLIENT_LOCK_PRIORITY_LOW);
+    // Nothing is waiting so this should do nothing
+    U_PORT_TEST_ASSERT(!uAtClientLockYield(atClientHandle));
+
+    gLockHighPriorityDone = false;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(lockHighPriorityTask, "lockHigh",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) atClientHandle,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    // Give the task time to start waiting for the lock
+    uPortTaskBlock(500);
+    U_PORT_TEST_ASSERT(!gLockHighPriorityDone);
+    U_TEST_PRINT_LINE("yielding to the high priority task...");
+    U_PORT_TEST_ASSERT(uAtClientLockYield(atClientHandle));
+    U_PORT_TEST_ASSERT(gLockHighPriorityDone);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    // Let the task exit
+    uPortTaskBlock(100);
+
+    uAtClientLockStatsGet(atClientHandle, &lockStats);
+    for (size_t x = 0; x < sizeof(lockStats.priority) / sizeof(lockStats.priority[0]); x++) {
+        U_TEST_PRINT_LINE("priority %d: %d lock(s), waited %d ms in total, %d ms max.",
+                          x, lockStats.priority[x].numLocks,
+                          lockStats.priority[x].waitTimeTotalMs,
+                          lockStats.priority[x].waitTimeMaxMs);
+    }
+    U_PORT_TEST_ASSERT(lockStats.priority[U_AT_CLIENT_LOCK_PRIORITY_LOW].numLocks == 2);
+    U_PORT_TEST_ASSERT(lockStats.priority[U_AT_CLIENT_LOCK_PRIORITY_NORMAL].numLocks == 0);
+    U_PORT_TEST_ASSERT(lockStats.priority[U_AT_CLIENT_LOCK_PRIORITY_HIGH].numLocks == 1);
+    U_PORT_TEST_ASSERT(lockStats.priority[U_AT_CLIENT_LOCK_PRIORITY_HIGH].waitTimeMaxMs > 0);
+    U_PORT_TEST_ASSERT(lockStats.numYields == 1);
+    uAtClientLockStatsReset(atClientHandle);
+    uAtClientLockStatsGet(atClientHandle, &lockStats);
+    U_PORT_TEST_ASSERT(lockStats.priority[U_AT_CLIENT_LOCK_PRIORITY_LOW].numLocks == 0);
+
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+    uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    gMemoryStreamHandle = -1;
+    uPortDeinit();
+}
+
+/** Check that AT commands sent by several tasks while the
+ * wake-up handler is holding off for the batch window are all
+ * served by a single wake-up.  Requires no hardware.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientWakeUpBatch")
+{
+    uAtClientHandle_t atClientHandle;
+    uPortTaskHandle_t taskHandle;
+    uAtClientTestWakeUpBatchTask_t task[U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS];
+    uAtClientWakeUpStats_t wakeUpStats;
+    int32_t startTimeMs;
+    int32_t x;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    gMemoryStreamHandle = uAtClientStreamMemoryOpen(U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES,
+                                                    okTransmitCallback, NULL);
+    U_PORT_TEST_ASSERT(gMemoryStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gMemoryStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+
+    gWakeUpCount = 0;
+    gWakeUpBatchTasksDone = 0;
+    x = uAtClientSetWakeUpHandler(atClientHandle, wakeUpHandler, NULL,
+                                  U_AT_CLIENT_TEST_WAKE_UP_INACTIVITY_TIMEOUT_MS);
+    U_PORT_TEST_ASSERT(x == 0);
+    x = uAtClientWakeUpBatchWindowSet(atClientHandle, U_AT_CLIENT_TEST_WAKE_UP_BATCH_WINDOW_MS);
+    U_PORT_TEST_ASSERT(x == 0);
+
+    // Send something so that there is a last transmit time to
+    // be inactive from, then let the module "go to sleep"
+    U_PORT_TEST_ASSERT(sendAt(atClientHandle) == 0);
+    U_PORT_TEST_ASSERT(gWakeUpCount == 0);
+    uAtClientWakeUpStatsReset(atClientHandle);
+    uPortTaskBlock(U_AT_CLIENT_TEST_WAKE_UP_INACTIVITY_TIMEOUT_MS * 2);
+
+    // Start the tasks, each of which will send an AT command
+    // part way through the batch window, and send one from here:
+    // this will wait for the batch window before waking the
+    // module and the tasks will queue up behind it
+    U_TEST_PRINT_LINE("sending %d AT command(s) from %d task(s) with a %d ms batch window...",
+                      U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS + 1,
+                      U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS + 1,
+                      U_AT_CLIENT_TEST_WAKE_UP_BATCH_WINDOW_MS);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t y = 0; y < U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS; y++) {
+        task[y].atClientHandle = atClientHandle;
+        task[y].delayMs = (U_AT_CLIENT_TEST_WAKE_UP_BATCH_WINDOW_MS * (y + 1)) /
+                          (U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS + 1);
+        U_PORT_TEST_ASSERT(uPortTaskCreate(wakeUpBatchTask, "wakeUpBatch",
+                                           U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                           (void *) &(task[y]),
+                                           U_CFG_TEST_OS_TASK_PRIORITY,
+                                           &taskHandle) == 0);
+    }
+    U_PORT_TEST_ASSERT(sendAt(atClientHandle) == 0);
+    while ((gWakeUpBatchTasksDone < U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_WAKE_UP_BATCH_WINDOW_MS +
+            (U_AT_CLIENT_TEST_AT_TIMEOUT_MS * (U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS + 1)))) {
+        uPortTaskBlock(10);
+    }
+    // Let the tasks exit
+    uPortTaskBlock(100);
+
+    uAtClientWakeUpStatsGet(atClientHandle, &wakeUpStats);
+    U_TEST_PRINT_LINE("%d task(s) done in %d ms, wake-up handler called %d time(s).",
+                      gWakeUpBatchTasksDone, uPortGetTickTimeMs() - startTimeMs,
+                      gWakeUpCount);
+    U_TEST_PRINT_LINE("%d wake-up(s), %d command(s), max %d per wake, waited %d ms"
+                      " in the batch window.", wakeUpStats.numWakeUps,
+                      wakeUpStats.numCommands, wakeUpStats.maxCommandsPerWake,
+                      wakeUpStats.batchWaitTimeTotalMs);
+    U_PORT_TEST_ASSERT(gWakeUpBatchTasksDone == U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS);
+    U_PORT_TEST_ASSERT(gWakeUpCount == 1);
+    U_PORT_TEST_ASSERT(wakeUpStats.numWakeUps == 1);
+    U_PORT_TEST_ASSERT(wakeUpStats.numCommands == U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS + 1);
+    U_PORT_TEST_ASSERT(wakeUpStats.maxCommandsPerWake ==
+                       U_AT_CLIENT_TEST_WAKE_UP_BATCH_NUM_TASKS + 1);
+    U_PORT_TEST_ASSERT(wakeUpStats.batchWaitTimeTotalMs >=
+                       U_AT_CLIENT_TEST_WAKE_UP_BATCH_WINDOW_MS -
+                       U_AT_CLIENT_TEST_AT_TIMEOUT_TOLERANCE_MS);
+
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+    uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    gMemoryStreamHandle = -1;
+    uPortDeinit();
+}
+
+/** Check that an AT client with a small receive buffer borrows a
+ * block from the receive buffer pool to parse a long response,
+ * gives it back afterwards and counts the borrow in its statistics
+ * or, if there is no pool, that the overflow is counted.  Requires
+ * no hardware.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientBufferPool")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientTestCorpusContext_t context = {0};
+    uAtClientReceiveBufferStats_t receiveBufferStats;
+    char response[U_AT_CLIENT_TEST_BUFFER_POOL_LINE_LENGTH_BYTES + 16];
+    char buffer[U_AT_CLIENT_TEST_BUFFER_POOL_LINE_LENGTH_BYTES + 1];
+    size_t length = 0;
+    int32_t heapUsed;
+    int32_t x;
+    int32_t y;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    // A response with a line which has no prefix, so it must
+    // all be in the receive buffer before it can be parsed
+    length += snprintf(response, sizeof(response), "\r\n");
+    for (size_t z = 0; z < U_AT_CLIENT_TEST_BUFFER_POOL_LINE_LENGTH_BYTES; z++) {
+        response[length] = (char) ('a' + (z % 26));
+        length++;
+    }
+    length += snprintf(response + length, sizeof(response) - length, "\r\n\r\nOK\r\n");
+    context.pResponse = response;
+    context.responseLength = length;
+
+    gMemoryStreamHandle = uAtClientStreamMemoryOpen(sizeof(response),
+                                                    corpusTransmitCallback, &context);
+    U_PORT_TEST_ASSERT(gMemoryStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gMemoryStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+
+    // Do it twice: the second borrow can only happen if the
+    // block was given back after the first
+    for (size_t z = 0; z < 2; z++) {
+        context.responsePushed = false;
+        uAtClientLock(atClientHandle);
+        uAtClientCommandStart(atClientHandle, "AT+LONG");
+        uAtClientCommandStop(atClientHandle);
+        uAtClientDelimiterSet(atClientHandle, '\x00');
+        uAtClientResponseStart(atClientHandle, NULL);
+        x = uAtClientReadString(atClientHandle, buffer, sizeof(buffer), false);
+        uAtClientResponseStop(atClientHandle);
+        uAtClientDelimiterSet(atClientHandle, ',');
+        y = uAtClientUnlock(atClientHandle);
+        U_PORT_TEST_ASSERT(context.responsePushed);
+        uAtClientReceiveBufferStatsGet(atClientHandle, &receiveBufferStats);
+        U_TEST_PRINT_LINE("%d: read %d byte(s), unlock returned %d, high water mark %d"
+                          " byte(s), %d borrow(s), %d overflow(s).", (int32_t) z + 1, x, y,
+                          (int32_t) receiveBufferStats.highWaterMarkBytes,
+                          receiveBufferStats.numBorrows, receiveBufferStats.numOverflows);
+#if U_AT_CLIENT_BUFFER_POOL_NUM_BLOCKS > 0
+        U_PORT_TEST_ASSERT(y == 0);
+        U_PORT_TEST_ASSERT(x == U_AT_CLIENT_TEST_BUFFER_POOL_LINE_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(memcmp(buffer, response + 2, x) == 0);
+        U_PORT_TEST_ASSERT(receiveBufferStats.numBorrows == (int32_t) z + 1);
+        U_PORT_TEST_ASSERT(receiveBufferStats.numOverflows == 0);
+        U_PORT_TEST_ASSERT(receiveBufferStats.highWaterMarkBytes >
+                           U_AT_CLIENT_BUFFER_LENGTH_BYTES - U_AT_CLIENT_BUFFER_OVERHEAD_BYTES);
+#else
+        // No pool: the response can't be parsed, the overflow
+        // must be counted
+        U_PORT_TEST_ASSERT(receiveBufferStats.numBorrows == 0);
+        U_PORT_TEST_ASSERT(receiveBufferStats.numOverflows > 0);
+        // Flush out anything left over
+        uAtClientFlush(atClientHandle);
+#endif
+    }
+
+    // With the block given back a short response should
+    // be handled in the AT client's own receive buffer
+    uAtClientReceiveBufferStatsReset(atClientHandle);
+    context.pResponse = "\r\nOK\r\n";
+    context.responseLength = 6;
+    context.responsePushed = false;
+    U_PORT_TEST_ASSERT(sendAt(atClientHandle) == 0);
+    U_PORT_TEST_ASSERT(context.responsePushed);
+    uAtClientReceiveBufferStatsGet(atClientHandle, &receiveBufferStats);
+    U_PORT_TEST_ASSERT(receiveBufferStats.numBorrows == 0);
+    U_PORT_TEST_ASSERT(receiveBufferStats.numOverflows == 0);
+
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+    uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    gMemoryStreamHandle = -1;
+    uPortDeinit();
+
+    // Check for memory leaks, which includes the block
+    // that was borrowed: uAtClientDeinit() should free it
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -1743,6 +2775,9 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCleanUp")
     if (gUartBHandle >= 0) {
         uPortUartClose(gUartBHandle);
     }
+    if (gMemoryStreamHandle >= 0) {
+        uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    }
 
     x = uPortTaskStackMinFree(NULL);
     if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
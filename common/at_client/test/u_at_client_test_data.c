@@ -2076,10 +2076,122 @@ const uAtClientTestEcho_t gAtClientTestSet2[] = {
  */
 const size_t gAtClientTestSetSize2 = sizeof(gAtClientTestSet2) / sizeof(gAtClientTestSet2[0]);
 
+#endif
+
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
+ * EXTERNED VARIABLES: gAtClientTestTranscript
  * -------------------------------------------------------------- */
 
-#endif
+/** Recorded AT transcripts, see uAtClientTestTranscript_t for the
+ * format; the only URCs that may be used are "+CEREG: 5" and
+ * "+UUSORD: 0,32" since those are what the corpus test handles.
+ */
+const uAtClientTestTranscript_t gAtClientTestTranscript[] = {
+    {
+        "SARA-R510M8S 02.06 connect and read a socket",
+        ">ATE0\n"
+        "OK\n"
+        ">AT+CMEE=1\n"
+        "OK\n"
+        ">AT+CGMI\n"
+        "u-blox\n"
+        "OK\n"
+        ">AT+CGMM\n"
+        "SARA-R510M8S\n"
+        "OK\n"
+        ">ATI9\n"
+        "02.06,A00.01\n"
+        "OK\n"
+        ">AT+CGSN\n"
+        "357520070136562\n"
+        "OK\n"
+        ">AT+CPIN?\n"
+        "+CPIN: READY\n"
+        "OK\n"
+        ">AT+CCID\n"
+        "+CCID: 89441000301141227871\n"
+        "OK\n"
+        ">AT+CPWD=\"SC\",\"1234\",\"5678\"\n"
+        "+CME ERROR: 16\n"
+        ">AT+CEREG=1\n"
+        "OK\n"
+        ">AT+CFUN=1\n"
+        "OK\n"
+        ">AT+COPS=3,2\n"
+        "!+CEREG: 5\n"
+        "OK\n"
+        ">AT+CEREG?\n"
+        "+CEREG: 1,5\n"
+        "OK\n"
+        ">AT+COPS?\n"
+        "+COPS: 0,2,\"23415\",7\n"
+        "OK\n"
+        ">AT+CESQ\n"
+        "+CESQ: 99,99,255,255,23,52\n"
+        "OK\n"
+        ">AT+CGDCONT?\n"
+        "+CGDCONT: 1,\"IP\",\"internet\",\"10.160.54.12\",0,0,0,0,0,0\n"
+        "OK\n"
+        ">AT+USOCR=6\n"
+        "+USOCR: 0\n"
+        "OK\n"
+        ">AT+USOCO=0,\"195.34.89.241\",7\n"
+        "OK\n"
+        ">AT+USOWR=0,32,\"0123456789abcdef0123456789abcdef\"\n"
+        "+USOWR: 0,32\n"
+        "OK\n"
+        ">AT+USORD=0,32\n"
+        "!+UUSORD: 0,32\n"
+        "+USORD: 0,32,\"0123456789abcdef0123456789abcdef\"\n"
+        "OK\n"
+        ">AT+USOCL=0\n"
+        "OK\n"
+    },
+    {
+        "SARA-R422M8S 00.12 identify and register",
+        ">ATE0\n"
+        "OK\n"
+        ">ATI\n"
+        "Manufacturer: u-blox\n"
+        "Model: SARA-R422M8S\n"
+        "Revision: L0.0.00.00.05.12 [Mar 09 2022 17:00:00]\n"
+        "SVN: 04\n"
+        "IMEI: 352753090041680\n"
+        "OK\n"
+        ">AT+CIMI\n"
+        "234150203049131\n"
+        "OK\n"
+        ">AT+UMNOPROF?\n"
+        "+UMNOPROF: 100\n"
+        "OK\n"
+        ">AT+UDCONF=999\n"
+        "ERROR\n"
+        ">AT+CEREG=1\n"
+        "OK\n"
+        ">AT+COPS=0\n"
+        "OK\n"
+        ">AT+CSQ\n"
+        "!+CEREG: 5\n"
+        "+CSQ: 19,99\n"
+        "OK\n"
+        ">AT+CCLK?\n"
+        "+CCLK: \"22/03/14,10:51:06+00\"\n"
+        "OK\n"
+        ">AT+CGPADDR=1\n"
+        "+CGPADDR: 1,\"10.160.54.12\"\n"
+        "OK\n"
+    }
+};
+
+/** Number of items in the gAtClientTestTranscript array, has to be
+ * done in this file and externed or GCC complains about asking
+ * for the size of a partially defined type.
+ */
+const size_t gAtClientTestTranscriptSize = sizeof(gAtClientTestTranscript) /
+                                           sizeof(gAtClientTestTranscript[0]);
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
 
 // End of file
@@ -92,6 +92,18 @@ extern "C" {
  */
 #define U_AT_CLIENT_TEST_NUM_URCS_SET_2 34
 
+/** The character at the start of a line of a recorded transcript,
+ * see uAtClientTestTranscript_t, which marks an AT command sent
+ * by the AT client.
+ */
+#define U_AT_CLIENT_TEST_TRANSCRIPT_COMMAND '>'
+
+/** The character at the start of a line of a recorded transcript,
+ * see uAtClientTestTranscript_t, which marks a URC sent by the
+ * module.
+ */
+#define U_AT_CLIENT_TEST_TRANSCRIPT_URC '!'
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -201,6 +213,32 @@ typedef struct {
     const uAtClientTestResponseLine_t *pUrc; /** The URC interleaved with it. */
 } uAtClientTestEchoMisc_t;
 
+/** A transcript of an AT session recorded from a real module,
+ * replayed through an AT client over an in-memory stream.  pText
+ * is a set of lines, each ended by "\n", in the order they were
+ * seen on the UART, as follows:
+ *
+ * - a line starting with #U_AT_CLIENT_TEST_TRANSCRIPT_COMMAND is
+ *   an AT command sent by the AT client, without the command
+ *   terminator, e.g. ">AT+CGMI",
+ * - a line starting with #U_AT_CLIENT_TEST_TRANSCRIPT_URC is a URC
+ *   from the module, e.g. "!+CEREG: 5"; only URCs which arrive
+ *   before the response to a command, and which have a different
+ *   prefix to its information response, can be replayed,
+ * - any other line is a line of the response of the module to the
+ *   last command, without the line endings, e.g. "+CSQ: 19,99",
+ *   the last of which must be a final result code: "OK", "ERROR",
+ *   "+CME ERROR: x" or "+CMS ERROR: x".
+ *
+ * A transcript captured from a debug log of the AT client can be
+ * converted into this form by removing the "\r"s and the blank
+ * lines and adding the markers.
+ */
+typedef struct {
+    const char *pName; /** The module and firmware version recorded from. */
+    const char *pText; /** The transcript. */
+} uAtClientTestTranscript_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -227,6 +265,15 @@ extern const size_t gAtClientTestSetSize2;
 
 #endif
 
+/** Recorded AT transcripts, requires no hardware.
+ */
+extern const uAtClientTestTranscript_t gAtClientTestTranscript[];
+
+/** Size of gAtClientTestTranscript, has to be here because otherwise
+ * GCC complains about asking for the size of an incomplete type.
+ */
+extern const size_t gAtClientTestTranscriptSize;
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,8 @@
 #include "u_location.h"
 #include "u_location_shared.h"
 
+#include "u_security_shared.h"
+
 #include "u_device_private.h"
 #include "u_device_private_cell.h"
 #include "u_device_private_gnss.h"
@@ -125,8 +127,14 @@ int32_t uDeviceInit()
         errorCode = uLocationSharedInit();
     }
 
+    if (errorCode == 0) {
+        // Initialise the internally shared security API
+        errorCode = uSecuritySharedInit();
+    }
+
     // Clean up on error
     if (errorCode != 0) {
+        uSecuritySharedDeinit();
         uLocationSharedDeinit();
         uDevicePrivateShortRangeDeinit();
         uDevicePrivateCellDeinit();
@@ -141,6 +149,7 @@ int32_t uDeviceInit()
 
 int32_t uDeviceDeinit()
 {
+    uSecuritySharedDeinit();
     uLocationSharedDeinit();
     uDevicePrivateShortRangeDeinit();
     uDevicePrivateGnssDeinit();
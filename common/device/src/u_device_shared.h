@@ -64,6 +64,13 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Forward declarations of the tables of functions that implement
+ * the sockets, MQTT client and location APIs for a device.
+ */
+struct uSockBackend_t;
+struct uMqttClientBackend_t;
+struct uLocationBackend_t;
+
 /** Data structure for network stuff that is hooked into the device
  * structure.
  */
@@ -83,9 +90,22 @@ typedef struct {
     uDeviceType_t deviceType;   /**< type of device. */
     int32_t moduleType;         /**< module identification (when applicable). */
     void *pContext;             /**< private instance data for the device. */
+    void *pDriverInstance;      /**< the instance of the driver for the device
+                                     (e.g. cellular), so that the driver can
+                                     find it from the handle without a search. */
     uDeviceNetworkData_t networkData[U_DEVICE_NETWORKS_MAX_NUM]; /**< network cfg and private data. */
-    // Note: In the future structs of function pointers for socket, MQTT etc.
-    // implementations may be added here.
+    const struct uSockBackend_t *pSockBackend; /**< the socket implementation for the
+                                                    device, see u_sock_backend.h; NULL
+                                                    means the default for deviceType. */
+    const struct uMqttClientBackend_t *pMqttClientBackend; /**< the MQTT client implementation
+                                                                for the device, see
+                                                                u_mqtt_client_backend.h; NULL
+                                                                means the default for
+                                                                deviceType. */
+    const struct uLocationBackend_t *pLocationBackend; /**< the location implementation for
+                                                            the device, see
+                                                            u_location_backend.h; NULL means
+                                                            the default for deviceType. */
 } uDeviceInstance_t;
 
 /* ----------------------------------------------------------------
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_HTTP_CLIENT_H_
+#define _U_HTTP_CLIENT_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_security_tls.h"
+#include "u_sock.h"
+
+/** \addtogroup HTTP-Client HTTP Client
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the u-blox HTTP client API, an
+ * HTTP/1.1 client which runs over the sockets API (and hence on any
+ * device that supports sockets), keeping connections to a server
+ * open between requests so that they may be re-used; request and
+ * response bodies are streamed through callbacks so that they need
+ * never be held in RAM.  This API is threadsafe except for the
+ * pUHttpClientOpen() and uHttpClientClose() functions, which should
+ * not be called simultaneously with themselves or any other HTTP
+ * client API function on the same context.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_HTTP_CLIENT_MAX_CONNECTIONS
+/** The default maximum number of connections that an HTTP client
+ * context will keep open to its server, which is also the maximum
+ * number of requests that may be in progress at any one time.
+ */
+# define U_HTTP_CLIENT_MAX_CONNECTIONS 2
+#endif
+
+#ifndef U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS
+/** The default maximum amount of time to wait for a connection
+ * to become free, to open a connection or for the server to send
+ * something, in seconds.
+ */
+# define U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS 30
+#endif
+
+#ifndef U_HTTP_CLIENT_IDLE_TIMEOUT_SECONDS
+/** The default time for which an idle connection will be kept
+ * open for re-use; servers commonly close idle connections after
+ * a minute or so, there is no point in holding on for longer than
+ * that.
+ */
+# define U_HTTP_CLIENT_IDLE_TIMEOUT_SECONDS 50
+#endif
+
+#ifndef U_HTTP_CLIENT_BUFFER_LENGTH_BYTES
+/** The length of the receive buffer kept for each connection and
+ * of the buffer used to send each chunk of a streamed request body.
+ * This is also the longest HTTP header line that can be handled
+ * (longer lines are passed to the header callback truncated).
+ */
+# define U_HTTP_CLIENT_BUFFER_LENGTH_BYTES 512
+#endif
+
+/** The defaults for an HTTP connection, see #uHttpClientConnection_t.
+ * Whenever an instance of uHttpClientConnection_t is created it
+ * should be assigned to this to ensure the correct default
+ * settings.
+ */
+#define U_HTTP_CLIENT_CONNECTION_DEFAULT {NULL, NULL, -1, -1, -1}
+
+/** The defaults for an HTTP request, see #uHttpClientRequest_t.
+ * Whenever an instance of uHttpClientRequest_t is created it
+ * should be assigned to this to ensure the correct default
+ * settings.
+ */
+#define U_HTTP_CLIENT_REQUEST_DEFAULT {"GET", "/", NULL, NULL, \
+                                       NULL, 0, NULL, NULL}
+
+/** The defaults for an HTTP response, see #uHttpClientResponse_t.
+ * Whenever an instance of uHttpClientResponse_t is created it
+ * should be assigned to this to ensure the correct default
+ * settings.
+ */
+#define U_HTTP_CLIENT_RESPONSE_DEFAULT {NULL, NULL, NULL, -1, 0}
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** HTTP connection information.
+ * NOTE: if this structure is modified be sure to modify
+ * #U_HTTP_CLIENT_CONNECTION_DEFAULT to match.
+ */
+typedef struct {
+    const char *pServerNameStr;   /**< the null-terminated name of the
+                                       HTTP server, a domain name or an IP
+                                       address, which may include a port
+                                       number, e.g. "myserver.com:8080";
+                                       if there is no port number then 80
+                                       is used, or 443 if
+                                       pSecurityTlsSettings is non-NULL.
+                                       The domain name is also sent in the
+                                       Host header of each request.
+                                       Cannot be NULL. */
+    const uSecurityTlsSettings_t *pSecurityTlsSettings; /**< the TLS settings
+                                                             to use, NULL
+                                                             (the default) for
+                                                             plain HTTP.  These
+                                                             are used each time
+                                                             a new connection
+                                                             is opened and so
+                                                             must remain valid
+                                                             until
+                                                             uHttpClientClose()
+                                                             is called. */
+    int32_t maxConnections;       /**< the maximum number of connections
+                                       to keep open to the server, -1 (the
+                                       default) for
+                                       #U_HTTP_CLIENT_MAX_CONNECTIONS. */
+    int32_t timeoutSeconds;       /**< the time to wait for a connection to
+                                       become free, a connection to open or
+                                       the server to send something, -1 (the
+                                       default) for
+                                       #U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS. */
+    int32_t idleTimeoutSeconds;   /**< how long an idle connection may be kept
+                                       open for re-use, -1 (the default) for
+                                       #U_HTTP_CLIENT_IDLE_TIMEOUT_SECONDS, 0
+                                       to close each connection after use. */
+} uHttpClientConnection_t;
+
+/** An HTTP request.
+ * NOTE: if this structure is modified be sure to modify
+ * #U_HTTP_CLIENT_REQUEST_DEFAULT to match.
+ */
+typedef struct {
+    const char *pMethodStr;       /**< the null-terminated method, e.g.
+                                       "GET" (the default), "HEAD", "POST",
+                                       "PUT" or "DELETE". */
+    const char *pPathStr;         /**< the null-terminated path, including
+                                       any query, e.g. "/fw/image?v=2";
+                                       defaults to "/". */
+    const char *pHeadersStr;      /**< any additional headers to send, a
+                                       null-terminated string of lines each
+                                       ending in "\r\n"; may be NULL (the
+                                       default).  The Host, Content-Length
+                                       and Transfer-Encoding headers are
+                                       added by this code. */
+    const char *pContentTypeStr;  /**< the null-terminated content type of
+                                       the request body, e.g.
+                                       "application/json"; may be NULL (the
+                                       default). */
+    const char *pBody;            /**< the request body, ignored if
+                                       pBodyCallback is non-NULL; may be
+                                       NULL (the default) for no body. */
+    size_t bodySizeBytes;         /**< the number of bytes at pBody. */
+    int32_t (*pBodyCallback) (char *pBuffer, size_t bufferSizeBytes,
+                              void *pCallbackParam); /**< a callback to stream
+                                                          the request body,
+                                                          which is then sent
+                                                          with chunked transfer
+                                                          encoding; the callback
+                                                          should write up to
+                                                          bufferSizeBytes of
+                                                          body into pBuffer and
+                                                          return the number
+                                                          written, zero at the
+                                                          end of the body or
+                                                          negative to abandon
+                                                          the request.  May be
+                                                          NULL (the default). */
+    void *pBodyCallbackParam;     /**< passed to pBodyCallback. */
+} uHttpClientRequest_t;
+
+/** An HTTP response.
+ * NOTE: if this structure is modified be sure to modify
+ * #U_HTTP_CLIENT_RESPONSE_DEFAULT to match.
+ */
+typedef struct {
+    void (*pHeaderCallback) (const char *pNameStr, const char *pValueStr,
+                             void *pCallbackParam); /**< called with the
+                                                         null-terminated name
+                                                         and value of each
+                                                         header of the response;
+                                                         may be NULL (the
+                                                         default). */
+    bool (*pBodyCallback) (const char *pData, size_t dataSizeBytes,
+                           void *pCallbackParam); /**< called with each piece
+                                                       of the response body as
+                                                       it arrives, de-chunked
+                                                       if necessary; return
+                                                       false to stop receiving
+                                                       (the connection will
+                                                       then not be re-used).
+                                                       May be NULL (the default)
+                                                       in which case the body
+                                                       is discarded. */
+    void *pCallbackParam;         /**< passed to pHeaderCallback and
+                                       pBodyCallback. */
+    int32_t contentLength;        /**< populated by this code: the content
+                                       length the server declared, -1 if it
+                                       did not. */
+    size_t bodySizeBytes;         /**< populated by this code: the number of
+                                       bytes of body passed to pBodyCallback. */
+} uHttpClientResponse_t;
+
+/** A connection in the pool of an HTTP client context, used
+ * internally by this code.
+ */
+typedef struct {
+    int32_t sock;          /**< the socket descriptor, -1 if not open. */
+    bool inUse;            /**< true while a request is using it. */
+    int64_t lastUsedMs;    /**< when a request last finished with it. */
+    char *pBuffer;         /**< the receive buffer. */
+    size_t bufferOffset;   /**< the offset of the unread data in pBuffer. */
+    size_t bufferLength;   /**< the amount of unread data in pBuffer. */
+} uHttpClientPooledConnection_t;
+
+/** HTTP client context data, one per server, used internally by
+ * this code and exposed here only so that it can be handed around
+ * by the caller.  The contents and structure of this structure
+ * may be changed without notice and should not be relied upon
+ * by the caller.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    void *mutexHandle; /* No 'p' prefix as this should be treated as a handle,
+                          not using actual type to avoid customer having to drag
+                          more headers in for what is an internal structure. */
+    char *pServerNameStr; /**< the server name as given, for the Host header. */
+    char *pHostStr; /**< the server name without any port number, in the
+                         same block of memory as pServerNameStr. */
+    uSockAddress_t serverAddress; /**< the server address, looked up once. */
+    bool serverAddressKnown;
+    const uSecurityTlsSettings_t *pSecurityTlsSettings;
+    int32_t timeoutMs;
+    int32_t idleTimeoutMs;
+    size_t numConnections;
+    uHttpClientPooledConnection_t *pConnections;
+    int32_t totalConnectsMade; /**< the number of connections opened. */
+    int32_t totalRequests;     /**< the number of requests made. */
+} uHttpClientContext_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Open an HTTP client for a server.  No connection is made until
+ * the first request.  The device must be connected to a network
+ * (e.g. using uNetworkInterfaceUp()) for requests to succeed.
+ *
+ * @param devHandle        the device handle to be used, for example
+ *                         obtained using uDeviceOpen().
+ * @param[in] pConnection  the connection information, cannot be NULL.
+ * @return                 a pointer to the HTTP client context or NULL
+ *                         on failure (in which case
+ *                         uHttpClientOpenResetLastError() can be called
+ *                         to obtain an error code).
+ */
+uHttpClientContext_t *pUHttpClientOpen(uDeviceHandle_t devHandle,
+                                       const uHttpClientConnection_t *pConnection);
+
+/** If pUHttpClientOpen() returned NULL this function can be
+ * called to find out why.  That error code is reset to "success"
+ * by calling this function.
+ *
+ * @return the last error code from a call to pUHttpClientOpen().
+ */
+int32_t uHttpClientOpenResetLastError();
+
+/** Close an HTTP client, closing all of its connections and
+ * freeing the context.  No request may be in progress.
+ *
+ * @param[in] pContext  a pointer to the HTTP client context returned
+ *                      by pUHttpClientOpen().
+ */
+void uHttpClientClose(uHttpClientContext_t *pContext);
+
+/** Perform an HTTP request, blocking until the whole response has
+ * been received (or pBodyCallback in pResponse has returned false).
+ * A connection that is open and idle is re-used, otherwise a new
+ * connection is opened if the maximum number of connections has
+ * not been reached, otherwise this waits for a connection to
+ * become free.  Should a re-used connection turn out to have been
+ * closed by the server the request is retried once on a new
+ * connection, unless the request body is streamed.
+ *
+ * @param[in] pContext      a pointer to the HTTP client context
+ *                          returned by pUHttpClientOpen().
+ * @param[in] pRequest      the request, cannot be NULL.
+ * @param[in,out] pResponse the callbacks for the response and a
+ *                          place for information about it; may be
+ *                          NULL if the response body is of no
+ *                          interest.
+ * @return                  the HTTP status code sent by the server,
+ *                          e.g. 200, else negative error code.
+ */
+int32_t uHttpClientRequest(uHttpClientContext_t *pContext,
+                           const uHttpClientRequest_t *pRequest,
+                           uHttpClientResponse_t *pResponse);
+
+/** Close any idle connections of an HTTP client, e.g. before
+ * the device is put to sleep.
+ *
+ * @param[in] pContext  a pointer to the HTTP client context returned
+ *                      by pUHttpClientOpen().
+ */
+void uHttpClientCloseIdle(uHttpClientContext_t *pContext);
+
+/** Get the number of connections that have been opened to the
+ * server, useful to check that connections are being re-used.
+ *
+ * @param[in] pContext  a pointer to the HTTP client context returned
+ *                      by pUHttpClientOpen().
+ * @return              the number of connections opened, else
+ *                      negative error code.
+ */
+int32_t uHttpClientGetTotalConnectsMade(const uHttpClientContext_t *pContext);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_HTTP_CLIENT_H_
+
+// End of file
@@ -0,0 +1,1004 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the u-blox HTTP client API.  This is
+ * written entirely in terms of the sockets API: a request is written
+ * to a TCP (optionally TLS) socket and the response parsed as it
+ * arrives, the socket being kept open afterwards, where the server
+ * permits, for the next request to the same server.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "errno.h"
+#include "stdlib.h"    // malloc(), free(), strtol()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memmove(), memchr(), strlen()
+#include "stdio.h"     // snprintf()
+#include "ctype.h"     // tolower(), isspace()
+
+#include "u_cfg_sw.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* integer stdio, must be
+                                              included before the
+                                              other port files if any
+                                              print or scan function
+                                              is used. */
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_debug.h"
+
+#include "u_device.h"
+
+#include "u_security_tls.h"
+
+#include "u_sock.h"
+#include "u_sock_errno.h"
+#include "u_sock_security.h"
+
+#include "u_http_client.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_HTTP_CLIENT_POLL_INTERVAL_MS
+/** How long to wait between checks for received data or for
+ * a connection to become free.
+ */
+# define U_HTTP_CLIENT_POLL_INTERVAL_MS 20
+#endif
+
+/** The default port for HTTP.
+ */
+#define U_HTTP_CLIENT_PORT_HTTP 80
+
+/** The default port for HTTPS.
+ */
+#define U_HTTP_CLIENT_PORT_HTTPS 443
+
+/** Room for the length line at the start of a chunk,
+ * a hex number of up to eight digits plus CR/LF.
+ */
+#define U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES 10
+
+/** Room for the fixed parts of a request header, i.e. everything
+ * other than the method, path, server name, content type and
+ * user-supplied headers, with a healthy margin.
+ */
+#define U_HTTP_CLIENT_REQUEST_HEADER_OVERHEAD_BYTES 128
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** What we learn from the response header.
+ */
+typedef struct {
+    int32_t statusCode;
+    int32_t contentLength;
+    bool chunked;
+    bool keepAlive;
+} uHttpClientResponseHeader_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Storage for the last error that occurred in pUHttpClientOpen().
+ */
+static uErrorCode_t gLastOpenError = U_ERROR_COMMON_SUCCESS;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Return true if the two strings are the same, ignoring case.
+static bool equalNoCase(const char *pStr1, const char *pStr2)
+{
+    while ((*pStr1 != 0) && (tolower((int32_t) *pStr1) == tolower((int32_t) *pStr2))) {
+        pStr1++;
+        pStr2++;
+    }
+
+    return (*pStr1 == 0) && (*pStr2 == 0);
+}
+
+// Return true if pStr contains the lower-case string pLowerStr,
+// ignoring the case of pStr.
+static bool containsNoCase(const char *pStr, const char *pLowerStr)
+{
+    bool found = false;
+    size_t x;
+
+    for (; (*pStr != 0) && !found; pStr++) {
+        for (x = 0; (pLowerStr[x] != 0) &&
+             (tolower((int32_t) pStr[x]) == pLowerStr[x]); x++) {
+        }
+        found = (pLowerStr[x] == 0);
+    }
+
+    return found;
+}
+
+// Write all of the given data to a socket.
+static int32_t sendAll(int32_t sock, const char *pData, size_t dataSizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t x;
+
+    while ((dataSizeBytes > 0) && (errorCode == 0)) {
+        x = uSockWrite(sock, pData, dataSizeBytes);
+        if (x > 0) {
+            pData += x;
+            dataSizeBytes -= x;
+        } else {
+            // A write failing generally means that
+            // the connection has gone
+            errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+        }
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CONNECTIONS
+ * -------------------------------------------------------------- */
+
+// Close a connection; the buffer is kept for next time.
+static void closeConnection(uHttpClientPooledConnection_t *pConnection)
+{
+    if (pConnection->sock >= 0) {
+        uSockClose(pConnection->sock);
+        pConnection->sock = -1;
+    }
+    pConnection->bufferOffset = 0;
+    pConnection->bufferLength = 0;
+}
+
+// Open a connection to the server.
+static int32_t openConnection(uHttpClientContext_t *pContext,
+                              uHttpClientPooledConnection_t *pConnection)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uSockAddress_t address;
+    int32_t sock;
+
+    if (pConnection->pBuffer == NULL) {
+        // This is free'd by uHttpClientClose()
+        pConnection->pBuffer = (char *) malloc(U_HTTP_CLIENT_BUFFER_LENGTH_BYTES);
+    }
+    if (pConnection->pBuffer != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        address = pContext->serverAddress;
+        if (!pContext->serverAddressKnown) {
+            // Look the server up only once: an IP address
+            // needs no DNS look-up at all
+            if (uSockStringToAddress(pContext->pHostStr, &address) != 0) {
+                errorCode = uSockGetHostByName(pContext->devHandle,
+                                               pContext->pHostStr,
+                                               &(address.ipAddress));
+            }
+            address.port = pContext->serverAddress.port;
+            if (errorCode == 0) {
+                U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+                pContext->serverAddress = address;
+                pContext->serverAddressKnown = true;
+                U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+            } else {
+                uPortLog("U_HTTP_CLIENT: unable to look up \"%s\" (errno %d).\n",
+                         pContext->pHostStr, errno);
+            }
+        }
+        if (errorCode == 0) {
+            sock = uSockCreate(pContext->devHandle, U_SOCK_TYPE_STREAM,
+                               U_SOCK_PROTOCOL_TCP);
+            errorCode = sock;
+            if (sock >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (pContext->pSecurityTlsSettings != NULL) {
+                    errorCode = uSockSecurity(sock, pContext->pSecurityTlsSettings);
+                }
+                if (errorCode == 0) {
+                    errorCode = uSockConnect(sock, &address);
+                }
+                if (errorCode == 0) {
+                    // We do our own waiting so that the sockets
+                    // API is not blocked while we do so
+                    uSockBlockingSet(sock, false);
+                    pConnection->sock = sock;
+                    pConnection->bufferOffset = 0;
+                    pConnection->bufferLength = 0;
+                    U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+                    pContext->totalConnectsMade++;
+                    U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+                } else {
+                    uPortLog("U_HTTP_CLIENT: unable to connect to \"%s\" (errno %d).\n",
+                             pContext->pServerNameStr, errno);
+                    uSockClose(sock);
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get a connection to use for a request, re-using an open
+// idle one if there is one; if fresh is true any open idle
+// connections are closed first.
+static uHttpClientPooledConnection_t *pConnectionGet(uHttpClientContext_t *pContext,
+                                                     bool fresh, bool *pReused,
+                                                     int32_t *pErrorCode)
+{
+    uHttpClientPooledConnection_t *pConnection = NULL;
+    uHttpClientPooledConnection_t *pOpen;
+    uHttpClientPooledConnection_t *pClosed;
+    uHttpClientPooledConnection_t *pThis;
+    int64_t startTimeMs = uPortGetTickTimeMs();
+    int64_t nowMs;
+
+    *pErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    *pReused = false;
+    do {
+        pOpen = NULL;
+        pClosed = NULL;
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+
+        nowMs = uPortGetTickTimeMs();
+        for (size_t x = 0; x < pContext->numConnections; x++) {
+            pThis = &(pContext->pConnections[x]);
+            if (!pThis->inUse) {
+                if ((pThis->sock >= 0) &&
+                    (fresh || (nowMs - pThis->lastUsedMs > pContext->idleTimeoutMs))) {
+                    // Not to be trusted, the server has
+                    // likely closed it by now
+                    closeConnection(pThis);
+                }
+                if (pThis->sock >= 0) {
+                    if (pOpen == NULL) {
+                        pOpen = pThis;
+                    }
+                } else if (pClosed == NULL) {
+                    pClosed = pThis;
+                }
+            }
+        }
+        pConnection = pOpen;
+        if (pConnection == NULL) {
+            pConnection = pClosed;
+        }
+        if (pConnection != NULL) {
+            pConnection->inUse = true;
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+
+        if (pConnection == NULL) {
+            // All connections are busy, wait for one
+            uPortTaskBlock(U_HTTP_CLIENT_POLL_INTERVAL_MS);
+        }
+    } while ((pConnection == NULL) &&
+             (uPortGetTickTimeMs() - startTimeMs < pContext->timeoutMs));
+
+    if (pConnection != NULL) {
+        *pErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pConnection == pOpen) {
+            *pReused = true;
+        } else {
+            // Open a connection, outside the lock since
+            // this may take a while
+            *pErrorCode = openConnection(pContext, pConnection);
+            if (*pErrorCode != 0) {
+                U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+                pConnection->inUse = false;
+                U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+                pConnection = NULL;
+            }
+        }
+    }
+
+    return pConnection;
+}
+
+// Give a connection back to the pool, closing it if it is
+// not to be kept.
+static void connectionRelease(uHttpClientContext_t *pContext,
+                              uHttpClientPooledConnection_t *pConnection,
+                              bool keep)
+{
+    U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+
+    // Anything left unread in the buffer means that we
+    // have lost track of where we are: don't re-use it
+    if (!keep || (pContext->idleTimeoutMs == 0) ||
+        (pConnection->bufferLength > 0)) {
+        closeConnection(pConnection);
+    }
+    pConnection->lastUsedMs = uPortGetTickTimeMs();
+    pConnection->inUse = false;
+
+    U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: RECEIVING
+ * -------------------------------------------------------------- */
+
+// Read more data into the buffer of a connection, returning
+// the number of bytes read, zero if the connection has been
+// closed by the server or negative error code.
+static int32_t readMore(const uHttpClientContext_t *pContext,
+                        uHttpClientPooledConnection_t *pConnection)
+{
+    int32_t sizeOrErrorCode = 0;
+    int64_t startTimeMs = uPortGetTickTimeMs();
+    size_t spaceBytes;
+    bool keepGoing = true;
+
+    // Move what remains to the start of the buffer
+    if ((pConnection->bufferOffset > 0) && (pConnection->bufferLength > 0)) {
+        memmove(pConnection->pBuffer,
+                pConnection->pBuffer + pConnection->bufferOffset,
+                pConnection->bufferLength);
+    }
+    pConnection->bufferOffset = 0;
+    spaceBytes = U_HTTP_CLIENT_BUFFER_LENGTH_BYTES - pConnection->bufferLength;
+
+    while (keepGoing && (spaceBytes > 0)) {
+        errno = 0;
+        sizeOrErrorCode = uSockRead(pConnection->sock,
+                                    pConnection->pBuffer + pConnection->bufferLength,
+                                    spaceBytes);
+        if (sizeOrErrorCode > 0) {
+            pConnection->bufferLength += sizeOrErrorCode;
+            keepGoing = false;
+        } else if ((sizeOrErrorCode < 0) && (errno != U_SOCK_EWOULDBLOCK)) {
+            // Connection closed
+            sizeOrErrorCode = 0;
+            keepGoing = false;
+        } else if (uPortGetTickTimeMs() - startTimeMs >= pContext->timeoutMs) {
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+            keepGoing = false;
+        } else {
+            uPortTaskBlock(U_HTTP_CLIENT_POLL_INTERVAL_MS);
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Read a line, without the CR/LF, into pLine, truncating it if
+// necessary; returns the length of the line or negative error
+// code, U_ERROR_COMMON_TEMPORARY_FAILURE if the connection
+// was closed.
+static int32_t readLine(const uHttpClientContext_t *pContext,
+                        uHttpClientPooledConnection_t *pConnection,
+                        char *pLine, size_t lineSizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    size_t lineLength = 0;
+    bool found = false;
+    char *pData;
+    char c;
+
+    while (!found && (errorCode == 0)) {
+        pData = pConnection->pBuffer + pConnection->bufferOffset;
+        while ((pConnection->bufferLength > 0) && !found) {
+            c = *pData;
+            pData++;
+            pConnection->bufferOffset++;
+            pConnection->bufferLength--;
+            if (c == '\n') {
+                found = true;
+            } else if ((c != '\r') && (lineLength < lineSizeBytes - 1)) {
+                pLine[lineLength] = c;
+                lineLength++;
+            }
+        }
+        if (!found) {
+            errorCode = readMore(pContext, pConnection);
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+            } else if (errorCode > 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+    pLine[lineLength] = 0;
+
+    if (errorCode == 0) {
+        errorCode = (int32_t) lineLength;
+    }
+
+    return errorCode;
+}
+
+// Read a line in place in the receive buffer of a connection,
+// setting *ppLine to point to it there, terminated and without the
+// CR/LF; the line remains valid until the connection is next read.
+// A line that does not fit in the buffer is truncated and
+// *pTruncated is set, in which case the rest of the line is thrown
+// away on the next call.  Returns the length of the line or negative
+// error code, U_ERROR_COMMON_TEMPORARY_FAILURE if the connection
+// was closed.
+static int32_t readLineInPlace(const uHttpClientContext_t *pContext,
+                               uHttpClientPooledConnection_t *pConnection,
+                               char **ppLine, bool *pTruncated)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    char *pStart = NULL;
+    char *pEnd = NULL;
+    size_t x;
+
+    while ((pStart == NULL) && (errorCode == 0)) {
+        pEnd = (char *) memchr(pConnection->pBuffer + pConnection->bufferOffset, '\n',
+                               pConnection->bufferLength);
+        x = pConnection->bufferLength;
+        if (pEnd != NULL) {
+            x = pEnd + 1 - (pConnection->pBuffer + pConnection->bufferOffset);
+        }
+        if (*pTruncated) {
+            // Throw away the rest of a line that was too long
+            *pTruncated = (pEnd == NULL);
+        } else if (pEnd != NULL) {
+            pStart = pConnection->pBuffer + pConnection->bufferOffset;
+        } else if (x == U_HTTP_CLIENT_BUFFER_LENGTH_BYTES) {
+            // A full buffer with no end in sight: keep what we
+            // have, losing the last character to the terminator
+            pStart = pConnection->pBuffer + pConnection->bufferOffset;
+            pEnd = pStart + x - 1;
+            *pTruncated = true;
+        } else {
+            x = 0;
+        }
+        pConnection->bufferOffset += x;
+        pConnection->bufferLength -= x;
+        if ((pStart == NULL) && (pEnd == NULL)) {
+            errorCode = readMore(pContext, pConnection);
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+            } else if (errorCode > 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    if (pStart != NULL) {
+        *pEnd = 0;
+        if ((pEnd > pStart) && (*(pEnd - 1) == '\r')) {
+            pEnd--;
+            *pEnd = 0;
+        }
+        *ppLine = pStart;
+        errorCode = (int32_t) (pEnd - pStart);
+    }
+
+    return errorCode;
+}
+
+// Read sizeBytes of body, or until the connection is closed if
+// untilClosed is true, passing it to the response body callback.
+// *pKeepGoing is set to false if the callback asked to stop.
+static int32_t readBody(const uHttpClientContext_t *pContext,
+                        uHttpClientPooledConnection_t *pConnection,
+                        size_t sizeBytes, bool untilClosed,
+                        uHttpClientResponse_t *pResponse,
+                        bool *pKeepGoing)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    size_t x;
+
+    while (((sizeBytes > 0) || untilClosed) && *pKeepGoing && (errorCode == 0)) {
+        if (pConnection->bufferLength == 0) {
+            errorCode = readMore(pContext, pConnection);
+            if (errorCode == 0) {
+                if (untilClosed) {
+                    // This is the end of the body
+                    untilClosed = false;
+                    sizeBytes = 0;
+                } else {
+                    errorCode = (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE;
+                }
+            } else if (errorCode > 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        x = pConnection->bufferLength;
+        if (!untilClosed && (x > sizeBytes)) {
+            x = sizeBytes;
+        }
+        if ((errorCode == 0) && (x > 0)) {
+            if (pResponse != NULL) {
+                if ((pResponse->pBodyCallback != NULL) &&
+                    !pResponse->pBodyCallback(pConnection->pBuffer + pConnection->bufferOffset,
+                                              x, pResponse->pCallbackParam)) {
+                    *pKeepGoing = false;
+                }
+                pResponse->bodySizeBytes += x;
+            }
+            pConnection->bufferOffset += x;
+            pConnection->bufferLength -= x;
+            if (!untilClosed) {
+                sizeBytes -= x;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Read the status line and headers of the response, skipping
+// any informational (1xx) responses; the lines are parsed in the
+// receive buffer of the connection rather than copied out of it.
+static int32_t readResponseHeader(const uHttpClientContext_t *pContext,
+                                  uHttpClientPooledConnection_t *pConnection,
+                                  uHttpClientResponse_t *pResponse,
+                                  uHttpClientResponseHeader_t *pHeader)
+{
+    int32_t errorCode;
+    char *pLine = NULL;
+    bool truncated = false;
+    char *pValue;
+    char *pEnd;
+
+    do {
+        pHeader->statusCode = -1;
+        pHeader->contentLength = -1;
+        pHeader->chunked = false;
+        pHeader->keepAlive = true;
+        // Status line is of the form "HTTP/1.1 200 OK"
+        errorCode = readLineInPlace(pContext, pConnection, &pLine, &truncated);
+        if (errorCode >= 0) {
+            // The length must be checked first: the line
+            // must at least hold "HTTP/1.x "
+            if ((errorCode >= 9) && (strncmp(pLine, "HTTP/1.", 7) == 0) &&
+                (pLine[8] == ' ')) {
+                // HTTP/1.0 closes the connection unless told otherwise
+                pHeader->keepAlive = (pLine[7] != '0');
+                pHeader->statusCode = strtol(pLine + 9, NULL, 10);
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+            if (pHeader->statusCode >= 100) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        // Now the headers, up to an empty line
+        while (errorCode > 0 || ((errorCode == 0) && (pLine[0] != 0))) {
+            errorCode = readLineInPlace(pContext, pConnection, &pLine, &truncated);
+            if (errorCode > 0) {
+                pValue = strchr(pLine, ':');
+                if (pValue != NULL) {
+                    *pValue = 0;
+                    pValue++;
+                    while (isspace((int32_t) *pValue)) {
+                        pValue++;
+                    }
+                    pEnd = pValue + strlen(pValue);
+                    while ((pEnd > pValue) && isspace((int32_t) * (pEnd - 1))) {
+                        pEnd--;
+                        *pEnd = 0;
+                    }
+                    if (equalNoCase(pLine, "Content-Length")) {
+                        pHeader->contentLength = strtol(pValue, NULL, 10);
+                    } else if (equalNoCase(pLine, "Transfer-Encoding")) {
+                        pHeader->chunked = containsNoCase(pValue, "chunked");
+                    } else if (equalNoCase(pLine, "Connection")) {
+                        if (containsNoCase(pValue, "close")) {
+                            pHeader->keepAlive = false;
+                        } else if (containsNoCase(pValue, "keep-alive")) {
+                            pHeader->keepAlive = true;
+                        }
+                    }
+                    if ((pHeader->statusCode >= 200) && (pResponse != NULL) &&
+                        (pResponse->pHeaderCallback != NULL)) {
+                        pResponse->pHeaderCallback(pLine, pValue, pResponse->pCallbackParam);
+                    }
+                }
+            }
+        }
+    } while ((errorCode == 0) && (pHeader->statusCode < 200));
+
+    return errorCode;
+}
+
+// Read the body of the response.
+static int32_t readResponseBody(const uHttpClientContext_t *pContext,
+                                uHttpClientPooledConnection_t *pConnection,
+                                uHttpClientResponse_t *pResponse,
+                                uHttpClientResponseHeader_t *pHeader)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    char line[32]; // Enough for a chunk size with a few extensions
+    bool keepGoing = true;
+    int32_t x;
+
+    if (pHeader->chunked) {
+        // Chunks are a hex length line, the data then CR/LF,
+        // ending with a zero length chunk and any trailers
+        x = 1;
+        while ((x > 0) && keepGoing && (errorCode == 0)) {
+            errorCode = readLine(pContext, pConnection, line, sizeof(line));
+            if (errorCode >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                x = strtol(line, NULL, 16);
+                if (x > 0) {
+                    errorCode = readBody(pContext, pConnection, x, false,
+                                         pResponse, &keepGoing);
+                    if ((errorCode == 0) && keepGoing) {
+                        errorCode = readLine(pContext, pConnection, line, sizeof(line));
+                        if (errorCode >= 0) {
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        }
+                    }
+                } else if (x < 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                }
+            }
+        }
+        // Skip the trailers
+        while ((errorCode > 0) || ((errorCode == 0) && keepGoing && (x == 0))) {
+            errorCode = readLine(pContext, pConnection, line, sizeof(line));
+            x = -1;
+        }
+    } else if (pHeader->contentLength >= 0) {
+        errorCode = readBody(pContext, pConnection, pHeader->contentLength,
+                             false, pResponse, &keepGoing);
+    } else {
+        // No length given: the body ends when the connection closes
+        pHeader->keepAlive = false;
+        errorCode = readBody(pContext, pConnection, 0, true,
+                             pResponse, &keepGoing);
+    }
+
+    if (!keepGoing) {
+        // The rest of the body is still on its way
+        pHeader->keepAlive = false;
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SENDING
+ * -------------------------------------------------------------- */
+
+// Send a streamed request body using chunked transfer encoding.
+static int32_t sendBodyChunked(int32_t sock, const uHttpClientRequest_t *pRequest)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pBuffer;
+    char *pData;
+    char chunkHeader[U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES + 1];
+    int32_t x = 1;
+    int32_t y;
+
+    pBuffer = (char *) malloc(U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES +
+                              U_HTTP_CLIENT_BUFFER_LENGTH_BYTES + 2);
+    if (pBuffer != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        pData = pBuffer + U_HTTP_CLIENT_CHUNK_HEADER_LENGTH_BYTES;
+        while ((x > 0) && (errorCode == 0)) {
+            x = pRequest->pBodyCallback(pData, U_HTTP_CLIENT_BUFFER_LENGTH_BYTES,
+                                        pRequest->pBodyCallbackParam);
+            if (x > U_HTTP_CLIENT_BUFFER_LENGTH_BYTES) {
+                x = U_HTTP_CLIENT_BUFFER_LENGTH_BYTES;
+            }
+            if (x >= 0) {
+                // Put the length line in front of the data and
+                // the CR/LF behind so that the whole chunk is
+                // sent in one go
+                y = snprintf(chunkHeader, sizeof(chunkHeader), "%x\r\n", (unsigned int) x);
+                memcpy(pData - y, chunkHeader, y);
+                memcpy(pData + x, "\r\n", 2);
+                errorCode = sendAll(sock, pData - y, y + x + 2);
+            } else {
+                errorCode = x;
+            }
+        }
+        free(pBuffer);
+    }
+
+    return errorCode;
+}
+
+// Send a request, header and body.
+static int32_t sendRequest(const uHttpClientContext_t *pContext, int32_t sock,
+                           const uHttpClientRequest_t *pRequest)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pBuffer;
+    size_t bufferSizeBytes;
+    size_t x = 0;
+    size_t bodySizeBytes = 0;
+
+    bufferSizeBytes = strlen(pRequest->pMethodStr) + strlen(pRequest->pPathStr) +
+                      strlen(pContext->pServerNameStr) +
+                      U_HTTP_CLIENT_REQUEST_HEADER_OVERHEAD_BYTES;
+    if (pRequest->pContentTypeStr != NULL) {
+        bufferSizeBytes += strlen(pRequest->pContentTypeStr);
+    }
+    if (pRequest->pHeadersStr != NULL) {
+        bufferSizeBytes += strlen(pRequest->pHeadersStr);
+    }
+    if ((pRequest->pBodyCallback == NULL) && (pRequest->pBody != NULL)) {
+        bodySizeBytes = pRequest->bodySizeBytes;
+        if (bodySizeBytes <= U_HTTP_CLIENT_BUFFER_LENGTH_BYTES) {
+            // Small enough to go out with the header
+            bufferSizeBytes += bodySizeBytes;
+        }
+    }
+
+    pBuffer = (char *) malloc(bufferSizeBytes);
+    if (pBuffer != NULL) {
+        x += snprintf(pBuffer + x, bufferSizeBytes - x, "%s %s HTTP/1.1\r\nHost: %s\r\n",
+                      pRequest->pMethodStr, pRequest->pPathStr,
+                      pContext->pServerNameStr);
+        if (pRequest->pContentTypeStr != NULL) {
+            x += snprintf(pBuffer + x, bufferSizeBytes - x, "Content-Type: %s\r\n",
+                          pRequest->pContentTypeStr);
+        }
+        if (pRequest->pBodyCallback != NULL) {
+            x += snprintf(pBuffer + x, bufferSizeBytes - x, "Transfer-Encoding: chunked\r\n");
+        } else if ((bodySizeBytes > 0) ||
+                   (strcmp(pRequest->pMethodStr, "POST") == 0) ||
+                   (strcmp(pRequest->pMethodStr, "PUT") == 0)) {
+            x += snprintf(pBuffer + x, bufferSizeBytes - x, "Content-Length: %u\r\n",
+                          (unsigned int) bodySizeBytes);
+        }
+        if (pContext->idleTimeoutMs == 0) {
+            x += snprintf(pBuffer + x, bufferSizeBytes - x, "Connection: close\r\n");
+        }
+        if (pRequest->pHeadersStr != NULL) {
+            x += snprintf(pBuffer + x, bufferSizeBytes - x, "%s", pRequest->pHeadersStr);
+        }
+        x += snprintf(pBuffer + x, bufferSizeBytes - x, "\r\n");
+        if ((bodySizeBytes > 0) && (bodySizeBytes <= U_HTTP_CLIENT_BUFFER_LENGTH_BYTES)) {
+            memcpy(pBuffer + x, pRequest->pBody, bodySizeBytes);
+            x += bodySizeBytes;
+            bodySizeBytes = 0;
+        }
+        errorCode = sendAll(sock, pBuffer, x);
+        free(pBuffer);
+        if (errorCode == 0) {
+            if (pRequest->pBodyCallback != NULL) {
+                errorCode = sendBodyChunked(sock, pRequest);
+            } else if (bodySizeBytes > 0) {
+                errorCode = sendAll(sock, pRequest->pBody, bodySizeBytes);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Perform a request on the given connection.
+static int32_t request(const uHttpClientContext_t *pContext,
+                       uHttpClientPooledConnection_t *pConnection,
+                       const uHttpClientRequest_t *pRequest,
+                       uHttpClientResponse_t *pResponse,
+                       bool *pKeepAlive)
+{
+    int32_t errorCode;
+    uHttpClientResponseHeader_t header;
+
+    *pKeepAlive = false;
+    errorCode = sendRequest(pContext, pConnection->sock, pRequest);
+    if (errorCode == 0) {
+        errorCode = readResponseHeader(pContext, pConnection, pResponse, &header);
+        if (errorCode == 0) {
+            if (pResponse != NULL) {
+                pResponse->contentLength = header.contentLength;
+            }
+            // Responses to HEAD, 204 and 304 never have a body
+            if ((strcmp(pRequest->pMethodStr, "HEAD") != 0) &&
+                (header.statusCode != 204) && (header.statusCode != 304)) {
+                errorCode = readResponseBody(pContext, pConnection, pResponse, &header);
+            }
+            if (errorCode == 0) {
+                *pKeepAlive = header.keepAlive;
+                errorCode = header.statusCode;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Open an HTTP client for a server.
+uHttpClientContext_t *pUHttpClientOpen(uDeviceHandle_t devHandle,
+                                       const uHttpClientConnection_t *pConnection)
+{
+    uHttpClientContext_t *pContext = NULL;
+    size_t length;
+    int32_t port;
+
+    gLastOpenError = U_ERROR_COMMON_INVALID_PARAMETER;
+    if ((pConnection != NULL) && (pConnection->pServerNameStr != NULL) &&
+        (pConnection->maxConnections != 0)) {
+        gLastOpenError = U_ERROR_COMMON_NO_MEMORY;
+        pContext = (uHttpClientContext_t *) malloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            memset(pContext, 0, sizeof(*pContext));
+            pContext->devHandle = devHandle;
+            pContext->pSecurityTlsSettings = pConnection->pSecurityTlsSettings;
+            pContext->numConnections = U_HTTP_CLIENT_MAX_CONNECTIONS;
+            if (pConnection->maxConnections > 0) {
+                pContext->numConnections = pConnection->maxConnections;
+            }
+            pContext->timeoutMs = U_HTTP_CLIENT_RESPONSE_WAIT_SECONDS * 1000;
+            if (pConnection->timeoutSeconds >= 0) {
+                pContext->timeoutMs = pConnection->timeoutSeconds * 1000;
+            }
+            pContext->idleTimeoutMs = U_HTTP_CLIENT_IDLE_TIMEOUT_SECONDS * 1000;
+            if (pConnection->idleTimeoutSeconds >= 0) {
+                pContext->idleTimeoutMs = pConnection->idleTimeoutSeconds * 1000;
+            }
+            pContext->pConnections = (uHttpClientPooledConnection_t *) malloc(pContext->numConnections *
+                                                                              sizeof(uHttpClientPooledConnection_t));
+            // Room for the server name twice, the second time
+            // with the port number removed
+            length = strlen(pConnection->pServerNameStr) + 1;
+            pContext->pServerNameStr = (char *) malloc(length * 2);
+            if ((pContext->pConnections != NULL) && (pContext->pServerNameStr != NULL) &&
+                (uPortMutexCreate((uPortMutexHandle_t *) & (pContext->mutexHandle)) == 0)) {
+                memset(pContext->pConnections, 0,
+                       pContext->numConnections * sizeof(uHttpClientPooledConnection_t));
+                for (size_t x = 0; x < pContext->numConnections; x++) {
+                    pContext->pConnections[x].sock = -1;
+                }
+                memcpy(pContext->pServerNameStr, pConnection->pServerNameStr, length);
+                memcpy(pContext->pServerNameStr + length, pConnection->pServerNameStr, length);
+                port = uSockDomainGetPort(pContext->pServerNameStr + length);
+                pContext->pHostStr = pUSockDomainRemovePort(pContext->pServerNameStr + length);
+                if (port < 0) {
+                    port = U_HTTP_CLIENT_PORT_HTTP;
+                    if (pContext->pSecurityTlsSettings != NULL) {
+                        port = U_HTTP_CLIENT_PORT_HTTPS;
+                    }
+                }
+                pContext->serverAddress.port = (uint16_t) port;
+                gLastOpenError = U_ERROR_COMMON_SUCCESS;
+            } else {
+                // Clean up on error
+                free(pContext->pConnections);
+                free(pContext->pServerNameStr);
+                free(pContext);
+                pContext = NULL;
+            }
+        }
+    }
+
+    return pContext;
+}
+
+// Get the last error from pUHttpClientOpen().
+int32_t uHttpClientOpenResetLastError()
+{
+    int32_t errorCode = (int32_t) gLastOpenError;
+    gLastOpenError = U_ERROR_COMMON_SUCCESS;
+    return errorCode;
+}
+
+// Close an HTTP client.
+void uHttpClientClose(uHttpClientContext_t *pContext)
+{
+    if (pContext != NULL) {
+        for (size_t x = 0; x < pContext->numConnections; x++) {
+            closeConnection(&(pContext->pConnections[x]));
+            free(pContext->pConnections[x].pBuffer);
+        }
+        uPortMutexDelete((uPortMutexHandle_t) pContext->mutexHandle);
+        free(pContext->pConnections);
+        free(pContext->pServerNameStr);
+        free(pContext);
+    }
+}
+
+// Perform an HTTP request.
+int32_t uHttpClientRequest(uHttpClientContext_t *pContext,
+                           const uHttpClientRequest_t *pRequest,
+                           uHttpClientResponse_t *pResponse)
+{
+    int32_t errorCodeOrStatus = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uHttpClientPooledConnection_t *pConnection;
+    bool reused = false;
+    bool keepAlive;
+    bool retry = true;
+
+    if ((pContext != NULL) && (pRequest != NULL) &&
+        (pRequest->pMethodStr != NULL) && (pRequest->pPathStr != NULL)) {
+        if (pResponse != NULL) {
+            pResponse->contentLength = -1;
+            pResponse->bodySizeBytes = 0;
+        }
+        for (size_t x = 0; (x < 2) && retry; x++) {
+            retry = false;
+            pConnection = pConnectionGet(pContext, x > 0, &reused, &errorCodeOrStatus);
+            if (pConnection != NULL) {
+                errorCodeOrStatus = request(pContext, pConnection, pRequest,
+                                            pResponse, &keepAlive);
+                // A connection that has been idle may have been
+                // closed by the server without us noticing: if
+                // so, and nothing can have been lost, try again
+                // on a new connection
+                retry = reused && (errorCodeOrStatus == (int32_t) U_ERROR_COMMON_TEMPORARY_FAILURE) &&
+                        (pRequest->pBodyCallback == NULL) &&
+                        ((pResponse == NULL) || (pResponse->bodySizeBytes == 0));
+                connectionRelease(pContext, pConnection, keepAlive && (errorCodeOrStatus > 0));
+                if (retry) {
+                    uPortLog("U_HTTP_CLIENT: connection to \"%s\" was closed,"
+                             " retrying on a new one.\n", pContext->pServerNameStr);
+                }
+            }
+        }
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+        pContext->totalRequests++;
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+    }
+
+    return errorCodeOrStatus;
+}
+
+// Close any idle connections.
+void uHttpClientCloseIdle(uHttpClientContext_t *pContext)
+{
+    if (pContext != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pContext->mutexHandle);
+
+        for (size_t x = 0; x < pContext->numConnections; x++) {
+            if (!pContext->pConnections[x].inUse) {
+                closeConnection(&(pContext->pConnections[x]));
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pContext->mutexHandle);
+    }
+}
+
+// Get the number of connections that have been opened.
+int32_t uHttpClientGetTotalConnectsMade(const uHttpClientContext_t *pContext)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pContext != NULL) {
+        errorCodeOrCount = pContext->totalConnectsMade;
+    }
+
+    return errorCodeOrCount;
+}
+
+// End of file
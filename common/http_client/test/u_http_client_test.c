@@ -0,0 +1,718 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the u-blox HTTP client API.  No module is required:
+ * the HTTP server is simulated by a socket implementation plugged
+ * into a dummy device (see u_sock_backend.h), which lets the
+ * behaviour on the wire (keep-alive, chunked encoding in both
+ * directions, the server closing a connection) be checked exactly
+ * on any platform.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc(), free(), strtol()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // strstr(), memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_device.h"
+#include "u_device_shared.h"
+
+#include "u_sock.h"
+#include "u_sock_errno.h"
+#include "u_sock_backend.h"
+
+#include "u_http_client.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_HTTP_CLIENT_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The name of the simulated server, port included.
+ */
+#define U_HTTP_CLIENT_TEST_SERVER "http.test:8080"
+
+/** The IP address the simulated server name resolves to.
+ */
+#define U_HTTP_CLIENT_TEST_SERVER_IP_ADDRESS 0x0a000001
+
+/** The number of sockets the simulated server supports.
+ */
+#define U_HTTP_CLIENT_TEST_MAX_NUM_SOCKETS 3
+
+/** Buffer size for each direction of each simulated socket.
+ */
+#define U_HTTP_CLIENT_TEST_SOCK_BUFFER_LENGTH_BYTES 1024
+
+/** The most that a simulated socket will return in one read,
+ * small so that responses arrive in pieces.
+ */
+#define U_HTTP_CLIENT_TEST_READ_MAX_LENGTH_BYTES 37
+
+/** The most that the upload callback will provide in one go.
+ */
+#define U_HTTP_CLIENT_TEST_UPLOAD_MAX_LENGTH_BYTES 50
+
+/** The number of times the test data is sent in the upload.
+ */
+#define U_HTTP_CLIENT_TEST_UPLOAD_REPEATS 5
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A simulated socket.
+ */
+typedef struct {
+    bool inUse;
+    bool connected;
+    bool closedByServer; /**< once the data in tx has been read. */
+    char rx[U_HTTP_CLIENT_TEST_SOCK_BUFFER_LENGTH_BYTES]; /**< from the client. */
+    size_t rxLength;
+    char tx[U_HTTP_CLIENT_TEST_SOCK_BUFFER_LENGTH_BYTES]; /**< to the client. */
+    size_t txOffset;
+    size_t txLength;
+} uHttpClientTestSock_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated sockets, malloc()ed for the test.
+ */
+static uHttpClientTestSock_t *gpSock = NULL;
+
+/** The dummy device the simulated server hangs off.
+ */
+static uDeviceInstance_t *gpDevice = NULL;
+
+/** The HTTP client context.
+ */
+static uHttpClientContext_t *gpContext = NULL;
+
+/** Data to send and receive; all printable characters.
+ */
+static const char gData[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                            "0123456789\"!#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+/** Where received body data is put.
+ */
+static char gBody[sizeof(gData) * 2];
+
+/** The amount of received body data.
+ */
+static size_t gBodyLength = 0;
+
+/** The number of times the header callback has been called
+ * with the test header.
+ */
+static int32_t gTestHeaderCount = 0;
+
+/** The number of times the header callback has been called.
+ */
+static int32_t gHeaderCount = 0;
+
+/** The length of the value of the long test header as
+ * passed to the header callback.
+ */
+static size_t gLongHeaderLength = 0;
+
+/** How far the upload callback has got.
+ */
+static size_t gUploadOffset = 0;
+
+/** The number of upload body bytes the server received,
+ * -1 if they were not as expected.
+ */
+static int32_t gUploadReceivedLength = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE SIMULATED SERVER
+ * -------------------------------------------------------------- */
+
+// Append a response to the transmit buffer of a socket.
+static void serverRespond(uHttpClientTestSock_t *pSock,
+                          const char *pHeader, const char *pBody,
+                          size_t bodyLength)
+{
+    size_t x = strlen(pHeader);
+
+    U_PORT_TEST_ASSERT(pSock->txLength + x + bodyLength <= sizeof(pSock->tx));
+    memcpy(pSock->tx + pSock->txLength, pHeader, x);
+    pSock->txLength += x;
+    if (pBody != NULL) {
+        memcpy(pSock->tx + pSock->txLength, pBody, bodyLength);
+        pSock->txLength += bodyLength;
+    }
+}
+
+// Check a chunked request body, returning its length if it
+// is complete (i.e. the last chunk and trailer have arrived),
+// else negative; *pSize must be zero on entry and is set to
+// the total size that the body occupies on the wire.
+static int32_t serverDecodeChunked(const char *pData, size_t length,
+                                   size_t *pSize)
+{
+    int32_t decodedLength = 0;
+    const char *pStart = pData;
+    const char *pEnd = pData + length;
+    const char *pLineEnd;
+    int32_t chunkLength = -1;
+
+    while ((chunkLength != 0) && (decodedLength >= 0)) {
+        pLineEnd = strstr(pData, "\r\n");
+        decodedLength = -1;
+        if ((pLineEnd != NULL) && (pLineEnd < pEnd)) {
+            chunkLength = strtol(pData, NULL, 16);
+            pData = pLineEnd + 2;
+            if (pData + chunkLength + 2 <= pEnd) {
+                // Check that the data is what the upload callback sends
+                for (int32_t x = 0; x < chunkLength; x++) {
+                    if (pData[x] != gData[(*pSize + x) % (sizeof(gData) - 1)]) {
+                        gUploadReceivedLength = -1;
+                    }
+                }
+                *pSize += chunkLength;
+                pData += chunkLength;
+                U_PORT_TEST_ASSERT(memcmp(pData, "\r\n", 2) == 0);
+                pData += 2;
+                decodedLength = 0;
+            }
+        }
+    }
+    if (decodedLength == 0) {
+        decodedLength = (int32_t) *pSize;
+        *pSize = pData - pStart;
+    }
+
+    return decodedLength;
+}
+
+// Handle any complete requests received on a socket.
+static void serverProcess(uHttpClientTestSock_t *pSock)
+{
+    char *pHeaderEnd;
+    char *pTmp;
+    char header[128];
+    size_t requestLength;
+    size_t bodyLength;
+    size_t chunkLength;
+    int32_t x;
+    bool keepGoing = true;
+
+    while (keepGoing) {
+        keepGoing = false;
+        bodyLength = 0;
+        x = 0;
+        pSock->rx[pSock->rxLength] = 0;
+        pHeaderEnd = strstr(pSock->rx, "\r\n\r\n");
+        if (pHeaderEnd != NULL) {
+            pHeaderEnd += 4;
+            requestLength = pHeaderEnd - pSock->rx;
+            *(pHeaderEnd - 2) = 0;
+            pTmp = strstr(pSock->rx, "Content-Length: ");
+            if (pTmp != NULL) {
+                bodyLength = strtol(pTmp + 16, NULL, 10);
+            }
+            if (strstr(pSock->rx, "Transfer-Encoding: chunked\r\n") != NULL) {
+                *(pHeaderEnd - 2) = '\r';
+                bodyLength = 0;
+                x = serverDecodeChunked(pHeaderEnd, pSock->rxLength - requestLength,
+                                        &bodyLength);
+                *(pHeaderEnd - 2) = 0;
+            }
+            if ((x >= 0) && (requestLength + bodyLength <= pSock->rxLength)) {
+                // Got a whole request, respond to it
+                if (strstr(pSock->rx, "\r\nHost: " U_HTTP_CLIENT_TEST_SERVER "\r\n") == NULL) {
+                    serverRespond(pSock, "HTTP/1.1 400 Bad Request\r\n"
+                                  "Content-Length: 0\r\n\r\n", NULL, 0);
+                } else if (strncmp(pSock->rx, "GET /length ", 12) == 0) {
+                    snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\n"
+                             "Content-Length: %d\r\nX-Test: yes\r\n\r\n",
+                             (int) (sizeof(gData) - 1));
+                    serverRespond(pSock, header, gData, sizeof(gData) - 1);
+                } else if (strncmp(pSock->rx, "GET /chunked ", 13) == 0) {
+                    serverRespond(pSock, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n"
+                                  "x-test: yes\r\n\r\n", NULL, 0);
+                    for (size_t y = 0; y < sizeof(gData) - 1; y += 16) {
+                        chunkLength = sizeof(gData) - 1 - y;
+                        if (chunkLength > 16) {
+                            chunkLength = 16;
+                        }
+                        snprintf(header, sizeof(header), "%x\r\n", (unsigned int) chunkLength);
+                        serverRespond(pSock, header, gData + y, chunkLength);
+                        serverRespond(pSock, "\r\n", NULL, 0);
+                    }
+                    serverRespond(pSock, "0\r\nX-Trailer: yes\r\n\r\n", NULL, 0);
+                } else if (strncmp(pSock->rx, "GET /close ", 11) == 0) {
+                    // HTTP 1.0, no length: the body ends at closure
+                    serverRespond(pSock, "HTTP/1.0 200 OK\r\n\r\n", gData, sizeof(gData) - 1);
+                    pSock->closedByServer = true;
+                } else if (strncmp(pSock->rx, "GET /long ", 10) == 0) {
+                    // A header line longer than the receive buffer of
+                    // the client, full of colons so that any of it
+                    // taken for another header would be noticed
+                    serverRespond(pSock, "HTTP/1.1 200 OK\r\nX-Long: ", NULL, 0);
+                    for (size_t y = 0; y < U_HTTP_CLIENT_BUFFER_LENGTH_BYTES; y += 2) {
+                        serverRespond(pSock, "a:", NULL, 0);
+                    }
+                    snprintf(header, sizeof(header), "\r\nX-Test: yes\r\n"
+                             "Content-Length: %d\r\n\r\n", (int) (sizeof(gData) - 1));
+                    serverRespond(pSock, header, gData, sizeof(gData) - 1);
+                } else if (strncmp(pSock->rx, "GET /short ", 11) == 0) {
+                    serverRespond(pSock, "HTTP/1.\r\n\r\n", NULL, 0);
+                } else if (strncmp(pSock->rx, "GET /continue ", 14) == 0) {
+                    serverRespond(pSock, "HTTP/1.1 100 Continue\r\n\r\n"
+                                  "HTTP/1.1 204 No Content\r\n\r\n", NULL, 0);
+                } else if (strncmp(pSock->rx, "POST /upload ", 13) == 0) {
+                    if (gUploadReceivedLength >= 0) {
+                        gUploadReceivedLength = x;
+                    }
+                    serverRespond(pSock, "HTTP/1.1 201 Created\r\n"
+                                  "Content-Length: 0\r\n\r\n", NULL, 0);
+                } else {
+                    serverRespond(pSock, "HTTP/1.1 404 Not Found\r\n"
+                                  "Content-Length: 0\r\n\r\n", NULL, 0);
+                }
+                requestLength += bodyLength;
+                pSock->rxLength -= requestLength;
+                memmove(pSock->rx, pSock->rx + requestLength, pSock->rxLength);
+                keepGoing = true;
+            } else {
+                *(pHeaderEnd - 2) = '\r';
+            }
+        }
+    }
+}
+
+// Close all connections from the server end, as a server
+// does when a connection has been idle for a while.
+static void serverCloseAll()
+{
+    for (size_t x = 0; x < U_HTTP_CLIENT_TEST_MAX_NUM_SOCKETS; x++) {
+        if (gpSock[x].inUse) {
+            gpSock[x].closedByServer = true;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE SIMULATED SOCKET IMPLEMENTATION
+ * -------------------------------------------------------------- */
+
+static int32_t sockCreate(uDeviceHandle_t devHandle, uSockType_t type,
+                          uSockProtocol_t protocol)
+{
+    int32_t sockHandle = -U_SOCK_ENOBUFS;
+
+    (void) devHandle;
+    (void) type;
+    (void) protocol;
+    for (size_t x = 0; (x < U_HTTP_CLIENT_TEST_MAX_NUM_SOCKETS) && (sockHandle < 0); x++) {
+        if (!gpSock[x].inUse) {
+            memset(&(gpSock[x]), 0, sizeof(gpSock[x]));
+            gpSock[x].inUse = true;
+            sockHandle = (int32_t) x;
+        }
+    }
+
+    return sockHandle;
+}
+
+static int32_t sockConnect(uDeviceHandle_t devHandle, int32_t sockHandle,
+                           const uSockAddress_t *pRemoteAddress)
+{
+    int32_t errorCode = -U_SOCK_EHOSTUNREACH;
+
+    (void) devHandle;
+    if ((pRemoteAddress->ipAddress.address.ipv4 == U_HTTP_CLIENT_TEST_SERVER_IP_ADDRESS) &&
+        (pRemoteAddress->port == 8080)) {
+        gpSock[sockHandle].connected = true;
+        errorCode = 0;
+    }
+
+    return errorCode;
+}
+
+static int32_t sockClose(uDeviceHandle_t devHandle, int32_t sockHandle,
+                         void (*pCallback) (uDeviceHandle_t, int32_t))
+{
+    (void) devHandle;
+    (void) pCallback;
+    gpSock[sockHandle].inUse = false;
+
+    return 0;
+}
+
+static int32_t sockWrite(uDeviceHandle_t devHandle, int32_t sockHandle,
+                         const void *pData, size_t dataSizeBytes)
+{
+    uHttpClientTestSock_t *pSock = &(gpSock[sockHandle]);
+    int32_t sizeOrErrorCode = -U_SOCK_ENOTCONN;
+
+    (void) devHandle;
+    if (pSock->connected && !pSock->closedByServer) {
+        // Leave room for a terminator
+        sizeOrErrorCode = sizeof(pSock->rx) - pSock->rxLength - 1;
+        if (sizeOrErrorCode > (int32_t) dataSizeBytes) {
+            sizeOrErrorCode = (int32_t) dataSizeBytes;
+        }
+        U_PORT_TEST_ASSERT(sizeOrErrorCode > 0);
+        memcpy(pSock->rx + pSock->rxLength, pData, sizeOrErrorCode);
+        pSock->rxLength += sizeOrErrorCode;
+        serverProcess(pSock);
+    }
+
+    return sizeOrErrorCode;
+}
+
+static int32_t sockRead(uDeviceHandle_t devHandle, int32_t sockHandle,
+                        void *pData, size_t dataSizeBytes)
+{
+    uHttpClientTestSock_t *pSock = &(gpSock[sockHandle]);
+    int32_t sizeOrErrorCode = -U_SOCK_EWOULDBLOCK;
+
+    (void) devHandle;
+    if (pSock->txLength > pSock->txOffset) {
+        sizeOrErrorCode = pSock->txLength - pSock->txOffset;
+        if (sizeOrErrorCode > (int32_t) dataSizeBytes) {
+            sizeOrErrorCode = (int32_t) dataSizeBytes;
+        }
+        if (sizeOrErrorCode > U_HTTP_CLIENT_TEST_READ_MAX_LENGTH_BYTES) {
+            sizeOrErrorCode = U_HTTP_CLIENT_TEST_READ_MAX_LENGTH_BYTES;
+        }
+        memcpy(pData, pSock->tx + pSock->txOffset, sizeOrErrorCode);
+        pSock->txOffset += sizeOrErrorCode;
+        if (pSock->txOffset == pSock->txLength) {
+            pSock->txOffset = 0;
+            pSock->txLength = 0;
+        }
+    } else if (pSock->closedByServer) {
+        sizeOrErrorCode = -U_SOCK_ENOTCONN;
+    }
+
+    return sizeOrErrorCode;
+}
+
+static int32_t sockGetHostByName(uDeviceHandle_t devHandle,
+                                 const char *pHostName,
+                                 uSockIpAddress_t *pHostIpAddress)
+{
+    int32_t errorCode = -U_SOCK_EHOSTUNREACH;
+
+    (void) devHandle;
+    if (strcmp(pHostName, "http.test") == 0) {
+        pHostIpAddress->type = U_SOCK_ADDRESS_TYPE_V4;
+        pHostIpAddress->address.ipv4 = U_HTTP_CLIENT_TEST_SERVER_IP_ADDRESS;
+        errorCode = 0;
+    }
+
+    return errorCode;
+}
+
+/** The simulated socket implementation.
+ */
+static const uSockBackend_t gBackend = {
+    .asyncTcpClose = false,
+    .pCreate = sockCreate,
+    .pConnect = sockConnect,
+    .pClose = sockClose,
+    .pWrite = sockWrite,
+    .pRead = sockRead,
+    .pGetHostByName = sockGetHostByName
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HTTP CALLBACKS
+ * -------------------------------------------------------------- */
+
+// Callback for each header of a response.
+static void headerCallback(const char *pNameStr, const char *pValueStr,
+                           void *pCallbackParam)
+{
+    (void) pCallbackParam;
+    if ((strcmp(pNameStr, "X-Test") == 0) || (strcmp(pNameStr, "x-test") == 0)) {
+        U_PORT_TEST_ASSERT(strcmp(pValueStr, "yes") == 0);
+        gTestHeaderCount++;
+    } else if (strcmp(pNameStr, "X-Long") == 0) {
+        gLongHeaderLength = strlen(pValueStr);
+    }
+    gHeaderCount++;
+}
+
+// Callback for response body data.
+static bool bodyCallback(const char *pData, size_t dataSizeBytes,
+                         void *pCallbackParam)
+{
+    (void) pCallbackParam;
+    U_PORT_TEST_ASSERT(gBodyLength + dataSizeBytes <= sizeof(gBody));
+    memcpy(gBody + gBodyLength, pData, dataSizeBytes);
+    gBodyLength += dataSizeBytes;
+
+    return true;
+}
+
+// Callback providing request body data.
+static int32_t uploadCallback(char *pBuffer, size_t bufferSizeBytes,
+                              void *pCallbackParam)
+{
+    int32_t size = 0;
+    size_t *pOffset = (size_t *) pCallbackParam;
+
+    for (size_t x = 0; (x < bufferSizeBytes) &&
+         (x < U_HTTP_CLIENT_TEST_UPLOAD_MAX_LENGTH_BYTES) &&
+         (*pOffset < (sizeof(gData) - 1) * U_HTTP_CLIENT_TEST_UPLOAD_REPEATS); x++) {
+        *pBuffer = gData[*pOffset % (sizeof(gData) - 1)];
+        pBuffer++;
+        (*pOffset)++;
+        size++;
+    }
+
+    return size;
+}
+
+// Do a GET and check that the test data comes back.
+static void getAndCheck(const char *pPathStr, int32_t expectedContentLength)
+{
+    uHttpClientRequest_t request = U_HTTP_CLIENT_REQUEST_DEFAULT;
+    uHttpClientResponse_t response = U_HTTP_CLIENT_RESPONSE_DEFAULT;
+
+    request.pPathStr = pPathStr;
+    response.pHeaderCallback = headerCallback;
+    response.pBodyCallback = bodyCallback;
+    gBodyLength = 0;
+    U_TEST_PRINT_LINE("GET %s...", pPathStr);
+    U_PORT_TEST_ASSERT(uHttpClientRequest(gpContext, &request, &response) == 200);
+    U_PORT_TEST_ASSERT(response.contentLength == expectedContentLength);
+    U_PORT_TEST_ASSERT(response.bodySizeBytes == sizeof(gData) - 1);
+    U_PORT_TEST_ASSERT(gBodyLength == sizeof(gData) - 1);
+    U_PORT_TEST_ASSERT(memcmp(gBody, gData, gBodyLength) == 0);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the HTTP client against a simulated server.
+ */
+U_PORT_TEST_FUNCTION("[httpClient]", "httpClientSimulated")
+{
+    uHttpClientConnection_t connection = U_HTTP_CLIENT_CONNECTION_DEFAULT;
+    uHttpClientRequest_t request = U_HTTP_CLIENT_REQUEST_DEFAULT;
+    uHttpClientResponse_t response = U_HTTP_CLIENT_RESPONSE_DEFAULT;
+    int32_t heapUsed;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    // In case a previous test left sockets hanging
+    uSockDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    gpSock = (uHttpClientTestSock_t *) malloc(sizeof(uHttpClientTestSock_t) *
+                                              U_HTTP_CLIENT_TEST_MAX_NUM_SOCKETS);
+    U_PORT_TEST_ASSERT(gpSock != NULL);
+    memset(gpSock, 0, sizeof(uHttpClientTestSock_t) * U_HTTP_CLIENT_TEST_MAX_NUM_SOCKETS);
+    gpDevice = pUDeviceCreateInstance(U_DEVICE_TYPE_CELL);
+    U_PORT_TEST_ASSERT(gpDevice != NULL);
+    gpDevice->pSockBackend = &gBackend;
+
+    // Check parameter errors
+    U_PORT_TEST_ASSERT(pUHttpClientOpen((uDeviceHandle_t) gpDevice, NULL) == NULL);
+    U_PORT_TEST_ASSERT(uHttpClientOpenResetLastError() < 0);
+    U_PORT_TEST_ASSERT(pUHttpClientOpen((uDeviceHandle_t) gpDevice, &connection) == NULL);
+    U_PORT_TEST_ASSERT(uHttpClientOpenResetLastError() < 0);
+    U_PORT_TEST_ASSERT(uHttpClientOpenResetLastError() == 0);
+
+    connection.pServerNameStr = U_HTTP_CLIENT_TEST_SERVER;
+    connection.timeoutSeconds = 5;
+    gpContext = pUHttpClientOpen((uDeviceHandle_t) gpDevice, &connection);
+    U_PORT_TEST_ASSERT(gpContext != NULL);
+    U_PORT_TEST_ASSERT(uHttpClientOpenResetLastError() == 0);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 0);
+
+    U_TEST_PRINT_LINE("testing keep-alive.");
+    gTestHeaderCount = 0;
+    for (size_t x = 0; x < 3; x++) {
+        getAndCheck("/length", sizeof(gData) - 1);
+        getAndCheck("/chunked", -1);
+    }
+    U_PORT_TEST_ASSERT(gTestHeaderCount == 6);
+    // All of that should have been done on one connection
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 1);
+
+    U_TEST_PRINT_LINE("testing informational response and no body.");
+    request.pPathStr = "/continue";
+    U_PORT_TEST_ASSERT(uHttpClientRequest(gpContext, &request, NULL) == 204);
+    request.pPathStr = "/nothing";
+    U_PORT_TEST_ASSERT(uHttpClientRequest(gpContext, &request, NULL) == 404);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 1);
+
+    U_TEST_PRINT_LINE("testing streamed upload.");
+    request.pMethodStr = "POST";
+    request.pPathStr = "/upload";
+    request.pContentTypeStr = "text/plain";
+    request.pBodyCallback = uploadCallback;
+    request.pBodyCallbackParam = &gUploadOffset;
+    gUploadOffset = 0;
+    gUploadReceivedLength = 0;
+    U_PORT_TEST_ASSERT(uHttpClientRequest(gpContext, &request, &response) == 201);
+    U_PORT_TEST_ASSERT(gUploadReceivedLength == (sizeof(gData) - 1) *
+                       U_HTTP_CLIENT_TEST_UPLOAD_REPEATS);
+    U_PORT_TEST_ASSERT(response.contentLength == 0);
+    U_PORT_TEST_ASSERT(response.bodySizeBytes == 0);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 1);
+
+    U_TEST_PRINT_LINE("testing a connection closed by the server while idle.");
+    serverCloseAll();
+    getAndCheck("/length", sizeof(gData) - 1);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 2);
+
+    U_TEST_PRINT_LINE("testing a body that ends with closure.");
+    getAndCheck("/close", -1);
+    // The next request must use a new connection
+    getAndCheck("/length", sizeof(gData) - 1);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 3);
+
+    U_TEST_PRINT_LINE("testing closing idle connections.");
+    uHttpClientCloseIdle(gpContext);
+    getAndCheck("/chunked", -1);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 4);
+
+    U_TEST_PRINT_LINE("testing a header longer than the receive buffer.");
+    gTestHeaderCount = 0;
+    gHeaderCount = 0;
+    gLongHeaderLength = 0;
+    getAndCheck("/long", sizeof(gData) - 1);
+    // The long header should have been truncated, the last
+    // character of the buffer giving way to the terminator,
+    // and the rest of it thrown away
+    U_PORT_TEST_ASSERT(gLongHeaderLength == U_HTTP_CLIENT_BUFFER_LENGTH_BYTES -
+                       sizeof("X-Long: "));
+    U_PORT_TEST_ASSERT(gTestHeaderCount == 1);
+    U_PORT_TEST_ASSERT(gHeaderCount == 3);
+
+    U_TEST_PRINT_LINE("testing a status line that is too short.");
+    request.pMethodStr = "GET";
+    request.pPathStr = "/short";
+    request.pContentTypeStr = NULL;
+    request.pBodyCallback = NULL;
+    request.pBodyCallbackParam = NULL;
+    U_PORT_TEST_ASSERT(uHttpClientRequest(gpContext, &request, NULL) ==
+                       (int32_t) U_ERROR_COMMON_DEVICE_ERROR);
+    getAndCheck("/length", sizeof(gData) - 1);
+
+    uHttpClientClose(gpContext);
+    gpContext = NULL;
+    for (size_t x = 0; x < U_HTTP_CLIENT_TEST_MAX_NUM_SOCKETS; x++) {
+        U_PORT_TEST_ASSERT(!gpSock[x].inUse);
+    }
+
+    U_TEST_PRINT_LINE("testing with keep-alive switched off.");
+    connection.idleTimeoutSeconds = 0;
+    gpContext = pUHttpClientOpen((uDeviceHandle_t) gpDevice, &connection);
+    U_PORT_TEST_ASSERT(gpContext != NULL);
+    getAndCheck("/length", sizeof(gData) - 1);
+    getAndCheck("/length", sizeof(gData) - 1);
+    U_PORT_TEST_ASSERT(uHttpClientGetTotalConnectsMade(gpContext) == 2);
+    uHttpClientClose(gpContext);
+    gpContext = NULL;
+
+    uSockCleanUp();
+    uSockDeinit();
+    uDeviceDestroyInstance(gpDevice);
+    gpDevice = NULL;
+    free(gpSock);
+    gpSock = NULL;
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[httpClient]", "httpClientCleanUp")
+{
+    int32_t y;
+
+    if (gpContext != NULL) {
+        uHttpClientClose(gpContext);
+        gpContext = NULL;
+    }
+    uSockDeinit();
+    if (gpDevice != NULL) {
+        uDeviceDestroyInstance(gpDevice);
+        gpDevice = NULL;
+    }
+    free(gpSock);
+    gpSock = NULL;
+
+    y = uPortTaskStackMinFree(NULL);
+    if (y != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("main task stack had a minimum of %d"
+                          " byte(s) free at the end of these tests.", y);
+        U_PORT_TEST_ASSERT(y >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    y = uPortGetHeapMinFree();
+    if (y >= 0) {
+        U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free"
+                          " at the end of these tests.", y);
+        U_PORT_TEST_ASSERT(y >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+// End of file
@@ -54,6 +54,7 @@
 #include "u_location_shared.h"
 
 #include "u_location_private_cloud_locate.h"
+#include "u_location_backend.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -185,6 +186,234 @@ static void cellLocCallback(uDeviceHandle_t devHandle,
     }
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: BACKENDS
+ * -------------------------------------------------------------- */
+
+// Get the current location from a cellular device, blocking version.
+static int32_t cellGet(uDeviceHandle_t devHandle, uLocationType_t type,
+                       const uLocationAssist_t *pLocationAssist,
+                       const char *pAuthenticationTokenStr,
+                       uLocation_t *pLocation,
+                       bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    uLocation_t location;
+    uDeviceHandle_t gnssDeviceHandle;
+
+    location.type = type;
+    if (location.type == U_LOCATION_TYPE_CLOUD_CELL_LOCATE) {
+        errorCode = cellLocConfigure(devHandle,
+                                     pLocationAssist,
+                                     pAuthenticationTokenStr);
+        if (errorCode == 0) {
+            errorCode = uCellLocGet(devHandle,
+                                    &(location.latitudeX1e7),
+                                    &(location.longitudeX1e7),
+                                    &(location.altitudeMillimetres),
+                                    &(location.radiusMillimetres),
+                                    &(location.speedMillimetresPerSecond),
+                                    &(location.svs),
+                                    &(location.timeUtc),
+                                    pKeepGoingCallback);
+            if (pLocation != NULL) {
+                *pLocation = location;
+            }
+        }
+    } else if (location.type == U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // For Cloud Locate the GNSS network handle is attached to
+        // the network data associated with the device handle (and
+        // the MQTT client handle is passed in via pLocationAssist)
+        gnssDeviceHandle = uNetworkGetDeviceHandle(devHandle, U_NETWORK_TYPE_GNSS);
+        if ((pLocationAssist != NULL) && (gnssDeviceHandle != NULL)) {
+            errorCode = uLocationPrivateCloudLocate(devHandle, gnssDeviceHandle,
+                                                    (uMqttClientContext_t *) pLocationAssist->pMqttClientContext,
+                                                    pLocationAssist->svsThreshold,
+                                                    pLocationAssist->cNoThreshold,
+                                                    pLocationAssist->multipathIndexLimit,
+                                                    pLocationAssist->pseudorangeRmsErrorIndexLimit,
+                                                    pLocationAssist->pClientIdStr,
+                                                    &location, pKeepGoingCallback);
+            if (pLocation != NULL) {
+                *pLocation = location;
+            }
+        }
+    } else if (location.type == U_LOCATION_TYPE_GNSS) {
+        // A GNSS device inside or connected-via a cellular device
+        errorCode = uGnssPosGet(devHandle,
+                                &(location.latitudeX1e7),
+                                &(location.longitudeX1e7),
+                                &(location.altitudeMillimetres),
+                                &(location.radiusMillimetres),
+                                &(location.speedMillimetresPerSecond),
+                                &(location.svs),
+                                &(location.timeUtc),
+                                pKeepGoingCallback);
+        if (pLocation != NULL) {
+            pLocation->type = U_LOCATION_TYPE_GNSS;
+            *pLocation = location;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the current location from a cellular device, non-blocking version.
+static int32_t cellGetStart(uDeviceHandle_t devHandle, uLocationType_t type,
+                            const uLocationAssist_t *pLocationAssist,
+                            const char *pAuthenticationTokenStr,
+                            void (*pCallback) (uDeviceHandle_t devHandle,
+                                               int32_t errorCode,
+                                               const uLocation_t *pLocation))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (type == U_LOCATION_TYPE_CLOUD_CELL_LOCATE) {
+        errorCode = cellLocConfigure(devHandle,
+                                     pLocationAssist,
+                                     pAuthenticationTokenStr);
+        if (errorCode == 0) {
+            errorCode = uLocationSharedRequestPush(devHandle,
+                                                   type,
+                                                   pCallback);
+            if (errorCode == 0) {
+                errorCode = uCellLocGetStart(devHandle, cellLocCallback);
+                if (errorCode != 0) {
+                    free(pULocationSharedRequestPop(U_LOCATION_TYPE_CLOUD_CELL_LOCATE));
+                }
+            }
+        }
+    } else if (type == U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+        // TODO
+
+    }
+
+    return errorCode;
+}
+
+// Get the current location from a GNSS device, blocking version.
+static int32_t gnssGet(uDeviceHandle_t devHandle, uLocationType_t type,
+                       const uLocationAssist_t *pLocationAssist,
+                       const char *pAuthenticationTokenStr,
+                       uLocation_t *pLocation,
+                       bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCode;
+    uLocation_t location;
+
+    // type, pLocationAssist and pAuthenticationTokenStr are
+    // irrelevant in this case, we just ask GNSS
+    (void) type;
+    (void) pLocationAssist;
+    (void) pAuthenticationTokenStr;
+    errorCode = uGnssPosGet(devHandle,
+                            &(location.latitudeX1e7),
+                            &(location.longitudeX1e7),
+                            &(location.altitudeMillimetres),
+                            &(location.radiusMillimetres),
+                            &(location.speedMillimetresPerSecond),
+                            &(location.svs),
+                            &(location.timeUtc),
+                            pKeepGoingCallback);
+    if (pLocation != NULL) {
+        pLocation->type = U_LOCATION_TYPE_GNSS;
+        *pLocation = location;
+    }
+
+    return errorCode;
+}
+
+// Get the current location from a GNSS device, non-blocking version.
+static int32_t gnssGetStart(uDeviceHandle_t devHandle, uLocationType_t type,
+                            const uLocationAssist_t *pLocationAssist,
+                            const char *pAuthenticationTokenStr,
+                            void (*pCallback) (uDeviceHandle_t devHandle,
+                                               int32_t errorCode,
+                                               const uLocation_t *pLocation))
+{
+    int32_t errorCode;
+
+    // type, pLocationAssist and pAuthenticationTokenStr are
+    // irrelevant in this case, we just ask GNSS
+    (void) type;
+    (void) pLocationAssist;
+    (void) pAuthenticationTokenStr;
+    errorCode = uLocationSharedRequestPush(devHandle,
+                                           U_LOCATION_TYPE_GNSS,
+                                           pCallback);
+    if (errorCode == 0) {
+        errorCode = uGnssPosGetStart(devHandle, gnssPosCallback);
+        if (errorCode != 0) {
+            free(pULocationSharedRequestPop(U_LOCATION_TYPE_GNSS));
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the status of a GNSS location establishment attempt.
+static int32_t gnssGetStatus(uDeviceHandle_t devHandle)
+{
+    (void) devHandle;
+    // No way to get it, so return unknown
+    return (int32_t) U_LOCATION_STATUS_UNKNOWN;
+}
+
+/** The cellular location implementation.
+ */
+static const uLocationBackend_t gCellBackend = {
+    .pGet = cellGet,
+    .pGetStart = cellGetStart,
+    .pGetStatus = uCellLocGetStatus,
+    .pGetStop = uCellLocGetStop
+};
+
+/** The GNSS location implementation.
+ */
+static const uLocationBackend_t gGnssBackend = {
+    .pGet = gnssGet,
+    .pGetStart = gnssGetStart,
+    .pGetStatus = gnssGetStatus,
+    .pGetStop = uGnssPosGetStop
+};
+
+/** Short-range devices don't support location.
+ */
+static const uLocationBackend_t gShortRangeBackend = {0};
+
+// Get the location implementation for a device, filling in the
+// default for the device type if the device doesn't have one yet.
+static const uLocationBackend_t *pBackendGet(uDeviceHandle_t devHandle)
+{
+    const uLocationBackend_t *pBackend = NULL;
+    uDeviceInstance_t *pInstance;
+
+    if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
+        pBackend = pInstance->pLocationBackend;
+        if (pBackend == NULL) {
+            switch (pInstance->deviceType) {
+                case U_DEVICE_TYPE_CELL:
+                    pBackend = &gCellBackend;
+                    break;
+                case U_DEVICE_TYPE_GNSS:
+                    pBackend = &gGnssBackend;
+                    break;
+                case U_DEVICE_TYPE_SHORT_RANGE:
+                    pBackend = &gShortRangeBackend;
+                    break;
+                default:
+                    break;
+            }
+            pInstance->pLocationBackend = pBackend;
+        }
+    }
+
+    return pBackend;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -197,88 +426,22 @@ int32_t uLocationGet(uDeviceHandle_t devHandle, uLocationType_t type,
                      bool (*pKeepGoingCallback) (uDeviceHandle_t))
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    uLocation_t location;
-    uDeviceHandle_t gnssDeviceHandle;
+    const uLocationBackend_t *pBackend;
 
     if (gULocationMutex != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
 
         U_PORT_MUTEX_LOCK(gULocationMutex);
 
-        int32_t devType = uDeviceGetDeviceType(devHandle);
-        if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        pBackend = pBackendGet(devHandle);
+        if (pBackend != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-        } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-            location.type = type;
-            if (location.type == U_LOCATION_TYPE_CLOUD_CELL_LOCATE) {
-                errorCode = cellLocConfigure(devHandle,
-                                             pLocationAssist,
-                                             pAuthenticationTokenStr);
-                if (errorCode == 0) {
-                    errorCode = uCellLocGet(devHandle,
-                                            &(location.latitudeX1e7),
-                                            &(location.longitudeX1e7),
-                                            &(location.altitudeMillimetres),
-                                            &(location.radiusMillimetres),
-                                            &(location.speedMillimetresPerSecond),
-                                            &(location.svs),
-                                            &(location.timeUtc),
-                                            pKeepGoingCallback);
-                    if (pLocation != NULL) {
-                        *pLocation = location;
-                    }
-                }
-            } else if (location.type == U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE) {
-                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-                // For Cloud Locate the GNSS network handle is attached to
-                // the network data associated with the device handle (and
-                // the MQTT client handle is passed in via pLocationAssist)
-                gnssDeviceHandle = uNetworkGetDeviceHandle(devHandle, U_NETWORK_TYPE_GNSS);
-                if ((pLocationAssist != NULL) && (gnssDeviceHandle != NULL)) {
-                    errorCode = uLocationPrivateCloudLocate(devHandle, gnssDeviceHandle,
-                                                            (uMqttClientContext_t *) pLocationAssist->pMqttClientContext,
-                                                            pLocationAssist->svsThreshold,
-                                                            pLocationAssist->cNoThreshold,
-                                                            pLocationAssist->multipathIndexLimit,
-                                                            pLocationAssist->pseudorangeRmsErrorIndexLimit,
-                                                            pLocationAssist->pClientIdStr,
-                                                            &location, pKeepGoingCallback);
-                    if (pLocation != NULL) {
-                        *pLocation = location;
-                    }
-                }
-            } else if (location.type == U_LOCATION_TYPE_GNSS) {
-                // A GNSS device inside or connected-via a cellular device
-                errorCode = uGnssPosGet(devHandle,
-                                        &(location.latitudeX1e7),
-                                        &(location.longitudeX1e7),
-                                        &(location.altitudeMillimetres),
-                                        &(location.radiusMillimetres),
-                                        &(location.speedMillimetresPerSecond),
-                                        &(location.svs),
-                                        &(location.timeUtc),
-                                        pKeepGoingCallback);
-                if (pLocation != NULL) {
-                    pLocation->type = U_LOCATION_TYPE_GNSS;
-                    *pLocation = location;
-                }
-            }
-        } else if (devType == (int32_t) U_DEVICE_TYPE_GNSS) {
-            // type, pLocationAssist and pAuthenticationTokenStr are
-            // irrelevant in this case, we just ask GNSS
-            errorCode = uGnssPosGet(devHandle,
-                                    &(location.latitudeX1e7),
-                                    &(location.longitudeX1e7),
-                                    &(location.altitudeMillimetres),
-                                    &(location.radiusMillimetres),
-                                    &(location.speedMillimetresPerSecond),
-                                    &(location.svs),
-                                    &(location.timeUtc),
-                                    pKeepGoingCallback);
-            if (pLocation != NULL) {
-                pLocation->type = U_LOCATION_TYPE_GNSS;
-                *pLocation = location;
+            if (pBackend->pGet != NULL) {
+                errorCode = pBackend->pGet(devHandle, type,
+                                           pLocationAssist,
+                                           pAuthenticationTokenStr,
+                                           pLocation,
+                                           pKeepGoingCallback);
             }
         }
 
@@ -297,48 +460,21 @@ int32_t uLocationGetStart(uDeviceHandle_t devHandle, uLocationType_t type,
                                              const uLocation_t *pLocation))
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uLocationBackend_t *pBackend;
 
     if (gULocationMutex != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
 
         U_PORT_MUTEX_LOCK(gULocationMutex);
 
-        int32_t devType = uDeviceGetDeviceType(devHandle);
-        if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        pBackend = pBackendGet(devHandle);
+        if (pBackend != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-        } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-            if (type == U_LOCATION_TYPE_CLOUD_CELL_LOCATE) {
-                errorCode = cellLocConfigure(devHandle,
-                                             pLocationAssist,
-                                             pAuthenticationTokenStr);
-                if (errorCode == 0) {
-                    errorCode = uLocationSharedRequestPush(devHandle,
-                                                           type,
-                                                           pCallback);
-                    if (errorCode == 0) {
-                        errorCode = uCellLocGetStart(devHandle, cellLocCallback);
-                        if (errorCode != 0) {
-                            free(pULocationSharedRequestPop(U_LOCATION_TYPE_CLOUD_CELL_LOCATE));
-                        }
-                    }
-                }
-            } else if (type == U_LOCATION_TYPE_CLOUD_CLOUD_LOCATE) {
-                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-
-                // TODO
-
-            }
-        } else if (devType == (int32_t) U_DEVICE_TYPE_GNSS) {
-            // type, pLocationAssist and pAuthenticationTokenStr are
-            // irrelevant in this case, we just ask GNSS
-            errorCode = uLocationSharedRequestPush(devHandle,
-                                                   U_LOCATION_TYPE_GNSS,
-                                                   pCallback);
-            if (errorCode == 0) {
-                errorCode = uGnssPosGetStart(devHandle, gnssPosCallback);
-                if (errorCode != 0) {
-                    free(pULocationSharedRequestPop(U_LOCATION_TYPE_GNSS));
-                }
+            if (pBackend->pGetStart != NULL) {
+                errorCode = pBackend->pGetStart(devHandle, type,
+                                                pLocationAssist,
+                                                pAuthenticationTokenStr,
+                                                pCallback);
             }
         }
 
@@ -352,20 +488,19 @@ int32_t uLocationGetStart(uDeviceHandle_t devHandle, uLocationType_t type,
 int32_t uLocationGetStatus(uDeviceHandle_t devHandle)
 {
     int32_t errorCodeOrStatus = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uLocationBackend_t *pBackend;
 
     if (gULocationMutex != NULL) {
         errorCodeOrStatus = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
 
         U_PORT_MUTEX_LOCK(gULocationMutex);
 
-        int32_t devType = uDeviceGetDeviceType(devHandle);
-        if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-            // Leave as not supported
-        } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-            errorCodeOrStatus = uCellLocGetStatus(devHandle);
-        } else if (devType == (int32_t) U_DEVICE_TYPE_GNSS) {
-            // No way to get it, so return unknown
-            errorCodeOrStatus = (int32_t) U_LOCATION_STATUS_UNKNOWN;
+        pBackend = pBackendGet(devHandle);
+        if (pBackend != NULL) {
+            errorCodeOrStatus = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (pBackend->pGetStatus != NULL) {
+                errorCodeOrStatus = pBackend->pGetStatus(devHandle);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
@@ -377,17 +512,15 @@ int32_t uLocationGetStatus(uDeviceHandle_t devHandle)
 // Cancel a uLocationGetStart().
 void uLocationGetStop(uDeviceHandle_t devHandle)
 {
+    const uLocationBackend_t *pBackend;
+
     if (gULocationMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gULocationMutex);
 
-        int32_t devType = uDeviceGetDeviceType(devHandle);
-        if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-            // Irrelevant
-        } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-            uCellLocGetStop(devHandle);
-        } else if (devType == (int32_t) U_DEVICE_TYPE_GNSS) {
-            uGnssPosGetStop(devHandle);
+        pBackend = pBackendGet(devHandle);
+        if ((pBackend != NULL) && (pBackend->pGetStop != NULL)) {
+            pBackend->pGetStop(devHandle);
         }
 
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
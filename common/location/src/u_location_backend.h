@@ -0,0 +1,82 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_LOCATION_BACKEND_H_
+#define _U_LOCATION_BACKEND_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_location.h"
+
+/** @file
+ * @brief This header file defines the table of functions through
+ * which the common location API calls an underlying location
+ * implementation.  It does not form part of the location API.
+ *
+ * A table is hung off the device instance (see pLocationBackend in
+ * u_device_shared.h); if that is left as NULL the location API
+ * fills in the default for the device type, i.e. cellular, GNSS or
+ * short-range, on first use.  A new location implementation may be
+ * plugged in by pointing pLocationBackend at its own table.
+ *
+ * Each function is called with the location API mutex locked; the
+ * meanings of the parameters and return values are as for the
+ * equivalent uLocationXxx() function in u_location.h.  Any function
+ * that is not supported may be NULL, in which case the location
+ * API returns #U_ERROR_COMMON_NOT_SUPPORTED (or does nothing).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The functions of an underlying location implementation.
+ */
+typedef struct uLocationBackend_t {
+    int32_t (*pGet) (uDeviceHandle_t devHandle, uLocationType_t type,
+                     const uLocationAssist_t *pLocationAssist,
+                     const char *pAuthenticationTokenStr,
+                     uLocation_t *pLocation,
+                     bool (*pKeepGoingCallback) (uDeviceHandle_t));
+    int32_t (*pGetStart) (uDeviceHandle_t devHandle, uLocationType_t type,
+                          const uLocationAssist_t *pLocationAssist,
+                          const char *pAuthenticationTokenStr,
+                          void (*pCallback) (uDeviceHandle_t devHandle,
+                                             int32_t errorCode,
+                                             const uLocation_t *pLocation));
+    int32_t (*pGetStatus) (uDeviceHandle_t devHandle);
+    void (*pGetStop) (uDeviceHandle_t devHandle);
+} uLocationBackend_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_LOCATION_BACKEND_H_
+
+// End of file
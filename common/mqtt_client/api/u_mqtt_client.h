@@ -195,6 +195,7 @@ typedef struct {
     uSecurityTlsContext_t *pSecurityContext;
     int32_t totalMessagesSent;      /* Total messages sent from MQTT client */
     int32_t totalMessagesReceived;  /* Total messages received by MQTT client */
+    void *pSnTopicRegistry; /* The MQTT-SN topic registry, see uMqttClientSnTopicAdd() */
 } uMqttClientContext_t;
 
 /* ----------------------------------------------------------------
@@ -557,6 +558,121 @@ int32_t uMqttClientSnRegisterNormalTopic(const uMqttClientContext_t *pContext,
                                          const char *pTopicNameStr,
                                          uMqttSnTopicName_t *pTopicName);
 
+/** MQTT-SN only: add a topic to the MQTT-SN topic registry of this
+ * MQTT client.  The registry maps MQTT topic name strings to MQTT-SN
+ * topic names so that the application doesn't have to: once a topic
+ * is in the registry uMqttClientSnPublishTopicName() may be used to
+ * publish to it by topic name string.  Topics that are not added
+ * with this function are added to the registry automatically when
+ * they are first published to by name, so this function is only
+ * needed to give a predefined MQTT-SN topic ID a name, or to put
+ * back a mapping that was previously persisted by the callback set
+ * with uMqttClientSnSetTopicStoreCallback().
+ * Normal MQTT topics in the registry are registered with the broker
+ * once per MQTT-SN session: lazily, on first publish, and all
+ * together each time uMqttClientConnect() succeeds, since the broker
+ * will have forgotten them; predefined topic IDs and short topic
+ * names never need registering.  The registry is emptied when
+ * uMqttClientClose() is called.
+ *
+ * @param[in] pContext      a pointer to the internal MQTT context
+ *                          structure that was originally returned
+ *                          by pUMqttClientOpen().
+ * @param[in] pTopicNameStr the null-terminated topic name string;
+ *                          cannot be NULL.
+ * @param[in] pTopicName    the MQTT-SN topic name that pTopicNameStr
+ *                          maps to, for instance as populated by
+ *                          uMqttClientSnSetTopicIdPredefined(); use
+ *                          NULL for a normal MQTT topic, which will
+ *                          be registered with the broker when
+ *                          required.  If the topic is already in
+ *                          the registry its mapping is replaced.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uMqttClientSnTopicAdd(uMqttClientContext_t *pContext,
+                              const char *pTopicNameStr,
+                              const uMqttSnTopicName_t *pTopicName);
+
+/** MQTT-SN only: get the MQTT-SN topic name for a topic name string
+ * from the MQTT-SN topic registry of this MQTT client (see
+ * uMqttClientSnTopicAdd()), adding it to the registry and
+ * registering it with the broker if that has not yet been done
+ * in this MQTT-SN session.  A two-character topic name string
+ * is treated as an MQTT-SN short topic name.
+ * Must be connected to an MQTT-SN broker for this to work if the
+ * topic has to be registered.
+ *
+ * @param[in] pContext      a pointer to the internal MQTT context
+ *                          structure that was originally returned
+ *                          by pUMqttClientOpen().
+ * @param[in] pTopicNameStr the null-terminated topic name string;
+ *                          cannot be NULL.
+ * @param[out] pTopicName   a place to put the MQTT-SN topic name;
+ *                          cannot be NULL.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uMqttClientSnTopicGet(uMqttClientContext_t *pContext,
+                              const char *pTopicNameStr,
+                              uMqttSnTopicName_t *pTopicName);
+
+/** MQTT-SN only: set a callback that will be called whenever
+ * the MQTT-SN topic registry of this MQTT client (see
+ * uMqttClientSnTopicAdd()) gains a mapping or a mapping changes,
+ * e.g. because a normal MQTT topic has been registered with the
+ * broker, allowing the application to persist the mappings in
+ * whatever storage it has and put them back with
+ * uMqttClientSnTopicAdd() after a restart.  The callback is called
+ * with the mutex of the MQTT client locked and so must not call
+ * back into this API.
+ *
+ * @param[in] pContext       a pointer to the internal MQTT context
+ *                           structure that was originally returned
+ *                           by pUMqttClientOpen().
+ * @param[in] pCallback      the callback; the first parameter is
+ *                           the null-terminated topic name string,
+ *                           the second the MQTT-SN topic name it
+ *                           maps to and the third pCallbackParam.
+ *                           Use NULL to remove a previous callback.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   zero on success else negative error code.
+ */
+int32_t uMqttClientSnSetTopicStoreCallback(uMqttClientContext_t *pContext,
+                                           void (*pCallback) (const char *,
+                                                              const uMqttSnTopicName_t *,
+                                                              void *),
+                                           void *pCallbackParam);
+
+/** MQTT-SN only: publish a message to a topic given by name; this
+ * differs from uMqttClientSnPublish() in that the MQTT-SN topic name
+ * is obtained from the MQTT-SN topic registry of this MQTT client
+ * (see uMqttClientSnTopicGet()), so that a normal MQTT topic is
+ * registered with the broker only the first time it is published to
+ * in an MQTT-SN session and, thereafter, publishing costs no more
+ * than uMqttClientSnPublish().
+ * Must be connected to an MQTT-SN broker for this to work.
+ *
+ * @param[in] pContext           a pointer to the internal MQTT context
+ *                               structure that was originally returned
+ *                               by pUMqttClientOpen().
+ * @param[in] pTopicNameStr      the null-terminated topic name string;
+ *                               cannot be NULL.
+ * @param[in] pMessage           a pointer to the message; the message
+ *                               is not restricted to ASCII values.
+ *                               Cannot be NULL.
+ * @param messageSizeBytes       the length of pMessage.
+ * @param qos                    the MQTT QoS to use for this message.
+ * @param retain                 if true the message will be kept
+ *                               by the broker across MQTT disconnects/
+ *                               connects, else it will be cleared.
+ * @return                       zero on success else negative error code.
+ */
+int32_t uMqttClientSnPublishTopicName(uMqttClientContext_t *pContext,
+                                      const char *pTopicNameStr,
+                                      const char *pMessage,
+                                      size_t messageSizeBytes,
+                                      uMqttQos_t qos, bool retain);
+
 /** MQTT-SN only: publish a message; this differs from uMqttClientPublish()
  * in that it uses an MQTT-SN topic name, either created with
  * uMqttClientSnSetTopicIdPredefined()/ uMqttClientSnSetTopicNameShort()
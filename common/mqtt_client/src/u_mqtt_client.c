@@ -48,7 +48,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen(), strncpy()
+#include "string.h"    // strlen(), strncpy(), strcmp(), memcpy()
 
 #include "u_error_common.h"
 
@@ -58,6 +58,7 @@
 
 #include "u_mqtt_common.h"
 #include "u_mqtt_client.h"
+#include "u_mqtt_client_backend.h"
 
 #include "u_cell_sec_tls.h"
 #include "u_cell_mqtt.h"
@@ -71,6 +72,26 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** An entry in the MQTT-SN topic registry.
+ */
+typedef struct uMqttClientSnTopic_t {
+    const char *pTopicNameStr; /**< stored in the same allocation as
+                                    this structure. */
+    uMqttSnTopicName_t topicName;
+    bool registered; /**< false for a normal MQTT topic that has not
+                          yet been registered in this MQTT-SN session. */
+    struct uMqttClientSnTopic_t *pNext;
+} uMqttClientSnTopic_t;
+
+/** The MQTT-SN topic registry of an MQTT client, hung off
+ * pSnTopicRegistry in the MQTT context.
+ */
+typedef struct {
+    uMqttClientSnTopic_t *pList;
+    void (*pStoreCallback) (const char *, const uMqttSnTopicName_t *, void *);
+    void *pStoreCallbackParam;
+} uMqttClientSnTopicRegistry_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -80,7 +101,7 @@
 static uErrorCode_t gLastOpenError = U_ERROR_COMMON_SUCCESS;
 
 /* ----------------------------------------------------------------
- * STATIC FUNCTIONS
+ * STATIC FUNCTIONS: CELLULAR
  * -------------------------------------------------------------- */
 
 /** Start an MQTT connection using cellular.
@@ -147,6 +168,475 @@ int32_t cellConnect(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Check that MQTT is supported by the given module.
+// Note that this implies that a module that supports MQTT-SN
+// also supports MQTT, which is currently the case.
+static int32_t cellOpen(uDeviceHandle_t devHandle, void **ppPriv)
+{
+    (void) ppPriv;
+    return uCellMqttIsSupported(devHandle) ? (int32_t) U_ERROR_COMMON_SUCCESS :
+           (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Close an MQTT client using cellular.
+static void cellClose(uMqttClientContext_t *pContext)
+{
+    uCellMqttDeinit(pContext->devHandle);
+}
+
+// Start an MQTT session using cellular.
+static int32_t cellConnectContext(uMqttClientContext_t *pContext,
+                                  const uMqttClientConnection_t *pConnection)
+{
+    int32_t errorCode = cellConnect(pContext->devHandle, pConnection,
+                                    pContext->pSecurityContext);
+
+    // For cellular MQTT connections the pContext->pPriv is not
+    // used, however for MQTT-SN the "will" data may be updated
+    // and so a pointer to the "will" data is hooked into
+    // pContext->pPriv so that it is carred around with the
+    // context and can be updated.
+    pContext->pPriv = (void *) pConnection->pWill;
+
+    return errorCode;
+}
+
+// Stop an MQTT session using cellular.
+static int32_t cellDisconnect(const uMqttClientContext_t *pContext)
+{
+    return uCellMqttDisconnect(pContext->devHandle);
+}
+
+// Determine whether an MQTT session is active using cellular.
+static bool cellIsConnected(const uMqttClientContext_t *pContext)
+{
+    return uCellMqttIsConnected(pContext->devHandle);
+}
+
+// Set a new message callback using cellular.
+static int32_t cellSetMessageCallback(const uMqttClientContext_t *pContext,
+                                      void (*pCallback) (int32_t, void *),
+                                      void *pCallbackParam)
+{
+    return uCellMqttSetMessageCallback(pContext->devHandle,
+                                       pCallback, pCallbackParam);
+}
+
+// Get the number of unread messages using cellular.
+static int32_t cellGetUnread(const uMqttClientContext_t *pContext)
+{
+    return uCellMqttGetUnread(pContext->devHandle);
+}
+
+// Get the last MQTT error code using cellular.
+static int32_t cellGetLastErrorCode(const uMqttClientContext_t *pContext)
+{
+    return uCellMqttGetLastErrorCode(pContext->devHandle);
+}
+
+// Set a disconnect callback using cellular.
+static int32_t cellSetDisconnectCallback(const uMqttClientContext_t *pContext,
+                                         void (*pCallback) (int32_t, void *),
+                                         void *pCallbackParam)
+{
+    return uCellMqttSetDisconnectCallback(pContext->devHandle,
+                                          pCallback, pCallbackParam);
+}
+
+// Publish an MQTT message using cellular.
+static int32_t cellPublish(const uMqttClientContext_t *pContext,
+                           const char *pTopicNameStr,
+                           const char *pMessage,
+                           size_t messageSizeBytes,
+                           uMqttQos_t qos, bool retain)
+{
+    return uCellMqttPublish(pContext->devHandle, pTopicNameStr,
+                            pMessage, messageSizeBytes,
+                            (uCellMqttQos_t) qos, retain);
+}
+
+// Subscribe to an MQTT topic using cellular.
+static int32_t cellSubscribe(const uMqttClientContext_t *pContext,
+                             const char *pTopicFilterStr,
+                             uMqttQos_t maxQos)
+{
+    return uCellMqttSubscribe(pContext->devHandle, pTopicFilterStr,
+                              (uCellMqttQos_t) maxQos);
+}
+
+// Unsubscribe from an MQTT topic using cellular.
+static int32_t cellUnsubscribe(const uMqttClientContext_t *pContext,
+                               const char *pTopicFilterStr)
+{
+    return uCellMqttUnsubscribe(pContext->devHandle, pTopicFilterStr);
+}
+
+// Read an MQTT message using cellular.
+static int32_t cellMessageRead(const uMqttClientContext_t *pContext,
+                               char *pTopicNameStr,
+                               size_t topicNameSizeBytes,
+                               char *pMessage,
+                               size_t *pMessageSizeBytes,
+                               uMqttQos_t *pQos)
+{
+    return uCellMqttMessageRead(pContext->devHandle,
+                                pTopicNameStr, topicNameSizeBytes,
+                                pMessage, pMessageSizeBytes,
+                                (uCellMqttQos_t *) pQos);
+}
+
+// Determine if MQTT-SN is supported using cellular.
+static bool cellSnIsSupported(const uMqttClientContext_t *pContext)
+{
+    return uCellMqttSnIsSupported(pContext->devHandle);
+}
+
+// Register an MQTT-SN topic name using cellular.
+static int32_t cellSnRegisterNormalTopic(const uMqttClientContext_t *pContext,
+                                         const char *pTopicNameStr,
+                                         uMqttSnTopicName_t *pTopicName)
+{
+    return uCellMqttSnRegisterNormalTopic(pContext->devHandle,
+                                          pTopicNameStr,
+                                          //lint -e(740) Suppress unusual pointer cast
+                                          (uCellMqttSnTopicName_t *) pTopicName);
+}
+
+// Publish an MQTT-SN message using cellular.
+static int32_t cellSnPublish(const uMqttClientContext_t *pContext,
+                             const uMqttSnTopicName_t *pTopicName,
+                             const char *pMessage,
+                             size_t messageSizeBytes,
+                             uMqttQos_t qos, bool retain)
+{
+    return uCellMqttSnPublish(pContext->devHandle,
+                              //lint -e(740) Suppress unusual pointer cast
+                              (const uCellMqttSnTopicName_t *) pTopicName,
+                              pMessage, messageSizeBytes,
+                              (uCellMqttQos_t) qos, retain);
+}
+
+// Subscribe to an MQTT-SN topic using cellular.
+static int32_t cellSnSubscribe(const uMqttClientContext_t *pContext,
+                               const uMqttSnTopicName_t *pTopicName,
+                               uMqttQos_t maxQos)
+{
+    return uCellMqttSnSubscribe(pContext->devHandle,
+                                //lint -e(740) Suppress unusual pointer cast
+                                (const uCellMqttSnTopicName_t *) pTopicName,
+                                (uCellMqttQos_t) maxQos);
+}
+
+// Subscribe to a normal MQTT topic with MQTT-SN using cellular.
+static int32_t cellSnSubscribeNormalTopic(const uMqttClientContext_t *pContext,
+                                          const char *pTopicFilterStr,
+                                          uMqttQos_t maxQos,
+                                          uMqttSnTopicName_t *pTopicName)
+{
+    return uCellMqttSnSubscribeNormalTopic(pContext->devHandle,
+                                           pTopicFilterStr,
+                                           (uCellMqttQos_t) maxQos,
+                                           //lint -e(740) Suppress unusual pointer cast
+                                           (uCellMqttSnTopicName_t *) pTopicName);
+}
+
+// Unsubscribe from an MQTT-SN topic using cellular.
+static int32_t cellSnUnsubscribe(const uMqttClientContext_t *pContext,
+                                 const uMqttSnTopicName_t *pTopicName)
+{
+    return uCellMqttSnUnsubscribe(pContext->devHandle,
+                                  //lint -e(740) Suppress unusual pointer cast
+                                  (const uCellMqttSnTopicName_t *) pTopicName);
+}
+
+// Unsubscribe from a normal MQTT topic with MQTT-SN using cellular.
+static int32_t cellSnUnsubscribeNormalTopic(const uMqttClientContext_t *pContext,
+                                            const char *pTopicFilterStr)
+{
+    return uCellMqttSnUnsubscribeNormalTopic(pContext->devHandle,
+                                             pTopicFilterStr);
+}
+
+// Read an MQTT-SN message using cellular.
+static int32_t cellSnMessageRead(const uMqttClientContext_t *pContext,
+                                 uMqttSnTopicName_t *pTopicName,
+                                 char *pMessage,
+                                 size_t *pMessageSizeBytes,
+                                 uMqttQos_t *pQos)
+{
+    return uCellMqttSnMessageRead(pContext->devHandle,
+                                  //lint -e(740) Suppress unusual pointer cast
+                                  (uCellMqttSnTopicName_t *) pTopicName,
+                                  pMessage, pMessageSizeBytes,
+                                  (uCellMqttQos_t *) pQos);
+}
+
+// Update the MQTT-SN "will" message using cellular.
+static int32_t cellSnWillMessageUpdate(const uMqttClientContext_t *pContext,
+                                       const uMqttWill_t *pWill)
+{
+    return uCellMqttSnSetWillMessaage(pContext->devHandle,
+                                      pWill->pMessage,
+                                      pWill->messageSizeBytes);
+}
+
+// Update the MQTT-SN "will" parameters using cellular.
+static int32_t cellSnWillParametersUpdate(const uMqttClientContext_t *pContext,
+                                          const uMqttWill_t *pWill)
+{
+    return uCellMqttSnSetWillParameters(pContext->devHandle,
+                                        pWill->pTopicNameStr,
+                                        (uCellMqttQos_t) pWill->qos,
+                                        pWill->retain);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: WIFI
+ * -------------------------------------------------------------- */
+
+// Start an MQTT session using Wi-Fi.
+static int32_t wifiConnect(uMqttClientContext_t *pContext,
+                           const uMqttClientConnection_t *pConnection)
+{
+    return uWifiMqttConnect(pContext, pConnection);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: BACKENDS
+ * -------------------------------------------------------------- */
+
+/** The cellular MQTT implementation.
+ */
+static const uMqttClientBackend_t gCellBackend = {
+    .pOpen = cellOpen,
+    .pClose = cellClose,
+    .pConnect = cellConnectContext,
+    .pDisconnect = cellDisconnect,
+    .pIsConnected = cellIsConnected,
+    .pSetMessageCallback = cellSetMessageCallback,
+    .pGetUnread = cellGetUnread,
+    .pGetLastErrorCode = cellGetLastErrorCode,
+    .pSetDisconnectCallback = cellSetDisconnectCallback,
+    .pPublish = cellPublish,
+    .pSubscribe = cellSubscribe,
+    .pUnsubscribe = cellUnsubscribe,
+    .pMessageRead = cellMessageRead,
+    .pSnIsSupported = cellSnIsSupported,
+    .pSnRegisterNormalTopic = cellSnRegisterNormalTopic,
+    .pSnPublish = cellSnPublish,
+    .pSnSubscribe = cellSnSubscribe,
+    .pSnSubscribeNormalTopic = cellSnSubscribeNormalTopic,
+    .pSnUnsubscribe = cellSnUnsubscribe,
+    .pSnUnsubscribeNormalTopic = cellSnUnsubscribeNormalTopic,
+    .pSnMessageRead = cellSnMessageRead,
+    .pSnWillMessageUpdate = cellSnWillMessageUpdate,
+    .pSnWillParametersUpdate = cellSnWillParametersUpdate
+};
+
+/** The Wi-Fi MQTT implementation; MQTT-SN is not supported.
+ */
+static const uMqttClientBackend_t gWifiBackend = {
+    .pOpen = uWifiMqttInit,
+    .pClose = uWifiMqttClose,
+    .pConnect = wifiConnect,
+    .pDisconnect = uWifiMqttDisconnect,
+    .pIsConnected = uWifiMqttIsConnected,
+    .pSetMessageCallback = uWifiMqttSetMessageCallback,
+    .pGetUnread = uWifiMqttGetUnread,
+    .pGetLastErrorCode = NULL,
+    .pSetDisconnectCallback = uWifiMqttSetDisconnectCallback,
+    .pPublish = uWifiMqttPublish,
+    .pSubscribe = uWifiMqttSubscribe,
+    .pUnsubscribe = uWifiMqttUnsubscribe,
+    .pMessageRead = uWifiMqttMessageRead
+};
+
+// Get the MQTT implementation for a device, filling in the default
+// for the device type if the device doesn't have one yet.
+static const uMqttClientBackend_t *pBackendGet(uDeviceHandle_t devHandle)
+{
+    const uMqttClientBackend_t *pBackend = NULL;
+    uDeviceInstance_t *pInstance;
+
+    if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
+        pBackend = pInstance->pMqttClientBackend;
+        if (pBackend == NULL) {
+            if (pInstance->deviceType == U_DEVICE_TYPE_CELL) {
+                pBackend = &gCellBackend;
+            } else if (pInstance->deviceType == U_DEVICE_TYPE_SHORT_RANGE) {
+                pBackend = &gWifiBackend;
+            }
+            pInstance->pMqttClientBackend = pBackend;
+        }
+    }
+
+    return pBackend;
+}
+
+// Get the MQTT implementation for an open context.
+static inline const uMqttClientBackend_t *pContextBackend(const uMqttClientContext_t *pContext)
+{
+    return U_DEVICE_INSTANCE(pContext->devHandle)->pMqttClientBackend;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MQTT-SN TOPIC REGISTRY
+ * -------------------------------------------------------------- */
+
+// Get the MQTT-SN topic registry of a context, optionally creating it.
+// The mutex for this session must be locked before this is called.
+static uMqttClientSnTopicRegistry_t *pSnTopicRegistryGet(uMqttClientContext_t *pContext,
+                                                         bool create)
+{
+    uMqttClientSnTopicRegistry_t *pRegistry;
+
+    pRegistry = (uMqttClientSnTopicRegistry_t *) pContext->pSnTopicRegistry;
+
+    if ((pRegistry == NULL) && create) {
+        pRegistry = (uMqttClientSnTopicRegistry_t *) malloc(sizeof(*pRegistry));
+        if (pRegistry != NULL) {
+            memset(pRegistry, 0, sizeof(*pRegistry));
+            pContext->pSnTopicRegistry = pRegistry;
+        }
+    }
+
+    return pRegistry;
+}
+
+// Find a topic in the MQTT-SN topic registry, adding it if it is not
+// there; a newly added topic is a normal MQTT topic that needs
+// registering unless it is a two-character short topic name.
+// The mutex for this session must be locked before this is called.
+static uMqttClientSnTopic_t *pSnTopicFindOrAdd(uMqttClientSnTopicRegistry_t *pRegistry,
+                                               const char *pTopicNameStr)
+{
+    uMqttClientSnTopic_t *pTopic = pRegistry->pList;
+    size_t length = strlen(pTopicNameStr);
+
+    while ((pTopic != NULL) && (strcmp(pTopic->pTopicNameStr, pTopicNameStr) != 0)) {
+        pTopic = pTopic->pNext;
+    }
+
+    if (pTopic == NULL) {
+        // Allocate the entry and the string storage in one
+        pTopic = (uMqttClientSnTopic_t *) malloc(sizeof(*pTopic) + length + 1);
+        if (pTopic != NULL) {
+            memcpy((char *) (pTopic + 1), pTopicNameStr, length + 1);
+            pTopic->pTopicNameStr = (const char *) (pTopic + 1);
+            memset(&(pTopic->topicName), 0, sizeof(pTopic->topicName));
+            pTopic->topicName.type = U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL;
+            pTopic->registered = false;
+            if (uMqttClientSnSetTopicNameShort(pTopicNameStr, &(pTopic->topicName)) == 0) {
+                pTopic->registered = true;
+            }
+            pTopic->pNext = pRegistry->pList;
+            pRegistry->pList = pTopic;
+        }
+    }
+
+    return pTopic;
+}
+
+// Register a topic from the MQTT-SN topic registry with the broker,
+// if that has not already been done in this MQTT-SN session.
+// The mutex for this session must be locked before this is called.
+static int32_t snTopicRegister(const uMqttClientContext_t *pContext,
+                               const uMqttClientSnTopicRegistry_t *pRegistry,
+                               uMqttClientSnTopic_t *pTopic)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    const uMqttClientBackend_t *pBackend;
+    uMqttSnTopicName_t topicName;
+
+    if (!pTopic->registered) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnRegisterNormalTopic != NULL) {
+            errorCode = pBackend->pSnRegisterNormalTopic(pContext,
+                                                         pTopic->pTopicNameStr,
+                                                         &topicName);
+            if (errorCode == 0) {
+                pTopic->topicName = topicName;
+                pTopic->registered = true;
+                if (pRegistry->pStoreCallback != NULL) {
+                    pRegistry->pStoreCallback(pTopic->pTopicNameStr,
+                                              &(pTopic->topicName),
+                                              pRegistry->pStoreCallbackParam);
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the MQTT-SN topic name for a topic name string, registering
+// it with the broker if required.
+// The mutex for this session must be locked before this is called.
+static int32_t snTopicGet(uMqttClientContext_t *pContext,
+                          const char *pTopicNameStr,
+                          uMqttSnTopicName_t *pTopicName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uMqttClientSnTopicRegistry_t *pRegistry = pSnTopicRegistryGet(pContext, true);
+    uMqttClientSnTopic_t *pTopic = NULL;
+
+    if (pRegistry != NULL) {
+        pTopic = pSnTopicFindOrAdd(pRegistry, pTopicNameStr);
+    }
+    if (pTopic != NULL) {
+        errorCode = snTopicRegister(pContext, pRegistry, pTopic);
+        if (errorCode == 0) {
+            *pTopicName = pTopic->topicName;
+        }
+    }
+
+    return errorCode;
+}
+
+// Forget the MQTT-SN session registrations of the normal MQTT
+// topics in the registry or, if reRegister is true, register
+// them all again with the broker; once a registration fails no
+// more are attempted, the remainder will be tried again when
+// they are next used.
+// The mutex for this session must be locked before this is called.
+static void snTopicRegistryRefresh(uMqttClientContext_t *pContext, bool reRegister)
+{
+    uMqttClientSnTopicRegistry_t *pRegistry = pSnTopicRegistryGet(pContext, false);
+    int32_t errorCode = 0;
+
+    if (pRegistry != NULL) {
+        for (uMqttClientSnTopic_t *pTopic = pRegistry->pList; pTopic != NULL;
+             pTopic = pTopic->pNext) {
+            if (pTopic->topicName.type == U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL) {
+                if (!reRegister) {
+                    pTopic->registered = false;
+                } else if (errorCode == 0) {
+                    errorCode = snTopicRegister(pContext, pRegistry, pTopic);
+                }
+            }
+        }
+    }
+}
+
+// Free the MQTT-SN topic registry of a context.
+// The mutex for this session must be locked before this is called.
+static void snTopicRegistryFree(uMqttClientContext_t *pContext)
+{
+    uMqttClientSnTopicRegistry_t *pRegistry = pSnTopicRegistryGet(pContext, false);
+    uMqttClientSnTopic_t *pTopic;
+
+    if (pRegistry != NULL) {
+        while (pRegistry->pList != NULL) {
+            pTopic = pRegistry->pList->pNext;
+            free(pRegistry->pList);
+            pRegistry->pList = pTopic;
+        }
+        free(pRegistry);
+        pContext->pSnTopicRegistry = NULL;
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MQTT AND MQTT-SN
  * -------------------------------------------------------------- */
@@ -157,19 +647,13 @@ uMqttClientContext_t *pUMqttClientOpen(uDeviceHandle_t devHandle,
 {
     uMqttClientContext_t *pContext = NULL;
     void *pPriv = NULL;
+    const uMqttClientBackend_t *pBackend = pBackendGet(devHandle);
 
     gLastOpenError = U_ERROR_COMMON_NOT_SUPPORTED;
-    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
-        // For cellular, check that MQTT is supported by the
-        // given module at this point.
-        // Note that this implies that a module that supports MQTT-SN
-        // also supports MQTT, which is currently the case.
-        if (uCellMqttIsSupported(devHandle)) {
-            gLastOpenError = U_ERROR_COMMON_SUCCESS;
-        }
-    } else if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-        // For WiFi
-        if (uWifiMqttInit(devHandle, &pPriv) == 0) {
+    if ((pBackend != NULL) && (pBackend->pOpen != NULL)) {
+        // Check that the underlying MQTT implementation
+        // is supported on this device
+        if (pBackend->pOpen(devHandle, &pPriv) == 0) {
             gLastOpenError = U_ERROR_COMMON_SUCCESS;
         }
     } else {
@@ -189,6 +673,7 @@ uMqttClientContext_t *pUMqttClientOpen(uDeviceHandle_t devHandle,
             pContext->pSecurityContext = NULL;
             pContext->totalMessagesSent = 0;
             pContext->totalMessagesReceived = 0;
+            pContext->pSnTopicRegistry = NULL;
             pContext->pPriv = pPriv;
             if (uPortMutexCreate((uPortMutexHandle_t *) & (pContext->mutexHandle)) == 0) {
                 gLastOpenError = U_ERROR_COMMON_SUCCESS;
@@ -238,14 +723,15 @@ int32_t uMqttClientOpenResetLastError()
 // Close an MQTT client.
 void uMqttClientClose(uMqttClientContext_t *pContext)
 {
+    const uMqttClientBackend_t *pBackend;
+
     if (pContext != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            uCellMqttDeinit(pContext->devHandle);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            uWifiMqttClose(pContext);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pClose != NULL) {
+            pBackend->pClose(pContext);
         }
 
         if (pContext->pSecurityContext != NULL) {
@@ -253,6 +739,8 @@ void uMqttClientClose(uMqttClientContext_t *pContext)
             uSecurityTlsRemove(pContext->pSecurityContext);
         }
 
+        snTopicRegistryFree(pContext);
+
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
         uPortMutexDelete((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -265,25 +753,23 @@ int32_t uMqttClientConnect(uMqttClientContext_t *pContext,
                            const uMqttClientConnection_t *pConnection)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pConnection != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = cellConnect(pContext->devHandle,
-                                    pConnection,
-                                    pContext->pSecurityContext);
-            // For cellular MQTT connections the pContext->pPriv is not
-            // used, however for MQTT-SN the "will" data may be updated
-            // and so a pointer to the "will" data is hooked into
-            // pContext->pPriv so that it is carred around with the
-            // context and can be updated.
-            pContext->pPriv = (void *) pConnection->pWill;
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-
-            errorCode = uWifiMqttConnect(pContext, pConnection);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pConnect != NULL) {
+            // This is a new MQTT-SN session as far as the broker
+            // is concerned: any registered topic IDs are gone
+            snTopicRegistryRefresh(pContext, false);
+            errorCode = pBackend->pConnect(pContext, pConnection);
+            if ((errorCode == 0) && pConnection->mqttSn) {
+                // Register all of the known topics in one go
+                snTopicRegistryRefresh(pContext, true);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -296,16 +782,16 @@ int32_t uMqttClientConnect(uMqttClientContext_t *pContext,
 int32_t uMqttClientDisconnect(const uMqttClientContext_t *pContext)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttDisconnect(pContext->devHandle);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttDisconnect(pContext);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pDisconnect != NULL) {
+            errorCode = pBackend->pDisconnect(pContext);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -318,15 +804,15 @@ int32_t uMqttClientDisconnect(const uMqttClientContext_t *pContext)
 bool uMqttClientIsConnected(const uMqttClientContext_t *pContext)
 {
     bool isConnected = false;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            isConnected = uCellMqttIsConnected(pContext->devHandle);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            isConnected = uWifiMqttIsConnected(pContext);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pIsConnected != NULL) {
+            isConnected = pBackend->pIsConnected(pContext);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -341,20 +827,18 @@ int32_t uMqttClientSetMessageCallback(const uMqttClientContext_t *pContext,
                                       void *pCallbackParam)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSetMessageCallback(pContext->devHandle,
-                                                    pCallback,
-                                                    pCallbackParam);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttSetMessageCallback(pContext,
-                                                    pCallback,
-                                                    pCallbackParam);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSetMessageCallback != NULL) {
+            errorCode = pBackend->pSetMessageCallback(pContext,
+                                                      pCallback,
+                                                      pCallbackParam);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -367,16 +851,16 @@ int32_t uMqttClientSetMessageCallback(const uMqttClientContext_t *pContext,
 int32_t uMqttClientGetUnread(const uMqttClientContext_t *pContext)
 {
     int32_t errorCodeOrUnread = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
         errorCodeOrUnread = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCodeOrUnread = uCellMqttGetUnread(pContext->devHandle);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCodeOrUnread = uWifiMqttGetUnread(pContext);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pGetUnread != NULL) {
+            errorCodeOrUnread = pBackend->pGetUnread(pContext);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -389,14 +873,16 @@ int32_t uMqttClientGetUnread(const uMqttClientContext_t *pContext)
 int32_t uMqttClientGetLastErrorCode(const uMqttClientContext_t *pContext)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttGetLastErrorCode(pContext->devHandle);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pGetLastErrorCode != NULL) {
+            errorCode = pBackend->pGetLastErrorCode(pContext);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -435,20 +921,18 @@ int32_t uMqttClientSetDisconnectCallback(const uMqttClientContext_t *pContext,
                                          void *pCallbackParam)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSetDisconnectCallback(pContext->devHandle,
-                                                       pCallback,
-                                                       pCallbackParam);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttSetDisconnectCallback(pContext,
-                                                       pCallback,
-                                                       pCallbackParam);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSetDisconnectCallback != NULL) {
+            errorCode = pBackend->pSetDisconnectCallback(pContext,
+                                                         pCallback,
+                                                         pCallbackParam);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -469,6 +953,7 @@ int32_t uMqttClientPublish(uMqttClientContext_t *pContext,
                            uMqttQos_t qos, bool retain)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicNameStr != NULL) &&
         (pMessage != NULL) && (messageSizeBytes > 0)) {
@@ -476,16 +961,11 @@ int32_t uMqttClientPublish(uMqttClientContext_t *pContext,
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttPublish(pContext->devHandle,
-                                         pTopicNameStr,
-                                         pMessage, messageSizeBytes,
-                                         (uCellMqttQos_t) qos, retain);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttPublish(pContext,
-                                         pTopicNameStr,
-                                         pMessage, messageSizeBytes,
-                                         (uMqttQos_t)qos, retain);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pPublish != NULL) {
+            errorCode = pBackend->pPublish(pContext, pTopicNameStr,
+                                           pMessage, messageSizeBytes,
+                                           qos, retain);
         }
         if (errorCode == 0) {
             pContext->totalMessagesSent++;
@@ -503,20 +983,16 @@ int32_t uMqttClientSubscribe(const uMqttClientContext_t *pContext,
                              uMqttQos_t maxQos)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicFilterStr != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSubscribe(pContext->devHandle,
-                                           pTopicFilterStr,
-                                           (uCellMqttQos_t) maxQos);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttSubscribe(pContext,
-                                           pTopicFilterStr,
-                                           (uMqttQos_t)maxQos);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSubscribe != NULL) {
+            errorCode = pBackend->pSubscribe(pContext, pTopicFilterStr, maxQos);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -530,17 +1006,16 @@ int32_t uMqttClientUnsubscribe(const uMqttClientContext_t *pContext,
                                const char *pTopicFilterStr)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicFilterStr != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttUnsubscribe(pContext->devHandle,
-                                             pTopicFilterStr);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttUnsubscribe(pContext, pTopicFilterStr);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pUnsubscribe != NULL) {
+            errorCode = pBackend->pUnsubscribe(pContext, pTopicFilterStr);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -558,6 +1033,7 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
                                uMqttQos_t *pQos)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicNameStr != NULL) &&
         (topicNameSizeBytes > 0) &&
@@ -566,20 +1042,14 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttMessageRead(pContext->devHandle,
-                                             pTopicNameStr,
-                                             topicNameSizeBytes,
-                                             pMessage,
-                                             pMessageSizeBytes,
-                                             (uCellMqttQos_t *) pQos);
-        } else if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_SHORT_RANGE)) {
-            errorCode = uWifiMqttMessageRead(pContext,
-                                             pTopicNameStr,
-                                             topicNameSizeBytes,
-                                             pMessage,
-                                             pMessageSizeBytes,
-                                             (uMqttQos_t *) pQos);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pMessageRead != NULL) {
+            errorCode = pBackend->pMessageRead(pContext,
+                                               pTopicNameStr,
+                                               topicNameSizeBytes,
+                                               pMessage,
+                                               pMessageSizeBytes,
+                                               pQos);
         }
         if (errorCode == 0) {
             pContext->totalMessagesReceived++;
@@ -599,13 +1069,15 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
 bool uMqttClientSnIsSupported(const uMqttClientContext_t *pContext)
 {
     bool isSupported = false;
+    const uMqttClientBackend_t *pBackend;
 
     if (pContext != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            isSupported = uCellMqttSnIsSupported(pContext->devHandle);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnIsSupported != NULL) {
+            isSupported = pBackend->pSnIsSupported(pContext);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -692,23 +1164,151 @@ int32_t uMqttClientSnGetTopicNameShort(const uMqttSnTopicName_t *pTopicName,
     return errorCodeOrLength;
 }
 
+
 // Ask the MQTT broker for an MQTT-SN topic name for the given normal MQTT topic.
 int32_t uMqttClientSnRegisterNormalTopic(const uMqttClientContext_t *pContext,
                                          const char *pTopicNameStr,
                                          uMqttSnTopicName_t *pTopicName)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicNameStr != NULL) && (pTopicName != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnRegisterNormalTopic(pContext->devHandle,
-                                                       pTopicNameStr,
-                                                       //lint -e(740) Suppress unusual pointer cast
-                                                       (uCellMqttSnTopicName_t *) pTopicName);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnRegisterNormalTopic != NULL) {
+            errorCode = pBackend->pSnRegisterNormalTopic(pContext,
+                                                         pTopicNameStr,
+                                                         pTopicName);
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Add a topic to the MQTT-SN topic registry.
+int32_t uMqttClientSnTopicAdd(uMqttClientContext_t *pContext,
+                              const char *pTopicNameStr,
+                              const uMqttSnTopicName_t *pTopicName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMqttClientSnTopicRegistry_t *pRegistry;
+    uMqttClientSnTopic_t *pTopic = NULL;
+
+    if ((pContext != NULL) && (pTopicNameStr != NULL) &&
+        ((pTopicName == NULL) ||
+         ((pTopicName->type >= U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL) &&
+          (pTopicName->type < U_MQTT_SN_TOPIC_NAME_TYPE_MAX_NUM)))) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        pRegistry = pSnTopicRegistryGet(pContext, true);
+        if (pRegistry != NULL) {
+            pTopic = pSnTopicFindOrAdd(pRegistry, pTopicNameStr);
+        }
+        if (pTopic != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pTopicName != NULL) {
+                pTopic->topicName = *pTopicName;
+                // A normal topic ID is only valid for the MQTT-SN
+                // session it was registered in so, since we can't
+                // know where this one came from, register it again
+                pTopic->registered = (pTopicName->type != U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL);
+                if (pRegistry->pStoreCallback != NULL) {
+                    pRegistry->pStoreCallback(pTopic->pTopicNameStr,
+                                              &(pTopic->topicName),
+                                              pRegistry->pStoreCallbackParam);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Get the MQTT-SN topic name for a topic name string.
+int32_t uMqttClientSnTopicGet(uMqttClientContext_t *pContext,
+                              const char *pTopicNameStr,
+                              uMqttSnTopicName_t *pTopicName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pContext != NULL) && (pTopicNameStr != NULL) && (pTopicName != NULL)) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        errorCode = snTopicGet(pContext, pTopicNameStr, pTopicName);
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Set a callback to persist the MQTT-SN topic registry.
+int32_t uMqttClientSnSetTopicStoreCallback(uMqttClientContext_t *pContext,
+                                           void (*pCallback) (const char *,
+                                                              const uMqttSnTopicName_t *,
+                                                              void *),
+                                           void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMqttClientSnTopicRegistry_t *pRegistry;
+
+    if (pContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        pRegistry = pSnTopicRegistryGet(pContext, true);
+        if (pRegistry != NULL) {
+            pRegistry->pStoreCallback = pCallback;
+            pRegistry->pStoreCallbackParam = pCallbackParam;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Publish a message to a topic given by name.
+int32_t uMqttClientSnPublishTopicName(uMqttClientContext_t *pContext,
+                                      const char *pTopicNameStr,
+                                      const char *pMessage,
+                                      size_t messageSizeBytes,
+                                      uMqttQos_t qos, bool retain)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
+    uMqttSnTopicName_t topicName;
+
+    if ((pContext != NULL) && (pTopicNameStr != NULL) &&
+        (pMessage != NULL) && (messageSizeBytes > 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnPublish != NULL) {
+            errorCode = snTopicGet(pContext, pTopicNameStr, &topicName);
+            if (errorCode == 0) {
+                errorCode = pBackend->pSnPublish(pContext, &topicName,
+                                                 pMessage, messageSizeBytes,
+                                                 qos, retain);
+            }
+        }
+        if (errorCode == 0) {
+            pContext->totalMessagesSent++;
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -725,6 +1325,7 @@ int32_t uMqttClientSnPublish(uMqttClientContext_t *pContext,
                              uMqttQos_t qos, bool retain)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicName != NULL) &&
         (pMessage != NULL) && (messageSizeBytes > 0)) {
@@ -732,12 +1333,11 @@ int32_t uMqttClientSnPublish(uMqttClientContext_t *pContext,
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnPublish(pContext->devHandle,
-                                           //lint -e(740) Suppress unusual pointer cast
-                                           (const uCellMqttSnTopicName_t *) pTopicName,
-                                           pMessage, messageSizeBytes,
-                                           (uCellMqttQos_t) qos, retain);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnPublish != NULL) {
+            errorCode = pBackend->pSnPublish(pContext, pTopicName,
+                                             pMessage, messageSizeBytes,
+                                             qos, retain);
         }
         if (errorCode == 0) {
             pContext->totalMessagesSent++;
@@ -755,17 +1355,16 @@ int32_t uMqttClientSnSubscribe(const uMqttClientContext_t *pContext,
                                uMqttQos_t maxQos)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicName != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnSubscribe(pContext->devHandle,
-                                             //lint -e(740) Suppress unusual pointer cast
-                                             (const uCellMqttSnTopicName_t *) pTopicName,
-                                             (uCellMqttQos_t) maxQos);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnSubscribe != NULL) {
+            errorCode = pBackend->pSnSubscribe(pContext, pTopicName, maxQos);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -781,18 +1380,19 @@ int32_t uMqttClientSnSubscribeNormalTopic(const uMqttClientContext_t *pContext,
                                           uMqttSnTopicName_t *pTopicName)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicFilterStr != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnSubscribeNormalTopic(pContext->devHandle,
-                                                        pTopicFilterStr,
-                                                        (uCellMqttQos_t) maxQos,
-                                                        //lint -e(740) Suppress unusual pointer cast
-                                                        (uCellMqttSnTopicName_t *) pTopicName);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnSubscribeNormalTopic != NULL) {
+            errorCode = pBackend->pSnSubscribeNormalTopic(pContext,
+                                                          pTopicFilterStr,
+                                                          maxQos,
+                                                          pTopicName);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -806,16 +1406,16 @@ int32_t uMqttClientSnUnsubscribe(const uMqttClientContext_t *pContext,
                                  const uMqttSnTopicName_t *pTopicName)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicName != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnUnsubscribe(pContext->devHandle,
-                                               //lint -e(740) Suppress unusual pointer cast
-                                               (const uCellMqttSnTopicName_t *) pTopicName);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnUnsubscribe != NULL) {
+            errorCode = pBackend->pSnUnsubscribe(pContext, pTopicName);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -829,15 +1429,17 @@ int32_t uMqttClientSnUnsubscribeNormalTopic(const uMqttClientContext_t *pContext
                                             const char *pTopicFilterStr)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicFilterStr != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnUnsubscribeNormalTopic(pContext->devHandle,
-                                                          pTopicFilterStr);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnUnsubscribeNormalTopic != NULL) {
+            errorCode = pBackend->pSnUnsubscribeNormalTopic(pContext,
+                                                            pTopicFilterStr);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -854,6 +1456,7 @@ int32_t uMqttClientSnMessageRead(uMqttClientContext_t *pContext,
                                  uMqttQos_t *pQos)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uMqttClientBackend_t *pBackend;
 
     if ((pContext != NULL) && (pTopicName != NULL) &&
         ((pMessageSizeBytes != NULL) || (pMessage == NULL))) {
@@ -861,12 +1464,11 @@ int32_t uMqttClientSnMessageRead(uMqttClientContext_t *pContext,
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnMessageRead(pContext->devHandle,
-                                               //lint -e(740) Suppress unusual pointer cast
-                                               (uCellMqttSnTopicName_t *) pTopicName,
-                                               pMessage, pMessageSizeBytes,
-                                               (uCellMqttQos_t *) pQos);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnMessageRead != NULL) {
+            errorCode = pBackend->pSnMessageRead(pContext, pTopicName,
+                                                 pMessage, pMessageSizeBytes,
+                                                 pQos);
         }
         if (errorCode == 0) {
             pContext->totalMessagesReceived++;
@@ -883,6 +1485,7 @@ int32_t uMqttClientSnWillMessageUpdate(const uMqttClientContext_t *pContext)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     const uMqttWill_t *pWill;
+    const uMqttClientBackend_t *pBackend;
 
     // For cellular MQTT-SN connections the pContext->pPriv is used
     // to carry the "will" data around.
@@ -892,10 +1495,9 @@ int32_t uMqttClientSnWillMessageUpdate(const uMqttClientContext_t *pContext)
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnSetWillMessaage(pContext->devHandle,
-                                                   pWill->pMessage,
-                                                   pWill->messageSizeBytes);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnWillMessageUpdate != NULL) {
+            errorCode = pBackend->pSnWillMessageUpdate(pContext, pWill);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -910,6 +1512,7 @@ int32_t uMqttClientSnWillParametersUpdate(const uMqttClientContext_t *pContext)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     const uMqttWill_t *pWill;
+    const uMqttClientBackend_t *pBackend;
 
     // For cellular MQTT-SN connections the pContext->pPriv is used
     // to carry the "will" data around.
@@ -919,11 +1522,9 @@ int32_t uMqttClientSnWillParametersUpdate(const uMqttClientContext_t *pContext)
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
 
-        if (U_DEVICE_IS_TYPE(pContext->devHandle, U_DEVICE_TYPE_CELL)) {
-            errorCode = uCellMqttSnSetWillParameters(pContext->devHandle,
-                                                     pWill->pTopicNameStr,
-                                                     (uCellMqttQos_t) pWill->qos,
-                                                     pWill->retain);
+        pBackend = pContextBackend(pContext);
+        if (pBackend->pSnWillParametersUpdate != NULL) {
+            errorCode = pBackend->pSnWillParametersUpdate(pContext, pWill);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_MQTT_CLIENT_BACKEND_H_
+#define _U_MQTT_CLIENT_BACKEND_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_mqtt_common.h"
+#include "u_mqtt_client.h"
+
+/** @file
+ * @brief This header file defines the table of functions through
+ * which the common MQTT client calls an underlying MQTT
+ * implementation.  It does not form part of the MQTT client API.
+ *
+ * A table is hung off the device instance (see pMqttClientBackend
+ * in u_device_shared.h); if that is left as NULL the MQTT client
+ * fills in the default for the device type, i.e. cellular or
+ * Wi-Fi, when pUMqttClientOpen() is called.  A new MQTT
+ * implementation may be plugged in by pointing pMqttClientBackend
+ * at its own table before then.
+ *
+ * Each function is called with the mutex of the MQTT context
+ * locked and with its parameters already checked; the meanings
+ * of the parameters and return values are as for the equivalent
+ * uMqttClientXxx() function in u_mqtt_client.h.  Any function that
+ * is not supported may be NULL, in which case the MQTT client
+ * returns #U_ERROR_COMMON_NOT_SUPPORTED (or false).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The functions of an underlying MQTT implementation.
+ */
+typedef struct uMqttClientBackend_t {
+    /** Called by pUMqttClientOpen() before the context is created;
+     * should return zero if MQTT is supported on devHandle and may
+     * populate *ppPriv, which will become pPriv in the context.
+     */
+    int32_t (*pOpen) (uDeviceHandle_t devHandle, void **ppPriv);
+    void (*pClose) (uMqttClientContext_t *pContext);
+    int32_t (*pConnect) (uMqttClientContext_t *pContext,
+                         const uMqttClientConnection_t *pConnection);
+    int32_t (*pDisconnect) (const uMqttClientContext_t *pContext);
+    bool (*pIsConnected) (const uMqttClientContext_t *pContext);
+    int32_t (*pSetMessageCallback) (const uMqttClientContext_t *pContext,
+                                    void (*pCallback) (int32_t, void *),
+                                    void *pCallbackParam);
+    int32_t (*pGetUnread) (const uMqttClientContext_t *pContext);
+    int32_t (*pGetLastErrorCode) (const uMqttClientContext_t *pContext);
+    int32_t (*pSetDisconnectCallback) (const uMqttClientContext_t *pContext,
+                                       void (*pCallback) (int32_t, void *),
+                                       void *pCallbackParam);
+    int32_t (*pPublish) (const uMqttClientContext_t *pContext,
+                         const char *pTopicNameStr,
+                         const char *pMessage,
+                         size_t messageSizeBytes,
+                         uMqttQos_t qos, bool retain);
+    int32_t (*pSubscribe) (const uMqttClientContext_t *pContext,
+                           const char *pTopicFilterStr,
+                           uMqttQos_t maxQos);
+    int32_t (*pUnsubscribe) (const uMqttClientContext_t *pContext,
+                             const char *pTopicFilterStr);
+    int32_t (*pMessageRead) (const uMqttClientContext_t *pContext,
+                             char *pTopicNameStr,
+                             size_t topicNameSizeBytes,
+                             char *pMessage,
+                             size_t *pMessageSizeBytes,
+                             uMqttQos_t *pQos);
+    bool (*pSnIsSupported) (const uMqttClientContext_t *pContext);
+    int32_t (*pSnRegisterNormalTopic) (const uMqttClientContext_t *pContext,
+                                       const char *pTopicNameStr,
+                                       uMqttSnTopicName_t *pTopicName);
+    int32_t (*pSnPublish) (const uMqttClientContext_t *pContext,
+                           const uMqttSnTopicName_t *pTopicName,
+                           const char *pMessage,
+                           size_t messageSizeBytes,
+                           uMqttQos_t qos, bool retain);
+    int32_t (*pSnSubscribe) (const uMqttClientContext_t *pContext,
+                             const uMqttSnTopicName_t *pTopicName,
+                             uMqttQos_t maxQos);
+    int32_t (*pSnSubscribeNormalTopic) (const uMqttClientContext_t *pContext,
+                                        const char *pTopicFilterStr,
+                                        uMqttQos_t maxQos,
+                                        uMqttSnTopicName_t *pTopicName);
+    int32_t (*pSnUnsubscribe) (const uMqttClientContext_t *pContext,
+                               const uMqttSnTopicName_t *pTopicName);
+    int32_t (*pSnUnsubscribeNormalTopic) (const uMqttClientContext_t *pContext,
+                                          const char *pTopicFilterStr);
+    int32_t (*pSnMessageRead) (const uMqttClientContext_t *pContext,
+                               uMqttSnTopicName_t *pTopicName,
+                               char *pMessage,
+                               size_t *pMessageSizeBytes,
+                               uMqttQos_t *pQos);
+    int32_t (*pSnWillMessageUpdate) (const uMqttClientContext_t *pContext,
+                                     const uMqttWill_t *pWill);
+    int32_t (*pSnWillParametersUpdate) (const uMqttClientContext_t *pContext,
+                                        const uMqttWill_t *pWill);
+} uMqttClientBackend_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_MQTT_CLIENT_BACKEND_H_
+
+// End of file
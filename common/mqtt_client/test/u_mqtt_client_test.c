@@ -170,6 +170,10 @@ static bool gDisconnectCallbackCalled;
  */
 static int32_t gNumUnread;
 
+/** The number of times topicStoreCallback() has been called.
+ */
+static int32_t gTopicStoreCallbackCount;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -257,6 +261,25 @@ static void disconnectCallback(int32_t errorCode, void *pParam)
 
     gDisconnectCallbackCalled = true;
 }
+
+// Callback for an MQTT-SN topic registry mapping to be stored.
+static void topicStoreCallback(const char *pTopicNameStr,
+                               const uMqttSnTopicName_t *pTopicName,
+                               void *pParam)
+{
+    (void) pParam;
+
+#if !U_CFG_OS_CLIB_LEAKS
+    // Only print stuff if the C library isn't going to leak
+    U_TEST_PRINT_LINE_MQTTSN("topicStoreCallback() called, \"%s\" is topic ID \"%d\".",
+                             pTopicNameStr, pTopicName->name.id);
+#else
+    (void) pTopicNameStr;
+    (void) pTopicName;
+#endif
+
+    gTopicStoreCallbackCount++;
+}
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -727,9 +750,10 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClientSn")
 
                 U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 0);
 
-                // Do this twice, once with the topic ID returned by uMqttClientSnSubscribe()
-                // above and a second time with one returned by uMqttClientSnRegisterNormalTopic()
-                for (size_t idRun = 0; idRun < 2; idRun++) {
+                // Do this three times, once with the topic ID returned by uMqttClientSnSubscribe()
+                // above, a second time with one returned by uMqttClientSnRegisterNormalTopic()
+                // and a third time by topic name through the MQTT-SN topic registry
+                for (size_t idRun = 0; idRun < 3; idRun++) {
                     U_TEST_PRINT_LINE_MQTTSN("publishing %d byte(s) to topic \"%d\"...",
                                              U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
                                              topicNameOut.name.id);
@@ -748,9 +772,16 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClientSn")
                         y -= z;
                         s += z;
                     }
-                    y = uMqttClientSnPublish(gpMqttContextA, &topicNameOut,
-                                             pMessageOut, U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
-                                             U_MQTT_QOS_EXACTLY_ONCE, false);
+                    if (idRun < 2) {
+                        y = uMqttClientSnPublish(gpMqttContextA, &topicNameOut, pMessageOut,
+                                                 U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                                 U_MQTT_QOS_EXACTLY_ONCE, false);
+                    } else {
+                        y = uMqttClientSnPublishTopicName(gpMqttContextA, pTopicNameOutMqtt,
+                                                          pMessageOut,
+                                                          U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                                          U_MQTT_QOS_EXACTLY_ONCE, false);
+                    }
                     if (y == 0) {
                         U_TEST_PRINT_LINE_MQTTSN("publish successful after %d ms.",
                                                  (int32_t) (uPortGetTickTimeMs() - startTimeMs));
@@ -817,8 +848,37 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClientSn")
                                            U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL);
                         U_PORT_TEST_ASSERT(uMqttClientSnGetTopicId(&topicNameOut) >= 0);
                         U_PORT_TEST_ASSERT(uMqttClientSnGetTopicNameShort(&topicNameOut, topicNameShortStr) < 0);
+                    } else if (idRun == 1) {
+                        // Now let the topic registry look after the topic ID: it
+                        // should be registered exactly once
+                        U_TEST_PRINT_LINE_MQTTSN("adding MQTT topic \"%s\" to the registry...",
+                                                 pTopicNameOutMqtt);
+                        gTopicStoreCallbackCount = 0;
+                        U_PORT_TEST_ASSERT(uMqttClientSnSetTopicStoreCallback(gpMqttContextA,
+                                                                              topicStoreCallback,
+                                                                              NULL) == 0);
+                        memset(&topicNameOut, 0xFF, sizeof(topicNameOut));
+                        U_PORT_TEST_ASSERT(uMqttClientSnTopicGet(gpMqttContextA, pTopicNameOutMqtt,
+                                                                 &topicNameOut) == 0);
+                        U_PORT_TEST_ASSERT(uMqttClientSnGetTopicNameType(&topicNameOut) ==
+                                           U_MQTT_SN_TOPIC_NAME_TYPE_ID_NORMAL);
+                        U_PORT_TEST_ASSERT(uMqttClientSnGetTopicId(&topicNameOut) >= 0);
+                        U_PORT_TEST_ASSERT(gTopicStoreCallbackCount == 1);
+                        U_PORT_TEST_ASSERT(uMqttClientSnTopicGet(gpMqttContextA, pTopicNameOutMqtt,
+                                                                 &topicNameIn) == 0);
+                        U_PORT_TEST_ASSERT(uMqttClientSnGetTopicId(&topicNameIn) ==
+                                           uMqttClientSnGetTopicId(&topicNameOut));
+                        U_PORT_TEST_ASSERT(gTopicStoreCallbackCount == 1);
+                        // A short topic name needs no registration
+                        U_PORT_TEST_ASSERT(uMqttClientSnTopicGet(gpMqttContextA, "ab",
+                                                                 &topicNameIn) == 0);
+                        U_PORT_TEST_ASSERT(uMqttClientSnGetTopicNameType(&topicNameIn) ==
+                                           U_MQTT_SN_TOPIC_NAME_TYPE_NAME_SHORT);
+                        U_PORT_TEST_ASSERT(gTopicStoreCallbackCount == 1);
                     }
                 }
+                // Publishing by name should not have registered the topic again
+                U_PORT_TEST_ASSERT(gTopicStoreCallbackCount == 1);
 
                 // Cancel the subscribe
                 U_TEST_PRINT_LINE_MQTTSN("unsubscribing from topic \"%d\"...", topicNameOut.name.id);
@@ -884,6 +944,42 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClientSn")
                     // dropped unexpectedly
                     U_PORT_TEST_ASSERT(gDisconnectCallbackCalled);
                 }
+
+                // Connect again: this is a new MQTT-SN session, so the
+                // topic in the registry should be registered again as
+                // part of connecting, after which publishing by topic
+                // name should need no registration of its own
+                U_TEST_PRINT_LINE_MQTTSN("reconnecting to \"%s\"...", connection.pBrokerNameStr);
+                startTimeMs = uPortGetTickTimeMs();
+                gStopTimeMs = startTimeMs +
+                              (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
+                U_PORT_TEST_ASSERT(uMqttClientConnect(gpMqttContextA, &connection) == 0);
+                U_TEST_PRINT_LINE_MQTTSN("reconnect successful after %d ms.",
+                                         (int32_t) (uPortGetTickTimeMs() - startTimeMs));
+                U_PORT_TEST_ASSERT(uMqttClientIsConnected(gpMqttContextA));
+                U_PORT_TEST_ASSERT(gTopicStoreCallbackCount == 2);
+                U_TEST_PRINT_LINE_MQTTSN("publishing %d byte(s) to topic name \"%s\"...",
+                                         U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                         pTopicNameOutMqtt);
+                gStopTimeMs = uPortGetTickTimeMs() +
+                              (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
+                y = uMqttClientSnPublishTopicName(gpMqttContextA, pTopicNameOutMqtt,
+                                                  pMessageOut,
+                                                  U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                                  U_MQTT_QOS_EXACTLY_ONCE, false);
+                U_PORT_TEST_ASSERT(y == 0);
+                U_PORT_TEST_ASSERT(gTopicStoreCallbackCount == 2);
+
+                // Disconnect MQTT again
+                U_TEST_PRINT_LINE_MQTTSN("disconnecting from \"%s\" again...",
+                                         connection.pBrokerNameStr);
+                gDisconnectCallbackCalled = false;
+                U_PORT_TEST_ASSERT(uMqttClientDisconnect(gpMqttContextA) == 0);
+                U_PORT_TEST_ASSERT(!uMqttClientIsConnected(gpMqttContextA));
+                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                if (pTmp->networkType != U_NETWORK_TYPE_CELL) {
+                    U_PORT_TEST_ASSERT(gDisconnectCallbackCalled);
+                }
             } else {
                 U_TEST_PRINT_LINE_MQTTSN("connection failed after %d ms,"
                                          " with error %d, module error %d.",
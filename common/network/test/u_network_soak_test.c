@@ -0,0 +1,981 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Concurrent multi-device soak test: all of the devices in the
+ * network test configuration are opened with uDeviceOpen(), their
+ * networks are brought up and then socket, MQTT and location workloads
+ * are run on every one of them at once from several tasks for a fixed
+ * period.  At the end the aggregate throughput, the latency percentiles
+ * of each workload, the heap high-water mark and, if U_CFG_MUTEX_DEBUG
+ * is defined, the lock contention statistics are printed, so that a
+ * change which causes ubxlib to scale badly with the number of devices
+ * or tasks, e.g. in one of the global mutexes, becomes visible.
+ *
+ * The devices may be real or may be simulated ones, e.g. module
+ * simulators on virtual UARTs (PTYs on Linux); it is only necessary
+ * that they respond through the UARTs set in the usual test
+ * configuration.
+ *
+ * Since the usual test configuration has at most one device of each
+ * type, a second test, networkSoakScaling, adds N cellular instances
+ * talking to modules simulated over memory streams, as in the
+ * cellParallel test, and runs an AT workload on all of them at once
+ * from several tasks, for N of 1, 2, 4, etc. up to
+ * #U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX; the results are printed
+ * for each N so that the way throughput and lock contention scale
+ * with the number of devices can be seen.
+ *
+ * This test takes a long time and so is only compiled if
+ * U_CFG_TEST_NETWORK_SOAK is defined.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_TEST_NETWORK_SOAK
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // malloc(), free()
+#include "string.h"    // memset(), memcpy(), strncmp()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_i2c.h"
+
+#include "u_network.h"
+#include "u_network_test_shared_cfg.h"
+
+#include "u_sock.h"
+#include "u_sock_test_shared_cfg.h"
+
+#include "u_mqtt_common.h"
+#include "u_mqtt_client.h"
+
+#include "u_location.h"
+#include "u_location_test_shared_cfg.h"
+
+#include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_info.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_NETWORK_SOAK_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The string to put at the start of all prints from this test
+ * where an interation is required on the end.
+ */
+#define U_TEST_PREFIX_X U_TEST_PREFIX_BASE "_%d: "
+
+/** Print a whole line, with terminator and iteration on the end,
+ * prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE_X(format, ...) uPortLog(U_TEST_PREFIX_X format "\n", ##__VA_ARGS__)
+
+#ifndef U_NETWORK_SOAK_TEST_DURATION_SECONDS
+/** How long to run the workloads for.
+ */
+# define U_NETWORK_SOAK_TEST_DURATION_SECONDS 600
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_TASKS_PER_NETWORK
+/** The number of workload tasks to run on each network; the
+ * workloads a network supports are shared out between its
+ * tasks in turn.
+ */
+# define U_NETWORK_SOAK_TEST_TASKS_PER_NETWORK 3
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX
+/** The maximum number of latency samples kept by each task;
+ * once this many have been taken the oldest are overwritten.
+ */
+# define U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX 256
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_MQTT_BROKER_URL
+/** Server to use for the MQTT workload, non secure.
+ */
+//lint -esym(773, U_NETWORK_SOAK_TEST_MQTT_BROKER_URL) Suppress not fully
+// bracketed, Lint is wary of the "-" in here but we can't have brackets
+// around this since it is used directly.
+# define U_NETWORK_SOAK_TEST_MQTT_BROKER_URL ubxlib.it-sgn.u-blox.com
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_MQTT_CONNECT_TIMEOUT_SECONDS
+/** How long to wait for the MQTT client of a network to connect
+ * to the broker.
+ */
+# define U_NETWORK_SOAK_TEST_MQTT_CONNECT_TIMEOUT_SECONDS 30
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX
+/** The largest number of simulated cellular devices to run the
+ * networkSoakScaling test with; it is run with 1, 2, 4, etc.
+ * devices, finishing with this number.  Each simulated device
+ * needs a memory stream and an AT client so, to go beyond the
+ * default, U_AT_CLIENT_STREAM_MEMORY_MAX_NUM and, if required,
+ * U_AT_CLIENT_MAX_NUM must also be increased, e.g. for 8 devices
+ * define U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX=8,
+ * U_AT_CLIENT_STREAM_MEMORY_MAX_NUM=8 and U_AT_CLIENT_MAX_NUM=8.
+ */
+# define U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX U_AT_CLIENT_STREAM_MEMORY_MAX_NUM
+#endif
+
+#if U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX > U_AT_CLIENT_STREAM_MEMORY_MAX_NUM
+# error U_AT_CLIENT_STREAM_MEMORY_MAX_NUM must be at least U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX
+#endif
+
+#if U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX > U_AT_CLIENT_MAX_NUM
+# error U_AT_CLIENT_MAX_NUM must be at least U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_SIMULATED_DURATION_SECONDS
+/** How long to run the AT workload for, for each number of
+ * simulated devices.
+ */
+# define U_NETWORK_SOAK_TEST_SIMULATED_DURATION_SECONDS 10
+#endif
+
+#ifndef U_NETWORK_SOAK_TEST_SIMULATED_LATENCY_MS
+/** The time a simulated module takes to respond to a command.
+ */
+# define U_NETWORK_SOAK_TEST_SIMULATED_LATENCY_MS 20
+#endif
+
+/** The response of a simulated module to any command, which is
+ * what it would send in response to AT+CGSN.
+ */
+#define U_NETWORK_SOAK_TEST_SIMULATED_RESPONSE "\r\n351234567890123\r\nOK\r\n"
+
+/** The maximum number of workload tasks for real networks.
+ */
+#define U_NETWORK_SOAK_TEST_NETWORK_TASKS_MAX_NUM (U_NETWORK_TYPE_MAX_NUM *      \
+                                                   U_NETWORK_SOAK_TEST_TASKS_PER_NETWORK)
+
+/** The maximum number of workload tasks for simulated devices.
+ */
+#define U_NETWORK_SOAK_TEST_SIMULATED_TASKS_MAX_NUM (U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX * \
+                                                     U_NETWORK_SOAK_TEST_TASKS_PER_NETWORK)
+
+/** The maximum number of workload tasks.
+ */
+#if U_NETWORK_SOAK_TEST_SIMULATED_TASKS_MAX_NUM > U_NETWORK_SOAK_TEST_NETWORK_TASKS_MAX_NUM
+# define U_NETWORK_SOAK_TEST_TASKS_MAX_NUM U_NETWORK_SOAK_TEST_SIMULATED_TASKS_MAX_NUM
+#else
+# define U_NETWORK_SOAK_TEST_TASKS_MAX_NUM U_NETWORK_SOAK_TEST_NETWORK_TASKS_MAX_NUM
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The workloads that may be run.
+ */
+typedef enum {
+    U_NETWORK_SOAK_TEST_WORKLOAD_SOCK,
+    U_NETWORK_SOAK_TEST_WORKLOAD_MQTT,
+    U_NETWORK_SOAK_TEST_WORKLOAD_LOCATION,
+    U_NETWORK_SOAK_TEST_WORKLOAD_AT, /**< simulated devices only. */
+    U_NETWORK_SOAK_TEST_WORKLOAD_MAX_NUM
+} uNetworkSoakTestWorkload_t;
+
+/** Everything a workload task needs, including the place where
+ * it records its results.
+ */
+typedef struct {
+    int32_t index;
+    uDeviceHandle_t devHandle;
+    uNetworkType_t networkType;
+    uNetworkSoakTestWorkload_t workload;
+    uMqttClientContext_t *pMqttClientContext; /**< shared between the
+                                                   tasks of a network. */
+    const uLocationTestCfg_t *pLocationCfg;
+    int32_t opCount;
+    int32_t errorCount;
+    int32_t byteCount;
+    int32_t latencyMaxMs;
+    size_t numLatencies; /**< may exceed the number stored. */
+    int32_t latencyMs[U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX];
+    int32_t stackMinFreeBytes;
+    volatile bool done;
+} uNetworkSoakTestTask_t;
+
+/** The results of the networkSoakScaling test for one number
+ * of simulated devices.
+ */
+typedef struct {
+    size_t numDevices;
+    int32_t durationMs;
+    int32_t opCount;
+    int32_t errorCount;
+    int32_t latencyMaxMs;
+} uNetworkSoakTestScalingResult_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The data sent by the socket and MQTT workloads.
+ */
+static const char gTestString[] = "Hello from u-blox, soaking.";
+
+/** The name of each workload.
+ */
+static const char *const gpWorkloadName[] = {"socket", "MQTT", "location", "AT"};
+
+/** The workload tasks.
+ */
+static uNetworkSoakTestTask_t *gpTask[U_NETWORK_SOAK_TEST_TASKS_MAX_NUM] = {0};
+
+/** The MQTT client of each network.
+ */
+static uMqttClientContext_t *gpMqttClientContext[U_NETWORK_TYPE_MAX_NUM] = {0};
+
+/** When the workloads should stop.
+ */
+static volatile int32_t gStopTimeMs;
+
+/** The address of the echo server, looked up once.
+ */
+static uSockAddress_t gEchoAddress;
+
+/** The memory streams of the simulated devices.
+ */
+static int32_t gSimulatedStreamHandle[U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX];
+
+/** The AT clients of the simulated devices.
+ */
+static uAtClientHandle_t gSimulatedAtClientHandle[U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX];
+
+/** The number of entries in gSimulatedStreamHandle[] that are open.
+ */
+static size_t gNumSimulatedStreams = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Callback function for MQTT connection.
+static bool mqttKeepGoingCallback(void)
+{
+    return ((int32_t) uPortGetTickTimeMs() < gStopTimeMs);
+}
+
+// Callback function for location establishment.
+static bool keepGoingCallback(uDeviceHandle_t devHandle)
+{
+    (void) devHandle;
+
+    return mqttKeepGoingCallback();
+}
+
+// Get the module type from a device configuration.
+static int32_t moduleTypeGet(const uDeviceCfg_t *pDeviceCfg)
+{
+    int32_t moduleType = -1;
+
+    switch (pDeviceCfg->deviceType) {
+        case U_DEVICE_TYPE_CELL:
+            moduleType = (int32_t) pDeviceCfg->deviceCfg.cfgCell.moduleType;
+            break;
+        case U_DEVICE_TYPE_GNSS:
+            moduleType = (int32_t) pDeviceCfg->deviceCfg.cfgGnss.moduleType;
+            break;
+        case U_DEVICE_TYPE_SHORT_RANGE:
+            moduleType = (int32_t) pDeviceCfg->deviceCfg.cfgSho.moduleType;
+            break;
+        default:
+            break;
+    }
+
+    return moduleType;
+}
+
+// Transmit callback for the simulated modules: once a command is
+// complete, wait a while, as a real module would, and then respond.
+static void simulatedTransmitCallback(int32_t streamHandle, const char *pData,
+                                      size_t size, void *pParam)
+{
+    (void) pParam;
+
+    if (memchr(pData, '\r', size) != NULL) {
+        uPortTaskBlock(U_NETWORK_SOAK_TEST_SIMULATED_LATENCY_MS);
+        uAtClientStreamMemoryPush(streamHandle, U_NETWORK_SOAK_TEST_SIMULATED_RESPONSE,
+                                  sizeof(U_NETWORK_SOAK_TEST_SIMULATED_RESPONSE) - 1);
+    }
+}
+
+// Remove the simulated devices and close their streams.
+static void simulatedDevicesRemove()
+{
+    uCellDeinit();
+    for (size_t x = 0; x < gNumSimulatedStreams; x++) {
+        if (gSimulatedAtClientHandle[x] != NULL) {
+            uAtClientRemove(gSimulatedAtClientHandle[x]);
+            gSimulatedAtClientHandle[x] = NULL;
+        }
+        uAtClientStreamMemoryClose(gSimulatedStreamHandle[x]);
+    }
+    gNumSimulatedStreams = 0;
+}
+
+// Record the latency of an operation.
+static void latencyAdd(uNetworkSoakTestTask_t *pTask, int32_t latencyMs)
+{
+    pTask->latencyMs[pTask->numLatencies % U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX] =
+        latencyMs;
+    pTask->numLatencies++;
+    if (latencyMs > pTask->latencyMaxMs) {
+        pTask->latencyMaxMs = latencyMs;
+    }
+}
+
+// The socket workload: a UDP echo on a socket of the task's own,
+// returns the number of bytes echoed or negative error code.
+static int32_t workloadSock(uSockDescriptor_t descriptor)
+{
+    int32_t errorCodeOrSize;
+    char buffer[sizeof(gTestString)];
+
+    errorCodeOrSize = uSockSendTo(descriptor, &gEchoAddress, gTestString,
+                                  sizeof(gTestString) - 1);
+    if (errorCodeOrSize == sizeof(gTestString) - 1) {
+        memset(buffer, 0, sizeof(buffer));
+        errorCodeOrSize = uSockReceiveFrom(descriptor, NULL,
+                                           buffer, sizeof(buffer));
+        if ((errorCodeOrSize != sizeof(gTestString) - 1) ||
+            (strncmp(buffer, gTestString, sizeof(buffer)) != 0)) {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        }
+    } else if (errorCodeOrSize >= 0) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+
+    return errorCodeOrSize;
+}
+
+// The workload task.
+static void workloadTask(void *pParameters)
+{
+    uNetworkSoakTestTask_t *pTask = (uNetworkSoakTestTask_t *) pParameters;
+    uSockDescriptor_t descriptor = -1;
+    char topic[32];
+    uLocation_t location;
+    char imei[U_CELL_INFO_IMEI_SIZE];
+    int32_t startTimeMs;
+    int32_t errorCodeOrSize;
+
+    if (pTask->workload == U_NETWORK_SOAK_TEST_WORKLOAD_SOCK) {
+        descriptor = uSockCreate(pTask->devHandle, U_SOCK_TYPE_DGRAM,
+                                 U_SOCK_PROTOCOL_UDP);
+        if (descriptor < 0) {
+            pTask->errorCount++;
+        }
+    }
+    snprintf(topic, sizeof(topic), "ubx_soak_%d", (int) pTask->index);
+
+    while (((int32_t) uPortGetTickTimeMs() < gStopTimeMs) &&
+           ((pTask->workload != U_NETWORK_SOAK_TEST_WORKLOAD_SOCK) ||
+            (descriptor >= 0))) {
+        startTimeMs = (int32_t) uPortGetTickTimeMs();
+        switch (pTask->workload) {
+            case U_NETWORK_SOAK_TEST_WORKLOAD_SOCK:
+                errorCodeOrSize = workloadSock(descriptor);
+                break;
+            case U_NETWORK_SOAK_TEST_WORKLOAD_MQTT:
+                errorCodeOrSize = uMqttClientPublish(pTask->pMqttClientContext,
+                                                     topic, gTestString,
+                                                     sizeof(gTestString) - 1,
+                                                     U_MQTT_QOS_AT_LEAST_ONCE,
+                                                     false);
+                if (errorCodeOrSize == 0) {
+                    errorCodeOrSize = sizeof(gTestString) - 1;
+                }
+                break;
+            case U_NETWORK_SOAK_TEST_WORKLOAD_LOCATION:
+                errorCodeOrSize = uLocationGet(pTask->devHandle,
+                                               pTask->pLocationCfg->locationType,
+                                               pTask->pLocationCfg->pLocationAssist,
+                                               pTask->pLocationCfg->pAuthenticationTokenStr,
+                                               &location, keepGoingCallback);
+                break;
+            case U_NETWORK_SOAK_TEST_WORKLOAD_AT:
+                errorCodeOrSize = uCellInfoGetImei(pTask->devHandle, imei);
+                if (errorCodeOrSize == 0) {
+                    errorCodeOrSize = sizeof(imei);
+                }
+                break;
+            default:
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                break;
+        }
+        if (errorCodeOrSize >= 0) {
+            latencyAdd(pTask, (int32_t) uPortGetTickTimeMs() - startTimeMs);
+            pTask->opCount++;
+            pTask->byteCount += errorCodeOrSize;
+        } else if ((int32_t) uPortGetTickTimeMs() < gStopTimeMs) {
+            // Only count as an error if we weren't stopped part way
+            pTask->errorCount++;
+            uPortTaskBlock(1000);
+        }
+        // Let everyone else in
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+
+    if (descriptor >= 0) {
+        uSockClose(descriptor);
+    }
+    pTask->stackMinFreeBytes = uPortTaskStackMinFree(NULL);
+    pTask->done = true;
+
+    uPortTaskDelete(NULL);
+}
+
+// Sort an array of latencies into ascending order; the number of
+// samples is small so a simple insertion sort is fine.
+static void latencySort(int32_t *pLatencyMs, size_t numLatencies)
+{
+    int32_t latencyMs;
+    size_t y;
+
+    for (size_t x = 1; x < numLatencies; x++) {
+        latencyMs = pLatencyMs[x];
+        for (y = x; (y > 0) && (pLatencyMs[y - 1] > latencyMs); y--) {
+            pLatencyMs[y] = pLatencyMs[y - 1];
+        }
+        pLatencyMs[y] = latencyMs;
+    }
+}
+
+// Print the results of a workload across all of the tasks running it.
+static void workloadResultsPrint(uNetworkSoakTestWorkload_t workload,
+                                 int32_t durationMs)
+{
+    int32_t opCount = 0;
+    int32_t errorCount = 0;
+    int32_t byteCount = 0;
+    int32_t latencyMaxMs = 0;
+    size_t numLatencies = 0;
+    size_t numStored;
+    int32_t *pLatencyMs;
+
+    for (size_t x = 0; x < sizeof(gpTask) / sizeof(gpTask[0]); x++) {
+        if ((gpTask[x] != NULL) && (gpTask[x]->workload == workload)) {
+            opCount += gpTask[x]->opCount;
+            errorCount += gpTask[x]->errorCount;
+            byteCount += gpTask[x]->byteCount;
+            if (gpTask[x]->latencyMaxMs > latencyMaxMs) {
+                latencyMaxMs = gpTask[x]->latencyMaxMs;
+            }
+            numStored = gpTask[x]->numLatencies;
+            if (numStored > U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX) {
+                numStored = U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX;
+            }
+            numLatencies += numStored;
+        }
+    }
+
+    if (opCount + errorCount > 0) {
+        U_TEST_PRINT_LINE("%s: %d operation(s) (%d.%02d per second), %d error(s),"
+                          " %d byte(s) (%d per second).", gpWorkloadName[workload],
+                          opCount, (opCount * 1000) / durationMs,
+                          ((opCount * 100000) / durationMs) % 100,
+                          errorCount, byteCount,
+                          (int32_t) (((int64_t) byteCount * 1000) / durationMs));
+        // Gather the latencies of all the tasks together
+        pLatencyMs = NULL;
+        if (numLatencies > 0) {
+            pLatencyMs = (int32_t *) malloc(numLatencies * sizeof(int32_t));
+        }
+        if (pLatencyMs != NULL) {
+            numLatencies = 0;
+            for (size_t x = 0; x < sizeof(gpTask) / sizeof(gpTask[0]); x++) {
+                if ((gpTask[x] != NULL) && (gpTask[x]->workload == workload)) {
+                    numStored = gpTask[x]->numLatencies;
+                    if (numStored > U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX) {
+                        numStored = U_NETWORK_SOAK_TEST_LATENCY_SAMPLES_MAX;
+                    }
+                    memcpy(pLatencyMs + numLatencies, gpTask[x]->latencyMs,
+                           numStored * sizeof(int32_t));
+                    numLatencies += numStored;
+                }
+            }
+            latencySort(pLatencyMs, numLatencies);
+            U_TEST_PRINT_LINE("%s: latency p50 %d ms, p90 %d ms, p99 %d ms,"
+                              " max %d ms (from the last %d operation(s)).",
+                              gpWorkloadName[workload],
+                              pLatencyMs[(numLatencies * 50) / 100],
+                              pLatencyMs[(numLatencies * 90) / 100],
+                              pLatencyMs[(numLatencies * 99) / 100],
+                              latencyMaxMs, numLatencies);
+        }
+        free(pLatencyMs);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Soak test: run socket, MQTT and location workloads on all
+ * networks at once.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[networkSoak]", "networkSoak")
+{
+    uNetworkTestList_t *pList;
+    uDeviceHandle_t devHandle;
+    uNetworkType_t networkType;
+    int32_t moduleType;
+    uMqttClientConnection_t connection = U_MQTT_CLIENT_CONNECTION_DEFAULT;
+    uNetworkSoakTestWorkload_t workloads[U_NETWORK_SOAK_TEST_WORKLOAD_MAX_NUM];
+    size_t numWorkloads;
+    size_t numTasks = 0;
+    uPortTaskHandle_t taskHandle;
+    int32_t heapFreeAtStart;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t opCount = 0;
+    int32_t errorCount = 0;
+    int32_t byteCount = 0;
+    int32_t y;
+#ifdef U_CFG_MUTEX_DEBUG
+    uMutexDebugStats_t mutexStats;
+#endif
+
+    // In case a previous test failed
+    uNetworkTestCleanUp();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    // Don't check this for success as not all platforms support I2C
+    uPortI2cInit();
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    // Get a list of all things and open them
+    pList = pUNetworkTestListAlloc(NULL);
+    if (pList == NULL) {
+        U_TEST_PRINT_LINE("*** WARNING *** nothing to do.");
+    }
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        if (*pTmp->pDevHandle == NULL) {
+            U_TEST_PRINT_LINE("adding device %s for network %s...",
+                              gpUNetworkTestDeviceTypeName[pTmp->pDeviceCfg->deviceType],
+                              gpUNetworkTestTypeName[pTmp->networkType]);
+            U_PORT_TEST_ASSERT(uDeviceOpen(pTmp->pDeviceCfg, pTmp->pDevHandle) == 0);
+        }
+    }
+
+    // Bring up each network and set up what its workloads need
+    gStopTimeMs = INT32_MAX;
+    connection.pBrokerNameStr = U_PORT_STRINGIFY_QUOTED(U_NETWORK_SOAK_TEST_MQTT_BROKER_URL);
+    connection.pKeepGoingCallback = mqttKeepGoingCallback;
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        devHandle = *pTmp->pDevHandle;
+        networkType = pTmp->networkType;
+        U_TEST_PRINT_LINE("bringing up %s...", gpUNetworkTestTypeName[networkType]);
+        U_PORT_TEST_ASSERT(uNetworkInterfaceUp(devHandle, networkType,
+                                               pTmp->pNetworkCfg) == 0);
+        moduleType = moduleTypeGet(pTmp->pDeviceCfg);
+        numWorkloads = 0;
+        if (uNetworkTestHasSock(pTmp->pDeviceCfg->deviceType, networkType, moduleType)) {
+            if (uSockGetHostByName(devHandle, U_SOCK_TEST_ECHO_UDP_SERVER_DOMAIN_NAME,
+                                   &(gEchoAddress.ipAddress)) == 0) {
+                gEchoAddress.port = U_SOCK_TEST_ECHO_UDP_SERVER_PORT;
+                workloads[numWorkloads] = U_NETWORK_SOAK_TEST_WORKLOAD_SOCK;
+                numWorkloads++;
+            } else {
+                U_TEST_PRINT_LINE("unable to look up \"%s\" on %s, no socket workload.",
+                                  U_SOCK_TEST_ECHO_UDP_SERVER_DOMAIN_NAME,
+                                  gpUNetworkTestTypeName[networkType]);
+            }
+        }
+        if (uNetworkTestHasMqtt(pTmp->pDeviceCfg->deviceType, networkType, moduleType)) {
+            gpMqttClientContext[networkType] = pUMqttClientOpen(devHandle, NULL);
+            if (gpMqttClientContext[networkType] != NULL) {
+                U_TEST_PRINT_LINE("connecting to \"%s\" on %s...", connection.pBrokerNameStr,
+                                  gpUNetworkTestTypeName[networkType]);
+                gStopTimeMs = (int32_t) uPortGetTickTimeMs() +
+                              (U_NETWORK_SOAK_TEST_MQTT_CONNECT_TIMEOUT_SECONDS * 1000);
+                if (uMqttClientConnect(gpMqttClientContext[networkType], &connection) == 0) {
+                    workloads[numWorkloads] = U_NETWORK_SOAK_TEST_WORKLOAD_MQTT;
+                    numWorkloads++;
+                } else {
+                    U_TEST_PRINT_LINE("unable to connect MQTT on %s, no MQTT workload.",
+                                      gpUNetworkTestTypeName[networkType]);
+                }
+                gStopTimeMs = INT32_MAX;
+            }
+        }
+        if (gpULocationTestCfg[networkType]->numEntries > 0) {
+            workloads[numWorkloads] = U_NETWORK_SOAK_TEST_WORKLOAD_LOCATION;
+            numWorkloads++;
+        }
+        // Share the workloads out between the tasks of this network
+        for (size_t x = 0; (x < U_NETWORK_SOAK_TEST_TASKS_PER_NETWORK) &&
+             (numWorkloads > 0); x++) {
+            U_PORT_TEST_ASSERT(numTasks < sizeof(gpTask) / sizeof(gpTask[0]));
+            gpTask[numTasks] = (uNetworkSoakTestTask_t *) malloc(sizeof(uNetworkSoakTestTask_t));
+            U_PORT_TEST_ASSERT(gpTask[numTasks] != NULL);
+            memset(gpTask[numTasks], 0, sizeof(uNetworkSoakTestTask_t));
+            gpTask[numTasks]->index = (int32_t) numTasks;
+            gpTask[numTasks]->devHandle = devHandle;
+            gpTask[numTasks]->networkType = networkType;
+            gpTask[numTasks]->workload = workloads[x % numWorkloads];
+            gpTask[numTasks]->pMqttClientContext = gpMqttClientContext[networkType];
+            gpTask[numTasks]->pLocationCfg = gpULocationTestCfg[networkType]->pCfgData[0];
+            numTasks++;
+        }
+    }
+
+    // Start the tasks and let them run
+    U_TEST_PRINT_LINE("running %d task(s) for %d second(s)...", numTasks,
+                      U_NETWORK_SOAK_TEST_DURATION_SECONDS);
+    heapFreeAtStart = uPortGetHeapFree();
+#ifdef U_CFG_MUTEX_DEBUG
+    uMutexDebugStatsReset();
+#endif
+    startTimeMs = (int32_t) uPortGetTickTimeMs();
+    gStopTimeMs = startTimeMs + (U_NETWORK_SOAK_TEST_DURATION_SECONDS * 1000);
+    for (size_t x = 0; x < numTasks; x++) {
+        U_TEST_PRINT_LINE_X("%s workload on %s.", x, gpWorkloadName[gpTask[x]->workload],
+                            gpUNetworkTestTypeName[gpTask[x]->networkType]);
+        U_PORT_TEST_ASSERT(uPortTaskCreate(workloadTask, "networkSoak",
+                                           U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                           (void *) gpTask[x],
+                                           U_CFG_TEST_OS_TASK_PRIORITY,
+                                           &taskHandle) == 0);
+    }
+    for (size_t x = 0; x < numTasks; x++) {
+        while (!gpTask[x]->done) {
+            uPortTaskBlock(1000);
+        }
+    }
+    durationMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+    // Give the tasks a moment to delete themselves
+    uPortTaskBlock(U_CFG_OS_YIELD_MS + 100);
+
+    // Report
+    U_TEST_PRINT_LINE("%d task(s) ran for %d ms.", numTasks, durationMs);
+    for (size_t x = 0; x < numTasks; x++) {
+        opCount += gpTask[x]->opCount;
+        errorCount += gpTask[x]->errorCount;
+        byteCount += gpTask[x]->byteCount;
+        if (gpTask[x]->stackMinFreeBytes != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+            U_TEST_PRINT_LINE_X("task stack had a minimum of %d byte(s) free.", x,
+                                gpTask[x]->stackMinFreeBytes);
+        }
+    }
+    for (size_t x = 0; x < U_NETWORK_SOAK_TEST_WORKLOAD_MAX_NUM; x++) {
+        workloadResultsPrint((uNetworkSoakTestWorkload_t) x, durationMs);
+    }
+    U_TEST_PRINT_LINE("total: %d operation(s), %d error(s), %d byte(s)"
+                      " (%d per second).", opCount, errorCount, byteCount,
+                      (int32_t) (((int64_t) byteCount * 1000) / durationMs));
+    y = uPortGetHeapMinFree();
+    if (y >= 0) {
+        U_TEST_PRINT_LINE("heap had %d byte(s) free at the start, a minimum"
+                          " of %d byte(s) free so far.", heapFreeAtStart, y);
+    }
+#ifdef U_CFG_MUTEX_DEBUG
+    if (uMutexDebugStatsGet(&mutexStats) == 0) {
+        U_TEST_PRINT_LINE("%d mutex(es), %d lock(s), %d contended, %d ms spent"
+                          " waiting in total, %d ms at most.", mutexStats.numMutexes,
+                          mutexStats.lockCount, mutexStats.contendedCount,
+                          (int32_t) mutexStats.waitTotalMs, mutexStats.waitMaxMs);
+        uMutexDebugStatsPrint(NULL);
+    }
+#endif
+
+    // Clean up
+    for (size_t x = 0; x < numTasks; x++) {
+        free(gpTask[x]);
+        gpTask[x] = NULL;
+    }
+    for (size_t x = 0; x < sizeof(gpMqttClientContext) / sizeof(gpMqttClientContext[0]); x++) {
+        if (gpMqttClientContext[x] != NULL) {
+            uMqttClientDisconnect(gpMqttClientContext[x]);
+            uMqttClientClose(gpMqttClientContext[x]);
+            gpMqttClientContext[x] = NULL;
+        }
+    }
+    uSockCleanUp();
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        U_TEST_PRINT_LINE("taking down %s...", gpUNetworkTestTypeName[pTmp->networkType]);
+        U_PORT_TEST_ASSERT(uNetworkInterfaceDown(*pTmp->pDevHandle,
+                                                 pTmp->networkType) == 0);
+    }
+    for (uNetworkTestList_t *pTmp = pList; pTmp != NULL; pTmp = pTmp->pNext) {
+        if (*pTmp->pDevHandle != NULL) {
+            U_TEST_PRINT_LINE("closing device %s...",
+                              gpUNetworkTestDeviceTypeName[pTmp->pDeviceCfg->deviceType]);
+            U_PORT_TEST_ASSERT(uDeviceClose(*pTmp->pDevHandle, false) == 0);
+            *pTmp->pDevHandle = NULL;
+        }
+    }
+    uNetworkTestListFree();
+
+    uDeviceDeinit();
+    uPortI2cDeinit();
+    uPortDeinit();
+
+    // Errors are reported rather than asserted on, a soak of real
+    // networks will always suffer a few, but there must have been
+    // some work done
+    U_PORT_TEST_ASSERT((numTasks == 0) || (opCount > 0));
+}
+
+/** Scaling test: run an AT workload on N simulated cellular
+ * devices at once, for N of 1, 2, 4, etc. up to
+ * #U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX, and report the results
+ * for each N.  Since each simulated module takes a fixed time to
+ * respond, the aggregate throughput should go up in proportion to N;
+ * if it does not then something, most likely a global mutex, is
+ * serialising the devices.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[networkSoak]", "networkSoakScaling")
+{
+    uDeviceHandle_t devHandle[U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX];
+    uNetworkSoakTestScalingResult_t results[U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX];
+    uNetworkSoakTestScalingResult_t *pResult;
+    size_t numResults = 0;
+    size_t numDevices = 1;
+    size_t numTasks;
+    uPortTaskHandle_t taskHandle;
+    int32_t startTimeMs;
+    int32_t heapUsed;
+#ifdef U_CFG_MUTEX_DEBUG
+    uMutexDebugStats_t mutexStats;
+#endif
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    while (numResults < sizeof(results) / sizeof(results[0])) {
+        // Add the simulated devices
+        U_PORT_TEST_ASSERT(uCellInit() == 0);
+        for (size_t x = 0; x < numDevices; x++) {
+            gSimulatedStreamHandle[x] = uAtClientStreamMemoryOpen(U_CELL_AT_BUFFER_LENGTH_BYTES,
+                                                                  simulatedTransmitCallback,
+                                                                  NULL);
+            U_PORT_TEST_ASSERT(gSimulatedStreamHandle[x] >= 0);
+            gNumSimulatedStreams++;
+            gSimulatedAtClientHandle[x] = uAtClientAdd(gSimulatedStreamHandle[x],
+                                                       U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                                       NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+            U_PORT_TEST_ASSERT(gSimulatedAtClientHandle[x] != NULL);
+            U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, gSimulatedAtClientHandle[x],
+                                        -1, -1, -1, false, &devHandle[x]) == 0);
+        }
+
+        // Share the tasks out between the devices
+        numTasks = 0;
+        for (size_t x = 0; x < numDevices * U_NETWORK_SOAK_TEST_TASKS_PER_NETWORK; x++) {
+            U_PORT_TEST_ASSERT(numTasks < sizeof(gpTask) / sizeof(gpTask[0]));
+            gpTask[numTasks] = (uNetworkSoakTestTask_t *) malloc(sizeof(uNetworkSoakTestTask_t));
+            U_PORT_TEST_ASSERT(gpTask[numTasks] != NULL);
+            memset(gpTask[numTasks], 0, sizeof(uNetworkSoakTestTask_t));
+            gpTask[numTasks]->index = (int32_t) numTasks;
+            gpTask[numTasks]->devHandle = devHandle[x % numDevices];
+            gpTask[numTasks]->networkType = U_NETWORK_TYPE_CELL;
+            gpTask[numTasks]->workload = U_NETWORK_SOAK_TEST_WORKLOAD_AT;
+            numTasks++;
+        }
+
+        // Start the tasks and let them run
+        U_TEST_PRINT_LINE("%d simulated device(s): running %d task(s) for %d"
+                          " second(s)...", numDevices, numTasks,
+                          U_NETWORK_SOAK_TEST_SIMULATED_DURATION_SECONDS);
+#ifdef U_CFG_MUTEX_DEBUG
+        uMutexDebugStatsReset();
+#endif
+        startTimeMs = (int32_t) uPortGetTickTimeMs();
+        gStopTimeMs = startTimeMs + (U_NETWORK_SOAK_TEST_SIMULATED_DURATION_SECONDS * 1000);
+        for (size_t x = 0; x < numTasks; x++) {
+            U_PORT_TEST_ASSERT(uPortTaskCreate(workloadTask, "networkSoak",
+                                               U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                               (void *) gpTask[x],
+                                               U_CFG_TEST_OS_TASK_PRIORITY,
+                                               &taskHandle) == 0);
+        }
+        for (size_t x = 0; x < numTasks; x++) {
+            while (!gpTask[x]->done) {
+                uPortTaskBlock(100);
+            }
+        }
+        pResult = &(results[numResults]);
+        memset(pResult, 0, sizeof(*pResult));
+        pResult->numDevices = numDevices;
+        pResult->durationMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+        // Give the tasks a moment to delete themselves
+        uPortTaskBlock(U_CFG_OS_YIELD_MS + 100);
+
+        // Report the results for this number of devices
+        for (size_t x = 0; x < numTasks; x++) {
+            pResult->opCount += gpTask[x]->opCount;
+            pResult->errorCount += gpTask[x]->errorCount;
+            if (gpTask[x]->latencyMaxMs > pResult->latencyMaxMs) {
+                pResult->latencyMaxMs = gpTask[x]->latencyMaxMs;
+            }
+        }
+        U_TEST_PRINT_LINE("%d simulated device(s):", numDevices);
+        workloadResultsPrint(U_NETWORK_SOAK_TEST_WORKLOAD_AT, pResult->durationMs);
+#ifdef U_CFG_MUTEX_DEBUG
+        if (uMutexDebugStatsGet(&mutexStats) == 0) {
+            U_TEST_PRINT_LINE("%d simulated device(s): %d lock(s), %d contended,"
+                              " %d ms spent waiting in total, %d ms at most.",
+                              numDevices, mutexStats.lockCount,
+                              mutexStats.contendedCount,
+                              (int32_t) mutexStats.waitTotalMs, mutexStats.waitMaxMs);
+        }
+#endif
+        numResults++;
+
+        // Clean up for the next number of devices
+        for (size_t x = 0; x < numTasks; x++) {
+            free(gpTask[x]);
+            gpTask[x] = NULL;
+        }
+        simulatedDevicesRemove();
+
+        if (numDevices >= U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX) {
+            break;
+        }
+        numDevices *= 2;
+        if (numDevices > U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX) {
+            numDevices = U_NETWORK_SOAK_TEST_SIMULATED_DEVICES_MAX;
+        }
+    }
+
+    // Print the results for each N side by side
+    U_TEST_PRINT_LINE("summary (devices, operations per second in total,"
+                      " per device, errors, max latency):");
+    for (size_t x = 0; x < numResults; x++) {
+        pResult = &(results[x]);
+        U_TEST_PRINT_LINE("%3d, %6d, %6d, %4d, %6d ms.", pResult->numDevices,
+                          (pResult->opCount * 1000) / pResult->durationMs,
+                          (pResult->opCount * 1000) /
+                          (pResult->durationMs * (int32_t) pResult->numDevices),
+                          pResult->errorCount, pResult->latencyMaxMs);
+    }
+
+    uAtClientDeinit();
+    uPortDeinit();
+
+    // The simulated modules never fail, so there should be no errors,
+    // and the devices are independent of one another, so the
+    // throughput of each device should not fall by much as more are
+    // added: allow it to halve
+    for (size_t x = 0; x < numResults; x++) {
+        pResult = &(results[x]);
+        U_PORT_TEST_ASSERT(pResult->errorCount == 0);
+        U_PORT_TEST_ASSERT(pResult->opCount > 0);
+        U_PORT_TEST_ASSERT(((int64_t) pResult->opCount * results[0].durationMs * 2) >=
+                           ((int64_t) results[0].opCount * pResult->durationMs *
+                            (int32_t) pResult->numDevices));
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[networkSoak]", "networkSoakCleanUp")
+{
+    for (size_t x = 0; x < sizeof(gpMqttClientContext) / sizeof(gpMqttClientContext[0]); x++) {
+        if (gpMqttClientContext[x] != NULL) {
+            uMqttClientClose(gpMqttClientContext[x]);
+            gpMqttClientContext[x] = NULL;
+        }
+    }
+    for (size_t x = 0; x < sizeof(gpTask) / sizeof(gpTask[0]); x++) {
+        // Don't free these if the task may still be running
+        if ((gpTask[x] != NULL) && gpTask[x]->done) {
+            free(gpTask[x]);
+            gpTask[x] = NULL;
+        }
+    }
+    uSockCleanUp();
+    uNetworkTestCleanUp();
+    simulatedDevicesRemove();
+    uAtClientDeinit();
+    uDeviceDeinit();
+    uPortI2cDeinit();
+    uPortDeinit();
+}
+
+#endif // #ifdef U_CFG_TEST_NETWORK_SOAK
+
+// End of file
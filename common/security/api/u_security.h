@@ -84,6 +84,21 @@ extern "C" {
  */
 #define U_SECURITY_E2E_HEADER_LENGTH_MIN_BYTES U_SECURITY_E2E_V2_HEADER_LENGTH_BYTES
 
+#ifndef U_SECURITY_E2E_STREAM_BLOCK_LENGTH_BYTES
+/** The default size of block used by uSecurityE2eEncryptStream():
+ * each block of this size is encrypted in a single operation by
+ * the module and so must not exceed the module's limit.
+ */
+# define U_SECURITY_E2E_STREAM_BLOCK_LENGTH_BYTES 512
+#endif
+
+#ifndef U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES
+/** The size of block in which ZTP items are moved to and from
+ * a cache store, see uSecurityZtpCacheEnable().
+ */
+# define U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES 256
+#endif
+
 /** The maximum amount of storage required for a generated
  * pre-shared key.
  */
@@ -120,6 +135,40 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The Zero Touch Provisioning items that may be read from a
+ * sealed module.
+ */
+typedef enum {
+    U_SECURITY_ZTP_TYPE_PRIVATE_KEY = 0,
+    U_SECURITY_ZTP_TYPE_DEVICE_CERTIFICATE = 1,
+    U_SECURITY_ZTP_TYPE_CERTIFICATE_AUTHORITIES = 2,
+    U_SECURITY_ZTP_TYPE_MAX_NUM
+} uSecurityZtpType_t;
+
+/** A store in which ZTP items may be cached, see
+ * uSecurityZtpCacheEnable().  The store is treated as one
+ * byte array per ZTP item, read and written in blocks of at most
+ * #U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES; it could, for instance,
+ * be a file per item in a file system.  The contents are validated
+ * by this code before use, the store need not check them.
+ */
+typedef struct {
+    /** Read a block from the store: should return the number of
+     * bytes read, which may be fewer than dataSizeBytes (e.g.
+     * zero if nothing has yet been stored), or negative error code.
+     */
+    int32_t (*pRead) (uDeviceHandle_t devHandle, uSecurityZtpType_t type,
+                      size_t offset, char *pData, size_t dataSizeBytes,
+                      void *pParam);
+    /** Write a block to the store: should return zero on success
+     * else negative error code.
+     */
+    int32_t (*pWrite) (uDeviceHandle_t devHandle, uSecurityZtpType_t type,
+                       size_t offset, const char *pData, size_t dataSizeBytes,
+                       void *pParam);
+    void *pParam; /**< passed to pRead and pWrite as their last parameter. */
+} uSecurityZtpCacheStore_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: INFORMATION
  * -------------------------------------------------------------- */
@@ -483,6 +532,68 @@ int32_t uSecurityZtpGetCertificateAuthorities(uDeviceHandle_t devHandle,
                                               char *pData,
                                               size_t dataSizeBytes);
 
+/** Enable caching of the ZTP items returned by
+ * uSecurityZtpGetDeviceCertificate(), uSecurityZtpGetPrivateKey()
+ * and uSecurityZtpGetCertificateAuthorities() for the given device.
+ * Reading these items from the module involves a transfer of
+ * several kilobytes over the AT interface; with the cache enabled
+ * an item is transferred from the module only once, after which
+ * it is returned from the cache.  The cache is keyed on a hash
+ * of the root of trust UID of the module, which is read from
+ * the module, along with its seal status, on the first read of
+ * any item after the cache is enabled; this is a short AT
+ * exchange, not an item transfer, and cached items are only used
+ * if they were cached with the same key, so a cache store that
+ * outlives a module cannot return the items of another module.
+ * Since the key does not change if the same module is somehow
+ * sealed again, a store that persists across such an event
+ * should be cleared by the application.  Every read from the
+ * cache is also checked against a checksum of the cached
+ * contents.  If either does not match the item is read from
+ * the module again.
+ *
+ * By default the cache is kept in RAM, allocated from the heap
+ * on demand.  Alternatively a store may be provided, for instance
+ * non-volatile storage, in which case no RAM is used for the
+ * cache, the contents being moved in blocks of
+ * #U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES, and so the items may
+ * survive a restart of the application.  Note that the private key
+ * is one of the items: the application is responsible for the
+ * confidentiality of any store it provides.
+ *
+ * An item is only cached if it was read in full: when reading
+ * an item for the first time either call the uSecurityZtpGetXxx()
+ * function with pData set to NULL to obtain the size first, as
+ * usual, or provide a buffer larger than the item.
+ *
+ * This function should not be called while a ZTP item is being
+ * read for the same device.
+ *
+ * @param devHandle   the handle of the instance to be used,
+ *                    for example obtained using uDeviceOpen().
+ * @param[in] pStore  the store to use, NULL to use RAM; if not
+ *                    NULL then the contents are copied and so
+ *                    pStore need not remain valid.  If the cache
+ *                    is already enabled for this device the store
+ *                    is replaced and any RAM cache is freed.
+ * @return            zero on success, else negative error code;
+ *                    U_ERROR_COMMON_NOT_INITIALISED if uDeviceInit()
+ *                    has not been called.
+ */
+int32_t uSecurityZtpCacheEnable(uDeviceHandle_t devHandle,
+                                const uSecurityZtpCacheStore_t *pStore);
+
+/** Disable caching of ZTP items for the given device, freeing any
+ * RAM that was used by the cache; the contents of a store provided
+ * to uSecurityZtpCacheEnable() are left untouched.  This should be
+ * called before the device is closed if uSecurityZtpCacheEnable()
+ * has been called, and should not be called while a ZTP item is
+ * being read for the same device.
+ *
+ * @param devHandle   the handle of the instance to be used.
+ */
+void uSecurityZtpCacheDisable(uDeviceHandle_t devHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: END TO END ENCRYPTION
  * -------------------------------------------------------------- */
@@ -545,6 +656,61 @@ int32_t uSecurityE2eEncrypt(uDeviceHandle_t devHandle,
                             void *pDataOut,
                             size_t dataSizeBytes);
 
+/** Ask a module to encrypt a stream of data of any length, with
+ * bounded RAM.  The data is pulled from pSourceCallback in blocks
+ * of up to blockSizeBytes; each block is encrypted by the module,
+ * exactly as uSecurityE2eEncrypt() would encrypt it, and pushed to
+ * pSinkCallback.  Where the module allows, the next block is
+ * obtained from pSourceCallback while the module is encrypting
+ * the current one.
+ *
+ * Each encrypted block carries its own E2E header and must be
+ * decrypted on its own at the destination, hence the application
+ * must preserve the block boundaries, e.g. by length-prefixing
+ * each block passed to pSinkCallback.  The RAM required is three
+ * times blockSizeBytes plus #U_SECURITY_E2E_HEADER_LENGTH_MAX_BYTES,
+ * allocated only for the duration of the call.
+ *
+ * @param devHandle            the handle of the instance to be used,
+ *                             for example obtained using uDeviceOpen().
+ * @param[in] pSourceCallback  the source of the data to encrypt, cannot
+ *                             be NULL.  It is given the device handle,
+ *                             a buffer, the size of that buffer and
+ *                             pCallbackParam and should fill as much of
+ *                             the buffer as it can, returning the number
+ *                             of bytes written, zero when there is no
+ *                             more data or negative error code to abort.
+ *                             It may be called with the interface to the
+ *                             module locked and so MUST NOT call any
+ *                             ubxlib API for the same device.
+ * @param[in] pSinkCallback    the destination of the encrypted blocks,
+ *                             cannot be NULL.  It is given the device
+ *                             handle, an encrypted block, its length and
+ *                             pCallbackParam and should return zero to
+ *                             continue or negative error code to abort.
+ * @param[in] pCallbackParam   a parameter that will be passed to both
+ *                             callbacks, may be NULL.
+ * @param blockSizeBytes       the number of bytes of data to encrypt
+ *                             in one block; use 0 for the default,
+ *                             #U_SECURITY_E2E_STREAM_BLOCK_LENGTH_BYTES.
+ * @return                     on success the total number of encrypted
+ *                             bytes passed to pSinkCallback, else
+ *                             negative error code (which will be the
+ *                             error code returned by a callback if it
+ *                             aborted the operation).
+ */
+int32_t uSecurityE2eEncryptStream(uDeviceHandle_t devHandle,
+                                  int32_t (*pSourceCallback) (uDeviceHandle_t,
+                                                              char *,
+                                                              size_t,
+                                                              void *),
+                                  int32_t (*pSinkCallback) (uDeviceHandle_t,
+                                                            const char *,
+                                                            size_t,
+                                                            void *),
+                                  void *pCallbackParam,
+                                  size_t blockSizeBytes);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PRE-SHARED KEY GENERATION
  * -------------------------------------------------------------- */
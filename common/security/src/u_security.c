@@ -110,6 +110,20 @@
  *                           void *pDataOut,
  *                           size_t dataSizeBytes);
  *
+ * Perform end to end encryption on a stream of data (optional):
+ *
+ * int32_t uXxxSecE2eEncryptStream(int32_t handle,
+ *                                 int32_t (*pSourceCallback) (uDeviceHandle_t,
+ *                                                             char *,
+ *                                                             size_t,
+ *                                                             void *),
+ *                                 int32_t (*pSinkCallback) (uDeviceHandle_t,
+ *                                                           const char *,
+ *                                                           size_t,
+ *                                                           void *),
+ *                                 void *pCallbackParam,
+ *                                 size_t blockSizeBytes);
+ *
  * Set the end to end encryption version in use (optional):
  *
  * int32_t uXxxSecE2eSetVersion(int32_t handle,
@@ -133,15 +147,19 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcpy()
+#include "stdlib.h"    // malloc(), free()
+#include "string.h"    // memcpy(), memcmp(), memset()
 
 #include "u_error_common.h"
 
+#include "u_port_os.h"
+
 #include "u_device_shared.h"
 
 #include "u_cell_sec.h"
 
 #include "u_security.h"
+#include "u_security_shared.h"
 #include "u_at_client.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
@@ -150,18 +168,389 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** A marker for a valid ZTP cache header.
+ */
+#define U_SECURITY_ZTP_CACHE_MAGIC 0x5A545043
+
+/** The initial value of a 32-bit FNV-1a hash.
+ */
+#define U_SECURITY_FNV1A_32_OFFSET_BASIS 0x811c9dc5UL
+
+/** The multiplier for a 32-bit FNV-1a hash.
+ */
+#define U_SECURITY_FNV1A_32_PRIME 0x01000193UL
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The header at the start of a cached ZTP item, followed by
+ * the item itself, including its null terminator.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t sizeBytes;
+    uint32_t checksum;
+    uint32_t key; /**< the key of the cache when the item was written. */
+} uSecurityZtpCacheHeader_t;
+
+/** The ZTP cache for a device.
+ */
+typedef struct uSecurityZtpCache_t {
+    uDeviceHandle_t devHandle;
+    uSecurityZtpCacheStore_t store;
+    char *pRam[U_SECURITY_ZTP_TYPE_MAX_NUM]; /**< used if no store was provided. */
+    size_t ramSizeBytes[U_SECURITY_ZTP_TYPE_MAX_NUM];
+    int32_t sizeBytes[U_SECURITY_ZTP_TYPE_MAX_NUM]; /**< as last read from the module, -1 if not known. */
+    bool keyValid; /**< true once key has been established from the module. */
+    uint32_t key; /**< a hash of the root of trust UID read from the module. */
+    struct uSecurityZtpCache_t *pNext;
+} uSecurityZtpCache_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** Root of the linked list of ZTP caches.
+ */
+static uSecurityZtpCache_t *gpZtpCacheList = NULL;
+
+/** Mutex to protect the ZTP caches, created by
+ * uSecuritySharedInit(); it is never held across an AT
+ * exchange.
+ */
+static uPortMutexHandle_t gZtpCacheMutex = NULL;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Find the ZTP cache for a device.
+static uSecurityZtpCache_t *pZtpCacheFind(uDeviceHandle_t devHandle)
+{
+    uSecurityZtpCache_t *pCache = gpZtpCacheList;
+
+    while ((pCache != NULL) && (pCache->devHandle != devHandle)) {
+        pCache = pCache->pNext;
+    }
+
+    return pCache;
+}
+
+// Free any RAM used by a ZTP cache.
+static void ztpCacheRamFree(uSecurityZtpCache_t *pCache)
+{
+    for (size_t x = 0; x < U_SECURITY_ZTP_TYPE_MAX_NUM; x++) {
+        free(pCache->pRam[x]);
+        pCache->pRam[x] = NULL;
+        pCache->ramSizeBytes[x] = 0;
+    }
+}
+
+// Read callback for the RAM store.
+static int32_t ztpCacheRamRead(uDeviceHandle_t devHandle,
+                               uSecurityZtpType_t type,
+                               size_t offset, char *pData,
+                               size_t dataSizeBytes, void *pParam)
+{
+    uSecurityZtpCache_t *pCache = (uSecurityZtpCache_t *) pParam;
+    size_t sizeBytes = 0;
+
+    (void) devHandle;
+
+    if (offset < pCache->ramSizeBytes[type]) {
+        sizeBytes = pCache->ramSizeBytes[type] - offset;
+        if (sizeBytes > dataSizeBytes) {
+            sizeBytes = dataSizeBytes;
+        }
+        memcpy(pData, pCache->pRam[type] + offset, sizeBytes);
+    }
+
+    return (int32_t) sizeBytes;
+}
+
+// Write callback for the RAM store.
+static int32_t ztpCacheRamWrite(uDeviceHandle_t devHandle,
+                                uSecurityZtpType_t type,
+                                size_t offset, const char *pData,
+                                size_t dataSizeBytes, void *pParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uSecurityZtpCache_t *pCache = (uSecurityZtpCache_t *) pParam;
+    char *pTmp;
+
+    (void) devHandle;
+
+    if (offset + dataSizeBytes > pCache->ramSizeBytes[type]) {
+        pTmp = (char *) realloc(pCache->pRam[type], offset + dataSizeBytes);
+        if (pTmp != NULL) {
+            pCache->pRam[type] = pTmp;
+            pCache->ramSizeBytes[type] = offset + dataSizeBytes;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+    }
+    if (errorCode == 0) {
+        memcpy(pCache->pRam[type] + offset, pData, dataSizeBytes);
+    }
+
+    return errorCode;
+}
+
+// Add data to a 32-bit FNV-1a hash.
+static uint32_t fnv1a32(uint32_t hash, const char *pData, size_t dataSizeBytes)
+{
+    for (size_t x = 0; x < dataSizeBytes; x++) {
+        hash ^= (uint8_t) *(pData + x);
+        hash *= U_SECURITY_FNV1A_32_PRIME;
+    }
+
+    return hash;
+}
+
+// Read a ZTP item from the module, no caching.
+static int32_t ztpGetUncached(uDeviceHandle_t devHandle,
+                              uSecurityZtpType_t type,
+                              char *pData, size_t dataSizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+
+    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+        switch (type) {
+            case U_SECURITY_ZTP_TYPE_PRIVATE_KEY:
+                errorCodeOrSize = uCellSecZtpGetPrivateKey(devHandle,
+                                                           pData,
+                                                           dataSizeBytes);
+                break;
+            case U_SECURITY_ZTP_TYPE_DEVICE_CERTIFICATE:
+                errorCodeOrSize = uCellSecZtpGetDeviceCertificate(devHandle,
+                                                                  pData,
+                                                                  dataSizeBytes);
+                break;
+            case U_SECURITY_ZTP_TYPE_CERTIFICATE_AUTHORITIES:
+                errorCodeOrSize = uCellSecZtpGetCertificateAuthorities(devHandle,
+                                                                       pData,
+                                                                       dataSizeBytes);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Read a ZTP item from the cache into pData, which must be
+// at least the size of the item, returning the size or
+// negative error code if the cached item is not valid.
+// pHeader must have been read from the cache already.
+static int32_t ztpCacheRead(uSecurityZtpCache_t *pCache,
+                            uSecurityZtpType_t type,
+                            const uSecurityZtpCacheHeader_t *pHeader,
+                            char *pData)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uSecurityZtpCacheStore_t *pStore = &(pCache->store);
+    uint32_t checksum = U_SECURITY_FNV1A_32_OFFSET_BASIS;
+    size_t offset = 0;
+    size_t blockSizeBytes;
+    int32_t x;
+
+    while ((offset < pHeader->sizeBytes) && (errorCodeOrSize == 0)) {
+        blockSizeBytes = pHeader->sizeBytes - offset;
+        if (blockSizeBytes > U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES) {
+            blockSizeBytes = U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES;
+        }
+        x = pStore->pRead(pCache->devHandle, type,
+                          sizeof(*pHeader) + offset,
+                          pData + offset, blockSizeBytes,
+                          pStore->pParam);
+        if (x == (int32_t) blockSizeBytes) {
+            checksum = fnv1a32(checksum, pData + offset, blockSizeBytes);
+            offset += blockSizeBytes;
+        } else {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+    }
+    if ((errorCodeOrSize == 0) &&
+        ((checksum != pHeader->checksum) ||
+         (*(pData + pHeader->sizeBytes - 1) != 0))) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    }
+    if (errorCodeOrSize == 0) {
+        errorCodeOrSize = (int32_t) pHeader->sizeBytes;
+    }
+
+    return errorCodeOrSize;
+}
+
+// Write a ZTP item to the cache; the header is written
+// last so that the item is only valid once complete.
+static int32_t ztpCacheWrite(uSecurityZtpCache_t *pCache,
+                             uSecurityZtpType_t type,
+                             const char *pData, size_t dataSizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uSecurityZtpCacheStore_t *pStore = &(pCache->store);
+    uSecurityZtpCacheHeader_t header;
+    size_t offset = 0;
+    size_t blockSizeBytes;
+
+    memset(&header, 0, sizeof(header));
+    header.sizeBytes = (uint32_t) dataSizeBytes;
+    header.checksum = U_SECURITY_FNV1A_32_OFFSET_BASIS;
+    header.key = pCache->key;
+    // Invalidate whatever was there before
+    errorCode = pStore->pWrite(pCache->devHandle, type, 0,
+                               (const char *) &header, sizeof(header),
+                               pStore->pParam);
+    while ((offset < dataSizeBytes) && (errorCode == 0)) {
+        blockSizeBytes = dataSizeBytes - offset;
+        if (blockSizeBytes > U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES) {
+            blockSizeBytes = U_SECURITY_ZTP_CACHE_BLOCK_LENGTH_BYTES;
+        }
+        errorCode = pStore->pWrite(pCache->devHandle, type,
+                                   sizeof(header) + offset,
+                                   pData + offset, blockSizeBytes,
+                                   pStore->pParam);
+        header.checksum = fnv1a32(header.checksum, pData + offset, blockSizeBytes);
+        offset += blockSizeBytes;
+    }
+    if (errorCode == 0) {
+        header.magic = U_SECURITY_ZTP_CACHE_MAGIC;
+        errorCode = pStore->pWrite(pCache->devHandle, type, 0,
+                                   (const char *) &header, sizeof(header),
+                                   pStore->pParam);
+    }
+
+    return errorCode;
+}
+
+// Get a ZTP item from the cache into pData, or just its size if
+// pData is NULL; gZtpCacheMutex must be locked.  Returns
+// the size or negative error code if the item is not there, is
+// not valid or is bigger than dataSizeBytes.
+static int32_t ztpCacheGet(uSecurityZtpCache_t *pCache,
+                           uSecurityZtpType_t type,
+                           char *pData, size_t dataSizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    uSecurityZtpCacheHeader_t header;
+
+    if (pCache->keyValid &&
+        (pCache->store.pRead(pCache->devHandle, type, 0, (char *) &header,
+                             sizeof(header),
+                             pCache->store.pParam) == (int32_t) sizeof(header)) &&
+        (header.magic == U_SECURITY_ZTP_CACHE_MAGIC) &&
+        (header.sizeBytes > 0) && (header.key == pCache->key)) {
+        if (pData == NULL) {
+            errorCodeOrSize = (int32_t) header.sizeBytes;
+        } else if (dataSizeBytes >= header.sizeBytes) {
+            errorCodeOrSize = ztpCacheRead(pCache, type, &header, pData);
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Read the key of the ZTP cache from the module: a hash of the
+// root of trust UID, which is unique to the module and costs one
+// short AT exchange, so that items cached from one module are never
+// returned for another.  A module that is not sealed has no ZTP
+// items and hence no key.
+static int32_t ztpCacheKeyRead(uDeviceHandle_t devHandle, uint32_t *pKey)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    char rootOfTrustUid[U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES];
+
+    if (uSecurityIsSealed(devHandle) &&
+        (uSecurityGetRootOfTrustUid(devHandle, rootOfTrustUid) > 0)) {
+        *pKey = fnv1a32(U_SECURITY_FNV1A_32_OFFSET_BASIS,
+                        rootOfTrustUid, sizeof(rootOfTrustUid));
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Read a ZTP item, from the cache if possible.  The cache is
+// only touched with gZtpCacheMutex locked and that lock is
+// never held while talking to the module, since the cache
+// may be disabled in the meantime it is looked up again
+// each time.
+static int32_t ztpGet(uDeviceHandle_t devHandle,
+                      uSecurityZtpType_t type,
+                      char *pData, size_t dataSizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    uSecurityZtpCache_t *pCache;
+    bool cacheEnabled = false;
+    bool keyValid = false;
+    uint32_t key;
+
+    if (gZtpCacheMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gZtpCacheMutex);
+
+        pCache = pZtpCacheFind(devHandle);
+        if (pCache != NULL) {
+            cacheEnabled = true;
+            keyValid = pCache->keyValid;
+            errorCodeOrSize = ztpCacheGet(pCache, type, pData, dataSizeBytes);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gZtpCacheMutex);
+    }
+
+    if (cacheEnabled && !keyValid &&
+        (ztpCacheKeyRead(devHandle, &key) == 0)) {
+        // First read of an item since the cache was enabled:
+        // now that we have the key we know whether what is
+        // in the cache belongs to the module as it is now
+        U_PORT_MUTEX_LOCK(gZtpCacheMutex);
+
+        pCache = pZtpCacheFind(devHandle);
+        if (pCache != NULL) {
+            pCache->key = key;
+            pCache->keyValid = true;
+            errorCodeOrSize = ztpCacheGet(pCache, type, pData, dataSizeBytes);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gZtpCacheMutex);
+    }
+
+    if (errorCodeOrSize < 0) {
+        // Not cached, or not cached correctly, or the caller's
+        // buffer is smaller than the item: read from the module
+        errorCodeOrSize = ztpGetUncached(devHandle, type, pData, dataSizeBytes);
+        if (cacheEnabled && (errorCodeOrSize > 0)) {
+
+            U_PORT_MUTEX_LOCK(gZtpCacheMutex);
+
+            pCache = pZtpCacheFind(devHandle);
+            if (pCache != NULL) {
+                if (pData == NULL) {
+                    // Remember the size so that we know when
+                    // a read is complete
+                    pCache->sizeBytes[type] = errorCodeOrSize;
+                } else if ((errorCodeOrSize < (int32_t) dataSizeBytes) ||
+                           (errorCodeOrSize == pCache->sizeBytes[type])) {
+                    // We have the whole item
+                    if (pCache->keyValid) {
+                        // Cache it; not a problem for the
+                        // caller if this fails
+                        ztpCacheWrite(pCache, type, pData, errorCodeOrSize);
+                    }
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(gZtpCacheMutex);
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INFORMATION
  * -------------------------------------------------------------- */
@@ -330,15 +719,7 @@ int32_t uSecurityZtpGetDeviceCertificate(uDeviceHandle_t devHandle,
                                          char *pData,
                                          size_t dataSizeBytes)
 {
-    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
-
-    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
-        errorCodeOrSize = uCellSecZtpGetDeviceCertificate(devHandle,
-                                                          pData,
-                                                          dataSizeBytes);
-    }
-
-    return errorCodeOrSize;
+    return ztpGet(devHandle, U_SECURITY_ZTP_TYPE_DEVICE_CERTIFICATE, pData, dataSizeBytes);
 }
 
 // Read the device private key generated during sealing.
@@ -346,15 +727,7 @@ int32_t uSecurityZtpGetPrivateKey(uDeviceHandle_t devHandle,
                                   char *pData,
                                   size_t dataSizeBytes)
 {
-    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
-
-    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
-        errorCodeOrSize = uCellSecZtpGetPrivateKey(devHandle,
-                                                   pData,
-                                                   dataSizeBytes);
-    }
-
-    return errorCodeOrSize;
+    return ztpGet(devHandle, U_SECURITY_ZTP_TYPE_PRIVATE_KEY, pData, dataSizeBytes);
 }
 
 // Read the certificate authorities used during sealing.
@@ -362,15 +735,87 @@ int32_t uSecurityZtpGetCertificateAuthorities(uDeviceHandle_t devHandle,
                                               char *pData,
                                               size_t dataSizeBytes)
 {
-    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+    return ztpGet(devHandle, U_SECURITY_ZTP_TYPE_CERTIFICATE_AUTHORITIES, pData, dataSizeBytes);
+}
 
-    if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
-        errorCodeOrSize = uCellSecZtpGetCertificateAuthorities(devHandle,
-                                                               pData,
-                                                               dataSizeBytes);
+// Enable caching of ZTP items.
+int32_t uSecurityZtpCacheEnable(uDeviceHandle_t devHandle,
+                                const uSecurityZtpCacheStore_t *pStore)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uSecurityZtpCache_t *pCache;
+
+    if (gZtpCacheMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gZtpCacheMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pStore == NULL) ||
+            ((pStore->pRead != NULL) && (pStore->pWrite != NULL))) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            pCache = pZtpCacheFind(devHandle);
+            if (pCache == NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pCache = (uSecurityZtpCache_t *) malloc(sizeof(*pCache));
+                if (pCache != NULL) {
+                    memset(pCache, 0, sizeof(*pCache));
+                    pCache->devHandle = devHandle;
+                    for (size_t x = 0; x < U_SECURITY_ZTP_TYPE_MAX_NUM; x++) {
+                        pCache->sizeBytes[x] = -1;
+                    }
+                    pCache->pNext = gpZtpCacheList;
+                    gpZtpCacheList = pCache;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            } else {
+                ztpCacheRamFree(pCache);
+                // The key is established again from the module
+                pCache->keyValid = false;
+            }
+            if (pCache != NULL) {
+                if (pStore != NULL) {
+                    pCache->store = *pStore;
+                } else {
+                    pCache->store.pRead = ztpCacheRamRead;
+                    pCache->store.pWrite = ztpCacheRamWrite;
+                    pCache->store.pParam = pCache;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gZtpCacheMutex);
     }
 
-    return errorCodeOrSize;
+    return errorCode;
+}
+
+// Disable caching of ZTP items.
+void uSecurityZtpCacheDisable(uDeviceHandle_t devHandle)
+{
+    uSecurityZtpCache_t *pCache;
+    uSecurityZtpCache_t *pPrevious = NULL;
+
+    if (gZtpCacheMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gZtpCacheMutex);
+
+        pCache = gpZtpCacheList;
+        while ((pCache != NULL) && (pCache->devHandle != devHandle)) {
+            pPrevious = pCache;
+            pCache = pCache->pNext;
+        }
+        if (pCache != NULL) {
+            if (pPrevious == NULL) {
+                gpZtpCacheList = pCache->pNext;
+            } else {
+                pPrevious->pNext = pCache->pNext;
+            }
+            ztpCacheRamFree(pCache);
+            free(pCache);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gZtpCacheMutex);
+    }
 }
 
 /* ----------------------------------------------------------------
@@ -424,6 +869,35 @@ int32_t uSecurityE2eEncrypt(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Ask a module to encrypt a stream of data.
+int32_t uSecurityE2eEncryptStream(uDeviceHandle_t devHandle,
+                                  int32_t (*pSourceCallback) (uDeviceHandle_t,
+                                                              char *,
+                                                              size_t,
+                                                              void *),
+                                  int32_t (*pSinkCallback) (uDeviceHandle_t,
+                                                            const char *,
+                                                            size_t,
+                                                            void *),
+                                  void *pCallbackParam,
+                                  size_t blockSizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pSourceCallback != NULL) && (pSinkCallback != NULL)) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+        if (U_DEVICE_IS_TYPE(devHandle, U_DEVICE_TYPE_CELL)) {
+            errorCodeOrSize = uCellSecE2eEncryptStream(devHandle,
+                                                       pSourceCallback,
+                                                       pSinkCallback,
+                                                       pCallbackParam,
+                                                       blockSizeBytes);
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: PRE-SHARED KEY GENERATION
  * -------------------------------------------------------------- */
@@ -464,4 +938,44 @@ int32_t uSecurityHeartbeatTrigger(uDeviceHandle_t devHandle)
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: SHARED INTERNALLY
+ * -------------------------------------------------------------- */
+
+// Initialise the internally shared security API.
+int32_t uSecuritySharedInit()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (gZtpCacheMutex == NULL) {
+        errorCode = uPortMutexCreate(&gZtpCacheMutex);
+    }
+
+    return errorCode;
+}
+
+// Deinitialise the internally shared security API.
+void uSecuritySharedDeinit()
+{
+    uSecurityZtpCache_t *pCache;
+
+    if (gZtpCacheMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gZtpCacheMutex);
+
+        // Free any caches the application didn't disable
+        while (gpZtpCacheList != NULL) {
+            pCache = gpZtpCacheList;
+            gpZtpCacheList = pCache->pNext;
+            ztpCacheRamFree(pCache);
+            free(pCache);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gZtpCacheMutex);
+
+        uPortMutexDelete(gZtpCacheMutex);
+        gZtpCacheMutex = NULL;
+    }
+}
+
 // End of file
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_SECURITY_SHARED_H_
+#define _U_SECURITY_SHARED_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines functions that do not form part
+ * of the security API but are shared internally, for use by the
+ * device API when it initialises and de-initialises itself.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Initialise the internally shared security API, creating the
+ * mutex that protects the ZTP caches: should be called by the
+ * device API when it initialises itself.
+ *
+ * @return  zero on success or negative error code.
+ */
+int32_t uSecuritySharedInit();
+
+/** De-initialise the internally shared security API, freeing any
+ * ZTP caches that are still enabled: should be called by the device
+ * API when it de-initialises itself.
+ */
+void uSecuritySharedDeinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_SECURITY_SHARED_H_
+
+// End of file
@@ -53,6 +53,15 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The FNV-1a 64-bit offset basis, the starting point of a settings
+ * hash.
+ */
+#define U_SECURITY_TLS_HASH_OFFSET_BASIS 0xcbf29ce484222325ULL
+
+/** The FNV-1a 64-bit prime.
+ */
+#define U_SECURITY_TLS_HASH_PRIME 0x100000001b3ULL
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -81,6 +90,82 @@ static int32_t init()
     return errorCode;
 }
 
+// Fold a block of data into a hash.
+static uint64_t hashAdd(uint64_t hash, const void *pData, size_t size)
+{
+    const uint8_t *pByte = (const uint8_t *) pData;
+
+    for (size_t x = 0; x < size; x++) {
+        hash ^= *pByte;
+        hash *= U_SECURITY_TLS_HASH_PRIME;
+        pByte++;
+    }
+
+    return hash;
+}
+
+// Fold an integer into a hash.
+static uint64_t hashAddInt(uint64_t hash, int32_t value)
+{
+    return hashAdd(hash, &value, sizeof(value));
+}
+
+// Fold a string into a hash, including the null terminator so that
+// adjacent strings cannot run into one another; NULL is hashed
+// differently to an empty string.
+static uint64_t hashAddString(uint64_t hash, const char *pString)
+{
+    hash = hashAddInt(hash, pString != NULL);
+    if (pString != NULL) {
+        hash = hashAdd(hash, pString, strlen(pString) + 1);
+    }
+
+    return hash;
+}
+
+// Fold a binary sequence into a hash.
+static uint64_t hashAddBinary(uint64_t hash, const uSecurityTlsBinary_t *pBinary)
+{
+    hash = hashAddInt(hash, pBinary->pBin != NULL);
+    hash = hashAddInt(hash, (int32_t) pBinary->size);
+    if (pBinary->pBin != NULL) {
+        hash = hashAdd(hash, pBinary->pBin, pBinary->size);
+    }
+
+    return hash;
+}
+
+// Hash the contents of a security configuration, which may be NULL;
+// the individual fields are hashed, rather than the structure as a
+// whole, so that padding and the values of pointers don't matter.
+static uint64_t settingsHash(const uSecurityTlsSettings_t *pSettings)
+{
+    uint64_t hash = U_SECURITY_TLS_HASH_OFFSET_BASIS;
+
+    hash = hashAddInt(hash, pSettings != NULL);
+    if (pSettings != NULL) {
+        hash = hashAddInt(hash, (int32_t) pSettings->tlsVersionMin);
+        hash = hashAddString(hash, pSettings->pRootCaCertificateName);
+        hash = hashAddString(hash, pSettings->pClientCertificateName);
+        hash = hashAddString(hash, pSettings->pClientPrivateKeyName);
+        hash = hashAddInt(hash, (int32_t) pSettings->certificateCheck);
+        hash = hashAddString(hash, pSettings->pClientPrivateKeyPassword);
+        hash = hashAddInt(hash, (int32_t) pSettings->cipherSuites.num);
+        for (size_t x = 0; x < pSettings->cipherSuites.num; x++) {
+            hash = hashAddInt(hash, (int32_t) pSettings->cipherSuites.suite[x]);
+        }
+        hash = hashAddBinary(hash, &(pSettings->psk));
+        hash = hashAddBinary(hash, &(pSettings->pskId));
+        hash = hashAddInt(hash, pSettings->pskGeneratedByRoT);
+        hash = hashAddString(hash, pSettings->pExpectedServerUrl);
+        hash = hashAddString(hash, pSettings->pSni);
+        hash = hashAddInt(hash, pSettings->useDeviceCertificate);
+        hash = hashAddInt(hash, pSettings->includeCaCertificates);
+    }
+
+    return hash;
+}
+
 // Check that a given security configuration contains no errors.
 static bool checkConfig(const uSecurityTlsSettings_t *pSettings)
 {
@@ -118,6 +203,77 @@ static bool checkConfig(const uSecurityTlsSettings_t *pSettings)
     return isGood;
 }
 
+// Apply the given settings to a cellular security context.
+static int32_t cellSettingsApply(const uCellSecTlsContext_t *pContext,
+                                 const uSecurityTlsSettings_t *pSettings)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (pSettings->tlsVersionMin != U_SECURITY_TLS_VERSION_ANY) {
+        // Set the TLS version (encoding is the
+        // same in cellular)
+        errorCode = uCellSecTlsVersionSet(pContext,
+                                          (int32_t) pSettings->tlsVersionMin);
+    }
+    if ((errorCode == 0) &&
+        (pSettings->pRootCaCertificateName != NULL)) {
+        // Set the root CA certificate name
+        errorCode = uCellSecTlsRootCaCertificateNameSet(pContext,
+                                                        pSettings->pRootCaCertificateName);
+    }
+    if ((errorCode == 0) &&
+        (pSettings->pClientCertificateName != NULL)) {
+        // Set the client certificate name
+        errorCode = uCellSecTlsClientCertificateNameSet(pContext,
+                                                        pSettings->pClientCertificateName);
+    }
+    if ((errorCode == 0) &&
+        (pSettings->pClientPrivateKeyName != NULL)) {
+        // Set the client private key name
+        errorCode = uCellSecTlsClientPrivateKeyNameSet(pContext,
+                                                       pSettings->pClientPrivateKeyName,
+                                                       pSettings->pClientPrivateKeyPassword);
+    }
+    if ((errorCode == 0) &&
+        (pSettings->cipherSuites.num > 0)) {
+        // Set the cipher suites
+        for (size_t x = 0; (x < pSettings->cipherSuites.num) &&
+             (errorCode == 0); x++) {
+            errorCode = uCellSecTlsCipherSuiteAdd(pContext,
+                                                  (int32_t) pSettings->cipherSuites.suite[x]);
+        }
+    }
+    if ((errorCode == 0) &&
+        (((pSettings->psk.pBin != NULL) && (pSettings->psk.size > 0) &&
+          (pSettings->pskId.pBin != NULL) && (pSettings->pskId.size > 0)) ||
+         pSettings->pskGeneratedByRoT)) {
+        // Set the pre-shared key and accompanying ID
+        errorCode = uCellSecTlsClientPskSet(pContext,
+                                            pSettings->psk.pBin, pSettings->psk.size,
+                                            pSettings->pskId.pBin, pSettings->pskId.size,
+                                            pSettings->pskGeneratedByRoT);
+    }
+    if (errorCode == 0) {
+        // Set the certificate checking
+        errorCode = uCellSecTlsCertificateCheckSet(pContext,
+                                                   (uCellSecTlsCertficateCheck_t) pSettings->certificateCheck,
+                                                   pSettings->pExpectedServerUrl);
+    }
+    if ((errorCode == 0) && (pSettings->pSni != NULL)) {
+        // Set the Server Name Indication string
+        errorCode = uCellSecTlsSniSet(pContext,
+                                      pSettings->pSni);
+    }
+    if ((errorCode == 0) && (pSettings->useDeviceCertificate)) {
+        // Set that the device certificate from security sealing
+        // should be used as the client certificate
+        errorCode = uCellSecTlsUseDeviceCertificateSet(pContext,
+                                                       pSettings->includeCaCertificates);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -134,6 +290,8 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
     const char *pClientPrivateKeyName = NULL;
     bool certificateCheckOn = false;
     uSecurityTlsVersion_t tlsVersionMin = U_SECURITY_TLS_VERSION_ANY;
+    uint64_t cacheKey;
+    bool cacheable;
 
     if ((errorCode == 0) && (pContext != NULL)) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
@@ -175,75 +333,32 @@ uSecurityTlsContext_t *pUSecurityTlsAdd(uDeviceHandle_t devHandle,
                 }
             } else if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
                 errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                // Allocate a cellular security context with
-                // default settings
-                pNetworkSpecific = (void *) pUCellSecSecTlsAdd(devHandle);
+                // A profile generated by the root of trust must always
+                // be created afresh, anything else may be re-used
+                cacheable = (pSettings == NULL) || !pSettings->pskGeneratedByRoT;
+                cacheKey = settingsHash(pSettings);
+                if (cacheable) {
+                    // If a security profile with these settings is already
+                    // programmed into the module, just use that
+                    pNetworkSpecific = (void *) pUCellSecSecTlsReuse(devHandle, cacheKey);
+                }
                 if (pNetworkSpecific == NULL) {
-                    errorCode = uCellSecTlsResetLastError();
-                } else {
-                    if (pSettings != NULL) {
-                        // Looks like some specific settings have been
-                        // requested: set them
-                        if (pSettings->tlsVersionMin != U_SECURITY_TLS_VERSION_ANY) {
-                            // Set the TLS version (encoding is the
-                            // same in cellular)
-                            errorCode = uCellSecTlsVersionSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                              (int32_t) pSettings->tlsVersionMin);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->pRootCaCertificateName != NULL)) {
-                            // Set the root CA certificate name
-                            errorCode = uCellSecTlsRootCaCertificateNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                            pSettings->pRootCaCertificateName);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->pClientCertificateName != NULL)) {
-                            // Set the client certificate name
-                            errorCode = uCellSecTlsClientCertificateNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                            pSettings->pClientCertificateName);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->pClientPrivateKeyName != NULL)) {
-                            // Set the client private key name
-                            errorCode = uCellSecTlsClientPrivateKeyNameSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                           pSettings->pClientPrivateKeyName,
-                                                                           pSettings->pClientPrivateKeyPassword);
-                        }
-                        if ((errorCode == 0) &&
-                            (pSettings->cipherSuites.num > 0)) {
-                            // Set the cipher suites
-                            for (size_t x = 0; (x < pSettings->cipherSuites.num) &&
-                                 (errorCode == 0); x++) {
-                                errorCode = uCellSecTlsCipherSuiteAdd((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                      (int32_t) pSettings->cipherSuites.suite[x]);
-                            }
-                        }
-                        if ((errorCode == 0) &&
-                            (((pSettings->psk.pBin != NULL) && (pSettings->psk.size > 0) &&
-                              (pSettings->pskId.pBin != NULL) && (pSettings->pskId.size > 0)) ||
-                             pSettings->pskGeneratedByRoT)) {
-                            // Set the pre-shared key and accompanying ID
-                            errorCode = uCellSecTlsClientPskSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                pSettings->psk.pBin, pSettings->psk.size,
-                                                                pSettings->pskId.pBin, pSettings->pskId.size,
-                                                                pSettings->pskGeneratedByRoT);
-                        }
-                        if (errorCode == 0) {
-                            // Set the certificate checking
-                            errorCode = uCellSecTlsCertificateCheckSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                       (uCellSecTlsCertficateCheck_t) pSettings->certificateCheck,
-                                                                       pSettings->pExpectedServerUrl);
-                        }
-                        if ((errorCode == 0) && (pSettings->pSni != NULL)) {
-                            // Set the Server Name Indication string
-                            errorCode = uCellSecTlsSniSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                          pSettings->pSni);
+                    // Allocate a cellular security context with
+                    // default settings
+                    pNetworkSpecific = (void *) pUCellSecSecTlsAdd(devHandle);
+                    if (pNetworkSpecific == NULL) {
+                        errorCode = uCellSecTlsResetLastError();
+                    } else {
+                        if (pSettings != NULL) {
+                            // Looks like some specific settings have been
+                            // requested: set them
+                            errorCode = cellSettingsApply((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                          pSettings);
                         }
-                        if ((errorCode == 0) && (pSettings->useDeviceCertificate)) {
-                            // Set that the device certificate from security sealing
-                            // should be used as the client certificate
-                            errorCode = uCellSecTlsUseDeviceCertificateSet((uCellSecTlsContext_t *) pNetworkSpecific,
-                                                                           pSettings->includeCaCertificates);
+                        if ((errorCode == 0) && cacheable) {
+                            // Keep the profile for next time
+                            errorCode = uCellSecTlsCache((uCellSecTlsContext_t *) pNetworkSpecific,
+                                                         cacheKey);
                         }
                     }
                 }
@@ -144,10 +144,28 @@ extern void uAtClientDetailedDebugPrint();
 
 #endif
 
+/** The number of times gAllChars is sent through the streamed
+ * end to end encryption test.
+ */
+#define U_SECURITY_TEST_E2E_STREAM_REPEATS 4
+
+/** The block size to use in the streamed end to end encryption
+ * test, deliberately not a factor of the length of gAllChars.
+ */
+#define U_SECURITY_TEST_E2E_STREAM_BLOCK_LENGTH_BYTES 100
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** State for the streamed end to end encryption test.
+ */
+typedef struct {
+    size_t inOffset;  /**< offset into the repeated gAllChars. */
+    size_t numBlocks; /**< the number of blocks received. */
+    size_t outSize;   /**< the total number of bytes received. */
+} uSecurityTestE2eStream_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -222,6 +240,39 @@ static bool keepGoingCallback()
 }
 #endif
 
+// Source callback for the streamed end to end encryption test,
+// providing U_SECURITY_TEST_E2E_STREAM_REPEATS copies of gAllChars.
+static int32_t e2eStreamSource(uDeviceHandle_t devHandle, char *pBuffer,
+                               size_t size, void *pParam)
+{
+    uSecurityTestE2eStream_t *pStream = (uSecurityTestE2eStream_t *) pParam;
+    size_t total = sizeof(gAllChars) * U_SECURITY_TEST_E2E_STREAM_REPEATS;
+    size_t x = 0;
+
+    (void) devHandle;
+    while ((x < size) && (pStream->inOffset < total)) {
+        *(pBuffer + x) = gAllChars[pStream->inOffset % sizeof(gAllChars)];
+        (pStream->inOffset)++;
+        x++;
+    }
+
+    return (int32_t) x;
+}
+
+// Sink callback for the streamed end to end encryption test.
+static int32_t e2eStreamSink(uDeviceHandle_t devHandle, const char *pData,
+                             size_t size, void *pParam)
+{
+    uSecurityTestE2eStream_t *pStream = (uSecurityTestE2eStream_t *) pParam;
+
+    (void) devHandle;
+    (void) pData;
+    (pStream->numBlocks)++;
+    pStream->outSize += size;
+
+    return 0;
+}
+
 // Standard preamble for all security tests
 static uNetworkTestList_t *pStdPreamble()
 {
@@ -1030,6 +1081,9 @@ U_PORT_TEST_FUNCTION("[security]", "securityE2eEncryption")
     void *pData;
     int32_t version;
     int32_t headerLengthBytes = U_SECURITY_E2E_V1_HEADER_LENGTH_BYTES;
+    uSecurityTestE2eStream_t stream;
+    size_t numBlocks;
+    int32_t startTimeMs;
 
     // Do the standard preamble to make sure there is
     // a network underneath us
@@ -1105,6 +1159,27 @@ U_PORT_TEST_FUNCTION("[security]", "securityE2eEncryption")
                 //lint -e(668) Suppress possible NULL pointer, it is checked above
                 U_PORT_TEST_ASSERT(memcmp(pData, gAllChars, sizeof(gAllChars)) != 0);
                 free(pData);
+
+                // Now do the same thing again, many times over, as a stream
+                memset(&stream, 0, sizeof(stream));
+                numBlocks = ((sizeof(gAllChars) * U_SECURITY_TEST_E2E_STREAM_REPEATS) +
+                             U_SECURITY_TEST_E2E_STREAM_BLOCK_LENGTH_BYTES - 1) /
+                            U_SECURITY_TEST_E2E_STREAM_BLOCK_LENGTH_BYTES;
+                U_TEST_PRINT_LINE("requesting end to end encryption of %d byte(s)"
+                                  " of data as a stream of %d block(s)...",
+                                  sizeof(gAllChars) * U_SECURITY_TEST_E2E_STREAM_REPEATS,
+                                  numBlocks);
+                startTimeMs = uPortGetTickTimeMs();
+                y = uSecurityE2eEncryptStream(devHandle, e2eStreamSource,
+                                              e2eStreamSink, &stream,
+                                              U_SECURITY_TEST_E2E_STREAM_BLOCK_LENGTH_BYTES);
+                U_TEST_PRINT_LINE("%d byte(s) of data returned in %d block(s), took %d ms.",
+                                  y, stream.numBlocks, uPortGetTickTimeMs() - startTimeMs);
+                U_PORT_TEST_ASSERT(stream.numBlocks == numBlocks);
+                U_PORT_TEST_ASSERT(y == (int32_t) stream.outSize);
+                U_PORT_TEST_ASSERT(y == (int32_t) ((sizeof(gAllChars) *
+                                                    U_SECURITY_TEST_E2E_STREAM_REPEATS) +
+                                                   (numBlocks * headerLengthBytes)));
             } else {
                 U_TEST_PRINT_LINE("this device supports u-blox security but has not"
                                   " been security sealed, no testing of end to end"
@@ -1271,6 +1346,8 @@ U_PORT_TEST_FUNCTION("[security]", "securityZtp")
     int32_t z;
     int32_t heapUsed;
     char *pData;
+    char *pDataCached;
+    int32_t startTimeMs;
 #ifdef U_CFG_TEST_SECURITY_C2C_TE_SECRET
     char key[U_SECURITY_C2C_ENCRYPTION_KEY_LENGTH_BYTES];
     char hmac[U_SECURITY_C2C_HMAC_TAG_LENGTH_BYTES];
@@ -1325,6 +1402,28 @@ U_PORT_TEST_FUNCTION("[security]", "securityZtp")
                     // Can't really check the data but can check that it is
                     // of the correct length
                     U_PORT_TEST_ASSERT(strlen(pData) == z - 1);
+                    // Now do it again with the cache enabled: the first read
+                    // fills the cache, the second should come from it and
+                    // the result should be the same
+                    U_TEST_PRINT_LINE("reading device public X.509 certificate"
+                                      " with the cache enabled...");
+                    U_PORT_TEST_ASSERT(uSecurityZtpCacheEnable(devHandle, NULL) == 0);
+                    pDataCached = (char *) malloc(y);
+                    U_PORT_TEST_ASSERT(pDataCached != NULL);
+                    for (size_t x = 0; x < 2; x++) {
+                        //lint -e(668) Suppress possible use of NULL pointer for pDataCached
+                        memset(pDataCached, 0, y);
+                        z = uSecurityZtpGetDeviceCertificate(devHandle, NULL, 0);
+                        U_PORT_TEST_ASSERT(z == y);
+                        startTimeMs = uPortGetTickTimeMs();
+                        z = uSecurityZtpGetDeviceCertificate(devHandle, pDataCached, y);
+                        U_TEST_PRINT_LINE("read %d: %d byte(s) took %d ms.", x + 1, z,
+                                          uPortGetTickTimeMs() - startTimeMs);
+                        U_PORT_TEST_ASSERT(z == y);
+                        U_PORT_TEST_ASSERT(memcmp(pDataCached, pData, y) == 0);
+                    }
+                    uSecurityZtpCacheDisable(devHandle);
+                    free(pDataCached);
                     free(pData);
                 } else {
                     U_TEST_PRINT_LINE("module does not support reading device public certificate.");
@@ -1346,6 +1445,23 @@ U_PORT_TEST_FUNCTION("[security]", "securityZtp")
                     // Can't really check the data but can check that it is
                     // of the correct length
                     U_PORT_TEST_ASSERT(strlen(pData) == z - 1);
+                    // Read it through the cache: the first read fills the
+                    // cache, the second should come from it
+                    U_PORT_TEST_ASSERT(uSecurityZtpCacheEnable(devHandle, NULL) == 0);
+                    pDataCached = (char *) malloc(y);
+                    U_PORT_TEST_ASSERT(pDataCached != NULL);
+                    for (size_t x = 0; x < 2; x++) {
+                        //lint -e(668) Suppress possible use of NULL pointer for pDataCached
+                        memset(pDataCached, 0, y);
+                        startTimeMs = uPortGetTickTimeMs();
+                        z = uSecurityZtpGetPrivateKey(devHandle, pDataCached, y);
+                        U_TEST_PRINT_LINE("read %d: %d byte(s) took %d ms.", x + 1, z,
+                                          uPortGetTickTimeMs() - startTimeMs);
+                        U_PORT_TEST_ASSERT(z == y);
+                        U_PORT_TEST_ASSERT(memcmp(pDataCached, pData, y) == 0);
+                    }
+                    uSecurityZtpCacheDisable(devHandle);
+                    free(pDataCached);
                     free(pData);
                 } else {
                     U_TEST_PRINT_LINE("module does not support reading device private key.");
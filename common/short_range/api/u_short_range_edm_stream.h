@@ -162,6 +162,39 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
                                   const void *pBuffer, size_t sizeBytes,
                                   uint32_t timeoutMs);
 
+/** Write a large amount of data to the given interface on given
+ * channel.  The data is framed into EDM data packets that are as
+ * large as possible, as many as fit into a transmit buffer of
+ * txBufferSizeBytes, and each transmit buffer is sent to the UART
+ * in one write.  Where the platform supports uPortUartWriteAsync()
+ * two transmit buffers are used, one being framed while the other
+ * is sent.  The stream is only locked while each transmit buffer
+ * is handed to the UART, not for the whole transfer, so AT
+ * commands and data on other channels may be interleaved.  Will
+ * block until all of the data has been written or an error has
+ * occurred.
+ *
+ * @param handle            the handle of the stream instance.
+ * @param channel           the number of for the connection channel
+ *                          given in the connected event callback.
+ * @param[in] pBuffer       a pointer to a buffer of data to send.
+ * @param sizeBytes         the number of bytes in pBuffer.
+ * @param txBufferSizeBytes the size of each transmit buffer,
+ *                          allocated from the heap for the duration
+ *                          of the call; must be larger than
+ *                          #U_SHORT_RANGE_EDM_DATA_OVERHEAD.
+ * @param timeoutMs         timeout in ms. If timeout is reached,
+ *                          sending is interrupted and the actual
+ *                          number of bytes sent returned.  Reaching
+ *                          timeout is not considered an error.
+ * @return                  the number of bytes sent or negative
+ *                          error code.
+ */
+int32_t uShortRangeEdmStreamWriteBulk(int32_t handle, int32_t channel,
+                                      const void *pBuffer, size_t sizeBytes,
+                                      size_t txBufferSizeBytes,
+                                      uint32_t timeoutMs);
+
 /** Set a callback to be called when an AT event occurs.
  * pFunction will be called asynchronously in its own task.
  *
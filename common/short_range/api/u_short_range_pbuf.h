@@ -56,6 +56,7 @@ extern "C" {
 typedef U_PACKED_STRUCT(uShortRangePbuf_t) {
     struct uShortRangePbuf_t *pNext; /**< Used for linked list of pBuf */
     uint16_t length; /**< Number of used bytes in the data buffer */
+    uint16_t offset; /**< Index of the first unconsumed byte in the data buffer */
     char data[];  /**< Data buffer */
 } uShortRangePbuf_t;
 #ifdef _MSC_VER
@@ -148,6 +149,29 @@ int32_t uShortRangePbufListAppend(uShortRangePbufList_t *pBufList, uShortRangePb
  */
 size_t uShortRangePbufListConsumeData(uShortRangePbufList_t *pBufList, char *pData, size_t len);
 
+/** Get a pointer to the first contiguous segment of unconsumed data
+ *  in a pbuf list without copying it.  The data remains in the pbuf
+ *  list until it is released with uShortRangePbufListRelease().
+ *
+ * @param[in] pBufList pointer to the pbuf list.
+ * @param[out] ppData  on return this will point to the start of the
+ *                     segment, NULL if there is no data.
+ * @return             the length of the segment.
+ */
+size_t uShortRangePbufListPeek(const uShortRangePbufList_t *pBufList, const char **ppData);
+
+/** Release data from the start of a pbuf list, e.g. after it has been
+ *  handled in place using uShortRangePbufListPeek(); any pbufs that
+ *  become empty are put back in the pool.
+ *
+ * @param[in,out] pBufList pointer to the pbuf list.
+ * @param len              the number of bytes to release.
+ * @return                 the number of bytes released, which will be
+ *                         less than len if there was less data in
+ *                         the pbuf list.
+ */
+size_t uShortRangePbufListRelease(uShortRangePbufList_t *pBufList, size_t len);
+
 /** Link a new pbuf list to the existing pbuf list.
  *  The pointer allocated for the new pbuf list from the pbuf list pool
  *  will be added to its free list.
@@ -215,6 +215,19 @@ static void flushUart(int32_t uartHandle);
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
 static inline void dumpAtData(const char *pBuffer, size_t length)
 {
+# ifdef U_CFG_LOG_BINARY
+    // Log in chunks rather than a binary log record per character
+    size_t x;
+    while (length > 0) {
+        x = length;
+        if (x > U_LOG_BINARY_STRING_MAX_LENGTH_BYTES) {
+            x = U_LOG_BINARY_STRING_MAX_LENGTH_BYTES;
+        }
+        uPortLog("%.*s", (int) x, pBuffer);
+        pBuffer += x;
+        length -= x;
+    }
+# else
     for (int i = 0; i < length; i++) {
         char ch = pBuffer[i];
         if (isprint((int32_t) ch)) {
@@ -227,6 +240,7 @@ static inline void dumpAtData(const char *pBuffer, size_t length)
             uPortLog("\\x%02x", ch);
         }
     }
+# endif
 }
 
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG_DUMP_DATA
@@ -846,6 +860,41 @@ static int32_t uartWrite(const void *pData, size_t length)
                           pData, length);
 }
 
+// Frame as much of pData as will fit into pTxBuffer as a sequence
+// of EDM data packets, each carrying up to maxPayload bytes.
+// Returns the number of bytes of pData that were framed,
+// *pTxLength being set to the number of bytes put in pTxBuffer.
+static size_t frameBulk(uint8_t channel, size_t maxPayload,
+                        const char *pData, size_t sizeBytes,
+                        char *pTxBuffer, size_t txBufferSizeBytes,
+                        size_t *pTxLength)
+{
+    size_t framed = 0;
+    size_t txLength = 0;
+    size_t payload;
+
+    while ((framed < sizeBytes) &&
+           (txBufferSizeBytes - txLength > U_SHORT_RANGE_EDM_DATA_OVERHEAD)) {
+        payload = txBufferSizeBytes - txLength - U_SHORT_RANGE_EDM_DATA_OVERHEAD;
+        if (payload > sizeBytes - framed) {
+            payload = sizeBytes - framed;
+        }
+        if (payload > maxPayload) {
+            payload = maxPayload;
+        }
+        txLength += uShortRangeEdmZeroCopyHeadData(channel, (uint32_t) payload,
+                                                   pTxBuffer + txLength);
+        memcpy(pTxBuffer + txLength, pData + framed, payload);
+        txLength += payload;
+        txLength += uShortRangeEdmZeroCopyTail(pTxBuffer + txLength);
+        framed += payload;
+    }
+
+    *pTxLength = txLength;
+
+    return framed;
+}
+
 // Do an EDM send.  Returns the amount written, including
 // EDM packet overhead.
 static int32_t edmSend(const uShortRangeEdmStreamInstance_t *pEdmStream)
@@ -1436,6 +1485,131 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
     return sizeOrErrorCode;
 }
 
+int32_t uShortRangeEdmStreamWriteBulk(int32_t handle, int32_t channel,
+                                      const void *pBuffer, size_t sizeBytes,
+                                      size_t txBufferSizeBytes,
+                                      uint32_t timeoutMs)
+{
+    int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uShortRangeEdmStreamConnections_t *pConnection;
+    int32_t uartHandle = -1;
+    size_t maxPayload = U_SHORT_RANGE_EDM_MAX_SIZE;
+    char *pTxBuffer[2] = {NULL, NULL};
+    size_t numTxBuffers = 1;
+    size_t txBufferIndex = 0;
+    bool async = false;
+    size_t sent = 0;
+    size_t framed;
+    size_t txLength;
+    int64_t startTime;
+    int32_t x;
+
+    if (gMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
+        sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        if (gEdmStream.handle == handle && channel >= 0 &&
+            pBuffer != NULL && sizeBytes != 0 &&
+            txBufferSizeBytes > U_SHORT_RANGE_EDM_DATA_OVERHEAD) {
+            pConnection = findConnection(channel);
+            if (pConnection != NULL) {
+                uartHandle = gEdmStream.uartHandle;
+                if ((pConnection->type == U_SHORT_RANGE_CONNECTION_TYPE_BT) &&
+                    (pConnection->bt.frameSize > 0) &&
+                    ((size_t) pConnection->bt.frameSize < maxPayload)) {
+                    maxPayload = pConnection->bt.frameSize;
+                }
+                sizeOrErrorCode = 0;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    if (sizeOrErrorCode == 0) {
+        // If the UART can write asynchronously then use two
+        // buffers, framing into one while the other is sent
+        if (uPortUartWriteAsyncGetPending(uartHandle) >= 0) {
+            async = true;
+            numTxBuffers = 2;
+        }
+        for (size_t y = 0; (y < numTxBuffers) && (sizeOrErrorCode == 0); y++) {
+            pTxBuffer[y] = (char *) malloc(txBufferSizeBytes);
+            if (pTxBuffer[y] == NULL) {
+                sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+            }
+        }
+
+        startTime = uPortGetTickTimeMs();
+        while ((sizeOrErrorCode == 0) && (sent < sizeBytes) &&
+               (uPortGetTickTimeMs() - startTime < timeoutMs)) {
+            if (async) {
+                // Asynchronous writes complete in order so, if no more
+                // than one is outstanding, the buffer we're about
+                // to frame into is no longer in use
+                while ((uPortUartWriteAsyncGetPending(uartHandle) > 1) &&
+                       (uPortGetTickTimeMs() - startTime < timeoutMs)) {
+                    uPortTaskBlock(1);
+                }
+                if (uPortUartWriteAsyncGetPending(uartHandle) > 1) {
+                    break;
+                }
+            }
+
+            framed = frameBulk((uint8_t) channel, maxPayload,
+                               (const char *) pBuffer + sent, sizeBytes - sent,
+                               pTxBuffer[txBufferIndex], txBufferSizeBytes,
+                               &txLength);
+
+#ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
+            uEdmChLogLine(LOG_CH_DATA, "TX bulk (%d bytes in %d)", (int) framed,
+                          (int) txLength);
+#endif
+
+            U_PORT_MUTEX_LOCK(gMutex);
+            // The lock was released since the last write so check
+            // that the connection is still there
+            if (findConnection(channel) == NULL) {
+                sizeOrErrorCode = (int32_t)U_ERROR_COMMON_DEVICE_ERROR;
+            } else if (async) {
+                x = uPortUartWriteAsync(uartHandle, pTxBuffer[txBufferIndex], txLength);
+                if (x < 0) {
+                    sizeOrErrorCode = (int32_t)U_ERROR_COMMON_DEVICE_ERROR;
+                }
+            } else {
+                x = uartWrite(pTxBuffer[txBufferIndex], txLength);
+                if (x != (int32_t) txLength) {
+                    sizeOrErrorCode = (int32_t)U_ERROR_COMMON_DEVICE_ERROR;
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(gMutex);
+
+            if (sizeOrErrorCode == 0) {
+                sent += framed;
+                txBufferIndex++;
+                if (txBufferIndex >= numTxBuffers) {
+                    txBufferIndex = 0;
+                }
+            }
+        }
+
+        if (async) {
+            // The buffers can't be freed until the UART
+            // has finished with them
+            while (uPortUartWriteAsyncGetPending(uartHandle) > 0) {
+                uPortTaskBlock(1);
+            }
+        }
+        for (size_t y = 0; y < numTxBuffers; y++) {
+            free(pTxBuffer[y]);
+        }
+
+        if (sizeOrErrorCode == 0) {
+            sizeOrErrorCode = (int32_t) sent;
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
 int32_t uShortRangeEdmStreamAtEventSend(int32_t handle, uint32_t eventBitMap)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
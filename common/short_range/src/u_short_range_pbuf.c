@@ -111,6 +111,7 @@ int32_t uShortRangePbufAlloc(uShortRangePbuf_t **ppBuf)
     *ppBuf = (uShortRangePbuf_t *)uMemPoolAllocMem(&gPBufPool);
     if (*ppBuf != NULL) {
         (*ppBuf)->length = 0;
+        (*ppBuf)->offset = 0;
         (*ppBuf)->pNext = NULL;
         errorCode = gPBufPool.blockSize - sizeof(uShortRangePbuf_t);
     }
@@ -178,42 +179,81 @@ void uShortRangePbufListMerge(uShortRangePbufList_t *pOldList, uShortRangePbufLi
 size_t uShortRangePbufListConsumeData(uShortRangePbufList_t *pBufList, char *pData, size_t len)
 {
     size_t copiedLen = 0;
-    uShortRangePbuf_t *pTemp;
-    uShortRangePbuf_t *pNext = NULL;
+    size_t segmentLen;
+    const char *pSegment;
 
     if ((pBufList != NULL) && (pData != NULL)) {
+        segmentLen = uShortRangePbufListPeek(pBufList, &pSegment);
+        while ((len > 0) && (segmentLen > 0)) {
+            if (segmentLen > len) {
+                segmentLen = len;
+            }
+            // Copy the data to the given buffer and then let go of it
+            memcpy(&pData[copiedLen], pSegment, segmentLen);
+            copiedLen += uShortRangePbufListRelease(pBufList, segmentLen);
+            len -= segmentLen;
+            segmentLen = uShortRangePbufListPeek(pBufList, &pSegment);
+        }
+    }
 
-        for (pTemp = pBufList->pBufHead; (len != 0 && pTemp != NULL); pTemp = pNext) {
-            // Basic sanity check - pbuf length should never be longer than pool block size
-            U_ASSERT(pTemp->length <= gPBufPool.blockSize);
-
-            if (pTemp->length <= len) {
-                // Copy the data to the given buffer
-                memcpy(&pData[copiedLen], &pTemp->data[0], pTemp->length);
-                copiedLen += pTemp->length;
-                pBufList->totalLen -= pTemp->length;
-                len -= pTemp->length;
-                pNext = pTemp->pNext;
+    return copiedLen;
+}
+
+size_t uShortRangePbufListPeek(const uShortRangePbufList_t *pBufList, const char **ppData)
+{
+    size_t segmentLen = 0;
+    uShortRangePbuf_t *pBuf;
+
+    if (ppData != NULL) {
+        *ppData = NULL;
+        if (pBufList != NULL) {
+            pBuf = pBufList->pBufHead;
+            if (pBuf != NULL) {
+                // Basic sanity check - pbuf length should never be longer than pool block size
+                U_ASSERT(pBuf->length <= gPBufPool.blockSize);
+                U_ASSERT(pBuf->offset <= pBuf->length);
+                segmentLen = pBuf->length - pBuf->offset;
+                *ppData = &pBuf->data[pBuf->offset];
+            }
+        }
+    }
+
+    return segmentLen;
+}
+
+size_t uShortRangePbufListRelease(uShortRangePbufList_t *pBufList, size_t len)
+{
+    size_t releasedLen = 0;
+    size_t available;
+    uShortRangePbuf_t *pTemp;
+
+    if (pBufList != NULL) {
+        pTemp = pBufList->pBufHead;
+        while ((len > 0) && (pTemp != NULL)) {
+            available = pTemp->length - pTemp->offset;
+            if (available <= len) {
                 // We are done with this pbuf - put it back in the pool
-                freePbuf(pTemp, false);
-                pBufList->pBufHead = pNext;
+                releasedLen += available;
+                pBufList->totalLen -= (uint16_t)available;
+                len -= available;
+                pBufList->pBufHead = pTemp->pNext;
                 if (pBufList->pBufHead == NULL) {
                     pBufList->pBufTail = NULL;
                 }
+                freePbuf(pTemp, false);
+                pTemp = pBufList->pBufHead;
             } else {
-                // Do partial copy
-                memcpy(&pData[copiedLen], &pTemp->data[0], len);
-                copiedLen += len;
+                // Partially consumed: just move the start along,
+                // no need to shuffle the remaining data down
+                releasedLen += len;
                 pBufList->totalLen -= (uint16_t)len;
-                pTemp->length -= (uint16_t)len;
-                // move the remaining data to start
-                memmove(&pTemp->data[0], &pTemp->data[len], pTemp->length);
+                pTemp->offset += (uint16_t)len;
                 len = 0;
             }
         }
     }
 
-    return copiedLen;
+    return releasedLen;
 }
 
 
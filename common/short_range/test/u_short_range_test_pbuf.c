@@ -262,4 +262,85 @@ U_PORT_TEST_FUNCTION("[pbuf]", "pbufPktList")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
+U_PORT_TEST_FUNCTION("[pbuf]", "pbufPeekRelease")
+{
+    int32_t errCode;
+    uShortRangePbufList_t *pPbufList;
+    int32_t numOfBlks = 4;
+    uShortRangePbuf_t *pBuf;
+    int32_t heapUsed;
+    char *pBuffer1;
+    const char *pSegment;
+    size_t segmentLen;
+    size_t offset = 0;
+    size_t releaseLen;
+    int32_t i;
+    //lint -e{679} suppress loss of precision
+    //lint -e{647} suppress suspicious truncation
+    size_t totalLen = numOfBlks * U_SHORT_RANGE_EDM_BLK_SIZE;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    rand();
+    heapUsed = uPortGetHeapFree();
+
+    errCode = uShortRangeMemPoolInit();
+    U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+
+    pPbufList = pUShortRangePbufListAlloc();
+    U_PORT_TEST_ASSERT(pPbufList != NULL);
+
+    // Nothing to peek at in an empty list
+    U_PORT_TEST_ASSERT(uShortRangePbufListPeek(pPbufList, &pSegment) == 0);
+    U_PORT_TEST_ASSERT(pSegment == NULL);
+
+    pBuffer1 = (char *)malloc(totalLen);
+    U_PORT_TEST_ASSERT(pBuffer1 != NULL);
+    memset(pBuffer1, 0, totalLen);
+
+    for (i = 0; i < numOfBlks; i++) {
+        int32_t sizeOfBlk = generatePayLoad(&pBuf);
+        U_PORT_TEST_ASSERT_EQUAL(U_SHORT_RANGE_EDM_BLK_SIZE, sizeOfBlk);
+        memcpy(&pBuffer1[i * sizeOfBlk], &pBuf->data[0], sizeOfBlk);
+        errCode = uShortRangePbufListAppend(pPbufList, pBuf);
+        U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+    }
+
+    // Work through the data in place, releasing it in
+    // pieces which don't line up with the pbuf boundaries
+    releaseLen = (U_SHORT_RANGE_EDM_BLK_SIZE / 3) + 1;
+    while (offset < totalLen) {
+        segmentLen = uShortRangePbufListPeek(pPbufList, &pSegment);
+        // The segment should be whatever is left of the current pbuf
+        U_PORT_TEST_ASSERT(segmentLen == U_SHORT_RANGE_EDM_BLK_SIZE -
+                           (offset % U_SHORT_RANGE_EDM_BLK_SIZE));
+        U_PORT_TEST_ASSERT(memcmp(pSegment, &pBuffer1[offset], segmentLen) == 0);
+        if (segmentLen > releaseLen) {
+            segmentLen = releaseLen;
+        }
+        U_PORT_TEST_ASSERT(uShortRangePbufListRelease(pPbufList, segmentLen) == segmentLen);
+        offset += segmentLen;
+        U_PORT_TEST_ASSERT(pPbufList->totalLen == totalLen - offset);
+    }
+
+    // All gone
+    U_PORT_TEST_ASSERT(uShortRangePbufListPeek(pPbufList, &pSegment) == 0);
+    U_PORT_TEST_ASSERT(pPbufList->pBufHead == NULL);
+    U_PORT_TEST_ASSERT(pPbufList->pBufTail == NULL);
+    U_PORT_TEST_ASSERT(uShortRangePbufListRelease(pPbufList, 1) == 0);
+
+    uShortRangePbufListFree(pPbufList);
+    uShortRangeMemPoolDeInit();
+    free(pBuffer1);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
 // End of file
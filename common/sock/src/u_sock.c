@@ -302,6 +302,13 @@
  *
  * The return value is the sockHandle to be used with
  * the new connection from now on.
+ *
+ * These functions are not called by name: each device instance
+ * carries a table of them, a uSockBackend_t (see u_sock_backend.h),
+ * which is filled in with the cellular or Wi-Fi table below on
+ * first use if the device has not been given one of its own.  The
+ * table is also cached in each socket when it is created so that
+ * sending and receiving are a single indirect call.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -335,6 +342,7 @@
 #include "u_sock.h"
 #include "u_sock_security.h"
 #include "u_sock_errno.h"
+#include "u_sock_backend.h"
 
 #include "u_cell_sec_tls.h"
 #include "u_cell_sock.h"
@@ -394,6 +402,8 @@ typedef struct {
                              is NOTHING TO DO with the socket
                              descriptor. */
     uSockState_t state;
+    const uSockBackend_t *pBackend; /**< the functions of the underlying
+                                         socket layer for devHandle. */
     uSockAddress_t remoteAddress;
     int64_t receiveTimeoutMs;
     int32_t bytesSent;
@@ -514,6 +524,108 @@ static void deinitButNotMutex()
     }
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: BACKENDS
+ * -------------------------------------------------------------- */
+
+// Adaptor for uCellSockSecure(), which takes a profile ID.
+static int32_t cellSecure(uDeviceHandle_t devHandle, int32_t sockHandle,
+                          const uSecurityTlsContext_t *pSecurityContext)
+{
+    return uCellSockSecure(devHandle, sockHandle,
+                           ((uCellSecTlsContext_t *) (pSecurityContext->pNetworkSpecific))->profileId);
+}
+
+// Adaptor for uCellSockRegisterCallbackData(), which can't fail.
+static int32_t cellRegisterCallbackData(uDeviceHandle_t devHandle,
+                                        int32_t sockHandle,
+                                        void (*pCallback) (uDeviceHandle_t,
+                                                           int32_t))
+{
+    uCellSockRegisterCallbackData(devHandle, sockHandle, pCallback);
+    return U_SOCK_ENONE;
+}
+
+// Adaptor for uCellSockRegisterCallbackClosed(), which can't fail.
+static int32_t cellRegisterCallbackClosed(uDeviceHandle_t devHandle,
+                                          int32_t sockHandle,
+                                          void (*pCallback) (uDeviceHandle_t,
+                                                             int32_t))
+{
+    uCellSockRegisterCallbackClosed(devHandle, sockHandle, pCallback);
+    return U_SOCK_ENONE;
+}
+
+/** The cellular socket layer.
+ */
+static const uSockBackend_t gCellBackend = {
+    .asyncTcpClose = true,
+    .pInitInstance = uCellSockInitInstance,
+    .pCleanup = uCellSockCleanup,
+    .pCreate = uCellSockCreate,
+    .pBlockingSet = uCellSockBlockingSet,
+    .pConnect = uCellSockConnect,
+    .pClose = uCellSockClose,
+    .pOptionSet = uCellSockOptionSet,
+    .pOptionGet = uCellSockOptionGet,
+    .pSecure = cellSecure,
+    .pSetNextLocalPort = uCellSockSetNextLocalPort,
+    .pSendTo = uCellSockSendTo,
+    .pReceiveFrom = uCellSockReceiveFrom,
+    .pWrite = uCellSockWrite,
+    .pRead = uCellSockRead,
+    .pRegisterCallbackData = cellRegisterCallbackData,
+    .pRegisterCallbackClosed = cellRegisterCallbackClosed,
+    .pGetHostByName = uCellSockGetHostByName,
+    .pGetLocalAddress = uCellSockGetLocalAddress
+};
+
+/** The Wi-Fi socket layer.
+ */
+static const uSockBackend_t gWifiBackend = {
+    .asyncTcpClose = false,
+    .pInitInstance = uWifiSockInitInstance,
+    .pCleanup = uWifiSockCleanup,
+    .pCreate = uWifiSockCreate,
+    .pBlockingSet = NULL, // TODO: Set blocking stuff
+    .pConnect = uWifiSockConnect,
+    .pClose = uWifiSockClose,
+    .pOptionSet = uWifiSockOptionSet,
+    .pOptionGet = uWifiSockOptionGet,
+    .pSecure = NULL,
+    .pSetNextLocalPort = uWifiSockSetNextLocalPort,
+    .pSendTo = uWifiSockSendTo,
+    .pReceiveFrom = uWifiSockReceiveFrom,
+    .pWrite = uWifiSockWrite,
+    .pRead = uWifiSockRead,
+    .pRegisterCallbackData = uWifiSockRegisterCallbackData,
+    .pRegisterCallbackClosed = uWifiSockRegisterCallbackClosed,
+    .pGetHostByName = uWifiSockGetHostByName,
+    .pGetLocalAddress = uWifiSockGetLocalAddress
+};
+
+// Get the socket layer for a device, filling in the default
+// for the device type if the device doesn't have one yet.
+static const uSockBackend_t *pBackendGet(uDeviceHandle_t devHandle)
+{
+    const uSockBackend_t *pBackend = NULL;
+    uDeviceInstance_t *pInstance;
+
+    if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
+        pBackend = pInstance->pSockBackend;
+        if (pBackend == NULL) {
+            if (pInstance->deviceType == U_DEVICE_TYPE_CELL) {
+                pBackend = &gCellBackend;
+            } else if (pInstance->deviceType == U_DEVICE_TYPE_SHORT_RANGE) {
+                pBackend = &gWifiBackend;
+            }
+            pInstance->pSockBackend = pBackend;
+        }
+    }
+
+    return pBackend;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: CONTAINER STUFF
  * -------------------------------------------------------------- */
@@ -1059,40 +1171,29 @@ static int32_t receive(const uSockContainer_t *pContainer,
 {
     uDeviceHandle_t devHandle = pContainer->socket.devHandle;
     int32_t sockHandle = pContainer->socket.sockHandle;
+    const uSockBackend_t *pBackend = pContainer->socket.pBackend;
     int32_t negErrnoOrSize = -U_SOCK_ENOSYS;
     int32_t startTimeMs = uPortGetTickTimeMs();
-    int32_t devType = uDeviceGetDeviceType(devHandle);
 
     // Run around the loop until a packet of data turns up
     // or we time out or just once if we're non-blocking.
     do {
         if (pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) {
             // UDP style
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                negErrnoOrSize = uCellSockReceiveFrom(devHandle,
-                                                      sockHandle,
-                                                      pRemoteAddress,
-                                                      pData,
-                                                      dataSizeBytes);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                negErrnoOrSize = uWifiSockReceiveFrom(devHandle,
-                                                      sockHandle,
-                                                      pRemoteAddress,
-                                                      pData,
-                                                      dataSizeBytes);
+            if (pBackend->pReceiveFrom != NULL) {
+                negErrnoOrSize = pBackend->pReceiveFrom(devHandle,
+                                                        sockHandle,
+                                                        pRemoteAddress,
+                                                        pData,
+                                                        dataSizeBytes);
             }
         } else {
             // TCP style
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                negErrnoOrSize = uCellSockRead(devHandle,
-                                               sockHandle,
-                                               pData,
-                                               dataSizeBytes);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                negErrnoOrSize = uWifiSockRead(devHandle,
-                                               sockHandle,
-                                               pData,
-                                               dataSizeBytes);
+            if (pBackend->pRead != NULL) {
+                negErrnoOrSize = pBackend->pRead(devHandle,
+                                                 sockHandle,
+                                                 pData,
+                                                 dataSizeBytes);
             }
         }
         if (negErrnoOrSize < 0) {
@@ -1166,17 +1267,17 @@ int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
             }
 
             if ((descriptorOrError >= 0) && (pContainer != NULL)) {
-                int32_t devType = uDeviceGetDeviceType(devHandle);
+                const uSockBackend_t *pBackend = pBackendGet(devHandle);
                 errnoLocal = U_SOCK_ENOSYS;
-                if (pContainerFindByDeviceHandle(devHandle, -1) == NULL) {
-                    // If this is the first time we have
-                    // encountered this network layer,
-                    // ask the underlying cell/wifi sockets
-                    // layer to initialise it
-                    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                        errnoLocal = -uCellSockInitInstance(devHandle);
-                    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                        errnoLocal = -uWifiSockInitInstance(devHandle);
+                if ((pBackend != NULL) && (pBackend->pCreate != NULL)) {
+                    errnoLocal = U_SOCK_ENONE;
+                    if ((pContainerFindByDeviceHandle(devHandle, -1) == NULL) &&
+                        (pBackend->pInitInstance != NULL)) {
+                        // If this is the first time we have
+                        // encountered this network layer,
+                        // ask the underlying cell/wifi sockets
+                        // layer to initialise it
+                        errnoLocal = -pBackend->pInitInstance(devHandle);
                     }
                 }
                 // Get the underlying cell/wifi socket layer to
@@ -1184,19 +1285,15 @@ int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
                 // a socket handle or a negated value of errno from
                 // the U_SOCK_Exxx list
                 if (errnoLocal == 0) {
-                    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                        sockHandle = uCellSockCreate(devHandle,
-                                                     type, protocol);
+                    sockHandle = pBackend->pCreate(devHandle,
+                                                   type, protocol);
+                    if ((sockHandle >= 0) && (pBackend->pBlockingSet != NULL)) {
                         // Setting non-blocking so that
                         // we do the blocking here instead.
                         // Since this has no return value
                         // we can do it at the same time
-                        uCellSockBlockingSet(devHandle,
-                                             sockHandle, false);
-                    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                        sockHandle = uWifiSockCreate(devHandle,
-                                                     type, protocol);
-                        // TODO: Set blocking stuff
+                        pBackend->pBlockingSet(devHandle,
+                                               sockHandle, false);
                     }
 
                     if (sockHandle >= 0) {
@@ -1204,6 +1301,7 @@ int32_t uSockCreate(uDeviceHandle_t devHandle, uSockType_t type,
                         // as it was already set above
                         pContainer->socket.sockHandle = sockHandle;
                         pContainer->socket.devHandle = devHandle;
+                        pContainer->socket.pBackend = pBackend;
                         pContainer->socket.bytesSent = 0;
                         uPortLog("U_SOCK: socket created, descriptor %d,"
                                  " network handle 0x%08x, socket handle %d.\n",
@@ -1272,15 +1370,10 @@ int32_t uSockConnect(uSockDescriptor_t descriptor,
                              addressToString(pRemoteAddress, true,
                                              buffer, sizeof(buffer)),
                              buffer);
-                    int32_t devType = uDeviceGetDeviceType(devHandle);
-                    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                        errorCode = uCellSockConnect(devHandle,
-                                                     sockHandle,
-                                                     pRemoteAddress);
-                    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                        errorCode = uWifiSockConnect(devHandle,
-                                                     sockHandle,
-                                                     pRemoteAddress);
+                    if (pContainer->socket.pBackend->pConnect != NULL) {
+                        errorCode = pContainer->socket.pBackend->pConnect(devHandle,
+                                                                          sockHandle,
+                                                                          pRemoteAddress);
                     }
 
                     if (errorCode == 0) {
@@ -1357,21 +1450,17 @@ int32_t uSockClose(uSockDescriptor_t descriptor)
             sockHandle = pContainer->socket.sockHandle;
             errnoLocal = U_SOCK_ENONE;
             errorCode = -U_SOCK_ENOSYS;
-            int32_t devType = uDeviceGetDeviceType(devHandle);
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                // In the cellular case asynchronous TCP
-                // socket closure is used in some cases.
-                if (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP) {
+            if (pContainer->socket.pBackend->pClose != NULL) {
+                // In some cases (e.g. cellular) asynchronous TCP
+                // socket closure is used.
+                if (pContainer->socket.pBackend->asyncTcpClose &&
+                    (pContainer->socket.protocol == U_SOCK_PROTOCOL_TCP)) {
                     finalState = U_SOCK_STATE_CLOSING;
                     pAsyncClosedCallback = closedCallback;
                 }
-                errorCode = uCellSockClose(devHandle,
-                                           sockHandle,
-                                           pAsyncClosedCallback);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errorCode = uWifiSockClose(devHandle,
-                                           sockHandle,
-                                           pAsyncClosedCallback);
+                errorCode = pContainer->socket.pBackend->pClose(devHandle,
+                                                                sockHandle,
+                                                                pAsyncClosedCallback);
             }
             if (errorCode == 0) {
                 uPortLog("U_SOCK: socket with descriptor %d,"
@@ -1469,13 +1558,11 @@ void uSockCleanUp()
                 }
 
                 if (devHandle != NULL) {
-                    int32_t devType = uDeviceGetDeviceType(devHandle);
+                    const uSockBackend_t *pBackend = pBackendGet(devHandle);
                     // Call the clean-up function in the underlying
                     // socket layer, where present
-                    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                        uCellSockCleanup(devHandle);
-                    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                        uWifiSockCleanup(devHandle);
+                    if ((pBackend != NULL) && (pBackend->pCleanup != NULL)) {
+                        pBackend->pCleanup(devHandle);
                     }
                 }
             } else {
@@ -1517,11 +1604,8 @@ void uSockDeinit()
                 // we're closin' dowwwn...
                 devHandle = pContainer->socket.devHandle;
                 sockHandle = pContainer->socket.sockHandle;
-                int32_t devType = uDeviceGetDeviceType(devHandle);
-                if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                    uCellSockClose(devHandle, sockHandle, NULL);
-                } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                    uWifiSockClose(devHandle, sockHandle, NULL);
+                if (pContainer->socket.pBackend->pClose != NULL) {
+                    pContainer->socket.pBackend->pClose(devHandle, sockHandle, NULL);
                 }
             }
 
@@ -1685,19 +1769,12 @@ int32_t uSockOptionSet(uSockDescriptor_t descriptor,
                     sockHandle = pContainer->socket.sockHandle;
                     errnoLocal = U_SOCK_ENONE;
                     errorCode = -U_SOCK_ENOSYS;
-                    int32_t devType = uDeviceGetDeviceType(devHandle);
-                    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                        errorCode = uCellSockOptionSet(devHandle,
-                                                       sockHandle,
-                                                       level, option,
-                                                       pOptionValue,
-                                                       optionValueLength);
-                    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                        errorCode = uWifiSockOptionSet(devHandle,
-                                                       sockHandle,
-                                                       level, option,
-                                                       pOptionValue,
-                                                       optionValueLength);
+                    if (pContainer->socket.pBackend->pOptionSet != NULL) {
+                        errorCode = pContainer->socket.pBackend->pOptionSet(devHandle,
+                                                                            sockHandle,
+                                                                            level, option,
+                                                                            pOptionValue,
+                                                                            optionValueLength);
                     }
 
                     if (errorCode == 0) {
@@ -1788,19 +1865,12 @@ int32_t uSockOptionGet(uSockDescriptor_t descriptor,
                     sockHandle = pContainer->socket.sockHandle;
                     errnoLocal = U_SOCK_ENONE;
                     errorCode = -U_SOCK_ENOSYS;
-                    int32_t devType = uDeviceGetDeviceType(devHandle);
-                    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                        errorCode = uCellSockOptionGet(devHandle,
-                                                       sockHandle,
-                                                       level, option,
-                                                       pOptionValue,
-                                                       pOptionValueLength);
-                    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                        errorCode = uWifiSockOptionGet(devHandle,
-                                                       sockHandle,
-                                                       level, option,
-                                                       pOptionValue,
-                                                       pOptionValueLength);
+                    if (pContainer->socket.pBackend->pOptionGet != NULL) {
+                        errorCode = pContainer->socket.pBackend->pOptionGet(devHandle,
+                                                                            sockHandle,
+                                                                            level, option,
+                                                                            pOptionValue,
+                                                                            pOptionValueLength);
                     }
 
                     if (errorCode == 0) {
@@ -1881,14 +1951,13 @@ int32_t uSockSecurity(uSockDescriptor_t descriptor,
                         break;
                 }
             } else {
-                int32_t devType = uDeviceGetDeviceType(devHandle);
                 // We're good
-                if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                    // In the cellular case the security
+                if (pContainer->socket.pBackend->pSecure != NULL) {
+                    // In the cellular case, for instance, the security
                     // profile has to be applied before connect
-                    errnoLocal = -uCellSockSecure(devHandle,
-                                                  sockHandle,
-                                                  ((uCellSecTlsContext_t *) (pContainer->socket.pSecurityContext->pNetworkSpecific))->profileId);
+                    errnoLocal = -pContainer->socket.pBackend->pSecure(devHandle,
+                                                                       sockHandle,
+                                                                       pContainer->socket.pSecurityContext);
                 }
             }
         }
@@ -1917,11 +1986,9 @@ int32_t uSockSetNextLocalPort(uDeviceHandle_t devHandle, int32_t port)
         U_PORT_MUTEX_LOCK(gMutexContainer);
 
         errorCode = -U_SOCK_ENOSYS;
-        int32_t devType = uDeviceGetDeviceType(devHandle);
-        if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-            errorCode = uCellSockSetNextLocalPort(devHandle, port);
-        } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-            errorCode = uWifiSockSetNextLocalPort(devHandle, port);
+        const uSockBackend_t *pBackend = pBackendGet(devHandle);
+        if ((pBackend != NULL) && (pBackend->pSetNextLocalPort != NULL)) {
+            errorCode = pBackend->pSetNextLocalPort(devHandle, port);
         }
 
         if (errorCode < 0) {
@@ -2009,22 +2076,12 @@ int32_t uSockSendTo(uSockDescriptor_t descriptor,
                             devHandle = pContainer->socket.devHandle;
                             sockHandle = pContainer->socket.sockHandle;
                             errorCodeOrSize = -U_SOCK_ENOSYS;
-                            int32_t devType = uDeviceGetDeviceType(devHandle);
-                            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                                errorCodeOrSize = uCellSockSendTo(devHandle,
-                                                                  sockHandle,
-                                                                  pRemoteAddress,
-                                                                  pData,
-                                                                  dataSizeBytes);
-                                if (errorCodeOrSize > 0) {
-                                    pContainer->socket.bytesSent += errorCodeOrSize;
-                                }
-                            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                                errorCodeOrSize = uWifiSockSendTo(devHandle,
-                                                                  sockHandle,
-                                                                  pRemoteAddress,
-                                                                  pData,
-                                                                  dataSizeBytes);
+                            if (pContainer->socket.pBackend->pSendTo != NULL) {
+                                errorCodeOrSize = pContainer->socket.pBackend->pSendTo(devHandle,
+                                                                                       sockHandle,
+                                                                                       pRemoteAddress,
+                                                                                       pData,
+                                                                                       dataSizeBytes);
                                 if (errorCodeOrSize > 0) {
                                     pContainer->socket.bytesSent += errorCodeOrSize;
                                 }
@@ -2171,20 +2228,11 @@ int32_t uSockWrite(uSockDescriptor_t descriptor,
                             devHandle = pContainer->socket.devHandle;
                             sockHandle = pContainer->socket.sockHandle;
                             errorCodeOrSize = -U_SOCK_ENOSYS;
-                            int32_t devType = uDeviceGetDeviceType(devHandle);
-                            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                                errorCodeOrSize = uCellSockWrite(devHandle,
-                                                                 sockHandle,
-                                                                 pData,
-                                                                 dataSizeBytes);
-                                if (errorCodeOrSize > 0) {
-                                    pContainer->socket.bytesSent += errorCodeOrSize;
-                                }
-                            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                                errorCodeOrSize = uWifiSockWrite(devHandle,
-                                                                 sockHandle,
-                                                                 pData,
-                                                                 dataSizeBytes);
+                            if (pContainer->socket.pBackend->pWrite != NULL) {
+                                errorCodeOrSize = pContainer->socket.pBackend->pWrite(devHandle,
+                                                                                      sockHandle,
+                                                                                      pData,
+                                                                                      dataSizeBytes);
                                 if (errorCodeOrSize > 0) {
                                     pContainer->socket.bytesSent += errorCodeOrSize;
                                 }
@@ -2370,16 +2418,10 @@ void uSockRegisterCallbackData(uSockDescriptor_t descriptor,
             devHandle = pContainer->socket.devHandle;
             sockHandle = pContainer->socket.sockHandle;
             errnoLocal = U_SOCK_ENOSYS;
-            int32_t devType = uDeviceGetDeviceType(devHandle);
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                uCellSockRegisterCallbackData(devHandle,
-                                              sockHandle,
-                                              dataCallback);
-                errnoLocal = U_SOCK_ENONE;
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errnoLocal = -uWifiSockRegisterCallbackData(devHandle,
-                                                            sockHandle,
-                                                            dataCallback);
+            if (pContainer->socket.pBackend->pRegisterCallbackData != NULL) {
+                errnoLocal = -pContainer->socket.pBackend->pRegisterCallbackData(devHandle,
+                                                                                 sockHandle,
+                                                                                 dataCallback);
             }
 
             if (errnoLocal == U_SOCK_ENONE) {
@@ -2426,16 +2468,10 @@ void uSockRegisterCallbackClosed(uSockDescriptor_t descriptor,
             devHandle = pContainer->socket.devHandle;
             sockHandle = pContainer->socket.sockHandle;
             errnoLocal = U_SOCK_ENOSYS;
-            int32_t devType = uDeviceGetDeviceType(devHandle);
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                uCellSockRegisterCallbackClosed(devHandle,
-                                                sockHandle,
-                                                closedCallback);
-                errnoLocal = U_SOCK_ENONE;
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errnoLocal = -uWifiSockRegisterCallbackClosed(devHandle,
-                                                              sockHandle,
-                                                              closedCallback);
+            if (pContainer->socket.pBackend->pRegisterCallbackClosed != NULL) {
+                errnoLocal = -pContainer->socket.pBackend->pRegisterCallbackClosed(devHandle,
+                                                                                 sockHandle,
+                                                                                 closedCallback);
             }
 
             if (errnoLocal == U_SOCK_ENONE) {
@@ -2586,15 +2622,10 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
                 devHandle = pContainer->socket.devHandle;
                 sockHandle = pContainer->socket.sockHandle;
                 errnoLocal = U_SOCK_ENOSYS;
-                int32_t devType = uDeviceGetDeviceType(devHandle);
-                if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                    errnoLocal = -uCellSockGetLocalAddress(devHandle,
-                                                           sockHandle,
-                                                           pLocalAddress);
-                } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                    errnoLocal = -uWifiSockGetLocalAddress(devHandle,
-                                                           sockHandle,
-                                                           pLocalAddress);
+                if (pContainer->socket.pBackend->pGetLocalAddress != NULL) {
+                    errnoLocal = -pContainer->socket.pBackend->pGetLocalAddress(devHandle,
+                                                                                sockHandle,
+                                                                                pLocalAddress);
                 }
             }
 
@@ -2627,21 +2658,17 @@ int32_t uSockGetHostByName(uDeviceHandle_t devHandle,
 
             U_PORT_MUTEX_LOCK(gMutexContainer);
 
-            int32_t devType = uDeviceGetDeviceType(devHandle);
+            const uSockBackend_t *pBackend = pBackendGet(devHandle);
 
             // Talk to the underlying cell/wifi
             // socket layer to do the DNS look-up.
             // uXxxSockGetHostByName() returns a negated
             // value from the U_SOCK_Exxx list.
             errnoLocal = U_SOCK_ENOSYS;
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                errnoLocal = -uCellSockGetHostByName(devHandle,
-                                                     pHostName,
-                                                     pHostIpAddress);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errnoLocal = -uWifiSockGetHostByName(devHandle,
-                                                     pHostName,
-                                                     pHostIpAddress);
+            if ((pBackend != NULL) && (pBackend->pGetHostByName != NULL)) {
+                errnoLocal = -pBackend->pGetHostByName(devHandle,
+                                                       pHostName,
+                                                       pHostIpAddress);
             }
 
             U_PORT_MUTEX_UNLOCK(gMutexContainer);
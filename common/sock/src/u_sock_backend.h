@@ -0,0 +1,123 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_SOCK_BACKEND_H_
+#define _U_SOCK_BACKEND_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_sock.h"
+#include "u_security_tls.h"
+
+/** @file
+ * @brief This header file defines the table of functions through
+ * which the common sockets layer calls an underlying socket
+ * implementation.  It does not form part of the sockets API.
+ *
+ * A table is hung off the device instance (see pSockBackend in
+ * u_device_shared.h); if that is left as NULL the sockets layer
+ * fills in the default for the device type, i.e. cellular or
+ * Wi-Fi, on first use.  A new socket implementation may be plugged
+ * in by pointing pSockBackend at its own table before the first
+ * uSockCreate() on the device.  The requirements on each function
+ * are those described for the equivalent uXxxSockYyy() function at
+ * the top of u_sock.c; any optional function that is not supported
+ * may be NULL, in which case the sockets layer returns
+ * U_SOCK_ENOSYS (or, where there is nothing to return, does
+ * nothing).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The functions of an underlying socket implementation.
+ */
+typedef struct uSockBackend_t {
+    /** Set to true if a TCP socket is closed asynchronously, i.e.
+     * pClose() may return before the socket is actually closed and
+     * will call the callback passed to it when it is.
+     */
+    bool asyncTcpClose;
+    int32_t (*pInitInstance) (uDeviceHandle_t devHandle);
+    void (*pCleanup) (uDeviceHandle_t devHandle);
+    int32_t (*pCreate) (uDeviceHandle_t devHandle, uSockType_t type,
+                        uSockProtocol_t protocol);
+    void (*pBlockingSet) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                          bool isBlocking);
+    int32_t (*pConnect) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                         const uSockAddress_t *pRemoteAddress);
+    int32_t (*pClose) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                       void (*pCallback) (uDeviceHandle_t, int32_t));
+    int32_t (*pOptionSet) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                           int32_t level, uint32_t option,
+                           const void *pOptionValue,
+                           size_t optionValueLength);
+    int32_t (*pOptionGet) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                           int32_t level, uint32_t option,
+                           void *pOptionValue,
+                           size_t *pOptionValueLength);
+    /** Apply security to a socket before it is connected; may
+     * be NULL if security is handled entirely elsewhere.
+     */
+    int32_t (*pSecure) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                        const uSecurityTlsContext_t *pSecurityContext);
+    int32_t (*pSetNextLocalPort) (uDeviceHandle_t devHandle, int32_t port);
+    int32_t (*pSendTo) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                        const uSockAddress_t *pRemoteAddress,
+                        const void *pData, size_t dataSizeBytes);
+    int32_t (*pReceiveFrom) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                             uSockAddress_t *pRemoteAddress,
+                             void *pData, size_t dataSizeBytes);
+    int32_t (*pWrite) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                       const void *pData, size_t dataSizeBytes);
+    int32_t (*pRead) (uDeviceHandle_t devHandle, int32_t sockHandle,
+                      void *pData, size_t dataSizeBytes);
+    int32_t (*pRegisterCallbackData) (uDeviceHandle_t devHandle,
+                                      int32_t sockHandle,
+                                      void (*pCallback) (uDeviceHandle_t,
+                                                         int32_t));
+    int32_t (*pRegisterCallbackClosed) (uDeviceHandle_t devHandle,
+                                        int32_t sockHandle,
+                                        void (*pCallback) (uDeviceHandle_t,
+                                                           int32_t));
+    int32_t (*pGetHostByName) (uDeviceHandle_t devHandle,
+                               const char *pHostName,
+                               uSockIpAddress_t *pHostIpAddress);
+    int32_t (*pGetLocalAddress) (uDeviceHandle_t devHandle,
+                                 int32_t sockHandle,
+                                 uSockAddress_t *pLocalAddress);
+} uSockBackend_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_SOCK_BACKEND_H_
+
+// End of file
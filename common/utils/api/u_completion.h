@@ -0,0 +1,133 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_COMPLETION_H_
+#define _U_COMPLETION_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __utils
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines a completion API: a binary semaphore
+ * that one task (typically a URC handler) signals when something
+ * has happened and another task waits on, with a timeout and an
+ * optional "keep going" callback.  It allows code that would
+ * otherwise poll a flag with uPortTaskBlock() to wake up as soon as
+ * the flag is set.  uCompletionSignal() and uCompletionWait() are
+ * thread-safe; uCompletionCreate() and uCompletionDelete() should not
+ * be called while either of those are in progress.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_COMPLETION_KEEP_GOING_INTERVAL_MS
+/** The interval at which uCompletionWait() calls the keep-going
+ * callback, if one is given.
+ */
+# define U_COMPLETION_KEEP_GOING_INTERVAL_MS 1000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A completion; treat the contents as private.
+ */
+typedef struct {
+    uPortSemaphoreHandle_t semaphoreHandle; /**< a binary semaphore. */
+} uCompletion_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Create a completion; it starts in the un-signalled state.
+ *
+ * @param pCompletion  a pointer to the completion to create,
+ *                     cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uCompletionCreate(uCompletion_t *pCompletion);
+
+/** Delete a completion; nothing may be waiting on it.  It is
+ * safe to call this on a completion that was never successfully
+ * created, provided the contents were zeroed.
+ *
+ * @param pCompletion  a pointer to the completion.
+ */
+void uCompletionDelete(uCompletion_t *pCompletion);
+
+/** Signal a completion, waking up anyone waiting on it; the
+ * signal is retained if no-one is waiting and multiple signals
+ * before a wait collapse into one.  May be called from a URC
+ * handler or a callback.
+ *
+ * @param pCompletion  a pointer to the completion; if this is
+ *                     NULL or the completion has not been
+ *                     created this function does nothing.
+ */
+void uCompletionSignal(uCompletion_t *pCompletion);
+
+/** Clear any pending signal from a completion; call this before
+ * starting the operation whose completion is to be waited for
+ * so that a stale signal does not cause an early return.
+ *
+ * @param pCompletion  a pointer to the completion.
+ */
+void uCompletionReset(uCompletion_t *pCompletion);
+
+/** Wait for a completion to be signalled.  A signal is consumed
+ * by the wait; since a signal may be left over from an earlier
+ * event the caller should check the condition it is actually
+ * waiting for and wait again if it is not yet met.
+ *
+ * @param pCompletion         a pointer to the completion.
+ * @param timeoutMs           the maximum time to wait in
+ *                            milliseconds.
+ * @param pKeepGoingCallback  an optional callback which is called
+ *                            every U_COMPLETION_KEEP_GOING_INTERVAL_MS
+ *                            while waiting; if it returns false
+ *                            the wait is abandoned.  May be NULL.
+ * @return                    zero if the completion was signalled,
+ *                            U_ERROR_COMMON_TIMEOUT if the timeout
+ *                            expired or the keep-going callback
+ *                            returned false, else negative error
+ *                            code.
+ */
+int32_t uCompletionWait(uCompletion_t *pCompletion, int32_t timeoutMs,
+                        bool (*pKeepGoingCallback)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_COMPLETION_H_
+
+// End of file
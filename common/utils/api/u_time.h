@@ -28,7 +28,11 @@
 
 /** @file
  * @brief This header file defines functions to help with time
- * manipulation.
+ * manipulation, including a simple UTC clock service that
+ * anchors uPortGetTickTimeMs() to the last known UTC time
+ * (e.g. from GNSS or from the cellular network), so that the
+ * current UTC time can be obtained from memory rather than by
+ * asking a module.
  */
 
 #ifdef __cplusplus
@@ -43,6 +47,17 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The possible sources of the UTC time held by the UTC clock
+ * service, see uTimeUtcSet().
+ */
+typedef enum {
+    U_TIME_UTC_SOURCE_NONE = 0, /**< the UTC clock has not been set. */
+    U_TIME_UTC_SOURCE_USER = 1, /**< set by the application. */
+    U_TIME_UTC_SOURCE_CELL = 2, /**< set from the cellular network time. */
+    U_TIME_UTC_SOURCE_GNSS = 3, /**< set from GNSS. */
+    U_TIME_UTC_SOURCE_MAX_NUM
+} uTimeUtcSource_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -51,8 +66,8 @@ extern "C" {
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
-/** Check if the given year is a leap year.  Not a UTC thing; any
- * year will work.
+/** Check if the given year is a leap year according to the
+ * Gregorian calendar.  Not a UTC thing; any year will work.
  *
  * @param year the year.
  * @return     true if the year is a leap year, else false.
@@ -72,6 +87,72 @@ bool uTimeIsLeapYear(int32_t year);
  */
 int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc);
 
+/** Convert a number of UTC days since the start of 1970 into a
+ * date in the Gregorian calendar, taking into account leap years;
+ * the inverse of the day/month/year conversion used by
+ * uTimeMonthsToSecondsUtc().  Useful when converting a UTC time
+ * into a day/month/year count.
+ *
+ * @param daysUtc the number of days since the start of 1970,
+ *                counting from zero; may be negative.
+ * @param pYear   a pointer to a place to put the year, e.g. 2022;
+ *                cannot be NULL.
+ * @param pMonth  a pointer to a place to put the month, 1 to 12;
+ *                cannot be NULL.
+ * @param pDay    a pointer to a place to put the day of the month,
+ *                1 to 31; cannot be NULL.
+ */
+void uTimeDaysToDateUtc(int64_t daysUtc, int32_t *pYear,
+                        int32_t *pMonth, int32_t *pDay);
+
+/** Set the UTC clock: the given UTC time is recorded against the
+ * current value of uPortGetTickTimeMs() so that uTimeUtcGet()
+ * can subsequently return the current UTC time without asking
+ * any module for it.  The GNSS and cellular APIs call this
+ * automatically whenever they obtain a valid UTC time, e.g. from
+ * uGnssPosGet() or uCellInfoGetTimeUtc(); the application may
+ * also call it.  The most recent setting always wins.
+ *
+ * Note that, since uPortGetTickTimeMs() is a 32-bit millisecond
+ * count, the UTC clock should be refreshed at least every 24 days
+ * and it must be cleared (by calling this function with a negative
+ * timeUtcMs) if uPortGetTickTimeMs() is restarted, e.g. on return
+ * from deep sleep.
+ *
+ * @param timeUtcMs the UTC time in milliseconds since 1970;
+ *                  use a negative value to clear the UTC clock.
+ * @param source    the source of the time.
+ */
+void uTimeUtcSet(int64_t timeUtcMs, uTimeUtcSource_t source);
+
+/** Get the current UTC time, in milliseconds since 1970,
+ * according to the UTC clock, i.e. the last UTC time passed
+ * to uTimeUtcSet() plus the time that has elapsed since, as
+ * measured by uPortGetTickTimeMs().
+ *
+ * @param pSource    a pointer to a place to put the source of
+ *                   the time; may be NULL.
+ * @param pAgeMs     a pointer to a place to put the number of
+ *                   milliseconds since the UTC clock was last set,
+ *                   useful if the caller wants to decide whether
+ *                   the value is fresh enough; may be NULL.
+ * @return           the current UTC time in milliseconds since
+ *                   1970 or negative error code if the UTC clock
+ *                   has not been set.
+ */
+int64_t uTimeUtcGetMs(uTimeUtcSource_t *pSource, int32_t *pAgeMs);
+
+/** Get the current UTC time, in seconds since 1970, according
+ * to the UTC clock; a convenience wrapper around uTimeUtcGetMs().
+ *
+ * @param pSource    a pointer to a place to put the source of
+ *                   the time; may be NULL.
+ * @return           the current UTC time in seconds since 1970
+ *                   or negative error code if the UTC clock
+ *                   has not been set.
+ */
+int64_t uTimeUtcGet(uTimeUtcSource_t *pSource);
+
 #ifdef __cplusplus
 }
 #endif
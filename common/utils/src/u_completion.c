@@ -0,0 +1,133 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the completion API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+
+#include "u_completion.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Create a completion.
+int32_t uCompletionCreate(uCompletion_t *pCompletion)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pCompletion != NULL) {
+        pCompletion->semaphoreHandle = NULL;
+        errorCode = uPortSemaphoreCreate(&(pCompletion->semaphoreHandle), 0, 1);
+        if (errorCode != 0) {
+            pCompletion->semaphoreHandle = NULL;
+        }
+    }
+
+    return errorCode;
+}
+
+// Delete a completion.
+void uCompletionDelete(uCompletion_t *pCompletion)
+{
+    if ((pCompletion != NULL) && (pCompletion->semaphoreHandle != NULL)) {
+        uPortSemaphoreDelete(pCompletion->semaphoreHandle);
+        pCompletion->semaphoreHandle = NULL;
+    }
+}
+
+// Signal a completion.
+void uCompletionSignal(uCompletion_t *pCompletion)
+{
+    if ((pCompletion != NULL) && (pCompletion->semaphoreHandle != NULL)) {
+        // An error here just means that the completion
+        // is already signalled, which is fine
+        uPortSemaphoreGive(pCompletion->semaphoreHandle);
+    }
+}
+
+// Clear any pending signal.
+void uCompletionReset(uCompletion_t *pCompletion)
+{
+    if ((pCompletion != NULL) && (pCompletion->semaphoreHandle != NULL)) {
+        uPortSemaphoreTryTake(pCompletion->semaphoreHandle, 0);
+    }
+}
+
+// Wait for a completion to be signalled.
+int32_t uCompletionWait(uCompletion_t *pCompletion, int32_t timeoutMs,
+                        bool (*pKeepGoingCallback)(void))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t startTimeMs;
+    int32_t remainingMs;
+    int32_t waitMs;
+
+    if ((pCompletion != NULL) && (pCompletion->semaphoreHandle != NULL) &&
+        (timeoutMs >= 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        startTimeMs = uPortGetTickTimeMs();
+        remainingMs = timeoutMs;
+        do {
+            waitMs = remainingMs;
+            if ((pKeepGoingCallback != NULL) &&
+                (waitMs > U_COMPLETION_KEEP_GOING_INTERVAL_MS)) {
+                waitMs = U_COMPLETION_KEEP_GOING_INTERVAL_MS;
+            }
+            if (uPortSemaphoreTryTake(pCompletion->semaphoreHandle, waitMs) == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                remainingMs = timeoutMs - (uPortGetTickTimeMs() - startTimeMs);
+            }
+        } while ((errorCode != 0) && (remainingMs > 0) &&
+                 ((pKeepGoingCallback == NULL) || pKeepGoingCallback()));
+    }
+
+    return errorCode;
+}
+
+// End of file
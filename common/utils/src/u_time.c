@@ -28,34 +28,80 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 
+#include "u_error_common.h"
+
+#include "u_port.h"
+
 #include "u_time.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The number of days from 0000-03-01, the start of the
+ * proleptic Gregorian "era" used by daysFromCivil() and
+ * uTimeDaysToDateUtc(), to 1970-01-01.
+ */
+#define U_TIME_DAYS_ERA_TO_1970 719468
+
+/** The number of days in a 400 year Gregorian era.
+ */
+#define U_TIME_DAYS_PER_ERA 146097
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The anchor of the UTC clock.
+ */
+typedef struct {
+    int64_t timeUtcMs;
+    int32_t tickTimeMs;
+    uTimeUtcSource_t source;
+} uTimeUtcAnchor_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
-static const char gDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31,
-                                    31, 30, 31, 30, 31
-                                   };
-static const char gDaysInMonthLeapYear[] = {31, 29, 31, 30, 31, 30,
-                                            31, 31, 30, 31, 30, 31
-                                           };
+/** The UTC clock; source is U_TIME_UTC_SOURCE_NONE when not set.
+ */
+static volatile uTimeUtcAnchor_t gUtcAnchor = {0, 0, U_TIME_UTC_SOURCE_NONE};
 
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Return the number of days since 1970-01-01 of the given date in
+// the proleptic Gregorian calendar, where month is 1 to 12 and
+// day is 1 to 31; this is the constant-time "days from civil"
+// algorithm: the year is shifted to start in March, so that the
+// leap day falls at the end, and then split into 400 year eras,
+// each of which contains exactly U_TIME_DAYS_PER_ERA days.
+static int64_t daysFromCivil(int32_t year, int32_t month, int32_t day)
+{
+    int32_t era;
+    int32_t yearOfEra;
+    int32_t dayOfYear;
+    int32_t dayOfEra;
+
+    if (month <= 2) {
+        year--;
+    }
+    era = (year >= 0 ? year : year - 399) / 400;
+    yearOfEra = year - (era * 400);                          // 0 to 399
+    dayOfYear = ((153 * (month + (month > 2 ? -3 : 9))) + 2) / 5 +
+                day - 1;                                     // 0 to 365
+    dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) -
+               (yearOfEra / 100) + dayOfYear;                // 0 to 146096
+
+    return ((int64_t) era * U_TIME_DAYS_PER_ERA) + dayOfEra - U_TIME_DAYS_ERA_TO_1970;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -66,7 +112,7 @@ bool uTimeIsLeapYear(int32_t year)
 
     if (year % 400 == 0) {
         isLeapYear = true;
-    } else if (year % 4 == 0) {
+    } else if ((year % 4 == 0) && (year % 100 != 0)) {
         isLeapYear = true;
     }
 
@@ -77,15 +123,100 @@ int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc)
 {
     int64_t secondsUtc = 0;
 
-    for (int32_t x = 0; x < monthsUtc; x++) {
-        if (uTimeIsLeapYear((x / 12) + 1970)) {
-            secondsUtc += gDaysInMonthLeapYear[x % 12] * 3600 * 24;
-        } else {
-            secondsUtc += gDaysInMonth[x % 12] * 3600 * 24;
-        }
+    if (monthsUtc > 0) {
+        secondsUtc = daysFromCivil((monthsUtc / 12) + 1970,
+                                   (monthsUtc % 12) + 1, 1) * 3600 * 24;
     }
 
     return secondsUtc;
 }
 
+// Convert a number of days since 1970 into a date: the inverse of
+// daysFromCivil(), splitting the days into 400 year eras which
+// start in March and then working out the year, month and day
+// within the era.
+void uTimeDaysToDateUtc(int64_t daysUtc, int32_t *pYear,
+                        int32_t *pMonth, int32_t *pDay)
+{
+    int64_t era;
+    int32_t dayOfEra;
+    int32_t yearOfEra;
+    int32_t dayOfYear;
+    int32_t monthFromMarch;
+
+    daysUtc += U_TIME_DAYS_ERA_TO_1970;
+    era = (daysUtc >= 0 ? daysUtc : daysUtc - (U_TIME_DAYS_PER_ERA - 1)) /
+          U_TIME_DAYS_PER_ERA;
+    dayOfEra = (int32_t) (daysUtc - (era * U_TIME_DAYS_PER_ERA)); // 0 to 146096
+    yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524) -
+                 (dayOfEra / 146096)) / 365;                      // 0 to 399
+    dayOfYear = dayOfEra - ((365 * yearOfEra) + (yearOfEra / 4) -
+                            (yearOfEra / 100));                    // 0 to 365
+    monthFromMarch = ((5 * dayOfYear) + 2) / 153;                 // 0 to 11
+    *pDay = dayOfYear - (((153 * monthFromMarch) + 2) / 5) + 1;
+    *pMonth = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+    *pYear = (int32_t) (yearOfEra + (era * 400)) + (*pMonth <= 2 ? 1 : 0);
+}
+
+// Set the UTC clock.
+void uTimeUtcSet(int64_t timeUtcMs, uTimeUtcSource_t source)
+{
+    int32_t tickTimeMs = uPortGetTickTimeMs();
+
+    if ((timeUtcMs < 0) || (source >= U_TIME_UTC_SOURCE_MAX_NUM)) {
+        source = U_TIME_UTC_SOURCE_NONE;
+    }
+
+    // If uPortEnterCritical() is not implemented then a
+    // simultaneous uTimeUtcGetMs() may see a partially
+    // updated anchor; that is the best we can do
+    uPortEnterCritical();
+    gUtcAnchor.timeUtcMs = timeUtcMs;
+    gUtcAnchor.tickTimeMs = tickTimeMs;
+    gUtcAnchor.source = source;
+    uPortExitCritical();
+}
+
+// Get the current UTC time in milliseconds from the UTC clock.
+int64_t uTimeUtcGetMs(uTimeUtcSource_t *pSource, int32_t *pAgeMs)
+{
+    int64_t errorCodeOrTimeUtcMs = (int64_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uTimeUtcAnchor_t anchor;
+    int32_t ageMs;
+
+    uPortEnterCritical();
+    anchor.timeUtcMs = gUtcAnchor.timeUtcMs;
+    anchor.tickTimeMs = gUtcAnchor.tickTimeMs;
+    anchor.source = gUtcAnchor.source;
+    uPortExitCritical();
+
+    if (anchor.source != U_TIME_UTC_SOURCE_NONE) {
+        // Unsigned subtraction so that a wrap of the
+        // tick count is handled correctly
+        ageMs = (int32_t) ((uint32_t) uPortGetTickTimeMs() -
+                           (uint32_t) anchor.tickTimeMs);
+        errorCodeOrTimeUtcMs = anchor.timeUtcMs + ageMs;
+        if (pAgeMs != NULL) {
+            *pAgeMs = ageMs;
+        }
+    }
+    if (pSource != NULL) {
+        *pSource = anchor.source;
+    }
+
+    return errorCodeOrTimeUtcMs;
+}
+
+// Get the current UTC time in seconds from the UTC clock.
+int64_t uTimeUtcGet(uTimeUtcSource_t *pSource)
+{
+    int64_t errorCodeOrTimeUtc = uTimeUtcGetMs(pSource, NULL);
+
+    if (errorCodeOrTimeUtc >= 0) {
+        errorCodeOrTimeUtc /= 1000;
+    }
+
+    return errorCodeOrTimeUtc;
+}
+
 // End of file
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the completion API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* struct timeval in some cases. */
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_completion.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_COMPLETION_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_COMPLETION_TEST_SIGNAL_DELAY_MS
+/** How long the signalling task waits before signalling.
+ */
+# define U_COMPLETION_TEST_SIGNAL_DELAY_MS 100
+#endif
+
+#ifndef U_COMPLETION_TEST_TIMEOUT_MS
+/** The timeout to use in the tests, must be a good deal
+ * larger than U_COMPLETION_TEST_SIGNAL_DELAY_MS.
+ */
+# define U_COMPLETION_TEST_TIMEOUT_MS 2000
+#endif
+
+#ifndef U_COMPLETION_TEST_MARGIN_MS
+/** Margin to allow on timings.
+ */
+# define U_COMPLETION_TEST_MARGIN_MS 50
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The number of times keepGoingCallback() has been called.
+ */
+static volatile int32_t gKeepGoingCount = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Task that signals the completion it is given after a delay.
+static void signalTask(void *pParameters)
+{
+    uPortTaskBlock(U_COMPLETION_TEST_SIGNAL_DELAY_MS);
+    uCompletionSignal((uCompletion_t *) pParameters);
+
+    uPortTaskDelete(NULL);
+}
+
+// Keep-going callback that gives up on its second call.
+static bool keepGoingCallback(void)
+{
+    gKeepGoingCount++;
+    return gKeepGoingCount < 2;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Test the completion API.
+ */
+U_PORT_TEST_FUNCTION("[completion]", "completionBasic")
+{
+    uCompletion_t completion;
+    uPortTaskHandle_t taskHandle;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uCompletionCreate(NULL) < 0);
+    U_PORT_TEST_ASSERT(uCompletionCreate(&completion) == 0);
+
+    // Nothing has signalled it so an immediate wait should time out
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, 0, NULL) ==
+                       (int32_t) U_ERROR_COMMON_TIMEOUT);
+
+    // A signal given before the wait is retained and multiple
+    // signals collapse into one
+    uCompletionSignal(&completion);
+    uCompletionSignal(&completion);
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, 0, NULL) == 0);
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, 0, NULL) ==
+                       (int32_t) U_ERROR_COMMON_TIMEOUT);
+
+    // Reset should clear a pending signal
+    uCompletionSignal(&completion);
+    uCompletionReset(&completion);
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, 0, NULL) ==
+                       (int32_t) U_ERROR_COMMON_TIMEOUT);
+
+    // Signal from another task: the wait should end
+    // as soon as the signal arrives, not at the timeout
+    U_PORT_TEST_ASSERT(uPortTaskCreate(signalTask, "completionSignal",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) &completion,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, U_COMPLETION_TEST_TIMEOUT_MS,
+                                       NULL) == 0);
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("signalled wait took %d ms.", durationMs);
+    U_PORT_TEST_ASSERT(durationMs < U_COMPLETION_TEST_TIMEOUT_MS / 2);
+
+    // Nothing to signal: the wait should last for the timeout
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, U_COMPLETION_TEST_SIGNAL_DELAY_MS,
+                                       NULL) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("un-signalled wait took %d ms.", durationMs);
+    U_PORT_TEST_ASSERT(durationMs >= U_COMPLETION_TEST_SIGNAL_DELAY_MS -
+                       U_COMPLETION_TEST_MARGIN_MS);
+
+    // A keep-going callback that returns false should
+    // end the wait early
+    gKeepGoingCount = 0;
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion,
+                                       U_COMPLETION_KEEP_GOING_INTERVAL_MS * 10,
+                                       keepGoingCallback) ==
+                       (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(gKeepGoingCount == 2);
+
+    uCompletionDelete(&completion);
+    // Deleting twice should be harmless
+    uCompletionDelete(&completion);
+    // As should signalling a deleted completion
+    uCompletionSignal(&completion);
+    U_PORT_TEST_ASSERT(uCompletionWait(&completion, 0, NULL) < 0);
+
+    // Let the signalling task exit
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+    uPortDeinit();
+
+#ifndef U_CFG_OS_CLIB_LEAKS
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+#else
+    (void) heapUsed;
+#endif
+}
+
+// End of file
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the time API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_time.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_TIME_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The number of seconds in a day.
+ */
+#define U_TIME_TEST_SECONDS_PER_DAY (3600 * 24)
+
+/** How long to wait when checking that the UTC clock advances.
+ */
+#define U_TIME_TEST_DELAY_MS 1000
+
+/** Margin to allow for when checking the UTC clock.
+ */
+#define U_TIME_TEST_MARGIN_MS 100
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A known calendar date and the UTC time of its first second.
+ */
+typedef struct {
+    int32_t year;
+    int32_t month; // 1 to 12
+    int64_t timeUtc;
+} uTimeTestDate_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Known dates, chosen to straddle leap days and century years.
+ */
+static const uTimeTestDate_t gDates[] = {{1970, 1, 0},
+    {1970, 2, 2678400},
+    {1972, 3, 68256000},
+    {2000, 2, 949363200},
+    {2000, 3, 951868800},
+    {2022, 10, 1664582400},
+    {2099, 12, 4099766400LL},
+    {2100, 3, 4107542400LL}
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Test the calendar conversion functions.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeConversion")
+{
+    int32_t months;
+    int64_t timeUtc;
+    int64_t previousTimeUtc = 0;
+    int32_t days;
+    int32_t year;
+    int32_t month;
+    int32_t day;
+
+    U_PORT_TEST_ASSERT(uTimeIsLeapYear(1972));
+    U_PORT_TEST_ASSERT(uTimeIsLeapYear(2000));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(2022));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(2100));
+
+    U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(-1) == 0);
+    for (size_t x = 0; x < sizeof(gDates) / sizeof(gDates[0]); x++) {
+        months = ((gDates[x].year - 1970) * 12) + gDates[x].month - 1;
+        timeUtc = uTimeMonthsToSecondsUtc(months);
+        U_TEST_PRINT_LINE("%04d/%02d is %d day(s) since 1970.",
+                          gDates[x].year, gDates[x].month,
+                          (int32_t) (timeUtc / U_TIME_TEST_SECONDS_PER_DAY));
+        U_PORT_TEST_ASSERT(timeUtc == gDates[x].timeUtc);
+        uTimeDaysToDateUtc(timeUtc / U_TIME_TEST_SECONDS_PER_DAY, &year, &month, &day);
+        U_PORT_TEST_ASSERT(year == gDates[x].year);
+        U_PORT_TEST_ASSERT(month == gDates[x].month);
+        U_PORT_TEST_ASSERT(day == 1);
+    }
+    uTimeDaysToDateUtc(-1, &year, &month, &day);
+    U_PORT_TEST_ASSERT((year == 1969) && (month == 12) && (day == 31));
+
+    // Check that every month is a sensible length
+    for (months = 1; months < (2200 - 1970) * 12; months++) {
+        timeUtc = uTimeMonthsToSecondsUtc(months);
+        days = (int32_t) ((timeUtc - previousTimeUtc) / U_TIME_TEST_SECONDS_PER_DAY);
+        U_PORT_TEST_ASSERT((timeUtc % U_TIME_TEST_SECONDS_PER_DAY) == 0);
+        U_PORT_TEST_ASSERT((days >= 28) && (days <= 31));
+        // ...and that the date conversion agrees, both for the first
+        // day of the month and the last day of the month before
+        uTimeDaysToDateUtc(timeUtc / U_TIME_TEST_SECONDS_PER_DAY, &year, &month, &day);
+        U_PORT_TEST_ASSERT((year == 1970 + (months / 12)) && (month == (months % 12) + 1) &&
+                           (day == 1));
+        uTimeDaysToDateUtc((timeUtc / U_TIME_TEST_SECONDS_PER_DAY) - 1, &year, &month, &day);
+        U_PORT_TEST_ASSERT(day == days);
+        previousTimeUtc = timeUtc;
+    }
+}
+
+/** Test the UTC clock.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeUtcClock")
+{
+    uTimeUtcSource_t source;
+    int64_t timeUtcMs;
+    int32_t ageMs = -1;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Clear the clock and make sure it says so
+    uTimeUtcSet(-1, U_TIME_UTC_SOURCE_USER);
+    U_PORT_TEST_ASSERT(uTimeUtcGetMs(&source, &ageMs) < 0);
+    U_PORT_TEST_ASSERT(source == U_TIME_UTC_SOURCE_NONE);
+    U_PORT_TEST_ASSERT(ageMs == -1);
+    U_PORT_TEST_ASSERT(uTimeUtcGet(NULL) < 0);
+
+    // Set it and check that it advances
+    uTimeUtcSet(gDates[5].timeUtc * 1000, U_TIME_UTC_SOURCE_USER);
+    uPortTaskBlock(U_TIME_TEST_DELAY_MS);
+    timeUtcMs = uTimeUtcGetMs(&source, &ageMs);
+    U_TEST_PRINT_LINE("UTC clock is %d ms ahead of the time it was set to.",
+                      (int32_t) (timeUtcMs - (gDates[5].timeUtc * 1000)));
+    U_PORT_TEST_ASSERT(source == U_TIME_UTC_SOURCE_USER);
+    U_PORT_TEST_ASSERT(ageMs >= U_TIME_TEST_DELAY_MS - U_TIME_TEST_MARGIN_MS);
+    U_PORT_TEST_ASSERT(ageMs <= U_TIME_TEST_DELAY_MS + U_TIME_TEST_MARGIN_MS);
+    U_PORT_TEST_ASSERT(timeUtcMs == (gDates[5].timeUtc * 1000) + ageMs);
+    U_PORT_TEST_ASSERT(uTimeUtcGet(NULL) >= gDates[5].timeUtc);
+
+    // Clear it again so as not to confuse anyone else
+    uTimeUtcSet(-1, U_TIME_UTC_SOURCE_NONE);
+    U_PORT_TEST_ASSERT(uTimeUtcGet(&source) < 0);
+    U_PORT_TEST_ASSERT(source == U_TIME_UTC_SOURCE_NONE);
+
+    uPortDeinit();
+}
+
+// End of file
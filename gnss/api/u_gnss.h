@@ -46,6 +46,17 @@ extern "C" {
 # define U_GNSS_I2C_ADDRESS 0x42
 #endif
 
+#ifndef U_GNSS_AT_STREAM_UGPRF_CONFIG
+/** The GNSS I/O configuration bit-map sent to an intermediate
+ * (for example cellular) module with AT+UGPRF by uGnssSetAtStream()
+ * in order that the module passes the GNSS data flow through to
+ * the interface that is connected to this MCU; the default is
+ * the auxiliary UART, check the AT commands manual of your module
+ * for the values that it supports.
+ */
+# define U_GNSS_AT_STREAM_UGPRF_CONFIG 16
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -221,6 +232,40 @@ bool uGnssGetUbxMessagePrint(uDeviceHandle_t gnssHandle);
  */
 void uGnssSetUbxMessagePrint(uDeviceHandle_t gnssHandle, bool onNotOff);
 
+/** If the transport type is AT, so the GNSS chip is being accessed
+ * through an intermediate (for example cellular) module, then every
+ * ubx message exchanged with the GNSS chip is normally carried,
+ * hex-encoded, in an AT+UGUBX command and so has to queue for the
+ * AT interface behind, and hold up, everything else that is using
+ * the module (sockets, MQTT, etc.).  Some modules (for example
+ * SARA-R5) can instead be asked, with AT+UGPRF, to pass the data
+ * of the GNSS chip straight through on a separate interface, e.g.
+ * their auxiliary UART; if that interface is connected to this
+ * MCU, open the UART with uPortUartOpen() and call this function
+ * with its handle: ubx messages will then be exchanged over that
+ * UART, leaving the AT interface free.  The AT interface continues
+ * to be used to power the GNSS chip on and off.  Since some modules
+ * only apply AT+UGPRF when the GNSS chip is next powered on, it is
+ * best to call this function before uGnssPwrOn().
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param uartHandle  the handle of the UART on which the GNSS data
+ *                    is passed through, -1 to go back to using
+ *                    AT+UGUBX; the UART is not closed by this API.
+ * @return            zero on success else negative error code;
+ *                    #U_ERROR_COMMON_NOT_SUPPORTED is returned if
+ *                    the transport type is not AT.
+ */
+int32_t uGnssSetAtStream(uDeviceHandle_t gnssHandle, int32_t uartHandle);
+
+/** Get the handle of the UART set with uGnssSetAtStream().
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            the handle of the UART or negative error
+ *                    code if there is none.
+ */
+int32_t uGnssGetAtStream(uDeviceHandle_t gnssHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -127,6 +127,10 @@ int32_t uGnssInfoGetIdStr(uDeviceHandle_t gnssHandle,
  * and connect to cellular for the relevant information to be
  * downloaded from a u-blox server instead.
  *
+ * On success the UTC clock of u_time.h is also set, so that
+ * uTimeUtcGet() may subsequently be used to obtain the current
+ * UTC time without talking to the GNSS device.
+ *
  * @param gnssHandle  the handle of the GNSS instance.
  * @return            on success the Unix UTC time, else negative
  *                    error code.
@@ -0,0 +1,402 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_MGA_H_
+#define _U_GNSS_MGA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the functions that inject aiding
+ * data (UBX-MGA, "multiple GNSS assistance", messages) into a GNSS
+ * chip in order to reduce the time to first fix: the data from the
+ * u-blox AssistNow Online or AssistNow Offline services, obtained
+ * by whatever means (e.g. over a socket or from a file), and the
+ * time and position, e.g. as known by a cellular module.
+ *
+ * A typical sequence after power-on is:
+ *
+ * - uGnssMgaIniTimeSend() with a negative time, so that the time
+ *   from the UTC clock of u_time.h is used; the cellular API sets
+ *   that clock whenever uCellInfoGetTimeUtc() is called,
+ * - uGnssMgaIniPosSend() with, e.g., the position from a
+ *   #U_LOCATION_TYPE_CLOUD_CELL_LOCATE location request,
+ * - uGnssMgaSend() or uGnssMgaResponseSend() with the AssistNow
+ *   data, e.g. from an HTTP GET of the path written by
+ *   uGnssMgaOnlineRequestEncode() to #U_GNSS_MGA_ONLINE_SERVER.
+ *
+ * The time and position alone typically take tens of seconds off
+ * the time to first fix from cold; ephemeris data from AssistNow
+ * Online reduces it to a few seconds.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The ubx message class of MGA messages.
+ */
+#define U_GNSS_MGA_MESSAGE_CLASS 0x13
+
+/** The server of the AssistNow Online service; the path of a
+ * request may be written with uGnssMgaOnlineRequestEncode().
+ */
+#define U_GNSS_MGA_ONLINE_SERVER "online-live1.services.u-blox.com"
+
+#ifndef U_GNSS_MGA_BUFFER_LENGTH_BYTES
+/** The size of the working buffer that uGnssMgaSend() reads
+ * aiding data into; must be larger than the largest MGA message
+ * plus #U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_LENGTH_BYTES.
+ */
+# define U_GNSS_MGA_BUFFER_LENGTH_BYTES 2048
+#endif
+
+#ifndef U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM
+/** The maximum number of MGA messages that may be awaiting an
+ * acknowledgement from the GNSS chip when using
+ * #U_GNSS_MGA_FLOW_CONTROL_SMART.
+ */
+# define U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM 8
+#endif
+
+#ifndef U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_LENGTH_BYTES
+/** The maximum number of bytes of MGA messages that may be
+ * awaiting an acknowledgement from the GNSS chip when using
+ * #U_GNSS_MGA_FLOW_CONTROL_SMART; this should not exceed the
+ * size of the receive buffer of the GNSS chip.
+ */
+# define U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_LENGTH_BYTES 1000
+#endif
+
+#ifndef U_GNSS_MGA_FLOW_CONTROL_WAIT_DELAY_MS
+/** The delay between MGA messages when using
+ * #U_GNSS_MGA_FLOW_CONTROL_WAIT.
+ */
+# define U_GNSS_MGA_FLOW_CONTROL_WAIT_DELAY_MS 20
+#endif
+
+#ifndef U_GNSS_MGA_RETRIES
+/** The number of times an MGA message that has not been
+ * acknowledged by the GNSS chip is sent again before it is
+ * given up on.
+ */
+# define U_GNSS_MGA_RETRIES 2
+#endif
+
+#ifndef U_GNSS_MGA_DATABASE_TIMEOUT_MS
+/** The maximum time to wait for the GNSS chip to finish sending
+ * its navigation database in milliseconds; the database may be
+ * several kbytes in size, which takes some seconds to arrive
+ * at 9600 baud.
+ */
+# define U_GNSS_MGA_DATABASE_TIMEOUT_MS 20000
+#endif
+
+#ifndef U_GNSS_MGA_DATABASE_TIME_ACCURACY_MS
+/** The accuracy, in milliseconds, to claim for the time sent to
+ * the GNSS chip ahead of its navigation database when it is
+ * restored at power-on, in addition to the age of the UTC clock.
+ */
+# define U_GNSS_MGA_DATABASE_TIME_ACCURACY_MS 1000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The ways of controlling the flow of MGA messages into the GNSS
+ * chip.  Where acknowledgements are used they are switched on in
+ * the GNSS chip automatically.
+ */
+typedef enum {
+    U_GNSS_MGA_FLOW_CONTROL_SIMPLE, /**< send one message, wait for it
+                                         to be acknowledged, send the
+                                         next, etc.: slowest. */
+    U_GNSS_MGA_FLOW_CONTROL_WAIT,   /**< send messages with
+                                         #U_GNSS_MGA_FLOW_CONTROL_WAIT_DELAY_MS
+                                         between them and no
+                                         acknowledgements: nothing is
+                                         known about whether they were
+                                         accepted. */
+    U_GNSS_MGA_FLOW_CONTROL_SMART   /**< keep up to
+                                         #U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM
+                                         messages in flight, written to
+                                         the GNSS chip in batches and
+                                         topped up as acknowledgements
+                                         arrive: fastest. */
+} uGnssMgaFlowControl_t;
+
+/** The outcome of sending aiding data to the GNSS chip.
+ */
+typedef struct {
+    int32_t sentNum;     /**< the number of MGA messages sent, not
+                              counting retries. */
+    int32_t ackNum;      /**< the number acknowledged by the GNSS chip. */
+    int32_t nackNum;     /**< the number rejected by the GNSS chip, e.g.
+                              because the data was out of date. */
+    int32_t retryNum;    /**< the number of times a message had to be
+                              sent again for lack of an acknowledgement. */
+    int32_t failedNum;   /**< the number given up on after
+                              #U_GNSS_MGA_RETRIES. */
+    int32_t skippedNum;  /**< the number of non-MGA messages in the
+                              aiding data, which are not sent. */
+} uGnssMgaStats_t;
+
+/** The parameters of a request to the AssistNow Online service,
+ * see uGnssMgaOnlineRequestEncode().
+ */
+typedef struct {
+    const char *pTokenStr;    /**< the authorisation token issued
+                                   by u-blox; cannot be NULL. */
+    const char *pGnssStr;     /**< the comma-separated systems to
+                                   obtain data for, e.g. "gps,gal";
+                                   NULL for GPS only. */
+    const char *pDataTypeStr; /**< the comma-separated data types to
+                                   obtain, e.g. "eph,alm,aux,pos";
+                                   NULL for "eph,alm,aux". */
+    bool positionValid;       /**< set to true if the position below
+                                   is valid, in which case ephemeris
+                                   data is only provided for the
+                                   satellites visible from there. */
+    int32_t latitudeX1e7;     /**< latitude in ten millionths of a
+                                   degree. */
+    int32_t longitudeX1e7;    /**< longitude in ten millionths of a
+                                   degree. */
+    int32_t altitudeMillimetres; /**< altitude in millimetres. */
+    int32_t radiusMillimetres; /**< the uncertainty of the position
+                                    in millimetres. */
+} uGnssMgaOnlineRequest_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Send aiding data, a sequence of ubx-format MGA messages exactly
+ * as provided by the AssistNow Online or AssistNow Offline service,
+ * to the GNSS chip.  The data is pulled in chunks by calling
+ * pReadCallback, so it may come straight from a socket or a file
+ * without being held in RAM all at once; messages which are not
+ * of class #U_GNSS_MGA_MESSAGE_CLASS are skipped.
+ *
+ * Where the transport is #U_GNSS_TRANSPORT_UBX_AT, and no stream
+ * has been set with uGnssSetAtStream(), messages are always sent
+ * one at a time and acknowledged, whatever the value of
+ * flowControl.  The GNSS API is locked for the duration.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pReadCallback   the function that provides the data:
+ *                            it should copy up to sizeBytes of data
+ *                            to pBuffer and return the number of
+ *                            bytes copied, zero at the end of the
+ *                            data or negative error code to abandon
+ *                            the operation; cannot be NULL.
+ * @param pReadCallbackParam  a parameter that will be passed to
+ *                            pReadCallback; may be NULL.
+ * @param flowControl         the flow control to use.
+ * @param[out] pStats         a place to put the outcome; may be NULL.
+ * @return                    zero on success, including the case
+ *                            where some messages were rejected by
+ *                            the GNSS chip (see pStats), else
+ *                            negative error code.
+ */
+int32_t uGnssMgaSend(uDeviceHandle_t gnssHandle,
+                     int32_t (*pReadCallback) (char *pBuffer,
+                                               size_t sizeBytes,
+                                               void *pReadCallbackParam),
+                     void *pReadCallbackParam,
+                     uGnssMgaFlowControl_t flowControl,
+                     uGnssMgaStats_t *pStats);
+
+/** As uGnssMgaSend() but for aiding data that is already in RAM,
+ * e.g. the body of an HTTP response from the AssistNow Online
+ * service.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param[in] pBuffer the aiding data; cannot be NULL.
+ * @param sizeBytes   the amount of data at pBuffer.
+ * @param flowControl the flow control to use.
+ * @param[out] pStats a place to put the outcome; may be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssMgaResponseSend(uDeviceHandle_t gnssHandle,
+                             const char *pBuffer, size_t sizeBytes,
+                             uGnssMgaFlowControl_t flowControl,
+                             uGnssMgaStats_t *pStats);
+
+/** Tell the GNSS chip the current UTC time (UBX-MGA-INI-TIME_UTC).
+ * This should be done as soon as possible after power-on, and
+ * before any other aiding data is sent, since the GNSS chip needs
+ * to know the time in order to use the other data.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param timeUtcMs   the UTC time in milliseconds since 1970; use
+ *                    a negative value to take the time from the
+ *                    UTC clock of u_time.h, see uTimeUtcGetMs().
+ * @param accuracyMs  the accuracy of the time in milliseconds;
+ *                    when timeUtcMs is negative the age of the UTC
+ *                    clock is added to this.
+ * @return            zero on success else negative error code;
+ *                    #U_ERROR_COMMON_NOT_FOUND if timeUtcMs is
+ *                    negative and the UTC clock has not been set.
+ */
+int32_t uGnssMgaIniTimeSend(uDeviceHandle_t gnssHandle,
+                            int64_t timeUtcMs, int32_t accuracyMs);
+
+/** Tell the GNSS chip its approximate position
+ * (UBX-MGA-INI-POS_LLH); the parameters are in the same units
+ * as those of uLocation_t, so the fields of a location obtained
+ * from, e.g., Cell Locate may be passed straight in.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param latitudeX1e7        latitude in ten millionths of a degree.
+ * @param longitudeX1e7       longitude in ten millionths of a degree.
+ * @param altitudeMillimetres altitude in millimetres; if this is not
+ *                            known use zero and increase
+ *                            radiusMillimetres to match.
+ * @param radiusMillimetres   the uncertainty of the position in
+ *                            millimetres.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uGnssMgaIniPosSend(uDeviceHandle_t gnssHandle,
+                           int32_t latitudeX1e7, int32_t longitudeX1e7,
+                           int32_t altitudeMillimetres,
+                           int32_t radiusMillimetres);
+
+/** Read the navigation database (ephemerides, almanac, last
+ * position, etc.) out of the GNSS chip with UBX-MGA-DBD, so that
+ * it can be kept while the GNSS chip is powered off and given
+ * back to it later, e.g. with uGnssMgaSend(), allowing a hot or
+ * warm start even where there is no back-up power.  Not supported
+ * over the AT interface unless the GNSS data is also available on
+ * a UART, see uGnssSetAtStream().
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param pWriteCallback      called with each UBX-MGA-DBD message,
+ *                            complete with its ubx protocol
+ *                            header and checksum, in the order
+ *                            they must be given back, with
+ *                            errorCode zero, and then always
+ *                            once more with pData NULL and
+ *                            sizeBytes zero to mark the end:
+ *                            errorCode is then zero if the
+ *                            database is complete, else it is
+ *                            the negative error code that this
+ *                            function will return and whatever
+ *                            has been stored should be thrown
+ *                            away.  Should return false to
+ *                            abandon the read, e.g. if the
+ *                            storage is full (the return value
+ *                            of the final call is ignored).
+ *                            Cannot be NULL.
+ * @param pWriteCallbackParam passed to pWriteCallback as its
+ *                            last parameter; may be NULL.
+ * @return                    the number of UBX-MGA-DBD messages
+ *                            passed to pWriteCallback, else
+ *                            negative error code;
+ *                            #U_ERROR_COMMON_NO_MEMORY if
+ *                            pWriteCallback returned false,
+ *                            #U_GNSS_ERROR_TRANSPORT if
+ *                            messages were lost on the way.
+ */
+int32_t uGnssMgaGetDatabase(uDeviceHandle_t gnssHandle,
+                            bool (*pWriteCallback) (const char *pData,
+                                                    size_t sizeBytes,
+                                                    int32_t errorCode,
+                                                    void *pWriteCallbackParam),
+                            void *pWriteCallbackParam);
+
+/** Have the navigation database of the GNSS chip saved when it is
+ * powered off and restored when it is powered on: uGnssPwrOff()
+ * and uGnssPwrOffBackup() will read the database out, as
+ * uGnssMgaGetDatabase() does, passing it to pWriteCallback,
+ * then uGnssPwrOn() will, if the UTC clock of u_time.h has been
+ * set, give the GNSS chip the time and then stream the saved
+ * database back in, in batches, using
+ * #U_GNSS_MGA_FLOW_CONTROL_SMART, calling pReadCallback until it
+ * returns zero.  Failure to save or restore the database does not
+ * cause the power on or power off to fail.
+ *
+ * @param gnssHandle     the handle of the GNSS instance.
+ * @param pWriteCallback the function to store the database, see
+ *                       uGnssMgaGetDatabase(); a new database
+ *                       begins with the first call after pData was
+ *                       NULL and, should errorCode be non-zero in
+ *                       that final call, what was stored before it
+ *                       is not a usable database.  Use NULL, along with a NULL
+ *                       pReadCallback, to stop saving and
+ *                       restoring the database.
+ * @param pReadCallback  the function to read the stored database
+ *                       back, which should start from the beginning
+ *                       of what was last stored each time the
+ *                       previous call returned zero; should return
+ *                       the number of bytes written to pBuffer,
+ *                       up to sizeBytes, zero when there is no
+ *                       more (or no database has been stored)
+ *                       or negative error code.
+ * @param pCallbackParam passed to both callbacks as their last
+ *                       parameter; may be NULL.
+ * @return               zero on success else negative error code.
+ */
+int32_t uGnssMgaSetDatabaseStore(uDeviceHandle_t gnssHandle,
+                                 bool (*pWriteCallback) (const char *pData,
+                                                         size_t sizeBytes,
+                                                         int32_t errorCode,
+                                                         void *pCallbackParam),
+                                 int32_t (*pReadCallback) (char *pBuffer,
+                                                           size_t sizeBytes,
+                                                           void *pCallbackParam),
+                                 void *pCallbackParam);
+
+/** Write the path, including the query string, of an HTTP GET
+ * request to the AssistNow Online service at
+ * #U_GNSS_MGA_ONLINE_SERVER; the body of the response may be
+ * passed to uGnssMgaResponseSend() or, a chunk at a time, to
+ * uGnssMgaSend().
+ *
+ * @param[in] pRequest the request parameters; cannot be NULL.
+ * @param[out] pBuffer a place to write the path, including a null
+ *                     terminator; cannot be NULL.
+ * @param sizeBytes    the amount of storage at pBuffer.
+ * @return             the length of the path (as strlen() would
+ *                     return), else negative error code;
+ *                     #U_ERROR_COMMON_NO_MEMORY if pBuffer is too
+ *                     small.
+ */
+int32_t uGnssMgaOnlineRequestEncode(const uGnssMgaOnlineRequest_t *pRequest,
+                                    char *pBuffer, size_t sizeBytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_MGA_H_
+
+// End of file
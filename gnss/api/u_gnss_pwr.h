@@ -121,7 +121,9 @@ extern "C" {
  * you must disable GNSS for Cell Locate (either by setting disableGnss
  * to true in the pLocationAssist structure when calling the location API
  * or by calling uCellLocSetGnssEnable() with false) otherwise cellLoc
- * location establishment will fail.
+ * location establishment will fail.  If uGnssMgaSetDatabaseStore()
+ * has been called, the navigation database saved at the last power
+ * off is given back to the GNSS chip.
  *
  * @param gnssHandle  the handle of the GNSS instance to power on.
  */
@@ -133,7 +135,8 @@ int32_t uGnssPwrOn(uDeviceHandle_t gnssHandle);
  */
 bool uGnssPwrIsAlive(uDeviceHandle_t gnssHandle);
 
-/** Power a GNSS chip off
+/** Power a GNSS chip off.  If uGnssMgaSetDatabaseStore() has been
+ * called, the navigation database of the GNSS chip is saved first.
  *
  * @param gnssHandle  the handle of the GNSS instance to power off.
  */
@@ -152,6 +155,10 @@ int32_t uGnssPwrOff(uDeviceHandle_t gnssHandle);
  * is connected via an intermediate [e.g. cellular] module; this is
  * because the module will be communicating with the GNSS chip over I2C.
  *
+ * If uGnssMgaSetDatabaseStore() has been called, the navigation
+ * database of the GNSS chip is saved first, in case the back-up
+ * power does not last.
+ *
  * @param gnssHandle  the handle of the GNSS instance to power on.
  */
 int32_t uGnssPwrOffBackup(uDeviceHandle_t gnssHandle);
@@ -42,6 +42,31 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A ubx message transaction, for use with
+ * uGnssUtilUbxSendReceiveMultiple().
+ */
+typedef struct {
+    int32_t messageClass; /**< the ubx message class to send. */
+    int32_t messageId;    /**< the ubx message ID to send. */
+    const char *pMessageBody; /**< the body of the message to send; may be NULL. */
+    size_t messageBodyLengthBytes; /**< the amount of data at pMessageBody; must
+                                        be zero if pMessageBody is NULL. */
+    char *pResponseBody; /**< somewhere to put the body of the response,
+                              which must have the same message class and
+                              ID as the message sent (i.e. a poll); if this
+                              is NULL then an Ack/Nack is waited for instead. */
+    size_t maxResponseBodyLengthBytes; /**< the amount of storage at
+                                            pResponseBody; must be non-zero
+                                            if pResponseBody is non-NULL. */
+    int32_t errorCodeOrResponseBodyLength; /**< set by
+                                                uGnssUtilUbxSendReceiveMultiple():
+                                                the number of bytes copied
+                                                into pResponseBody, zero for
+                                                an Ack, else negative error
+                                                code, e.g. #U_GNSS_ERROR_NACK
+                                                or #U_ERROR_COMMON_TIMEOUT. */
+} uGnssUtilUbxTransaction_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -85,6 +110,38 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                                            char *pResponse,
                                            size_t maxResponseLengthBytes);
 
+/** Send several ubx format messages to the GNSS chip and wait for
+ * all of the responses (or Ack/Nacks), which may arrive in any
+ * order.  The messages are all sent before any response is waited
+ * for, so the round-trip times of the transactions overlap; each
+ * response is matched to its transaction by message class and
+ * ID, oldest transaction first, everything else received while
+ * waiting (e.g. NMEA or unwanted ubx messages) being discarded.
+ * Unlike uGnssUtilUbxTransparentSendReceive() the messages are
+ * encoded for you.  The overall time taken is bounded by the
+ * timeout set with uGnssSetTimeout().
+ *
+ * On a streaming transport (UART or I2C) this can run alongside
+ * an asynchronous position request, see uGnssPosGetStart(); on the
+ * AT transport the transactions are simply performed one after
+ * the other.
+ *
+ * @param gnssHandle               the handle of the GNSS instance.
+ * @param[in,out] pTransactions    an array of transactions; the
+ *                                 errorCodeOrResponseBodyLength field
+ *                                 of each will be populated.
+ * @param numTransactions          the number of entries at
+ *                                 pTransactions.
+ * @return                         on success the number of transactions
+ *                                 that succeeded, else negative error
+ *                                 code; if any transaction is invalid
+ *                                 #U_ERROR_COMMON_INVALID_PARAMETER is
+ *                                 returned and nothing is sent.
+ */
+int32_t uGnssUtilUbxSendReceiveMultiple(uDeviceHandle_t gnssHandle,
+                                        uGnssUtilUbxTransaction_t *pTransactions,
+                                        size_t numTransactions);
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,8 @@
 #include "u_port_debug.h"
 #include "u_port_gpio.h"
 
+#include "u_at_client.h"
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
@@ -138,6 +140,12 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
             uGnssPrivateCleanUpPosTask(pInstance);
             // Delete the transport mutex
             uPortMutexDelete(pInstance->transportMutex);
+            // Free any navigation database store
+            free(pInstance->pDatabaseStore);
+            // Free the ubx transaction state; nothing can
+            // be waiting as the pos task has been stopped
+            free(pInstance->pUbxReceive->pBuffer);
+            free(pInstance->pUbxReceive);
             // Deallocate the uDevice instance
             uDeviceDestroyInstance(U_DEVICE_INSTANCE(pInstance->gnssHandle));
             // Unlink the instance from the list
@@ -258,6 +266,16 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                     pInstance->gnssHandle = (uDeviceHandle_t)pDevInstance;
                     pInstance->transportMutex = NULL;
                     errorCodeOrHandle = uPortMutexCreate(&pInstance->transportMutex);
+                    if (errorCodeOrHandle == 0) {
+                        // Somewhere to keep track of ubx transactions
+                        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                        pInstance->pUbxReceive = (uGnssPrivateUbxReceive_t *)
+                                                 malloc(sizeof(uGnssPrivateUbxReceive_t));
+                        if (pInstance->pUbxReceive != NULL) {
+                            memset(pInstance->pUbxReceive, 0, sizeof(*(pInstance->pUbxReceive)));
+                            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        }
+                    }
                     if (errorCodeOrHandle == 0) {
                         pInstance->transportType = transportType;
                         pInstance->pModule = &(gUGnssPrivateModuleList[moduleType]);
@@ -268,6 +286,7 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         pInstance->pinGnssEnablePower = pinGnssEnablePower;
                         pInstance->atModulePinPwr = -1;
                         pInstance->atModulePinDataReady = -1;
+                        pInstance->atStreamUartHandle = -1;
                         pInstance->portNumber = 0; // This is the I2C port number inside the GNSS chip
                         if ((transportType == U_GNSS_TRANSPORT_UBX_UART) ||
                             (transportType == U_GNSS_TRANSPORT_NMEA_UART)) {
@@ -276,6 +295,7 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         pInstance->posTask = NULL;
                         pInstance->posMutex = NULL;
                         pInstance->posTaskFlags = 0;
+                        pInstance->pDatabaseStore = NULL;
                         pInstance->pNext = NULL;
 
                         // Now set up the pins
@@ -328,6 +348,7 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         if (pInstance->transportMutex != NULL) {
                             uPortMutexDelete(pInstance->transportMutex);
                         }
+                        free(pInstance->pUbxReceive);
                         free(pInstance);
                     }
                 }
@@ -555,4 +576,77 @@ void uGnssSetUbxMessagePrint(uDeviceHandle_t gnssHandle, bool onNotOff)
     }
 }
 
+// Set the UART through which the AT module passes GNSS data.
+int32_t uGnssSetAtStream(uDeviceHandle_t gnssHandle, int32_t uartHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (pInstance->transportType == U_GNSS_TRANSPORT_UBX_AT) {
+                atHandle = (uAtClientHandle_t) pInstance->transportHandle.pAt;
+
+                U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+                // Ask the AT module to route the GNSS data flow to
+                // the stream, or to stop doing so
+                uAtClientLock(atHandle);
+                uAtClientCommandStart(atHandle, "AT+UGPRF=");
+                if (uartHandle >= 0) {
+                    uAtClientWriteInt(atHandle, U_GNSS_AT_STREAM_UGPRF_CONFIG);
+                } else {
+                    uAtClientWriteInt(atHandle, 0);
+                }
+                uAtClientCommandStopReadResponse(atHandle);
+                errorCode = uAtClientUnlock(atHandle);
+                if (errorCode == 0) {
+                    pInstance->atStreamUartHandle = uartHandle;
+                    if (uartHandle < 0) {
+                        pInstance->atStreamUartHandle = -1;
+                    }
+                }
+
+                U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the UART through which the AT module passes GNSS data.
+int32_t uGnssGetAtStream(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCodeOrUartHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrUartHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCodeOrUartHandle = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (pInstance->atStreamUartHandle >= 0) {
+                errorCodeOrUartHandle = pInstance->atStreamUartHandle;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrUartHandle;
+}
+
 // End of file
@@ -251,6 +251,8 @@ int64_t uGnssInfoGetTimeUtc(uDeviceHandle_t gnssHandle)
                     errorCodeOrTime += ((int32_t) message[17]) * 60;
                     // Second (0 to 60)
                     errorCodeOrTime += message[18];
+                    // Anchor the UTC clock to this
+                    uTimeUtcSet(errorCodeOrTime * 1000, U_TIME_UTC_SOURCE_GNSS);
 
                     uPortLog("U_GNSS_POS: UTC time is %d.\n", (int32_t) errorCodeOrTime);
                 }
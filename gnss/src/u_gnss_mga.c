@@ -0,0 +1,963 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the aiding (MGA) functions of the GNSS API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc()/free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memmove(), memset()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"  // Required by u_gnss_private.h
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+#include "u_port_i2c.h"
+
+#include "u_time.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_private.h"
+#include "u_gnss_mga.h"
+#include "u_gnss_mga_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message ID of UBX-MGA-INI.
+ */
+#define U_GNSS_MGA_MESSAGE_ID_INI 0x40
+
+/** The message ID of UBX-MGA-ACK.
+ */
+#define U_GNSS_MGA_MESSAGE_ID_ACK 0x60
+
+/** The message ID of UBX-MGA-DBD.
+ */
+#define U_GNSS_MGA_MESSAGE_ID_DBD 0x80
+
+/** The length of the body of UBX-MGA-INI-TIME_UTC.
+ */
+#define U_GNSS_MGA_INI_TIME_LENGTH_BYTES 24
+
+/** The length of the body of UBX-MGA-ACK.
+ */
+#define U_GNSS_MGA_ACK_LENGTH_BYTES 8
+
+/** The number of bytes at the start of the body of an MGA
+ * message that are reflected back in UBX-MGA-ACK.
+ */
+#define U_GNSS_MGA_PAYLOAD_START_LENGTH_BYTES 4
+
+/** The offset of the body in a ubx message.
+ */
+#define U_GNSS_MGA_BODY_OFFSET 6
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The state of an MGA message that has been sent.
+ */
+typedef enum {
+    U_GNSS_MGA_MESSAGE_STATE_PENDING,
+    U_GNSS_MGA_MESSAGE_STATE_SENT,     /**< no acknowledgement expected. */
+    U_GNSS_MGA_MESSAGE_STATE_ACK,
+    U_GNSS_MGA_MESSAGE_STATE_NACK,
+    U_GNSS_MGA_MESSAGE_STATE_FAILED
+} uGnssMgaMessageState_t;
+
+/** An MGA message that has been sent, held in the working buffer
+ * until it has been acknowledged so that it can be sent again.
+ */
+typedef struct {
+    size_t offset;      /**< where the message is in the working buffer. */
+    size_t lengthBytes; /**< the length of the whole message. */
+    int32_t id;
+    char payloadStart[U_GNSS_MGA_PAYLOAD_START_LENGTH_BYTES];
+    int32_t retries;
+    uGnssMgaMessageState_t state;
+} uGnssMgaMessage_t;
+
+/** The MGA messages in flight, oldest first.
+ */
+typedef struct {
+    uGnssMgaMessage_t message[U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM];
+    size_t num;
+} uGnssMgaInFlight_t;
+
+/** Aiding data in RAM, for bufferRead().
+ */
+typedef struct {
+    const char *pData;
+    size_t sizeBytes;
+} uGnssMgaBuffer_t;
+
+/** Context for databaseCallback().
+ */
+typedef struct {
+    bool (*pWriteCallback) (const char *, size_t, int32_t, void *);
+    void *pWriteCallbackParam;
+    char *pMessage; /**< room to put a UBX-MGA-DBD message back together. */
+    int32_t count;  /**< the number of UBX-MGA-DBD messages written. */
+    int32_t errorCode;
+} uGnssMgaDatabase_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Read callback for aiding data in RAM.
+static int32_t bufferRead(char *pBuffer, size_t sizeBytes, void *pParam)
+{
+    uGnssMgaBuffer_t *pMgaBuffer = (uGnssMgaBuffer_t *) pParam;
+
+    if (sizeBytes > pMgaBuffer->sizeBytes) {
+        sizeBytes = pMgaBuffer->sizeBytes;
+    }
+    memcpy(pBuffer, pMgaBuffer->pData, sizeBytes);
+    pMgaBuffer->pData += sizeBytes;
+    pMgaBuffer->sizeBytes -= sizeBytes;
+
+    return (int32_t) sizeBytes;
+}
+
+// Switch on acknowledgement of aiding data in the GNSS chip.
+static int32_t setAckAiding(const uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    // Enough room for the body of a UBX-CFG-NAVX5 message
+    char message[40];
+    uint16_t mask;
+    uint32_t key;
+
+    switch (pInstance->pModule->moduleType) {
+        case U_GNSS_MODULE_TYPE_M8:
+            // Poll UBX-CFG-NAVX5, so that its version is right,
+            // then write it back with only ackAiding applied
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            if (uGnssPrivateSendReceiveUbxMessage(pInstance, 0x06, 0x23,
+                                                  NULL, 0, message,
+                                                  sizeof(message)) == sizeof(message)) {
+                mask = uUbxProtocolUint16Encode(0x0400);
+                memcpy(message + 2, &mask, sizeof(mask));
+                memset(message + 4, 0, 4);
+                message[17] = 1;
+                errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x23,
+                                                       message, sizeof(message));
+            }
+            break;
+        case U_GNSS_MODULE_TYPE_M9:
+            // UBX-CFG-VALSET of CFG-NAVSPG-ACKAIDING in the RAM layer
+            message[0] = 0;
+            message[1] = 0x01;
+            message[2] = 0;
+            message[3] = 0;
+            key = uUbxProtocolUint32Encode(0x10110025);
+            memcpy(message + 4, &key, sizeof(key));
+            message[8] = 1;
+            errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
+                                                   message, 9);
+            break;
+        default:
+            break;
+    }
+
+    return errorCode;
+}
+
+// Match a UBX-MGA-ACK against the messages in flight, returning
+// false once the oldest has been dealt with.
+static bool ackCallback(int32_t messageClass, int32_t messageId,
+                        const char *pBody, size_t bodyLengthBytes,
+                        void *pCallbackParam)
+{
+    uGnssMgaInFlight_t *pInFlight = (uGnssMgaInFlight_t *) pCallbackParam;
+    uGnssMgaMessage_t *pMessage;
+
+    (void) messageClass;
+    (void) messageId;
+
+    // The body is type (1 for accepted), version (0),
+    // infoCode, msgId and then msgPayloadStart
+    if ((bodyLengthBytes >= U_GNSS_MGA_ACK_LENGTH_BYTES) && (*(pBody + 1) == 0)) {
+        for (size_t x = 0; x < pInFlight->num; x++) {
+            pMessage = &(pInFlight->message[x]);
+            if ((pMessage->state == U_GNSS_MGA_MESSAGE_STATE_PENDING) &&
+                (pMessage->id == (uint8_t) *(pBody + 3)) &&
+                (memcmp(pMessage->payloadStart, pBody + 4,
+                        sizeof(pMessage->payloadStart)) == 0)) {
+                pMessage->state = U_GNSS_MGA_MESSAGE_STATE_NACK;
+                if (*pBody == 1) {
+                    pMessage->state = U_GNSS_MGA_MESSAGE_STATE_ACK;
+                }
+                break;
+            }
+        }
+    }
+
+    return (pInFlight->num > 0) &&
+           (pInFlight->message[0].state == U_GNSS_MGA_MESSAGE_STATE_PENDING);
+}
+
+// Pass each UBX-MGA-DBD message of a navigation database dump on
+// to the caller, returning false at the UBX-MGA-ACK that ends it.
+static bool databaseCallback(int32_t messageClass, int32_t messageId,
+                             const char *pBody, size_t bodyLengthBytes,
+                             void *pCallbackParam)
+{
+    uGnssMgaDatabase_t *pDatabase = (uGnssMgaDatabase_t *) pCallbackParam;
+    bool keepGoing = true;
+    int32_t x;
+
+    (void) messageClass;
+
+    if (messageId == U_GNSS_MGA_MESSAGE_ID_DBD) {
+        // Put the header back on, since that is what has to be
+        // sent to the GNSS chip to restore it
+        x = uUbxProtocolEncode(U_GNSS_MGA_MESSAGE_CLASS, U_GNSS_MGA_MESSAGE_ID_DBD,
+                               pBody, bodyLengthBytes, pDatabase->pMessage);
+        if ((x > 0) &&
+            pDatabase->pWriteCallback(pDatabase->pMessage, (size_t) x, 0,
+                                      pDatabase->pWriteCallbackParam)) {
+            pDatabase->count++;
+        } else {
+            pDatabase->errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            keepGoing = false;
+        }
+    } else if ((messageId == U_GNSS_MGA_MESSAGE_ID_ACK) &&
+               (bodyLengthBytes >= U_GNSS_MGA_ACK_LENGTH_BYTES) &&
+               ((uint8_t) *(pBody + 3) == U_GNSS_MGA_MESSAGE_ID_DBD)) {
+        // The end: msgPayloadStart is the number of UBX-MGA-DBD
+        // messages that were sent
+        if (uUbxProtocolUint32Decode(pBody + 4) != (uint32_t) pDatabase->count) {
+            pDatabase->errorCode = (int32_t) U_GNSS_ERROR_TRANSPORT;
+        }
+        keepGoing = false;
+    }
+
+    return keepGoing;
+}
+
+// Read the navigation database out of the GNSS chip, always
+// ending with a call to pWriteCallback with pData NULL and the
+// outcome; gUGnssPrivateMutex must be locked.
+static int32_t databaseGet(const uGnssPrivateInstance_t *pInstance,
+                           bool (*pWriteCallback) (const char *, size_t, int32_t, void *),
+                           void *pWriteCallbackParam)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uGnssMgaDatabase_t database = {0};
+
+    database.pWriteCallback = pWriteCallback;
+    database.pWriteCallbackParam = pWriteCallbackParam;
+    database.pMessage = (char *) malloc(U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                                        U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+    if (database.pMessage != NULL) {
+        // With acknowledgement of aiding switched on the GNSS chip
+        // ends the dump with a UBX-MGA-ACK, otherwise we can only
+        // wait for the timeout
+        setAckAiding(pInstance);
+        // Poll with an empty UBX-MGA-DBD
+        errorCodeOrCount = uGnssPrivateSendOnlyStreamUbxMessage(pInstance,
+                                                                U_GNSS_MGA_MESSAGE_CLASS,
+                                                                U_GNSS_MGA_MESSAGE_ID_DBD,
+                                                                NULL, 0);
+        if (errorCodeOrCount >= 0) {
+            errorCodeOrCount = uGnssPrivateReceiveStreamUbxMessages(pInstance,
+                                                                    U_GNSS_MGA_MESSAGE_CLASS, -1,
+                                                                    databaseCallback, &database,
+                                                                    U_GNSS_MGA_DATABASE_TIMEOUT_MS);
+            if (errorCodeOrCount >= 0) {
+                errorCodeOrCount = database.errorCode;
+                if (errorCodeOrCount == 0) {
+                    errorCodeOrCount = database.count;
+                }
+            }
+        }
+        if (pInstance->printUbxMessages) {
+            uPortLog("U_GNSS: %d UBX-MGA-DBD message(s) read from GNSS chip (%d).\n",
+                     database.count, errorCodeOrCount);
+        }
+
+        // Free memory
+        free(database.pMessage);
+    }
+
+    // Mark the end, telling the caller whether what it has been
+    // given is a complete database or should be thrown away
+    if (errorCodeOrCount >= 0) {
+        pWriteCallback(NULL, 0, 0, pWriteCallbackParam);
+    } else {
+        pWriteCallback(NULL, 0, errorCodeOrCount, pWriteCallbackParam);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Write data to the GNSS chip over a stream.
+static int32_t streamWrite(const uGnssPrivateInstance_t *pInstance,
+                           int32_t streamType, int32_t streamHandle,
+                           const char *pData, size_t lengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
+
+    U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+    switch (streamType) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            errorCodeOrLength = uPortUartWrite(streamHandle, pData, lengthBytes);
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+            errorCodeOrLength = uPortI2cControllerSend(streamHandle, pInstance->i2cAddress,
+                                                       pData, lengthBytes, false);
+            if (errorCodeOrLength == 0) {
+                errorCodeOrLength = (int32_t) lengthBytes;
+            }
+            break;
+        default:
+            break;
+    }
+
+    U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+    if (pInstance->printUbxMessages) {
+        uPortLog("U_GNSS: sent %d byte(s) of MGA data.\n", errorCodeOrLength);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Send the oldest message in flight over AT and wait for its
+// acknowledgement.
+static void atSendAndWait(const uGnssPrivateInstance_t *pInstance,
+                          uGnssMgaInFlight_t *pInFlight, const char *pBuffer)
+{
+    uGnssMgaMessage_t *pMessage = &(pInFlight->message[0]);
+    char ack[U_GNSS_MGA_ACK_LENGTH_BYTES];
+    int32_t x;
+
+    x = uGnssPrivateSendReceiveUbxMessage(pInstance, U_GNSS_MGA_MESSAGE_CLASS,
+                                          pMessage->id,
+                                          pBuffer + pMessage->offset + U_GNSS_MGA_BODY_OFFSET,
+                                          pMessage->lengthBytes - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES,
+                                          ack, sizeof(ack));
+    if (x == (int32_t) sizeof(ack)) {
+        ackCallback(U_GNSS_MGA_MESSAGE_CLASS, U_GNSS_MGA_MESSAGE_ID_ACK,
+                    ack, sizeof(ack), pInFlight);
+    }
+}
+
+// Send aiding data; gUGnssPrivateMutex must be locked.
+static int32_t sendMga(const uGnssPrivateInstance_t *pInstance,
+                       int32_t (*pReadCallback) (char *, size_t, void *),
+                       void *pReadCallbackParam,
+                       uGnssMgaFlowControl_t flowControl,
+                       uGnssMgaStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pBuffer;
+    size_t bufferBytes = 0;
+    size_t nextOffset = 0;
+    size_t keepFrom;
+    size_t batchOffset;
+    size_t batchLength;
+    size_t inFlightBytes;
+    size_t maxNum = 1;
+    size_t x;
+    int32_t y;
+    int32_t cls;
+    int32_t id;
+    const char *pEnd;
+    bool endOfData = false;
+    int32_t streamType;
+    int32_t streamHandle = -1;
+    uGnssMgaInFlight_t inFlight;
+    uGnssMgaMessage_t *pMessage;
+
+    memset(pStats, 0, sizeof(*pStats));
+    memset(&inFlight, 0, sizeof(inFlight));
+    streamType = uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle);
+    if (streamType < 0) {
+        // AT: one at a time, always acknowledged
+        flowControl = U_GNSS_MGA_FLOW_CONTROL_SIMPLE;
+    }
+    if (flowControl == U_GNSS_MGA_FLOW_CONTROL_SMART) {
+        maxNum = U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM;
+    }
+
+    pBuffer = (char *) malloc(U_GNSS_MGA_BUFFER_LENGTH_BYTES);
+    if (pBuffer != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (flowControl != U_GNSS_MGA_FLOW_CONTROL_WAIT) {
+            errorCode = setAckAiding(pInstance);
+        }
+        while ((errorCode == 0) &&
+               (!endOfData || (nextOffset < bufferBytes) || (inFlight.num > 0))) {
+            // Move down what is still needed: messages in flight
+            // (in case they have to be sent again) and anything new
+            keepFrom = nextOffset;
+            if (inFlight.num > 0) {
+                keepFrom = inFlight.message[0].offset;
+            }
+            memmove(pBuffer, pBuffer + keepFrom, bufferBytes - keepFrom);
+            bufferBytes -= keepFrom;
+            nextOffset -= keepFrom;
+            for (x = 0; x < inFlight.num; x++) {
+                inFlight.message[x].offset -= keepFrom;
+            }
+
+            // Top up the buffer
+            if (!endOfData && (bufferBytes < U_GNSS_MGA_BUFFER_LENGTH_BYTES)) {
+                y = pReadCallback(pBuffer + bufferBytes,
+                                  U_GNSS_MGA_BUFFER_LENGTH_BYTES - bufferBytes,
+                                  pReadCallbackParam);
+                if (y < 0) {
+                    errorCode = y;
+                } else if (y == 0) {
+                    endOfData = true;
+                } else {
+                    bufferBytes += (size_t) y;
+                }
+            }
+
+            // Gather a batch of new, contiguous, messages, as
+            // many as the flow control allows
+            batchOffset = nextOffset;
+            batchLength = 0;
+            inFlightBytes = 0;
+            for (x = 0; x < inFlight.num; x++) {
+                inFlightBytes += inFlight.message[x].lengthBytes;
+            }
+            while ((errorCode == 0) && (inFlight.num < maxNum)) {
+                y = uUbxProtocolDecode(pBuffer + nextOffset, bufferBytes - nextOffset,
+                                       &cls, &id, NULL, 0, &pEnd);
+                if (y < 0) {
+                    if (y != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                        // Nothing but junk
+                        nextOffset = bufferBytes;
+                    } else if (endOfData) {
+                        // A partial message at the end: junk also
+                        nextOffset = bufferBytes;
+                    } else if ((inFlight.num == 0) && (nextOffset == 0) &&
+                               (bufferBytes == U_GNSS_MGA_BUFFER_LENGTH_BYTES)) {
+                        // A message that will never fit
+                        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    }
+                    break;
+                }
+                x = (size_t) (pEnd - pBuffer) - ((size_t) y + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                if (cls != U_GNSS_MGA_MESSAGE_CLASS) {
+                    if (batchLength > 0) {
+                        // Send what we have first
+                        break;
+                    }
+                    pStats->skippedNum++;
+                    nextOffset = (size_t) (pEnd - pBuffer);
+                    continue;
+                }
+                if (((batchLength > 0) && (x != batchOffset + batchLength)) ||
+                    ((inFlight.num > 0) &&
+                     (inFlightBytes + (size_t) y + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES >
+                      U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_LENGTH_BYTES))) {
+                    // Not contiguous or too much in flight
+                    break;
+                }
+                pMessage = &(inFlight.message[inFlight.num]);
+                memset(pMessage, 0, sizeof(*pMessage));
+                pMessage->offset = x;
+                pMessage->lengthBytes = (size_t) y + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                pMessage->id = id;
+                memcpy(pMessage->payloadStart, pBuffer + x + U_GNSS_MGA_BODY_OFFSET,
+                       y < U_GNSS_MGA_PAYLOAD_START_LENGTH_BYTES ? y : U_GNSS_MGA_PAYLOAD_START_LENGTH_BYTES);
+                pMessage->state = U_GNSS_MGA_MESSAGE_STATE_PENDING;
+                inFlight.num++;
+                if (batchLength == 0) {
+                    batchOffset = x;
+                }
+                batchLength += pMessage->lengthBytes;
+                inFlightBytes += pMessage->lengthBytes;
+                nextOffset = (size_t) (pEnd - pBuffer);
+                pStats->sentNum++;
+            }
+
+            // Send the batch in one go
+            if ((errorCode == 0) && (batchLength > 0) && (streamType >= 0)) {
+                if (streamWrite(pInstance, streamType, streamHandle,
+                                pBuffer + batchOffset, batchLength) != (int32_t) batchLength) {
+                    errorCode = (int32_t) U_GNSS_ERROR_TRANSPORT;
+                }
+            }
+
+            if ((errorCode == 0) && (inFlight.num > 0)) {
+                // Wait for the outcome
+                if (streamType < 0) {
+                    atSendAndWait(pInstance, &inFlight, pBuffer);
+                } else if (flowControl == U_GNSS_MGA_FLOW_CONTROL_WAIT) {
+                    uPortTaskBlock(U_GNSS_MGA_FLOW_CONTROL_WAIT_DELAY_MS);
+                    for (x = 0; x < inFlight.num; x++) {
+                        inFlight.message[x].state = U_GNSS_MGA_MESSAGE_STATE_SENT;
+                    }
+                } else {
+                    uGnssPrivateReceiveStreamUbxMessages(pInstance, U_GNSS_MGA_MESSAGE_CLASS,
+                                                         U_GNSS_MGA_MESSAGE_ID_ACK,
+                                                         ackCallback, &inFlight,
+                                                         pInstance->timeoutMs);
+                }
+                if (inFlight.message[0].state == U_GNSS_MGA_MESSAGE_STATE_PENDING) {
+                    // Nothing back for the oldest: send everything
+                    // that is still pending again, or give up on it
+                    for (x = 0; (x < inFlight.num) && (errorCode == 0); x++) {
+                        pMessage = &(inFlight.message[x]);
+                        if (pMessage->state == U_GNSS_MGA_MESSAGE_STATE_PENDING) {
+                            if (pMessage->retries < U_GNSS_MGA_RETRIES) {
+                                pMessage->retries++;
+                                pStats->retryNum++;
+                                // Over AT the retry is done by atSendAndWait()
+                                if ((streamType >= 0) &&
+                                    (streamWrite(pInstance, streamType, streamHandle,
+                                                 pBuffer + pMessage->offset,
+                                                 pMessage->lengthBytes) != (int32_t) pMessage->lengthBytes)) {
+                                    errorCode = (int32_t) U_GNSS_ERROR_TRANSPORT;
+                                }
+                            } else {
+                                pMessage->state = U_GNSS_MGA_MESSAGE_STATE_FAILED;
+                            }
+                        }
+                    }
+                }
+                // Retire whatever is done from the front
+                x = 0;
+                while ((x < inFlight.num) &&
+                       (inFlight.message[x].state != U_GNSS_MGA_MESSAGE_STATE_PENDING)) {
+                    switch (inFlight.message[x].state) {
+                        case U_GNSS_MGA_MESSAGE_STATE_ACK:
+                            pStats->ackNum++;
+                            break;
+                        case U_GNSS_MGA_MESSAGE_STATE_NACK:
+                            pStats->nackNum++;
+                            break;
+                        case U_GNSS_MGA_MESSAGE_STATE_FAILED:
+                            pStats->failedNum++;
+                            break;
+                        default:
+                            break;
+                    }
+                    x++;
+                }
+                inFlight.num -= x;
+                memmove(&(inFlight.message[0]), &(inFlight.message[x]),
+                        inFlight.num * sizeof(inFlight.message[0]));
+            }
+        }
+
+        if (pInstance->printUbxMessages) {
+            uPortLog("U_GNSS: MGA %d message(s) sent, %d ack, %d nack, %d retries,"
+                     " %d failed, %d skipped.\n", pStats->sentNum, pStats->ackNum,
+                     pStats->nackNum, pStats->retryNum, pStats->failedNum,
+                     pStats->skippedNum);
+        }
+
+        // Free memory
+        free(pBuffer);
+    }
+
+    return errorCode;
+}
+
+// Send a single UBX-MGA-INI message, checking that it is accepted;
+// gUGnssPrivateMutex must be locked.
+static int32_t iniSendInstance(const uGnssPrivateInstance_t *pInstance,
+                               const char *pBody, size_t bodyLengthBytes)
+{
+    int32_t errorCode;
+    char message[U_GNSS_MGA_INI_TIME_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    uGnssMgaBuffer_t mgaBuffer;
+    uGnssMgaStats_t stats;
+    int32_t x;
+
+    x = uUbxProtocolEncode(U_GNSS_MGA_MESSAGE_CLASS, U_GNSS_MGA_MESSAGE_ID_INI,
+                           pBody, bodyLengthBytes, message);
+    mgaBuffer.pData = message;
+    mgaBuffer.sizeBytes = (size_t) x;
+    errorCode = sendMga(pInstance, bufferRead, &mgaBuffer,
+                        U_GNSS_MGA_FLOW_CONTROL_SIMPLE, &stats);
+    if (errorCode == 0) {
+        if (stats.nackNum > 0) {
+            errorCode = (int32_t) U_GNSS_ERROR_NACK;
+        } else if (stats.ackNum == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        }
+    }
+
+    return errorCode;
+}
+
+// As iniSendInstance() but taking a handle.
+static int32_t iniSend(uDeviceHandle_t gnssHandle,
+                       const char *pBody, size_t bodyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = iniSendInstance(pInstance, pBody, bodyLengthBytes);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Encode the body of a UBX-MGA-INI-TIME_UTC message, which must
+// be U_GNSS_MGA_INI_TIME_LENGTH_BYTES long.
+static void iniTimeEncode(int64_t timeUtcMs, int32_t accuracyMs, char *pBody)
+{
+    int64_t seconds;
+    int32_t year;
+    int32_t month;
+    int32_t day;
+    uint16_t uint16;
+    uint32_t uint32;
+
+    memset(pBody, 0, U_GNSS_MGA_INI_TIME_LENGTH_BYTES);
+    seconds = timeUtcMs / 1000;
+    uTimeDaysToDateUtc(seconds / (3600 * 24), &year, &month, &day);
+    seconds %= 3600 * 24;
+    *pBody = 0x10; // Type: TIME_UTC
+    // Version 0 and reference "on receipt of message"
+    *(pBody + 3) = (char) -128; // Leap seconds unknown
+    uint16 = uUbxProtocolUint16Encode((uint16_t) year);
+    memcpy(pBody + 4, &uint16, sizeof(uint16));
+    *(pBody + 6) = (char) month;
+    *(pBody + 7) = (char) day;
+    *(pBody + 8) = (char) (seconds / 3600);
+    *(pBody + 9) = (char) ((seconds % 3600) / 60);
+    *(pBody + 10) = (char) (seconds % 60);
+    uint32 = uUbxProtocolUint32Encode((uint32_t) (timeUtcMs % 1000) * 1000000);
+    memcpy(pBody + 12, &uint32, sizeof(uint32));
+    uint16 = uUbxProtocolUint16Encode((uint16_t) (accuracyMs / 1000));
+    memcpy(pBody + 16, &uint16, sizeof(uint16));
+    uint32 = uUbxProtocolUint32Encode((uint32_t) (accuracyMs % 1000) * 1000000);
+    memcpy(pBody + 20, &uint32, sizeof(uint32));
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
+ * -------------------------------------------------------------- */
+
+// Save the navigation database to the store, if there is one.
+int32_t uGnssMgaPrivateDatabaseSave(const uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCodeOrCount = 0;
+    const uGnssPrivateDatabaseStore_t *pStore = pInstance->pDatabaseStore;
+
+    if (pStore != NULL) {
+        errorCodeOrCount = databaseGet(pInstance, pStore->pWriteCallback,
+                                       pStore->pCallbackParam);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Restore the navigation database from the store, if there is one.
+int32_t uGnssMgaPrivateDatabaseRestore(const uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCodeOrCount = 0;
+    const uGnssPrivateDatabaseStore_t *pStore = pInstance->pDatabaseStore;
+    char body[U_GNSS_MGA_INI_TIME_LENGTH_BYTES];
+    uGnssMgaStats_t stats;
+    int64_t timeUtcMs;
+    int32_t ageMs = 0;
+
+    if (pStore != NULL) {
+        // The ephemerides are of more use if the GNSS chip
+        // knows the time, so send that first if we have it
+        timeUtcMs = uTimeUtcGetMs(NULL, &ageMs);
+        if (timeUtcMs >= 0) {
+            iniTimeEncode(timeUtcMs, U_GNSS_MGA_DATABASE_TIME_ACCURACY_MS + ageMs, body);
+            iniSendInstance(pInstance, body, sizeof(body));
+        }
+        errorCodeOrCount = sendMga(pInstance, pStore->pReadCallback,
+                                   pStore->pCallbackParam,
+                                   U_GNSS_MGA_FLOW_CONTROL_SMART, &stats);
+        if (errorCodeOrCount == 0) {
+            errorCodeOrCount = stats.ackNum;
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Send aiding data to the GNSS chip, pulling it from a callback.
+int32_t uGnssMgaSend(uDeviceHandle_t gnssHandle,
+                     int32_t (*pReadCallback) (char *pBuffer,
+                                               size_t sizeBytes,
+                                               void *pReadCallbackParam),
+                     void *pReadCallbackParam,
+                     uGnssMgaFlowControl_t flowControl,
+                     uGnssMgaStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssMgaStats_t stats;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pReadCallback != NULL) &&
+            (flowControl >= U_GNSS_MGA_FLOW_CONTROL_SIMPLE) &&
+            (flowControl <= U_GNSS_MGA_FLOW_CONTROL_SMART)) {
+            if (pStats == NULL) {
+                pStats = &stats;
+            }
+            errorCode = sendMga(pInstance, pReadCallback, pReadCallbackParam,
+                                flowControl, pStats);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Send aiding data that is in RAM to the GNSS chip.
+int32_t uGnssMgaResponseSend(uDeviceHandle_t gnssHandle,
+                             const char *pBuffer, size_t sizeBytes,
+                             uGnssMgaFlowControl_t flowControl,
+                             uGnssMgaStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssMgaBuffer_t mgaBuffer;
+
+    if (pBuffer != NULL) {
+        mgaBuffer.pData = pBuffer;
+        mgaBuffer.sizeBytes = sizeBytes;
+        errorCode = uGnssMgaSend(gnssHandle, bufferRead, &mgaBuffer,
+                                 flowControl, pStats);
+    }
+
+    return errorCode;
+}
+
+// Send UBX-MGA-INI-TIME_UTC.
+int32_t uGnssMgaIniTimeSend(uDeviceHandle_t gnssHandle,
+                            int64_t timeUtcMs, int32_t accuracyMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    char message[U_GNSS_MGA_INI_TIME_LENGTH_BYTES];
+    int32_t ageMs = 0;
+
+    if (timeUtcMs < 0) {
+        timeUtcMs = uTimeUtcGetMs(NULL, &ageMs);
+        if (timeUtcMs < 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+        accuracyMs += ageMs;
+    }
+    if ((errorCode == 0) && (accuracyMs >= 0)) {
+        iniTimeEncode(timeUtcMs, accuracyMs, message);
+        errorCode = iniSend(gnssHandle, message, sizeof(message));
+    } else if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    return errorCode;
+}
+
+// Send UBX-MGA-INI-POS_LLH.
+int32_t uGnssMgaIniPosSend(uDeviceHandle_t gnssHandle,
+                           int32_t latitudeX1e7, int32_t longitudeX1e7,
+                           int32_t altitudeMillimetres,
+                           int32_t radiusMillimetres)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    // Enough room for the body of UBX-MGA-INI-POS_LLH
+    char message[20] = {0};
+    uint32_t uint32;
+
+    if ((latitudeX1e7 >= -900000000) && (latitudeX1e7 <= 900000000) &&
+        (longitudeX1e7 >= -1800000000) && (longitudeX1e7 <= 1800000000) &&
+        (radiusMillimetres >= 0)) {
+        message[0] = 0x01; // Type: POS_LLH, version 0
+        uint32 = uUbxProtocolUint32Encode((uint32_t) latitudeX1e7);
+        memcpy(message + 4, &uint32, sizeof(uint32));
+        uint32 = uUbxProtocolUint32Encode((uint32_t) longitudeX1e7);
+        memcpy(message + 8, &uint32, sizeof(uint32));
+        // Altitude and accuracy are in centimetres
+        uint32 = uUbxProtocolUint32Encode((uint32_t) (altitudeMillimetres / 10));
+        memcpy(message + 12, &uint32, sizeof(uint32));
+        uint32 = uUbxProtocolUint32Encode((uint32_t) (radiusMillimetres / 10));
+        memcpy(message + 16, &uint32, sizeof(uint32));
+        errorCode = iniSend(gnssHandle, message, sizeof(message));
+    }
+
+    return errorCode;
+}
+
+// Read the navigation database out of the GNSS chip.
+int32_t uGnssMgaGetDatabase(uDeviceHandle_t gnssHandle,
+                            bool (*pWriteCallback) (const char *pData,
+                                                    size_t sizeBytes,
+                                                    int32_t errorCode,
+                                                    void *pWriteCallbackParam),
+                            void *pWriteCallbackParam)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pWriteCallback != NULL)) {
+            errorCodeOrCount = databaseGet(pInstance, pWriteCallback,
+                                           pWriteCallbackParam);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Set where the navigation database is kept over power off.
+int32_t uGnssMgaSetDatabaseStore(uDeviceHandle_t gnssHandle,
+                                 bool (*pWriteCallback) (const char *pData,
+                                                         size_t sizeBytes,
+                                                         int32_t errorCode,
+                                                         void *pCallbackParam),
+                                 int32_t (*pReadCallback) (char *pBuffer,
+                                                           size_t sizeBytes,
+                                                           void *pCallbackParam),
+                                 void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && ((pWriteCallback == NULL) == (pReadCallback == NULL))) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pWriteCallback == NULL) {
+                free(pInstance->pDatabaseStore);
+                pInstance->pDatabaseStore = NULL;
+            } else {
+                if (pInstance->pDatabaseStore == NULL) {
+                    pInstance->pDatabaseStore = (uGnssPrivateDatabaseStore_t *)
+                                                malloc(sizeof(uGnssPrivateDatabaseStore_t));
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if (pInstance->pDatabaseStore != NULL) {
+                    pInstance->pDatabaseStore->pWriteCallback = pWriteCallback;
+                    pInstance->pDatabaseStore->pReadCallback = pReadCallback;
+                    pInstance->pDatabaseStore->pCallbackParam = pCallbackParam;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Write the path of an AssistNow Online request.
+int32_t uGnssMgaOnlineRequestEncode(const uGnssMgaOnlineRequest_t *pRequest,
+                                    char *pBuffer, size_t sizeBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t x;
+
+    if ((pRequest != NULL) && (pRequest->pTokenStr != NULL) &&
+        (pBuffer != NULL) && (sizeBytes > 0)) {
+        errorCodeOrLength = snprintf(pBuffer, sizeBytes,
+                                     "/GetOnlineData.ashx?token=%s;gnss=%s;datatype=%s",
+                                     pRequest->pTokenStr,
+                                     pRequest->pGnssStr != NULL ? pRequest->pGnssStr : "gps",
+                                     pRequest->pDataTypeStr != NULL ? pRequest->pDataTypeStr :
+                                     "eph,alm,aux");
+        if ((errorCodeOrLength >= 0) && (errorCodeOrLength < (int32_t) sizeBytes) &&
+            pRequest->positionValid) {
+            // Degrees to seven decimal places, whole metres
+            x = snprintf(pBuffer + errorCodeOrLength, sizeBytes - errorCodeOrLength,
+                         ";lat=%s%d.%07d;lon=%s%d.%07d;alt=%d;pacc=%d;filteronpos",
+                         pRequest->latitudeX1e7 < 0 ? "-" : "",
+                         (int) (labs(pRequest->latitudeX1e7) / 10000000),
+                         (int) (labs(pRequest->latitudeX1e7) % 10000000),
+                         pRequest->longitudeX1e7 < 0 ? "-" : "",
+                         (int) (labs(pRequest->longitudeX1e7) / 10000000),
+                         (int) (labs(pRequest->longitudeX1e7) % 10000000),
+                         (int) (pRequest->altitudeMillimetres / 1000),
+                         (int) (pRequest->radiusMillimetres / 1000));
+            errorCodeOrLength = (x >= 0) ? errorCodeOrLength + x : x;
+        }
+        if ((errorCodeOrLength < 0) || (errorCodeOrLength >= (int32_t) sizeBytes)) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// End of file
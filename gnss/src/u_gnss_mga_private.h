@@ -0,0 +1,67 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_MGA_PRIVATE_H_
+#define _U_GNSS_MGA_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines the functions that the pwr part
+ * of the GNSS API uses to save and restore the navigation database
+ * of a GNSS chip, see uGnssMgaSetDatabaseStore().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Save the navigation database of the GNSS chip to the store set
+ * by uGnssMgaSetDatabaseStore(), if there is one.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @return           the number of UBX-MGA-DBD messages saved, zero
+ *                   if there is no store, else negative error code.
+ */
+int32_t uGnssMgaPrivateDatabaseSave(const uGnssPrivateInstance_t *pInstance);
+
+/** Give the navigation database in the store set by
+ * uGnssMgaSetDatabaseStore(), if there is one, back to the
+ * GNSS chip, preceded by the time if the UTC clock is set.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @return           the number of UBX-MGA-DBD messages accepted by
+ *                   the GNSS chip, zero if there is no store, else
+ *                   negative error code.
+ */
+int32_t uGnssMgaPrivateDatabaseRestore(const uGnssPrivateInstance_t *pInstance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_GNSS_MGA_PRIVATE_H_
+
+// End of file
@@ -154,6 +154,8 @@ static int32_t posGet(const uGnssPrivateInstance_t *pInstance,
             t += ((int32_t) message[9]) * 60;
             // Second (0 to 60)
             t += message[10];
+            // Anchor the UTC clock to this
+            uTimeUtcSet(t * 1000, U_TIME_UTC_SOURCE_GNSS);
             if (printIt) {
                 uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
             }
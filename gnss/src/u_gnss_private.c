@@ -79,6 +79,14 @@
                                                 U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) * 2)
 #endif
 
+#ifndef U_GNSS_PRIVATE_UBX_TRANSACTION_POLL_MS
+/** How long to wait between looks at the stream while ubx
+ * transactions are outstanding; the transport mutex is not
+ * held during this time.
+ */
+# define U_GNSS_PRIVATE_UBX_TRANSACTION_POLL_MS 10
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -500,12 +508,30 @@ static int32_t sendReceiveUbxMessage(const uGnssPrivateInstance_t *pInstance,
                         }
                         break;
                     case U_GNSS_TRANSPORT_UBX_AT:
-                        //lint -e{1773} Suppress attempt to cast away const: I'm not!
-                        errorCodeOrResponseBodyLength = sendReceiveUbxMessageAt((const uAtClientHandle_t)
-                                                                                pInstance->transportHandle.pAt,
-                                                                                pBuffer, bytesToSend,
-                                                                                pResponse, pInstance->timeoutMs,
-                                                                                pInstance->printUbxMessages);
+                        if (pInstance->atStreamUartHandle >= 0) {
+                            // The AT module is passing the GNSS data through
+                            // on a UART of its own, so use that and leave
+                            // the AT interface free for everyone else
+                            errorCodeOrResponseBodyLength = sendUbxMessageStream(pInstance->atStreamUartHandle,
+                                                                                 U_GNSS_PRIVATE_STREAM_TYPE_UART,
+                                                                                 pInstance->i2cAddress,
+                                                                                 pBuffer, bytesToSend,
+                                                                                 pInstance->printUbxMessages);
+                            if (errorCodeOrResponseBodyLength >= 0) {
+                                errorCodeOrResponseBodyLength = receiveUbxMessageStream(pInstance->atStreamUartHandle,
+                                                                                        U_GNSS_PRIVATE_STREAM_TYPE_UART,
+                                                                                        pInstance->i2cAddress,
+                                                                                        pResponse, pInstance->timeoutMs,
+                                                                                        pInstance->printUbxMessages);
+                            }
+                        } else {
+                            //lint -e{1773} Suppress attempt to cast away const: I'm not!
+                            errorCodeOrResponseBodyLength = sendReceiveUbxMessageAt((const uAtClientHandle_t)
+                                                                                    pInstance->transportHandle.pAt,
+                                                                                    pBuffer, bytesToSend,
+                                                                                    pResponse, pInstance->timeoutMs,
+                                                                                    pInstance->printUbxMessages);
+                        }
                         break;
                     default:
                         break;
@@ -522,6 +548,140 @@ static int32_t sendReceiveUbxMessage(const uGnssPrivateInstance_t *pInstance,
     return errorCodeOrResponseBodyLength;
 }
 
+// Hand a complete ubx message, which begins at pMessage, to the
+// oldest transaction that is waiting for it, if there is one.
+// The transport mutex must be locked before this is called.
+static void ubxTransactionDeliver(const uGnssPrivateUbxReceive_t *pReceive,
+                                  const char *pMessage, size_t messageLengthBytes,
+                                  int32_t cls, int32_t id, int32_t bodyLength,
+                                  bool printIt)
+{
+    uGnssPrivateUbxTransaction_t *pTransaction = pReceive->pWaitingList;
+    char ackBody[2] = {0};
+    bool isAckNack = false;
+    bool delivered = false;
+
+    if ((cls == 0x05) && ((id == 0x00) || (id == 0x01)) && (bodyLength >= 2)) {
+        // An Ack/Nack: its body is the class and ID of what it is for
+        uUbxProtocolDecode(pMessage, messageLengthBytes, NULL, NULL,
+                           ackBody, sizeof(ackBody), NULL);
+        isAckNack = true;
+    }
+    while ((pTransaction != NULL) && !delivered) {
+        if (!pTransaction->done) {
+            if (isAckNack && (ackBody[0] == (char) pTransaction->messageClass) &&
+                (ackBody[1] == (char) pTransaction->messageId) &&
+                ((pTransaction->pResponseBody == NULL) || (id == 0x00))) {
+                // Acked or, possibly in the case of a poll, Nacked
+                pTransaction->errorCodeOrLength = (int32_t) U_GNSS_ERROR_NACK;
+                if (id == 0x01) {
+                    pTransaction->errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+                delivered = true;
+            } else if ((pTransaction->pResponseBody != NULL) &&
+                       (cls == pTransaction->messageClass) &&
+                       (id == pTransaction->messageId)) {
+                // The response to a poll
+                uUbxProtocolDecode(pMessage, messageLengthBytes, NULL, NULL,
+                                   pTransaction->pResponseBody,
+                                   pTransaction->maxResponseBodyLengthBytes, NULL);
+                pTransaction->errorCodeOrLength = bodyLength;
+                if (bodyLength > (int32_t) pTransaction->maxResponseBodyLengthBytes) {
+                    pTransaction->errorCodeOrLength =
+                        (int32_t) pTransaction->maxResponseBodyLengthBytes;
+                }
+                delivered = true;
+            }
+            pTransaction->done = delivered;
+        }
+        pTransaction = pTransaction->pNext;
+    }
+
+    if (printIt && delivered) {
+        uPortLog("U_GNSS: decoded ubx response 0x%02x 0x%02x", cls, id);
+        uPortLog(" [body %d byte(s)].\n", bodyLength);
+    }
+}
+
+// Read whatever has arrived on the stream and hand any complete
+// ubx messages to the transactions that are waiting for them.
+// The transport mutex must be locked before this is called.
+static void ubxTransactionPump(const uGnssPrivateInstance_t *pInstance,
+                               int32_t streamHandle,
+                               uGnssPrivateStreamType_t streamType)
+{
+    uGnssPrivateUbxReceive_t *pReceive = pInstance->pUbxReceive;
+    char *pBuffer = pReceive->pBuffer;
+    const char *pStart;
+    const char *pEnd;
+    int32_t receiveSize;
+    int32_t x;
+    int32_t cls;
+    int32_t id;
+
+    while ((receiveSize = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
+                                                           pInstance->i2cAddress)) > 0) {
+        if (receiveSize > U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES - pReceive->bytesKept) {
+            receiveSize = U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES - pReceive->bytesKept;
+        }
+        x = -1;
+        switch (streamType) {
+            case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+                x = uPortUartRead(streamHandle, pBuffer + pReceive->bytesKept,
+                                  (size_t) (unsigned) receiveSize);
+                break;
+            case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+                x = uPortI2cControllerSendReceive(streamHandle, pInstance->i2cAddress,
+                                                  NULL, 0, pBuffer + pReceive->bytesKept,
+                                                  (size_t) (unsigned) receiveSize);
+                break;
+            default:
+                break;
+        }
+        if (x > 0) {
+            pReceive->bytesKept += x;
+        }
+        // Decode everything that is complete, NMEA stuff and
+        // unwanted ubx messages being thrown away
+        pStart = pBuffer;
+        while ((x = uUbxProtocolDecode(pStart, pReceive->bytesKept - (pStart - pBuffer),
+                                       &cls, &id, NULL, 0, &pEnd)) >= 0) {
+            ubxTransactionDeliver(pReceive, pStart, pEnd - pStart, cls, id, x,
+                                  pInstance->printUbxMessages);
+            pStart = pEnd;
+        }
+        pReceive->bytesKept -= (int32_t) (pStart - pBuffer);
+        if (x == (int32_t) U_ERROR_COMMON_TIMEOUT) {
+            // A message has begun but is not complete: keep
+            // what's left, though no more than a maximal message
+            if (pReceive->bytesKept > U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) {
+                pStart += pReceive->bytesKept - (U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                                                 U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                pReceive->bytesKept = U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                                      U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+            }
+            memmove(pBuffer, pStart, pReceive->bytesKept);
+        } else {
+            // Nothing of use left
+            pReceive->bytesKept = 0;
+        }
+    }
+}
+
+// Return true if all of the given transactions are done.
+static bool ubxTransactionsDone(const uGnssPrivateUbxTransaction_t *pTransactions,
+                                size_t numTransactions)
+{
+    bool done = true;
+
+    for (size_t x = 0; (x < numTransactions) && done; x++) {
+        done = pTransactions[x].done;
+    }
+
+    return done;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
  * -------------------------------------------------------------- */
@@ -594,6 +754,33 @@ int32_t uGnssPrivateGetStreamType(uGnssTransportType_t transportType)
     return errorCodeOrStreamType;
 }
 
+// Get the stream type and handle to use for a GNSS instance.
+int32_t uGnssPrivateGetStreamTypeAndHandle(const uGnssPrivateInstance_t *pInstance,
+                                           int32_t *pStreamHandle)
+{
+    int32_t errorCodeOrStreamType = uGnssPrivateGetStreamType(pInstance->transportType);
+
+    *pStreamHandle = -1;
+    switch (errorCodeOrStreamType) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            *pStreamHandle = pInstance->transportHandle.uart;
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+            *pStreamHandle = pInstance->transportHandle.i2c;
+            break;
+        default:
+            errorCodeOrStreamType = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if ((pInstance->transportType == U_GNSS_TRANSPORT_UBX_AT) &&
+                (pInstance->atStreamUartHandle >= 0)) {
+                *pStreamHandle = pInstance->atStreamUartHandle;
+                errorCodeOrStreamType = (int32_t) U_GNSS_PRIVATE_STREAM_TYPE_UART;
+            }
+            break;
+    }
+
+    return errorCodeOrStreamType;
+}
+
 // Get the number of bytes waiting for us when using a streaming transport.
 int32_t uGnssPrivateStreamGetReceiveSize(int32_t streamHandle,
                                          uGnssPrivateStreamType_t streamType,
@@ -644,7 +831,7 @@ int32_t uGnssPrivateSendOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pInst
     char *pBuffer;
 
     if (pInstance != NULL) {
-        transportTypeStream = uGnssPrivateGetStreamType(pInstance->transportType);
+        transportTypeStream = uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle);
         if ((transportTypeStream >= 0) &&
             (((pMessageBody == NULL) && (messageBodyLengthBytes == 0)) ||
              (messageBodyLengthBytes > 0))) {
@@ -659,17 +846,6 @@ int32_t uGnssPrivateSendOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pInst
 
                 U_PORT_MUTEX_LOCK(pInstance->transportMutex);
 
-                switch (transportTypeStream) {
-                    case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                        streamHandle = pInstance->transportHandle.uart;
-                        break;
-                    case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                        streamHandle = pInstance->transportHandle.i2c;
-                        break;
-                    default:
-                        break;
-                }
-
                 errorCodeOrSentLength = sendUbxMessageStream(streamHandle,
                                                              (uGnssPrivateStreamType_t) transportTypeStream,
                                                              pInstance->i2cAddress,
@@ -699,9 +875,10 @@ int32_t uGnssPrivateSendOnlyCheckStreamUbxMessage(const uGnssPrivateInstance_t *
     // Message buffer for the 120-byte UBX-MON-MSGPP message
     char message[120] = {0};
     uint64_t y;
+    int32_t streamHandle;
 
     if ((pInstance != NULL) &&
-        (uGnssPrivateGetStreamType(pInstance->transportType) >= 0)) {
+        (uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle) >= 0)) {
         // Send UBX-MON-MSGPP to get the number of messages received
         errorCodeOrLength = uGnssPrivateSendReceiveUbxMessage(pInstance,
                                                               0x0a, 0x06,
@@ -752,7 +929,7 @@ int32_t uGnssPrivateReceiveOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pI
     uGnssPrivateUbxMessage_t response;
 
     if (pInstance != NULL) {
-        transportTypeStream = uGnssPrivateGetStreamType(pInstance->transportType);
+        transportTypeStream = uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle);
         if ((transportTypeStream >= 0) &&
             (((pMessageBody == NULL) && (maxBodyLengthBytes == 0)) ||
              (maxBodyLengthBytes > 0))) {
@@ -765,17 +942,6 @@ int32_t uGnssPrivateReceiveOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pI
 
             U_PORT_MUTEX_LOCK(pInstance->transportMutex);
 
-            switch (transportTypeStream) {
-                case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                    streamHandle = pInstance->transportHandle.uart;
-                    break;
-                case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                    streamHandle = pInstance->transportHandle.i2c;
-                    break;
-                default:
-                    break;
-            }
-
             errorCodeOrResponseBodyLength = receiveUbxMessageStream(streamHandle,
                                                                     (uGnssPrivateStreamType_t) transportTypeStream,
                                                                     pInstance->i2cAddress,
@@ -789,6 +955,282 @@ int32_t uGnssPrivateReceiveOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pI
     return errorCodeOrResponseBodyLength;
 }
 
+// Receive all of the wanted ubx format messages arriving on a
+// UART or I2C.
+int32_t uGnssPrivateReceiveStreamUbxMessages(const uGnssPrivateInstance_t *pInstance,
+                                             int32_t messageClass,
+                                             int32_t messageId,
+                                             bool (*pCallback) (int32_t messageClass,
+                                                                int32_t messageId,
+                                                                const char *pBody,
+                                                                size_t bodyLengthBytes,
+                                                                void *pCallbackParam),
+                                             void *pCallbackParam,
+                                             int32_t timeoutMs)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t streamType;
+    int32_t streamHandle = -1;
+    char *pBuffer;
+    char *pBody;
+    const char *pStart;
+    const char *pEnd;
+    int32_t bytesKept = 0;
+    int32_t receiveSize;
+    int32_t x;
+    int32_t cls;
+    int32_t id;
+    bool keepGoing = true;
+    int64_t startTime;
+
+    if ((pInstance != NULL) && (pCallback != NULL)) {
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        streamType = uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle);
+        if (streamType >= 0) {
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // One buffer for the raw data, followed by room
+            // for the body of a decoded message
+            pBuffer = (char *) malloc(U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES +
+                                      U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES);
+            if (pBuffer != NULL) {
+                pBody = pBuffer + U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES;
+                errorCodeOrCount = 0;
+                startTime = uPortGetTickTimeMs();
+
+                U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+                // Once told to stop, carry on only while part-way
+                // through a message, so as not to lose its end
+                while ((keepGoing || (bytesKept > 0)) &&
+                       (uPortGetTickTimeMs() - startTime < timeoutMs)) {
+                    receiveSize = uGnssPrivateStreamGetReceiveSize(streamHandle,
+                                                                   (uGnssPrivateStreamType_t) streamType,
+                                                                   pInstance->i2cAddress);
+                    if (receiveSize > 0) {
+                        if (receiveSize > U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES - bytesKept) {
+                            receiveSize = U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES - bytesKept;
+                        }
+                        x = -1;
+                        switch (streamType) {
+                            case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+                                x = uPortUartRead(streamHandle, pBuffer + bytesKept,
+                                                  (size_t) (unsigned) receiveSize);
+                                break;
+                            case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+                                x = uPortI2cControllerSendReceive(streamHandle,
+                                                                  pInstance->i2cAddress,
+                                                                  NULL, 0, pBuffer + bytesKept,
+                                                                  (size_t) (unsigned) receiveSize);
+                                break;
+                            default:
+                                break;
+                        }
+                        if (x > 0) {
+                            bytesKept += x;
+                        }
+                        // Decode everything that is complete
+                        pStart = pBuffer;
+                        while ((x = uUbxProtocolDecode(pStart, bytesKept - (pStart - pBuffer),
+                                                       &cls, &id, pBody,
+                                                       U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES,
+                                                       &pEnd)) >= 0) {
+                            if (((messageClass < 0) || (cls == messageClass)) &&
+                                ((messageId < 0) || (id == messageId))) {
+                                if (x > U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES) {
+                                    x = U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES;
+                                }
+                                if (pInstance->printUbxMessages) {
+                                    uPortLog("U_GNSS: decoded ubx message 0x%02x 0x%02x", cls, id);
+                                    if (x > 0) {
+                                        uPortLog(":");
+                                        uGnssPrivatePrintBuffer(pBody, x);
+                                    }
+                                    uPortLog(" [body %d byte(s)].\n", x);
+                                }
+                                errorCodeOrCount++;
+                                if (!pCallback(cls, id, pBody, (size_t) x, pCallbackParam)) {
+                                    keepGoing = false;
+                                }
+                            }
+                            pStart = pEnd;
+                        }
+                        bytesKept -= (int32_t) (pStart - pBuffer);
+                        if (x == (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                            // A message has begun but is not complete: keep
+                            // what's left, though no more than a maximal message
+                            if (bytesKept > U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                                U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) {
+                                pStart += bytesKept - (U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                                                       U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                                bytesKept = U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
+                                            U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                            }
+                            memmove(pBuffer, pStart, bytesKept);
+                        } else {
+                            // Nothing of use left
+                            bytesKept = 0;
+                        }
+                    } else {
+                        // Relax a little
+                        uPortTaskBlock(10);
+                    }
+                }
+
+                U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+                // Free memory
+                free(pBuffer);
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Send several ubx format messages and wait for all of the responses.
+int32_t uGnssPrivateSendReceiveUbxTransactions(const uGnssPrivateInstance_t *pInstance,
+                                               uGnssPrivateUbxTransaction_t *pTransactions,
+                                               size_t numTransactions)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssPrivateUbxReceive_t *pReceive;
+    uGnssPrivateUbxTransaction_t *pTransaction;
+    uGnssPrivateUbxTransaction_t **ppTail;
+    int32_t streamType;
+    int32_t streamHandle = -1;
+    size_t maxBodyLengthBytes = 0;
+    char *pBuffer;
+    int32_t bytesToSend;
+    int64_t startTime;
+    bool valid = true;
+    bool done = false;
+
+    if ((pInstance != NULL) && (pTransactions != NULL) && (numTransactions > 0)) {
+        for (size_t x = 0; (x < numTransactions) && valid; x++) {
+            pTransaction = &(pTransactions[x]);
+            if (((pTransaction->pMessageBody == NULL) &&
+                 (pTransaction->messageBodyLengthBytes > 0)) ||
+                ((pTransaction->pResponseBody != NULL) &&
+                 (pTransaction->maxResponseBodyLengthBytes == 0))) {
+                valid = false;
+            }
+            if (pTransaction->messageBodyLengthBytes > maxBodyLengthBytes) {
+                maxBodyLengthBytes = pTransaction->messageBodyLengthBytes;
+            }
+        }
+        if (valid) {
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            streamType = uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle);
+            if (streamType >= 0) {
+                pReceive = pInstance->pUbxReceive;
+                errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                // Allocate a buffer big enough to encode the largest outgoing message
+                pBuffer = (char *) malloc(maxBodyLengthBytes +
+                                          U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                if (pBuffer != NULL) {
+
+                    U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+                    if (pReceive->pBuffer == NULL) {
+                        // The first transaction in: this is free'd
+                        // by the last one out
+                        pReceive->pBuffer = (char *) malloc(U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES);
+                        pReceive->bytesKept = 0;
+                    }
+                    if (pReceive->pBuffer != NULL) {
+                        errorCodeOrCount = 0;
+                        ppTail = &(pReceive->pWaitingList);
+                        while (*ppTail != NULL) {
+                            ppTail = &((*ppTail)->pNext);
+                        }
+                        // Send all of the messages, adding each one to the
+                        // end of the waiting list before it is sent so that
+                        // a quick response can't be missed
+                        for (size_t x = 0; x < numTransactions; x++) {
+                            pTransaction = &(pTransactions[x]);
+                            pTransaction->errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                            pTransaction->done = false;
+                            pTransaction->pNext = NULL;
+                            *ppTail = pTransaction;
+                            ppTail = &(pTransaction->pNext);
+                            bytesToSend = uUbxProtocolEncode(pTransaction->messageClass,
+                                                             pTransaction->messageId,
+                                                             pTransaction->pMessageBody,
+                                                             pTransaction->messageBodyLengthBytes,
+                                                             pBuffer);
+                            if (bytesToSend > 0) {
+                                bytesToSend -= sendUbxMessageStream(streamHandle,
+                                                                    (uGnssPrivateStreamType_t)
+                                                                    streamType,
+                                                                    pInstance->i2cAddress,
+                                                                    pBuffer, bytesToSend,
+                                                                    pInstance->printUbxMessages);
+                            } else {
+                                bytesToSend = -1;
+                            }
+                            if (bytesToSend != 0) {
+                                pTransaction->errorCodeOrLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
+                                pTransaction->done = true;
+                            }
+                        }
+                    }
+
+                    U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+                    free(pBuffer);
+
+                    if (errorCodeOrCount == 0) {
+                        // Wait for the responses, only holding the
+                        // transport mutex while reading the stream
+                        startTime = uPortGetTickTimeMs();
+                        while (!done) {
+
+                            U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+                            ubxTransactionPump(pInstance, streamHandle,
+                                               (uGnssPrivateStreamType_t) streamType);
+                            done = ubxTransactionsDone(pTransactions, numTransactions) ||
+                                   (uPortGetTickTimeMs() - startTime >= pInstance->timeoutMs);
+                            if (done) {
+                                // Take our transactions out of the waiting list
+                                ppTail = &(pReceive->pWaitingList);
+                                while (*ppTail != NULL) {
+                                    pTransaction = *ppTail;
+                                    if ((pTransaction >= pTransactions) &&
+                                        (pTransaction < pTransactions + numTransactions)) {
+                                        *ppTail = pTransaction->pNext;
+                                        pTransaction->pNext = NULL;
+                                    } else {
+                                        ppTail = &(pTransaction->pNext);
+                                    }
+                                }
+                                if (pReceive->pWaitingList == NULL) {
+                                    free(pReceive->pBuffer);
+                                    pReceive->pBuffer = NULL;
+                                    pReceive->bytesKept = 0;
+                                }
+                            }
+
+                            U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+                            if (!done) {
+                                uPortTaskBlock(U_GNSS_PRIVATE_UBX_TRANSACTION_POLL_MS);
+                            }
+                        }
+                        for (size_t x = 0; x < numTransactions; x++) {
+                            if (pTransactions[x].errorCodeOrLength >= 0) {
+                                errorCodeOrCount++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
 // Send a ubx format message to the GNSS module and receive
 // a response back.
 int32_t uGnssPrivateSendReceiveUbxMessage(const uGnssPrivateInstance_t *pInstance,
@@ -799,18 +1241,41 @@ int32_t uGnssPrivateSendReceiveUbxMessage(const uGnssPrivateInstance_t *pInstanc
                                           char *pResponseBody,
                                           size_t maxResponseBodyLengthBytes)
 {
+    int32_t errorCodeOrResponseBodyLength;
     uGnssPrivateUbxMessage_t response;
+    uGnssPrivateUbxTransaction_t transaction;
+    int32_t streamHandle = -1;
 
-    // Fill the response structure in with the message class
-    // and ID we expect to get back and the buffer passed in.
-    response.cls = messageClass;
-    response.id = messageId;
-    response.pBody = pResponseBody;
-    response.bodyMaxLengthBytes = maxResponseBodyLengthBytes;
+    if ((pInstance != NULL) && (pResponseBody != NULL) &&
+        (uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle) >= 0)) {
+        // On a streaming transport, wait for the response
+        // without blocking the transport for others
+        transaction.messageClass = messageClass;
+        transaction.messageId = messageId;
+        transaction.pMessageBody = pMessageBody;
+        transaction.messageBodyLengthBytes = messageBodyLengthBytes;
+        transaction.pResponseBody = pResponseBody;
+        transaction.maxResponseBodyLengthBytes = maxResponseBodyLengthBytes;
+        transaction.errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        errorCodeOrResponseBodyLength = uGnssPrivateSendReceiveUbxTransactions(pInstance,
+                                                                               &transaction, 1);
+        if (errorCodeOrResponseBodyLength >= 0) {
+            errorCodeOrResponseBodyLength = transaction.errorCodeOrLength;
+        }
+    } else {
+        // Fill the response structure in with the message class
+        // and ID we expect to get back and the buffer passed in.
+        response.cls = messageClass;
+        response.id = messageId;
+        response.pBody = pResponseBody;
+        response.bodyMaxLengthBytes = maxResponseBodyLengthBytes;
+
+        errorCodeOrResponseBodyLength = sendReceiveUbxMessage(pInstance, messageClass, messageId,
+                                                              pMessageBody, messageBodyLengthBytes,
+                                                              &response);
+    }
 
-    return sendReceiveUbxMessage(pInstance, messageClass, messageId,
-                                 pMessageBody, messageBodyLengthBytes,
-                                 &response);
+    return errorCodeOrResponseBodyLength;
 }
 
 // Send a ubx format message to the GNSS module that only has an
@@ -823,27 +1288,49 @@ int32_t uGnssPrivateSendUbxMessage(const uGnssPrivateInstance_t *pInstance,
 {
     int32_t errorCode;
     uGnssPrivateUbxMessage_t response;
+    uGnssPrivateUbxTransaction_t transaction;
+    int32_t streamHandle = -1;
     char ackBody[2];
 
-    // Fill the response structure in with the message class
-    // and ID we expect to get back and the buffer passed in.
-    response.cls = 0x05;
-    response.id = -1;
-    response.pBody = ackBody;
-    response.bodyMaxLengthBytes = sizeof(ackBody);
-
-    errorCode = sendReceiveUbxMessage(pInstance, messageClass, messageId,
-                                      pMessageBody, messageBodyLengthBytes,
-                                      &response);
-    if ((errorCode == 2) && (response.cls == 0x05) &&
-        (*(response.pBody) == (char) messageClass) &&
-        (*(response.pBody + 1) == (char) messageId)) {
-        errorCode = (int32_t) U_GNSS_ERROR_NACK;
-        if (response.id == 0x01) {
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    if ((pInstance != NULL) &&
+        (uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle) >= 0)) {
+        // On a streaming transport, wait for the Ack/Nack
+        // without blocking the transport for others
+        transaction.messageClass = messageClass;
+        transaction.messageId = messageId;
+        transaction.pMessageBody = pMessageBody;
+        transaction.messageBodyLengthBytes = messageBodyLengthBytes;
+        transaction.pResponseBody = NULL;
+        transaction.maxResponseBodyLengthBytes = 0;
+        transaction.errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        errorCode = uGnssPrivateSendReceiveUbxTransactions(pInstance, &transaction, 1);
+        if (errorCode >= 0) {
+            errorCode = transaction.errorCodeOrLength;
+            if ((errorCode != 0) && (errorCode != (int32_t) U_GNSS_ERROR_NACK)) {
+                errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+            }
         }
     } else {
-        errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        // Fill the response structure in with the message class
+        // and ID we expect to get back and the buffer passed in.
+        response.cls = 0x05;
+        response.id = -1;
+        response.pBody = ackBody;
+        response.bodyMaxLengthBytes = sizeof(ackBody);
+
+        errorCode = sendReceiveUbxMessage(pInstance, messageClass, messageId,
+                                          pMessageBody, messageBodyLengthBytes,
+                                          &response);
+        if ((errorCode == 2) && (response.cls == 0x05) &&
+            (*(response.pBody) == (char) messageClass) &&
+            (*(response.pBody + 1) == (char) messageId)) {
+            errorCode = (int32_t) U_GNSS_ERROR_NACK;
+            if (response.id == 0x01) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        }
     }
 
     return errorCode;
@@ -105,6 +105,52 @@ typedef enum {
     U_GNSS_PRIVATE_STREAM_TYPE_MAX_NUM
 } uGnssPrivateStreamType_t;
 
+/** Where the navigation database of a GNSS chip is kept while it
+ * is powered off, see uGnssMgaSetDatabaseStore().
+ */
+typedef struct {
+    bool (*pWriteCallback) (const char *pData, size_t sizeBytes,
+                            int32_t errorCode, void *pCallbackParam);
+    int32_t (*pReadCallback) (char *pBuffer, size_t sizeBytes,
+                              void *pCallbackParam);
+    void *pCallbackParam;
+} uGnssPrivateDatabaseStore_t;
+
+/** A ubx transaction: a message to send to the GNSS chip and the
+ * response, or Ack/Nack, that comes back for it; see
+ * uGnssPrivateSendReceiveUbxTransactions().
+ */
+typedef struct uGnssPrivateUbxTransaction_t {
+    int32_t messageClass; /**< the ubx message class to send. */
+    int32_t messageId; /**< the ubx message ID to send. */
+    const char *pMessageBody; /**< the body of the message to send, may be NULL. */
+    size_t messageBodyLengthBytes; /**< the amount of data at pMessageBody. */
+    char *pResponseBody; /**< where to put the body of the response, which has
+                              the same message class and ID as that sent; NULL
+                              if the message is answered only by an Ack/Nack. */
+    size_t maxResponseBodyLengthBytes; /**< the amount of storage at pResponseBody. */
+    int32_t errorCodeOrLength; /**< populated by this code: the number of bytes
+                                    copied into pResponseBody (zero for an Ack
+                                    where pResponseBody is NULL), else negative
+                                    error code, e.g. U_GNSS_ERROR_NACK. */
+    bool done; /**< used internally by this code. */
+    struct uGnssPrivateUbxTransaction_t *pNext; /**< used internally by this code. */
+} uGnssPrivateUbxTransaction_t;
+
+/** The receive side of the ubx transactions in progress on a
+ * streaming transport.  Whichever waiting task holds the transport
+ * mutex reads what has arrived and hands each message to the
+ * transaction it belongs to, hence the mutex is held only for the
+ * duration of a read, not for a whole request/response, and several
+ * transactions may be outstanding at once.
+ */
+typedef struct {
+    uGnssPrivateUbxTransaction_t *pWaitingList; /**< oldest first. */
+    char *pBuffer; /**< data read but not yet decoded, only allocated
+                        while pWaitingList is non-NULL. */
+    int32_t bytesKept; /**< the amount of data at pBuffer. */
+} uGnssPrivateUbxReceive_t;
+
 /** Definition of a GNSS instance.
  * Note: a pointer to this structure is passed to the asynchronous
  * "get position" function (posGetTask()) which does NOT lock the
@@ -125,6 +171,7 @@ typedef struct uGnssPrivateInstance_t {
     int32_t pinGnssEnablePowerOnState; /**< the value to set pinGnssEnablePower to for "on". */
     int32_t atModulePinPwr; /**< the pin of the AT module that enables power to the GNSS chip (only relevant for transport type AT). */
     int32_t atModulePinDataReady; /**< the pin of the AT module that is connected to the Data Ready pin of the GNSS chip (only relevant for transport type AT). */
+    int32_t atStreamUartHandle; /**< the handle of a UART through which the AT module passes GNSS data, -1 if there is none (only relevant for transport type AT). */
     int32_t portNumber; /**< the internal port number of the GNSS device that we are connected on. */
     uPortMutexHandle_t
     transportMutex; /**< mutex so that we can have an asynchronous task use the transport. */
@@ -133,6 +180,10 @@ typedef struct uGnssPrivateInstance_t {
     uPortMutexHandle_t
     posMutex; /**< handle for mutex associated with non-blocking position establishment. */
     volatile uint8_t posTaskFlags; /**< flags to synchronisation the pos task. */
+    uGnssPrivateDatabaseStore_t
+    *pDatabaseStore; /**< where to save the navigation database on power off, NULL if nowhere. */
+    uGnssPrivateUbxReceive_t
+    *pUbxReceive; /**< the ubx transactions waiting for a response, protected by transportMutex. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
 
@@ -199,6 +250,22 @@ void uGnssPrivatePrintBuffer(const char *pBuffer,
  */
 int32_t uGnssPrivateGetStreamType(uGnssTransportType_t transportType);
 
+/** Get the stream type and stream handle that should be used to
+ * exchange data with the GNSS chip of an instance; this is the
+ * transport of the instance if that is a streaming transport or,
+ * for transport type AT, the UART set with uGnssSetAtStream(), if
+ * there is one.
+ *
+ * @param pInstance          a pointer to the GNSS instance, cannot
+ *                           be NULL.
+ * @param[out] pStreamHandle a place to put the stream handle, cannot
+ *                           be NULL.
+ * @return                   the stream type or negative error code
+ *                           if there is no stream to use.
+ */
+int32_t uGnssPrivateGetStreamTypeAndHandle(const uGnssPrivateInstance_t *pInstance,
+                                           int32_t *pStreamHandle);
+
 /** Get the number of bytes waiting for us from the GNSS chip when using
  * a streaming transport (e.g. UART or I2C).
  *
@@ -279,6 +346,68 @@ int32_t uGnssPrivateReceiveOnlyStreamUbxMessage(const uGnssPrivateInstance_t *pI
                                                 char *pMessageBody,
                                                 size_t maxBodyLengthBytes);
 
+/** Receive all of the ubx format messages with a given message class
+ * and ID that arrive on a UART or I2C, passing each one to a callback,
+ * until the callback returns false or the timeout expires.  Unlike
+ * uGnssPrivateReceiveOnlyStreamUbxMessage(), wanted messages that
+ * arrive in the same read as an earlier one are not thrown away, so
+ * this is suitable for collecting a burst of acknowledgements.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance       a pointer to the GNSS instance, cannot
+ *                        be NULL.
+ * @param messageClass    the ubx message class wanted, -1 for any.
+ * @param messageId       the ubx message ID wanted, -1 for any.
+ * @param pCallback       the function to call with the message class,
+ *                        message ID and body of each message
+ *                        received, the body truncated to
+ *                        #U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES;
+ *                        return false to stop; cannot be NULL.
+ * @param pCallbackParam  parameter passed to pCallback; may be NULL.
+ * @param timeoutMs       the maximum time to wait in milliseconds.
+ * @return                the number of messages passed to pCallback,
+ *                        else negative error code.
+ */
+int32_t uGnssPrivateReceiveStreamUbxMessages(const uGnssPrivateInstance_t *pInstance,
+                                             int32_t messageClass,
+                                             int32_t messageId,
+                                             bool (*pCallback) (int32_t messageClass,
+                                                                int32_t messageId,
+                                                                const char *pBody,
+                                                                size_t bodyLengthBytes,
+                                                                void *pCallbackParam),
+                                             void *pCallbackParam,
+                                             int32_t timeoutMs);
+
+/** Send several ubx format messages to the GNSS module and wait for
+ * all of the responses, which are matched to the messages by message
+ * class and ID (or, for an Ack/Nack, by the message class and ID
+ * it carries) as they arrive, in whatever order.  The transport
+ * mutex is not held while waiting, hence other tasks (e.g. the
+ * asynchronous position task) may have transactions outstanding
+ * at the same time.  Where several transactions are waiting for
+ * the same response they are satisfied oldest first.  Only
+ * streaming transports are supported.  Note that functions which
+ * read the stream directly, e.g.
+ * uGnssPrivateReceiveOnlyStreamUbxMessage(), will take any
+ * responses that arrive while they are running.
+ * Note: gUGnssPrivateMutex should be locked before this is called,
+ * other than from the asynchronous position task.
+ *
+ * @param pInstance         a pointer to the GNSS instance, cannot
+ *                          be NULL.
+ * @param pTransactions     an array of transactions, cannot be NULL;
+ *                          the outcome of each is written to its
+ *                          errorCodeOrLength field.
+ * @param numTransactions   the number of transactions at pTransactions.
+ * @return                  the number of transactions that succeeded,
+ *                          else negative error code (in which case
+ *                          none were sent).
+ */
+int32_t uGnssPrivateSendReceiveUbxTransactions(const uGnssPrivateInstance_t *pInstance,
+                                               uGnssPrivateUbxTransaction_t *pTransactions,
+                                               size_t numTransactions);
+
 /** Send a ubx format message to the GNSS module and, optionally, receive
  * the response.  If the message only illicites a simple Ack/Nack from the
  * module then uGnssPrivateSendUbxMessage() must be used instead.
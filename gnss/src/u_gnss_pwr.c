@@ -46,6 +46,7 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss_private.h"
+#include "u_gnss_mga_private.h"
 #include "u_gnss_pwr.h"
 
 /* ----------------------------------------------------------------
@@ -302,6 +303,12 @@ int32_t uGnssPwrOn(uDeviceHandle_t gnssHandle)
                 uPortGpioSet(pInstance->pinGnssEnablePower,
                              (int32_t) !pInstance->pinGnssEnablePowerOnState);
             }
+
+            if (errorCode == 0) {
+                // Give the GNSS chip back its navigation database,
+                // if one was saved when it was powered off
+                uGnssMgaPrivateDatabaseRestore(pInstance);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -364,6 +371,8 @@ int32_t uGnssPwrOff(uDeviceHandle_t gnssHandle)
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if (pInstance != NULL) {
+            // Save the navigation database first, if asked to
+            uGnssMgaPrivateDatabaseSave(pInstance);
             if (pInstance->transportType == U_GNSS_TRANSPORT_UBX_AT) {
                 // For the AT interface, need to ask the cellular module
                 // to power the GNSS module down
@@ -420,6 +429,9 @@ int32_t uGnssPwrOffBackup(uDeviceHandle_t gnssHandle)
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (pInstance->transportType != U_GNSS_TRANSPORT_UBX_AT) {
+                // Save the navigation database first, if asked to,
+                // in case the back-up power does not last
+                uGnssMgaPrivateDatabaseSave(pInstance);
                 // Put the GNSS chip into backup mode with UBX-RXM-PMREQ
                 // This message is not acknowledged and fiddling with the
                 // GNSS chip after this will wake it up again, so we just
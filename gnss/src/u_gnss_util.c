@@ -32,6 +32,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memset()
 
 #include "u_cfg_sw.h"
 #include "u_error_common.h"
@@ -76,6 +77,60 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Return true if all of the given ubx transactions are valid.
+static bool transactionsAreValid(const uGnssUtilUbxTransaction_t *pTransactions,
+                                 size_t numTransactions)
+{
+    bool valid = true;
+
+    for (size_t x = 0; (x < numTransactions) && valid; x++) {
+        if (((pTransactions[x].pMessageBody == NULL) &&
+             (pTransactions[x].messageBodyLengthBytes > 0)) ||
+            ((pTransactions[x].pResponseBody != NULL) &&
+             (pTransactions[x].maxResponseBodyLengthBytes == 0))) {
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+// Perform ubx transactions one after the other, for transports
+// where the responses can't be waited for together.
+static int32_t sendReceiveUbxSequential(uGnssPrivateInstance_t *pInstance,
+                                        uGnssUtilUbxTransaction_t *pTransactions,
+                                        size_t numTransactions)
+{
+    int32_t count = 0;
+    uGnssUtilUbxTransaction_t *pTransaction;
+    int32_t x;
+
+    for (size_t y = 0; y < numTransactions; y++) {
+        pTransaction = &(pTransactions[y]);
+        if (pTransaction->pResponseBody != NULL) {
+            x = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                  pTransaction->messageClass,
+                                                  pTransaction->messageId,
+                                                  pTransaction->pMessageBody,
+                                                  pTransaction->messageBodyLengthBytes,
+                                                  pTransaction->pResponseBody,
+                                                  pTransaction->maxResponseBodyLengthBytes);
+        } else {
+            x = uGnssPrivateSendUbxMessage(pInstance,
+                                           pTransaction->messageClass,
+                                           pTransaction->messageId,
+                                           pTransaction->pMessageBody,
+                                           pTransaction->messageBodyLengthBytes);
+        }
+        pTransaction->errorCodeOrResponseBodyLength = x;
+        if (x >= 0) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -111,21 +166,10 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
              (maxResponseLengthBytes > 0))) {
 
             errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
-            streamType = uGnssPrivateGetStreamType(pInstance->transportType);
+            streamType = uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle);
 
             U_PORT_MUTEX_LOCK(pInstance->transportMutex);
 
-            switch (streamType) {
-                case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                    streamHandle = pInstance->transportHandle.uart;
-                    break;
-                case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                    streamHandle = pInstance->transportHandle.i2c;
-                    break;
-                default:
-                    break;
-            }
-
             if (streamHandle >= 0) {
                 // Streaming transport
                 switch (streamType) {
@@ -268,4 +312,63 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
     return errorCodeOrResponseLength;
 }
 
+// Send several ubx messages and wait for all of the responses.
+int32_t uGnssUtilUbxSendReceiveMultiple(uDeviceHandle_t gnssHandle,
+                                        uGnssUtilUbxTransaction_t *pTransactions,
+                                        size_t numTransactions)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateUbxTransaction_t *pPrivate;
+    uGnssUtilUbxTransaction_t *pTransaction;
+    int32_t streamHandle = -1;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pTransactions != NULL) && (numTransactions > 0) &&
+            transactionsAreValid(pTransactions, numTransactions)) {
+            if (uGnssPrivateGetStreamTypeAndHandle(pInstance, &streamHandle) >= 0) {
+                // Streaming transport: send them all and then wait
+                errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pPrivate = (uGnssPrivateUbxTransaction_t *) malloc(sizeof(*pPrivate) *
+                                                                   numTransactions);
+                if (pPrivate != NULL) {
+                    memset(pPrivate, 0, sizeof(*pPrivate) * numTransactions);
+                    for (size_t x = 0; x < numTransactions; x++) {
+                        pTransaction = &(pTransactions[x]);
+                        pPrivate[x].messageClass = pTransaction->messageClass;
+                        pPrivate[x].messageId = pTransaction->messageId;
+                        pPrivate[x].pMessageBody = pTransaction->pMessageBody;
+                        pPrivate[x].messageBodyLengthBytes = pTransaction->messageBodyLengthBytes;
+                        pPrivate[x].pResponseBody = pTransaction->pResponseBody;
+                        pPrivate[x].maxResponseBodyLengthBytes =
+                            pTransaction->maxResponseBodyLengthBytes;
+                    }
+                    errorCodeOrCount = uGnssPrivateSendReceiveUbxTransactions(pInstance, pPrivate,
+                                                                              numTransactions);
+                    if (errorCodeOrCount >= 0) {
+                        for (size_t x = 0; x < numTransactions; x++) {
+                            pTransactions[x].errorCodeOrResponseBodyLength =
+                                pPrivate[x].errorCodeOrLength;
+                        }
+                    }
+                    free(pPrivate);
+                }
+            } else {
+                // AT transport: one at a time
+                errorCodeOrCount = sendReceiveUbxSequential(pInstance, pTransactions,
+                                                            numTransactions);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
 // End of file
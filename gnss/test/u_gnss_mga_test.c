@@ -0,0 +1,591 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS aiding (MGA) API: these should pass on all
+ * platforms that have a GNSS module connected to them.  They
+ * are only compiled if U_CFG_TEST_GNSS_MODULE_TYPE is defined.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_TEST_GNSS_MODULE_TYPE
+
+# ifdef U_CFG_OVERRIDE
+#  include "u_cfg_override.h" // For a customer's configuration override
+# endif
+
+#include "stdlib.h"    // malloc()/free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // strcmp()
+#include "limits.h"    // INT_MIN
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"   // Required by u_gnss_private.h
+#include "u_port_uart.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_pos.h"
+#include "u_gnss_pwr.h"
+#include "u_gnss_util.h"
+#include "u_gnss_mga.h"
+#include "u_gnss_private.h"
+
+#include "u_gnss_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_MGA_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_MGA_TEST_TIMEOUT_SECONDS
+/** The timeout on position establishment.
+ */
+# define U_GNSS_MGA_TEST_TIMEOUT_SECONDS 240
+#endif
+
+#ifndef U_GNSS_MGA_TEST_RESET_TIME_SECONDS
+/** How long to wait for the GNSS chip to come back after a
+ * cold start.
+ */
+# define U_GNSS_MGA_TEST_RESET_TIME_SECONDS 2
+#endif
+
+#ifndef U_GNSS_MGA_TEST_DATABASE_LENGTH_BYTES
+/** Room for the navigation database of the GNSS chip.
+ */
+# define U_GNSS_MGA_TEST_DATABASE_LENGTH_BYTES (1024 * 16)
+#endif
+
+#ifndef U_GNSS_MGA_TEST_SEND_NUM
+/** The number of MGA messages to send in the gnssMgaSend test;
+ * more than #U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM so that the
+ * messages in flight have to be topped up as acknowledgements
+ * arrive.
+ */
+# define U_GNSS_MGA_TEST_SEND_NUM ((U_GNSS_MGA_FLOW_CONTROL_SMART_MAX_NUM * 2) + 1)
+#endif
+
+/** The length of a UBX-MGA-INI-POS_LLH message, including the
+ * ubx protocol overhead.
+ */
+#define U_GNSS_MGA_TEST_INI_POS_LENGTH_BYTES (20 + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A navigation database store in RAM.
+ */
+typedef struct {
+    char *pBuffer;
+    size_t maxLengthBytes;
+    size_t lengthBytes;
+    size_t readOffset;
+    size_t endCount;
+    size_t abortCount;
+} uGnssMgaTestDatabase_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Used for keepGoingCallback() timeout.
+ */
+static int64_t gStopTimeMs;
+
+/** Handles.
+ */
+static uGnssTestPrivate_t gHandles = U_GNSS_TEST_PRIVATE_DEFAULTS;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Callback function for the position establishment process.
+static bool keepGoingCallback(uDeviceHandle_t gnssHandle)
+{
+    bool keepGoing = true;
+
+    U_PORT_TEST_ASSERT(gnssHandle == gHandles.gnssHandle);
+    if (uPortGetTickTimeMs() > gStopTimeMs) {
+        keepGoing = false;
+    }
+
+    return keepGoing;
+}
+
+// Write callback for the navigation database.
+static bool databaseWrite(const char *pData, size_t sizeBytes,
+                          int32_t errorCode, void *pParam)
+{
+    uGnssMgaTestDatabase_t *pDatabase = (uGnssMgaTestDatabase_t *) pParam;
+    bool success = true;
+
+    if (pData == NULL) {
+        pDatabase->endCount++;
+        if (errorCode != 0) {
+            // Not a usable database, throw it away
+            pDatabase->abortCount++;
+            pDatabase->lengthBytes = 0;
+        }
+    } else {
+        if (pDatabase->endCount > 0) {
+            // A new database
+            pDatabase->lengthBytes = 0;
+            pDatabase->endCount = 0;
+            pDatabase->abortCount = 0;
+        }
+        if (pDatabase->lengthBytes + sizeBytes <= pDatabase->maxLengthBytes) {
+            memcpy(pDatabase->pBuffer + pDatabase->lengthBytes, pData, sizeBytes);
+            pDatabase->lengthBytes += sizeBytes;
+        } else {
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+// Read callback for the navigation database.
+static int32_t databaseRead(char *pBuffer, size_t sizeBytes, void *pParam)
+{
+    uGnssMgaTestDatabase_t *pDatabase = (uGnssMgaTestDatabase_t *) pParam;
+
+    if (sizeBytes > pDatabase->lengthBytes - pDatabase->readOffset) {
+        sizeBytes = pDatabase->lengthBytes - pDatabase->readOffset;
+    }
+    memcpy(pBuffer, pDatabase->pBuffer + pDatabase->readOffset, sizeBytes);
+    pDatabase->readOffset += sizeBytes;
+
+    return (int32_t) sizeBytes;
+}
+
+// Encode a UBX-MGA-INI-POS_LLH message into pBuffer, which must be
+// at least U_GNSS_MGA_TEST_INI_POS_LENGTH_BYTES long.
+static int32_t iniPosEncode(int32_t latitudeX1e7, int32_t longitudeX1e7,
+                            int32_t altitudeMillimetres, int32_t radiusMillimetres,
+                            char *pBuffer)
+{
+    char body[U_GNSS_MGA_TEST_INI_POS_LENGTH_BYTES - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES] = {0};
+    uint32_t uint32;
+
+    body[0] = 0x01; // Type: POS_LLH, version 0
+    uint32 = uUbxProtocolUint32Encode((uint32_t) latitudeX1e7);
+    memcpy(body + 4, &uint32, sizeof(uint32));
+    uint32 = uUbxProtocolUint32Encode((uint32_t) longitudeX1e7);
+    memcpy(body + 8, &uint32, sizeof(uint32));
+    // Altitude and accuracy are in centimetres
+    uint32 = uUbxProtocolUint32Encode((uint32_t) (altitudeMillimetres / 10));
+    memcpy(body + 12, &uint32, sizeof(uint32));
+    uint32 = uUbxProtocolUint32Encode((uint32_t) (radiusMillimetres / 10));
+    memcpy(body + 16, &uint32, sizeof(uint32));
+
+    return uUbxProtocolEncode(U_GNSS_MGA_MESSAGE_CLASS, 0x40, body, sizeof(body), pBuffer);
+}
+
+// Cold start the GNSS chip, throwing away everything it knows.
+static void coldStart(uDeviceHandle_t gnssHandle)
+{
+    // Body of UBX-CFG-RST: clear all of battery-backed RAM and do
+    // a controlled software reset of GNSS only
+    const char body[] = {(char) 0xff, (char) 0xff, 0x02, 0x00};
+    char message[sizeof(body) + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t length;
+
+    length = uUbxProtocolEncode(0x06, 0x04, body, sizeof(body), message);
+    U_PORT_TEST_ASSERT(length == sizeof(message));
+    // There is no response to UBX-CFG-RST
+    U_PORT_TEST_ASSERT(uGnssUtilUbxTransparentSendReceive(gnssHandle, message,
+                                                          length, NULL, 0) >= 0);
+    uPortTaskBlock(U_GNSS_MGA_TEST_RESET_TIME_SECONDS * 1000);
+}
+
+// Measure the time to first fix in milliseconds.
+static int32_t timeToFirstFix(uDeviceHandle_t gnssHandle,
+                              int32_t *pLatitudeX1e7,
+                              int32_t *pLongitudeX1e7,
+                              int32_t *pAltitudeMillimetres,
+                              int32_t *pRadiusMillimetres)
+{
+    int64_t startTime = uPortGetTickTimeMs();
+    int32_t speedMillimetresPerSecond;
+    int32_t svs;
+    int64_t timeUtc;
+
+    gStopTimeMs = startTime + U_GNSS_MGA_TEST_TIMEOUT_SECONDS * 1000;
+    U_PORT_TEST_ASSERT(uGnssPosGet(gnssHandle, pLatitudeX1e7, pLongitudeX1e7,
+                                   pAltitudeMillimetres, pRadiusMillimetres,
+                                   &speedMillimetresPerSecond, &svs, &timeUtc,
+                                   keepGoingCallback) == 0);
+
+    return (int32_t) (uPortGetTickTimeMs() - startTime);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test writing an AssistNow Online request.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaOnlineRequest")
+{
+    uGnssMgaOnlineRequest_t request = {0};
+    char buffer[160];
+    int32_t length;
+
+    request.pTokenStr = "abc";
+    U_PORT_TEST_ASSERT(uGnssMgaOnlineRequestEncode(NULL, buffer, sizeof(buffer)) < 0);
+    length = uGnssMgaOnlineRequestEncode(&request, buffer, sizeof(buffer));
+    U_TEST_PRINT_LINE("request \"%s\".", buffer);
+    U_PORT_TEST_ASSERT(length == (int32_t) strlen(buffer));
+    U_PORT_TEST_ASSERT(strcmp(buffer, "/GetOnlineData.ashx?token=abc;"
+                              "gnss=gps;datatype=eph,alm,aux") == 0);
+
+    request.pGnssStr = "gps,gal";
+    request.pDataTypeStr = "eph";
+    request.positionValid = true;
+    request.latitudeX1e7 = 523012345;
+    request.longitudeX1e7 = -1234567;
+    request.altitudeMillimetres = 100000;
+    request.radiusMillimetres = 5000000;
+    length = uGnssMgaOnlineRequestEncode(&request, buffer, sizeof(buffer));
+    U_TEST_PRINT_LINE("request \"%s\".", buffer);
+    U_PORT_TEST_ASSERT(length == (int32_t) strlen(buffer));
+    U_PORT_TEST_ASSERT(strcmp(buffer, "/GetOnlineData.ashx?token=abc;gnss=gps,gal;"
+                              "datatype=eph;lat=52.3012345;lon=-0.1234567;"
+                              "alt=100;pacc=5000;filteronpos") == 0);
+
+    // Too short
+    U_PORT_TEST_ASSERT(uGnssMgaOnlineRequestEncode(&request, buffer,
+                                                   length) == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+}
+
+/** Measure the time to first fix from cold with and without
+ * time and position aiding.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaTtff")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t latitudeX1e7 = INT_MIN;
+    int32_t longitudeX1e7 = INT_MIN;
+    int32_t altitudeMillimetres = INT_MIN;
+    int32_t radiusMillimetres = INT_MIN;
+    int32_t ttffMs[2];
+    int32_t x;
+    int32_t heapUsed;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Only need to do this on one transport
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    U_PORT_TEST_ASSERT(iterations > 0);
+    U_TEST_PRINT_LINE("testing aiding on transport %s...",
+                      pGnssTestPrivateTransportTypeName(transportTypes[0]));
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                transportTypes[0], &gHandles, true,
+                                                U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+    gnssHandle = gHandles.gnssHandle;
+
+    // So that we can see what we're doing
+    uGnssSetUbxMessagePrint(gnssHandle, true);
+
+    // Get a fix first: this gives us a position and sets the
+    // UTC clock, standing in for what would come from cellular
+    U_TEST_PRINT_LINE("getting an initial fix...");
+    timeToFirstFix(gnssHandle, &latitudeX1e7, &longitudeX1e7,
+                   &altitudeMillimetres, &radiusMillimetres);
+
+    // Stop the position being too good to be true
+    if (radiusMillimetres < 100000) {
+        radiusMillimetres = 100000;
+    }
+
+    U_TEST_PRINT_LINE("cold start, no aiding...");
+    coldStart(gnssHandle);
+    ttffMs[0] = timeToFirstFix(gnssHandle, &x, &x, &x, &x);
+
+    U_TEST_PRINT_LINE("cold start, aiding with time and position...");
+    coldStart(gnssHandle);
+    U_PORT_TEST_ASSERT(uGnssMgaIniTimeSend(gnssHandle, -1, 1000) == 0);
+    U_PORT_TEST_ASSERT(uGnssMgaIniPosSend(gnssHandle, latitudeX1e7, longitudeX1e7,
+                                          altitudeMillimetres, radiusMillimetres) == 0);
+    ttffMs[1] = timeToFirstFix(gnssHandle, &x, &x, &x, &x);
+
+    U_TEST_PRINT_LINE("time to first fix from cold: %d ms without aiding,"
+                      " %d ms with time and position aiding.", ttffMs[0], ttffMs[1]);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uGnssTestPrivatePostamble(&gHandles, false);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Save the navigation database of the GNSS chip across a power
+ * cycle and give it back after a cold start.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaDatabase")
+{
+    uDeviceHandle_t gnssHandle;
+    uGnssMgaTestDatabase_t database = {0};
+    uGnssMgaStats_t stats;
+    int32_t ttffMs;
+    int32_t x;
+    int32_t heapUsed;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    U_PORT_TEST_ASSERT(iterations > 0);
+    U_TEST_PRINT_LINE("testing navigation database on transport %s...",
+                      pGnssTestPrivateTransportTypeName(transportTypes[0]));
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                transportTypes[0], &gHandles, true,
+                                                U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+    gnssHandle = gHandles.gnssHandle;
+
+    database.pBuffer = (char *) malloc(U_GNSS_MGA_TEST_DATABASE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(database.pBuffer != NULL);
+
+    // Get a fix so that there is something in the database
+    U_TEST_PRINT_LINE("getting a fix...");
+    timeToFirstFix(gnssHandle, &x, &x, &x, &x);
+
+    // A store that is too small should be told that what it
+    // has been given is not a usable database
+    U_TEST_PRINT_LINE("reading the navigation database into too small a store...");
+    database.maxLengthBytes = 1;
+    U_PORT_TEST_ASSERT(uGnssMgaGetDatabase(gnssHandle, databaseWrite,
+                                           &database) == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+    U_PORT_TEST_ASSERT(database.endCount == 1);
+    U_PORT_TEST_ASSERT(database.abortCount == 1);
+    U_PORT_TEST_ASSERT(database.lengthBytes == 0);
+    database.maxLengthBytes = U_GNSS_MGA_TEST_DATABASE_LENGTH_BYTES;
+
+    // Power off and on again, saving and restoring the database
+    U_PORT_TEST_ASSERT(uGnssMgaSetDatabaseStore(gnssHandle, databaseWrite, NULL,
+                                                &database) < 0);
+    U_PORT_TEST_ASSERT(uGnssMgaSetDatabaseStore(gnssHandle, databaseWrite, databaseRead,
+                                                &database) == 0);
+    U_PORT_TEST_ASSERT(uGnssPwrOff(gnssHandle) == 0);
+    U_TEST_PRINT_LINE("%d byte(s) of navigation database saved.",
+                      (int) database.lengthBytes);
+    U_PORT_TEST_ASSERT(database.lengthBytes > 0);
+    U_PORT_TEST_ASSERT(database.endCount == 1);
+    U_PORT_TEST_ASSERT(database.abortCount == 0);
+    U_PORT_TEST_ASSERT(uGnssPwrOn(gnssHandle) == 0);
+    U_PORT_TEST_ASSERT(database.readOffset == database.lengthBytes);
+    U_PORT_TEST_ASSERT(uGnssMgaSetDatabaseStore(gnssHandle, NULL, NULL, NULL) == 0);
+
+    // Now throw everything away and give the database back by hand
+    U_TEST_PRINT_LINE("cold start, restoring navigation database...");
+    coldStart(gnssHandle);
+    U_PORT_TEST_ASSERT(uGnssMgaIniTimeSend(gnssHandle, -1, 1000) == 0);
+    U_PORT_TEST_ASSERT(uGnssMgaResponseSend(gnssHandle, database.pBuffer,
+                                            database.lengthBytes,
+                                            U_GNSS_MGA_FLOW_CONTROL_SMART,
+                                            &stats) == 0);
+    U_TEST_PRINT_LINE("%d message(s) sent, %d acknowledged.", stats.sentNum, stats.ackNum);
+    U_PORT_TEST_ASSERT(stats.sentNum > 0);
+    U_PORT_TEST_ASSERT(stats.ackNum > 0);
+    ttffMs = timeToFirstFix(gnssHandle, &x, &x, &x, &x);
+    U_TEST_PRINT_LINE("time to first fix with restored navigation database %d ms.", ttffMs);
+
+    free(database.pBuffer);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uGnssTestPrivatePostamble(&gHandles, false);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Send a buffer of many MGA messages, plus one that is not an
+ * MGA message, with uGnssMgaSend() and smart flow control, i.e.
+ * in batches, and check that every MGA message is acknowledged.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaSend")
+{
+    uDeviceHandle_t gnssHandle;
+    uGnssMgaTestDatabase_t aiding = {0};
+    uGnssMgaStats_t stats;
+    int32_t latitudeX1e7 = INT_MIN;
+    int32_t longitudeX1e7 = INT_MIN;
+    int32_t altitudeMillimetres = INT_MIN;
+    int32_t radiusMillimetres = INT_MIN;
+    int32_t x;
+    int32_t heapUsed;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    U_PORT_TEST_ASSERT(iterations > 0);
+    U_TEST_PRINT_LINE("testing batched aiding on transport %s...",
+                      pGnssTestPrivateTransportTypeName(transportTypes[0]));
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                transportTypes[0], &gHandles, true,
+                                                U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+    gnssHandle = gHandles.gnssHandle;
+
+    // Get a fix so that the aiding positions are believable
+    U_TEST_PRINT_LINE("getting a fix...");
+    timeToFirstFix(gnssHandle, &latitudeX1e7, &longitudeX1e7,
+                   &altitudeMillimetres, &radiusMillimetres);
+    if (radiusMillimetres < 100000) {
+        radiusMillimetres = 100000;
+    }
+
+    // Fill a buffer with UBX-MGA-INI-POS_LLH messages, putting
+    // a non-MGA message (a poll of UBX-MON-VER) in the middle
+    aiding.pBuffer = (char *) malloc((U_GNSS_MGA_TEST_SEND_NUM *
+                                      U_GNSS_MGA_TEST_INI_POS_LENGTH_BYTES) +
+                                     U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(aiding.pBuffer != NULL);
+    for (x = 0; x < U_GNSS_MGA_TEST_SEND_NUM; x++) {
+        if (x == U_GNSS_MGA_TEST_SEND_NUM / 2) {
+            aiding.lengthBytes += uUbxProtocolEncode(0x0a, 0x04, NULL, 0,
+                                                     aiding.pBuffer + aiding.lengthBytes);
+        }
+        aiding.lengthBytes += iniPosEncode(latitudeX1e7, longitudeX1e7,
+                                           altitudeMillimetres,
+                                           radiusMillimetres + (x * 1000),
+                                           aiding.pBuffer + aiding.lengthBytes);
+    }
+
+    U_TEST_PRINT_LINE("sending %d MGA message(s) (%d byte(s)) with smart flow control...",
+                      U_GNSS_MGA_TEST_SEND_NUM, (int) aiding.lengthBytes);
+    U_PORT_TEST_ASSERT(uGnssMgaSend(gnssHandle, databaseRead, &aiding,
+                                    U_GNSS_MGA_FLOW_CONTROL_SMART, &stats) == 0);
+    U_TEST_PRINT_LINE("%d sent, %d acknowledged, %d rejected, %d retried, %d failed,"
+                      " %d skipped.", stats.sentNum, stats.ackNum, stats.nackNum,
+                      stats.retryNum, stats.failedNum, stats.skippedNum);
+    U_PORT_TEST_ASSERT(aiding.readOffset == aiding.lengthBytes);
+    U_PORT_TEST_ASSERT(stats.sentNum == U_GNSS_MGA_TEST_SEND_NUM);
+    U_PORT_TEST_ASSERT(stats.ackNum == U_GNSS_MGA_TEST_SEND_NUM);
+    U_PORT_TEST_ASSERT(stats.nackNum == 0);
+    U_PORT_TEST_ASSERT(stats.failedNum == 0);
+    U_PORT_TEST_ASSERT(stats.skippedNum == 1);
+
+    free(aiding.pBuffer);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uGnssTestPrivatePostamble(&gHandles, false);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssMga]", "gnssMgaCleanUp")
+{
+    int32_t x;
+
+    uGnssTestPrivateCleanup(&gHandles);
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("main task stack had a minimum of %d byte(s) free at the end of these tests.",
+                          x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free at the end of these tests.", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+#endif // #ifdef U_CFG_TEST_GNSS_MODULE_TYPE
+
+// End of file
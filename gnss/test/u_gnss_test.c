@@ -36,7 +36,8 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcmp()
+#include "string.h"    // memcmp(), strcmp(), strlen()
+#include "stdio.h"     // snprintf()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -51,6 +52,9 @@
 #include "u_port_uart.h"
 #include "u_port_i2c.h"
 
+#include "u_at_client.h"
+#include "u_at_client_stream_memory.h"
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
@@ -82,6 +86,13 @@
 # endif
 #endif
 
+#ifndef U_GNSS_TEST_AT_STREAM_COMMAND_MAX_LENGTH_BYTES
+/** The maximum length of AT command that the simulated module of
+ * the gnssAtStream test will capture.
+ */
+# define U_GNSS_TEST_AT_STREAM_COMMAND_MAX_LENGTH_BYTES 32
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -102,10 +113,49 @@ static uGnssTransportType_t gTransportTypeA = U_GNSS_TRANSPORT_NONE;
  */
 static int32_t gUartBHandle = -1;
 
+/** Handle of the memory stream used by the gnssAtStream test.
+ */
+static int32_t gMemoryStreamHandle = -1;
+
+/** The last AT command received by the simulated module of the
+ * gnssAtStream test, null terminated.
+ */
+static char gAtStreamCommand[U_GNSS_TEST_AT_STREAM_COMMAND_MAX_LENGTH_BYTES];
+
+/** The number of characters in gAtStreamCommand.
+ */
+static size_t gAtStreamCommandLength = 0;
+
+/** The response that the simulated module of the gnssAtStream
+ * test gives to an AT command.
+ */
+static const char *gpAtStreamResponse = "\r\nOK\r\n";
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Transmit callback for the memory stream of the gnssAtStream
+// test: capture the AT command and, once it is complete, respond
+// with gpAtStreamResponse.
+static void atStreamTransmitCallback(int32_t streamHandle, const char *pData,
+                                     size_t size, void *pParam)
+{
+    (void) pParam;
+
+    for (size_t x = 0; x < size; x++) {
+        if (pData[x] == '\r') {
+            gAtStreamCommand[gAtStreamCommandLength] = 0;
+            gAtStreamCommandLength = 0;
+            uAtClientStreamMemoryPush(streamHandle, gpAtStreamResponse,
+                                      strlen(gpAtStreamResponse));
+        } else if (gAtStreamCommandLength < sizeof(gAtStreamCommand) - 1) {
+            gAtStreamCommand[gAtStreamCommandLength] = pData[x];
+            gAtStreamCommandLength++;
+        }
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -211,6 +261,13 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssAddStream")
         U_PORT_TEST_ASSERT(uGnssGetUbxMessagePrint(gnssHandleA));
     }
 
+    // Passing GNSS data through a separate stream only applies to
+    // the AT transport
+    U_PORT_TEST_ASSERT(uGnssGetAtStream(gnssHandleA) < 0);
+    U_PORT_TEST_ASSERT(uGnssSetAtStream(gnssHandleA, 0) ==
+                       (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+    U_PORT_TEST_ASSERT(uGnssGetAtStream(gnssHandleA) < 0);
+
 # if (U_CFG_APP_GNSS_I2C < 0)
     U_TEST_PRINT_LINE("adding another instance on the same UART"
                       " port, should fail...");
@@ -475,6 +532,80 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssI2cAddress")
 }
 #endif
 
+/** Test passing the GNSS data flow from an intermediate AT module
+ * through to a separate UART with uGnssSetAtStream(), using a
+ * simulated module on a memory stream; only the AT side is tested,
+ * no GNSS traffic is exchanged.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssAtStream")
+{
+    uAtClientHandle_t atClientHandle;
+    uGnssTransportHandle_t transportHandle;
+    uDeviceHandle_t gnssHandle = NULL;
+    char command[U_GNSS_TEST_AT_STREAM_COMMAND_MAX_LENGTH_BYTES];
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    gMemoryStreamHandle = uAtClientStreamMemoryOpen(U_AT_CLIENT_BUFFER_LENGTH_BYTES,
+                                                    atStreamTransmitCallback,
+                                                    NULL);
+    U_PORT_TEST_ASSERT(gMemoryStreamHandle >= 0);
+    atClientHandle = uAtClientAdd(gMemoryStreamHandle, U_AT_CLIENT_STREAM_TYPE_MEMORY,
+                                  NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    transportHandle.pAt = (void *) atClientHandle;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M8, U_GNSS_TRANSPORT_UBX_AT,
+                                transportHandle, -1, false, &gnssHandle) == 0);
+    U_PORT_TEST_ASSERT(uGnssGetAtStream(gnssHandle) < 0);
+
+    // The handle is only stored, nothing is sent over it here,
+    // so any non-negative value will do
+    U_TEST_PRINT_LINE("passing GNSS data through to UART handle 1...");
+    gpAtStreamResponse = "\r\nOK\r\n";
+    U_PORT_TEST_ASSERT(uGnssSetAtStream(gnssHandle, 1) == 0);
+    snprintf(command, sizeof(command), "AT+UGPRF=%d", U_GNSS_AT_STREAM_UGPRF_CONFIG);
+    U_TEST_PRINT_LINE("module received \"%s\".", gAtStreamCommand);
+    U_PORT_TEST_ASSERT(strcmp(gAtStreamCommand, command) == 0);
+    U_PORT_TEST_ASSERT(uGnssGetAtStream(gnssHandle) == 1);
+
+    U_TEST_PRINT_LINE("an error from the module should leave that unchanged...");
+    gpAtStreamResponse = "\r\nERROR\r\n";
+    U_PORT_TEST_ASSERT(uGnssSetAtStream(gnssHandle, 2) < 0);
+    U_PORT_TEST_ASSERT(uGnssGetAtStream(gnssHandle) == 1);
+
+    U_TEST_PRINT_LINE("stopping the pass-through...");
+    gpAtStreamResponse = "\r\nOK\r\n";
+    U_PORT_TEST_ASSERT(uGnssSetAtStream(gnssHandle, -1) == 0);
+    U_TEST_PRINT_LINE("module received \"%s\".", gAtStreamCommand);
+    U_PORT_TEST_ASSERT(strcmp(gAtStreamCommand, "AT+UGPRF=0") == 0);
+    U_PORT_TEST_ASSERT(uGnssGetAtStream(gnssHandle) < 0);
+
+    uGnssDeinit();
+    uAtClientDeinit();
+    uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    gMemoryStreamHandle = -1;
+    uPortDeinit();
+
+# ifndef __XTENSA__
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+# else
+    (void) heapUsed;
+# endif
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -503,6 +634,10 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssCleanUp")
     if (gUartBHandle >= 0) {
         uPortUartClose(gUartBHandle);
     }
+    uAtClientDeinit();
+    if (gMemoryStreamHandle >= 0) {
+        uAtClientStreamMemoryClose(gMemoryStreamHandle);
+    }
 
     x = uPortTaskStackMinFree(NULL);
     if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
@@ -82,6 +82,12 @@
 # define U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES 1024
 #endif
 
+#ifndef U_GNSS_UTIL_TEST_OVERLAP_NUM
+/** The number of polls sent by the gnssUtilUbxOverlap test.
+ */
+# define U_GNSS_UTIL_TEST_OVERLAP_NUM 5
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -226,6 +232,215 @@ U_PORT_TEST_FUNCTION("[gnssUtil]", "gnssUtilTransparent")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Send several ubx messages at once and check that the responses
+ * find their way back to the right place.
+ */
+U_PORT_TEST_FUNCTION("[gnssUtil]", "gnssUtilUbxMultiple")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    char *pBuffer1;
+    char *pBuffer2;
+    // Enough room for the body of a UBX-NAV-PVT message
+    char navPvt[92];
+    int32_t y;
+    int32_t x;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
+    uGnssUtilUbxTransaction_t transactions[2];
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateUbxTransaction_t privateTransaction;
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types except U_GNSS_TRANSPORT_NMEA_UART
+    // and U_GNSS_TRANSPORT_NMEA_I2C
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        if ((transportTypes[w] != U_GNSS_TRANSPORT_NMEA_UART) &&
+            (transportTypes[w] != U_GNSS_TRANSPORT_NMEA_I2C)) {
+            // Do the standard preamble
+            U_TEST_PRINT_LINE("testing on transport %s...",
+                              pGnssTestPrivateTransportTypeName(transportTypes[w]));
+            U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                        transportTypes[w], &gHandles, true,
+                                                        U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                        U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+            gnssHandle = gHandles.gnssHandle;
+
+            // So that we can see what we're doing
+            uGnssSetUbxMessagePrint(gnssHandle, true);
+
+            pBuffer1 = (char *) malloc(U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+            U_PORT_TEST_ASSERT(pBuffer1 != NULL);
+            pBuffer2 = (char *) malloc(U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+            U_PORT_TEST_ASSERT(pBuffer2 != NULL);
+
+            // Ask for the firmware version string in the normal way
+            y = uGnssInfoGetFirmwareVersionStr(gnssHandle, pBuffer1,
+                                               U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+            U_PORT_TEST_ASSERT(y > 0);
+
+            // Now poll UBX-MON-VER and UBX-NAV-PVT together
+            memset(transactions, 0, sizeof(transactions));
+            transactions[0].messageClass = 0x0a;
+            transactions[0].messageId = 0x04;
+            transactions[0].pResponseBody = pBuffer2;
+            transactions[0].maxResponseBodyLengthBytes = U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES;
+            transactions[1].messageClass = 0x01;
+            transactions[1].messageId = 0x07;
+            transactions[1].pResponseBody = navPvt;
+            transactions[1].maxResponseBodyLengthBytes = sizeof(navPvt);
+            U_TEST_PRINT_LINE("polling UBX-MON-VER and UBX-NAV-PVT together...");
+            x = uGnssUtilUbxSendReceiveMultiple(gnssHandle, transactions,
+                                                sizeof(transactions) / sizeof(transactions[0]));
+            U_TEST_PRINT_LINE("%d transaction(s) succeeded.", x);
+            U_PORT_TEST_ASSERT(x == sizeof(transactions) / sizeof(transactions[0]));
+            U_PORT_TEST_ASSERT(transactions[0].errorCodeOrResponseBodyLength == y);
+            U_PORT_TEST_ASSERT(memcmp(pBuffer1, pBuffer2, y) == 0);
+            U_PORT_TEST_ASSERT(transactions[1].errorCodeOrResponseBodyLength == sizeof(navPvt));
+
+            // Check that bad parameters are caught
+            U_PORT_TEST_ASSERT(uGnssUtilUbxSendReceiveMultiple(gnssHandle, NULL, 1) < 0);
+            U_PORT_TEST_ASSERT(uGnssUtilUbxSendReceiveMultiple(gnssHandle, transactions, 0) < 0);
+
+            // Check that an invalid transaction is rejected and
+            // nothing sent, rather than zero transactions succeeding
+            U_TEST_PRINT_LINE("sending invalid transactions...");
+            transactions[1].maxResponseBodyLengthBytes = 0;
+            x = uGnssUtilUbxSendReceiveMultiple(gnssHandle, transactions, 2);
+            U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+            transactions[1].maxResponseBodyLengthBytes = sizeof(navPvt);
+            transactions[0].messageBodyLengthBytes = 1;
+            x = uGnssUtilUbxSendReceiveMultiple(gnssHandle, transactions, 2);
+            U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+            transactions[0].messageBodyLengthBytes = 0;
+            if (transportTypes[w] != U_GNSS_TRANSPORT_UBX_AT) {
+                // Also check the layer underneath, which only
+                // handles streaming transports
+                memset(&privateTransaction, 0, sizeof(privateTransaction));
+                privateTransaction.messageClass = 0x0a;
+                privateTransaction.messageId = 0x04;
+                privateTransaction.messageBodyLengthBytes = 1;
+                U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+                pInstance = pUGnssPrivateGetInstance(gnssHandle);
+                U_PORT_TEST_ASSERT(pInstance != NULL);
+                x = uGnssPrivateSendReceiveUbxTransactions(pInstance, &privateTransaction, 1);
+                U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+                U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+            }
+
+            // Free memory
+            free(pBuffer2);
+            free(pBuffer1);
+
+            // Do the standard postamble
+            uGnssTestPrivatePostamble(&gHandles, false);
+        }
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Check that the round trips of ubx messages sent together
+ * overlap: polling UBX-NAV-TIMEUTC a number of times in one go
+ * should take less time than doing so one poll after another,
+ * since the next poll is not held back until the response to the
+ * last has arrived.  Only the streaming transports are tested,
+ * on the AT transport the transactions are done one at a time.
+ */
+U_PORT_TEST_FUNCTION("[gnssUtil]", "gnssUtilUbxOverlap")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    // Enough room for the body of a UBX-NAV-TIMEUTC message
+    char timeUtc[U_GNSS_UTIL_TEST_OVERLAP_NUM][20];
+    uGnssUtilUbxTransaction_t transactions[U_GNSS_UTIL_TEST_OVERLAP_NUM];
+    int32_t startTimeMs;
+    int32_t sequentialMs;
+    int32_t togetherMs;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for the streaming transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        if ((transportTypes[w] == U_GNSS_TRANSPORT_UBX_UART) ||
+            (transportTypes[w] == U_GNSS_TRANSPORT_UBX_I2C)) {
+            // Do the standard preamble
+            U_TEST_PRINT_LINE("testing on transport %s...",
+                              pGnssTestPrivateTransportTypeName(transportTypes[w]));
+            U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                        transportTypes[w], &gHandles, true,
+                                                        U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                        U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+            gnssHandle = gHandles.gnssHandle;
+
+            memset(transactions, 0, sizeof(transactions));
+            for (size_t x = 0; x < U_GNSS_UTIL_TEST_OVERLAP_NUM; x++) {
+                transactions[x].messageClass = 0x01;
+                transactions[x].messageId = 0x21;
+                transactions[x].pResponseBody = timeUtc[x];
+                transactions[x].maxResponseBodyLengthBytes = sizeof(timeUtc[x]);
+            }
+
+            // One poll after another
+            startTimeMs = (int32_t) uPortGetTickTimeMs();
+            for (size_t x = 0; x < U_GNSS_UTIL_TEST_OVERLAP_NUM; x++) {
+                U_PORT_TEST_ASSERT(uGnssUtilUbxSendReceiveMultiple(gnssHandle,
+                                                                   &(transactions[x]),
+                                                                   1) == 1);
+                U_PORT_TEST_ASSERT(transactions[x].errorCodeOrResponseBodyLength ==
+                                   sizeof(timeUtc[x]));
+            }
+            sequentialMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+
+            // All of the polls together
+            startTimeMs = (int32_t) uPortGetTickTimeMs();
+            U_PORT_TEST_ASSERT(uGnssUtilUbxSendReceiveMultiple(gnssHandle, transactions,
+                                                               U_GNSS_UTIL_TEST_OVERLAP_NUM) ==
+                               U_GNSS_UTIL_TEST_OVERLAP_NUM);
+            togetherMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+            for (size_t x = 0; x < U_GNSS_UTIL_TEST_OVERLAP_NUM; x++) {
+                U_PORT_TEST_ASSERT(transactions[x].errorCodeOrResponseBodyLength ==
+                                   sizeof(timeUtc[x]));
+            }
+
+            U_TEST_PRINT_LINE("%d UBX-NAV-TIMEUTC poll(s) took %d ms one after"
+                              " another, %d ms together.", U_GNSS_UTIL_TEST_OVERLAP_NUM,
+                              sequentialMs, togetherMs);
+            U_PORT_TEST_ASSERT(togetherMs < sequentialMs);
+
+            // Do the standard postamble
+            uGnssTestPrivatePostamble(&gHandles, false);
+        }
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
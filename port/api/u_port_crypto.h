@@ -28,7 +28,16 @@
 
 /** @file
  * @brief Porting layer for cryptographic functions, mapped to
- * mbedTLS on most platforms.  These functions are thread-safe.
+ * mbedTLS on most platforms.  These functions are thread-safe,
+ * with the exception that a given context (see
+ * uPortCryptoSha256ContextCreate() etc.) must only be used by one
+ * task at a time.
+ *
+ * The one-shot functions set up the underlying algorithm, including
+ * any key schedule, every time they are called; where the same key
+ * is used over and over, or where the input data is not contiguous,
+ * it is more efficient to create a context once and then use the
+ * context functions.
  */
 
 #ifdef __cplusplus
@@ -52,6 +61,13 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Handle for a crypto context, as returned by
+ * uPortCryptoSha256ContextCreate(),
+ * uPortCryptoHmacSha256ContextCreate() or
+ * uPortCryptoAes128CbcContextCreate().
+ */
+typedef void *uPortCryptoContextHandle_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -150,6 +166,187 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
                                     size_t lengthBytes,
                                     char *pOutput);
 
+/** Create a context for an incremental SHA256 calculation;
+ * data is added with uPortCryptoSha256ContextUpdate() and the
+ * result obtained with uPortCryptoSha256ContextFinish(), after
+ * which the context is ready for the next calculation.  When
+ * done, call uPortCryptoSha256ContextDelete() to free memory.
+ *
+ * @param[out] pHandle a place to put the handle of the context;
+ *                     cannot be NULL.
+ * @return             zero on success else negative error code,
+ *                     e.g. #U_ERROR_COMMON_NOT_SUPPORTED if
+ *                     contexts are not supported on this platform.
+ */
+int32_t uPortCryptoSha256ContextCreate(uPortCryptoContextHandle_t *pHandle);
+
+/** Add data to a SHA256 calculation.
+ *
+ * @param handle           the handle of the context, as returned by
+ *                         uPortCryptoSha256ContextCreate().
+ * @param pInput           a pointer to the input data; cannot be
+ *                         NULL unless inputLengthBytes is zero.
+ * @param inputLengthBytes the length of the input data.
+ * @return                 zero on success else negative error code;
+ *                         the error code may come directly from the
+ *                         underlying cryptographic library.
+ */
+int32_t uPortCryptoSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                       const char *pInput,
+                                       size_t inputLengthBytes);
+
+/** Obtain the result of a SHA256 calculation and make the context
+ * ready for the next one.
+ *
+ * @param handle       the handle of the context, as returned by
+ *                     uPortCryptoSha256ContextCreate().
+ * @param[out] pOutput a pointer to at least 32 bytes of space
+ *                     to which the output will be written.
+ * @return             zero on success else negative error code;
+ *                     the error code may come directly from the
+ *                     underlying cryptographic library.
+ */
+int32_t uPortCryptoSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                       char *pOutput);
+
+/** Free a SHA256 context.
+ *
+ * @param handle the handle of the context, as returned by
+ *               uPortCryptoSha256ContextCreate(); may be NULL.
+ */
+void uPortCryptoSha256ContextDelete(uPortCryptoContextHandle_t handle);
+
+/** Create a context for incremental HMAC SHA256 calculations with
+ * a given key; the key is set up once here rather than on every
+ * calculation.  Data is added with uPortCryptoHmacSha256ContextUpdate()
+ * and the result obtained with uPortCryptoHmacSha256ContextFinish(),
+ * after which the context is ready for the next calculation with
+ * the same key.  When done, call uPortCryptoHmacSha256ContextDelete()
+ * to free memory.
+ *
+ * @param[out] pHandle a place to put the handle of the context;
+ *                     cannot be NULL.
+ * @param pKey         a pointer to the key; cannot be NULL.
+ * @param keyLengthBytes the length of the key.
+ * @return             zero on success else negative error code,
+ *                     e.g. #U_ERROR_COMMON_NOT_SUPPORTED if
+ *                     contexts are not supported on this platform.
+ */
+int32_t uPortCryptoHmacSha256ContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                           const char *pKey,
+                                           size_t keyLengthBytes);
+
+/** Add data to a HMAC SHA256 calculation.
+ *
+ * @param handle           the handle of the context, as returned by
+ *                         uPortCryptoHmacSha256ContextCreate().
+ * @param pInput           a pointer to the input data; cannot be
+ *                         NULL unless inputLengthBytes is zero.
+ * @param inputLengthBytes the length of the input data.
+ * @return                 zero on success else negative error code;
+ *                         the error code may come directly from the
+ *                         underlying cryptographic library.
+ */
+int32_t uPortCryptoHmacSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                           const char *pInput,
+                                           size_t inputLengthBytes);
+
+/** Obtain the result of a HMAC SHA256 calculation and make the
+ * context ready for the next one with the same key.
+ *
+ * @param handle       the handle of the context, as returned by
+ *                     uPortCryptoHmacSha256ContextCreate().
+ * @param[out] pOutput a pointer to at least 32 bytes of space
+ *                     to which the output will be written.
+ * @return             zero on success else negative error code;
+ *                     the error code may come directly from the
+ *                     underlying cryptographic library.
+ */
+int32_t uPortCryptoHmacSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                           char *pOutput);
+
+/** Free a HMAC SHA256 context.
+ *
+ * @param handle the handle of the context, as returned by
+ *               uPortCryptoHmacSha256ContextCreate(); may be NULL.
+ */
+void uPortCryptoHmacSha256ContextDelete(uPortCryptoContextHandle_t handle);
+
+/** Create a context for AES 128 CBC encryption and decryption with
+ * a given key; the key schedules are expanded once here rather
+ * than on every call.  When done, call
+ * uPortCryptoAes128CbcContextDelete() to free memory.
+ *
+ * @param[out] pHandle   a place to put the handle of the context;
+ *                       cannot be NULL.
+ * @param pKey           a pointer to the key; cannot be NULL.
+ * @param keyLengthBytes the length of the key; must be 16, 24
+ *                       or 32 bytes.
+ * @return               zero on success else negative error code,
+ *                       e.g. #U_ERROR_COMMON_NOT_SUPPORTED if
+ *                       contexts are not supported on this platform.
+ */
+int32_t uPortCryptoAes128CbcContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                          const char *pKey,
+                                          size_t keyLengthBytes);
+
+/** Perform AES 128 CBC encryption of a block of data using
+ * a context; otherwise as uPortCryptoAes128CbcEncrypt().
+ *
+ * @param handle              the handle of the context, as returned
+ *                            by uPortCryptoAes128CbcContextCreate().
+ * @param[in,out] pInitVector a pointer to the 16 byte initialisation
+ *                            vector; cannot be NULL, must be writeable
+ *                            and WILL be modified by this function.
+ * @param[in] pInput          a pointer to the input data; cannot be
+ *                            NULL.
+ * @param lengthBytes         the length of the input data; must be
+ *                            a multiple of 16 bytes.
+ * @param[out] pOutput        a pointer to at least lengthBytes
+ *                            bytes of space to which the output will
+ *                            be written.
+ * @return                    zero on success else negative error code;
+ *                            the error code may come directly from the
+ *                            underlying cryptographic library.
+ */
+int32_t uPortCryptoAes128CbcContextEncrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput);
+
+/** Perform AES 128 CBC decryption of a block of data using
+ * a context; otherwise as uPortCryptoAes128CbcDecrypt().
+ *
+ * @param handle              the handle of the context, as returned
+ *                            by uPortCryptoAes128CbcContextCreate().
+ * @param[in,out] pInitVector a pointer to the 16 byte initialisation
+ *                            vector; cannot be NULL, must be writeable
+ *                            and WILL be modified by this function.
+ * @param[in] pInput          a pointer to the input data; cannot be
+ *                            NULL.
+ * @param lengthBytes         the length of the input data; must be
+ *                            a multiple of 16 bytes.
+ * @param[out] pOutput        a pointer to at least lengthBytes
+ *                            bytes of space to which the output will
+ *                            be written.
+ * @return                    zero on success else negative error code;
+ *                            the error code may come directly from the
+ *                            underlying cryptographic library.
+ */
+int32_t uPortCryptoAes128CbcContextDecrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput);
+
+/** Free an AES 128 CBC context; the key schedules are wiped.
+ *
+ * @param handle the handle of the context, as returned by
+ *               uPortCryptoAes128CbcContextCreate(); may be NULL.
+ */
+void uPortCryptoAes128CbcContextDelete(uPortCryptoContextHandle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,9 +42,17 @@ extern "C" {
  * leave the building is dictated by the platform.
  */
 #if U_CFG_ENABLE_LOGGING
-# define uPortLog(format, ...) \
+# ifdef U_CFG_LOG_BINARY
+/** Define #U_CFG_LOG_BINARY as well to have uPortLog() write
+ * compact binary records to a RAM ring buffer instead, see
+ * port/platform/common/log_binary.
+ */
+#  define uPortLog(format, ...) uLogBinary(format, ##__VA_ARGS__)
+# else
+#  define uPortLog(format, ...) \
              /*lint -e{507} suppress size incompatibility warnings in printf() */ \
              uPortLogF(format, ##__VA_ARGS__)
+# endif
 #else
 # define uPortLog(...)
 #endif
@@ -88,6 +96,14 @@ int32_t uPortLogOn(void);
 
 /** @}*/
 
+/* ----------------------------------------------------------------
+ * INCLUDE FOR U_CFG_LOG_BINARY
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_LOG_BINARY
+# include "u_log_binary.h"
+#endif
+
 #endif // _U_PORT_DEBUG_H_
 
 // End of file
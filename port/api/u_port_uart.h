@@ -58,17 +58,39 @@ extern "C" {
 # define U_PORT_UART_WRITE_TIMEOUT_MS 30000
 #endif
 
+#ifndef U_PORT_UART_WRITE_ASYNC_MAX_NUM
+/** The maximum number of buffers, passed to uPortUartWriteAsync()
+ * or uPortUartWriteAsyncVector(), that may be outstanding on a UART
+ * at any one time.
+ */
+# define U_PORT_UART_WRITE_ASYNC_MAX_NUM 8
+#endif
+
 /** The event which means that received data is available; this
  * will be sent if the receive buffer goes from empty to containing
  * one or more bytes of received data. It is used as a bit-mask.
- * It is the only U_PORT_UART_EVENT_BITMASK_xxx currently supported.
  */
 #define U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED 0x01
 
+/** The event which means that the data passed to one call of
+ * uPortUartWriteAsync() has been transmitted and the buffer
+ * may be re-used; one event is sent per call, in the order of
+ * the calls.  It is used as a bit-mask.  This event is only sent
+ * on platforms which support uPortUartWriteAsync().
+ */
+#define U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE 0x02
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** One buffer of a vectored write, see uPortUartWriteAsyncVector().
+ */
+typedef struct {
+    const void *pBuffer; /**< the data to send. */
+    size_t sizeBytes;    /**< the number of bytes at pBuffer. */
+} uPortUartWriteVector_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -190,6 +212,67 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes);
 
+/** Write to the given UART interface without waiting for the
+ * data to be sent: the data is queued behind any previous writes
+ * and this function returns immediately, leaving the caller free
+ * to, for instance, prepare the next lot of data while this lot is
+ * transmitted.  Up to #U_PORT_UART_WRITE_ASYNC_MAX_NUM writes may
+ * be queued.  The data at pBuffer is NOT copied: it MUST remain
+ * valid until the write has completed, which is signalled by
+ * #U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE through the event
+ * callback (see uPortUartEventCallbackSet()), one event per call
+ * to this function, or can be checked with
+ * uPortUartWriteAsyncGetPending().  Calls to this function and
+ * to uPortUartWrite() may be mixed; the data is sent in the
+ * order of the calls.  Note that NOT ALL PLATFORMS support this
+ * API: where it is not supported #U_ERROR_COMMON_NOT_SUPPORTED
+ * will be returned and uPortUartWrite() should be used instead.
+ *
+ * @param handle      the handle of the UART instance.
+ * @param[in] pBuffer a pointer to a buffer of data to send,
+ *                    which must remain valid until the write
+ *                    has completed.
+ * @param sizeBytes   the number of bytes in pBuffer.
+ * @return            zero on success else negative error code;
+ *                    if there is no room to queue the write
+ *                    #U_ERROR_COMMON_NO_MEMORY is returned.
+ */
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes);
+
+/** As uPortUartWriteAsync() but gathering the data from several
+ * buffers, e.g. a command prefix, a payload and a terminator, which
+ * are sent back to back without being copied together first.  Either
+ * all of the buffers are queued or none are; each buffer counts
+ * towards #U_PORT_UART_WRITE_ASYNC_MAX_NUM.  A single
+ * #U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE event is sent once the
+ * last buffer has been transmitted and the whole call counts as one
+ * in uPortUartWriteAsyncGetPending().  Note that NOT ALL PLATFORMS
+ * support this API: where it is not supported
+ * #U_ERROR_COMMON_NOT_SUPPORTED will be returned.
+ *
+ * @param handle      the handle of the UART instance.
+ * @param[in] pVector an array of numVector buffers, each of which
+ *                    must remain valid until the write has
+ *                    completed; the array itself need not.
+ * @param numVector   the number of entries at pVector.
+ * @return            zero on success else negative error code;
+ *                    if there is no room to queue all of the
+ *                    buffers #U_ERROR_COMMON_NO_MEMORY is returned.
+ */
+int32_t uPortUartWriteAsyncVector(int32_t handle,
+                                  const uPortUartWriteVector_t *pVector,
+                                  size_t numVector);
+
+/** Get the number of uPortUartWriteAsync() and
+ * uPortUartWriteAsyncVector() calls which have not yet completed.
+ *
+ * @param handle the handle of the UART instance.
+ * @return       the number of outstanding asynchronous writes
+ *               or negative error code.
+ */
+int32_t uPortUartWriteAsyncGetPending(int32_t handle);
+
 /** Set a callback to be called when a UART event occurs.
  * pFunction will be called asynchronously in its own task,
  * for which the stack size and priority can be specified.
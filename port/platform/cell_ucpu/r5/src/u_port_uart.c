@@ -639,6 +639,34 @@ int32_t uPortUartWrite(int32_t handle,
     return errorCodeOrSize;
 }
 
+// Write asynchronously: not supported on this platform.
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes)
+{
+    (void) handle;
+    (void) pBuffer;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Write asynchronously from several buffers: not supported.
+int32_t uPortUartWriteAsyncVector(int32_t handle,
+                                  const uPortUartWriteVector_t *pVector,
+                                  size_t numVector)
+{
+    (void) handle;
+    (void) pVector;
+    (void) numVector;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Get the number of pending asynchronous writes: not supported.
+int32_t uPortUartWriteAsyncGetPending(int32_t handle)
+{
+    (void) handle;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Event handler, calls the user's event callback.
 static void eventHandler(void *pParam, size_t paramLength)
 {
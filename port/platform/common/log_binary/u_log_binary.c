@@ -0,0 +1,407 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief This file implements deferred, binary, logging; see
+ * u_log_binary.h for a description.
+ *
+ * Each record in the ring buffer is a whole number of 32-bit
+ * words, in the native byte order of the target, laid out as:
+ *
+ * - a header word: #U_LOG_BINARY_RECORD_MARKER in bits 31 to 24,
+ *   an 8-bit sequence number in bits 23 to 16, the flag
+ *   #U_LOG_BINARY_RECORD_FLAG_TRUNCATED in bit 15 and the length
+ *   of the whole record in bytes in bits 14 to 0,
+ * - the tick time in milliseconds, 32 bits,
+ * - the address of the format string, a pointer,
+ * - the arguments, in order, packed with no alignment: integers
+ *   and pointers as their native size (char/short promoted to int,
+ *   intmax_t stored as a long long), floating point as a double,
+ *   "*" widths/precisions as an int and strings as a length byte
+ *   followed by that many characters, no terminator,
+ * - padding to the next word boundary.
+ *
+ * u_log_binary.py must be kept in step with this.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#ifdef U_CFG_LOG_BINARY
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdarg.h"    // va_list
+#include "string.h"    // memcpy()
+
+#include "u_cfg_sw.h"
+#include "u_port.h"
+#include "u_port_debug.h"
+
+#include "u_hex_bin_convert.h"
+
+#include "u_log_binary.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The length of the fixed part of a record: header word, time
+ * and format string address.
+ */
+#define U_LOG_BINARY_RECORD_HEADER_LENGTH_BYTES (sizeof(uint32_t) + \
+                                                 sizeof(uint32_t) + \
+                                                 sizeof(const char *))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The length modifiers of a printf() conversion.
+ */
+typedef enum {
+    U_LOG_BINARY_LENGTH_NONE,
+    U_LOG_BINARY_LENGTH_LONG,
+    U_LOG_BINARY_LENGTH_LONG_LONG,
+    U_LOG_BINARY_LENGTH_SIZE
+} uLogBinaryLength_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The ring buffer, as words so that record headers are aligned.
+ */
+static uint32_t gBuffer[U_LOG_BINARY_BUFFER_LENGTH_BYTES / sizeof(uint32_t)];
+
+/** Where the next record will be written in gBuffer, in bytes.
+ */
+static size_t gWriteOffset = 0;
+
+/** Where the oldest record starts in gBuffer, in bytes.
+ */
+static size_t gReadOffset = 0;
+
+/** The number of bytes of records in gBuffer.
+ */
+static size_t gUsedBytes = 0;
+
+/** The sequence number of the next record.
+ */
+static uint8_t gSequence = 0;
+
+/** The number of records overwritten.
+ */
+static int32_t gLost = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Add data to a record, returning false if it won't fit.
+static bool put(char *pRecord, size_t *pOffset, const void *pData,
+                size_t length)
+{
+    bool fits = false;
+
+    if (*pOffset + length <= U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES) {
+        memcpy(pRecord + *pOffset, pData, length);
+        *pOffset += length;
+        fits = true;
+    }
+
+    return fits;
+}
+
+// Copy a record into the ring buffer, overwriting the oldest
+// records if necessary; must be called in a critical section.
+static void ringWrite(const char *pRecord, size_t length)
+{
+    char *pBuffer = (char *) gBuffer;
+    size_t x;
+
+    // Make room
+    while (gUsedBytes + length > sizeof(gBuffer)) {
+        x = gBuffer[gReadOffset / sizeof(uint32_t)] & 0x7FFF;
+        gReadOffset = (gReadOffset + x) % sizeof(gBuffer);
+        gUsedBytes -= x;
+        gLost++;
+    }
+
+    // Copy in, in up to two pieces
+    x = sizeof(gBuffer) - gWriteOffset;
+    if (x > length) {
+        x = length;
+    }
+    memcpy(pBuffer + gWriteOffset, pRecord, x);
+    memcpy(pBuffer, pRecord + x, length - x);
+    gWriteOffset = (gWriteOffset + length) % sizeof(gBuffer);
+    gUsedBytes += length;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Write a binary log record.
+void uLogBinary(const char *pFormat, ...)
+{
+    va_list args;
+    // Words, so that the header is aligned
+    uint32_t record[U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES / sizeof(uint32_t)];
+    char *pRecord = (char *) record;
+    size_t offset = U_LOG_BINARY_RECORD_HEADER_LENGTH_BYTES;
+    bool fits = true;
+    const char *pTmp = pFormat;
+    uLogBinaryLength_t length;
+    int32_t precision;
+    int intValue;
+    long longValue;
+    long long longLongValue;
+    size_t sizeValue;
+    double doubleValue;
+    const void *pValue;
+    const char *pString;
+    uint8_t stringLength;
+
+    record[1] = (uint32_t) uPortGetTickTimeMs();
+    memcpy(pRecord + sizeof(uint32_t) * 2, &pFormat, sizeof(pFormat));
+
+    // Store the arguments, working out their types from the
+    // conversion specifications in the format string
+    va_start(args, pFormat);
+    while ((pTmp != NULL) && (*pTmp != 0) && fits) {
+        if (*pTmp++ != '%') {
+            continue;
+        }
+        // Flags
+        while ((*pTmp == '-') || (*pTmp == '+') || (*pTmp == ' ') ||
+               (*pTmp == '#') || (*pTmp == '0')) {
+            pTmp++;
+        }
+        // Width
+        if (*pTmp == '*') {
+            intValue = va_arg(args, int);
+            fits = put(pRecord, &offset, &intValue, sizeof(intValue));
+            pTmp++;
+        } else {
+            while ((*pTmp >= '0') && (*pTmp <= '9')) {
+                pTmp++;
+            }
+        }
+        // Precision
+        precision = -1;
+        if (*pTmp == '.') {
+            pTmp++;
+            precision = 0;
+            if (*pTmp == '*') {
+                intValue = va_arg(args, int);
+                fits = fits && put(pRecord, &offset, &intValue, sizeof(intValue));
+                precision = intValue;
+                pTmp++;
+            } else {
+                while ((*pTmp >= '0') && (*pTmp <= '9')) {
+                    precision = (precision * 10) + (*pTmp - '0');
+                    pTmp++;
+                }
+            }
+        }
+        // Length modifier
+        length = U_LOG_BINARY_LENGTH_NONE;
+        switch (*pTmp) {
+            case 'h':
+                pTmp++;
+                if (*pTmp == 'h') {
+                    pTmp++;
+                }
+                break;
+            case 'l':
+                pTmp++;
+                length = U_LOG_BINARY_LENGTH_LONG;
+                if (*pTmp == 'l') {
+                    pTmp++;
+                    length = U_LOG_BINARY_LENGTH_LONG_LONG;
+                }
+                break;
+            case 'j':
+                pTmp++;
+                length = U_LOG_BINARY_LENGTH_LONG_LONG;
+                break;
+            case 'z':
+            //lint -fallthrough
+            case 't':
+                pTmp++;
+                length = U_LOG_BINARY_LENGTH_SIZE;
+                break;
+            case 'L':
+                pTmp++;
+                break;
+            default:
+                break;
+        }
+        // Conversion
+        switch (*pTmp) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                switch (length) {
+                    case U_LOG_BINARY_LENGTH_LONG:
+                        longValue = va_arg(args, long);
+                        fits = fits && put(pRecord, &offset, &longValue, sizeof(longValue));
+                        break;
+                    case U_LOG_BINARY_LENGTH_LONG_LONG:
+                        longLongValue = va_arg(args, long long);
+                        fits = fits && put(pRecord, &offset, &longLongValue, sizeof(longLongValue));
+                        break;
+                    case U_LOG_BINARY_LENGTH_SIZE:
+                        sizeValue = va_arg(args, size_t);
+                        fits = fits && put(pRecord, &offset, &sizeValue, sizeof(sizeValue));
+                        break;
+                    default:
+                        intValue = va_arg(args, int);
+                        fits = fits && put(pRecord, &offset, &intValue, sizeof(intValue));
+                        break;
+                }
+                break;
+            case 'p':
+                pValue = va_arg(args, const void *);
+                fits = fits && put(pRecord, &offset, &pValue, sizeof(pValue));
+                break;
+            case 's':
+                pString = va_arg(args, const char *);
+                if (pString == NULL) {
+                    pString = "(null)";
+                }
+                if ((precision < 0) || (precision > U_LOG_BINARY_STRING_MAX_LENGTH_BYTES)) {
+                    precision = U_LOG_BINARY_STRING_MAX_LENGTH_BYTES;
+                }
+                for (stringLength = 0; (stringLength < precision) &&
+                     (pString[stringLength] != 0); stringLength++) {
+                }
+                fits = fits && put(pRecord, &offset, &stringLength, sizeof(stringLength)) &&
+                       put(pRecord, &offset, pString, stringLength);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                doubleValue = va_arg(args, double);
+                fits = fits && put(pRecord, &offset, &doubleValue, sizeof(doubleValue));
+                break;
+            case 'n':
+                // Nothing to print
+                (void) va_arg(args, void *);
+                break;
+            default:
+                break;
+        }
+        if (*pTmp != 0) {
+            pTmp++;
+        }
+    }
+    va_end(args);
+
+    // Pad to a word boundary
+    offset = (offset + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+    if (offset > U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES) {
+        offset = U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES;
+    }
+
+    // Not checking the return value here: if there is no
+    // critical section on this platform then we carry on anyway
+    uPortEnterCritical();
+    record[0] = ((uint32_t) U_LOG_BINARY_RECORD_MARKER << 24) |
+                ((uint32_t) gSequence << 16) | (uint32_t) offset;
+    if (!fits) {
+        record[0] |= U_LOG_BINARY_RECORD_FLAG_TRUNCATED;
+    }
+    gSequence++;
+    ringWrite(pRecord, offset);
+    uPortExitCritical();
+}
+
+// Read binary log records out of the ring buffer.
+size_t uLogBinaryRead(char *pBuffer, size_t sizeBytes)
+{
+    size_t readBytes = 0;
+    size_t length;
+    size_t x;
+    const char *pRing = (const char *) gBuffer;
+
+    if (pBuffer != NULL) {
+        uPortEnterCritical();
+        while (gUsedBytes > 0) {
+            length = gBuffer[gReadOffset / sizeof(uint32_t)] & 0x7FFF;
+            if (readBytes + length > sizeBytes) {
+                break;
+            }
+            x = sizeof(gBuffer) - gReadOffset;
+            if (x > length) {
+                x = length;
+            }
+            memcpy(pBuffer + readBytes, pRing + gReadOffset, x);
+            memcpy(pBuffer + readBytes + x, pRing, length - x);
+            gReadOffset = (gReadOffset + length) % sizeof(gBuffer);
+            gUsedBytes -= length;
+            readBytes += length;
+        }
+        uPortExitCritical();
+    }
+
+    return readBytes;
+}
+
+// Print the ring buffer as lines of hex.
+void uLogBinaryDump()
+{
+    char record[U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES];
+    char hex[(sizeof(record) * 2) + 1];
+    size_t length;
+
+    // Read one record at a time, since they are limited in length
+    while ((length = uLogBinaryRead(record, sizeof(record))) > 0) {
+        length = uBinToHex(record, length, hex);
+        hex[length] = 0;
+        uPortLogF("U_LOG_BINARY: %s\n", hex);
+    }
+}
+
+// Get the number of records lost.
+int32_t uLogBinaryGetLost()
+{
+    int32_t lost;
+
+    uPortEnterCritical();
+    lost = gLost;
+    gLost = 0;
+    uPortExitCritical();
+
+    return lost;
+}
+
+#endif // U_CFG_LOG_BINARY
+
+// End of file
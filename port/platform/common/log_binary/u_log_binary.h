@@ -0,0 +1,148 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files.. */
+
+#ifndef _U_LOG_BINARY_H_
+#define _U_LOG_BINARY_H_
+
+/** @file
+ * @brief This file provides a deferred, binary, form of logging
+ * which may be used in place of uPortLog() if U_CFG_LOG_BINARY is
+ * defined (as well as U_CFG_ENABLE_LOGGING).  Instead of formatting
+ * a string and sending it out of a debug port, a call to uPortLog()
+ * then writes a small binary record into a RAM ring buffer: the
+ * address of the format string plus the raw values of the arguments
+ * (strings are copied, up to #U_LOG_BINARY_STRING_MAX_LENGTH_BYTES).
+ * The format string is still parsed on every call, in order to find
+ * the type of each argument, but nothing is formatted and nothing is
+ * sent out of a debug port; the cost is a walk of the format string
+ * plus a copy of a record of typically a few tens of bytes, which is
+ * usually cheap enough for logging to be left on under load.
+ *
+ * The ring buffer may be emptied by calling uLogBinaryRead(),
+ * sending the contents wherever you wish (a file, a socket, etc.),
+ * or by calling uLogBinaryDump(), which prints the contents as lines
+ * of hex to the normal debug output.  The binary log is turned back
+ * into text on a host with the script u_log_binary.py in this
+ * directory: that first generates a table of format strings from
+ * the ELF file of the build (the addresses of the format strings
+ * being fixed at link time) and then uses it to decode the binary
+ * log.  Where the build is position-independent and loaded at a
+ * random address (e.g. a PIE executable on Linux, with ASLR) the
+ * logged addresses are not the link-time ones and must be rebased
+ * before decoding, see the --load-offset option of the script.
+ * See the README.md in this directory for details.
+ *
+ * The functions here are thread-safe; the ring buffer is protected
+ * with uPortEnterCritical()/uPortExitCritical() for the duration of
+ * a copy of one record.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_LOG_BINARY_BUFFER_LENGTH_BYTES
+/** The size of the ring buffer that binary log records are written
+ * to; when the buffer is full the oldest records are overwritten.
+ * Must be a multiple of four.
+ */
+# define U_LOG_BINARY_BUFFER_LENGTH_BYTES 4096
+#endif
+
+#ifndef U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES
+/** The maximum length of a single binary log record; this amount
+ * of stack is used by each call to uPortLog().  Must be a multiple
+ * of four.  Arguments that do not fit are dropped and the record
+ * is marked as truncated.
+ */
+# define U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES 128
+#endif
+
+#ifndef U_LOG_BINARY_STRING_MAX_LENGTH_BYTES
+/** The maximum number of characters of a "%s" argument that are
+ * copied into a binary log record; cannot be more than 255.
+ */
+# define U_LOG_BINARY_STRING_MAX_LENGTH_BYTES 64
+#endif
+
+/** The marker in the top byte of the first word of each binary
+ * log record.
+ */
+#define U_LOG_BINARY_RECORD_MARKER 0xA5
+
+/** The flag in the first word of a binary log record that
+ * indicates that some of the arguments were dropped.
+ */
+#define U_LOG_BINARY_RECORD_FLAG_TRUNCATED 0x8000
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Write a binary log record; this is not usually called directly,
+ * it is called by the uPortLog() macro when U_CFG_LOG_BINARY is
+ * defined.  pFormat MUST be a string literal, or at least a string
+ * which lives at a fixed address in the read-only data of the image,
+ * since it is only the address which is logged.
+ *
+ * @param[in] pFormat a printf() style format string.
+ * @param ...         variable argument list.
+ */
+void uLogBinary(const char *pFormat, ...);
+
+/** Read binary log records out of the ring buffer, oldest first;
+ * only whole records are read and those read are removed from the
+ * ring buffer.
+ *
+ * @param[out] pBuffer a place to put the records; cannot be NULL.
+ * @param sizeBytes    the amount of storage at pBuffer, should be
+ *                     at least #U_LOG_BINARY_RECORD_MAX_LENGTH_BYTES.
+ * @return             the number of bytes read, zero if there are
+ *                     no records (or none that will fit).
+ */
+size_t uLogBinaryRead(char *pBuffer, size_t sizeBytes);
+
+/** Empty the ring buffer, printing the binary log records as lines
+ * of hex, each prefixed with "U_LOG_BINARY: ", to the normal debug
+ * output; u_log_binary.py can decode a capture of such lines.
+ * This uses uPortLogF() and so is subject to its costs.
+ */
+void uLogBinaryDump();
+
+/** Get the number of binary log records that have been overwritten,
+ * because the ring buffer was full, since the last call to this
+ * function.
+ *
+ * @return the number of records lost.
+ */
+int32_t uLogBinaryGetLost();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_LOG_BINARY_H_
+
+// End of file
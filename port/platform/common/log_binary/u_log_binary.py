@@ -0,0 +1,327 @@
+#!/usr/bin/env python
+
+# Copyright 2019-2022 u-blox
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+'''Decode a binary log written by u_log_binary.c back into text.
+
+Step 1, after each build, make a format table from the ELF file:
+
+    u_log_binary.py table my_app.elf my_app.json
+
+Step 2, decode a binary log captured from that build, either the
+raw bytes returned by uLogBinaryRead() or a capture of the debug
+output containing the "U_LOG_BINARY: " lines written by
+uLogBinaryDump():
+
+    u_log_binary.py decode my_app.json my_log.bin
+
+If the build is position-independent and was loaded at a random
+address (e.g. a PIE executable on Linux), pass the address it was
+loaded at with --load-offset so that the logged format string
+addresses can be rebased to the link-time addresses in the table.
+
+Only the Python standard library is used.'''
+
+import sys
+import re
+import json
+import struct
+import base64
+import argparse
+
+# The marker in the top byte of the header word of each record
+RECORD_MARKER = 0xA5
+
+# The flag in the header word marking a truncated record
+RECORD_FLAG_TRUNCATED = 0x8000
+
+# The prefix of the lines written by uLogBinaryDump()
+DUMP_PREFIX = "U_LOG_BINARY: "
+
+# ELF constants
+ELF_MAGIC = b"\x7fELF"
+ELF_CLASS_64 = 2
+ELF_DATA_BIG_ENDIAN = 2
+ELF_SHF_WRITE = 0x1
+ELF_SHF_ALLOC = 0x2
+ELF_SHT_PROGBITS = 1
+
+# A C printf() conversion specification, mirroring the parsing
+# in uLogBinary()
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|[0-9]*)(?:\.(\*|[0-9]*))?"
+                        r"(hh|h|ll|l|j|z|t|L)?([diuxXocpsfFeEgGaAn%]?)")
+
+def elf_table(elf_path):
+    '''Return the read-only, loaded, sections of an ELF file.'''
+    with open(elf_path, "rb") as elf_file:
+        elf = elf_file.read()
+    if elf[0:4] != ELF_MAGIC:
+        raise ValueError("{} is not an ELF file".format(elf_path))
+    is_64 = elf[4] == ELF_CLASS_64
+    endian = ">" if elf[5] == ELF_DATA_BIG_ENDIAN else "<"
+    if is_64:
+        (shoff,) = struct.unpack_from(endian + "Q", elf, 0x28)
+        (shentsize, shnum) = struct.unpack_from(endian + "HH", elf, 0x3a)
+        header_format = endian + "IIQQQQIIQQ"
+    else:
+        (shoff,) = struct.unpack_from(endian + "I", elf, 0x20)
+        (shentsize, shnum) = struct.unpack_from(endian + "HH", elf, 0x2e)
+        header_format = endian + "IIIIIIIIII"
+    sections = []
+    for index in range(shnum):
+        (_, sh_type, sh_flags, sh_addr, sh_offset, sh_size,
+         _, _, _, _) = struct.unpack_from(header_format, elf,
+                                          shoff + (index * shentsize))
+        # Format strings end up in loaded sections that are not
+        # writeable: .rodata and friends, or .text on some toolchains
+        if (sh_type == ELF_SHT_PROGBITS and sh_flags & ELF_SHF_ALLOC and
+                not sh_flags & ELF_SHF_WRITE and sh_size > 0):
+            data = elf[sh_offset:sh_offset + sh_size]
+            sections.append({"address": sh_addr,
+                             "data": base64.b64encode(data).decode("ascii")})
+    return {"pointer_size": 8 if is_64 else 4,
+            "big_endian": endian == ">",
+            "sections": sections}
+
+class FormatTable():
+    '''Look up format strings by address.'''
+    def __init__(self, table):
+        self.pointer_size = table["pointer_size"]
+        self.endian = ">" if table["big_endian"] else "<"
+        self.sections = [(section["address"], base64.b64decode(section["data"]))
+                         for section in table["sections"]]
+        self.cache = {}
+
+    def lookup(self, address):
+        '''Return the string at address or None.'''
+        if address in self.cache:
+            return self.cache[address]
+        string = None
+        for (start, data) in self.sections:
+            if start <= address < start + len(data):
+                end = data.find(b"\x00", address - start)
+                if end < 0:
+                    end = len(data)
+                string = data[address - start:end].decode("utf-8", "replace")
+                break
+        self.cache[address] = string
+        return string
+
+class Record():
+    '''Unpack values from the argument area of a record.'''
+    def __init__(self, data, offset, endian):
+        self.data = data
+        self.offset = offset
+        self.endian = endian
+
+    def unpack(self, size, signed=True, floating=False):
+        '''Unpack a value, raises IndexError if there are no more.'''
+        if self.offset + size > len(self.data):
+            raise IndexError
+        if floating:
+            code = "d"
+        else:
+            code = {1: "b", 2: "h", 4: "i", 8: "q"}[size]
+            if not signed:
+                code = code.upper()
+        (value,) = struct.unpack_from(self.endian + code, self.data, self.offset)
+        self.offset += size
+        return value
+
+    def string(self):
+        '''Unpack a length-prefixed string.'''
+        length = self.unpack(1, signed=False)
+        if self.offset + length > len(self.data):
+            raise IndexError
+        value = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return value.decode("utf-8", "replace")
+
+def printable(text):
+    '''Make the control characters in logged AT data visible.'''
+    text = text.replace("\r\n", "\n")
+    return "".join(c if c.isprintable() or c == "\n" else
+                   "[{:02x}]".format(ord(c)) for c in text)
+
+def format_record(format_string, record, long_size, pointer_size):
+    '''Expand format_string with the arguments in record.'''
+    output = []
+    position = 0
+    truncated = False
+    for match in CONVERSION.finditer(format_string):
+        output.append(format_string[position:match.start()])
+        position = match.end()
+        (flags, width, precision, length, conversion) = match.groups()
+        if conversion == "%":
+            output.append("%")
+            continue
+        try:
+            if width == "*":
+                width = str(record.unpack(4))
+            if precision == "*":
+                precision = str(record.unpack(4))
+            spec = "%" + flags + width
+            if precision is not None:
+                spec += "." + (precision if precision else "0")
+            size = 4
+            if length == "l":
+                size = long_size
+            elif length in ("ll", "j"):
+                size = 8
+            elif length in ("z", "t"):
+                size = pointer_size
+            if conversion in "di":
+                output.append((spec + "d") % record.unpack(size))
+            elif conversion in "uxXo":
+                value = record.unpack(size, signed=False)
+                if length == "hh":
+                    value &= 0xFF
+                elif length == "h":
+                    value &= 0xFFFF
+                output.append((spec + conversion.replace("u", "d")) % value)
+            elif conversion == "c":
+                output.append(printable((spec + "c") % chr(record.unpack(4) & 0xFF)))
+            elif conversion == "p":
+                output.append((spec + "s") % hex(record.unpack(pointer_size,
+                                                              signed=False)))
+            elif conversion == "s":
+                output.append(printable((spec + "s") % record.string()))
+            elif conversion in "fFeEgG":
+                output.append((spec + conversion) % record.unpack(8, floating=True))
+            elif conversion in "aA":
+                value = float.hex(record.unpack(8, floating=True))
+                output.append(value.upper() if conversion == "A" else value)
+            else:
+                # %n or an unknown conversion: print as-is
+                output.append(match.group(0))
+        except IndexError:
+            truncated = True
+            output.append(match.group(0))
+    output.append(format_string[position:])
+    return ("".join(output), truncated)
+
+def read_log(log_path):
+    '''Read a binary log, either raw or as a dump capture.'''
+    with open(log_path, "rb") as log_file:
+        data = log_file.read()
+    prefix = DUMP_PREFIX.encode("ascii")
+    if prefix in data:
+        binary = bytearray()
+        for line in data.splitlines():
+            index = line.find(prefix)
+            if index >= 0:
+                binary += bytes.fromhex(line[index + len(prefix):].strip().decode("ascii"))
+        data = bytes(binary)
+    return data
+
+def decode(table, data, long_size, pointer_size, timestamps, out,
+           load_offset=0):
+    '''Decode the records in data, writing text to out; load_offset
+    is subtracted from each logged format string address.'''
+    offset = 0
+    sequence = None
+    lost = 0
+    start_of_line = True
+    header_format = table.endian + "II"
+    address_format = table.endian + {4: "I", 8: "Q"}[pointer_size]
+    header_length = 8 + pointer_size
+    while offset + header_length <= len(data):
+        (header, time) = struct.unpack_from(header_format, data, offset)
+        length = header & 0x7FFF
+        if ((header >> 24) != RECORD_MARKER or length < header_length or
+                offset + length > len(data)):
+            # Out of step, try the next word
+            offset += 4
+            continue
+        this_sequence = (header >> 16) & 0xFF
+        if sequence is not None and this_sequence != (sequence + 1) & 0xFF:
+            lost += 1
+            out.write("\n*** {} record(s) missing ***\n".
+                      format((this_sequence - sequence - 1) & 0xFF))
+            start_of_line = True
+        sequence = this_sequence
+        (address,) = struct.unpack_from(address_format, data, offset + 8)
+        address -= load_offset
+        format_string = table.lookup(address)
+        if format_string is None:
+            text = "<unknown format string at 0x{:x}>\n".format(address)
+            truncated = False
+        else:
+            record = Record(data[offset:offset + length],
+                            header_length, table.endian)
+            (text, truncated) = format_record(format_string, record,
+                                              long_size, pointer_size)
+        if truncated or header & RECORD_FLAG_TRUNCATED:
+            text += " <truncated>"
+        for line in text.splitlines(True):
+            if timestamps and start_of_line:
+                out.write("{:>10} ".format(time))
+            out.write(line)
+            start_of_line = line.endswith("\n")
+        offset += length
+    if not start_of_line:
+        out.write("\n")
+    return lost
+
+def main():
+    '''Entry point.'''
+    parser = argparse.ArgumentParser(description="Decode a binary log"
+                                     " written by u_log_binary.c.")
+    subparsers = parser.add_subparsers(dest="command")
+    parser_table = subparsers.add_parser("table", help="make a format"
+                                         " table from an ELF file.")
+    parser_table.add_argument("elf", help="the ELF file of the build.")
+    parser_table.add_argument("table", help="the format table to write.")
+    parser_decode = subparsers.add_parser("decode", help="decode a"
+                                          " binary log.")
+    parser_decode.add_argument("table", help="the format table, made"
+                               " from the ELF file of the same build.")
+    parser_decode.add_argument("log", help="the binary log or a capture"
+                               " of the output of uLogBinaryDump().")
+    parser_decode.add_argument("--pointer-size", type=int, choices=[4, 8],
+                               help="the size of a pointer on the target,"
+                               " default taken from the ELF file.")
+    parser_decode.add_argument("--long-size", type=int, choices=[4, 8],
+                               help="the size of a long on the target,"
+                               " default the pointer size.")
+    parser_decode.add_argument("--load-offset", type=lambda x: int(x, 0),
+                               default=0,
+                               help="the address at which a position-"
+                               "independent build was loaded, e.g. a PIE"
+                               " executable on Linux with ASLR, to be"
+                               " subtracted from the logged addresses;"
+                               " default 0.")
+    parser_decode.add_argument("--no-timestamps", action="store_true",
+                               help="do not put the tick time in"
+                               " milliseconds at the start of each line.")
+    args = parser.parse_args()
+
+    if args.command == "table":
+        with open(args.table, "w") as table_file:
+            json.dump(elf_table(args.elf), table_file)
+        return 0
+    if args.command == "decode":
+        with open(args.table, "r") as table_file:
+            table = FormatTable(json.load(table_file))
+        pointer_size = args.pointer_size if args.pointer_size else table.pointer_size
+        long_size = args.long_size if args.long_size else pointer_size
+        decode(table, read_log(args.log), long_size, pointer_size,
+               not args.no_timestamps, sys.stdout, args.load_offset)
+        return 0
+    parser.print_help()
+    return 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -22,6 +22,7 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stdlib.h"    // malloc()/free()
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
@@ -43,6 +44,14 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** An AES context: the encrypt and decrypt key schedules
+ * are different so both are kept.
+ */
+typedef struct {
+    mbedtls_aes_context encrypt;
+    mbedtls_aes_context decrypt;
+} uPortCryptoAesContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -146,4 +155,235 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
     return errorCode;
 }
 
+// Create a SHA256 context.
+int32_t uPortCryptoSha256ContextCreate(uPortCryptoContextHandle_t *pHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    mbedtls_sha256_context *pContext;
+
+    if (pHandle != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (mbedtls_sha256_context *) malloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_sha256_init(pContext);
+            // As for uPortCryptoSha256(), use the older functions
+            // without the _ret suffix so that NRF5 is happy
+            mbedtls_sha256_starts(pContext, 0);
+            *pHandle = (uPortCryptoContextHandle_t) pContext;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Add data to a SHA256 calculation.
+int32_t uPortCryptoSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                       const char *pInput,
+                                       size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((handle != NULL) && ((pInput != NULL) || (inputLengthBytes == 0))) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        mbedtls_sha256_update((mbedtls_sha256_context *) handle,
+                              (const unsigned char *) pInput,
+                              inputLengthBytes);
+    }
+
+    return errorCode;
+}
+
+// Get the result of a SHA256 calculation.
+int32_t uPortCryptoSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                       char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((handle != NULL) && (pOutput != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        mbedtls_sha256_finish((mbedtls_sha256_context *) handle,
+                              (unsigned char *) pOutput);
+        // Ready for the next one
+        mbedtls_sha256_starts((mbedtls_sha256_context *) handle, 0);
+    }
+
+    return errorCode;
+}
+
+// Free a SHA256 context.
+void uPortCryptoSha256ContextDelete(uPortCryptoContextHandle_t handle)
+{
+    if (handle != NULL) {
+        mbedtls_sha256_free((mbedtls_sha256_context *) handle);
+        free(handle);
+    }
+}
+
+// Create a HMAC SHA256 context.
+int32_t uPortCryptoHmacSha256ContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                           const char *pKey,
+                                           size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    mbedtls_md_context_t *pContext;
+
+    if ((pHandle != NULL) && (pKey != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (mbedtls_md_context_t *) malloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_md_init(pContext);
+            // The 1 here means "HMAC"
+            errorCode = mbedtls_md_setup(pContext,
+                                         mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                                         1);
+            if (errorCode == 0) {
+                errorCode = mbedtls_md_hmac_starts(pContext,
+                                                   (const unsigned char *) pKey,
+                                                   keyLengthBytes);
+            }
+            if (errorCode == 0) {
+                *pHandle = (uPortCryptoContextHandle_t) pContext;
+            } else {
+                mbedtls_md_free(pContext);
+                free(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Add data to a HMAC SHA256 calculation.
+int32_t uPortCryptoHmacSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                           const char *pInput,
+                                           size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((handle != NULL) && ((pInput != NULL) || (inputLengthBytes == 0))) {
+        errorCode = mbedtls_md_hmac_update((mbedtls_md_context_t *) handle,
+                                           (const unsigned char *) pInput,
+                                           inputLengthBytes);
+    }
+
+    return errorCode;
+}
+
+// Get the result of a HMAC SHA256 calculation.
+int32_t uPortCryptoHmacSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                           char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((handle != NULL) && (pOutput != NULL)) {
+        errorCode = mbedtls_md_hmac_finish((mbedtls_md_context_t *) handle,
+                                           (unsigned char *) pOutput);
+        if (errorCode == 0) {
+            // Ready for the next one, with the same key
+            errorCode = mbedtls_md_hmac_reset((mbedtls_md_context_t *) handle);
+        }
+    }
+
+    return errorCode;
+}
+
+// Free a HMAC SHA256 context.
+void uPortCryptoHmacSha256ContextDelete(uPortCryptoContextHandle_t handle)
+{
+    if (handle != NULL) {
+        // This also wipes the key material
+        mbedtls_md_free((mbedtls_md_context_t *) handle);
+        free(handle);
+    }
+}
+
+// Create an AES 128 CBC context.
+int32_t uPortCryptoAes128CbcContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                          const char *pKey,
+                                          size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoAesContext_t *pContext;
+
+    if ((pHandle != NULL) && (pKey != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (uPortCryptoAesContext_t *) malloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            mbedtls_aes_init(&(pContext->encrypt));
+            mbedtls_aes_init(&(pContext->decrypt));
+            errorCode = mbedtls_aes_setkey_enc(&(pContext->encrypt),
+                                               (const unsigned char *) pKey,
+                                               keyLengthBytes * 8);
+            if (errorCode == 0) {
+                errorCode = mbedtls_aes_setkey_dec(&(pContext->decrypt),
+                                                   (const unsigned char *) pKey,
+                                                   keyLengthBytes * 8);
+            }
+            if (errorCode == 0) {
+                *pHandle = (uPortCryptoContextHandle_t) pContext;
+            } else {
+                uPortCryptoAes128CbcContextDelete((uPortCryptoContextHandle_t) pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Perform AES 128 CBC encryption using a context.
+int32_t uPortCryptoAes128CbcContextEncrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (handle != NULL) {
+        errorCode = mbedtls_aes_crypt_cbc(&(((uPortCryptoAesContext_t *) handle)->encrypt),
+                                          MBEDTLS_AES_ENCRYPT,
+                                          lengthBytes,
+                                          (unsigned char *) pInitVector,
+                                          (const unsigned char *) pInput,
+                                          (unsigned char *) pOutput);
+    }
+
+    return errorCode;
+}
+
+// Perform AES 128 CBC decryption using a context.
+int32_t uPortCryptoAes128CbcContextDecrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (handle != NULL) {
+        errorCode = mbedtls_aes_crypt_cbc(&(((uPortCryptoAesContext_t *) handle)->decrypt),
+                                          MBEDTLS_AES_DECRYPT,
+                                          lengthBytes,
+                                          (unsigned char *) pInitVector,
+                                          (const unsigned char *) pInput,
+                                          (unsigned char *) pOutput);
+    }
+
+    return errorCode;
+}
+
+// Free an AES 128 CBC context.
+void uPortCryptoAes128CbcContextDelete(uPortCryptoContextHandle_t handle)
+{
+    uPortCryptoAesContext_t *pContext = (uPortCryptoAesContext_t *) handle;
+
+    if (pContext != NULL) {
+        // These wipe the key schedules
+        mbedtls_aes_free(&(pContext->encrypt));
+        mbedtls_aes_free(&(pContext->decrypt));
+        free(pContext);
+    }
+}
+
 // End of file
@@ -99,6 +99,10 @@ typedef struct uMutexInfo_t {
     uMutexFunctionInfo_t *pCreator; // If this is NULL the entry is not in use.
     uMutexFunctionInfo_t *pLocker;
     uMutexFunctionInfo_t *pWaiting;
+    int32_t lockCount;      // Successful locks.
+    int32_t contendedCount; // Locks that found the mutex already locked.
+    int64_t waitTotalMs;    // Total time spent waiting for a lock.
+    int32_t waitMaxMs;      // Longest time spent waiting for a lock.
     struct uMutexInfo_t *pNext;
 } uMutexInfo_t;
 
@@ -196,6 +200,10 @@ static uMutexInfo_t *pAllocMutexInformationBlock()
             pMutexInfo->pLocker = NULL;
             pMutexInfo->pWaiting = NULL;
             pMutexInfo->handle = NULL;
+            pMutexInfo->lockCount = 0;
+            pMutexInfo->contendedCount = 0;
+            pMutexInfo->waitTotalMs = 0;
+            pMutexInfo->waitMaxMs = 0;
             pMutexInfo->pNext = NULL;
         }
     }
@@ -293,10 +301,12 @@ static bool unlinkWaiting(uMutexInfo_t *pMutexInfo,
  * STATIC FUNCTIONS: ONES THAT LOCK THE LIST MUTEX
  * -------------------------------------------------------------- */
 
-// Add a waiting entry to a mutex, returning a pointer to it.
+// Add a waiting entry to a mutex, returning a pointer to it;
+// *pContended is set to true if the mutex is already locked.
 static uMutexFunctionInfo_t *pLockAddWaiting(uMutexInfo_t *pMutexInfo,
                                              const char *pFile,
-                                             int32_t line)
+                                             int32_t line,
+                                             bool *pContended)
 {
     uMutexFunctionInfo_t *pWaiting = NULL;
     uMutexFunctionInfo_t *pTmp;
@@ -305,6 +315,7 @@ static uMutexFunctionInfo_t *pLockAddWaiting(uMutexInfo_t *pMutexInfo,
 
         U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
 
+        *pContended = (pMutexInfo->pLocker != NULL);
         // Create a waiting information entry
         pWaiting = pAllocFunctionInformationBlock();
         if (pWaiting != NULL) {
@@ -322,9 +333,11 @@ static uMutexFunctionInfo_t *pLockAddWaiting(uMutexInfo_t *pMutexInfo,
     return pWaiting;
 }
 
-// Move a waiting entry to become a locker entry.
+// Move a waiting entry to become a locker entry, updating
+// the contention statistics of the mutex.
 static bool lockMoveWaitingToLocker(uMutexInfo_t *pMutexInfo,
-                                    uMutexFunctionInfo_t *pWaiting)
+                                    uMutexFunctionInfo_t *pWaiting,
+                                    bool contended, int32_t waitMs)
 {
     bool success = false;
 
@@ -332,6 +345,15 @@ static bool lockMoveWaitingToLocker(uMutexInfo_t *pMutexInfo,
 
         U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
 
+        pMutexInfo->lockCount++;
+        if (contended) {
+            pMutexInfo->contendedCount++;
+        }
+        pMutexInfo->waitTotalMs += waitMs;
+        if (waitMs > pMutexInfo->waitMaxMs) {
+            pMutexInfo->waitMaxMs = waitMs;
+        }
+
         // If there is a locker, free it, it's gone
         freeFunctionInformationBlock(pMutexInfo->pLocker);
         // Unlink the waiting entry in the list, noting
@@ -514,6 +536,8 @@ int32_t uMutexDebugLock(uPortMutexHandle_t mutexHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uMutexInfo_t *pMutexInfo = (uMutexInfo_t *) mutexHandle;
     uMutexFunctionInfo_t *pWaiting;
+    bool contended = false;
+    int32_t startTimeMs;
 
     if (gMutexList != NULL) {
 
@@ -522,11 +546,13 @@ int32_t uMutexDebugLock(uPortMutexHandle_t mutexHandle,
         // the individual linked-list functions do so.
 
         errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pWaiting = pLockAddWaiting(pMutexInfo, pFile, line);
+        pWaiting = pLockAddWaiting(pMutexInfo, pFile, line, &contended);
         if (pWaiting != NULL) {
+            startTimeMs = (int32_t) uPortGetTickTimeMs();
             errorCode = _uPortMutexLock(pMutexInfo->handle);
             if (errorCode == 0) {
-                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting)) {
+                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting, contended,
+                                             (int32_t) uPortGetTickTimeMs() - startTimeMs)) {
                     lockFreeWaiting(pMutexInfo, pWaiting);
                 }
             } else {
@@ -547,6 +573,8 @@ int32_t uMutexDebugTryLock(uPortMutexHandle_t mutexHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uMutexInfo_t *pMutexInfo = (uMutexInfo_t *) mutexHandle;
     uMutexFunctionInfo_t *pWaiting;
+    bool contended = false;
+    int32_t startTimeMs;
 
     if (gMutexList != NULL) {
 
@@ -555,11 +583,13 @@ int32_t uMutexDebugTryLock(uPortMutexHandle_t mutexHandle,
         // the individual linked-list functions do so.
 
         errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pWaiting = pLockAddWaiting(pMutexInfo, pFile, line);
+        pWaiting = pLockAddWaiting(pMutexInfo, pFile, line, &contended);
         if (pWaiting != NULL) {
+            startTimeMs = (int32_t) uPortGetTickTimeMs();
             errorCode = _uPortMutexTryLock(pMutexInfo->handle, delayMs);
             if (errorCode == 0) {
-                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting)) {
+                if (!lockMoveWaitingToLocker(pMutexInfo, pWaiting, contended,
+                                             (int32_t) uPortGetTickTimeMs() - startTimeMs)) {
                     lockFreeWaiting(pMutexInfo, pWaiting);
                 }
             } else {
@@ -749,6 +779,92 @@ void uMutexDebugPrint(void *pParam)
     }
 }
 
+// Get the contention statistics summed across all mutexes.
+int32_t uMutexDebugStatsGet(uMutexDebugStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uMutexInfo_t *pMutexInfo;
+
+    if (gMutexList != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pStats != NULL) {
+
+            U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
+
+            memset(pStats, 0, sizeof(*pStats));
+            pMutexInfo = gpMutexInfoList;
+            while (pMutexInfo != NULL) {
+                pStats->numMutexes++;
+                pStats->lockCount += pMutexInfo->lockCount;
+                pStats->contendedCount += pMutexInfo->contendedCount;
+                pStats->waitTotalMs += pMutexInfo->waitTotalMs;
+                if (pMutexInfo->waitMaxMs > pStats->waitMaxMs) {
+                    pStats->waitMaxMs = pMutexInfo->waitMaxMs;
+                }
+                pMutexInfo = pMutexInfo->pNext;
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+            U_MUTEX_DEBUG_PORT_MUTEX_UNLOCK(gMutexList);
+        }
+    }
+
+    return errorCode;
+}
+
+// Reset the contention statistics of all mutexes.
+void uMutexDebugStatsReset(void)
+{
+    uMutexInfo_t *pMutexInfo;
+
+    if (gMutexList != NULL) {
+
+        U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
+
+        pMutexInfo = gpMutexInfoList;
+        while (pMutexInfo != NULL) {
+            pMutexInfo->lockCount = 0;
+            pMutexInfo->contendedCount = 0;
+            pMutexInfo->waitTotalMs = 0;
+            pMutexInfo->waitMaxMs = 0;
+            pMutexInfo = pMutexInfo->pNext;
+        }
+
+        U_MUTEX_DEBUG_PORT_MUTEX_UNLOCK(gMutexList);
+    }
+}
+
+// Print out the contention statistics of the contended mutexes.
+void uMutexDebugStatsPrint(void *pParam)
+{
+    uMutexInfo_t *pMutexInfo;
+
+    (void) pParam;
+
+    if (gMutexList != NULL) {
+
+        U_MUTEX_DEBUG_PORT_MUTEX_LOCK(gMutexList);
+
+        pMutexInfo = gpMutexInfoList;
+        while (pMutexInfo != NULL) {
+            if (pMutexInfo->contendedCount > 0) {
+                uPortLog("U_MUTEX_DEBUG_0x%08x: created by %s:%d, %d lock(s),"
+                         " %d contended, waited %d ms in total, %d ms at most.\n",
+                         pMutexInfo->handle,
+                         pMutexInfo->pCreator->pFile,
+                         pMutexInfo->pCreator->line,
+                         pMutexInfo->lockCount,
+                         pMutexInfo->contendedCount,
+                         (int32_t) pMutexInfo->waitTotalMs,
+                         pMutexInfo->waitMaxMs);
+            }
+            pMutexInfo = pMutexInfo->pNext;
+        }
+
+        U_MUTEX_DEBUG_PORT_MUTEX_UNLOCK(gMutexList);
+    }
+}
+
 #endif // U_CFG_MUTEX_DEBUG
 
 // End of file
@@ -131,6 +131,20 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Lock contention statistics, as returned by uMutexDebugStatsGet().
+ */
+typedef struct {
+    int32_t numMutexes;     /**< the number of mutexes in existence. */
+    int32_t lockCount;      /**< the number of successful locks. */
+    int32_t contendedCount; /**< the number of those locks that found
+                                 the mutex already locked and so had
+                                 to wait. */
+    int64_t waitTotalMs;    /**< the total time spent waiting for
+                                 locks in milliseconds. */
+    int32_t waitMaxMs;      /**< the longest time spent waiting for
+                                 any one lock in milliseconds. */
+} uMutexDebugStats_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: INTERMEDIATES FOR THE uPortMutex* FUNCTIONS
  * -------------------------------------------------------------- */
@@ -279,6 +293,29 @@ int32_t uMutexDebugWatchdog(void (*pCallback) (void *),
  */
 void uMutexDebugPrint(void *pParam);
 
+/** Get the lock contention statistics, summed across all of the
+ * mutexes that currently exist, since they were created or since
+ * uMutexDebugStatsReset() was last called.  May be used, for
+ * instance, to see how much time tasks spend waiting on ubxlib's
+ * mutexes when many devices and tasks are in use at once.
+ *
+ * @param[out] pStats a place to put the statistics, cannot be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uMutexDebugStatsGet(uMutexDebugStats_t *pStats);
+
+/** Reset the lock contention statistics of all mutexes.
+ */
+void uMutexDebugStatsReset(void);
+
+/** Print out the lock contention statistics of each mutex that
+ * has been contended; the parameter is a dummy so that this
+ * function has the same signature as uMutexDebugPrint().
+ *
+ * @param pParam  a dummy parameter.
+ */
+void uMutexDebugStatsPrint(void *pParam);
+
 #ifdef __cplusplus
 }
 #endif
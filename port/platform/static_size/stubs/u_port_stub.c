@@ -356,6 +356,28 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
     (void) sizeBytes;
     return 0;
 }
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes)
+{
+    (void) handle;
+    (void) pBuffer;
+    (void) sizeBytes;
+    return 0;
+}
+int32_t uPortUartWriteAsyncVector(int32_t handle,
+                                  const uPortUartWriteVector_t *pVector,
+                                  size_t numVector)
+{
+    (void) handle;
+    (void) pVector;
+    (void) numVector;
+    return 0;
+}
+int32_t uPortUartWriteAsyncGetPending(int32_t handle)
+{
+    (void) handle;
+    return 0;
+}
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
                                   void (*pFunction)(int32_t, uint32_t,
@@ -562,5 +584,98 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
     (void) pOutput;
     return 0;
 }
+int32_t uPortCryptoSha256ContextCreate(uPortCryptoContextHandle_t *pHandle)
+{
+    (void) pHandle;
+    return 0;
+}
+int32_t uPortCryptoSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                       const char *pInput,
+                                       size_t inputLengthBytes)
+{
+    (void) handle;
+    (void) pInput;
+    (void) inputLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                       char *pOutput)
+{
+    (void) handle;
+    (void) pOutput;
+    return 0;
+}
+void uPortCryptoSha256ContextDelete(uPortCryptoContextHandle_t handle)
+{
+    (void) handle;
+}
+int32_t uPortCryptoHmacSha256ContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                           const char *pKey,
+                                           size_t keyLengthBytes)
+{
+    (void) pHandle;
+    (void) pKey;
+    (void) keyLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoHmacSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                           const char *pInput,
+                                           size_t inputLengthBytes)
+{
+    (void) handle;
+    (void) pInput;
+    (void) inputLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoHmacSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                           char *pOutput)
+{
+    (void) handle;
+    (void) pOutput;
+    return 0;
+}
+void uPortCryptoHmacSha256ContextDelete(uPortCryptoContextHandle_t handle)
+{
+    (void) handle;
+}
+int32_t uPortCryptoAes128CbcContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                          const char *pKey,
+                                          size_t keyLengthBytes)
+{
+    (void) pHandle;
+    (void) pKey;
+    (void) keyLengthBytes;
+    return 0;
+}
+int32_t uPortCryptoAes128CbcContextEncrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput)
+{
+    (void) handle;
+    (void) pInitVector;
+    (void) pInput;
+    (void) lengthBytes;
+    (void) pOutput;
+    return 0;
+}
+int32_t uPortCryptoAes128CbcContextDecrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput)
+{
+    (void) handle;
+    (void) pInitVector;
+    (void) pInput;
+    (void) lengthBytes;
+    (void) pOutput;
+    return 0;
+}
+void uPortCryptoAes128CbcContextDelete(uPortCryptoContextHandle_t handle)
+{
+    (void) handle;
+}
 
 // End of file
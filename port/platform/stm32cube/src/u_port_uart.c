@@ -1356,6 +1356,34 @@ int32_t uPortUartWrite(int32_t handle,
     return sizeOrErrorCode;
 }
 
+// Write asynchronously: not supported on this platform.
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes)
+{
+    (void) handle;
+    (void) pBuffer;
+    (void) sizeBytes;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Write asynchronously from several buffers: not supported.
+int32_t uPortUartWriteAsyncVector(int32_t handle,
+                                  const uPortUartWriteVector_t *pVector,
+                                  size_t numVector)
+{
+    (void) handle;
+    (void) pVector;
+    (void) numVector;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Get the number of pending asynchronous writes: not supported.
+int32_t uPortUartWriteAsyncGetPending(int32_t handle)
+{
+    (void) handle;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
 // Set an event callback.
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
@@ -22,6 +22,7 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stdlib.h"    // malloc()/free()
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
@@ -43,6 +44,14 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A crypto context: for SHA256/HMAC SHA256 objectHandle is a
+ * reusable hash object, for AES it is the key object.
+ */
+typedef struct {
+    BCRYPT_ALG_HANDLE algorithmHandle;
+    BCRYPT_HANDLE objectHandle;
+} uPortCryptoContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -51,6 +60,85 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Create a reusable hash context, HMAC if pKey is non-NULL.
+static int32_t hashContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                 const char *pKey, size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uPortCryptoContext_t *pContext;
+
+    pContext = (uPortCryptoContext_t *) malloc(sizeof(*pContext));
+    if (pContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (BCryptOpenAlgorithmProvider(&(pContext->algorithmHandle),
+                                        BCRYPT_SHA256_ALGORITHM, NULL,
+                                        pKey != NULL ? BCRYPT_ALG_HANDLE_HMAC_FLAG : 0) >= 0) {
+            // A reusable hash object goes back to its initial
+            // state, including any key, after BCryptFinishHash()
+            if (BCryptCreateHash(pContext->algorithmHandle,
+                                 &(pContext->objectHandle),
+                                 NULL, 0, (PUCHAR) pKey, (ULONG) keyLengthBytes,
+                                 BCRYPT_HASH_REUSABLE_FLAG) >= 0) {
+                *pHandle = (uPortCryptoContextHandle_t) pContext;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                BCryptCloseAlgorithmProvider(pContext->algorithmHandle, 0);
+            }
+        }
+        if (errorCode != 0) {
+            free(pContext);
+        }
+    }
+
+    return errorCode;
+}
+
+// Add data to a hash context.
+static int32_t hashContextUpdate(uPortCryptoContextHandle_t handle,
+                                 const char *pInput, size_t inputLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((handle != NULL) && ((pInput != NULL) || (inputLengthBytes == 0))) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (BCryptHashData(((uPortCryptoContext_t *) handle)->objectHandle,
+                           (PUCHAR) pInput, (ULONG) inputLengthBytes, 0) >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the result from a hash context.
+static int32_t hashContextFinish(uPortCryptoContextHandle_t handle, char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((handle != NULL) && (pOutput != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (BCryptFinishHash(((uPortCryptoContext_t *) handle)->objectHandle,
+                             (PUCHAR) pOutput,
+                             U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES, 0) >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Free a hash context.
+static void hashContextDelete(uPortCryptoContextHandle_t handle)
+{
+    uPortCryptoContext_t *pContext = (uPortCryptoContext_t *) handle;
+
+    if (pContext != NULL) {
+        BCryptDestroyHash(pContext->objectHandle);
+        BCryptCloseAlgorithmProvider(pContext->algorithmHandle, 0);
+        free(pContext);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -228,4 +316,173 @@ int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
     return errorCode;
 }
 
+// Create a SHA256 context.
+int32_t uPortCryptoSha256ContextCreate(uPortCryptoContextHandle_t *pHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pHandle != NULL) {
+        errorCode = hashContextCreate(pHandle, NULL, 0);
+    }
+
+    return errorCode;
+}
+
+// Add data to a SHA256 calculation.
+int32_t uPortCryptoSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                       const char *pInput,
+                                       size_t inputLengthBytes)
+{
+    return hashContextUpdate(handle, pInput, inputLengthBytes);
+}
+
+// Get the result of a SHA256 calculation.
+int32_t uPortCryptoSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                       char *pOutput)
+{
+    return hashContextFinish(handle, pOutput);
+}
+
+// Free a SHA256 context.
+void uPortCryptoSha256ContextDelete(uPortCryptoContextHandle_t handle)
+{
+    hashContextDelete(handle);
+}
+
+// Create a HMAC SHA256 context.
+int32_t uPortCryptoHmacSha256ContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                           const char *pKey,
+                                           size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pHandle != NULL) && (pKey != NULL)) {
+        errorCode = hashContextCreate(pHandle, pKey, keyLengthBytes);
+    }
+
+    return errorCode;
+}
+
+// Add data to a HMAC SHA256 calculation.
+int32_t uPortCryptoHmacSha256ContextUpdate(uPortCryptoContextHandle_t handle,
+                                           const char *pInput,
+                                           size_t inputLengthBytes)
+{
+    return hashContextUpdate(handle, pInput, inputLengthBytes);
+}
+
+// Get the result of a HMAC SHA256 calculation.
+int32_t uPortCryptoHmacSha256ContextFinish(uPortCryptoContextHandle_t handle,
+                                           char *pOutput)
+{
+    return hashContextFinish(handle, pOutput);
+}
+
+// Free a HMAC SHA256 context.
+void uPortCryptoHmacSha256ContextDelete(uPortCryptoContextHandle_t handle)
+{
+    hashContextDelete(handle);
+}
+
+// Create an AES 128 CBC context.
+int32_t uPortCryptoAes128CbcContextCreate(uPortCryptoContextHandle_t *pHandle,
+                                          const char *pKey,
+                                          size_t keyLengthBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortCryptoContext_t *pContext;
+
+    if ((pHandle != NULL) && (pKey != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = (uPortCryptoContext_t *) malloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            if (BCryptOpenAlgorithmProvider(&(pContext->algorithmHandle),
+                                            BCRYPT_AES_ALGORITHM,
+                                            NULL, 0) >= 0) {
+                // Set CBC and generate the key object once
+                if ((BCryptSetProperty(pContext->algorithmHandle, BCRYPT_CHAINING_MODE,
+                                       (PBYTE) BCRYPT_CHAIN_MODE_CBC,
+                                       sizeof(BCRYPT_CHAIN_MODE_CBC), 0) >= 0) &&
+                    (BCryptGenerateSymmetricKey(pContext->algorithmHandle,
+                                                &(pContext->objectHandle), NULL, 0,
+                                                (PUCHAR) pKey, (ULONG) keyLengthBytes,
+                                                0) >= 0)) {
+                    *pHandle = (uPortCryptoContextHandle_t) pContext;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                } else {
+                    BCryptCloseAlgorithmProvider(pContext->algorithmHandle, 0);
+                }
+            }
+            if (errorCode != 0) {
+                free(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Perform AES 128 CBC encryption using a context.
+int32_t uPortCryptoAes128CbcContextEncrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    DWORD resultLength = 0;
+
+    if (handle != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (BCryptEncrypt(((uPortCryptoContext_t *) handle)->objectHandle,
+                          (PUCHAR) pInput, (ULONG) lengthBytes, NULL,
+                          (PUCHAR) pInitVector,
+                          U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES,
+                          (PUCHAR) pOutput, (ULONG) lengthBytes,
+                          &resultLength, 0) >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Perform AES 128 CBC decryption using a context.
+int32_t uPortCryptoAes128CbcContextDecrypt(uPortCryptoContextHandle_t handle,
+                                           char *pInitVector,
+                                           const char *pInput,
+                                           size_t lengthBytes,
+                                           char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    DWORD resultLength = 0;
+
+    if (handle != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (BCryptDecrypt(((uPortCryptoContext_t *) handle)->objectHandle,
+                          (PUCHAR) pInput, (ULONG) lengthBytes, NULL,
+                          (PUCHAR) pInitVector,
+                          U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES,
+                          (PUCHAR) pOutput, (ULONG) lengthBytes,
+                          &resultLength, 0) >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Free an AES 128 CBC context.
+void uPortCryptoAes128CbcContextDelete(uPortCryptoContextHandle_t handle)
+{
+    uPortCryptoContext_t *pContext = (uPortCryptoContext_t *) handle;
+
+    if (pContext != NULL) {
+        BCryptDestroyKey(pContext->objectHandle);
+        BCryptCloseAlgorithmProvider(pContext->algorithmHandle, 0);
+        free(pContext);
+    }
+}
+
 // End of file
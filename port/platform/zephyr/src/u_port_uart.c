@@ -63,10 +63,35 @@
 #define U_PORT_UART_MAX_NUM 4
 #endif
 
+/** The period of pollTimer(), used when the UART is not interrupt
+ * driven.
+ */
+#define U_PORT_UART_POLL_TIMER_PERIOD_MS 1
+
+/* U_PORT_UART_POLL_TX_MAX_BYTES may be defined to fix the maximum
+ * number of bytes that pollTimer() transmits in one tick; if it is
+ * not defined the number is worked out from the baud rate of the
+ * UART, see pollTxBudget().
+ */
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A block of data to transmit, queued on fifoTxData.
+ */
+struct uartData_t {
+    void *pFifoReserved; /**< first word is reserved for use by k_fifo. */
+    int32_t handle;
+    const char *pData;
+    size_t len;
+    bool isAsync;        /**< true if queued by uPortUartWriteAsync[Vector](). */
+    bool isLast;         /**< true if this is the last (or only) buffer of
+                              an asynchronous write, i.e. the one that
+                              sends the completion event. */
+    bool inUse;          /**< only used for the isAsync case. */
+};
+
 /** Structure of the things we need to keep track of per UART.
  */
 typedef struct {
@@ -82,12 +107,12 @@ typedef struct {
     int32_t bufferWrite;
     bool bufferFull;
     struct k_timer rxTimer;
-#ifdef CONFIG_UART_INTERRUPT_DRIVEN
-    struct uartData_t *pTxData;
     struct k_fifo fifoTxData;
-    uint32_t txWritten;
     struct k_sem txSem;
-#else
+    struct uartData_t txAsyncData[U_PORT_UART_WRITE_ASYNC_MAX_NUM];
+    struct uartData_t *pTxData;
+    uint32_t txWritten;
+#ifndef CONFIG_UART_INTERRUPT_DRIVEN
     struct k_timer pollTimer;
 #endif
 } uPortUartData_t;
@@ -99,12 +124,6 @@ typedef struct {
     uint32_t eventBitMap;
 } uPortUartEvent_t;
 
-struct uartData_t {
-    int32_t handle;
-    char *pData;
-    uint16_t len;
-} uartData_t;
-
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -140,6 +159,35 @@ static void eventHandler(void *pParam, size_t paramLength)
     }
 }
 
+// Send an event to the callback from interrupt context, if
+// it is not filtered out.
+static void eventSendIrq(int32_t handle, uint32_t eventBitMap)
+{
+    uPortUartEvent_t event;
+
+    if ((gUartData[handle].eventQueueHandle >= 0) &&
+        (gUartData[handle].eventFilter & eventBitMap)) {
+        event.uartHandle = handle;
+        event.eventBitMap = eventBitMap;
+        uPortEventQueueSendIrq(gUartData[handle].eventQueueHandle,
+                               &event, sizeof(event));
+    }
+}
+
+// Called, possibly in interrupt context, when a block of data
+// from fifoTxData has been transmitted.
+static void txDone(int32_t handle, struct uartData_t *pTxData)
+{
+    if (pTxData->isAsync) {
+        pTxData->inUse = false;
+        if (pTxData->isLast) {
+            eventSendIrq(handle, U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE);
+        }
+    } else {
+        k_sem_give(&gUartData[handle].txSem);
+    }
+}
+
 // Close a UART instance
 // Note: gMutex should be locked before this is called.
 static void uartClose(int32_t handle)
@@ -160,10 +208,12 @@ static void uartClose(int32_t handle)
     gUartData[handle].eventFilter = 0;
     gUartData[handle].pEventCallback = NULL;
     gUartData[handle].pEventCallbackParam = NULL;
-#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+    // Anything still queued for transmission is dropped
+    for (size_t x = 0; x < U_PORT_UART_WRITE_ASYNC_MAX_NUM; x++) {
+        gUartData[handle].txAsyncData[x].inUse = false;
+    }
     gUartData[handle].pTxData = NULL;
     gUartData[handle].txWritten = 0;
-#endif
 }
 
 static void rxTimer(struct k_timer *timer_id)
@@ -252,9 +302,9 @@ static void uartCb(const struct device *uart, void *user_data)
                                                      gUartData[i].pTxData->len - gUartData[i].txWritten);
 
         } else {
+            txDone(i, gUartData[i].pTxData);
             gUartData[i].pTxData = NULL;
             gUartData[i].txWritten = 0;
-            k_sem_give(&gUartData[i].txSem);
 
             if (k_fifo_is_empty(&gUartData[i].fifoTxData)) {
                 uart_irq_tx_disable(uart);
@@ -265,8 +315,26 @@ static void uartCb(const struct device *uart, void *user_data)
 
 #else
 
-// Polled receive for when an interrupt-driven UART driver
-// is not available (though note that pollTimer is still
+// Return the number of bytes that pollTimer() may transmit in one
+// tick: uart_poll_out() waits for each byte to go, so sending more
+// than the line can carry in a tick would only keep us in the timer
+// interrupt for longer, while sending less would cap the throughput
+// below the line rate.
+static size_t pollTxBudget(int32_t uart)
+{
+#ifdef U_PORT_UART_POLL_TX_MAX_BYTES
+    (void) uart;
+    return U_PORT_UART_POLL_TX_MAX_BYTES;
+#else
+    // 10 bits per byte (start bit, 8 data bits, stop bit), rounded
+    // up so that there is always at least one
+    return ((gUartData[uart].config.baudrate * U_PORT_UART_POLL_TIMER_PERIOD_MS) +
+            9999) / 10000;
+#endif
+}
+
+// Polled receive and transmit for when an interrupt-driven UART
+// driver is not available (though note that pollTimer is still
 // run in interrupt context, just not that of the UART, that of
 // the timer code instead).
 // Note: this is not intended to be efficient, just as similar
@@ -276,6 +344,33 @@ static void pollTimer(struct k_timer *timer_id)
 {
     uint32_t uart = (uint32_t)(timer_id->user_data);
     bool read = false;
+    size_t budget = pollTxBudget((int32_t) uart);
+    struct uartData_t *pTxData;
+
+    // Transmit whatever has been queued, in order, but only as
+    // much as the line can carry in a tick since each
+    // uart_poll_out() blocks until its byte has gone
+    while (budget > 0) {
+        if (gUartData[uart].pTxData == NULL) {
+            gUartData[uart].pTxData = k_fifo_get(&gUartData[uart].fifoTxData, K_NO_WAIT);
+            gUartData[uart].txWritten = 0;
+        }
+        pTxData = gUartData[uart].pTxData;
+        if (pTxData == NULL) {
+            break;
+        }
+        while ((budget > 0) && (gUartData[uart].txWritten < pTxData->len)) {
+            uart_poll_out(gUartData[uart].pDevice,
+                          (unsigned char) * (pTxData->pData + gUartData[uart].txWritten));
+            gUartData[uart].txWritten++;
+            budget--;
+        }
+        if (gUartData[uart].txWritten >= pTxData->len) {
+            gUartData[uart].pTxData = NULL;
+            gUartData[uart].txWritten = 0;
+            txDone(uart, pTxData);
+        }
+    }
 
     while (!gUartData[uart].bufferFull &&
            (uart_poll_in(gUartData[uart].pDevice,
@@ -393,12 +488,13 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
             if (gUartData[uart].pBuffer == NULL) {
                 handleOrErrorCode = U_ERROR_COMMON_NO_MEMORY;
             } else {
-#ifdef CONFIG_UART_INTERRUPT_DRIVEN
                 k_sem_init(&gUartData[uart].txSem, 0, 1);
                 k_fifo_init(&gUartData[uart].fifoTxData);
+                for (size_t x = 0; x < U_PORT_UART_WRITE_ASYNC_MAX_NUM; x++) {
+                    gUartData[uart].txAsyncData[x].inUse = false;
+                }
                 gUartData[uart].pTxData = NULL;
                 gUartData[uart].txWritten = 0;
-#endif
                 gUartData[uart].receiveBufferSizeBytes = receiveBufferSizeBytes;
                 gUartData[uart].bufferRead = 0;
                 gUartData[uart].bufferWrite = 0;
@@ -426,7 +522,9 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
 #else
                 k_timer_init(&gUartData[uart].pollTimer, pollTimer, NULL);
                 k_timer_user_data_set(&gUartData[uart].pollTimer, (void *)uart);
-                k_timer_start(&gUartData[uart].pollTimer, K_MSEC(1), K_MSEC(1));
+                k_timer_start(&gUartData[uart].pollTimer,
+                              K_MSEC(U_PORT_UART_POLL_TIMER_PERIOD_MS),
+                              K_MSEC(U_PORT_UART_POLL_TIMER_PERIOD_MS));
 #endif
                 handleOrErrorCode = uart;
             }
@@ -571,32 +669,125 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
             // it or the CTS pin when configuring this UART
             // was wrong and it's not connected to the right
             // thing.
-#ifdef CONFIG_UART_INTERRUPT_DRIVEN
             struct uartData_t data;
             data.handle = handle;
-            data.pData = (void *)pBuffer;
+            data.pData = (const char *) pBuffer;
             data.len = sizeBytes;
+            data.isAsync = false;
 
+            // Queue the data behind anything written with
+            // uPortUartWriteAsync() so that order is preserved;
+            // without interrupts pollTimer() does the sending
             k_fifo_put(&gUartData[handle].fifoTxData, &data);
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
             uart_irq_tx_enable(gUartData[handle].pDevice);
+#endif
             // UART write is async to wait here to make this function synchronous
             k_sem_take(&gUartData[handle].txSem, K_FOREVER);
-#else
-            // When we have no interrupts we can block right here
-            const unsigned char *pBufferUnsignedChar = (const unsigned char *) pBuffer;
-            while (sizeBytes > 0) {
-                uart_poll_out(gUartData[handle].pDevice, *pBufferUnsignedChar);
-                pBufferUnsignedChar++;
-                sizeBytes--;
+
+            U_PORT_MUTEX_UNLOCK(gMutex);
+        }
+    }
+
+    return (int32_t) errorCode;
+}
+
+int32_t uPortUartWriteAsync(int32_t handle, const void *pBuffer,
+                            size_t sizeBytes)
+{
+    uPortUartWriteVector_t vector;
+
+    vector.pBuffer = pBuffer;
+    vector.sizeBytes = sizeBytes;
+
+    return uPortUartWriteAsyncVector(handle, &vector, 1);
+}
+
+int32_t uPortUartWriteAsyncVector(int32_t handle,
+                                  const uPortUartWriteVector_t *pVector,
+                                  size_t numVector)
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
+    struct uartData_t *pTxData[U_PORT_UART_WRITE_ASYNC_MAX_NUM];
+    size_t numFree = 0;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pVector != NULL) && (numVector > 0) && (handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            (gUartData[handle].pDevice != NULL) &&
+            (gUartData[handle].pBuffer != NULL)) {
+            bool vectorOk = true;
+            for (size_t x = 0; vectorOk && (x < numVector); x++) {
+                vectorOk = (pVector[x].pBuffer != NULL) && (pVector[x].sizeBytes > 0);
+            }
+            if (vectorOk) {
+                // Find enough free slots for all of the buffers
+                // before queueing any of them
+                errorCode = U_ERROR_COMMON_NO_MEMORY;
+                for (size_t x = 0; (numFree < numVector) &&
+                     (x < U_PORT_UART_WRITE_ASYNC_MAX_NUM); x++) {
+                    if (!gUartData[handle].txAsyncData[x].inUse) {
+                        pTxData[numFree] = &(gUartData[handle].txAsyncData[x]);
+                        numFree++;
+                    }
+                }
             }
+            if ((numFree > 0) && (numFree == numVector)) {
+                for (size_t x = 0; x < numVector; x++) {
+                    pTxData[x]->handle = handle;
+                    pTxData[x]->pData = (const char *) pVector[x].pBuffer;
+                    pTxData[x]->len = pVector[x].sizeBytes;
+                    pTxData[x]->isAsync = true;
+                    pTxData[x]->isLast = (x == numVector - 1);
+                    pTxData[x]->inUse = true;
+                    k_fifo_put(&gUartData[handle].fifoTxData, pTxData[x]);
+                }
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+                uart_irq_tx_enable(gUartData[handle].pDevice);
 #endif
-            U_PORT_MUTEX_UNLOCK(gMutex);
+                errorCode = U_ERROR_COMMON_SUCCESS;
+            }
         }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
     }
 
     return (int32_t) errorCode;
 }
 
+int32_t uPortUartWriteAsyncGetPending(int32_t handle)
+{
+    uErrorCode_t countOrErrorCode = U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        countOrErrorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            (gUartData[handle].pDevice != NULL)) {
+            countOrErrorCode = 0;
+            // Only the last buffer of each call is counted
+            // so that a vectored write counts as one
+            for (size_t x = 0; x < U_PORT_UART_WRITE_ASYNC_MAX_NUM; x++) {
+                if (gUartData[handle].txAsyncData[x].inUse &&
+                    gUartData[handle].txAsyncData[x].isLast) {
+                    countOrErrorCode++;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return (int32_t) countOrErrorCode;
+}
+
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
                                   void (*pFunction)(int32_t,
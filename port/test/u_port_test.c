@@ -231,6 +231,22 @@
 # define U_PORT_TEST_CRITICAL_SECTION_TEST_WAIT_LOOPS 1000000
 #endif
 
+#ifndef U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS
+/** The number of frames to process when comparing the cost of
+ * the one-shot crypto functions with that of the crypto contexts.
+ */
+# define U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS 200
+#endif
+
+#ifndef U_PORT_TEST_CRYPTO_BENCHMARK_FRAME_LENGTH_BYTES
+/** The size of frame to use when comparing the cost of the
+ * one-shot crypto functions with that of the crypto contexts;
+ * must be a multiple of 16, 256 being the largest chip to chip
+ * security frame.
+ */
+# define U_PORT_TEST_CRYPTO_BENCHMARK_FRAME_LENGTH_BYTES 256
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -246,6 +262,7 @@ typedef struct {
     size_t indexInBlock;
     char *pReceive;
     size_t bytesReceived;
+    size_t writeCompleteCount;
     int32_t errorCode;
 } uartEventCallbackData_t;
 
@@ -863,9 +880,13 @@ static void uartReceivedDataCallback(int32_t uartHandle,
     uartEventCallbackData_t *pEventCallbackData = (uartEventCallbackData_t *) pParameters;
 
     pEventCallbackData->callCount++;
-    if (filter != U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+    if (filter & U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE) {
+        pEventCallbackData->writeCompleteCount++;
+    }
+    if ((filter & ~(U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED |
+                    U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE)) != 0) {
         pEventCallbackData->errorCode = -1;
-    } else {
+    } else if (filter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
         // Run until we spot an error or run out of data
         do {
             receiveSizeOrError = uPortUartGetReceiveSize(uartHandle);
@@ -939,6 +960,8 @@ static void runUartTest(int32_t size, int32_t speed, bool flowControlOn)
     uPortGpioConfig_t gpioConfig = U_PORT_GPIO_CONFIG_DEFAULT;
     int32_t stackMinFreeBytes;
     int32_t x;
+    int32_t y;
+    uPortUartWriteVector_t vector[3];
 
     eventCallbackData.callCount = 0;
     eventCallbackData.pReceive = gUartBuffer;
@@ -1093,6 +1116,73 @@ static void runUartTest(int32_t size, int32_t speed, bool flowControlOn)
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
     }
 
+    // Now, where supported, queue some more of the same with
+    // the asynchronous write, which should be received in order
+    // and result in one write-complete event per write
+    x = uPortUartWriteAsync(uartHandle, gUartTestData, 0);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(x < 0);
+        U_PORT_TEST_ASSERT(uPortUartEventCallbackFilterSet(uartHandle,
+                                                           (uint32_t) (U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED |
+                                                                       U_PORT_UART_EVENT_BITMASK_WRITE_COMPLETE)) == 0);
+        U_TEST_PRINT_LINE("testing asynchronous write...");
+        x = 0;
+        while (x < U_PORT_UART_WRITE_ASYNC_MAX_NUM) {
+            // Carry on from where the receiver expects to be in
+            // gUartTestData; the same buffer is used each time,
+            // which is fine since it is never modified
+            // (-1 to omit gUartTestData string terminator)
+            bytesToSend = bytesSent % (sizeof(gUartTestData) - 1);
+            U_PORT_TEST_ASSERT(uPortUartWriteAsync(uartHandle,
+                                                   gUartTestData + bytesToSend,
+                                                   sizeof(gUartTestData) - 1 - bytesToSend) == 0);
+            bytesSent += sizeof(gUartTestData) - 1 - bytesToSend;
+            x++;
+        }
+        U_PORT_TEST_ASSERT(uPortUartWriteAsyncGetPending(uartHandle) >= 0);
+        U_PORT_TEST_ASSERT(uPortUartWriteAsyncGetPending(uartHandle) <= x);
+        uPortTaskBlock(U_PORT_TEST_UART_TIME_TO_ARRIVE_MS);
+        U_TEST_PRINT_LINE("%d asynchronous write(s), %d completion event(s).",
+                          x, eventCallbackData.writeCompleteCount);
+        U_PORT_TEST_ASSERT(uPortUartWriteAsyncGetPending(uartHandle) == 0);
+        U_PORT_TEST_ASSERT(eventCallbackData.writeCompleteCount == (size_t) x);
+
+        // Where supported, do the same again in one vectored
+        // write, splitting the remainder of gUartTestData into
+        // pieces: this should result in a single completion event
+        x = uPortUartWriteAsyncVector(uartHandle, NULL, 0);
+        if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+            U_PORT_TEST_ASSERT(x < 0);
+            U_TEST_PRINT_LINE("testing vectored asynchronous write...");
+            // (-1 to omit gUartTestData string terminator)
+            bytesToSend = bytesSent % (sizeof(gUartTestData) - 1);
+            y = sizeof(gUartTestData) - 1 - bytesToSend;
+            vector[0].pBuffer = gUartTestData + bytesToSend;
+            vector[0].sizeBytes = y / 3;
+            vector[1].pBuffer = gUartTestData + bytesToSend + (y / 3);
+            vector[1].sizeBytes = y / 3;
+            vector[2].pBuffer = gUartTestData + bytesToSend + ((y / 3) * 2);
+            vector[2].sizeBytes = y - ((y / 3) * 2);
+            x = eventCallbackData.writeCompleteCount;
+            // A vector with an empty entry should be rejected entirely
+            vector[1].sizeBytes = 0;
+            U_PORT_TEST_ASSERT(uPortUartWriteAsyncVector(uartHandle, vector,
+                                                         sizeof(vector) / sizeof(vector[0])) < 0);
+            vector[1].sizeBytes = y / 3;
+            U_PORT_TEST_ASSERT(uPortUartWriteAsyncVector(uartHandle, vector,
+                                                         sizeof(vector) / sizeof(vector[0])) == 0);
+            bytesSent += y;
+            U_PORT_TEST_ASSERT(uPortUartWriteAsyncGetPending(uartHandle) >= 0);
+            U_PORT_TEST_ASSERT(uPortUartWriteAsyncGetPending(uartHandle) <= 1);
+            uPortTaskBlock(U_PORT_TEST_UART_TIME_TO_ARRIVE_MS);
+            U_TEST_PRINT_LINE("vectored write of %d piece(s), %d completion event(s).",
+                              (int32_t) (sizeof(vector) / sizeof(vector[0])),
+                              eventCallbackData.writeCompleteCount - x);
+            U_PORT_TEST_ASSERT(uPortUartWriteAsyncGetPending(uartHandle) == 0);
+            U_PORT_TEST_ASSERT(eventCallbackData.writeCompleteCount == (size_t) x + 1);
+        }
+    }
+
     // Wait long enough for everything to have been received
     uPortTaskBlock(U_PORT_TEST_UART_TIME_TO_ARRIVE_MS);
 
@@ -2595,6 +2685,138 @@ U_PORT_TEST_FUNCTION("[port]", "portCrypto")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test crypto contexts against the same vectors as portCrypto
+ * and print how long a chip to chip security sized frame takes
+ * with and without them.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portCryptoContext")
+{
+    char buffer[U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES];
+    char iv[U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES];
+    uPortCryptoContextHandle_t sha256Context = NULL;
+    uPortCryptoContextHandle_t hmacContext = NULL;
+    uPortCryptoContextHandle_t aesContext = NULL;
+    char *pFrame;
+    int32_t heapUsed;
+    int32_t startTimeMs;
+    int32_t oneShotTimeMs;
+    int32_t contextTimeMs;
+    size_t frameLength = U_PORT_TEST_CRYPTO_BENCHMARK_FRAME_LENGTH_BYTES;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    x = uPortCryptoSha256ContextCreate(&sha256Context);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(x == 0);
+        U_TEST_PRINT_LINE("testing SHA256 context...");
+        // Twice, to check that the context can be reused, the
+        // second time feeding the input in two pieces
+        for (size_t y = 0; y < 2; y++) {
+            memset(buffer, 0, sizeof(buffer));
+            x = (int32_t) y * 10;
+            U_PORT_TEST_ASSERT(uPortCryptoSha256ContextUpdate(sha256Context, gSha256Input,
+                                                              x) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoSha256ContextUpdate(sha256Context, gSha256Input + x,
+                                                              sizeof(gSha256Input) - 1 - x) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoSha256ContextFinish(sha256Context, buffer) == 0);
+            U_PORT_TEST_ASSERT(memcmp(buffer, gSha256Output,
+                                      U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES) == 0);
+        }
+        uPortCryptoSha256ContextDelete(sha256Context);
+
+        U_TEST_PRINT_LINE("testing HMAC SHA256 context...");
+        U_PORT_TEST_ASSERT(uPortCryptoHmacSha256ContextCreate(&hmacContext, gHmacSha256Key,
+                                                              sizeof(gHmacSha256Key) - 1) == 0);
+        for (size_t y = 0; y < 2; y++) {
+            memset(buffer, 0, sizeof(buffer));
+            x = (int32_t) y * 3;
+            U_PORT_TEST_ASSERT(uPortCryptoHmacSha256ContextUpdate(hmacContext, gHmacSha256Input,
+                                                                  x) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoHmacSha256ContextUpdate(hmacContext,
+                                                                  gHmacSha256Input + x,
+                                                                  (sizeof(gHmacSha256Input) - 1) -
+                                                                  x) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoHmacSha256ContextFinish(hmacContext, buffer) == 0);
+            U_PORT_TEST_ASSERT(memcmp(buffer, gHmacSha256Output,
+                                      U_PORT_CRYPTO_SHA256_OUTPUT_LENGTH_BYTES) == 0);
+        }
+
+        U_TEST_PRINT_LINE("testing AES CBC 128 context...");
+        U_PORT_TEST_ASSERT(uPortCryptoAes128CbcContextCreate(&aesContext, gAes128CbcKey,
+                                                             sizeof(gAes128CbcKey) - 1) == 0);
+        for (size_t y = 0; y < 2; y++) {
+            memcpy(iv, gAes128CbcIV, sizeof(iv));
+            U_PORT_TEST_ASSERT(uPortCryptoAes128CbcContextEncrypt(aesContext, iv,
+                                                                  gAes128CbcClear,
+                                                                  sizeof(gAes128CbcClear) - 1,
+                                                                  buffer) == 0);
+            U_PORT_TEST_ASSERT(memcmp(buffer, gAes128CbcEncrypted,
+                                      sizeof(gAes128CbcEncrypted) - 1) == 0);
+            memcpy(iv, gAes128CbcIV, sizeof(iv));
+            x = (int32_t) sizeof(gAes128CbcEncrypted) - 1;
+            U_PORT_TEST_ASSERT(uPortCryptoAes128CbcContextDecrypt(aesContext, iv,
+                                                                  gAes128CbcEncrypted,
+                                                                  x, buffer) == 0);
+            U_PORT_TEST_ASSERT(memcmp(buffer, gAes128CbcClear,
+                                      sizeof(gAes128CbcClear) - 1) == 0);
+        }
+
+        // Now the comparison: a frame is encrypted and then a HMAC
+        // is taken across it, as chip to chip security does
+        pFrame = (char *) malloc(frameLength);
+        U_PORT_TEST_ASSERT(pFrame != NULL);
+        memset(pFrame, 0x5a, frameLength);
+        startTimeMs = uPortGetTickTimeMs();
+        for (size_t y = 0; y < U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS; y++) {
+            U_PORT_TEST_ASSERT(uPortCryptoAes128CbcEncrypt(gAes128CbcKey,
+                                                           sizeof(gAes128CbcKey) - 1, iv,
+                                                           pFrame, frameLength, pFrame) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoHmacSha256(gHmacSha256Key,
+                                                     sizeof(gHmacSha256Key) - 1,
+                                                     pFrame, frameLength, buffer) == 0);
+        }
+        oneShotTimeMs = uPortGetTickTimeMs() - startTimeMs;
+        startTimeMs = uPortGetTickTimeMs();
+        for (size_t y = 0; y < U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS; y++) {
+            U_PORT_TEST_ASSERT(uPortCryptoAes128CbcContextEncrypt(aesContext, iv, pFrame,
+                                                                  frameLength, pFrame) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoHmacSha256ContextUpdate(hmacContext, pFrame,
+                                                                  frameLength) == 0);
+            U_PORT_TEST_ASSERT(uPortCryptoHmacSha256ContextFinish(hmacContext, buffer) == 0);
+        }
+        contextTimeMs = uPortGetTickTimeMs() - startTimeMs;
+        U_TEST_PRINT_LINE("%d frame(s) of %d byte(s), AES CBC 128 encrypt plus"
+                          " HMAC SHA256:", U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS,
+                          (int32_t) frameLength);
+        U_TEST_PRINT_LINE("  one-shot functions took %d ms (%d us per frame).", oneShotTimeMs,
+                          (oneShotTimeMs * 1000) / U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS);
+        U_TEST_PRINT_LINE("  contexts took %d ms (%d us per frame).", contextTimeMs,
+                          (contextTimeMs * 1000) / U_PORT_TEST_CRYPTO_BENCHMARK_ITERATIONS);
+        free(pFrame);
+
+        uPortCryptoAes128CbcContextDelete(aesContext);
+        uPortCryptoHmacSha256ContextDelete(hmacContext);
+    } else {
+        U_TEST_PRINT_LINE("crypto contexts not supported.");
+    }
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Test timers.
  */
 U_PORT_TEST_FUNCTION("[port]", "portTimers")
@@ -85,6 +85,7 @@ endfunction()
 # Add /api, /src and /test sub folders for these:
 u_add_module_dir(base ${UBXLIB_BASE}/common/at_client)
 u_add_module_dir(base ${UBXLIB_BASE}/common/error)
+u_add_module_dir(base ${UBXLIB_BASE}/common/http_client)
 u_add_module_dir(base ${UBXLIB_BASE}/common/assert)
 u_add_module_dir(base ${UBXLIB_BASE}/common/location)
 u_add_module_dir(base ${UBXLIB_BASE}/common/mqtt_client)
@@ -97,12 +98,14 @@ u_add_module_dir(base ${UBXLIB_BASE}/port/platform/common/debug_utils)
 # Additional source directories
 u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/event_queue)
 u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/mutex_debug)
+u_add_source_dir(base ${UBXLIB_BASE}/port/platform/common/log_binary)
 
 # Additional include directories
 list(APPEND UBXLIB_INC
   ${UBXLIB_BASE}
   ${UBXLIB_BASE}/cfg
   ${UBXLIB_BASE}/port/api
+  ${UBXLIB_BASE}/port/platform/common/log_binary
 )
 
 list(APPEND UBXLIB_PRIVATE_INC
@@ -9,6 +9,7 @@
 UBXLIB_MODULE_DIRS = \
 	${UBXLIB_BASE}/common/at_client \
 	${UBXLIB_BASE}/common/error \
+	${UBXLIB_BASE}/common/http_client \
 	${UBXLIB_BASE}/common/assert \
 	${UBXLIB_BASE}/common/location \
 	${UBXLIB_BASE}/common/mqtt_client \
@@ -21,13 +22,15 @@ UBXLIB_MODULE_DIRS = \
 # Additional source directories
 UBXLIB_SRC_DIRS += \
 	${UBXLIB_BASE}/port/platform/common/event_queue \
-	${UBXLIB_BASE}/port/platform/common/mutex_debug
+	${UBXLIB_BASE}/port/platform/common/mutex_debug \
+	${UBXLIB_BASE}/port/platform/common/log_binary
 
 # Additional include directories
 UBXLIB_INC += \
 	${UBXLIB_BASE} \
 	${UBXLIB_BASE}/cfg \
 	${UBXLIB_BASE}/port/api \
+	${UBXLIB_BASE}/port/platform/common/log_binary \
 
 UBXLIB_PRIVATE_INC += \
 	${UBXLIB_BASE}/port/platform/common/event_queue \
@@ -88,6 +88,7 @@
 #include <u_sock_security.h>
 #include <u_mqtt_common.h>
 #include <u_mqtt_client.h>
+#include <u_http_client.h>
 #include <u_location.h>
 #include <u_ubx_protocol.h>
 #include <u_short_range.h>
@@ -117,6 +118,7 @@
 #include <u_gnss.h>
 #include <u_gnss_cfg.h>
 #include <u_gnss_info.h>
+#include <u_gnss_mga.h>
 #include <u_gnss_pos.h>
 #include <u_gnss_pwr.h>
 #include <u_gnss_util.h>
@@ -93,6 +93,21 @@ extern "C" {
 #define U_WIFI_SOCK_WRITE_TIMEOUT_MS 500
 #endif
 
+#ifndef U_WIFI_SOCK_TX_BUFFER_SIZE_BYTES
+/** The default transmit buffer size for a TCP socket, which may be
+ * changed per socket with the socket option #U_SOCK_OPT_SNDBUF at
+ * level #U_SOCK_OPT_LEVEL_SOCK.  When this is non-zero
+ * uWifiSockWrite() frames the data into maximal EDM packets,
+ * gathered into transmit buffers of this size that are sent to
+ * the UART in one go, pipelined where the platform supports
+ * uPortUartWriteAsync(); a buffer a few times larger than
+ * #U_WIFI_SOCK_MAX_SEGMENT_SIZE_BYTES, e.g. 4096, gives the best
+ * throughput.  Zero means that uWifiSockWrite() sends each call
+ * as a single EDM packet, with no additional buffering.
+ */
+# define U_WIFI_SOCK_TX_BUFFER_SIZE_BYTES 0
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -233,7 +248,10 @@ bool uWifiSockBlockingGet(uDeviceHandle_t devHandle,
  * the socket receive timeout one would pass in a level
  * of #U_SOCK_OPT_LEVEL_SOCK, and option value of
  * #U_SOCK_OPT_RCVTIMEO and then the option value would be
- * a pointer to a structure of type timeval.
+ * a pointer to a structure of type timeval.  The options
+ * supported are #U_SOCK_OPT_SNDBUF at level #U_SOCK_OPT_LEVEL_SOCK
+ * (int32_t, TCP only, see #U_WIFI_SOCK_TX_BUFFER_SIZE_BYTES) and
+ * those at level #U_SOCK_OPT_LEVEL_TCP.
  *
  * @param devHandle         the handle of the wifi instance.
  * @param sockHandle        the handle of the socket.
@@ -395,6 +413,54 @@ int32_t uWifiSockRead(uDeviceHandle_t devHandle,
                       int32_t sockHandle,
                       void *pData, size_t dataSizeBytes);
 
+/** Get access to received bytes on a connected socket without
+ * copying them: a pointer to the next contiguous segment of
+ * received data is returned, the data remaining in the receive
+ * buffers of the short-range driver until it is released with
+ * uWifiSockReadRelease().  Calling this function
+ * repeatedly without releasing anything returns the same segment;
+ * once the whole of a segment has been released the next call
+ * returns the following segment.  Handling received data in place
+ * in this way means that no copy is made between the module
+ * interface and the application, which helps for sustained TCP
+ * reception; the application should release data promptly since,
+ * while it is held, the receive buffers cannot be re-used.
+ *
+ * Only one task should read from a given socket at a time and
+ * uWifiSockRead() should not be called on a socket while a segment
+ * obtained from it with this function is still in use.
+ *
+ * @param devHandle    the handle of the wifi instance.
+ * @param sockHandle   the handle of the socket.
+ * @param[out] ppData  a pointer to a place to put the pointer to
+ *                     the segment; cannot be NULL.
+ * @return             the number of bytes in the segment else
+ *                     negated value of U_SOCK_Exxx from
+ *                     u_sock_errno.h, -U_SOCK_EWOULDBLOCK if no
+ *                     data has been received.
+ */
+int32_t uWifiSockReadPeek(uDeviceHandle_t devHandle,
+                          int32_t sockHandle,
+                          const void **ppData);
+
+/** Release received bytes on a connected socket, usually after
+ * they have been handled in place using uWifiSockReadPeek(); the
+ * receive buffers that held the bytes are returned to the pool.
+ *
+ * @param devHandle     the handle of the wifi instance.
+ * @param sockHandle    the handle of the socket.
+ * @param dataSizeBytes the number of bytes to release; this may be
+ *                      less than the length of the segment returned
+ *                      by uWifiSockReadPeek(), in which case the
+ *                      next call to uWifiSockReadPeek() will return
+ *                      the remainder of that segment.
+ * @return              the number of bytes released else negated
+ *                      value of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uWifiSockReadRelease(uDeviceHandle_t devHandle,
+                             int32_t sockHandle,
+                             size_t dataSizeBytes);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: ASYNC
  * -------------------------------------------------------------- */
@@ -76,6 +76,7 @@ typedef enum {
     WIFI_INT_OPT_TCP_KEEPIDLE,
     WIFI_INT_OPT_TCP_KEEPINTVL,
     WIFI_INT_OPT_TCP_KEEPCNT,
+    WIFI_INT_OPT_SNDBUF,
 
     /* Sentinel */
     WIFI_INT_OPT_MAX
@@ -212,6 +213,8 @@ static inline WifiIntOptId_t getIntOptionId(int32_t level, uint32_t option)
             default:
                 break;
         }
+    } else if ((level == U_SOCK_OPT_LEVEL_SOCK) && (option == U_SOCK_OPT_SNDBUF)) {
+        return WIFI_INT_OPT_SNDBUF;
     }
     return WIFI_INT_OPT_INVALID;
 }
@@ -856,6 +859,7 @@ int32_t uWifiSockCreate(uDeviceHandle_t devHandle,
             pSock->localPort = pInstance->sockNextLocalPort;
             pInstance->sockNextLocalPort = -1;
             memset(pSock->intOpts, 0, sizeof(pSock->intOpts));
+            pSock->intOpts[WIFI_INT_OPT_SNDBUF] = U_WIFI_SOCK_TX_BUFFER_SIZE_BYTES;
             sockHandle = pSock->sockHandle;
         }
     }
@@ -1050,6 +1054,14 @@ int32_t uWifiSockOptionSet(uDeviceHandle_t devHandle,
         WifiIntOptId_t wifiOpt = getIntOptionId(level, option);
 
         errnoLocal = -U_SOCK_EINVAL;
+        if ((wifiOpt == WIFI_INT_OPT_SNDBUF) &&
+            ((pSock->protocol != U_SOCK_PROTOCOL_TCP) ||
+             ((pOptionValue != NULL) && (optionValueLength >= sizeof(int32_t)) &&
+              (*((const int32_t *) pOptionValue) < 0)))) {
+            // Only TCP sockets have a transmit buffer
+            // and it can't be negative
+            wifiOpt = WIFI_INT_OPT_INVALID;
+        }
         if (wifiOpt != WIFI_INT_OPT_INVALID) {
             errnoLocal = setOptionInt(pSock, wifiOpt, pOptionValue, optionValueLength);
         }
@@ -1134,6 +1146,32 @@ int32_t uWifiSockWrite(uDeviceHandle_t devHandle,
             errnoLocal = -U_SOCK_EUNATCH;
         }
     }
+    if ((errnoLocal == U_SOCK_ENONE) && (pSock->intOpts[WIFI_INT_OPT_SNDBUF] > 0)) {
+        int32_t streamHandle = pInstance->streamHandle;
+        int32_t edmChannel = pSock->edmChannel;
+        size_t txBufferSize = (size_t) pSock->intOpts[WIFI_INT_OPT_SNDBUF];
+
+        // Bulk transfer: release the lock while the data goes out
+        // so that received data can be delivered meanwhile; the EDM
+        // stream looks after its own locking
+        uShortRangeUnlock();
+
+        int32_t shortRangeEC = uShortRangeEdmStreamWriteBulk(streamHandle,
+                                                             edmChannel,
+                                                             pData, dataSizeBytes,
+                                                             txBufferSize,
+                                                             U_WIFI_SOCK_WRITE_TIMEOUT_MS);
+        if (shortRangeEC >= 0) {
+            errnoLocal = shortRangeEC;
+        } else if (shortRangeEC == (int32_t) U_ERROR_COMMON_NO_MEMORY) {
+            errnoLocal = -U_SOCK_ENOMEM;
+        } else {
+            errnoLocal = -U_SOCK_ECOMM;
+        }
+
+        return errnoLocal;
+    }
+
     if (errnoLocal == U_SOCK_ENONE) {
         int32_t shortRangeEC = uShortRangeEdmStreamWrite(pInstance->streamHandle,
                                                          pSock->edmChannel,
@@ -1190,6 +1228,80 @@ int32_t uWifiSockRead(uDeviceHandle_t devHandle,
     return errnoLocal;
 }
 
+int32_t uWifiSockReadPeek(uDeviceHandle_t devHandle,
+                          int32_t sockHandle,
+                          const void **ppData)
+{
+    int32_t errnoLocal;
+    uWifiSockSocket_t *pSock = NULL;
+    uShortRangePrivateInstance_t *pInstance = NULL;
+
+    if (ppData == NULL) {
+        return -U_SOCK_EINVAL;
+    }
+    *ppData = NULL;
+
+    if (uShortRangeLock() != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return -U_SOCK_EIO;
+    }
+
+    errnoLocal = getInstanceAndSocket(devHandle, sockHandle, &pInstance, &pSock);
+
+    // As for uWifiSockRead(), only TCP sockets are supported
+    if ((errnoLocal == U_SOCK_ENONE) && (pSock->protocol != U_SOCK_PROTOCOL_TCP)) {
+        errnoLocal = -U_SOCK_EOPNOTSUPP;
+    }
+
+    if (errnoLocal == U_SOCK_ENONE) {
+        // The segment stays where it is, at the head of the
+        // pbuf list: new data from edmIpDataCallback() is only
+        // ever added to the tail of the list
+        errnoLocal = (int32_t)uShortRangePbufListPeek(pSock->pTcpRxBuff,
+                                                      (const char **) ppData);
+        if (errnoLocal == 0) {
+            // If there are no data available we must return U_SOCK_EWOULDBLOCK
+            errnoLocal = -U_SOCK_EWOULDBLOCK;
+        }
+    }
+
+    uShortRangeUnlock();
+
+    return errnoLocal;
+}
+
+int32_t uWifiSockReadRelease(uDeviceHandle_t devHandle,
+                             int32_t sockHandle,
+                             size_t dataSizeBytes)
+{
+    int32_t errnoLocal;
+    uWifiSockSocket_t *pSock = NULL;
+    uShortRangePrivateInstance_t *pInstance = NULL;
+    uShortRangePbufList_t *pList;
+
+    if (uShortRangeLock() != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return -U_SOCK_EIO;
+    }
+
+    errnoLocal = getInstanceAndSocket(devHandle, sockHandle, &pInstance, &pSock);
+
+    if ((errnoLocal == U_SOCK_ENONE) && (pSock->protocol != U_SOCK_PROTOCOL_TCP)) {
+        errnoLocal = -U_SOCK_EOPNOTSUPP;
+    }
+
+    if (errnoLocal == U_SOCK_ENONE) {
+        pList = pSock->pTcpRxBuff;
+        errnoLocal = (int32_t)uShortRangePbufListRelease(pList, dataSizeBytes);
+        if ((pList != NULL) && (pList->totalLen == 0)) {
+            uShortRangePbufListFree(pList);
+            pSock->pTcpRxBuff = NULL;
+        }
+    }
+
+    uShortRangeUnlock();
+
+    return errnoLocal;
+}
+
 int32_t uWifiSockSendTo(uDeviceHandle_t devHandle,
                         int32_t sockHandle,
                         const uSockAddress_t *pRemoteAddress,
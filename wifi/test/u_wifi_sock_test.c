@@ -455,6 +455,24 @@ U_PORT_TEST_FUNCTION("[wifiSock]", "wifiSockTCPTest")
         TEST_CHECK_TRUE(returnCode == 0);
     }
 
+    if (!TEST_HAS_ERROR()) {
+        // Use a small transmit buffer so that the bulk
+        // transmit path has to frame writes across several
+        // EDM packets and transmit buffers
+        int32_t txBufferSize = 128;
+        size_t length = sizeof(txBufferSize);
+        returnCode = uWifiSockOptionSet(gHandles.devHandle, gSockHandleTcp,
+                                        U_SOCK_OPT_LEVEL_SOCK, U_SOCK_OPT_SNDBUF,
+                                        &txBufferSize, sizeof(txBufferSize));
+        TEST_CHECK_TRUE(returnCode == 0);
+        txBufferSize = 0;
+        returnCode = uWifiSockOptionGet(gHandles.devHandle, gSockHandleTcp,
+                                        U_SOCK_OPT_LEVEL_SOCK, U_SOCK_OPT_SNDBUF,
+                                        &txBufferSize, &length);
+        TEST_CHECK_TRUE(returnCode == 0);
+        TEST_CHECK_TRUE(txBufferSize == 128);
+    }
+
 
     //lint -esym(645, remoteAddress) 'remoteAddress' may not have been initialized
     uSockAddress_t remoteAddress;